@@ -37,6 +37,12 @@ macro(load_sdklib_libraries)
         if(USE_FREEIMAGE)
             find_package(freeimage REQUIRED)
             target_link_libraries(SDKlib PRIVATE freeimage::FreeImage)
+
+            if(USE_TURBOJPEG)
+                find_package(libjpeg-turbo CONFIG REQUIRED)
+                target_link_libraries(SDKlib PRIVATE libjpeg-turbo::turbojpeg)
+                set(HAVE_TURBOJPEG 1)
+            endif()
         endif()
 
         if(USE_FFMPEG)
@@ -106,6 +112,12 @@ macro(load_sdklib_libraries)
             # FreeImage has no pkg-config file. Use out own FindFreeImage.cmake to find the library.
             find_package(FreeImage REQUIRED)
             target_link_libraries(SDKlib PRIVATE FreeImage::FreeImage)
+
+            if(USE_TURBOJPEG)
+                pkg_check_modules(turbojpeg REQUIRED IMPORTED_TARGET libturbojpeg)
+                target_link_libraries(SDKlib PRIVATE PkgConfig::turbojpeg)
+                set(HAVE_TURBOJPEG 1)
+            endif()
         endif()
 
         if(USE_FFMPEG)
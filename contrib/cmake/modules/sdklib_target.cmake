@@ -33,6 +33,7 @@ set(SDKLIB_HEADERS
     include/mega/autocomplete.h
     include/mega/serialize64.h
     include/mega/nodemanager.h
+    include/mega/nodesnapshot.h
     include/mega/setandelement.h
     include/mega/mega_ccronexpr.h
     include/mega/testhooks.h
@@ -40,6 +41,7 @@ set(SDKLIB_HEADERS
     include/mega/mega_dict-src.h
     include/mega/gfx/GfxProcCG.h
     include/mega/gfx/freeimage.h
+    include/mega/gfx/turbojpeg.h
     include/mega/gfx/gfx_pdfium.h
     include/mega/gfx/external.h
     include/mega/pubkeyaction.h
@@ -89,6 +91,7 @@ set(SDKLIB_SOURCES
     src/gfx.cpp
     src/gfx/external.cpp
     src/gfx/freeimage.cpp
+    src/gfx/turbojpeg.cpp
     src/gfx/gfx_pdfium.cpp
     src/http.cpp
     src/json.cpp
@@ -108,6 +111,7 @@ set(SDKLIB_SOURCES
     src/request.cpp
     src/serialize64.cpp
     src/nodemanager.cpp
+    src/nodesnapshot.cpp
     src/setandelement.cpp
     src/share.cpp
     src/sharenodekeys.cpp
@@ -61,6 +61,9 @@
 #include "mega/pendingcontactrequest.h"
 #include "mega/utils.h"
 #include "mega/logging.h"
+#include "mega/tracing.h"
+#include "mega/stallsampler.h"
+#include "mega/wirecapture.h"
 #include "mega/waiter.h"
 
 #include "mega/node.h"
@@ -91,6 +94,7 @@
 #include "mega/db/sqlite.h"
 
 #include "mega/gfx/freeimage.h"
+#include "mega/gfx/turbojpeg.h"
 #include "mega/gfx/GfxProcCG.h"
 
 
@@ -24,27 +24,191 @@
 
 #include "mega/utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 namespace mega {
 
 // maps attribute names to attribute values
-struct attr_map : map<nameid, string>
+//
+// Backed by a single sorted vector rather than a std::map: the vast majority
+// of nodes carry only a handful of attributes, so a red-black tree node per
+// entry is pure allocator and cache overhead at that size. Iteration stays in
+// nameid order and the interface keeps to the std::map subset the SDK uses.
+// Unlike std::map, mutation invalidates iterators and element addresses -
+// existing call sites never hold them across one.
+struct MEGA_API attr_map
 {
+    using key_type = nameid;
+    using mapped_type = string;
+    using value_type = pair<nameid, string>;
+    using storage = vector<value_type>;
+    using iterator = storage::iterator;
+    using const_iterator = storage::const_iterator;
+
     attr_map() {}
 
     attr_map(nameid key, string value)
     {
-        (*this)[key] = value;
+        mEntries.emplace_back(key, std::move(value));
+    }
+
+    iterator begin() { return mEntries.begin(); }
+    iterator end() { return mEntries.end(); }
+    const_iterator begin() const { return mEntries.begin(); }
+    const_iterator end() const { return mEntries.end(); }
+
+    size_t size() const { return mEntries.size(); }
+    bool empty() const { return mEntries.empty(); }
+    void clear() { mEntries.clear(); }
+
+    iterator find(nameid id)
+    {
+        iterator it = lowerBound(id);
+        return it != mEntries.end() && it->first == id ? it : mEntries.end();
+    }
+
+    const_iterator find(nameid id) const
+    {
+        const_iterator it = lowerBound(id);
+        return it != mEntries.end() && it->first == id ? it : mEntries.end();
+    }
+
+    size_t count(nameid id) const { return find(id) != end() ? 1 : 0; }
+
+    string& operator[](nameid id)
+    {
+        iterator it = lowerBound(id);
+        if (it == mEntries.end() || it->first != id)
+        {
+            it = mEntries.emplace(it, id, string());
+        }
+        return it->second;
     }
 
-    attr_map(map<nameid, string>&& m)
+    size_t erase(nameid id)
     {
-        m.swap(*this);
+        iterator it = find(id);
+        if (it == mEntries.end())
+        {
+            return 0;
+        }
+        mEntries.erase(it);
+        return 1;
     }
+
+    iterator erase(const_iterator it) { return mEntries.erase(it); }
+
+    void swap(attr_map& other) { mEntries.swap(other.mEntries); }
+
+    bool operator==(const attr_map& other) const { return mEntries == other.mEntries; }
+
+private:
+    iterator lowerBound(nameid id)
+    {
+        return std::lower_bound(mEntries.begin(), mEntries.end(), id,
+                                [](const value_type& e, nameid v) { return e.first < v; });
+    }
+
+    const_iterator lowerBound(nameid id) const
+    {
+        return std::lower_bound(mEntries.begin(), mEntries.end(), id,
+                                [](const value_type& e, nameid v) { return e.first < v; });
+    }
+
+    storage mEntries;
+};
+
+// Parse-on-first-access view over an attr_map. AttrMap::unserialize() hands
+// the raw serialized blob over instead of building the std::map immediately;
+// most nodes never have anything but their name inspected, which getquick()
+// serves straight from the blob. Any other access materializes the full map
+// first, so callers keep using the std::map interface unchanged.
+class MEGA_API LazyAttrMap
+{
+public:
+    using iterator = attr_map::iterator;
+    using const_iterator = attr_map::const_iterator;
+
+    LazyAttrMap() {}
+    LazyAttrMap(const LazyAttrMap& other) { *this = other; }
+    ~LazyAttrMap() { clearQuickCache(); }
+    LazyAttrMap& operator=(const LazyAttrMap& other);
+    LazyAttrMap& operator=(const attr_map& m);
+
+    // adopt a serialized blob (as produced by AttrMap::serialize, without the
+    // terminator); parsing is deferred until something looks at the map
+    void adoptBlob(const char* ptr, size_t len);
+
+    // still holding an unparsed blob?
+    bool pending() const { return mPending.load(std::memory_order_acquire); }
+
+    // look a single attribute up without materializing the whole map.
+    // Returns nullptr if the attribute is not present
+    const string* getquick(nameid id) const;
+
+    // append the serialized form of the entries to 'd' (straight from the
+    // blob if still pending)
+    void serialize(string* d) const;
+
+    iterator begin() { return materialized().begin(); }
+    iterator end() { return materialized().end(); }
+    const_iterator begin() const { return materialized().begin(); }
+    const_iterator end() const { return materialized().end(); }
+    iterator find(nameid id) { return materialized().find(id); }
+    const_iterator find(nameid id) const { return materialized().find(id); }
+    string& operator[](nameid id) { return materialized()[id]; }
+    size_t erase(nameid id) { return materialized().erase(id); }
+    iterator erase(const_iterator it) { return materialized().erase(it); }
+    size_t size() const { return materialized().size(); }
+    bool empty() const { return materialized().empty(); }
+    void clear();
+
+    bool operator==(const LazyAttrMap& other) const { return materialized() == other.materialized(); }
+
+    operator attr_map&() { return materialized(); }
+    operator const attr_map&() const { return materialized(); }
+
+private:
+    attr_map& materialized() const;
+
+    // logically a cache of mBlob while mPending, hence mutable.
+    // Readers holding the SDK lock shared may touch pending maps
+    // concurrently, so the parse paths serialize on mParseMutex; once
+    // mPending drops to false the map is immutable under shared locking
+    // and is read without it.
+    mutable attr_map mMap;
+    mutable string mBlob;
+    mutable std::atomic<bool> mPending{false};
+
+    // one attribute served by getquick() while the blob was still pending.
+    // Entries are pool-allocated and linked, never moved or freed before
+    // the map dies, so returned pointers stay valid across the later
+    // materialization. A chain instead of a deque because a deque carries
+    // around half a KB of bookkeeping per instance, which across millions
+    // of nodes dwarfed the names it was holding
+    struct QuickEntry
+    {
+        QuickEntry* mNext;
+        nameid mId;
+        string mValue;
+    };
+
+    const string* findQuickEntry(nameid id) const;
+    const string* addQuickEntry(nameid id, const char* value, unsigned short valuelen) const;
+    void clearQuickCache();
+
+    mutable QuickEntry* mQuickCache = nullptr;
+
+    // shared by all instances: only ever held across a short parse or copy,
+    // and per-node mutexes would dwarf the maps they protect
+    static std::mutex mParseMutex;
 };
 
 struct MEGA_API AttrMap
 {
-    attr_map map;
+    LazyAttrMap map;
 
     bool getBool(const char* name) const;
 
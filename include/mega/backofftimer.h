@@ -69,17 +69,64 @@ public:
 
 class MEGA_API BackoffTimerTracked;
 
+// Hierarchical timer wheel over deciseconds: 4 levels of 64 slots each cover
+// around 19 days of deadlines (anything further is clamped and re-cascaded).
+// insert/remove are O(1), and the next-deadline query scans one 64-bit
+// occupancy word per level instead of the timers themselves, so thousands of
+// tracked backoffs cost the same per exec() pass as a handful.
+class MEGA_API TimerWheel
+{
+public:
+    struct Handle
+    {
+        int level = -1;   // -1: not in the wheel; LEVELS: in the overdue list
+        int slot = 0;
+        std::list<BackoffTimerTracked*>::iterator it;
+    };
+
+    // track a timer due at 'when'; deadlines not in the future go straight to
+    // the overdue list, which advance() keeps reporting until they are
+    // rearmed or reset (preserving the old armed-timer semantics)
+    Handle insert(dstime when, BackoffTimerTracked* t);
+
+    // untrack; the handle becomes invalid
+    void remove(const Handle& h);
+
+    // move time forward to 'now', collecting every timer that came due (the
+    // wheel forgets them - callers retrack via the timer operations)
+    void advance(dstime now, vector<BackoffTimerTracked*>* due);
+
+    // earliest possible due time of any tracked timer, or NEVER if none.
+    // Coarse (higher-level) slots report the start of their span, so the
+    // result can be early, never late
+    dstime next() const;
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOTBITS = 6;
+    static const int SLOTS = 1 << SLOTBITS;
+    static const dstime SLOTMASK = SLOTS - 1;
+
+    // redistribute a higher-level slot into finer ones as its span begins
+    void cascade(int level, int slot);
+
+    std::list<BackoffTimerTracked*> mSlots[LEVELS][SLOTS];
+    std::list<BackoffTimerTracked*> mOverdue;
+    uint64_t mOccupied[LEVELS] = { 0, 0, 0, 0 };
+    dstime mNow = 0;
+};
+
 // This class keeps track of a group of BackoffTimerTracked, which register and deregister themselves.
-// Timers are in the multimap when they have non-0 non-NEVER timeouts set, giving us a much smaller group should we need to iterate it.
+// Timers are in the wheel when they have non-0 non-NEVER timeouts set, giving us a much smaller group should we need to iterate it.
 class MEGA_API BackoffTimerGroupTracker
 {
-    std::multimap<dstime, BackoffTimerTracked*> timeouts;
+    TimerWheel timeouts;
 
 public:
-    typedef std::multimap<dstime, BackoffTimerTracked*>::iterator Iter;
+    typedef TimerWheel::Handle Iter;
 
     inline Iter add(BackoffTimerTracked* bt);
-    inline void remove(Iter i) { timeouts.erase(i); }
+    inline void remove(const Iter& i) { timeouts.remove(i); }
 
     // Find out the soonest (non-0 and non-NEVER) timeout in the group.
     // For transfers, it calls set(0) on any timed out timers, as the old code did.
@@ -96,6 +143,9 @@ class MEGA_API BackoffTimerTracked
     BackoffTimerGroupTracker& mTracker;
     BackoffTimerGroupTracker::Iter mTrackerPos;
 
+    // the wheel clears mTrackerPos when it hands a due timer back
+    friend class TimerWheel;
+
     void untrack();
     void track();
 
@@ -120,15 +170,15 @@ public:
 
 inline auto BackoffTimerGroupTracker::add(BackoffTimerTracked* bt) -> Iter
 {
-    return timeouts.emplace(bt->nextset() ? bt->nextset() : NEVER, bt);
+    return timeouts.insert(bt->nextset(), bt);
 }
 
 inline void BackoffTimerTracked::untrack()
 {
-    if (mIsEnabled && bt.nextset() != 0 && bt.nextset() != NEVER)
+    if (mTrackerPos.level >= 0)
     {
         mTracker.remove(mTrackerPos);
-        mTrackerPos = BackoffTimerGroupTracker::Iter();
+        mTrackerPos.level = -1;
     }
 }
 
@@ -158,6 +208,42 @@ public:
     TimerWithBackoff(PrnGen &rng, int tag);
 };
 
+// aggregated retry/backoff telemetry: what made each endpoint back off, how
+// often, and for how long.  Cheap enough to record unconditionally, and
+// reported through MegaApi so a slow device can explain itself without
+// fleet-side correlation
+class MEGA_API RetryTelemetry
+{
+public:
+    typedef enum
+    {
+        ENDPOINT_CS = 0,        // API command channel
+        ENDPOINT_SC,            // server-client/action packet channel
+        ENDPOINT_TRANSFER_GET,
+        ENDPOINT_TRANSFER_PUT,
+        ENDPOINTS
+    } endpoint_t;
+
+    // record one backoff decision: why it happened and the delay chosen
+    void record(endpoint_t ep, retryreason_t reason, dstime delayds);
+
+    // one line per endpoint that retried: per-cause counts and delay
+    // aggregates (total/max/last, in ds)
+    string report() const;
+
+private:
+    struct Stats
+    {
+        uint64_t count[RETRY_UNKNOWN + 1] = {};
+        uint64_t totalretries = 0;
+        uint64_t totaldelayds = 0;
+        dstime maxdelayds = 0;
+        dstime lastdelayds = 0;
+    };
+
+    Stats mStats[ENDPOINTS];
+};
+
 } // namespace
 
 #endif
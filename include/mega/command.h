@@ -160,9 +160,20 @@ public:
     // json for the command is usually pre-generated but can be calculated just before sending, by overriding this function
     virtual const char* getJSON(MegaClient* client);
 
+    // approximate size of this command's JSON, for size-aware batch formation
+    size_t estimatedSize() const { return jsonWriter.size(); }
+
     Command();
     virtual ~Command();
 
+    // commands churn at a high rate on busy accounts: every API operation
+    // news a subclass and destroys it once the response is processed. Route
+    // them through the fixed-block pools, size-classed so subclasses of
+    // similar size share slots, and steady-state traffic stops touching the
+    // general-purpose heap.
+    void* operator new(size_t size);
+    void operator delete(void* ptr, size_t size);
+
     bool checkError(Error &errorDetails, JSON &json);
 
     void addToNodePendingCommands(Node* n);
@@ -212,6 +223,16 @@ struct MEGA_API HttpReqFA : public HttpReq, public std::enable_shared_from_this<
     std::function<CommandPutFA*()> getURLForFACmd;
     int tag = 0;
 
+    // upload URL received for this attribute; the data POST starts once a
+    // putfa slot is free (status REQ_PREPARED in between)
+    string faurl;
+
+    // start the data POST to faurl
+    void postfadata(MegaClient*);
+
+    // the encrypted attribute payload (NULL if only the URL was requested)
+    const string* encryptedData() const { return data.get(); }
+
 private:
     std::unique_ptr<string> data;
 };
@@ -418,10 +439,19 @@ public:
 
     CommandGetUA(MegaClient*, const char*, attr_t, const char *, int,
         CompletionErr completionErr, CompletionBytes completionBytes, CompletionTLV compltionTLV);
+    ~CommandGetUA() override;
 
     bool procresult(Result, JSON&) override;
 
+    // key identifying identical fetches, for coalescing in MegaClient::getua
+    static string mapkey(const char* uid, attr_t at, const char* ph);
+
+    // chain another caller's completion onto this command, so a duplicate
+    // in-flight fetch is answered by the one server round trip
+    void addWaiter(int ctag, CompletionErr ce, CompletionBytes cb, CompletionTLV ctlv);
+
 private:
+    string mMapKey;
     CompletionErr mCompletionErr;
     CompletionBytes mCompletionBytes;
     CompletionTLV mCompletionTLV;
@@ -486,7 +516,8 @@ protected:
 class MEGA_API CommandNodeKeyUpdate : public Command
 {
 public:
-    CommandNodeKeyUpdate(MegaClient*, handle_vector*);
+    // emits the [from, to) slice of pre-encrypted (handle, key) rewrites
+    CommandNodeKeyUpdate(MegaClient*, const vector<pair<handle, string>>& rewrites, size_t from, size_t to);
 
     bool procresult(Result, JSON&) override { return true; }
 };
@@ -495,7 +526,9 @@ class MEGA_API CommandShareKeyUpdate : public Command
 {
 public:
     CommandShareKeyUpdate(MegaClient*, handle, const char*, const byte*, int);
-    CommandShareKeyUpdate(MegaClient*, handle_vector*);
+
+    // emits the [from, to) slice of pre-encrypted (handle, key) rewrites
+    CommandShareKeyUpdate(MegaClient*, const vector<pair<handle, string>>& rewrites, size_t from, size_t to);
 
     bool procresult(Result, JSON&) override { return true; }
 };
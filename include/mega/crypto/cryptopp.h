@@ -82,6 +82,8 @@ private:
     CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption aescbc_e;
     CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption aescbc_d;
 
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption aesctr_e;
+
     CryptoPP::CCM<CryptoPP::AES, 16>::Encryption aesccm16_e;
     CryptoPP::CCM<CryptoPP::AES, 16>::Decryption aesccm16_d;
 
@@ -425,8 +427,18 @@ public:
      */
     void serializekeyforjs(std::string *);
 
+    // advance the transfer MAC chain over whole blocks of data: mac = E(block XOR mac)
+    // per block, computed as CBC encryption with the running mac as IV so Crypto++ can
+    // dispatch the whole run to the hardware AES pipeline in one call
+    void cbcmac(byte* mac, const byte* data, unsigned len);
+
     void ctr_crypt(byte *, unsigned, m_off_t, ctr_iv, byte *mac, bool encrypt, bool initmac = true);
 
+    // encrypt from a separate read-only source (e.g. a memory-mapped file) into dst:
+    // reads exactly len bytes from src, NUL-padding the final partial block internally,
+    // and writes whole blocks to dst (so dst must be padded to BLOCKSIZE)
+    void ctr_crypt(const byte* src, byte* dst, unsigned len, m_off_t pos, ctr_iv ctriv, byte* mac, bool initmac = true);
+
     static void setint64(int64_t, byte*);
 
     static void xorblock(const byte*, byte*);
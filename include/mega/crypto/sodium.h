@@ -76,6 +76,31 @@ public:
     static bool verifyKey(const unsigned char* pubk, const unsigned long long pubkLen,
                    const std::string *sig, const unsigned char* singingPubKey);
 
+    /**
+     * @brief One entry of a key signature verification batch.
+     *
+     * Fields mirror the verifyKey() parameters; pointed-to data must stay
+     * valid until verifyKeyBatch() returns.
+     */
+    struct KeySignature
+    {
+        const unsigned char* pubk;
+        unsigned long long pubkLen;
+        const std::string* sig;
+        const unsigned char* signingPubKey;
+    };
+
+    /**
+     * @brief Verifies a batch of independent key signatures.
+     *
+     * Entries are verified concurrently across hardware threads, so a large
+     * batch does not serialize through one core.
+     *
+     * @param batch Signatures to verify.
+     * @return Per-entry results; element i equals verifyKey() on entry i.
+     */
+    static std::vector<bool> verifyKeyBatch(const std::vector<KeySignature>& batch);
+
 private:
     static const int PRIVATE_KEY_LENGTH = crypto_sign_SECRETKEYBYTES;
     unsigned char privKey[PRIVATE_KEY_LENGTH]; // don't use it externally, use keySeed instead
@@ -71,6 +71,10 @@ public:
     virtual bool next(uint32_t*, string*) = 0;
     bool next(uint32_t*, string*, SymmCipher*);
 
+    // like the decrypting next(), but hands the ciphertext back: the caller
+    // decrypts (eg. in parallel on worker threads). Id bookkeeping matches
+    bool nextRaw(uint32_t*, string*);
+
     // get specific record by key
     virtual bool get(uint32_t, string*) = 0;
 
@@ -111,6 +115,7 @@ public:
 };
 
 class NodeSearchFilter;
+class NodeSearchPage;
 
 class MEGA_API DBTableNodes
 {
@@ -119,6 +124,16 @@ public:
     // add or update a node
     virtual bool put(Node* node) = 0;
 
+    // number of node rows buffered before they are written with one multi-row
+    // statement; 1 disables batching. Buffered rows are flushed before any other
+    // operation on the table and at transaction boundaries
+    virtual void setPutBatchSize(unsigned) {}
+
+    // store node blobs compressed (reads always understand both formats, so this
+    // only affects rows written from now on). Off by default: a database written
+    // with compression enabled is not readable by older clients
+    virtual void setBlobCompression(bool) {}
+
     // remove one node from 'nodes' table
     virtual bool remove(NodeHandle nodehandle) = 0;
 
@@ -138,7 +153,7 @@ public:
 
     virtual bool getChildrenFromType(NodeHandle parentHandle, nodetype_t nodeType, std::vector<std::pair<NodeHandle, NodeSerialized>>& children, CancelToken cancelFlag) = 0;
     virtual uint64_t getNumberOfChildren(NodeHandle parentHandle) = 0;
-    virtual bool getChildren(const NodeSearchFilter& filter, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, CancelToken cancelFlag) = 0;
+    virtual bool getChildren(const NodeSearchFilter& filter, const NodeSearchPage& page, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, CancelToken cancelFlag) = 0;
     virtual bool searchNodes(const NodeSearchFilter& filter, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, CancelToken cancelFlag) = 0;
 
     /**
@@ -165,8 +180,15 @@ public:
     virtual bool getRecentNodes(unsigned maxcount, m_time_t since, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
     virtual bool getNodesByFingerprint(const std::string& fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
     virtual bool getNodeByFingerprint(const std::string& fingerprint, mega::NodeSerialized& node, NodeHandle& handle) = 0;
+
+    // handle-only fingerprint lookup: answered from the fingerprint->handle index
+    // without deserializing any node (for upload dedup / "already exists" checks)
+    virtual bool getHandleByFingerprint(const std::string& fingerprint, NodeHandle& handle) = 0;
     virtual bool getRootNodes(std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
 
+    // full table dump (used to build the read-only node snapshot after fetchnodes)
+    virtual bool getAllNodes(std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
+
     /**
      * @deprecated
      * should be removed along with deprecated MegaApi::getChildren() calls
@@ -303,7 +325,10 @@ enum DbOpenFlag
     // Recycle legacy database, if present.
     DB_OPEN_FLAG_RECYCLE = 0x1,
     // Operations should always be transacted.
-    DB_OPEN_FLAG_TRANSACTED = 0x2
+    DB_OPEN_FLAG_TRANSACTED = 0x2,
+    // Tune the connection for concurrent readers (WAL with relaxed syncing and a
+    // busy timeout), so lookups from other threads don't fail behind a commit.
+    DB_OPEN_FLAG_CONCURRENT = 0x4
 }; // DbOpenFlag
 
 struct MEGA_API DbAccess
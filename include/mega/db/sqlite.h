@@ -76,6 +76,7 @@ public:
     bool getNode(mega::NodeHandle nodehandle, NodeSerialized& nodeSerialized) override;
     bool getNodesByOrigFingerprint(const std::string& fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized>> &nodes) override;
     bool getRootNodes(std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) override;
+    bool getAllNodes(std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) override;
 
     /**
      * @deprecated
@@ -94,7 +95,7 @@ public:
     bool getChildrenFromType(NodeHandle parentHandle, nodetype_t nodeType, std::vector<std::pair<NodeHandle, NodeSerialized>>& children, mega::CancelToken cancelFlag) override;
     uint64_t getNumberOfChildren(NodeHandle parentHandle) override;
     // If a cancelFlag is passed, it must be kept alive until this method returns.
-    bool getChildren(const mega::NodeSearchFilter& filter, std::vector<std::pair<NodeHandle, NodeSerialized>>& children, CancelToken cancelFlag) override;
+    bool getChildren(const mega::NodeSearchFilter& filter, const mega::NodeSearchPage& page, std::vector<std::pair<NodeHandle, NodeSerialized>>& children, CancelToken cancelFlag) override;
     bool searchNodes(const mega::NodeSearchFilter& filter, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, CancelToken cancelFlag) override;
 
     /**
@@ -120,6 +121,7 @@ public:
 
     bool getNodesByFingerprint(const std::string& fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) override;
     bool getNodeByFingerprint(const std::string& fingerprint, mega::NodeSerialized& node, NodeHandle& handle) override;
+    bool getHandleByFingerprint(const std::string& fingerprint, NodeHandle& handle) override;
     bool getRecentNodes(unsigned maxcount, m_time_t since, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) override;
     bool getFavouritesHandles(NodeHandle node, uint32_t count, std::vector<mega::NodeHandle>& nodes) override;
     bool childNodeByNameType(NodeHandle parentHanlde, const std::string& name, nodetype_t nodeType, std::pair<NodeHandle, NodeSerialized>& node) override;
@@ -142,6 +144,8 @@ public:
      */
     bool getNodesByMimetypeExclusiveRecursive(MimeType_t mimeType, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, Node::Flags requiredFlags, Node::Flags excludeFlags, Node::Flags excludeRecursiveFlags, NodeHandle anscestorHandle, CancelToken cancelFlag) override;
     bool put(Node* node) override;
+    void setPutBatchSize(unsigned size) override;
+    void setBlobCompression(bool enable) override;
     bool remove(mega::NodeHandle nodehandle) override;
     bool removeNodes() override;
 
@@ -150,6 +154,11 @@ public:
     void createIndexes() override;
 
     void remove() override;
+
+    // flush (or on abort, drop) node rows still buffered by put()
+    void commit() override;
+    void abort() override;
+
     SqliteAccountState(PrnGen &rng, sqlite3*, FileSystemAccess &fsAccess, const mega::LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack);
     void finalise();
     virtual ~SqliteAccountState();
@@ -176,8 +185,48 @@ private:
     // Allow at least the following containers:
     bool processSqlQueryNodes(sqlite3_stmt *stmt, std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>& nodes);
 
+    // one serialized node row, ready to be bound to an INSERT statement
+    struct PutNodeRecord
+    {
+        int64_t mHandle = 0;
+        int64_t mParentHandle = 0;
+        std::string mName;
+        std::string mFingerprint;
+        std::string mOrigFingerprint;
+        int mType = 0;
+        int64_t mSize = 0;
+        int mShareType = 0;
+        int mFav = 0;
+        int64_t mCtime = 0;
+        int64_t mMtime = 0;
+        int64_t mFlags = 0;
+        std::string mCounter;
+        std::string mNode;
+    };
+
+    void fillPutNodeRecord(PutNodeRecord& rec, Node* node);
+
+    // deflate 'blob' in place, prefixed with a magic + original size header
+    // (kept as-is if compression doesn't pay for itself)
+    static void encodeNodeBlob(std::string& blob);
+
+    // inflate 'blob' in place if it carries the compressed-blob header
+    static void decodeNodeBlob(std::string& blob);
+
+    bool mCompressNodeBlobs = false;
+    static void bindPutNodeRecord(sqlite3_stmt* stmt, int row, const PutNodeRecord& rec);
+    bool putNodeRecord(const PutNodeRecord& rec);
+    bool flushPutNodeBatch();
+
+    std::vector<PutNodeRecord> mPutNodeBatch;
+    unsigned mPutNodeBatchSize = DEFAULT_PUT_BATCH_SIZE;
+
+    // 32 rows x 14 columns stays well below SQLite's default limit of 999 bound variables
+    static const unsigned DEFAULT_PUT_BATCH_SIZE = 32;
+
     // if add a new sqlite3_stmt update finalise()
     sqlite3_stmt* mStmtPutNode = nullptr;
+    sqlite3_stmt* mStmtPutNodeBatch = nullptr;
     sqlite3_stmt* mStmtUpdateNode = nullptr;
     sqlite3_stmt* mStmtUpdateNodeAndFlags = nullptr;
     sqlite3_stmt* mStmtTypeAndSizeNode = nullptr;
@@ -191,7 +240,9 @@ private:
 
     sqlite3_stmt* mStmtNumChildren = nullptr;
     sqlite3_stmt* mStmtGetChildren = nullptr;
+    sqlite3_stmt* mStmtGetChildrenFts = nullptr;
     sqlite3_stmt* mStmtSearchNodes = nullptr;
+    sqlite3_stmt* mStmtSearchNodesFts = nullptr;
 
     /** @deprecated */
     sqlite3_stmt* mStmtNodeByName = nullptr;
@@ -210,6 +261,7 @@ private:
 
     sqlite3_stmt* mStmtNodesByFp = nullptr;
     sqlite3_stmt* mStmtNodeByFp = nullptr;
+    sqlite3_stmt* mStmtHandleByFp = nullptr;
     sqlite3_stmt* mStmtNodeByOrigFp = nullptr;
     sqlite3_stmt* mStmtChildNode = nullptr;
     sqlite3_stmt* mStmtIsAncestor = nullptr;
@@ -220,6 +272,16 @@ private:
     // how many SQLite instructions will be executed between callbacks to the progress handler
     // (tests with a value of 1000 results on a callback every 1.2ms on a desktop PC)
     static const int NUM_VIRTUAL_MACHINE_INSTRUCTIONS = 1000;
+
+    // whether the 'fts_nodes' full-text name index can be used for 'name' (long enough,
+    // and the trigram-tokenized FTS5 table is available in this DB / SQLite build)
+    bool useFtsNameIndex(const std::string& name);
+
+    // quote 'name' as an FTS5 string literal, so it is matched as a plain substring
+    static std::string ftsQuoteName(const std::string& name);
+
+    // -1 not probed yet, 0 unavailable, 1 available
+    int mFtsNameIndexAvailable = -1;
 };
 
 class MEGA_API SqliteDbAccess : public DbAccess
@@ -254,6 +316,7 @@ private:
     void removeDBFiles(mega::FileSystemAccess& fsAccess, mega::LocalPath& dbPath);
     bool ensureColumnIsInNodesTable(sqlite3* db, const string& colName, const string& colType, std::function<bool()> callAfterAdded = nullptr);
     bool copyMtimeFromFingerprint(sqlite3* db);
+    bool createNameFulltextIndex(sqlite3* db);
 };
 
 } // namespace
@@ -61,6 +61,9 @@ struct MEGA_API File: public FileFingerprint
     // update localname
     virtual void updatelocalname() { }
 
+    // traffic class this file's transfer data is accounted against
+    virtual trafficclass_t trafficclass() const;
+
     void sendPutnodesOfUpload(MegaClient* client, UploadHandle fileAttrMatchHandle, const UploadToken& ultoken,
                       const FileNodeKey& filekey, putsource_t source, NodeHandle ovHandle,
                       std::function<void(const Error&, targettype_t, vector<NewNode>&, bool targetOverride, int tag)>&& completion,
@@ -95,6 +98,10 @@ struct MEGA_API File: public FileFingerprint
     // previous node, if any
     std::shared_ptr<Node> previousNode;
 
+    // identical node spotted at startxfer() time: putnodes will issue a
+    // server-side copy of it instead of referencing uploaded file data
+    std::shared_ptr<Node> cloneNode;
+
     struct
     {
         // source handle private?
@@ -111,6 +118,10 @@ struct MEGA_API File: public FileFingerprint
 
         // remember if the sync is from an inshare
         bool fromInsycShare : 1;
+
+        // the app asked for a true re-upload; never satisfy this File by
+        // cloning an existing node
+        bool forceNewUpload : 1;
     };
 
     VersioningOption mVersioningOption = NoVersioning;
@@ -174,6 +185,9 @@ struct SyncTransfer_inClient: public File
 
     shared_ptr<SyncThreadsafeState> syncThreadSafeState;
 
+    // distinguish backup syncs (Vault-bound) from twoway syncs
+    trafficclass_t trafficclass() const override;
+
     // Why was the transfer failed/terminated?
     error mError = API_OK;
 
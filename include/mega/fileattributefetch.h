@@ -28,6 +28,51 @@
 
 namespace mega {
 
+class DbTable;
+
+// durable content-addressed store of file attributes (thumbnails/previews),
+// keyed by file attribute handle, with size-bounded LRU eviction. Records keep
+// the wire (CBC-encrypted) form, so the cache is opaque without the node keys.
+// Checked before any fetch goes out on a faf channel.
+class MEGA_API FileAttributeCache
+{
+    struct Entry
+    {
+        uint32_t dbid;
+        unsigned size;
+        m_time_t lastuse;
+    };
+
+    map<handle, Entry> mEntries;
+    unique_ptr<DbTable> mTable;
+    m_off_t mTotalSize = 0;
+
+    // drop least recently used records until the cache fits the bound again
+    void evict();
+
+public:
+    // stored attribute bytes beyond this make the oldest records go
+    static const m_off_t MAXSIZE = 64 * 1048576;
+
+    // take ownership of the (possibly NULL) table and load the handle index
+    void init(DbTable*);
+
+    // look up one attribute by its handle, refreshing its recency
+    bool get(handle fah, string* data);
+
+    // store one attribute as sent/received on the wire (still encrypted)
+    void put(handle fah, fatype, const char* data, unsigned len);
+
+    // close the table, keeping its records for the next session
+    void reset();
+
+    // permanently delete the table and all records
+    void remove();
+
+    FileAttributeCache();
+    ~FileAttributeCache();
+};
+
 // file attribute fetching for a specific source cluster
 struct MEGA_API FileAttributeFetchChannel
 {
@@ -43,6 +88,9 @@ struct MEGA_API FileAttributeFetchChannel
     string posturl;
     size_t inbytes;
 
+    // a download URL is being refreshed in parallel with an active transfer
+    bool urlfetching;
+
     faf_map fafs[2];
     error e;
 
@@ -67,7 +115,10 @@ struct MEGA_API FileAttributeFetch
     int retries;
     int tag;
 
-    FileAttributeFetch(handle, string, fatype, int);
+    // request recency - newer fetches are dispatched first
+    unsigned seqno;
+
+    FileAttributeFetch(handle, string, fatype, int, unsigned);
 };
 } // namespace
 
@@ -47,6 +47,12 @@ struct MEGA_API FileFingerprint : public Cacheable
     bool isvalid = false;
 
     // Generates a fingerprint by iterating through`fa`
+    //
+    // There is deliberately no incremental mode for appended/tail-modified
+    // files: sample offsets are a function of the file size, so any size
+    // change relocates every sample and cached per-sample CRC state cannot
+    // be reused. Recomputation is already bounded at MAXFULL (8KB) of reads
+    // per file regardless of file size.
     bool genfingerprint(FileAccess* fa, bool ignoremtime = false);
 
     // Generates a fingerprint by iterating through `is`
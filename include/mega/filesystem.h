@@ -707,12 +707,40 @@ struct MEGA_API FileAccess
     // absolute position write
     virtual bool fwrite(const byte *, unsigned, m_off_t) = 0;
 
+    // Write len zero bytes at pos without physically storing them, where the
+    // platform supports it (extending the file to leave a hole, or punching
+    // one through already allocated blocks).  Returns false when that isn't
+    // possible; the caller then falls back to a regular fwrite().
+    virtual bool fwriteZeros(unsigned len, m_off_t pos);
+
+    // Reserve backing store for the file up to the given size, so data
+    // written later (possibly out of order) lands in contiguous extents
+    // rather than fragmenting as the file grows chunk by chunk.  Returns
+    // false where the platform or filesystem can't; writes then proceed
+    // exactly as without the reservation.
+    virtual bool fpreallocate(m_off_t size);
+
+    // Access-pattern hints for [pos, pos + len) (len 0 = to end of file):
+    // the whole file will be read once front to back / the range will be
+    // read shortly / the range's cached pages won't be needed again.
+    enum AccessHint { ACCESS_SEQUENTIAL, ACCESS_WILLNEED, ACCESS_DONTNEED };
+
+    // Advise the kernel about upcoming (or completed) access to part of the
+    // file.  Purely an optimization; the default implementation does nothing.
+    virtual void fadvise(AccessHint, m_off_t, m_off_t) { }
+
     // Truncate a file.
     virtual bool ftruncate() = 0;
 
     FileAccess(Waiter *waiter);
     virtual ~FileAccess();
 
+    // Map [pos, pos + size) of the file for reading (zero-copy upload path).
+    // The returned pointer keeps the mapping alive for as long as it is held,
+    // including after this FileAccess is closed or destroyed.
+    // Returns nullptr when mapping is unsupported or fails; callers fall back to fread().
+    virtual std::shared_ptr<const byte> mmapread(m_off_t, unsigned) { return nullptr; }
+
     virtual bool asyncavailable() { return false; }
 
     AsyncIOContext *asyncfopen(const LocalPath&, FSLogging);
@@ -784,6 +812,10 @@ struct Notification
     LocalPath path;
     LocalNode* localnode = nullptr;
 
+    // how many raw filesystem events this notification stands for (repeats
+    // of the same event are coalesced in the queue rather than queued again)
+    unsigned count = 1;
+
     Notification() {}
     Notification(dstime ts, ScanRequirement sr, const LocalPath& p, LocalNode* ln)
         : timestamp(ts), scanRequirement(sr), path(p), localnode(ln)
@@ -803,6 +835,37 @@ struct NotificationDeque : ThreadSafeDeque<Notification>
             }
         }
     }
+
+    // Returns true if n was folded into a recently queued notification.
+    // Builds and similar bursts deliver long runs of events for the same few
+    // paths; folding exact repeats here keeps the queue small and saves the
+    // sync loop from resolving each repeat individually.
+    bool coalesce(const Notification& n)
+    {
+        std::lock_guard<std::mutex> g(m);
+
+        size_t checked = 0;
+        for (auto i = mNotifications.rbegin();
+             i != mNotifications.rend() && checked < 8;
+             ++i, ++checked)
+        {
+            if (i->localnode == n.localnode &&
+                i->scanRequirement == n.scanRequirement &&
+                i->path == n.path)
+            {
+                i->count += n.count;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> g(m);
+        mNotifications.clear();
+    }
 };
 
 // filesystem change notification, highly coupled to Syncs and LocalNodes.
@@ -826,6 +889,11 @@ public:
     // set if a temporary error occurred.  May be set from a thread.
     std::atomic<int> mErrorCount;
 
+    // If the event queue grows beyond this despite coalescing, it is
+    // collapsed into a full rescan (resolving such a backlog against the
+    // LocalNode tree costs more than the rescan does).
+    static const size_t MAX_QUEUED_NOTIFICATIONS = 100000;
+
     // thread safe setter/getters
     void setFailed(int errCode, const string& reason);
     int  getFailed(string& reason);
@@ -969,12 +1037,23 @@ struct MEGA_API FileSystemAccess : public EventTrigger
     virtual bool initFilesystemNotificationSystem();
 #endif // ENABLE_SYNC
 
+    // When deferredFingerprints is nonnull, files needing a (re)computed
+    // fingerprint are recorded there as indices into results instead of being
+    // fingerprinted inline, so the caller can overlap CRC computation with
+    // further discovery.
     virtual ScanResult directoryScan(const LocalPath& path,
                                      handle expectedFsid,
                                      map<LocalPath, FSNode>& known,
                                      std::vector<FSNode>& results,
                                      bool followSymLinks,
-                                     unsigned& nFingerprinted) = 0;
+                                     unsigned& nFingerprinted,
+                                     std::vector<size_t>* deferredFingerprints) = 0;
+
+    // Computes the content fingerprint of a single file found by
+    // directoryScan(...), as used for entries whose fingerprints were
+    // deferred.  Platforms may override it to open the file with the same
+    // flags their inline scan path uses (eg. O_NOATIME on POSIX).
+    virtual bool scanFingerprint(const LocalPath& filePath, FSNode& node);
 
     // Retrieve the FSID of the item at the specified path.
     // UNDEF is returned if we cannot determine the item's FSID.
@@ -1047,6 +1126,13 @@ int compareUtf(const string&, bool unescaping1, const LocalPath&, bool unescapin
 int compareUtf(const LocalPath&, bool unescaping1, const string&, bool unescaping2, bool caseInsensitive);
 int compareUtf(const LocalPath&, bool unescaping1, const LocalPath&, bool unescaping2, bool caseInsensitive);
 
+// 64-bit hash of a name's canonical form: escapes decoded and codepoints
+// case-folded, mirroring the equality applied by compareUtf(a, true, b, true, ...).
+// Names that compare equal (under either case sensitivity) always hash equally,
+// so the hash serves as a cheap first-level key when grouping names; rows with
+// equal hashes still need a compareUtf call to confirm a real match.
+uint64_t canonicalNameHash(const string& name);
+
 // Same as above except case insensitivity is determined by build platform.
 int platformCompareUtf(const string&, bool unescape1, const string&, bool unescape2);
 int platformCompareUtf(const string&, bool unescape1, const LocalPath&, bool unescape2);
@@ -1216,18 +1302,51 @@ private:
         void queue(ScanRequestPtr request);
 
     private:
+        // A scan whose content fingerprints are still being computed.
+        //
+        // Discovery fills the request's results first; the CRCs of new or
+        // changed files are then claimed one at a time by whichever threads
+        // are free, so fingerprinting one directory overlaps discovery of
+        // the next.
+        struct FingerprintBatch
+        {
+            // The request whose results are being fingerprinted.
+            ScanRequestPtr mRequest;
+
+            // Indices into the request's results needing fingerprints.
+            std::vector<size_t> mDeferred;
+
+            // Next entry of mDeferred to claim (guarded by mPendingLock).
+            size_t mNext = 0;
+
+            // Claimed entries not yet completed (guarded by mPendingLock).
+            size_t mRemaining = 0;
+
+            // How many files were actually fingerprinted (guarded by mPendingLock).
+            unsigned mNumFingerprinted = 0;
+
+            // When the scan began, for the completion log.
+            std::chrono::high_resolution_clock::time_point mScanStart;
+        };
+
+        using FingerprintBatchPtr = std::shared_ptr<FingerprintBatch>;
+
         // Thread entry point.
         void loop();
 
-        // Processes a scan request.
-        ScanResult scan(ScanRequestPtr request, unsigned& nFingerprinted);
+        // Processes a scan request (fsAccess is the calling thread's own).
+        ScanResult scan(FileSystemAccess& fsAccess, ScanRequestPtr request, unsigned& nFingerprinted, std::vector<size_t>& deferredFingerprints);
 
-        // Filesystem access.
-        std::unique_ptr<FileSystemAccess> mFsAccess;
+        // Computes one deferred fingerprint; completes the batch's request
+        // when the last entry is done.
+        void fingerprintOne(FileSystemAccess& fsAccess, FingerprintBatchPtr batch, size_t index);
 
         // Pending scan requests.
         std::deque<ScanRequestPtr> mPending;
 
+        // Scans whose deferred fingerprints are still outstanding.
+        std::deque<FingerprintBatchPtr> mPendingBatches;
+
         // Guards access to the above.
         std::mutex mPendingLock;
         std::condition_variable mPendingNotifier;
@@ -22,6 +22,7 @@
 #ifndef GFX_H
 #define GFX_H 1
 
+#include <functional>
 #include <mutex>
 
 #ifdef USE_IOS
@@ -51,6 +52,17 @@ public:
     // key related to the image
     byte key[SymmCipher::KEYLENGTH];
 
+    // flipping this skips the (potentially slow) decode; the job still
+    // travels to checkevents() so pending file attribute counters unwind
+    CancelToken cancelToken;
+
+    // best-effort backfill jobs yield to jobs gating an active upload
+    bool background = false;
+
+    // second pass for a render that ran out of budget: no time cap, and no
+    // further refinement regardless of the outcome
+    bool refinement = false;
+
     // resulting images
     vector<string *> images;
 };
@@ -58,13 +70,21 @@ public:
 class MEGA_API GfxJobQueue
 {
     protected:
+        // two lanes: pop() always serves the priority lane first, so a burst
+        // of background backfill cannot delay imagery an upload is waiting on
         std::deque<GfxJob *> jobs;
+        std::deque<GfxJob *> backgroundJobs;
+
+        // nodes the app flagged as visible: pop() serves their jobs ahead of
+        // the rest of their lane
+        std::set<handle> prioritized;
         std::mutex mutex;
 
     public:
         GfxJobQueue();
         void push(GfxJob *job);
         GfxJob *pop();
+        void prioritize(handle h, bool up);
 };
 
 // Interface for graphic processor provider used by GfxProc
@@ -78,6 +98,18 @@ public: // read and store bitmap
 
     virtual bool readbitmap(FileSystemAccess*, const LocalPath&, int) = 0;
 
+    // decode an image held in memory (embedded EXIF thumbnails); providers
+    // without memory decoding keep the default and get a full file decode
+    virtual bool readbitmapmem(const byte*, size_t) { return false; }
+
+    // wall-clock cap in milliseconds for expensive renders (0 = no cap);
+    // when it runs out, a degraded bitmap may be produced - see partialrender()
+    virtual void setrenderbudget(unsigned) { }
+
+    // whether the last readbitmap() gave up early, leaving a degraded bitmap
+    // worth re-rendering without a budget
+    virtual bool partialrender() { return false; }
+
     // resize stored bitmap and store result as JPEG
     virtual bool resizebitmap(int, int, string* result) = 0;
 
@@ -104,17 +136,36 @@ protected:
 class MEGA_API GfxProc
 {
     bool finished;
-    WAIT_CLASS waiter;
     std::mutex mutex;
-    THREAD_CLASS thread;
     bool threadstarted = false;
     SymmCipher mCheckEventsKey;
     GfxJobQueue requests;
     GfxJobQueue responses;
     std::unique_ptr<IGfxProvider>  mGfxProvider;
 
+    // one processing thread plus the provider instance confined to it. The
+    // first worker shares mGfxProvider with the synchronous paths under
+    // 'mutex'; further workers own a provider minted by mProviderFactory, so
+    // codec libraries that dislike cross-thread use never see it
+    struct Worker
+    {
+        GfxProc* proc = nullptr;
+        IGfxProvider* provider = nullptr;
+        std::unique_ptr<IGfxProvider> ownedProvider;
+        WAIT_CLASS waiter;
+        THREAD_CLASS thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::function<std::unique_ptr<IGfxProvider>()> mProviderFactory;
+    unsigned mWorkerCount = 1;
+
     static void *threadEntryPoint(void *param);
-    void loop();
+    void loop(Worker* worker);
+
+    // wall-clock budget per job for expensive renders (PDFs); a job that runs
+    // out delivers what it has and requeues an unbudgeted refinement pass
+    static const unsigned RENDERBUDGETMS = 3000;
 
     struct Dimension final
     {
@@ -125,9 +176,9 @@ class MEGA_API GfxProc
 
     std::vector<Dimension> getJobDimensions(GfxJob *job);
 
-    // Caller should give dimensions from high resolution to low resolution, as some implementation such as freeimages 
+    // Caller should give dimensions from high resolution to low resolution, as some implementation such as freeimages
     // may cache a generated image for next one
-    std::vector<std::string> generateImagesHelper(const LocalPath& localfilepath, const std::vector<Dimension>& dimensions);
+    std::vector<std::string> generateImagesHelper(IGfxProvider* provider, const LocalPath& localfilepath, const std::vector<Dimension>& dimensions);
 
     // Caller should give dimensions from high resolution to low resolution
     std::vector<std::string> generateImages(const LocalPath& localfilepath, const std::vector<Dimension>& dimensions);
@@ -151,7 +202,10 @@ public:
     // handle is uploadhandle or nodehandle
     // - must respect JPEG EXIF rotation tag
     // - must save at 85% quality (120*120 pixel result: ~4 KB)
-    int gendimensionsputfa(FileAccess*, const LocalPath&, NodeOrUploadHandle, SymmCipher*, int missingattr);
+    // Jobs for an existing node (attribute restoration) run in the background
+    // lane, behind jobs an active upload is waiting on. A cancelled token
+    // makes the job skip decoding and complete as failed.
+    int gendimensionsputfa(FileAccess*, const LocalPath&, NodeOrUploadHandle, SymmCipher*, int missingattr, CancelToken cancelToken = CancelToken());
 
     // FIXME: read dynamically from API server
     typedef enum { THUMBNAIL, PREVIEW } meta_t;
@@ -167,12 +221,22 @@ public:
     
     MegaClient* client;
 
-    // start a thread that will do the processing
+    // raise or lower the dispatch priority of queued jobs for this node
+    // (viewport hint - see MegaClient::setfapriority)
+    void setjobpriority(handle h, bool up);
+
+    // start the threads that will do the processing (one unless a provider
+    // factory and worker count were supplied at construction)
     void startProcessingThread();
 
     // The provided IGfxProvider implements library specific image processing
     // Thread safety among IGfxProvider methods is guaranteed by GfxProc
     GfxProc(std::unique_ptr<IGfxProvider>);
+
+    // pool variant: each worker beyond the first gets its own provider from
+    // 'providerFactory' and keeps it confined to that thread for its lifetime
+    GfxProc(std::unique_ptr<IGfxProvider>, std::function<std::unique_ptr<IGfxProvider>()> providerFactory, unsigned workerCount);
+
     virtual ~GfxProc();
 };
 } // namespace
@@ -33,6 +33,13 @@ namespace mega {
 class GfxProviderExternal : public IGfxProvider
 {
     MegaGfxProcessor *processor;
+    bool ownprocessor;
+
+    // consecutive images the processor accepted but then failed to deliver;
+    // at MAXFAILURES the instance is presumed wedged and replaced with a
+    // fresh one from MegaGfxProcessor::createProcessor (when implemented)
+    unsigned failures;
+    static const unsigned MAXFAILURES = 16;
 
     bool readbitmap(FileSystemAccess*, const LocalPath&, int) override;
     bool resizebitmap(int, int, string* result) override;
@@ -42,8 +49,10 @@ class GfxProviderExternal : public IGfxProvider
     const char* supportedvideoformats() override;
 public:
     GfxProviderExternal();
+    ~GfxProviderExternal();
     bool isgfx(string*);
     void setProcessor(MegaGfxProcessor *processor);
+    void setOwnedProcessor(MegaGfxProcessor *processor);
 };
 } // namespace
 
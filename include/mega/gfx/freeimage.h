@@ -44,9 +44,13 @@ class MEGA_API GfxProviderFreeImage : public IGfxProvider
 
 public:
     bool readbitmap(FileSystemAccess*, const LocalPath&, int) override;
+    bool readbitmapmem(const byte*, size_t) override;
     bool resizebitmap(int, int, string*) override;
     void freebitmap() override;
 
+    void setrenderbudget(unsigned ms) override { renderbudgetms = ms; }
+    bool partialrender() override { return lastrenderpartial; }
+
     const char* supportedformats() override;
     const char* supportedvideoformats() override;
 
@@ -56,6 +60,12 @@ public:
 protected:
 
     string sformats;
+
+    // wall-clock cap applied to PDF page rendering (0 = no cap), and whether
+    // the last readbitmap gave up early because of it
+    unsigned renderbudgetms = 0;
+    bool lastrenderpartial = false;
+
     bool readbitmapFreeimage(FileSystemAccess*, const LocalPath&, int);
 
 #if defined(HAVE_FFMPEG)  || defined(HAVE_PDFIUM)
@@ -46,11 +46,15 @@ public:
     // BGRA format, 4 bytes per pixel (32bits), byte order: blue, green, red, alpha.
     // init() is called internally if library is not initialized.
     // workingDirFolder : Path to create a temporary file.
-    static unique_ptr<char[]> readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa, const LocalPath &workingDirFolder);
+    // budgetms caps the wall-clock render time (0 = no cap); if it runs out, the
+    // page content finished so far is returned and *partialrender is set.
+    static unique_ptr<char[]> readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa, const LocalPath &workingDirFolder, unsigned budgetms = 0, bool* partialrender = nullptr);
 #else
     // Returns a bitmap in BGRA format, 4 bytes per pixel (32bits), byte order: blue, green, red, alpha.
     // init() is called internally if library is not initialized.
-    static unique_ptr<char[]> readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa);
+    // budgetms caps the wall-clock render time (0 = no cap); if it runs out, the
+    // page content finished so far is returned and *partialrender is set.
+    static unique_ptr<char[]> readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa, unsigned budgetms = 0, bool* partialrender = nullptr);
 #endif
     // It decreases the initializations internal counter and destroys the library once it reaches zero.
     static void destroy();
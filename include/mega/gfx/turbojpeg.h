@@ -0,0 +1,57 @@
+/**
+ * @file turbojpeg.h
+ * @brief Accelerated JPEG decoding on top of the FreeImage graphics layer
+ *
+ * (c) 2014 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#if defined(USE_FREEIMAGE) && defined(HAVE_TURBOJPEG)
+#ifndef GFX_TURBOJPEG_H
+#define GFX_TURBOJPEG_H 1
+
+#include "mega/gfx/freeimage.h"
+
+namespace mega {
+
+// JPEG decoding through libjpeg-turbo's TurboJPEG API: SIMD colour conversion
+// and IDCT-domain downscaling make it much cheaper than FreeImage's libjpeg
+// path, which matters for camera-roll thumbnailing on battery. Every other
+// format, plus resizing and JPEG encoding, is inherited from
+// GfxProviderFreeImage, and any JPEG this decoder rejects falls back to that
+// path per image.
+class MEGA_API GfxProviderTurboJpeg : public GfxProviderFreeImage
+{
+public:
+    bool readbitmap(FileSystemAccess*, const LocalPath&, int) override;
+    bool readbitmapmem(const byte*, size_t) override;
+
+    GfxProviderTurboJpeg();
+    ~GfxProviderTurboJpeg();
+
+private:
+    // decode a JPEG held in memory into 'dib', scaled no smaller than the size
+    // hint and corrected for its EXIF orientation; false leaves 'dib' unset
+    bool decodejpeg(const byte* data, size_t len, int size);
+
+    // TurboJPEG decompressor instance (tjhandle); NULL if initialization
+    // failed, in which case everything runs on the inherited decoder
+    void* decoder;
+};
+} // namespace
+
+#endif
+#endif
@@ -99,6 +99,10 @@ public:
     bool operator==(const BackupInfoSync& o) const;
     bool operator!=(const BackupInfoSync& o) const;
 
+    // cheap change check against the live config, so the per-beat path only
+    // constructs a full BackupInfoSync when something actually changed
+    bool matches(const UnifiedSync& us, bool pauseDown, bool pauseUp) const;
+
 private:
     static CommandBackupPut::SPState calculatePauseActiveState(bool pauseDown, bool pauseUp);
 };
@@ -118,6 +122,21 @@ private:
 
     Syncs& syncs;
 
+    // one pending sphb, gathered during a beat so that all backups cross to
+    // the client thread (and into one cs batch) together
+    struct PendingHeartBeat
+    {
+        handle backupId;
+        HeartBeatSyncInfo::SPHBStatus status;
+        uint8_t progress;
+        uint32_t pendingUps;
+        uint32_t pendingDowns;
+        m_time_t lastAction;
+        handle lastItemUpdated;
+        std::shared_ptr<HeartBeatSyncInfo> hbs;
+    };
+    vector<PendingHeartBeat> mPendingBeats;
+
     void beatBackupInfo(UnifiedSync& us);
 };
 
@@ -23,6 +23,7 @@
 #define MEGA_HTTP_H 1
 
 #include <atomic>
+#include <mutex>
 #include "types.h"
 #include "waiter.h"
 #include "backofftimer.h"
@@ -211,6 +212,76 @@ protected:
     dstime mLastRequestUpdate = 0;
 };
 
+// hierarchical token buckets under a global byte rate cap: each traffic
+// class owns a bucket refilled at its reserved rate and the remainder of
+// the cap refills a shared pool that any class may borrow from.
+// Reservations only bite under contention - an idle class lends its share
+// out, but gets it back within a refill interval once it has traffic again.
+// Without a global cap, reservations are ignored
+class MEGA_API TrafficShaper
+{
+public:
+    // global cap in bytes/s (0 disables shaping)
+    void setcap(m_off_t bps);
+    m_off_t cap() const { return mCap; }
+
+    // reserve a guaranteed share of the cap for one class, in bytes/s
+    void setreserved(trafficclass_t tc, m_off_t bps);
+    m_off_t reserved(trafficclass_t tc) const { return mReserved[tc]; }
+
+    // true if per-class accounting is in effect
+    bool active() const;
+
+    // bytes class tc may transfer right now (own bucket plus shared pool)
+    m_off_t avail(trafficclass_t tc);
+
+    // debit len bytes from class tc, borrowing from the shared pool once
+    // its own bucket is exhausted
+    void consume(trafficclass_t tc, m_off_t len);
+
+private:
+    // top buckets up for the time elapsed since the last refill,
+    // capping bursts at one second's worth of each rate
+    void refill();
+
+    m_off_t mCap = 0;
+    m_off_t mReserved[TRAFFIC_CLASSES] = {};
+    m_off_t mTokens[TRAFFIC_CLASSES] = {};
+    m_off_t mShared = 0;
+    dstime mLastRefill = 0;
+};
+
+// Compact log-scale histogram for latency/throughput samples: 32 octaves of
+// 4 linear sub-buckets each (~12% relative error), constant memory, cheap to
+// record into from transfer hot paths. Values are unitless - the caller picks
+// ms, KB/s, etc.
+class MEGA_API LatencyHistogram
+{
+public:
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return mCount; }
+    uint64_t maxvalue() const { return mMax; }
+
+    // approximate value at percentile p (0..100), 0 if no samples
+    uint64_t percentile(double p) const;
+
+    // "n=<count> p50=<v> p90=<v> p99=<v> max=<v>", empty if no samples
+    std::string report() const;
+
+private:
+    static const int OCTAVES = 32;
+    static const int SUBBUCKETS = 4;
+
+    static int bucketindex(uint64_t value);
+
+    uint64_t mBuckets[OCTAVES * SUBBUCKETS] = {};
+    uint64_t mCount = 0;
+    uint64_t mSum = 0;
+    uint64_t mMax = 0;
+};
+
 extern std::mutex g_APIURL_default_mutex;
 extern string g_APIURL_default;
 extern bool g_disablepkp_default;
@@ -239,6 +310,11 @@ struct MEGA_API HttpIO : public EventTrigger
 
     virtual void disconnect() { }
 
+    // gzip JSON request bodies larger than this before sending, when the
+    // backend supports the Content-Encoding header (0 disables, the default).
+    // Only enable against servers known to accept compressed bodies
+    size_t gzipRequestThreshold = 0;
+
     // track Internet connectivity issues
     dstime noinetds;
     bool inetback;
@@ -300,10 +376,47 @@ struct MEGA_API HttpIO : public EventTrigger
     // get max upload speed
     virtual m_off_t getmaxuploadspeed();
 
+    // per-class token buckets under the global caps, indexed by GET/PUT
+    TrafficShaper trafficshaper[2];
+
+    // reserve a guaranteed share of the global download/upload cap for one
+    // traffic class (0 = best effort); only effective while a cap is set
+    virtual bool setmaxdownloadspeed(trafficclass_t tc, m_off_t bpslimit);
+    virtual bool setmaxuploadspeed(trafficclass_t tc, m_off_t bpslimit);
+
+    // get the reserved share for one traffic class
+    virtual m_off_t getmaxdownloadspeed(trafficclass_t tc);
+    virtual m_off_t getmaxuploadspeed(trafficclass_t tc);
+
+    // kernel-level tuning applied to each newly created transfer socket.
+    // Zero/empty fields leave the corresponding OS default untouched
+    struct SocketTuning
+    {
+        int rcvbuf = 0;          // SO_RCVBUF, bytes
+        int sndbuf = 0;          // SO_SNDBUF, bytes
+        int notsentlowat = 0;    // TCP_NOTSENT_LOWAT, bytes (where the platform supports it)
+        string congestionalg;    // TCP_CONGESTION algorithm name, eg. "bbr" (Linux only)
+    };
+
+    // set/read the socket tuning; synchronized because backends apply it
+    // from their socket callbacks on the network thread
+    void setsockettuning(const SocketTuning& tuning);
+    SocketTuning getsockettuning();
+
     virtual bool cacheresolvedurls(const std::vector<string>&, std::vector<string>&&) { return false; }
 
+    // export the backend's resolver cache for cross-session persistence
+    virtual bool exportdnscache(string*) { return false; }
+
+    // seed the resolver cache with a blob exported by an earlier session
+    virtual void importdnscache(const string&) {}
+
     HttpIO();
     virtual ~HttpIO() { }
+
+private:
+    SocketTuning sockettuning;
+    std::mutex sockettuningmutex;
 };
 
 // outgoing HTTP request
@@ -322,6 +435,9 @@ struct MEGA_API HttpReq
 
     bool protect; // check pinned public key
     bool minspeed;
+
+    // traffic class this request's payload is accounted against
+    trafficclass_t trafficclass = TRAFFIC_MANUAL;
     bool mExpectRedirect = false;
     bool mChunked = false;
 
@@ -339,12 +455,24 @@ struct MEGA_API HttpReq
     // if the out payload includes a fetch nodes command
     bool includesFetchingNodes = false;
 
+    // the body in 'out' has been gzip-compressed; the backend must send a
+    // matching Content-Encoding header
+    bool outgzipped = false;
+
+    // gzip-compress the body in 'out' in place and set outgzipped.
+    // Leaves the body untouched if compression does not shrink it
+    void gzipRequestBody();
+
     byte* buf;
     m_off_t buflen, bufpos, notifiedbufpos;
 
     // When did a post() start
     std::chrono::steady_clock::time_point postStartTime;
 
+    // when the first response payload byte arrived (time-to-first-byte),
+    // default-initialized until then
+    std::chrono::steady_clock::time_point firstByteTime;
+
     // we assume that API responses are smaller than 4 GB
     m_off_t contentlength;
 
@@ -399,6 +527,7 @@ struct MEGA_API HttpReq
 
     private:
         byte* buf;
+        size_t accounted;   // bytes registered against MEM_TRANSFERBUFFERS for this buffer
     };
 
     // give up ownership of the buffer for client to use.  The caller is the new owner of the http_buf_t, and the HttpReq no longer has the buffer or any info about it.
@@ -407,6 +536,9 @@ struct MEGA_API HttpReq
     // set amount of purgeable data at 0
     void purge(size_t);
 
+    // apply any deferred purge, so HttpReq::in can be accessed directly again
+    void flushinpurge();
+
     // set response content length
     void setcontentlength(m_off_t);
 
@@ -477,6 +609,11 @@ public:
     // len must be < 2^31
     virtual byte* nextbuffer(unsigned datasize) = 0;
 
+    // optionally supplies a separate read-only source of the plaintext to encrypt into
+    // the buffer returned by nextbuffer().  Unlike nextbuffer(), the source does not
+    // need NUL padding - the final partial block is padded during encryption.
+    virtual const byte* nextsource(unsigned) { return NULL; }
+
     bool encrypt(m_off_t pos, m_off_t npos, string& urlSuffix);
 
 private:
@@ -498,6 +635,18 @@ public:
     EncryptBufferByChunks(byte* b, SymmCipher* k, chunkmac_map* m, uint64_t iv);
 };
 
+class MEGA_API EncryptMappedByChunks : public EncryptBufferByChunks
+{
+    // specialisation for encrypting from a read-only source (e.g. a memory-mapped
+    // file) into a separate contiguous output buffer
+    const byte* srcstart;
+
+    const byte* nextsource(unsigned bufsize) override;
+
+public:
+    EncryptMappedByChunks(const byte* src, byte* dst, SymmCipher* k, chunkmac_map* m, uint64_t iv);
+};
+
 // file chunk I/O
 struct MEGA_API HttpReqXfer : public HttpReq
 {
@@ -513,6 +662,11 @@ struct MEGA_API HttpReqUL : public HttpReqXfer
 {
     chunkmac_map mChunkmacs;
 
+    // when set, prepare() encrypts straight from this read-only source (a file
+    // mapping kept alive by the pointer) into out, instead of expecting the
+    // padded plaintext to have been read into out beforehand
+    std::shared_ptr<const byte> mMappedSource;
+
     void prepare(const char*, SymmCipher*, uint64_t, m_off_t, m_off_t);
 
     m_off_t transferred(MegaClient*);
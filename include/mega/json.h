@@ -24,6 +24,9 @@
 
 #include "types.h"
 
+#include <atomic>
+#include <string_view>
+
 namespace mega {
 
 // linear non-strict JSON scanner
@@ -54,6 +57,10 @@ struct MEGA_API JSON
     double getfloat();
     const char* getvalue();
 
+    // like getvalue(), but with the length included, sparing consumers the
+    // rescan for the closing quote; same lifetime caveats as getvalue()
+    std::string_view getvalueview();
+
     std::uint64_t getfsfp();
     uint64_t getuint64();
 
@@ -68,6 +75,10 @@ public:
     string getname();
     string getnameWithoutAdvance() const;
 
+    // in-place variant for hot parse loops: 'name' is cleared and refilled,
+    // reusing its existing capacity instead of returning a fresh string
+    void getnameWithoutAdvance(string& name) const;
+
     bool is(const char*);
 
     int storebinary(byte*, int);
@@ -87,10 +98,19 @@ public:
     bool storeKeyValueFromObject(string& key, string& value);
 
     bool storeobject(string* = NULL);
+
+    // non-owning storeobject(): on success, 'v' spans the value's raw bytes
+    // in the parse buffer (quotes stripped, escapes untouched), so the caller
+    // must not outlive the buffer. v.data() stays NULL if nothing was stored
+    bool storeobject(std::string_view& v);
     bool skipnullvalue();
 
     static void unescape(string*);
 
+    // position of the next '"', '\\' or NUL at or after p; scans 16 bytes at
+    // a time (SSE2/NEON) where available. The workhorse under storeobject()
+    static const char* strscan(const char* p);
+
     /**
      * @brief Extract a string value for a name in a JSON string
      * @param json JSON string to check
@@ -110,6 +130,7 @@ public:
 
     // copy JSON-delimited string
     static void copystring(string*, const char*);
+    static void copystring(string*, std::string_view);
 
     // Strip whitspace from a string in a JSON-safe manner.
     static string stripWhitespace(const string& text);
@@ -166,6 +187,14 @@ public:
     size_t size() const;
     void clear() { mJson.clear(); }
 
+    // pre-grow the buffer, e.g. to an externally computed exact size
+    void reserve(size_t n) { mJson.reserve(n); }
+
+    // feed back the size of a completed command body; newly constructed
+    // writers reserve to a rolling average of these, so typical commands
+    // build up without reallocating
+    static void noteFinalSize(size_t n);
+
 protected:
     string escape(const char* data, size_t length) const;
 
@@ -174,6 +203,9 @@ private:
 
     int elements();
 
+    // rolling average command body size, maintained by noteFinalSize()
+    static std::atomic<size_t> mSizeHint;
+
     string mJson;
     std::array<signed char, MAXDEPTH> mLevels;
     signed char mLevel;
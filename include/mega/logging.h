@@ -92,11 +92,14 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 // define MEGA_QT_LOGGING to support QString
@@ -786,6 +789,65 @@ public:
 };
 
 
+class AsyncRingLogger : public Logger
+{
+    // A bounded ring buffer adapter decoupling log call sites from the output sink.
+    // log() copies the finished line into a slot and returns; a dedicated drain thread
+    // forwards slots to the wrapped logger, so the downstream mutexes and file/callback
+    // I/O never run on the thread that produced the message (eg. a transfer thread at
+    // debug level).  Producers claim slots with per-slot sequence counters and never
+    // block: when the ring is full the message is dropped and counted, and the count
+    // is reported through the sink once the drain catches up.
+
+public:
+
+    // capacity is rounded up to the next power of two
+    AsyncRingLogger(Logger* sink, size_t capacity = 4096);
+    ~AsyncRingLogger() override;
+
+    void log(const char *time, int loglevel, const char *source, const char *message
+#ifdef ENABLE_LOG_PERFORMANCE
+        , const char **directMessages, size_t *directMessagesSizes, unsigned numberMessages
+#endif
+    ) override;
+
+    // block until every message accepted so far has reached the sink
+    void flush();
+
+    // messages discarded because the ring was full
+    uint64_t droppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> mSequence{0};
+        int mLevel = 0;
+        std::string mTime;
+        std::string mSource;
+        std::string mMessage;
+    };
+
+    bool enqueue(const char* time, int loglevel, const char* source, std::string&& message);
+    void drainLoop();
+
+    Logger* mSink;
+    std::unique_ptr<Slot[]> mSlots;
+    size_t mSlotMask;
+    std::atomic<uint64_t> mEnqueuePos{0};
+    std::atomic<uint64_t> mDequeuePos{0};
+    std::atomic<uint64_t> mDropped{0};
+    uint64_t mDroppedReported = 0;
+
+    // the drain thread only takes this mutex to sleep when the ring is empty, and
+    // producers only take it to wake it - the ring itself is not protected by it
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCV;
+    std::atomic<bool> mDrainSleeping{false};
+    std::atomic<bool> mExit{false};
+    std::thread mDrainThread;
+};
+
+
 // This used to be a static member of MegaApi_impl
 // However, megacli could not use or test it from there since it
 // uses the SDK core directly, and not the intermediate layer
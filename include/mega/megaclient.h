@@ -33,6 +33,7 @@
 #include "account.h"
 #include "backofftimer.h"
 #include "http.h"
+#include "fileattributefetch.h"
 #include "pubkeyaction.h"
 #include "pendingcontactrequest.h"
 #include "mediafileattribute.h"
@@ -42,6 +43,7 @@
 #include "drivenotify.h"
 #include "setandelement.h"
 #include "nodemanager.h"
+#include "stallsampler.h"
 
 namespace mega {
 
@@ -234,6 +236,15 @@ public:
     static ScDbStateRecord unserialize(const std::string& data);
 };
 
+// statusTable record carrying the HTTP backend's resolver cache between sessions
+class DnsCacheRecord : public Cacheable
+{
+public:
+    string blob;
+
+    bool serialize(string* data) const override;
+};
+
 // Class to help with upload of file attributes
 struct UploadWaitingForFileAttributes
 {
@@ -486,6 +497,78 @@ private:
 };
 
 
+// Capped LRU of already-unwrapped node keys, keyed by handle. Node objects
+// are evictable from RAM, and a node reloaded from DB before its unwrapped
+// key was persisted would otherwise redo the share-key resolution and AES
+// unwrap in applykey(). Browsing, transfer and streaming paths all funnel
+// through applykey(), so this one cache covers them all.
+class MEGA_API UnwrappedKeyCache
+{
+public:
+    // remember the unwrapped key for this handle (refreshes LRU position)
+    void put(NodeHandle h, const string& unwrappedKey)
+    {
+        auto it = mByHandle.find(h);
+        if (it != mByHandle.end())
+        {
+            it->second->second = unwrappedKey;
+            mEntries.splice(mEntries.begin(), mEntries, it->second);
+            return;
+        }
+
+        if (mByHandle.size() >= MAXENTRIES)
+        {
+            mByHandle.erase(mEntries.back().first);
+            mEntries.pop_back();
+        }
+
+        mEntries.emplace_front(h, unwrappedKey);
+        mByHandle[h] = mEntries.begin();
+    }
+
+    // true on a hit, with the key copied into 'unwrappedKey'
+    bool get(NodeHandle h, string& unwrappedKey)
+    {
+        auto it = mByHandle.find(h);
+        if (it == mByHandle.end())
+        {
+            return false;
+        }
+
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        unwrappedKey = it->second->second;
+        return true;
+    }
+
+    void erase(NodeHandle h)
+    {
+        auto it = mByHandle.find(h);
+        if (it != mByHandle.end())
+        {
+            mEntries.erase(it->second);
+            mByHandle.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        mEntries.clear();
+        mByHandle.clear();
+    }
+
+    size_t size() const { return mByHandle.size(); }
+
+private:
+    // at FILENODEKEYLENGTH bytes plus bookkeeping per entry, the worst
+    // case stays within a few MB
+    static const size_t MAXENTRIES = 16384;
+
+    // MRU first
+    std::list<std::pair<NodeHandle, string>> mEntries;
+    std::map<NodeHandle, std::list<std::pair<NodeHandle, string>>::iterator> mByHandle;
+};
+
+
 class MEGA_API MegaClient
 {
 public:
@@ -824,6 +907,10 @@ public:
     // queue file attribute retrieval
     error getfa(handle h, string *fileattrstring, const string &nodekey, fatype, int = 0);
 
+    // raise or lower the dispatch priority of this node's pending attribute
+    // fetches and thumbnail generation jobs (app viewport hint)
+    void setfapriority(handle h, bool up);
+
     // notify delayed upload completion subsystem about new file attribute
     void checkfacompletion(UploadHandle, Transfer* = NULL, bool uploadCompleted = false);
 
@@ -840,6 +927,9 @@ public:
     // queue a user attribute retrieval (for non-contacts)
     void getua(const char* email_handle, const attr_t at = ATTR_UNKNOWN, const char *ph = NULL, int ctag = -1, CommandGetUA::CompletionErr ce = nullptr, CommandGetUA::CompletionBytes cb = nullptr, CommandGetUA::CompletionTLV ctlv = nullptr);
 
+    // silently warm the attribute cache for all visible contacts in one batched request
+    void prefetchContactAttributes();
+
     // retrieve the email address of a user
     void getUserEmail(const char *uid);
 
@@ -1216,6 +1306,13 @@ public:
     // get max upload speed
     m_off_t getmaxuploadspeed();
 
+    // reserve a share of the global caps for one traffic class
+    bool setmaxdownloadspeed(trafficclass_t tc, m_off_t bpslimit);
+    bool setmaxuploadspeed(trafficclass_t tc, m_off_t bpslimit);
+
+    // tune kernel buffers and congestion control for new transfer sockets
+    void setsockettuning(int rcvbuf, int sndbuf, const char* congestionalg, int notsentlowat);
+
     // get the handle of the older version for a NewNode
     std::shared_ptr<Node> getovnode(Node *parent, string *name);
 
@@ -1436,6 +1533,10 @@ public:
     // maximum number of concurrent putfa
     static const int MAXPUTFA;
 
+    // maximum number of putfa upload URL requests activated together; they
+    // coalesce into a single batched API request for the whole burst
+    static const int MAXPUTFABATCH;
+
     // update time at which next deferred transfer retry kicks in
     void nexttransferretry(direction_t d, dstime*);
 
@@ -1604,6 +1705,12 @@ public:
     // set true after fetchnodes and catching up on actionpackets, stays true after that.
     bool statecurrent;
 
+    // true while the initial load or the actionpacket backlog replay after resuming a cached
+    // session is in progress: per-batch listener notifications are withheld (the internal purge
+    // and DB work still runs per batch), and the existing consolidated "notify all elements"
+    // pass when the tree becomes current surfaces the final state in one go
+    bool catchingUpOnActionpackets() const { return fetchingnodes || !statecurrent; }
+
     // actionpackets are up to date (similar to statecurrent but false if in the middle of spoonfeeding etc)
     bool actionpacketsCurrent;
 
@@ -1640,7 +1747,7 @@ public:
     void persistAlert(UserAlert::Base* a);
 
     // record type indicator for statusTable
-    enum StatusTableRecType { CACHEDSTATUS };
+    enum StatusTableRecType { CACHEDSTATUS, CACHEDDNS };
 
     // open/create "statecache" and "nodes" tables in DB
     void opensctable();
@@ -1657,6 +1764,9 @@ public:
     // truncates status table
     void initStatusTable();
 
+    // persist the resolver cache so the next session skips initial DNS resolution
+    void savednscache();
+
     // flag to pause / resume the processing of action packets
     bool scpaused;
 
@@ -1673,11 +1783,35 @@ public:
     // records last seqTag, with allowance for future fields also
     ScDbStateRecord mScDbStateRecord;
 
+    // last resolver cache snapshot saved to (or loaded from) statusTable
+    DnsCacheRecord mDnsCacheRecord;
+
     // Server-MegaClient request JSON and processing state flag ("processing a element")
     JSON jsonsc;
     bool insca;
     bool insca_notlast;
 
+    // recycled string temporaries for the sc/readnodes parse loops; each leaf
+    // parser resets it on entry, so nothing parsed there survives the call
+    ScratchStrings mParseScratch;
+
+    // when the sc response currently being processed arrived off the wire;
+    // the scArrivalTo* histograms measure how stale the app's view is by the
+    // time its packets are parsed, notified and delivered
+    std::chrono::steady_clock::time_point mScResponseArrival;
+
+    // time slice budget per exec() phase, in milliseconds
+    static const unsigned EXECSLICEMS = 100;
+
+    // cooperative time slice shared by the resumable exec() phases
+    // (actionpacket processing, transfer dispatch); phases that cannot be
+    // split keep their own local budget and only account overruns
+    TimeSliceBudget mExecSlice;
+
+    // set when a phase ran out of slice and yielded: the next preparewait()
+    // resumes immediately instead of sleeping
+    bool mExecSliceYielded = false;
+
     // no two interrelated client instances should ever have the same sessionid
     char sessionid[10];
 
@@ -1699,6 +1833,10 @@ public:
     // map is cleared upon call to mergenewshares(), and used only temporary during `f` command.
     std::map<NodeHandle, std::vector<byte>> mNewKeyRepository;
 
+    // unwrapped node keys that outlive the Node objects they were
+    // unwrapped for; consulted and refilled by Node::applykey()
+    UnwrappedKeyCache mUnwrappedNodeKeys;
+
     // current request tag
     int reqtag;
 
@@ -1709,12 +1847,27 @@ public:
     // mapping of pending contact handles to their structure
     handlepcr_map pcrindex;
 
+    // secondary index over pcrindex: target e-mail of outgoing requests to
+    // their id, so command responses that only carry the e-mail don't have
+    // to scan every standing request
+    map<string, handle> mPcrByTargetEmail;
+
     // A record of which file attributes are needed (or now available) per upload transfer
     FileAttributesPending fileAttributesUploading;
 
     // file attribute fetch channels
     fafc_map fafcs;
 
+    // recency counter for file attribute fetches (newest dispatch first)
+    unsigned fafseqno = 0;
+
+    // nodes whose imagery the app wants served first (viewport hint)
+    handle_set fapriority;
+
+    // durable local store of fetched/uploaded file attributes, consulted
+    // before any faf channel request goes out
+    FileAttributeCache facache;
+
     // generate attribute string based on the pending attributes for this upload
     void pendingattrstring(UploadHandle, string*);
 
@@ -1782,6 +1935,11 @@ public:
     handle_vector nodekeyrewrite;
     handle_vector sharekeyrewrite;
 
+    // maximum number of key rewrites per "k" command (larger rotations are
+    // split into multiple commands so request batches stay bounded and a
+    // retry never resends the whole rotation)
+    static const unsigned MAXKEYREWRITESPERCOMMAND = 1000;
+
     static const char* const EXPORTEDLINK;
 
     // default number of seconds to wait after a bandwidth overquota
@@ -1938,6 +2096,10 @@ public:
 
     void freeq(direction_t);
 
+    // user-attribute fetches currently in flight, so identical concurrent
+    // requests coalesce onto one command (maintained by CommandGetUA)
+    map<string, CommandGetUA*> mPendingGetUA;
+
     // client-server request double-buffering
     RequestDispatcher reqs;
 
@@ -2091,6 +2253,10 @@ public:
     // send andy key rewrites prepared when keys were applied
     void sendkeyrewrites();
 
+    // re-encrypt the queued handles' keys under the master key (in parallel
+    // for large rotations) and emit them as chunked "k" commands
+    void sendkeyrewrites(handle_vector& v, bool sharekeys);
+
     // symmetric password challenge
     int checktsid(byte* sidbuf, unsigned len);
 
@@ -2106,11 +2272,23 @@ public:
 
     PendingContactRequest* findpcr(handle);
 
+    // locate an outgoing pending contact request by its target e-mail
+    PendingContactRequest* findpcrbyemail(const string& targetemail);
+
+    // keep mPcrByTargetEmail in lockstep with pcrindex
+    void indexpcr(PendingContactRequest*);
+    void unindexpcr(PendingContactRequest*);
+
     // queue public key request for user
     User *getUserForSharing(const char *uid);
     void queuepubkeyreq(User*, std::unique_ptr<PubKeyAction>);
     void queuepubkeyreq(const char*, std::unique_ptr<PubKeyAction>);
 
+    // RSA public keys fetched for non-contact sharing targets, kept so repeated
+    // shares to the same target don't refetch.  (Contacts don't need this: their
+    // User record, including pubk, is persisted in the state cache.)
+    map<string, AsymmCipher> mTempUserPubKeyCache;
+
     // rewrite foreign keys of the node (tree)
     void rewriteforeignkeys(std::shared_ptr<Node> n);
 
@@ -2145,7 +2323,7 @@ public:
     bool isValidFolderLink();
 
     //returns the top-level node for a node
-    shared_ptr<Node> getrootnode(shared_ptr<Node>);
+    shared_ptr<Node> getrootnode(const shared_ptr<Node>&);
 
     //returns true if the node referenced by the handle belongs to the logged-in account
     bool isPrivateNode(NodeHandle h);
@@ -2235,6 +2413,10 @@ public:
     // true if user has disabled fileversioning
     bool versions_disabled;
 
+    // defer parsing node attributes until they are first read (saves CPU and RAM
+    // during fetchnodes on large accounts; attributes resolve on access)
+    bool mLazyAttrDecryption = false;
+
     // the SDK is trying to log out
     int loggingout = 0;
 
@@ -2295,12 +2477,38 @@ public:
 #endif
         uint64_t transferStarts = 0, transferFinishes = 0;
         uint64_t transferTempErrors = 0, transferFails = 0;
+        uint64_t raidConnSwitchesSlowStart = 0, raidConnSwitchesSlowness = 0, raidConnSwitchesError = 0;
+        uint64_t execSliceYields = 0, execSliceOverruns = 0;
         uint64_t prepwaitImmediate = 0, prepwaitZero = 0, prepwaitHttpio = 0, prepwaitFsaccess = 0, nonzeroWait = 0;
         CodeCounter::DurationSum csRequestWaitTime;
         CodeCounter::DurationSum transfersActiveTime;
+
+        // session-wide transfer histograms, merged from each TransferSlot:
+        // chunk service time (ms), time-to-first-byte (ms), chunk throughput
+        // per connection (KB/s)
+        LatencyHistogram transferChunkLatency;
+        LatencyHistogram transferTimeToFirstByte;
+        LatencyHistogram transferConnThroughput;
+
+        // actionpacket pipeline staleness (ms), all measured from sc response
+        // arrival: to each packet being applied, to a notify phase starting,
+        // and to the response being fully parsed and delivered to listeners.
+        // scBytesAtArrival sizes the responses themselves, so catch-up
+        // backlogs show up in the distribution.
+        LatencyHistogram scArrivalToParse;
+        LatencyHistogram scArrivalToNotify;
+        LatencyHistogram scArrivalToDelivery;
+        LatencyHistogram scBytesAtArrival;
         std::string report(bool reset, HttpIO* httpio, Waiter* waiter, const RequestDispatcher& reqs);
     } performanceStats;
 
+    // why and how long each endpoint has been backing off
+    RetryTelemetry retryTelemetry;
+
+    // recent exec() pass durations with phase attribution, for watchdog/ANR
+    // reporters; sampled in release builds too
+    StallSampler stallSampler;
+
     std::string getDeviceidHash();
 
     /**
@@ -2386,6 +2594,24 @@ private:
 
     static vector<byte> deriveKey(const char* password, const string& salt, size_t derivedKeySize);
 
+    // memoizing wrapper around deriveKey(): repeated checks of the same
+    // password in one session (kiosk unlock, per-operation confirmation)
+    // skip the full 100000-iteration PBKDF2.  Entries are keyed by an HMAC
+    // of the password under a random per-session pepper, so no
+    // fast-verifiable password digest is retained; the cache is wiped on
+    // logout along with the rest of the session state
+    vector<byte> deriveKeyCached(const char* password, const string& salt, size_t derivedKeySize);
+
+    struct CachedDerivedKey
+    {
+        string hmac;
+        string salt;
+        size_t keySize;
+        vector<byte> key;
+    };
+    std::vector<CachedDerivedKey> mDerivedKeyCache;
+    string mDerivedKeyPepper;
+
 //
 // JourneyID and ViewID
 //
@@ -2502,7 +2728,7 @@ private:
     error readElement(JSON& j, SetElement& el);
     error readAllNodeMetadata(JSON& j, map<handle, SetElement::NodeMetadata>& nodes);
     error readSingleNodeMetadata(JSON& j, SetElement::NodeMetadata& node);
-    bool decryptNodeMetadata(SetElement::NodeMetadata& nodeMeta, const string& key);
+    static bool decryptNodeMetadata(SetElement::NodeMetadata& nodeMeta, const string& key, SymmCipher& cipher);
     error readExportedSet(JSON& j, Set& s, pair<bool, m_off_t>& exportRemoved);
     error readSetsPublicHandles(JSON& j, map<handle, Set>& sets);
     error readSetPublicHandle(JSON& j, map<handle, Set>& sets);
@@ -2510,8 +2736,11 @@ private:
     size_t decryptAllSets(map<handle, Set>& newSets, map<handle, elementsmap_t>& newElements, map<handle, SetElement::NodeMetadata>* nodeData);
     error decryptSetData(Set& s);
     error decryptElementData(SetElement& el, const string& setKey);
-    string decryptKey(const string& k, SymmCipher& cipher) const;
+    // cipher-explicit variant, safe to run on a worker thread against distinct Elements
+    static error decryptElementData(SetElement& el, const string& setKey, SymmCipher& cipher);
+    static string decryptKey(const string& k, SymmCipher& cipher);
     bool decryptAttrs(const string& attrs, const string& decrKey, string_map& output);
+    static bool decryptAttrs(const string& attrs, const string& decrKey, string_map& output, SymmCipher& cipher);
     string encryptAttrs(const string_map& attrs, const string& encryptionKey);
 
     void sc_asp(); // AP after new or updated Set
@@ -148,7 +148,14 @@ private:
     NodeManager& mNodeManager;
     weak_ptr<Node> mNode;
 };
-typedef std::map<NodeHandle, NodeManagerNode>::iterator NodePosition;
+// Tree nodes of the handle -> NodeManagerNode map come from a FixedBlockPool,
+// so the map can be pre-carved from the statecache row count and steady-state
+// inserts stay off the system allocator. It must remain a node-based map:
+// Node::mNodePosition stores iterators into it, which have to survive
+// unrelated inserts and erases.
+typedef std::map<NodeHandle, NodeManagerNode, std::less<NodeHandle>,
+                 PooledAllocator<std::pair<const NodeHandle, NodeManagerNode>>> nodemanagernode_map;
+typedef nodemanagernode_map::iterator NodePosition;
 
 struct CommandChain
 {
@@ -229,8 +236,21 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
     // Node's depth, counting from the cloud root.
     unsigned depth() const;
 
-    // try to resolve node key string
-    bool applykey();
+    // try to resolve node key string. With 'deferAttrDecryption' the key is
+    // checked against the attribute blob but the attributes are not parsed:
+    // that is left for ensureAttrsDecrypted() to do when they are first needed
+    bool applykey(bool deferAttrDecryption = false);
+
+    // locate the cipher and the wrapped key text that applykey() would
+    // unwrap; returns NULL when no suitable key is available yet
+    SymmCipher* resolveKeySource(const char*& wrappedKey);
+
+    // adopt an unwrapped node key and decrypt the attributes (the tail of
+    // applykey(), split out so unwraps can run on worker threads)
+    void commitUnwrappedKey(const byte* unwrappedKey, unsigned keylength, bool deferAttrDecryption);
+
+    // parse the attributes if applykey() deferred it; no-op otherwise
+    void ensureAttrsDecrypted();
 
     // Returns false if the share key can't correctly decrypt the key and the
     // attributes of the node. Otherwise, it returns true. There are cases in
@@ -349,7 +369,7 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
 
     void setKey(const string& key);
     void setkey(const byte*);
-    void setkeyfromjson(const char*);
+    void setkeyfromjson(std::string_view);
 
     void setfingerprint();
 
@@ -364,6 +384,16 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
     // own position in NodeManager::mFingerPrints (only valid for file nodes)
     // It's used for speeding up node removing at NodeManager::removeFingerprint
     FingerprintPosition mFingerPrintPosition;
+
+    // estimation of the resident memory taken by this node, as accounted by the
+    // LRU cache when the node was inserted (see NodeManager::insertNodeCacheLRU)
+    size_t mRamUsageAtLRU = 0;
+
+    // attrstring holds a validated, still unparsed attribute blob (lazy decryption)
+    bool mPendingAttrDecryption = false;
+
+    // rough estimation of the resident memory taken by this node (heap members included)
+    size_t estimatedRamUsage() const;
     // own position in NodeManager::mNodes. The map can have an element of type NodeManagerNode
     // previously Node exists
     // It's used for speeding up get children when Node parent is known
@@ -549,6 +579,11 @@ struct MEGA_API LocalNode
     // as escapes/case may be involved.
     string toName_of_localname;
 
+    // canonicalNameHash of toName_of_localname, kept in step with it.
+    // Lets computeSyncTriplets order and group sibling rows with O(1)
+    // comparisons instead of re-deriving escapes/case folding per compare.
+    uint64_t mNameHash = 0;
+
     // parent linkage
     LocalNode* parent = nullptr;
 
@@ -556,7 +591,6 @@ struct MEGA_API LocalNode
     localnode_map children;
 
     unique_ptr<LocalPath> cloneShortname() const;
-    localnode_map schildren;
 
     // The last scan of the folder (for folders).
     // Removed again when the folder is fully synced.
@@ -578,6 +612,21 @@ struct MEGA_API LocalNode
     // related cloud node, if any
     nodehandle_localnode_map::iterator syncedCloudNodeHandle_it;
 
+    // Signature of the last completed scan of this folder: the folder's own
+    // mtime as the parent's scan saw it, plus a digest over the entries the
+    // scan returned.  While the signature still holds, a subtree rescan can
+    // reuse the previous results instead of going back to disk.
+    // A zero digest means no usable signature.  Not serialized: the
+    // as-scanned state it vouches for is rebuilt at runtime only.
+    m_time_t scanSigMtime = 0;
+    uint64_t scanSigDigest = 0;
+    dstime scanSigRecordedDs = 0;
+
+    // Signatures are only trusted for so long: edits that leave directory
+    // mtimes untouched (in-place file writes, anything below another pruned
+    // folder) only show up in a real scan, so expiry forces one periodically.
+    static const dstime SCAN_SIGNATURE_TTL_DS = 36000;
+
     // using a per-Localnode scan delay prevents self-notifications delaying the whole sync
     dstime scanDelayUntil = 0;
     unsigned expectedSelfNotificationCount = 0;
@@ -752,6 +801,11 @@ struct MEGA_API LocalNode
         shared_ptr<DeleteToDebrisInProgress> removeNodeHere;
         weak_ptr<UnlinkInProgress> unlinkHere;
 
+        // children by their legacy secondary ("short") names.  Shortnames
+        // only occur on a few legacy filesystems, so most parents never
+        // populate this; keeping it here saves a map per LocalNode.
+        localnode_map schildren;
+
         // Filter rules applicable below this node.
         unique_ptr<FilterChain> filterChain;
 
@@ -792,6 +846,14 @@ struct MEGA_API LocalNode
     // Also receive the results if they are ready
     bool processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath);
 
+    // True if this folder's recorded scan signature still matches row.fsNode,
+    // so a requested rescan can be satisfied from the previous results
+    bool scanSignatureUnchanged(const SyncRow& row) const;
+
+    // Drop the scan signatures in this subtree, forcing real rescans (eg.
+    // after a notification overflow, when changes may have gone unseen)
+    void clearScanSignatures();
+
     void reassignUnstableFsidsOnceOnly(const FSNode* fsnode);
 
     // current subtree sync state as last notified to OS
@@ -846,6 +908,13 @@ struct MEGA_API LocalNode
     LocalNode(Sync*);
     void init(nodetype_t, LocalNode*, const LocalPath&, std::unique_ptr<LocalPath>);
 
+    // LocalNodes are carved from a pool of identically-sized slots rather
+    // than the general-purpose heap: large trees allocate millions of them,
+    // and the per-allocation header and fragmentation add up to a
+    // significant fraction of sync memory use.
+    void* operator new(size_t size);
+    void operator delete(void* ptr, size_t size);
+
     bool serialize(string*) const override;
     static unique_ptr<LocalNode> unserialize(Sync& sync, const string& source, uint32_t& parentID);
 
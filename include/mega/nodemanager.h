@@ -23,10 +23,13 @@
 #ifndef NODEMANAGER_H
 #define NODEMANAGER_H 1
 
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <limits>
 #include <set>
 #include "node.h"
+#include "nodesnapshot.h"
 #include "types.h"
 
 namespace mega {
@@ -37,6 +40,22 @@ class FingerprintContainer;
 class MegaClient;
 class NodeSerialized;
 
+// Window over a filtered look-up: skip the first 'startingOffset' matches and
+// return at most 'size' of them (0 means no limit). Offsets count positions in
+// the unordered result set, so callers that need a particular order must fetch
+// everything, sort, and window afterwards.
+class NodeSearchPage
+{
+public:
+    NodeSearchPage(size_t startingOffset, size_t size) : mOffset(startingOffset), mSize(size) {}
+    size_t startingOffset() const { return mOffset; }
+    size_t size() const { return mSize; }
+
+private:
+    size_t mOffset;
+    size_t mSize;
+};
+
 class NodeSearchFilter
 {
 public:
@@ -104,6 +123,7 @@ class MEGA_API NodeManager
 {
 public:
     NodeManager(MegaClient& client);
+    ~NodeManager();
 
     // set interface to access to "nodes" table
     void setTable(DBTableNodes *table);
@@ -123,7 +143,7 @@ public:
     // read children from DB and load them in memory
     sharedNode_list getChildren(const Node *parent, CancelToken cancelToken = CancelToken());
 
-    sharedNode_vector getChildren(const NodeSearchFilter& filter, CancelToken cancelFlag);
+    sharedNode_vector getChildren(const NodeSearchFilter& filter, CancelToken cancelFlag, const NodeSearchPage& page = NodeSearchPage(0, 0));
 
     // read children from type (folder or file) from DB and load them in memory
     sharedNode_vector getChildrenFromType(const NodeHandle &parent, nodetype_t type, CancelToken cancelToken);
@@ -154,6 +174,10 @@ public:
     sharedNode_vector getNodesByOrigFingerprint(const std::string& fingerprint, Node *parent);
     std::shared_ptr<Node> getNodeByFingerprint(FileFingerprint &fingerprint);
 
+    // handle-only lookup for "does this file already exist" checks: served from
+    // RAM or the DB fingerprint index, without materializing any node
+    NodeHandle handleByFingerprint(FileFingerprint& fingerprint);
+
     // Return a first level child node whose name matches with 'name'
     // Valid values for nodeType: FILENODE, FOLDERNODE
     // Note: if not found among children loaded in RAM (and not all children are loaded), it will search in DB
@@ -271,6 +295,12 @@ public:
     // Initialize node counters and create indexes at DB
     void initCompleted();
 
+    // Location of the read-only node snapshot sidecar. If a valid snapshot
+    // exists at that path, it's mapped and consulted before sqlite when
+    // loading nodes (see NodeTableSnapshot). The snapshot is rebuilt when
+    // the initial fetch nodes completes
+    void setSnapshotPath(const LocalPath& path);
+
     std::shared_ptr<Node> getNodeFromNodeManagerNode(NodeManagerNode& nodeManagerNode);
 
     void insertNodeCacheLRU(std::shared_ptr<Node> node);
@@ -283,9 +313,34 @@ public:
 
     uint64_t getNumNodesAtCacheLRU() const;
 
+    // byte budget for nodes kept at the LRU cache, in addition to the node-count limit
+    // (estimated memory footprint, see Node::estimatedRamUsage)
+    uint64_t getCacheLRUMaxBytes() const;
+    void setCacheLRUMaxBytes(uint64_t cacheLRUMaxBytes);
+    uint64_t getCacheLRUUsedBytes() const;
+
+    // cache effectiveness counters: a hit is a node served from RAM,
+    // a miss is a node that had to be loaded from DB
+    uint64_t getCacheLRUHits() const;
+    uint64_t getCacheLRUMisses() const;
+
+    // pinned nodes are never evicted from the LRU cache, regardless of the
+    // configured budgets (used while a node is the target of an active
+    // transfer or sync). Pins are counted, so a node can be pinned by
+    // several owners simultaneously
+    void pinNodeToCacheLRU(NodeHandle h);
+    void unpinNodeFromCacheLRU(NodeHandle h);
+
     // true when the filesystem has been initialized
     bool ready();
 
+    // Background prefetch of likely-next folder listings: on getChildren,
+    // the siblings of the expanded folder and the children of its subfolders
+    // are warmed from DB on a worker thread, so subsequent navigations are
+    // served from RAM. Disabled by default
+    void enableChildPrefetch(bool enable);
+    bool childPrefetchEnabled() const;
+
 private:
     MegaClient& mClient;
 
@@ -302,6 +357,17 @@ private:
     // interface to handle accesses to "nodes" table
     DBTableNodes* mTable = nullptr;
 
+    // mmap'ed read-only snapshot of the "nodes" table and where to keep it.
+    // Consulted before sqlite while its tag matches the current scsn
+    NodeTableSnapshot mSnapshot;
+    LocalPath mSnapshotPath;
+
+    // dump the full "nodes" table into the snapshot sidecar and map it
+    void rebuildSnapshot_internal();
+
+    // true if the mapped snapshot (if any) was built at the current scsn
+    bool snapshotIsCurrent() const;
+
     // root nodes (files, vault, rubbish)
     struct Rootnodes
     {
@@ -331,11 +397,22 @@ private:
     };
 
     // Stores nodes that have been loaded in RAM from DB (not necessarily all of them)
-    std::map<NodeHandle, NodeManagerNode> mNodes;
+    nodemanagernode_map mNodes;
 
     uint64_t mCacheLRUMaxSize = std::numeric_limits<uint64_t>::max();
     std::list<std::shared_ptr<Node> > mCacheLRU;
 
+    // memory budget and current estimated usage of the nodes at mCacheLRU
+    uint64_t mCacheLRUMaxBytes = std::numeric_limits<uint64_t>::max();
+    uint64_t mCacheLRUUsedBytes = 0;
+
+    // hit/miss counters for the LRU cache (see getCacheLRUHits/getCacheLRUMisses)
+    std::atomic<uint64_t> mCacheLRUHits{0};
+    std::atomic<uint64_t> mCacheLRUMisses{0};
+
+    // pin counters by handle: nodes with a pin are skipped by unLoadNodeFromCacheLRU
+    std::map<NodeHandle, unsigned> mCacheLRUPinned;
+
     std::atomic<uint64_t> mNodesInRam;
 
     // nodes that have changed and are pending to notify to app and dump to DB
@@ -364,7 +441,7 @@ private:
     shared_ptr<Node> unserializeNode(const string*, bool fromOldCache);
 
     // returns the counter for the specified node, calculating it recursively and accessing to DB if it's neccesary
-    NodeCounter calculateNodeCounter(const NodeHandle &nodehandle, nodetype_t parentType, std::shared_ptr<Node> node, bool isInRubbish);
+    NodeCounter calculateNodeCounter(const NodeHandle &nodehandle, nodetype_t parentType, std::shared_ptr<Node> node, bool isInRubbish, NodeHandle parentHandle = NodeHandle());
 
     // Container storing FileFingerprint* (Node* in practice) ordered by fingerprint
     FingerprintContainer mFingerPrints;
@@ -383,7 +460,7 @@ private:
 
     sharedNode_vector searchNodes_internal(const NodeSearchFilter& filter, CancelToken cancelFlag);
     sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, const NodeSearchFilter& filter, CancelToken cancelFlag = CancelToken());
-    sharedNode_vector getChildren_internal(const NodeSearchFilter& filter, CancelToken cancelFlag);
+    sharedNode_vector getChildren_internal(const NodeSearchFilter& filter, CancelToken cancelFlag, const NodeSearchPage& page);
     sharedNode_vector processUnserializedChildren(const std::vector<std::pair<NodeHandle, NodeSerialized>>& childrenFromTable, const NodeSearchFilter& filter, CancelToken cancelFlag = CancelToken());
 
     // node temporary in memory, which will be removed upon write to DB
@@ -392,6 +469,27 @@ private:
     // Stores (or updates) the node in the DB. It also tries to decrypt it for the last time before storing it.
     void putNodeInDb(Node* node) const;
 
+    // -- columnar node skeleton --
+    // parallel columns of the tree metadata recursive walks need, indexed through
+    // mSkeletonRow. Rows are captured when nodes are written to the DB and memoized
+    // on lookup misses, so counter recomputation over subtrees that are not in RAM
+    // doesn't pay one DB query (and one heap-scattered Node) per node.
+    // mutable: it is a cache, refreshed from the const putNodeInDb() path too
+    struct NodeSkeleton
+    {
+        std::vector<NodeHandle> mHandles;
+        std::vector<NodeHandle> mParents;
+        std::vector<nodetype_t> mTypes;
+        std::vector<m_off_t> mSizes;
+        std::vector<uint64_t> mFlags;
+    };
+    mutable NodeSkeleton mSkeleton;
+    mutable std::map<NodeHandle, size_t> mSkeletonRow;
+
+    void skeletonPutRow(NodeHandle h, NodeHandle parent, nodetype_t type, m_off_t size, uint64_t flags) const;
+    void skeletonRemove(NodeHandle h);
+    bool skeletonGet(NodeHandle h, m_off_t& size, nodetype_t& type, uint64_t& flags) const;
+
     // true when the NodeManager has been inicialized and contains a valid filesystem
     bool mInitialized = false;
 
@@ -404,6 +502,33 @@ private:
     // We would use a non-recursive mutex for more precise control, and to make sure we can unlock
     // it when we need to make callbacks to the app.
     // It's quite a verbose approach, but at least simple, easy to understand, and easy to get right.
+    // -- background child prefetcher --
+
+    // bounded queue of parent handles whose children should be warmed
+    std::deque<NodeHandle> mPrefetchQueue;
+    std::mutex mPrefetchMutex;
+    std::condition_variable mPrefetchCV;
+    std::thread mPrefetchThread;
+    std::atomic<bool> mPrefetchEnabled{false};
+    bool mPrefetchStop = false;
+
+    // max number of pending prefetch targets; older entries are dropped first
+    static constexpr size_t MAX_PREFETCH_QUEUE = 64;
+
+    // batches of pending node keys at least this big have their AES unwraps
+    // run on the worker threads, in chunks of UNWRAP_KEYS_CHUNK jobs
+    static constexpr size_t UNWRAP_KEYS_PARALLEL_THRESHOLD = 256;
+    static constexpr size_t UNWRAP_KEYS_CHUNK = 512;
+
+    // enqueue 'parent' for child warming (no-op when disabled or queue full)
+    void queuePrefetch(NodeHandle parent);
+
+    // schedule warming for siblings and grandchildren of 'parent'
+    void schedulePrefetchAround(const Node* parent);
+
+    void prefetchLoop();
+    void stopPrefetchThread();
+
     void setTable_internal(DBTableNodes *table);
     void reset_internal();
     bool addNode_internal(std::shared_ptr<Node> node, bool notify, bool isFetching, MissingParentNodes& missingParentNodes);
@@ -426,6 +551,7 @@ private:
     sharedNode_vector getNodesByFingerprint_internal(FileFingerprint& fingerprint);
     sharedNode_vector getNodesByOrigFingerprint_internal(const std::string& fingerprint, Node *parent);
     std::shared_ptr<Node> getNodeByFingerprint_internal(FileFingerprint &fingerprint);
+    NodeHandle handleByFingerprint_internal(FileFingerprint& fingerprint);
     std::shared_ptr<Node> childNodeByNameType_internal(const Node *parent, const std::string& name, nodetype_t nodeType);
     sharedNode_vector getRootNodes_internal();
 
@@ -442,6 +568,11 @@ private:
     void cleanNodes_internal();
     std::shared_ptr<Node> getNodeFromBlob_internal(const string* nodeSerialized);
     void applyKeys_internal(uint32_t appliedKeys);
+
+    // run the AES unwraps for a large batch of pending node keys across the
+    // client's worker threads; attribute decryption and all bookkeeping stay
+    // on the calling thread
+    void unwrapKeysParallel(const sharedNode_vector& pending);
     void notifyNode_internal(std::shared_ptr<Node> node, sharedNode_vector* nodesToReport);
     bool loadNodes_internal();
     uint64_t getNodeCount_internal();
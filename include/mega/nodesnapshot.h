@@ -0,0 +1,102 @@
+/**
+ * @file mega/nodesnapshot.h
+ * @brief Memory-mapped read-only snapshot of the "nodes" DB table
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#ifndef MEGA_NODESNAPSHOT_H
+#define MEGA_NODESNAPSHOT_H 1
+
+#include "db.h"
+#include "types.h"
+
+namespace mega {
+
+/**
+ * @brief Read-optimized sidecar of the "nodes" DB table
+ *
+ * After fetchnodes completes, NodeManager dumps the serialized node records
+ * into a compact file with a sorted offset index. Subsequent sessions map the
+ * file with mmap and fault pages in lazily, instead of issuing one sqlite
+ * SELECT per node during tree walks and session restore.
+ *
+ * Sqlite remains the only write path. The snapshot is tagged with the scsn it
+ * was built at; whenever the tag doesn't match the client's current scsn, the
+ * snapshot is considered stale and readers must fall back to sqlite.
+ *
+ * Node records hold decrypted keys and attributes, so the payload is CTR
+ * encrypted with the session's cache key (the header and offset index stay in
+ * the clear, like the column data of the sqlite file next to it). Records are
+ * decrypted individually on lookup, which keeps lazy page faulting intact.
+ *
+ * The mmap fast path is only implemented for POSIX platforms; on other
+ * platforms mapping fails gracefully and the sqlite path is used.
+ */
+class MEGA_API NodeTableSnapshot
+{
+public:
+    ~NodeTableSnapshot();
+
+    // Write a snapshot of 'records' at 'path', tagged with 'scsnTag' and
+    // encrypted with 'cacheKey'. Any previous snapshot at that path is
+    // replaced atomically (write + rename)
+    static bool build(const LocalPath& path, const std::string& scsnTag,
+                      const std::vector<std::pair<NodeHandle, NodeSerialized>>& records,
+                      SymmCipher& cacheKey, PrnGen& rng);
+
+    // Map the snapshot at 'path', to be decrypted with 'cacheKey'. Returns
+    // false if the file is missing, malformed or mmap is not available on
+    // this platform
+    bool map(const LocalPath& path, SymmCipher& cacheKey);
+    void unmap();
+    bool isMapped() const { return mBase != nullptr; }
+
+    // scsn the snapshot was built at (empty if not mapped)
+    const std::string& tag() const { return mTag; }
+
+    // Look 'handle' up in the offset index and copy the record out.
+    // Returns false if the handle is not present in the snapshot
+    bool getNode(NodeHandle handle, NodeSerialized& nodeSerialized) const;
+
+    uint64_t numRecords() const { return mCount; }
+
+private:
+    struct IndexEntry
+    {
+        uint64_t handle;
+        uint64_t offset;
+        uint32_t nodeLen;
+        uint32_t counterLen;
+    };
+
+    static const char MAGIC[8];
+
+    const char* mBase = nullptr;
+    size_t mSize = 0;
+    uint64_t mCount = 0;
+    const IndexEntry* mIndex = nullptr;
+    std::string mTag;
+    uint64_t mNonce = 0;
+
+    // ctr_crypt mutates cipher state, but lookups are logically const
+    mutable SymmCipher mKey;
+};
+
+} // namespace
+
+#endif
@@ -37,6 +37,11 @@
 
 #ifdef HAVE_AIO_RT
 #include <aio.h>
+
+#if defined(__linux__) && defined(HAVE_LINUX_IO_URING_H)
+#define USE_IOURING 1
+#include <sys/uio.h>
+#endif
 #endif
 
 #include "mega.h"
@@ -62,6 +67,11 @@ struct MEGA_API PosixDirAccess : public DirAccess
     unsigned globindex;
 
     struct stat currentItemStat;
+
+    // Whether currentItemStat describes the item last returned by dnext():
+    // dnext() defers the stat() entirely when the dirent's type field is
+    // enough to classify the entry.
+    bool currentItemStatValid;
     bool currentItemFollowedSymlink;
 
     bool dopen(LocalPath*, FileAccess*, bool) override;
@@ -118,7 +128,10 @@ public:
                              map<LocalPath, FSNode>& known,
                              std::vector<FSNode>& results,
                              bool followSymLinks,
-                             unsigned& nFingerprinted) override;
+                             unsigned& nFingerprinted,
+                             std::vector<size_t>* deferredFingerprints) override;
+
+    bool scanFingerprint(const LocalPath& filePath, FSNode& node) override;
 
 #ifdef ENABLE_SYNC
     bool fsStableIDs(const LocalPath& path) const override;
@@ -138,6 +151,12 @@ struct MEGA_API PosixAsyncIOContext : public AsyncIOContext
     void finish() override;
 
     struct aiocb *aiocb;
+
+#ifdef USE_IOURING
+    // in-flight io_uring operation state (see PosixIoUring in fs.cpp)
+    struct iovec iov;
+    bool uringinflight;
+#endif
 };
 #endif
 
@@ -161,9 +180,14 @@ public:
     void updatelocalname(const LocalPath&, bool force) override;
     bool fread(string *, unsigned, unsigned, m_off_t);
     bool fwrite(const byte *, unsigned, m_off_t) override;
+    bool fwriteZeros(unsigned len, m_off_t pos) override;
+    bool fpreallocate(m_off_t size) override;
+    void fadvise(AccessHint hint, m_off_t pos, m_off_t len) override;
 
     bool ftruncate() override;
 
+    std::shared_ptr<const byte> mmapread(m_off_t, unsigned) override;
+
     bool sysread(byte *, unsigned, m_off_t) override;
     bool sysstat(m_time_t*, m_off_t*, FSLogging) override;
     bool sysopen(bool async, FSLogging) override;
@@ -188,6 +212,10 @@ protected:
 private:
     bool mFollowSymLinks = true;
 
+    // whether fpreallocate() reserved this file's extents, in which case
+    // fwriteZeros() has to punch its holes explicitly
+    bool mPreallocated = false;
+
 };
 
 #ifdef __linux__
@@ -215,12 +243,21 @@ public:
                             Waiter* waiter) override;
 
 private:
+    // Drains pending fanotify events, queueing notifications against the
+    // roots of the notifiers whose trees they fall under.
+    int checkFanotifyEvents();
+
     // Tracks which notifiers were created by this instance.
     list<DirNotify*> mNotifiers;
 
     // Inotify descriptor.
     int mNotifyFd = -EINVAL;
 
+    // Fanotify descriptor, if the kernel and our privileges allow one.
+    // A single filesystem-wide fanotify mark replaces the per-directory
+    // inotify watches; inotify remains the fallback.
+    int mFanotifyFd = -EINVAL;
+
     // Tracks which nodes are associated with what inotify handle.
     WatchMap mWatches;
 
@@ -236,6 +273,8 @@ class LinuxDirNotify
   : public DirNotify
 {
 public:
+    friend class LinuxFileSystemAccess;
+
     LinuxDirNotify(LinuxFileSystemAccess& owner,
                    LocalNode& root,
                    const LocalPath& rootPath);
@@ -248,12 +287,33 @@ public:
 
     void removeWatch(WatchMapIterator entry);
 
+    // True if this notifier is fed by a filesystem-wide fanotify mark,
+    // in which case no per-directory watches are needed.
+    bool usingFanotify() const { return mUseFanotify; }
+
 private:
+    // If eventPath lies within our tree, sets relative to its
+    // root-relative remainder and returns true.
+    bool containsEventPath(const string& eventPath, string& relative) const;
+
     // The LFSA that we are associated with.
     LinuxFileSystemAccess& mOwner;
 
     // Our position in our owner's mNotifiers list.
     list<DirNotify*>::iterator mNotifiersIt;
+
+    // The root of the tree we're monitoring: fanotify events are queued
+    // against it with root-relative paths, as on the other platforms.
+    LocalNode& mRoot;
+
+    // Identifies our root's filesystem in fanotify events.
+    uint64_t mFsidKey = 0;
+
+    // Descriptor on the root directory, for resolving event file handles.
+    int mMountFd = -1;
+
+    // Whether the fanotify mark was established.
+    bool mUseFanotify = false;
 }; // LinuxDirNotify
 
 #endif // ENABLE_SYNC
@@ -36,6 +36,10 @@
 
 #include <curl/curl.h>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #ifdef MEGA_USE_C_ARES
 #include <ares.h>
 #endif
@@ -98,6 +102,8 @@ protected:
     string useragent;
     CURLM* curlm[3];
 
+    // points at the process-wide refcounted curl share (DNS, TLS sessions,
+    // connection pool); acquired in the constructor, released in the destructor
     CURLSH* curlsh;
 #ifdef MEGA_USE_C_ARES
     ares_channel ares;
@@ -176,6 +182,7 @@ protected:
 #endif
 
     bool curlipv6;
+    bool curlhttp2;
     bool reset;
     bool statechange;
     bool dnsok;
@@ -200,7 +207,39 @@ protected:
     int checkevents(Waiter*) override;
     void closecurlevents(direction_t d);
     void processcurlevents(direction_t d);
+
+    // big lock serializing curl handle and in-flight HttpReq access between
+    // the client thread and the network thread - the same contract WinHttpIO
+    // uses for its system callback threads (csHTTP), with the waiter
+    // releasing it while blocked
+    std::mutex mCsHTTP;
+    int mLockDepth = 0;
+
+    // dedicated network servicing thread with its own waiter owning all
+    // curl/ares sockets.  Started lazily by the first lock() call, so apps
+    // that drive the SDK single-threaded and never engage the locking
+    // contract keep the old inline servicing in doio()
+    std::thread mNetThread;
+    std::unique_ptr<WAIT_CLASS> mNetWaiter;
+    std::atomic<bool> mNetThreadExit{ false };
+    Waiter* mClientWaiter = nullptr;
+
+    void networkThread();
+
+    // wake the network thread so it picks up new sockets/settings
+    void wakeNetworkThread();
+
+    // the pre-thread doio()/addevents() bodies, run by whichever thread
+    // services the sockets
+    bool doiointernal();
+    void addeventsinternal();
+
     SockInfoMap curlsockets[3];
+
+    // sockets dropped by curl since the last cleanup pass, so the pass can
+    // be skipped entirely on the (common) wakeups without removals
+    int removedcurlsockets[3];
+
     m_time_t curltimeoutreset[3];
     bool arerequestspaused[3];
     int numconnections[3];
@@ -209,6 +248,9 @@ protected:
     m_off_t maxspeed[2];
 
 public:
+    void lock() override;
+    void unlock() override;
+
     void post(HttpReq*, const char* = 0, unsigned = 0) override;
     void cancel(HttpReq*) override;
 
@@ -240,6 +282,9 @@ public:
 
     bool cacheresolvedurls(const std::vector<string>& urls, std::vector<string>&& ips) override;
 
+    bool exportdnscache(string* data) override;
+    void importdnscache(const string& data) override;
+
     CurlHttpIO();
     ~CurlHttpIO();
 
@@ -25,7 +25,11 @@
 #include "mega/waiter.h"
 #include <mutex>
 
-#ifndef USE_POLL
+#if defined(USE_EPOLL) || defined(USE_KQUEUE)
+#include <map>
+#endif
+
+#if !defined(USE_POLL) && !defined(USE_EPOLL) && !defined(USE_KQUEUE)
     #define MEGA_FD_ZERO FD_ZERO
     #define MEGA_FD_SET FD_SET
     #define MEGA_FD_ISSET FD_ISSET
@@ -36,9 +40,11 @@
     #define MEGA_FD_SET PosixWaiter::fdset
     #define MEGA_FD_ISSET PosixWaiter::fdisset
 
+#ifdef USE_POLL
     #define POLLIN_SET  (POLLRDNORM | POLLRDBAND | POLLIN | POLLHUP | POLLERR) // Ready for reading
     #define POLLOUT_SET (POLLWRBAND | POLLWRNORM | POLLOUT | POLLERR) // Ready for writing
     #define POLLEX_SET  (POLLPRI) // Exceptional condition
+#endif
     typedef std::set<int> mega_fd_set_t ;
 
 #endif
@@ -54,7 +60,7 @@ struct PosixWaiter : public Waiter
     mega_fd_set_t rfds, wfds, efds;
     mega_fd_set_t ignorefds;
 
-#ifdef USE_POLL
+#if defined(USE_POLL) || defined(USE_EPOLL) || defined(USE_KQUEUE)
 
     static void clear_fdset(mega_fd_set_t *s)
     {
@@ -70,6 +76,16 @@ struct PosixWaiter : public Waiter
     }
 #endif
 
+#if defined(USE_EPOLL) || defined(USE_KQUEUE)
+    // persistent kernel interest set: fd -> event mask currently registered
+    // with the epoll/kqueue instance, updated incrementally each wait()
+    std::map<int, uint32_t> m_registered;
+#endif
+
+    // released while blocked in wait(), so the network thread can service
+    // curl while this thread sleeps (same contract as WinWaiter::pcsHTTP)
+    std::mutex* pcsHTTP = nullptr;
+
     bool fd_filter(int nfds, mega_fd_set_t* fds, mega_fd_set_t* ignorefds) const;
 
     void init(dstime);
@@ -80,6 +96,9 @@ struct PosixWaiter : public Waiter
 
 protected:
     int m_pipe[2];
+#if defined(USE_EPOLL) || defined(USE_KQUEUE)
+    int m_kernelfd = -1;
+#endif
     std::mutex mMutex;
     bool alreadyNotified = false;
 };
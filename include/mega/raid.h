@@ -100,6 +100,13 @@ namespace mega {
         // indicate that the buffer written by asyncIO (or synchronously) can now be discarded.
         void bufferWriteCompleted(unsigned connectionNum, bool succeeded);
 
+        // take ownership of the connection's current output buffer (eg. to pool it for write-behind),
+        // freeing the connection to fetch more data.  Report the eventual write with detachedWriteCompleted().
+        std::shared_ptr<FilePiece> detachOutputBuffer(unsigned connectionNum);
+
+        // progress and chunkmac accounting for a piece written to file after detachOutputBuffer()
+        void detachedWriteCompleted(FilePiece& r);
+
         // temp URL to use on a given connection.  The same on all connections for a non-raid file.
         const std::string& tempURL(unsigned connectionNum);
 
@@ -133,6 +140,19 @@ namespace mega {
         // Which raid connection is not being used for downloading
         unsigned getUnusedRaidConnection() const;
 
+        // re-derive the per-part chunk size from an autotuned request size mid-transfer.
+        // Only affects how future requests are sized, buffered data is untouched
+        void tuneRaidLinesPerChunk(m_off_t maxRequestSize);
+
+        // current per-part chunk sizing, for transfer stats
+        unsigned getRaidLinesPerChunk() const;
+
+        // counters showing why connections were unloaded, harvested into the client's
+        // performanceStats when the owning slot closes
+        unsigned raidConnectionSwitchesSlowStart = 0;   // slowest-to-reply dropped at transfer start
+        unsigned raidConnectionSwitchesSlowness = 0;    // in-use connection unloaded for falling behind its peers
+        unsigned raidConnectionSwitchesError = 0;       // in-use connection unloaded after an http error
+
         // returns how far we are through the file on average, including uncombined data
         m_off_t progress() const;
 
@@ -225,7 +245,7 @@ namespace mega {
         m_off_t& transferPos(unsigned connectionNum) override;
 
         // Get the file position to upload/download to on the specified connection
-        std::pair<m_off_t, m_off_t> nextNPosForConnection(unsigned connectionNum, m_off_t maxDownloadRequestSize, unsigned connectionCount, bool& newBufferSupplied, bool& pauseConnectionForRaid, m_off_t uploadspeed);
+        std::pair<m_off_t, m_off_t> nextNPosForConnection(unsigned connectionNum, m_off_t maxDownloadRequestSize, unsigned connectionCount, bool& newBufferSupplied, bool& pauseConnectionForRaid, m_off_t uploadspeed, m_off_t downloadspeed, unsigned errorcount);
 
         TransferBufferManager();
 
@@ -248,6 +268,10 @@ namespace mega {
         // Track the progress of http requests sent.  For raid download, tracks the parts.  Otherwise, uses the full file position in the Transfer object, as it used to prior to raid.
         m_off_t& transferPos(unsigned connectionNum) override;
 
+        // ctr-decrypt a stretch of the stream in its own buffer (no mac for streaming).
+        // Used by finalize() and by the zero-copy non-raid delivery path, which decrypts the network buffer directly
+        void decryptInPlace(byte* buf, size_t len, m_off_t pos);
+
         DirectReadBufferManager(DirectRead* dr);
 
     private:
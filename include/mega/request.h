@@ -38,6 +38,10 @@ private:
     JSONSplitter mJsonSplitter;
     size_t mChunkedProgress = 0;
 
+    // bytes of a re-delivered chunked response still to be discarded, see
+    // prepareChunkedResume()
+    size_t mChunkedResumeSkip = 0;
+
     // once we send the commands, any retry must be for exactly
     // the same JSON, or idempotence will not work properly
     mutable string cachedJSON;
@@ -45,12 +49,21 @@ private:
     mutable string cachedCounts;
     mutable bool cachedSuppressSID = false;
 
+    // running estimate of the batch JSON size, maintained by add()
+    size_t mEstimatedBytes = 0;
+
 public:
     void add(Command*);
 
     size_t size() const;
 
-    string get(bool& suppressSID, MegaClient* client, char reqidCounter[10], string& idempotenceId) const;
+    // approximate size in bytes of the resulting batch JSON, for
+    // size-aware batch formation in RequestDispatcher::add()
+    size_t estimatedBytes() const { return mEstimatedBytes; }
+
+    // returns the batch JSON by reference to the idempotence cache; valid
+    // until this Request is cleared or destroyed
+    const string& get(bool& suppressSID, MegaClient* client, char reqidCounter[10], string& idempotenceId) const;
 
     void serverresponse(string&& movestring, MegaClient*);
     void servererror(const std::string &e, MegaClient* client);
@@ -62,6 +75,11 @@ public:
     m_off_t processChunk(const char* chunk, MegaClient*);
     m_off_t totalChunkedProgress();
 
+    // arrange for the next delivery of this request's (idempotent, hence
+    // byte-identical) response to resume where chunked parsing stopped,
+    // instead of feeding the splitter already-parsed data again
+    void prepareChunkedResume();
+
     void clear();
     bool empty() const;
     void swap(Request&);
@@ -82,6 +100,19 @@ class MEGA_API RequestDispatcher
     Request inflightreq;
     retryreason_t inflightFailReason = RETRY_NONE;
 
+    // responses received from the server but not yet fully processed
+    // locally. The front entry is the one being processed; it may be paused
+    // waiting for sc catch-up (seqtag) while the next batch is already on
+    // the wire, see readyToSend()
+    struct ReceivedResponse
+    {
+        Request req;
+        string response;
+        bool isError = false;
+        bool started = false;
+    };
+    deque<ReceivedResponse> mReceived;
+
     // client-server request double-buffering, in batches of up to MAX_COMMANDS
     deque<Request> nextreqs;
 
@@ -91,6 +122,11 @@ class MEGA_API RequestDispatcher
 
     static const int MAX_COMMANDS = 10000;
 
+    // batches are also cut off by estimated size, so that one enormous
+    // batch does not monopolize the cs channel (and a retry of it does
+    // not resend megabytes unnecessarily)
+    static const size_t MAX_BATCH_BYTES = 1024 * 1024;
+
     // unique request ID
     char reqid[10];
 
@@ -114,11 +150,21 @@ public:
      * @param suppressSID
      * @param includesFetchingNodes set to whether the commands include fetch nodes
      */
-    string serverrequest(bool& suppressSID, bool &includesFetchingNodes, bool& v3, MegaClient* client, string& idempotenceId);
-
-    // Once we get a successful reply from the server, call this to complete everything
-    // Since we need to support idempotence, we cannot add anything more to the in-progress request
-    void serverresponse(string&& movestring, MegaClient*);
+    // the returned reference points at the in-flight request's cached batch
+    // JSON: callers stream it directly (no reassembly copy) and it stays
+    // valid until that request completes or the dispatcher is cleared
+    const string& serverrequest(bool& suppressSID, bool &includesFetchingNodes, bool& v3, MegaClient* client, string& idempotenceId);
+
+    // Once we get a successful reply from the server, call this to queue it.
+    // Since we need to support idempotence, we cannot add anything more to the completed request.
+    // Queueing frees the inflight slot, so the next batch can go on the wire
+    // before the response is processed; that round trip overlaps the processing
+    void queueResponse(string&& movestring);
+
+    // Process queued responses, in order. The front one may pause waiting for
+    // sc catch-up of its seqtag, in which case continueProcessing() resumes it.
+    // Returns true if any processing was performed
+    bool processQueuedResponses(MegaClient* client);
 
     // Call this function when a chunk of data is received from the server for chunked requests
     // The return value is the number of bytes that must be discarded. The chunk in the next call
@@ -28,9 +28,94 @@ namespace mega {
 // 64-bit int serialization/unserialization
 struct MEGA_API Serialize64
 {
+    // the buffer must have room for sizeof(uint64_t) + 1 bytes, all of
+    // which may be written even for short encodings
     static int serialize(byte *, uint64_t);
     static int unserialize(byte*, int, uint64_t*);
 };
+
+// Batches runs of small fields in a stack buffer, so the destination string
+// is grown once per run rather than once per field. flush() (or destruction)
+// must happen before the destination is written through any other path.
+// See Node::serialize
+class MEGA_API BatchedWriter
+{
+public:
+    BatchedWriter(string& dest)
+        : mDest(dest)
+    {
+    }
+
+    ~BatchedWriter()
+    {
+        flush();
+    }
+
+    void append(const void* data, size_t len)
+    {
+        if (mLen + len > sizeof(mBuf))
+        {
+            flush();
+            if (len > sizeof(mBuf))
+            {
+                mDest.append(static_cast<const char*>(data), len);
+                return;
+            }
+        }
+        memcpy(mBuf + mLen, data, len);
+        mLen += len;
+    }
+
+    void append(const string& field)
+    {
+        append(field.data(), field.size());
+    }
+
+    // append a fixed-width field by value
+    template<typename T>
+    void appendvalue(const T& field)
+    {
+        append(&field, sizeof(field));
+    }
+
+    void appendfill(size_t count, char value)
+    {
+        if (mLen + count > sizeof(mBuf))
+        {
+            flush();
+            if (count > sizeof(mBuf))
+            {
+                mDest.append(count, value);
+                return;
+            }
+        }
+        memset(mBuf + mLen, value, count);
+        mLen += count;
+    }
+
+    void appendcompressed64(uint64_t value)
+    {
+        if (mLen + sizeof(value) + 1 > sizeof(mBuf))
+        {
+            flush();
+        }
+        mLen += static_cast<size_t>(Serialize64::serialize(mBuf + mLen, value));
+    }
+
+    void flush()
+    {
+        if (mLen)
+        {
+            mDest.append(reinterpret_cast<const char*>(mBuf), mLen);
+            mLen = 0;
+        }
+    }
+
+private:
+    string& mDest;
+    size_t mLen = 0;
+    byte mBuf[256];
+};
 } // namespace
 
 #endif
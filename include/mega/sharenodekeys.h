@@ -33,8 +33,24 @@ class MEGA_API ShareNodeKeys
 
     string keys;
 
+    // one deferred share-key wrap: the node key is encrypted with the share key
+    // and base64-appended to `keys` lazily, so a large tree can be processed in
+    // parallel instead of one AES call at a time while collecting
+    struct PendingKey
+    {
+        string nodekey;
+        int shareindex;
+        int itemindex;
+    };
+
+    vector<PendingKey> pending;
+
     int addshare(std::shared_ptr<Node>);
 
+    // wrap all pending node keys into `keys`, fanning large batches out across
+    // hardware threads (output is byte-identical to sequential processing)
+    void wrappending();
+
 public:
     // a convenience function for calling the full add() below when working with Node*
     void add(std::shared_ptr<Node>, std::shared_ptr<Node>, bool);
@@ -0,0 +1,129 @@
+/**
+ * @file mega/stallsampler.h
+ * @brief always-on sampling of exec() passes for post-hoc stall diagnosis
+ *
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#ifndef MEGA_STALLSAMPLER_H
+#define MEGA_STALLSAMPLER_H 1
+
+#include "types.h"
+#include <functional>
+
+namespace mega {
+
+// Unlike the hooks in testhooks.h, this surface is compiled into release
+// builds: when a watchdog or ANR reporter fires in the field, the most recent
+// exec() passes and the worst stall seen so far are the evidence we need to
+// attribute the hang, and by then it is too late to opt in.
+//
+// The exec thread attributes its time to coarse phases via the RAII scopes
+// below and records one sample per pass; the only synchronisation on that
+// path is a brief mutex acquisition at the end of each pass.  snapshot() and
+// report() take the same internal mutex and deliberately NOT the SDK mutex,
+// so a watchdog thread can call them even while exec() is wedged.
+class MEGA_API StallSampler
+{
+public:
+    typedef enum
+    {
+        PHASE_OTHER = 0,        // bookkeeping between the attributed phases
+        PHASE_CS_RESPONSE,      // processing a cs batch response
+        PHASE_SC_PROCESSING,    // applying sc actionpackets
+        PHASE_TRANSFERS,        // dispatching transfers and running slot io
+
+        PHASES
+    } phase_t;
+
+    struct Sample
+    {
+        m_time_t when = 0;                  // unix time the pass ended
+        uint32_t durationUs = 0;            // total pass duration
+        uint32_t phaseUs[PHASES] = {};      // time attributed per phase
+
+        // phase that consumed the most time in this pass
+        phase_t dominantPhase() const;
+    };
+
+    // passes kept for the crash/ANR reporter - at typical event loop rates
+    // this covers the last few seconds before a watchdog fires
+    static const unsigned RINGSIZE = 128;
+
+    // exec-thread only
+    void beginPass();
+    void enterPhase(phase_t p);
+    void endPass();
+    phase_t currentPhase() const { return mPhase; }
+
+    // safe from any thread; samples are returned oldest first
+    std::vector<Sample> snapshot() const;
+    Sample worstStall() const;
+
+    // text form of snapshot() plus the worst stall, for crash annotations
+    std::string report() const;
+
+    // cb runs on the exec thread whenever a pass exceeds thresholdMs, with
+    // that pass's sample; pass nullptr to unregister.  Keep it cheap - it
+    // runs inside the event loop it is diagnosing.
+    void setStallCallback(unsigned thresholdMs, std::function<void(const Sample&)> cb);
+
+    static const char* phaseName(phase_t p);
+
+private:
+    // exec-thread state, unsynchronised by design
+    std::chrono::steady_clock::time_point mPassStart;
+    std::chrono::steady_clock::time_point mPhaseStart;
+    phase_t mPhase = PHASE_OTHER;
+    uint32_t mPhaseUs[PHASES] = {};
+    bool mInPass = false;
+
+    // guards everything below; held only briefly at pass end and in snapshots
+    mutable std::mutex mMutex;
+    Sample mRing[RINGSIZE];
+    unsigned mNext = 0;
+    unsigned mCount = 0;
+    Sample mWorst;
+    unsigned mThresholdMs = 0;
+    std::function<void(const Sample&)> mCallback;
+};
+
+// scoped phase attribution; restores the previous phase on destruction so
+// nested scopes (eg. slot io inside the transfer dispatch pass) stay correct
+class MEGA_API StallSamplerPhase
+{
+    StallSampler& mSampler;
+    StallSampler::phase_t mPrevious;
+
+public:
+    StallSamplerPhase(StallSampler& sampler, StallSampler::phase_t p);
+    ~StallSamplerPhase();
+};
+
+// scoped pass bracket for exec(), tolerant of early returns
+class MEGA_API StallSamplerPass
+{
+    StallSampler& mSampler;
+
+public:
+    explicit StallSamplerPass(StallSampler& sampler);
+    ~StallSamplerPass();
+};
+
+} // namespace
+
+#endif
@@ -217,6 +217,17 @@ struct PerSyncStats
     int32_t numUploads = 0;
     int32_t numDownloads = 0;
 
+    // Performance counters.  Filled on the sync thread and delivered to the
+    // app as a copy, so they can be inspected without locking that thread.
+    uint64_t scannedFolders = 0;      // folder scans completed since the sync started
+    uint64_t scannedItems = 0;        // directory entries those scans returned
+    uint64_t filterEvaluations = 0;   // exclusion rule chain evaluations
+    uint64_t moveChecks = 0;          // move/rename detection checks performed
+    uint64_t folderVisits = 0;        // folders entered by recursiveSync passes
+    uint32_t queuedNotifications = 0; // filesystem events awaiting processing
+    uint32_t queuedDbChanges = 0;     // LocalNode rows awaiting a db flush
+    uint32_t lastDbFlushMs = 0;       // duration of the last statecache flush
+
     bool operator==(const PerSyncStats&);
     bool operator!=(const PerSyncStats&);
 };
@@ -282,6 +293,10 @@ struct SyncRow
     LocalNode* syncNode;
     FSNode* fsNode;
 
+    // canonicalNameHash of this row's name; first-level key when
+    // computeSyncTriplets orders and groups sibling rows.
+    uint64_t mNameHash = 0;
+
     NodeHandle cloudHandleOpt() { return cloudNode ? cloudNode->handle : NodeHandle(); }
 
     vector<CloudNode*> cloudClashingNames;
@@ -457,6 +472,9 @@ public:
     // insertion/update queue
     localnode_set insertq;
 
+    // deletion queue (dbids of rows to remove from the db)
+    set<uint32_t> deleteq;
+
     // adds an entry to the delete queue - removes it from insertq
     void statecachedel(LocalNode*);
 
@@ -469,6 +487,31 @@ public:
     // Caches all synchronized LocalNode
     void cachenodes();
 
+    // Flushes the queues once enough changes have accumulated or the flush
+    // interval has expired.  Called once per pass of the sync loop; the
+    // dropped rows are rewritten after a crash anyway when the tree is
+    // reconciled against the filesystem and cloud, so deferring costs
+    // nothing but a slightly longer startup.
+    void cachenodesIfDue();
+
+    // flush the state cache queues when this many changes accumulate...
+    static const size_t MAXSTATECACHEQUEUE = 8192;
+
+    // ...or when this much time has passed since the last flush (ds)
+    static const dstime STATECACHEFLUSHINTERVAL = 30;
+
+    // when the state cache queues were last flushed
+    dstime mLastStatecacheFlush = 0;
+
+    // Cumulative performance counters for this sync, copied into
+    // PerSyncStats by the sync loop.  Sync thread only.
+    uint64_t mScannedFolders = 0;
+    uint64_t mScannedItems = 0;
+    uint64_t mFilterEvaluations = 0;
+    uint64_t mMoveChecks = 0;
+    uint64_t mFolderVisits = 0;
+    uint32_t mLastDbFlushMs = 0;
+
     // change state, signal to application
     void changestate(SyncError newSyncError, bool newEnableFlag, bool notifyApp, bool keepSyncDb);
 
@@ -578,13 +621,14 @@ public:
     Sync(UnifiedSync&, const string&, const LocalPath&, bool, const string& logname, SyncError& e);
     ~Sync();
 
-    // Asynchronous scan request / result.
-    std::shared_ptr<ScanService::ScanRequest> mActiveScanRequestGeneral;
+    // Asynchronous scan requests in flight for this sync, up to
+    // MAX_ACTIVE_SCAN_REQUESTS at a time so independent directories scan and
+    // fingerprint in parallel on the ScanService pool.  One slot is reserved
+    // for yet-unscanned folders so the initial scan always progresses even
+    // when downloads are triggering rescans of their target folders
+    std::vector<std::shared_ptr<ScanService::ScanRequest>> mActiveScanRequests;
 
-    // we can additionally be scanning one more yet-unscanned folder
-    // in order to always be progressing even when downloads are
-    // triggering rescans of their target folder
-    std::shared_ptr<ScanService::ScanRequest> mActiveScanRequestUnscanned;
+    static const size_t MAX_ACTIVE_SCAN_REQUESTS = 8;
 
     static const int SCANNING_DELAY_DS;
     static const int EXTRA_SCANNING_DELAY_DS;
@@ -955,6 +999,11 @@ struct SyncFlags
 
     bool earlyRecurseExitRequested = false;
 
+    // per-pass counters of folders recursiveSync entered vs pruned as
+    // clean, to verify passes only visit marked (dirty) subtrees
+    unsigned foldersVisitedThisPass = 0;
+    unsigned foldersPrunedThisPass = 0;
+
     // to help with slowing down retries in stall state
     dstime recursiveSyncLastCompletedDs = 0;
 
@@ -1125,6 +1174,13 @@ public:
     void importSyncConfigs(const char* data, std::function<void(error)> completion);
 
     // maps local fsid to corresponding LocalNode* (s)
+    //
+    // These multimaps (and localnodeByNodeHandle below) are the only lookup
+    // structures move/rename matching needs: candidates are found by exact
+    // fsid or node handle in O(1), never by searching LocalNode children
+    // maps across subtrees, so no per-directory summary (bloom filter or
+    // otherwise) would be consulted anywhere.  Tree passes after a rename
+    // are bounded separately, by the scanAgain/syncAgain descendant flags.
     fsid_localnode_map localnodeBySyncedFsid;
     fsid_localnode_map localnodeByScannedFsid;
     LocalNode* findLocalNodeBySyncedFsid(const fsfp_t& fsfp, mega::handle fsid, const LocalPath& originalpath, nodetype_t type, const FileFingerprint& fp,
@@ -22,6 +22,7 @@
 #define MEGA_SYNC_FILTER_H 1
 
 #include <memory>
+#include <unordered_map>
 
 #include "types.h"
 
@@ -181,6 +182,32 @@ public:
     bool mSyncThisMegaignore = false;
 
 private:
+    // Rebuilds the compiled evaluation plan below from mStringFilters.
+    //
+    // Most rules in a typical ignore file are literal, case-insensitive
+    // name exclusions. Rather than test each of them in turn for every
+    // path component, consecutive literal name filters are folded into a
+    // single hash table so a run of N such rules costs one lookup.
+    // Filters that can't be folded (wildcards, regexes, path filters)
+    // remain individual steps, preserving the chain's first-match
+    // (in reverse order of definition) semantics.
+    void compile();
+
+    struct MatchStep
+    {
+        // The filter this step evaluates, unless it's a folded run.
+        const StringFilter* filter = nullptr;
+
+        // Index into mNameTables when this step is a folded run.
+        size_t table = 0;
+    }; /* MatchStep */
+
+    // Compiled evaluation plan, in match priority order.
+    vector<MatchStep> mMatchSteps;
+
+    // Folded literal name filters, keyed by uppercased name.
+    vector<std::unordered_map<string, vector<const StringFilter*>>> mNameTables;
+
     // Name and/or path filters.
     StringFilterPtrVector mStringFilters;
 
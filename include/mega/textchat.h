@@ -258,6 +258,18 @@ private:
 
     int tag = -1;    // source tag, to identify own changes
 
+    // raw serialized attachment map and scheduled meeting records, captured by
+    // unserialize() but left unparsed; for accounts with thousands of cached chats
+    // these blocks dominate the per-chat load cost at session resume, and most
+    // chats are never opened. Cleared once hydrated.
+    string mDeferredAttachments;
+    string mDeferredSchedMeetings;
+
+    // parse mDeferredAttachments/mDeferredSchedMeetings into attachedNodes and
+    // mScheduledMeetings; called from the accessors so the cost is only paid for
+    // chats the app actually uses
+    void hydrateDeferred();
+
 public:
     TextChat(const bool publicChat);
     ~TextChat() = default;
@@ -0,0 +1,136 @@
+/**
+ * @file mega/tracing.h
+ * @brief opt-in chrome://tracing event emission for performance diagnosis
+ *
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#ifndef MEGA_TRACING_H
+#define MEGA_TRACING_H 1
+
+#include "types.h"
+#include <cstdio>
+
+namespace mega {
+
+    // Trace events for correlating exec() phases, transfer lifecycles, sync
+    // passes and db commits over time, in the Trace Event JSON format that
+    // chrome://tracing and Perfetto load directly.
+    //
+    // Like the hooks in testhooks.h, the instrumentation points compile to
+    // nothing unless the build opts in by defining MEGASDK_TRACE_EVENTS, so
+    // release builds carry no overhead. In an opted-in build, recording is
+    // additionally off until the application starts it, and events are a
+    // timestamp plus a couple of words each, buffered and flushed in bulk.
+
+#ifdef MEGASDK_TRACE_EVENTS
+    #define MEGASDK_TRACE_EVENTS_ENABLED
+#endif
+
+#ifdef MEGASDK_TRACE_EVENTS_ENABLED
+
+    class MEGA_API TraceRecorder
+    {
+    public:
+        static TraceRecorder& get();
+
+        // begin writing events to the given file (Trace Event JSON array).
+        // Returns false if the file could not be opened.
+        bool start(const char* path);
+
+        // flush buffered events, write the closing bracket and stop recording
+        void stop();
+
+        bool recording() const
+        {
+            return mRecording.load(std::memory_order_acquire);
+        }
+
+        // name must be a string literal (it is not copied).
+        // ph is the Trace Event phase: 'X' complete, 'i' instant, 'b'/'e' async
+        void record(const char* name, char ph, std::chrono::steady_clock::time_point ts,
+                    std::chrono::microseconds dur, uint64_t id);
+
+    private:
+        struct Event
+        {
+            const char* name;
+            char ph;
+            int64_t ts;     // microseconds
+            int64_t dur;    // microseconds, 'X' events only
+            uint64_t tid;
+            uint64_t id;    // async events only
+        };
+
+        void flush();   // mMutex must be held
+
+        std::atomic<bool> mRecording{false};
+        std::mutex mMutex;
+        std::vector<Event> mEvents;
+        FILE* mFile = nullptr;
+        bool mFirstEvent = true;
+
+        static const size_t FLUSH_THRESHOLD = 4096;
+    };
+
+    // scoped 'X' (complete) event covering the lifetime of the object
+    class MEGA_API TraceScope
+    {
+        const char* mName;
+        std::chrono::steady_clock::time_point mStart;
+
+    public:
+        TraceScope(const char* name)
+            : mName(name)
+            , mStart(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~TraceScope()
+        {
+            if (TraceRecorder::get().recording())
+            {
+                auto end = std::chrono::steady_clock::now();
+                TraceRecorder::get().record(mName, 'X', mStart,
+                    std::chrono::duration_cast<std::chrono::microseconds>(end - mStart), 0);
+            }
+        }
+    };
+
+    #define MEGA_TRACE_SCOPE(name) ::mega::TraceScope megaTraceScope_(name)
+
+    #define MEGA_TRACE_INSTANT(name) { if (::mega::TraceRecorder::get().recording()) \
+        ::mega::TraceRecorder::get().record(name, 'i', std::chrono::steady_clock::now(), std::chrono::microseconds(0), 0); }
+
+    // async begin/end pair: spans threads and exec() passes, correlated by id
+    // (e.g. the address of the object whose lifetime is being traced)
+    #define MEGA_TRACE_ASYNC_BEGIN(name, id) { if (::mega::TraceRecorder::get().recording()) \
+        ::mega::TraceRecorder::get().record(name, 'b', std::chrono::steady_clock::now(), std::chrono::microseconds(0), (uint64_t)(id)); }
+
+    #define MEGA_TRACE_ASYNC_END(name, id) { if (::mega::TraceRecorder::get().recording()) \
+        ::mega::TraceRecorder::get().record(name, 'e', std::chrono::steady_clock::now(), std::chrono::microseconds(0), (uint64_t)(id)); }
+
+#else
+    #define MEGA_TRACE_SCOPE(name)
+    #define MEGA_TRACE_INSTANT(name)
+    #define MEGA_TRACE_ASYNC_BEGIN(name, id)
+    #define MEGA_TRACE_ASYNC_END(name, id)
+#endif
+
+} // namespace
+
+#endif
@@ -166,6 +166,13 @@ struct MEGA_API Transfer : public FileFingerprint
 
     void removeAndDeleteSelf(transferstate_t finalState);
 
+    // called during terminal teardown of a download with verified partial data:
+    // re-inserts an anonymous copy into the cached-transfer pool so the temp
+    // file, chunk MACs and db record survive, and a future download of the same
+    // node resumes from the chunks already fetched.  Returns false if there is
+    // nothing worth keeping (the caller then unlinks the temp file as usual)
+    bool preserveDownloadProgress(TransferDbCommitter* committer);
+
     // previous wrong fingerprint
     FileFingerprint badfp;
 
@@ -185,11 +192,30 @@ struct MEGA_API Transfer : public FileFingerprint
     // priority of the transfer
     uint64_t priority;
 
+    // dispatch class: interactive transfers (user-facing, eg started with
+    // startFirst) are dispatched ahead of bulk ones and may take over a bulk
+    // slot once past the latency target.  Not persisted: resumed transfers
+    // restart as bulk.
+    bool interactive = false;
+
+    // traffic class for rate limiting: the most latency-sensitive class
+    // among the files this transfer serves
+    trafficclass_t trafficclass() const;
+
     // state of the transfer
     transferstate_t state;
 
     bool skipserialization;
 
+    // resumed upload whose size and mtime matched the cached state: full
+    // fingerprint verification was skipped at startxfer() time and runs on a
+    // worker thread, overlapped with the first chunks (set at dispatch)
+    bool deferredfpverification = false;
+
+    // set by the worker if the deferred check finds the local file modified.
+    // shared with the worker task so it stays valid if the transfer is deleted
+    std::shared_ptr<std::atomic<bool>> deferredfpmismatch;
+
     Transfer(MegaClient*, direction_t);
     virtual ~Transfer();
 
@@ -238,6 +264,10 @@ public:
     static const uint64_t PRIORITY_START = 0x0000800000000000ull;
     static const uint64_t PRIORITY_STEP  = 0x0000000000010000ull;
 
+    // latency target for interactive transfers: how long one may sit waiting
+    // with every slot taken before it bumps a bulk transfer
+    static const dstime INTERACTIVELATENCYDS = 20;
+
     typedef deque_with_lazy_bulk_erase<Transfer*, LazyEraseTransferPtr> transfer_list;
 
     TransferList();
@@ -256,12 +286,19 @@ public:
     void movedown(Transfer *transfer, TransferDbCommitter& committer);
     void movedown(transfer_list::iterator it, TransferDbCommitter& committer);
     error pause(Transfer *transfer, bool enable, TransferDbCommitter& committer);
+    void clear();
     transfer_list::iterator begin(direction_t direction);
     transfer_list::iterator end(direction_t direction);
     bool getIterator(Transfer *transfer, transfer_list::iterator&, bool canHandleErasedElements = false);
     std::array<vector<Transfer*>, 6> nexttransfers(std::function<bool(Transfer*)>& continuefunction,
 	                                               std::function<bool(direction_t)>& directionContinuefunction,
                                                    TransferDbCommitter& committer);
+
+    // with every slot taken and an interactive transfer waiting past the
+    // latency target, kick the lowest-priority active bulk transfer back to
+    // QUEUED so the freed slot can seat the interactive one.  True if kicked.
+    bool preemptforinteractive(TransferDbCommitter& committer);
+
     Transfer *transferat(direction_t direction, unsigned int position);
 
     std::array<transfer_list, 2> transfers;
@@ -272,6 +309,20 @@ private:
     void prepareIncreasePriority(Transfer *transfer, transfer_list::iterator srcit, transfer_list::iterator dstit, TransferDbCommitter& committer);
     void prepareDecreasePriority(Transfer *transfer, transfer_list::iterator it, transfer_list::iterator dstit);
     bool isReady(Transfer *transfer);
+
+    // priority-ordered index of the transfers that are eligible for dispatch (ie.
+    // everything not paused), so nexttransfers() does not walk a huge paused
+    // backlog on every exec().  Keyed by priority, which is unique per direction.
+    std::array<map<uint64_t, Transfer*>, 2> mDispatchIndex;
+
+    // keep mDispatchIndex in step; must be called around every priority,
+    // membership or pause change (all of which happen in this class)
+    void indexInsert(Transfer* transfer);
+    void indexErase(Transfer* transfer);
+
+    // when dispatch first found an interactive transfer waiting with no free
+    // slot (NEVER while none is waiting)
+    dstime mInteractiveWaitingSince = NEVER;
 };
 
 /**
@@ -662,6 +713,19 @@ private:
     */
     bool processAnyOutputPieces();
 
+    /**
+    *   @brief Deliver one already-decrypted chunk to the client by reference, updating speed and progress accounting.
+    *
+    *    - The buffer is only borrowed by the app for the duration of the callback: the caller consumes (or releases) it afterwards.
+    *    - Used for combined output pieces and for the zero-copy non-raid path, which decrypts in the network buffer itself.
+    *
+    *   @param buf Decrypted chunk data.
+    *   @param len Size of the chunk.
+    *   @return True if DirectReadSlot can continue, False if the delivery failed or the transfer is gone.
+    *   @see MegaApiImpl::pread_data()
+    */
+    bool deliverBytes(byte* buf, size_t len);
+
     /**
     *   @brief Aux method to calculate the throughput: numBytes for 1 unit of timeCount.
     *
@@ -675,6 +739,37 @@ private:
     m_off_t calcThroughput(m_off_t numBytes, m_off_t timeCount) const;
 };
 
+// Bounded per-file cache of decrypted stream ranges that were already delivered
+// to the app, so seek-heavy playback can reuse bytes fetched moments ago instead
+// of going back to the network.  Segments are coalesced while delivery is
+// sequential and evicted least-recently-used once the byte budget is exceeded.
+class MEGA_API DirectReadSegmentCache
+{
+public:
+    // record a delivered decrypted range (overlaps with cached data are trimmed away)
+    void store(m_off_t pos, const byte* data, size_t len);
+
+    // longest cached run starting at pos, or null.  The pointer is only valid
+    // until the next store(); callers deliver or copy before returning to it
+    const byte* lookup(m_off_t pos, size_t& len);
+
+    // per-file byte budget, and the coalescing limit that sets eviction granularity
+    static const size_t MAX_BYTES;
+    static const size_t MAX_SEGMENT_BYTES;
+
+private:
+    struct Segment
+    {
+        string data;
+        uint64_t lastUse = 0;
+    };
+
+    // non-overlapping segments keyed by their start offset in the file
+    map<m_off_t, Segment> mSegments;
+    size_t mTotalBytes = 0;
+    uint64_t mUseCounter = 0;
+};
+
 struct MEGA_API DirectRead
 {
     m_off_t count;
@@ -682,6 +777,10 @@ struct MEGA_API DirectRead
     m_off_t progress;
     m_off_t nextrequestpos;
 
+    // bytes fetched past the requested range purely to warm the segment cache
+    // for the next sequential read; never delivered to the app
+    m_off_t readahead;
+
     DirectReadBufferManager drbuf;
 
     DirectReadNode* drn;
@@ -697,7 +796,7 @@ struct MEGA_API DirectRead
     void abort();
     m_off_t drMaxReqSize() const;
 
-    DirectRead(DirectReadNode*, m_off_t, m_off_t, int, void*);
+    DirectRead(DirectReadNode*, m_off_t, m_off_t, int, void*, m_off_t = 0);
     ~DirectRead();
 };
 
@@ -724,6 +823,16 @@ struct MEGA_API DirectReadNode
 
     dr_list reads;
 
+    // decrypted ranges already streamed from this file, reused across seeks
+    DirectReadSegmentCache segmentcache;
+
+    // where a strictly sequential next read would start, for readahead detection
+    m_off_t nextseqpos;
+
+    // readahead sizing for sequential read patterns
+    static const m_off_t MIN_READAHEAD;
+    static const m_off_t MAX_READAHEAD;
+
     MegaClient* client;
 
     handledrn_map::iterator hdrn_it;
@@ -65,9 +65,26 @@ struct MEGA_API TransferSlot
     // max time without progress callbacks
     static const dstime PROGRESSTIMEOUT;
 
+    // interval between connection scaling decisions, long enough for the mean
+    // speed to settle after a change
+    static const dstime CONNECTION_SCALE_INTERVAL_DS;
+
     // max request size for downloads and uploads
     static const m_off_t MAX_REQ_SIZE;
 
+    // floor for the autotuned download request size
+    static const m_off_t MIN_REQ_SIZE;
+
+    // write-behind: pooled pieces coalesce until a run of adjacent pieces reaches this size
+    static const m_off_t WRITE_BEHIND_FLUSH_SIZE;
+
+    // write-behind: per-transfer cap on pooled bytes; beyond it the whole pool is flushed
+    static const m_off_t WRITE_BEHIND_MAX_BYTES;
+
+    // all-zero download pieces at least this large skip the physical write
+    // when the target file can represent them as a hole
+    static const m_off_t SPARSE_WRITE_MIN_SIZE;
+
     // maximum gap between chunks for uploads
     static const m_off_t MAX_GAP_SIZE;
 
@@ -93,16 +110,73 @@ struct MEGA_API TransferSlot
     int connections;
     vector<std::shared_ptr<HttpReqXfer>> reqs;
 
+    // upload read-ahead pipeline: while a connection's request is on the
+    // wire, the following range is claimed, read and encrypted on a worker
+    // thread so ciphertext is ready the moment the connection frees up
+    // (bounded at one extra request per connection)
+    vector<std::shared_ptr<HttpReqXfer>> mNextReqs;
+
     // Keep track of transfer network speed per channel, and overall
     vector<SpeedController> mReqSpeeds;
     SpeedController mTransferSpeed;
 
+    // per-chunk service time (ms), time-to-first-byte (ms) and chunk
+    // throughput per connection (KB/s) for this slot; merged into the
+    // session-wide histograms in performanceStats when the slot dies
+    LatencyHistogram mChunkLatency;
+    LatencyHistogram mTimeToFirstByte;
+    LatencyHistogram mConnThroughput;
+
+    // one-line summary of the three histograms, empty if no chunks finished
+    string statsReport() const;
+
+    // dynamic connection scaling (non-raid): how many of the allocated
+    // connections may dispatch new requests, plus hill-climbing bookkeeping
+    int mActiveConnections = 0;
+    dstime mLastScaleDecision = 0;
+    m_off_t mSpeedAtLastScale = 0;
+    bool mLastScaleWasUp = false;
+
+    // read-ahead autotuning: ceiling for BDP-driven request size growth (the
+    // platform static plus headroom, unless the memory probe reduced it), and
+    // when the window was last retuned
+    m_off_t mMaxTunedRequestSize = 0;
+    dstime mLastReadAheadTune = 0;
+
+    // nodes pinned at the NodeManager LRU cache while this slot is active,
+    // so they can't be evicted mid-transfer (unpinned on destruction)
+    vector<NodeHandle> mPinnedNodeHandles;
+
     // only swap channels twice for speed issues, to prevent endless non-progress (counter is reset if we make overall progress, ie data reassembled)
     unsigned mRaidChannelSwapsForSlowness = 0;
 
+    // when we last unloaded a channel for slowness, so proactive swaps (peers still streaming) can't thrash
+    dstime mLastRaidSlownessSwitch = 0;
+
+    // the download meta-MAC check runs on a worker at completion; the worker
+    // stores 1 (match) or -1 (mismatch) here while the transfer shows as
+    // COMPLETING, and doio polls for the outcome
+    std::shared_ptr<std::atomic<int>> mMacVerifyResult;
+
     // Manage download input buffers and file output buffers for file download.  Raid-aware, and automatically performs decryption and mac.
     TransferBufferManager transferbuf;
 
+    // write-behind pool for synchronous download output: decrypted pieces wait
+    // here, keyed by file position, until adjacent pieces arrive and can be
+    // written as one ascending sequential run (spinning disks suffer badly
+    // from many small out-of-order writes)
+    map<m_off_t, std::shared_ptr<TransferBufferManager::FilePiece>> mPendingWrites;
+    m_off_t mPendingWriteBytes = 0;
+
+    // a pooled write failed with a retryable error; try again on the next doio()
+    bool mFlushWriteBehind = false;
+
+    // tails of truncated download ranges whose chunk-aligned prefix was
+    // salvaged: these holes sit behind the claim cursor (transfer->pos) so
+    // nextNPosForConnection can't see them; ready connections drain this
+    // list before claiming fresh ranges
+    deque<std::pair<m_off_t, m_off_t>> mRetryRanges;
+
     // async IO operations
     AsyncIOContext** asyncIO;
 
@@ -130,6 +204,32 @@ struct MEGA_API TransferSlot
     // Contiguous progress means that all the chunks are finished, from the start of the file up to (but not including) the file position returned.
     m_off_t updatecontiguousprogress();
 
+    // periodically adjust mActiveConnections from SpeedController feedback
+    void updateconnectionscaling();
+
+    // periodically resize maxRequestSize (and raid chunk sizing) from the
+    // measured bandwidth-delay product, so high-latency paths keep the pipe full
+    void updatereadaheadwindow();
+
+    // claim and pre-encrypt the next upload range for connection i (no-op if
+    // nothing remains to claim; caller checks that none is pending yet)
+    void prepareuploadreadahead(unsigned i);
+
+    // true if the piece is entirely zeros and was recorded as a hole in the
+    // target file instead of being physically written, keeping mostly-empty
+    // downloads (VM images, disk dumps) sparse on disk
+    static bool sparseWritePiece(FileAccess& fa, TransferBufferManager::FilePiece& piece);
+
+    // write pooled pieces out in coalesced ascending runs; runs below
+    // WRITE_BEHIND_FLUSH_SIZE stay pooled unless flushall is set or the pool
+    // is over budget.  Returns false if a write failed (remaining pieces stay pooled)
+    bool flushwrites(bool flushall);
+
+    // flushwrites() plus the surrounding bookkeeping: progress/cache updates on
+    // success, error handling on failure.  Returns true if doio() must stop
+    // (transfer finished or failed, and this slot may have been deleted)
+    bool completewritebehind(TransferDbCommitter& committer, dstime& backoff);
+
     // compute the meta MAC based on the chunk MACs
     int64_t macsmac(chunkmac_map*);
     int64_t macsmac_gaps(chunkmac_map*, size_t g1, size_t g2, size_t g3, size_t g4);
@@ -153,6 +253,11 @@ private:
     bool checkMetaMacWithMissingLateEntries();
     bool tryRaidRecoveryFromHttpGetError(unsigned i, bool incrementErrors);
 
+    // non-raid download arrived short: keep the chunk-aligned prefix as a
+    // normal success and queue only the missing tail for refetch.  Returns
+    // false if less than one whole chunk arrived (caller retries the full range)
+    bool trySalvageTruncatedChunk(HttpReqDL* downloadRequest, int channel);
+
     // returns true if connection haven't received data recently (set incrementErrors) or if slower than other connections (reset incrementErrors)
     bool testForSlowRaidConnection(unsigned connectionNum, bool& incrementErrors);
 };
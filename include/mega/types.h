@@ -71,6 +71,7 @@ typedef unsigned char byte;
 
 #include "mega/crypto/sodium.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <chrono>
@@ -576,14 +577,42 @@ typedef list<struct TransferSlot*> transferslot_list;
 // map a FileFingerprint to the transfer for that FileFingerprint
 typedef multimap<FileFingerprint*, Transfer*, FileFingerprintCmp> transfer_multimap;
 
-template <class T, class E>
+// default entry type for deque_with_lazy_bulk_erase: wraps the stored value
+// with the erased flag.  Use it directly unless erasure needs to capture extra
+// state (see LazyEraseTransferPtr in transfer.h, which records the erased
+// transfer's priority)
+template <class T>
+struct LazyEraseEntry
+{
+    T value;
+    bool erased = false;
+
+    explicit LazyEraseEntry(T v) : value(std::move(v)) {}
+    operator T&() { return value; }
+    void erase() { value = T(); erased = true; }
+    bool isErased() const { return erased; }
+    bool operator==(const LazyEraseEntry<T>& e) { return !erased && value == e.value; }
+};
+
+template <class T, class E = LazyEraseEntry<T>>
 class deque_with_lazy_bulk_erase
 {
     // This is a wrapper class for deque.  Erasing an element from the middle of a deque is not cheap since all the subsequent elements need to be shuffled back.
     // This wrapper intercepts the erase() calls for single items, and instead marks each one as 'erased'.
-    // The supplied template class E contains the normal deque entry T, plus a flag or similar to mark an entry erased.
+    // The supplied template class E contains the normal deque entry T, plus a flag or similar to mark an entry erased:
+    // it must provide construction from T, conversion to T&, erase() and isErased().
     // Any other operation on the deque performs all the gathered erases in a single std::remove_if for efficiency.
     // This makes an enormous difference when cancelling 100k transfers in MEGAsync's transfers window for example.
+    //
+    // Iterator guarantees, which differ from plain deque:
+    //  - erase(i) does not invalidate any iterator, including i itself: the entry
+    //    merely becomes isErased() and is skipped by value consumers.
+    //  - every other mutator (and size()/empty()/begin()/end() without the
+    //    canHandleErasedElements flag) may first perform the pending bulk erase,
+    //    which invalidates ALL outstanding iterators.
+    //  - loops that erase while iterating must therefore use
+    //    begin(true)/end(true), only mark via erase(), and skip entries that are
+    //    already isErased().
     deque<E> mDeque;
     size_t nErased = 0;
 
@@ -625,7 +654,9 @@ public:
 
     size_t size()                                        { applyErase(); return mDeque.size(); }
     size_t empty()                                       { applyErase(); return mDeque.empty(); }
-    void clear()                                         { mDeque.clear(); }
+    void clear()                                         { mDeque.clear(); nErased = 0; }
+    T& front()                                           { applyErase(); return mDeque.front(); }
+    void pop_front()                                     { applyErase(); mDeque.pop_front(); }
     iterator begin(bool canHandleErasedElements = false) { if (!canHandleErasedElements) applyErase(); return mDeque.begin(); }
     iterator end(bool canHandleErasedElements = false)   { if (!canHandleErasedElements) applyErase(); return mDeque.end(); }
     void push_front(T t)                                 { applyErase(); mDeque.push_front(E(t)); }
@@ -689,6 +720,17 @@ typedef map<int, FileAttributeFetchChannel*> fafc_map;
 typedef enum { GET = 0, PUT, API, NONE } direction_t;
 typedef enum { LARGEFILE = 0, SMALLFILE } filesizetype_t;
 
+// traffic class of a transfer payload, for hierarchical rate limiting
+// (order matters: lower values win when a Transfer serves several Files)
+typedef enum
+{
+    TRAFFIC_STREAMING = 0,  // direct reads/media streaming
+    TRAFFIC_MANUAL,         // app-initiated transfers
+    TRAFFIC_SYNC,           // sync engine traffic
+    TRAFFIC_BACKUP,         // backup sync traffic
+    TRAFFIC_CLASSES
+} trafficclass_t;
+
 struct StringCmp
 {
     bool operator()(const string* a, const string* b) const
@@ -995,6 +1037,153 @@ namespace CodeCounter
     };
 }
 
+// Cooperative time slice for the long-running phases of MegaClient::exec().
+// A phase calls start() when it begins and checks exceeded() at safe
+// checkpoints; once the budget runs out it yields and resumes on the next
+// exec() pass, so one phase cannot monopolize the client thread.
+class MEGA_API TimeSliceBudget
+{
+    std::chrono::steady_clock::time_point mStart;
+    std::chrono::steady_clock::duration mBudget{};
+    mutable unsigned mChecks = 0;
+
+public:
+    void start(unsigned ms)
+    {
+        mStart = std::chrono::steady_clock::now();
+        mBudget = std::chrono::milliseconds(ms);
+        mChecks = 0;
+    }
+
+    bool exceeded() const
+    {
+        // checkpoints are much more frequent than the budget granularity, so
+        // only pay for a clock read on every 16th call - the overshoot this
+        // allows is noise against budgets of tens of milliseconds
+        if (++mChecks & 15)
+        {
+            return false;
+        }
+
+        return std::chrono::steady_clock::now() - mStart >= mBudget;
+    }
+};
+
+// process-wide performance counters and gauges, cheap enough (relaxed atomic
+// increments) to update from transfer, db and worker-thread hot paths.
+// A text snapshot is available through MegaApi::getPerformanceCounters().
+typedef enum
+{
+    PERF_CS_REQUESTS = 0,       // client-server request batches posted
+    PERF_CS_INFLIGHT,           // gauge: cs batches awaiting a response
+    PERF_SC_PACKETS,            // server-client actionpackets applied
+    PERF_SC_BACKLOG,            // gauge: sc response bytes received but not yet applied
+    PERF_NODES_IN_RAM,          // gauge: nodes currently held in memory
+    PERF_NODE_CACHE_HITS,       // node lookups answered from the LRU cache
+    PERF_NODE_CACHE_MISSES,     // node lookups that went to the database
+    PERF_BYTES_DOWNLOADED,      // transfer payload received
+    PERF_BYTES_UPLOADED,        // transfer payload sent
+    PERF_CHUNK_RETRIES,         // transfer chunks that failed and were requeued
+    PERF_DB_QUERIES,            // statecache queries executed
+    PERF_DB_QUERY_TIME_US,      // cumulative statecache query time
+    PERF_LISTENER_CALLBACKS,    // app listener invocations dispatched
+    PERF_LISTENER_TIME_US,      // cumulative time spent inside app listeners
+    PERF_SLOW_LISTENER_CALLBACKS, // listener invocations over the warn threshold
+
+    PERF_COUNTERS
+} perfcounter_t;
+
+class MEGA_API PerfCounters
+{
+    std::atomic<int64_t> mCounters[PERF_COUNTERS]{};
+
+public:
+    static PerfCounters& get()
+    {
+        static PerfCounters counters;
+        return counters;
+    }
+
+    void add(perfcounter_t c, int64_t n = 1)
+    {
+        mCounters[c].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void sub(perfcounter_t c, int64_t n = 1)
+    {
+        mCounters[c].fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    void set(perfcounter_t c, int64_t n)
+    {
+        mCounters[c].store(n, std::memory_order_relaxed);
+    }
+
+    int64_t value(perfcounter_t c) const
+    {
+        return mCounters[c].load(std::memory_order_relaxed);
+    }
+
+    // one "name:value" pair per line
+    std::string report() const;
+};
+
+// subsystems whose memory footprint is tracked individually, so that capacity
+// planning on constrained targets does not require attaching a heap profiler
+typedef enum
+{
+    MEM_NODES = 0,          // Node objects resident in NodeManager's LRU cache
+    MEM_LOCALNODES,         // LocalNode trees held by active syncs
+    MEM_TRANSFERBUFFERS,    // raid/transfer payload buffers (http_buf_t ownership)
+
+    MEM_SUBSYSTEMS
+} memsubsystem_t;
+
+// process-wide byte accounting per subsystem, updated with relaxed atomics at
+// the points where the tracked objects are created and destroyed.  Peaks are
+// maintained best-effort (a concurrent race can miss a peak by one update,
+// which is noise for sizing purposes).  A text snapshot including the sqlite
+// allocator's own accounting is available through MegaApi::getMemoryUsage().
+class MEGA_API MemoryAccounting
+{
+    std::atomic<int64_t> mCurrent[MEM_SUBSYSTEMS]{};
+    std::atomic<int64_t> mPeak[MEM_SUBSYSTEMS]{};
+
+public:
+    static MemoryAccounting& get()
+    {
+        static MemoryAccounting accounting;
+        return accounting;
+    }
+
+    void add(memsubsystem_t s, int64_t n)
+    {
+        int64_t now = mCurrent[s].fetch_add(n, std::memory_order_relaxed) + n;
+        if (now > mPeak[s].load(std::memory_order_relaxed))
+        {
+            mPeak[s].store(now, std::memory_order_relaxed);
+        }
+    }
+
+    void sub(memsubsystem_t s, int64_t n)
+    {
+        mCurrent[s].fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    int64_t current(memsubsystem_t s) const
+    {
+        return mCurrent[s].load(std::memory_order_relaxed);
+    }
+
+    int64_t peak(memsubsystem_t s) const
+    {
+        return mPeak[s].load(std::memory_order_relaxed);
+    }
+
+    // one "name: current=<bytes> peak=<bytes>" line per subsystem
+    std::string report() const;
+};
+
 
 // Hold the status of a status variable
 class CacheableStatus : public Cacheable
@@ -88,6 +88,9 @@ struct MEGA_API User : public Cacheable
         bool keys : 1;
         bool aPrefs : 1;    // apps preferences
         bool ccPrefs : 1;   // content consumption preferences
+        bool show : 1;      // visibility of the contact
+        bool ctime : 1;     // contact establishment timestamp
+        bool sharing : 1;   // set of nodes this user shares with us
     } changed;
 
     // user's public key
@@ -108,6 +111,10 @@ private:
     // version of each attribute
     userattr_map attrsv;
 
+    // when each cached entry (value or non-existing marker) was last refreshed
+    // from the API; session-scoped, not serialized
+    map<attr_t, m_time_t> attrts;
+
     // source tag
     int tag;
 
@@ -115,6 +122,10 @@ private:
     static constexpr char NON_EXISTING[] = "-9";
 
 public:
+    // lifetime of cached entries that versioned invalidation cannot keep
+    // coherent (attributes of users we get no actionpackets for)
+    static constexpr m_time_t ATTR_CACHE_TTL = 300;
+
     void set(visibility_t, m_time_t);
 
     bool serialize(string*) const override;
@@ -131,9 +142,13 @@ public:
     void removeattr(attr_t at, const string *version = nullptr);
     int updateattr(attr_t at, string *av, string *v);
 
+    // when the cached entry for 'at' was last refreshed from the API (0 if never)
+    m_time_t getattrts(attr_t at) const;
+
     // Returns if attribute doesn't exist. Avoid requesting it to server
     bool nonExistingAttribute(attr_t at) const;
-    // Only mark own attributes that it doesn't exist
+    // mark an attribute as not existing; for own attributes the marker is kept
+    // coherent by actionpackets, for other users it expires after ATTR_CACHE_TTL
     void setNonExistingAttribute(attr_t at);
 
     static string attr2string(attr_t at);
@@ -162,6 +177,10 @@ public:
 
     bool setChanged(attr_t at);
 
+    // true if any field-level delta has been recorded since the last
+    // notification; notification fan-out is skipped when nothing changed
+    bool anyChanged() const;
+
     void setTag(int tag);
     int getTag();
     void resetTag();
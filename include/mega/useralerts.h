@@ -26,6 +26,7 @@
 #include "utils.h"
 
 #include <bitset>
+#include <tuple>
 
 namespace mega {
 
@@ -544,6 +545,17 @@ private:
     bool notingSharedNodes;
     handle ignoreNodesUnderShare;
 
+    // serialized statecache records of alerts older than the resident window,
+    // oldest first; they only become UserAlert objects when paged in
+    deque<pair<uint32_t, string>> coldAlerts;
+
+    // alerts materialized from the cold store on demand; widens the trim
+    // budget so paging history in does not push it straight back out
+    size_t onDemandResident = 0;
+
+    // just the type dispatch and construction, without adding to `alerts`
+    UserAlert::Base* unserializeAlertRecord(string* d, uint32_t dbid);
+
     bool isUnwantedAlert(nameid type, int action);
     bool isConvertReadyToAdd(handle originatinguser) const;
     void convertNotedSharedNodes(bool added);
@@ -552,7 +564,32 @@ private:
     void trimAlertsToMaxCount(); // mark as removed the excess from 200
     void notifyAlert(UserAlert::Base* alert, bool seen, int tag);
 
-    UserAlert::Base* findAlertToCombineWith(const UserAlert::Base* a, nameid t) const;
+    // windowed aggregation of share-activity alerts: while a storm of puts/
+    // removals/updates keeps merging into a composite, its notification is
+    // withheld so the app hears about the storm once, with final counts
+    struct AggregateWindow
+    {
+        dstime opened = 0;      // when the composite was created
+        dstime lastMerge = 0;   // when a packet last merged into it
+    };
+    map<UserAlert::Base*, AggregateWindow> mOpenAggregates;
+
+    // composite candidate per (type, user, parent), so storms interleaved
+    // across users or folders still collapse instead of only being matched
+    // against the most recent alert
+    map<std::tuple<nameid, handle, handle>, UserAlert::Base*> mCombineIndex;
+
+    static const dstime AGGREGATE_QUIET_DS = 20;     // storm considered over after 2s without merges
+    static const dstime AGGREGATE_MAX_HOLD_DS = 300; // but never withhold an alert longer than 30s
+
+    // key a share-activity alert may collapse under; false for other types
+    bool combineKey(const UserAlert::Base* a, std::tuple<nameid, handle, handle>& key) const;
+
+    // true while `a` must still be withheld from the app
+    bool aggregateHeld(UserAlert::Base* a) const;
+
+    // drop aggregation state referencing `a` (it is about to be deleted)
+    void forgetAggregate(UserAlert::Base* a);
 
     bool containsRemovedNodeAlert(handle nh, const UserAlert::Base* a) const;
     // Returns param `a` downcasted if `nh` is found and erased; `nullptr` otherwise
@@ -606,10 +643,30 @@ public:
     void removeNodeAlerts(Node* n);
     void setNewNodeAlertToUpdateNodeAlert(Node* n);
 
+    // only this many alerts are kept resident (the cap from the requirements);
+    // anything older stays serialized until the app pages it in
+    static constexpr size_t residentAlertPage = 200;
+
     void initscalerts(); // persist alerts received from sc50
     void purgescalerts(); // persist alerts from action packets
+
+    // earliest moment a withheld composite alert must be released to the app
+    void updateAggregateDeadline(dstime* nds) const;
     bool unserializeAlert(string* d, uint32_t dbid);
 
+    // defer a statecache alert record at login instead of materializing it
+    void queueAlertDbRecord(string* d, uint32_t dbid);
+
+    // turn the newest page of deferred records into resident alerts
+    void materializeResidentAlerts();
+
+    // materialize up to count older alerts from the cold store, prepending
+    // them to the resident window; returns how many were loaded
+    size_t loadOlderAlertPage(size_t count);
+
+    // alerts still in serialized form, available for paging in
+    size_t unloadedAlertCount() const { return coldAlerts.size(); }
+
     // stash removal-alert noted nodes
     void purgeNodeVersionsFromStash();
     void convertStashedDeletedSharedNodes();
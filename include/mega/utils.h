@@ -573,6 +573,7 @@ public:
     void debugLogOuputMacs();
 
     void ctr_encrypt(m_off_t chunkid, SymmCipher *cipher, byte *chunkstart, unsigned chunksize, m_off_t startpos, int64_t ctriv, bool finishesChunk);
+    void ctr_encrypt(m_off_t chunkid, SymmCipher *cipher, const byte *src, byte *dst, unsigned chunksize, m_off_t startpos, int64_t ctriv, bool finishesChunk);
     void ctr_decrypt(m_off_t chunkid, SymmCipher *cipher, byte *chunkstart, unsigned chunksize, m_off_t startpos, int64_t ctriv, bool finishesChunk);
 
     size_t size() const
@@ -687,9 +688,123 @@ bool CompareLocalFileMetaMacWithNode(FileAccess* fa, Node* node);
 // Maintains a small thread pool for executing independent operations such as encrypt/decrypt a block of data
 // The number of threads can be 0 (eg. for helper MegaApi that deals with public folder links) in which case something queued is
 // immediately executed synchronously on the caller's thread
+// Slab-backed pool of fixed-size blocks. Blocks are recycled through a free
+// list and slabs are only returned to the system when the pool is destroyed,
+// so high-churn allocations (eg. millions of Node objects across fetchnodes
+// and actionpacket processing) stop fragmenting the heap.
+class MEGA_API FixedBlockPool
+{
+public:
+    explicit FixedBlockPool(size_t blockSize, unsigned blocksPerSlab = 1024);
+    ~FixedBlockPool();
+
+    void* allocate();
+    void deallocate(void* p);
+
+    // carve slabs upfront until at least 'count' blocks sit on the free list,
+    // so a burst of known size (eg. loading every statecache row) never grows
+    // the pool mid-loop
+    void reserveBlocks(size_t count);
+
+    // process-wide pool serving blocks of exactly 'blockSize' bytes
+    static FixedBlockPool& poolFor(size_t blockSize);
+
+    MEGA_DISABLE_COPY_MOVE(FixedBlockPool)
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* mNext;
+    };
+
+    // append one slab's worth of blocks to the free list; mMutex must be held
+    void carveSlab();
+
+    size_t mBlockSize;
+    unsigned mBlocksPerSlab;
+    FreeBlock* mFreeList = nullptr;
+    size_t mFreeBlocks = 0;
+    std::vector<char*> mSlabs;
+    std::mutex mMutex;
+};
+
+// Minimal allocator over FixedBlockPool, for std::allocate_shared and friends.
+// Single-object allocations come from the pool; anything else falls back to
+// the global allocator.
+template <typename T>
+struct PooledAllocator
+{
+    using value_type = T;
+
+    PooledAllocator() = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        if (n == 1)
+        {
+            return static_cast<T*>(FixedBlockPool::poolFor(sizeof(T)).allocate());
+        }
+
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (n == 1)
+        {
+            FixedBlockPool::poolFor(sizeof(T)).deallocate(p);
+            return;
+        }
+
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const { return true; }
+
+    template <typename U>
+    bool operator!=(const PooledAllocator<U>&) const { return false; }
+};
+
+// Parse-scoped arena of recycled string temporaries. get() hands out a
+// cleared string whose heap buffer is retained from earlier rounds, so a
+// parse loop that calls reset() at the top of each object stops hitting the
+// allocator once every slot has reached its high-water capacity.
+// References returned by get() are stable (deque backing) but must not be
+// kept across the reset() that starts the next round.
+class MEGA_API ScratchStrings
+{
+public:
+    string& get()
+    {
+        if (mNext == mPool.size())
+        {
+            mPool.emplace_back();
+        }
+
+        string& s = mPool[mNext++];
+        s.clear();
+        return s;
+    }
+
+    // return every string to the arena wholesale; capacity is kept
+    void reset() { mNext = 0; }
+
+private:
+    std::deque<string> mPool;
+    size_t mNext = 0;
+};
+
 struct MegaClientAsyncQueue
 {
-    void push(std::function<void(SymmCipher&)> f, bool discardable);
+    // Jobs pushed with the same nonzero affinity key are queued to the same
+    // worker shard (steals aside), so related work - eg. all chunks of one
+    // transfer - keeps hitting the same worker's warm cipher and cache state.
+    // Affinity 0 round-robins across shards
+    void push(std::function<void(SymmCipher&)> f, bool discardable, uint64_t affinity = 0);
     void clearDiscardable();
 
     MegaClientAsyncQueue(Waiter& w, unsigned threadCount);
@@ -709,11 +824,17 @@ private:
         {}
     };
 
-    std::deque<Entry> mQueue;
+    // one queue per worker; a worker drains its own shard first and steals
+    // the oldest job of another shard when idle, so affinity never costs
+    // throughput. All shards share mMutex: jobs run orders of magnitude
+    // longer than the queue operations, so finer locking buys nothing here
+    std::vector<std::deque<Entry>> mShards;
+    size_t mNextShard = 0;
+    bool mExiting = false;
     std::vector<std::thread> mThreads;
     SymmCipher mZeroThreadsCipher;
 
-    void asyncThreadLoop();
+    void asyncThreadLoop(size_t shard);
 };
 
 template<class T>
@@ -46,6 +46,11 @@ struct MEGA_API Waiter
     // current time (processwide)
     static dstime ds;
 
+    // steady-clock instant that ds was derived from - hot paths needing more
+    // than decisecond resolution, but not more than one sample per event-loop
+    // pass, can reuse it instead of re-reading the clock
+    static std::chrono::steady_clock::time_point tickTime;
+
     // set ds to current time
     static void bumpds();
 
@@ -0,0 +1,73 @@
+/**
+ * @file mega/wirecapture.h
+ * @brief capture of cs/sc traffic with timing, for record-and-replay analysis
+ *
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#ifndef MEGA_WIRECAPTURE_H
+#define MEGA_WIRECAPTURE_H 1
+
+#include "types.h"
+#include <cstdio>
+
+namespace mega {
+
+// Records the post-TLS cs/sc exchanges of a session with millisecond timing
+// into a JSON-lines file, one object per event:
+//
+//   {"t":<ms since capture start>,"ch":"cs"|"sc","dir":"out"|"in","url":"...","data":"..."}
+//
+// Session identifiers are stripped from urls before writing; payloads are
+// recorded as-is (node keys and attributes in them are already encrypted).
+// The resulting file turns a misbehaving session - a share storm, a slow
+// catch-up - into a reproducible input for the replay driver in
+// tests/benchmark.  Unlike the tracing in tracing.h this is always compiled
+// in, since captures are typically wanted from release builds in the field;
+// when off, the cost is one atomic load per cs/sc completion.
+class MEGA_API WireCapture
+{
+public:
+    static WireCapture& get();
+
+    // begin writing events to the given file; returns false if it can't be opened
+    bool start(const char* path);
+
+    // flush and stop recording
+    void stop();
+
+    bool capturing() const
+    {
+        return mCapturing.load(std::memory_order_acquire);
+    }
+
+    // channel and dir must be string literals ("cs"/"sc", "out"/"in")
+    void record(const char* channel, const char* dir, const std::string& url, const std::string& data);
+
+    // strips the sid parameter value from a url so captures carry no session secret
+    static std::string redactUrl(const std::string& url);
+
+private:
+    std::atomic<bool> mCapturing{false};
+    std::mutex mMutex;
+    FILE* mFile = nullptr;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+} // namespace
+
+#endif
@@ -22,6 +22,7 @@
 #ifndef MEGAAPI_H
 #define MEGAAPI_H
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <inttypes.h>
@@ -249,6 +250,27 @@ public:
     */
     virtual const char* supportedVideoFormats();
 
+    /**
+     * @brief Create an additional, independent processor instance
+     *
+     * If this function is implemented, the SDK may call it to obtain extra processor
+     * instances and generate thumbnails/previews for several files in parallel, one
+     * instance per internal worker thread. Each instance receives the callback
+     * sequence described above for the files dispatched to it, always from the same
+     * thread, so instances don't need to be thread-safe with respect to each other.
+     *
+     * The SDK may also call this function on one of the returned instances to replace
+     * it when it repeatedly fails to process files, so implementations should return
+     * a fully independent instance that is itself able to create further ones.
+     *
+     * The SDK takes ownership of the returned processor and will delete it when it is
+     * no longer needed.
+     *
+     * @return A new processor instance, or NULL if the SDK should keep processing
+     * all files sequentially through this one (default)
+     */
+    virtual MegaGfxProcessor* createProcessor();
+
     virtual ~MegaGfxProcessor();
 };
 
@@ -1677,6 +1699,8 @@ class MegaUser
             CHANGE_TYPE_NO_CALLKIT                  = 0x20000000,
             CHANGE_APPS_PREFS                       = 0x40000000,
             CHANGE_CC_PREFS                         = 0x80000000,
+            CHANGE_TYPE_VISIBILITY                  = 0x100000000,
+            CHANGE_TYPE_SHARING                     = 0x200000000,
         };
 
         /**
@@ -1785,6 +1809,12 @@ class MegaUser
          * - MegaUser::CHANGE_CC_PREFS       = 0x80000000
          * Check if content consumption prefs have changed
          *
+         * - MegaUser::CHANGE_TYPE_VISIBILITY = 0x100000000
+         * Check if the visibility or the contact establishment timestamp has changed
+         *
+         * - MegaUser::CHANGE_TYPE_SHARING   = 0x200000000
+         * Check if the set of nodes shared by this user has changed
+         *
          * @return true if this user has an specific change
          */
         virtual bool hasChanged(uint64_t changeType);
@@ -1886,6 +1916,12 @@ class MegaUser
          * - MegaUser::CHANGE_CC_PREFS       = 0x80000000
          * Check if content consumption prefs have changed
          *
+         * - MegaUser::CHANGE_TYPE_VISIBILITY = 0x100000000
+         * Check if the visibility or the contact establishment timestamp has changed
+         *
+         * - MegaUser::CHANGE_TYPE_SHARING   = 0x200000000
+         * Check if the set of nodes shared by this user has changed
+         *
          * Check if backup names have changed         */
         virtual uint64_t getChanges();
 
@@ -5629,6 +5665,22 @@ class MegaTransfer
          */
         virtual long long getMeanSpeed() const;
 
+        /**
+         * @brief Returns a performance summary of this transfer
+         *
+         * The summary contains percentile digests of the chunk service time
+         * histogram (milliseconds), the time-to-first-byte histogram
+         * (milliseconds) and the per-connection chunk throughput histogram
+         * (KB/s), collected while the transfer was running. It is set when the
+         * transfer completes or fails; before that, and for transfers that
+         * never moved any data, this function returns NULL.
+         *
+         * The MegaTransfer object retains the ownership of the returned value.
+         *
+         * @return Performance summary, or NULL if none was collected
+         */
+        virtual const char* getStats() const;
+
         /**
 		 * @brief Returns the number of bytes transferred since the previous callback
 		 * @return Number of bytes transferred since the previous callback
@@ -6821,6 +6873,38 @@ public:
     */
     virtual int getDownloadCount() const = 0;
 
+  /** @brief Count of folder scans completed since the sync started
+    */
+    virtual long long getScannedFolderCount() const = 0;
+
+  /** @brief Count of directory entries returned by those folder scans
+    */
+    virtual long long getScannedItemCount() const = 0;
+
+  /** @brief Count of exclusion rule chain evaluations performed
+    */
+    virtual long long getFilterEvaluationCount() const = 0;
+
+  /** @brief Count of move/rename detection checks performed
+    */
+    virtual long long getMoveCheckCount() const = 0;
+
+  /** @brief Count of folders entered by sync passes
+    */
+    virtual long long getFolderVisitCount() const = 0;
+
+  /** @brief Number of filesystem events awaiting processing
+    */
+    virtual int getQueuedNotificationCount() const = 0;
+
+  /** @brief Number of node database rows awaiting a flush
+    */
+    virtual int getQueuedDbChangeCount() const = 0;
+
+  /** @brief Duration of the last node database flush, in milliseconds
+    */
+    virtual int getLastDbFlushMs() const = 0;
+
   /** @brief Make a copy of this object
     * You take ownership of the result.
     */
@@ -7824,6 +7908,47 @@ public:
     virtual ~SynchronousRequestListener();
 };
 
+/**
+ * @brief Listener that forwards a single onRequestFinish to a function object
+ * and then deletes itself
+ *
+ * Aimed at programmatic callers issuing requests at high frequency: no listener
+ * subclass, registration or manual lifetime management is needed. Create one
+ * with MegaOneShotRequestListener::create, pass it to the request-issuing call,
+ * and the function object is invoked exactly once when the request finishes,
+ * after which the listener destroys itself.
+ *
+ * The function object receives the SDK-owned request and error objects
+ * directly, without intermediate copies. As with any listener callback they
+ * are only valid for the duration of the call, so copy out whatever needs to
+ * outlive it.
+ *
+ * @see MegaRequestListener
+ */
+class MegaOneShotRequestListener : public MegaRequestListener
+{
+public:
+    /**
+     * @brief Creates a self-deleting listener around a completion function
+     *
+     * Ownership of the returned listener is effectively transferred to the
+     * request it is passed to: it deletes itself right after invoking the
+     * completion function. Do not delete it and do not reuse it for several
+     * requests.
+     *
+     * @param completion Function object invoked when the request finishes
+     * @return Listener to pass to a single request-issuing MegaApi call
+     */
+    static MegaOneShotRequestListener* create(std::function<void(MegaApi* api, MegaRequest* request, MegaError* e)> completion);
+
+    void onRequestFinish(MegaApi* api, MegaRequest* request, MegaError* e) override;
+
+protected:
+    explicit MegaOneShotRequestListener(std::function<void(MegaApi* api, MegaRequest* request, MegaError* e)> completion);
+
+    std::function<void(MegaApi* api, MegaRequest* request, MegaError* e)> mCompletion;
+};
+
 /**
  * @brief Interface to receive information about transfers
  *
@@ -9356,6 +9481,51 @@ public:
     virtual int64_t byModificationTimeUpperLimit() const;
 };
 
+class MegaSearchPage
+{
+protected:
+    MegaSearchPage();
+
+public:
+    /**
+     * @brief Creates a new instance of MegaSearchPage
+     *
+     * A page describes a window over the results of a search or listing:
+     * the first startingOffset matches are skipped and at most size matches
+     * are returned (size 0 means no limit).
+     *
+     * @param startingOffset Number of results to skip
+     * @param size Maximum number of results to return, 0 for all of them
+     * @return A pointer of current type, a superclass of the private object
+     */
+    static MegaSearchPage* createInstance(size_t startingOffset, size_t size);
+
+    /**
+     * @brief Create a copy of this instance.
+     *
+     * You are the owner of the returned instance
+     *
+     * @return Copy of the current instance
+     */
+    virtual MegaSearchPage* copy() const;
+
+    virtual ~MegaSearchPage();
+
+    /**
+     * @brief Return the number of results to be skipped.
+     *
+     * @return number of results to be skipped
+     */
+    virtual size_t startingOffset() const;
+
+    /**
+     * @brief Return the maximum number of results to be returned.
+     *
+     * @return maximum number of results to be returned, or 0 for no limit
+     */
+    virtual size_t size() const;
+};
+
 class MegaNodeTree
 {
 protected:
@@ -9568,6 +9738,13 @@ class MegaApi
             TRANSFER_METHOD_AUTO_ALTERNATIVE = 4
         };
 
+        enum {
+            TRAFFIC_CLASS_STREAMING = 0,
+            TRAFFIC_CLASS_MANUAL = 1,
+            TRAFFIC_CLASS_SYNC = 2,
+            TRAFFIC_CLASS_BACKUP = 3
+        };
+
         enum {
             PUSH_NOTIFICATION_ANDROID = 1,
             PUSH_NOTIFICATION_IOS_VOIP = 2,
@@ -9692,6 +9869,9 @@ class MegaApi
          * @param workerThreadCount The number of worker threads for encryption or other operations
          * Using worker threads means that synchronous function calls on MegaApi will be blocked less,
          * and uploads and downloads can proceed more quickly on very fast connections.
+         * With the default value of 1 the SDK scales the pool to the number of CPU cores
+         * (up to 8), so the MACs of several in-flight transfer chunks are computed
+         * concurrently; pass an explicit count to fix the pool size instead.
          *
          */
         MegaApi(const char *appKey, const char *basePath = NULL, const char *userAgent = NULL, unsigned workerThreadCount = 1);
@@ -9719,6 +9899,9 @@ class MegaApi
          * @param workerThreadCount The number of worker threads for encryption or other operations
          * Using worker threads means that synchronous function calls on MegaApi will be blocked less,
          * and uploads and downloads can proceed more quickly on very fast connections.
+         * With the default value of 1 the SDK scales the pool to the number of CPU cores
+         * (up to 8), so the MACs of several in-flight transfer chunks are computed
+         * concurrently; pass an explicit count to fix the pool size instead.
          *
          */
         MegaApi(const char *appKey, MegaGfxProcessor* processor, const char *basePath = NULL, const char *userAgent = NULL, unsigned workerThreadCount = 1);
@@ -12765,6 +12948,23 @@ class MegaApi
          */
         void cancelGetPreview(MegaNode* node, MegaRequestListener *listener = NULL);
 
+        /**
+         * @brief Raise or lower the loading priority of a node's thumbnail and preview
+         *
+         * Pending thumbnail/preview retrievals and generation jobs are served roughly
+         * in request order. Apps showing a scrolling gallery can flag the nodes currently
+         * visible in the viewport with this function so their imagery is served ahead of
+         * older queued requests, and unflag them as they scroll out of view.
+         *
+         * The hint takes effect immediately on queued work; requests already on the wire
+         * are unaffected. Flags are not persisted across sessions.
+         *
+         * @param handle Handle of the node to reprioritize
+         * @param priority True to serve this node's imagery first, false to restore
+         * normal ordering
+         */
+        void setThumbnailPriority(MegaHandle handle, bool priority);
+
         /**
          * @brief Set the thumbnail of a MegaNode
          *
@@ -13407,6 +13607,12 @@ class MegaApi
          *  - transfer quota: (numDetails & 0x02)
          *  - pro level: (numDetails & 0x04)
          *
+         * The SDK caches the result of the last successful fetch and answers repeat
+         * calls from that cache for up to 5 minutes, so apps may poll this method
+         * freely. The cache is discarded as soon as the servers push an account or
+         * storage change, so a cached answer is never older than the last known
+         * server-side state.
+         *
          * @param listener MegaRequestListener to track this request
          */
         void getAccountDetails(MegaRequestListener *listener = NULL);
@@ -14723,6 +14929,36 @@ class MegaApi
          */
         void startUpload(const char *localPath, MegaNode *parent, const char *fileName, int64_t mtime, const char *appData, bool isSourceTemporary, bool startFirst, MegaCancelToken *cancelToken, MegaTransferListener *listener=NULL);
 
+        /**
+         * @brief Upload a batch of files in a single call
+         *
+         * This is equivalent to calling MegaApi::startUpload once per file, but the whole
+         * batch is queued under a single lock with one wakeup of the SDK thread, and the
+         * per-file setup (in particular the filesystem type detection of the source
+         * folder) is shared across the batch. When queueing tens of thousands of files,
+         * this removes most of the submission latency before the first byte moves.
+         *
+         * The listener is attached to every transfer of the batch and receives the usual
+         * per-transfer callbacks (onTransferStart, onTransferUpdate, onTransferFinish)
+         * for each file.
+         *
+         * If the status of the business account is expired, onTransferFinish will be called with the error
+         * code MegaError::API_EBUSINESSPASTDUE. In this case, apps should show a warning message similar to
+         * "Your business account is overdue, please contact your administrator."
+         *
+         * @param localPaths Local paths of the files to upload (folders are not supported here)
+         * @param parent Parent node for the files in the MEGA account
+         * @param mtime Custom modification time for the files in MEGA (in seconds since the epoch)
+         *  + If you don't need this param provide MegaApi::INVALID_CUSTOM_MOD_TIME as value
+         * @param startFirst puts the transfers on top of the upload queue
+         *  + If you don't need this param provide false as value
+         * @param cancelToken MegaCancelToken to be able to cancel the batch.
+         * This param is required to be able to cancel the transfers safely.
+         * App retains the ownership of this param.
+         * @param listener MegaTransferListener to track all transfers of the batch
+         */
+        void startUploadBatch(const MegaStringList* localPaths, MegaNode* parent, int64_t mtime, bool startFirst, MegaCancelToken* cancelToken, MegaTransferListener* listener = NULL);
+
         /**
          * @brief Upload a file or a folder
          *
@@ -14818,6 +15054,36 @@ class MegaApi
          */
         void startDownload(MegaNode* node, const char* localPath, const char *customName, const char *appData, bool startFirst, MegaCancelToken *cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener = NULL);
 
+        /**
+         * @brief Download a batch of files to one local folder in a single call
+         *
+         * This is equivalent to calling MegaApi::startDownload once per node, but the
+         * whole batch is queued under a single lock with one wakeup of the SDK thread,
+         * and the per-file setup (destination filesystem type detection) is shared
+         * across the batch. When queueing tens of thousands of files, this removes most
+         * of the submission latency before the first byte moves.
+         *
+         * Each file is stored inside localFolder under its name in MEGA. The listener is
+         * attached to every transfer of the batch and receives the usual per-transfer
+         * callbacks (onTransferStart, onTransferUpdate, onTransferFinish) for each file.
+         *
+         * If the status of the business account is expired, onTransferFinish will be called with the error
+         * code MegaError::API_EBUSINESSPASTDUE. In this case, apps should show a warning message similar to
+         * "Your business account is overdue, please contact your administrator."
+         *
+         * @param nodes MegaNode list that identifies the files (folders are not supported here)
+         * @param localFolder Destination folder for the files
+         * @param startFirst puts the transfers on top of the download queue
+         *  + If you don't need this param provide false as value
+         * @param cancelToken MegaCancelToken to be able to cancel the batch.
+         * This param is required to be able to cancel the transfers safely.
+         * App retains the ownership of this param.
+         * @param collisionCheck Indicates the collision check on same files, as in MegaApi::startDownload
+         * @param collisionResolution Indicates how to save same files, as in MegaApi::startDownload
+         * @param listener MegaTransferListener to track all transfers of the batch
+         */
+        void startDownloadBatch(MegaNodeList* nodes, const char* localFolder, bool startFirst, MegaCancelToken* cancelToken, int collisionCheck, int collisionResolution, MegaTransferListener* listener = NULL);
+
         /**
          * @brief Start an streaming download for a file in MEGA
          *
@@ -15315,6 +15581,63 @@ class MegaApi
          */
         bool setMaxUploadSpeed(long long bpslimit);
 
+        /**
+         * @brief Reserve a share of the maximum download speed for one traffic class
+         *
+         * While a global limit set with MegaApi::setMaxDownloadSpeed is active, each
+         * traffic class (TRAFFIC_CLASS_STREAMING, TRAFFIC_CLASS_MANUAL, TRAFFIC_CLASS_SYNC,
+         * TRAFFIC_CLASS_BACKUP) is guaranteed its reserved share of the limit, and may
+         * additionally borrow any bandwidth the other classes are not using. This keeps
+         * latency-sensitive traffic (eg. media streaming) responsive while bulk traffic
+         * (eg. backups) saturates the global limit.
+         *
+         * Reservations have no effect while no global limit is set.
+         *
+         * Currently, this method is only available using the cURL-based network layer.
+         *
+         * @param trafficClass Traffic class to reserve bandwidth for
+         * @param bpslimit Reserved share in bytes per second (<= 0 removes the reservation)
+         * @return true if the network layer allows to control the download speed, otherwise false
+         */
+        bool setMaxDownloadSpeed(int trafficClass, long long bpslimit);
+
+        /**
+         * @brief Reserve a share of the maximum upload speed for one traffic class
+         *
+         * See MegaApi::setMaxDownloadSpeed(int, long long) for the semantics.
+         *
+         * @param trafficClass Traffic class to reserve bandwidth for
+         * @param bpslimit Reserved share in bytes per second (<= 0 removes the reservation)
+         * @return true if the network layer allows to control the upload speed, otherwise false
+         */
+        bool setMaxUploadSpeed(int trafficClass, long long bpslimit);
+
+        /**
+         * @brief Tune the TCP sockets created for new connections
+         *
+         * On links with a high bandwidth-delay product (eg. 10 Gbit with tens of
+         * milliseconds of round-trip time), the OS default socket buffers can cap
+         * single-connection throughput well below the line rate. This method lets
+         * the app request larger kernel buffers and, on Linux, a specific TCP
+         * congestion control algorithm for the sockets the SDK creates.
+         *
+         * The values apply to sockets created after the call; established
+         * connections are not modified. A value of 0 (or NULL for the algorithm)
+         * leaves the corresponding OS default untouched. Settings the kernel
+         * refuses (an algorithm that is not available, or buffer sizes above the
+         * system-wide limits) are logged and ignored.
+         *
+         * Currently, this method is only available using the cURL-based network layer.
+         *
+         * @param receiveBufferSize SO_RCVBUF size in bytes (0 = OS default)
+         * @param sendBufferSize SO_SNDBUF size in bytes (0 = OS default)
+         * @param congestionAlgorithm TCP congestion control algorithm name, eg. "bbr"
+         * (Linux only, NULL = OS default)
+         * @param notSentLowat TCP_NOTSENT_LOWAT threshold in bytes, where the
+         * platform supports it (0 = OS default)
+         */
+        void setSocketTuning(int receiveBufferSize, int sendBufferSize, const char* congestionAlgorithm, int notSentLowat);
+
         /**
          * @brief Get the maximum download speed in bytes per second
          *
@@ -15353,6 +15676,127 @@ class MegaApi
          */
         int getCurrentSpeed(int type);
 
+        /**
+         * @brief Get aggregated retry/backoff telemetry
+         *
+         * Returns one line per endpoint (cs, sc, transfer-get, transfer-put) that has
+         * backed off since this MegaApi was created: the number of retries, delay
+         * aggregates in deciseconds (total/max/last) and a count per retry cause.
+         * Endpoints that never retried are omitted; the string is empty if nothing
+         * has retried at all.
+         *
+         * You take the ownership of the returned value.
+         *
+         * @return Retry telemetry report. NULL if not logged in yet
+         */
+        char *getRetryTelemetry();
+
+        /**
+         * @brief Get a snapshot of the SDK performance counters
+         *
+         * Returns one "name:value" pair per line covering API request counts,
+         * actionpacket processing, node cache effectiveness, transferred bytes,
+         * chunk retries and local database query counts/latency. Counters are
+         * process-wide (shared between MegaApi instances in the same process)
+         * and accumulate since the process started. The snapshot additionally
+         * contains one line per registered app listener with the number of
+         * callbacks dispatched to it, the cumulative and worst-case time spent
+         * inside them and the name of the slowest callback, so a listener that
+         * blocks the SDK thread can be identified.
+         *
+         * You take the ownership of the returned value.
+         *
+         * @return Performance counter snapshot
+         */
+        char *getPerformanceCounters();
+
+        /**
+         * @brief Get a snapshot of the SDK memory usage per subsystem
+         *
+         * Returns one line per tracked subsystem with its current and peak byte
+         * counts: node objects resident in the in-memory cache, LocalNode trees
+         * held by active syncs, transfer payload buffers, and (when the SDK was
+         * built with SQLite) the database library's own allocation accounting.
+         * Figures are estimates maintained at object creation/destruction time,
+         * are process-wide (shared between MegaApi instances in the same
+         * process) and are intended for capacity planning, not exact audits.
+         *
+         * You take the ownership of the returned value.
+         *
+         * @return Memory usage snapshot
+         */
+        char *getMemoryUsage();
+
+        /**
+         * @brief Get the most recent SDK event-loop pass samples
+         *
+         * The SDK continuously records the duration of its event-loop passes
+         * with the time attributed to coarse phases (API response processing,
+         * actionpacket application, transfer dispatch/io), plus the worst pass
+         * observed since startup. This call returns those samples as text, one
+         * pass per line, oldest first, preceded by the worst stall.
+         *
+         * Unlike most MegaApi functions this call does not acquire the SDK
+         * lock, so a watchdog or ANR reporter can use it even while the SDK
+         * thread appears wedged.
+         *
+         * You take the ownership of the returned value.
+         *
+         * @return Event-loop sample report
+         */
+        char *getStallSamples();
+
+        /**
+         * @brief Start recording SDK trace events to a file
+         *
+         * The file is written in the Trace Event JSON format that chrome://tracing
+         * and Perfetto load directly, covering MegaClient::exec phases, transfer
+         * slot lifecycles, sync passes and database commits.
+         *
+         * Only effective if the SDK was built with MEGASDK_TRACE_EVENTS defined;
+         * otherwise the instrumentation is compiled out and this function always
+         * returns false.
+         *
+         * @param path Path of the trace file to write
+         * @return True if recording started
+         */
+        bool startPerformanceTrace(const char *path);
+
+        /**
+         * @brief Stop recording SDK trace events and finalize the trace file
+         *
+         * Does nothing if no trace recording is in progress.
+         */
+        void stopPerformanceTrace();
+
+        /**
+         * @brief Start capturing API traffic with timing to a file
+         *
+         * Records the client's cs/sc exchanges (post-TLS) into a JSON-lines
+         * file, one event per line with a millisecond timestamp, so that a
+         * misbehaving session can be replayed later as a reproducible
+         * benchmark input (see the replay driver shipped with the SDK tests).
+         * Session identifiers are stripped from the recorded urls; payloads
+         * are stored as received, with node keys and attributes still in
+         * their encrypted form.
+         *
+         * Capture is process-wide: with several MegaApi instances in one
+         * process their traffic is interleaved in the same file.
+         *
+         * @param path Path of the capture file to create
+         * @return true if the capture started, false if the file could not be
+         * created or a capture is already running
+         */
+        bool startWireCapture(const char *path);
+
+        /**
+         * @brief Stop a capture started with MegaApi::startWireCapture
+         *
+         * Flushes and closes the capture file. Does nothing if no capture is
+         * running.
+         */
+        void stopWireCapture();
+
         /**
          * @brief Get the active transfer method for downloads
          *
@@ -15474,6 +15918,27 @@ class MegaApi
          */
         MegaTransfer* getTransferByTag(int transferTag);
 
+        /**
+         * @brief Sample the progress of an active transfer without locking the SDK
+         *
+         * Unlike most MegaApi functions, this one can be called from any thread
+         * without blocking the SDK thread or being blocked by it: transfers publish
+         * their progress through per-transfer atomic counters. It is intended for
+         * apps that display many concurrent transfers and want to sample progress
+         * on a timer instead of processing every
+         * MegaTransferListener::onTransferUpdate callback.
+         *
+         * Any of the output parameters can be NULL if the value is not needed.
+         *
+         * @param transferTag tag to check, as returned by MegaTransfer::getTag
+         * @param transferredBytes receives the transferred bytes so far
+         * @param totalBytes receives the total bytes of the transfer
+         * @param speed receives the current speed of the transfer, in bytes per second
+         * @param meanSpeed receives the average speed of the transfer, in bytes per second
+         * @return true if there is an active transfer with that tag
+         */
+        bool getTransferProgressByTag(int transferTag, long long* transferredBytes, long long* totalBytes, long long* speed, long long* meanSpeed);
+
         /**
          * @brief Get all transfers of a specific type (downloads or uploads)
          *
@@ -16372,6 +16837,50 @@ class MegaApi
          */
         void setLRUCacheSize(unsigned long long size);
 
+        /**
+         * @brief Set the memory budget for the LRU node cache, in bytes
+         *
+         * When the estimated memory taken by the cached nodes exceeds this
+         * budget, the least recently used unpinned nodes are unloaded from RAM.
+         * Nodes involved in active transfers are never evicted.
+         *
+         * By default it's defined at unsigned long long max value (no byte limit)
+         *
+         * @param maxBytes Memory budget for the LRU node cache, in bytes
+         */
+        void setLRUCacheMaxBytes(unsigned long long maxBytes);
+
+        /**
+         * @brief Get the number of node lookups served from the LRU node cache
+         *
+         * Together with MegaApi::getLRUCacheMisses it allows to measure the cache
+         * hit rate and size the cache budget per device class.
+         *
+         * @return Number of node lookups that were served from RAM
+         */
+        unsigned long long getLRUCacheHits();
+
+        /**
+         * @brief Get the number of node lookups that had to load the node from DB
+         *
+         * @return Number of node lookups that were loaded from the local DB
+         */
+        unsigned long long getLRUCacheMisses();
+
+        /**
+         * @brief Enable or disable background prefetching of child nodes
+         *
+         * When enabled, listing the children of a folder schedules a background
+         * load of the folder's siblings and of the listings of its first
+         * subfolders, so that navigating into them is served from RAM instead
+         * of hitting the local DB on the UI path.
+         *
+         * By default it's disabled
+         *
+         * @param enable True to warm likely-next folder listings in background
+         */
+        void setChildrenPrefetchEnabled(bool enable);
+
         enum { ORDER_NONE = 0, ORDER_DEFAULT_ASC, ORDER_DEFAULT_DESC,
             ORDER_SIZE_ASC, ORDER_SIZE_DESC,
             ORDER_CREATION_ASC, ORDER_CREATION_DESC,
@@ -16598,6 +17107,30 @@ class MegaApi
          */
         MegaNodeList* getChildren(const MegaSearchFilter *filter, int order = ORDER_NONE, MegaCancelToken *cancelToken = nullptr);
 
+        /**
+         * @brief Get a window over the children of a node
+         *
+         * Same as getChildren(const MegaSearchFilter*, int, MegaCancelToken*) but
+         * only the requested page of the result set is built and returned, which
+         * avoids materializing complete lists for UIs that show a few rows at a
+         * time. With MegaApi::ORDER_NONE the windowing is pushed down to the
+         * local database query; with any other order the full result set is
+         * still collected and sorted internally before the page is cut.
+         *
+         * There is no snapshot isolation between pages: if the account changes
+         * between calls, the window may shift.
+         *
+         * You take the ownership of the returned value
+         *
+         * @param filter Container for filtering options, same as getChildren()
+         * @param order Order for the returned list, same values as getChildren()
+         * @param cancelToken MegaCancelToken to be able to cancel the processing at any time.
+         * @param searchPage Window over the result set; nullptr behaves like no windowing
+         *
+         * @return List with the requested page of children as MegaNode objects
+         */
+        MegaNodeList* getChildren(const MegaSearchFilter *filter, int order, MegaCancelToken *cancelToken, const MegaSearchPage *searchPage);
+
         /**
          * @brief Get all children of a list of MegaNodes
          *
@@ -16664,6 +17197,48 @@ class MegaApi
          */
         MegaNodeList* getChildren(MegaNodeList *parentNodes, int order = 1);
 
+        /**
+         * @brief Hint that a folder is likely to be opened soon
+         *
+         * The child list of the folder is loaded into the in-memory node cache in the
+         * background, at low priority, so a subsequent MegaApi::getChildren call for it
+         * does not have to touch the local database. This is a pure hint: it produces
+         * no callbacks and it is safe to call it speculatively (e.g. when the user
+         * hovers a folder one tap away).
+         *
+         * Pending hints can be abandoned with MegaApi::cancelPrefetch when navigation
+         * moves elsewhere.
+         *
+         * @param node Folder expected to be opened soon
+         */
+        void prefetchNode(MegaNode *node);
+
+#ifdef ENABLE_CHAT
+        /**
+         * @brief Hint that a chatroom is likely to be opened soon
+         *
+         * Chatroom metadata that is parsed lazily (node attachments, scheduled
+         * meetings) is hydrated in the background, at low priority, so opening the
+         * chat does not pay that cost on first use. This is a pure hint: it produces
+         * no callbacks and unknown chat handles are ignored.
+         *
+         * Pending hints can be abandoned with MegaApi::cancelPrefetch when navigation
+         * moves elsewhere.
+         *
+         * @param chatid MegaHandle that identifies the chat room
+         */
+        void prefetchChat(MegaHandle chatid);
+#endif
+
+        /**
+         * @brief Abandon prefetch hints that have not run yet
+         *
+         * Call this when navigation changes so that warming queued for the previous
+         * location does not compete with the content the user actually opened.
+         * Hints issued after this call are unaffected.
+         */
+        void cancelPrefetch();
+
         /**
          * @brief Get all versions of a file
          * @param node Node to check
@@ -16957,6 +17532,28 @@ class MegaApi
         */
         MegaUserAlertList* getUserAlerts();
 
+        /**
+        * @brief Load older user alerts from the local cache into memory
+        *
+        * Only the newest page of alerts is kept in memory; older ones remain
+        * in the local cache in serialized form. This call materializes up to
+        * count additional older alerts, after which they are included in the
+        * list returned by MegaApi::getUserAlerts.
+        *
+        * @param count Maximum number of older alerts to load
+        * @return Number of alerts actually loaded, 0 when none are left
+        */
+        int loadMoreUserAlerts(int count);
+
+        /**
+        * @brief Get the number of older user alerts still in the local cache
+        *
+        * These can be brought into memory with MegaApi::loadMoreUserAlerts.
+        *
+        * @return Number of alerts available for loading
+        */
+        int getUnloadedUserAlertCount();
+
         /**
          * @brief Get the number of unread user alerts for the logged in user
          *
@@ -17720,6 +18317,28 @@ class MegaApi
          */
         MegaNodeList* search(const MegaSearchFilter* filter, int order = ORDER_NONE, MegaCancelToken* cancelToken = nullptr);
 
+        /**
+         * @brief Search nodes and return only a window of the results
+         *
+         * Same as search(const MegaSearchFilter*, int, MegaCancelToken*) but only
+         * the requested page of the result set is built and returned: matches are
+         * still collected and ordered internally, and only the nodes inside the
+         * window are wrapped as MegaNode objects.
+         *
+         * There is no snapshot isolation between pages: if the account changes
+         * between calls, the window may shift.
+         *
+         * You take the ownership of the returned value
+         *
+         * @param filter Container for filtering options, same as search()
+         * @param order Order for the returned list, same values as search()
+         * @param cancelToken MegaCancelToken to be able to cancel the search at any time.
+         * @param searchPage Window over the result set; nullptr behaves like no windowing
+         *
+         * @return List with the requested page of found nodes as MegaNode objects
+         */
+        MegaNodeList* search(const MegaSearchFilter* filter, int order, MegaCancelToken* cancelToken, const MegaSearchPage* searchPage);
+
         /**
          * @brief Search nodes containing a search string in their name
          *
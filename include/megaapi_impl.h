@@ -24,6 +24,9 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 #include "mega.h"
 #include "mega/gfx/external.h"
@@ -74,7 +77,13 @@ class MegaSemaphore : public CppSemaphore {};
 #endif
 
 #if USE_FREEIMAGE
+#ifdef HAVE_TURBOJPEG
+// FreeImage pipeline with JPEGs decoded by libjpeg-turbo's SIMD paths,
+// falling back to plain FreeImage per image
+using MegaGfxProvider = GfxProviderTurboJpeg;
+#else
 using MegaGfxProvider = GfxProviderFreeImage;
+#endif
 #elif TARGET_OS_IPHONE
 using MegaGfxProvider = GfxProviderCG;
 #else
@@ -641,6 +650,8 @@ class MegaNodePrivate : public MegaNode, public Cacheable
     protected:
         MegaNodePrivate(Node *node);
         int type;
+        // interned: identical values share one refcounted allocation, so these
+        // must only ever be assigned from the pool in megaapi_impl.cpp
         const char *name;
         const char *fingerprint;
         const char *originalfingerprint;
@@ -683,6 +694,16 @@ class MegaNodePrivate : public MegaNode, public Cacheable
         bool mMarkedSensitive = false; // sensitive attribute set on this node
         nodelabel_t mLabel;
         bool mIsNodeKeyDecrypted = false;
+
+        // Snapshot of the node's attribute map, taken by MegaNodePrivate(Node*)
+        // instead of walking the attributes up front. The fields derived from it
+        // (custom attrs, coordinates, duration, label, fingerprint fallback...)
+        // are only parsed out when one of them is first read; nodes handed out
+        // in lists rarely get that far
+        void ensureAttrDerivedFields();
+        LazyAttrMap mDeferredAttrs;
+        std::unique_ptr<SymmCipher> mUnshareableCipher;  // "gp" decryption needs the master key, so the cipher is derived at snapshot time
+        bool mAttrsDeferred = false;
 };
 
 
@@ -939,7 +960,8 @@ public:
     void addMegaHandle(MegaHandle megaHandle) override;
 
 private:
-    std::vector<MegaHandle> mList;
+    // copy-on-write backing, same scheme as MegaStringListPrivate
+    std::shared_ptr<std::vector<MegaHandle>> mList;
 };
 
 class MegaIntegerListPrivate : public MegaIntegerList
@@ -1050,6 +1072,20 @@ class MegaTransferPrivate : public MegaTransfer, public Cacheable
         virtual ~MegaTransferPrivate();
 
         MegaTransfer *copy() override;
+
+        // live progress counters: written with atomic stores on the SDK thread and
+        // safe to sample from any thread without taking sdkMutex
+        // (see MegaApi::getTransferProgressByTag)
+        struct ProgressCounters
+        {
+            std::atomic<long long> transferredBytes{0};
+            std::atomic<long long> totalBytes{0};
+            std::atomic<long long> speed{0};
+            std::atomic<long long> meanSpeed{0};
+        };
+
+        const std::shared_ptr<ProgressCounters>& getProgressCounters() const { return mProgress; }
+
 	    Transfer *getTransfer() const;
         void setTransfer(Transfer *transfer);
         void setStartTime(int64_t startTime);
@@ -1069,6 +1105,7 @@ class MegaTransferPrivate : public MegaTransfer, public Cacheable
 		void setTag(int tag);
 		void setSpeed(long long speed);
         void setMeanSpeed(long long meanSpeed);
+        void setStats(const string& stats);
 		void setDeltaSize(long long deltaSize);
         void setUpdateTime(int64_t updateTime);
         void setPublicNode(MegaNode *publicNode, bool copyChildren = false);
@@ -1117,6 +1154,7 @@ class MegaTransferPrivate : public MegaTransfer, public Cacheable
         int getTag() const override;
         long long getSpeed() const override;
         long long getMeanSpeed() const override;
+        const char* getStats() const override;
         long long getDeltaSize() const override;
         int64_t getUpdateTime() const override;
         virtual MegaNode *getPublicNode() const;
@@ -1195,12 +1233,17 @@ protected:
         int64_t startTime;
         int64_t updateTime;
         int64_t time;
-        long long transferredBytes;
-        long long totalBytes;
-        long long speed;
-        long long meanSpeed;
+
+        // holds transferredBytes, totalBytes, speed and meanSpeed; each copy of the
+        // transfer gets its own counters, so copies remain independent snapshots
+        std::shared_ptr<ProgressCounters> mProgress;
+
         long long deltaSize;
         long long notificationNumber;
+
+        // histogram summary captured when the transfer completed or failed
+        string mStats;
+
         MegaHandle nodeHandle;
         MegaHandle parentHandle;
         const char* path;
@@ -1467,6 +1510,14 @@ public:
     int getFileCount() const override { return stats.numFiles; }
     int getUploadCount() const override { return stats.numUploads; }
     int getDownloadCount() const override { return stats.numDownloads; }
+    long long getScannedFolderCount() const override { return (long long)stats.scannedFolders; }
+    long long getScannedItemCount() const override { return (long long)stats.scannedItems; }
+    long long getFilterEvaluationCount() const override { return (long long)stats.filterEvaluations; }
+    long long getMoveCheckCount() const override { return (long long)stats.moveChecks; }
+    long long getFolderVisitCount() const override { return (long long)stats.folderVisits; }
+    int getQueuedNotificationCount() const override { return (int)stats.queuedNotifications; }
+    int getQueuedDbChangeCount() const override { return (int)stats.queuedDbChanges; }
+    int getLastDbFlushMs() const override { return (int)stats.lastDbFlushMs; }
     MegaSyncStatsPrivate *copy() const override { return new MegaSyncStatsPrivate(*this); }
 };
 
@@ -1506,6 +1557,15 @@ class MegaRequestPrivate : public MegaRequest
         std::function<error()> performRequest;
         std::function<error(TransferDbCommitter&)> performTransferRequest;
 
+        // Read-scoped alternative to performRequest: the body must not mutate
+        // client state, so sendPendingRequests() may run it on a client worker
+        // thread holding the SDK lock shared, concurrently with other
+        // read-scoped requests. Unlike performRequest, the body must NOT call
+        // fireOnRequestFinish itself (it may be running off the SDK thread):
+        // it fills in the request's results and returns the outcome, and the
+        // dispatcher marshals the completion back to the SDK thread
+        std::function<error()> performReadOnlyRequest;
+
         // perform fireOnRequestFinish in sendPendingReqeusts()
         // See fireOnRequestFinish
         std::function<void()> performFireOnRequestFinish;
@@ -2131,7 +2191,7 @@ private:
 class MegaStringListPrivate : public MegaStringList
 {
 public:
-    MegaStringListPrivate() = default;
+    MegaStringListPrivate();
     MegaStringListPrivate(string_vector&&); // takes ownership
     virtual ~MegaStringListPrivate() = default;
     MegaStringList *copy() const override;
@@ -2141,7 +2201,11 @@ public:
     const string_vector& getVector();
 protected:
     MegaStringListPrivate(const MegaStringListPrivate& stringList) = default;
-    string_vector mList;
+
+    // copy-on-write backing: copy() shares the buffer and the first add()
+    // on a shared list detaches a private one, so handing result lists
+    // across the binding boundary never duplicates the strings
+    std::shared_ptr<string_vector> mList;
 };
 
 bool operator==(const MegaStringList& lhs, const MegaStringList& rhs);
@@ -2185,7 +2249,11 @@ class MegaNodeListPrivate : public MegaNodeList
         MegaNodeListPrivate();
         MegaNodeListPrivate(Node** newlist, int size);
         MegaNodeListPrivate(const MegaNodeListPrivate *nodeList, bool copyChildren = false);
-        MegaNodeListPrivate(sharedNode_vector& v);
+
+        // with deferNodeCopies, entries are copied out of the Node objects on
+        // first get() instead of up front: one list can then be handed to
+        // every listener of an update without copying nodes nobody looks at
+        MegaNodeListPrivate(sharedNode_vector& v, bool deferNodeCopies = false);
         MegaNodeListPrivate(sharedNode_list& l);
         virtual ~MegaNodeListPrivate();
         MegaNodeList *copy() const override;
@@ -2198,8 +2266,13 @@ class MegaNodeListPrivate : public MegaNodeList
         void addNode(std::unique_ptr<MegaNode> node);
 
 	protected:
-		MegaNode** list;
+        // entries may start out null (deferred copies) and be filled in by
+        // get(), hence mutable
+        mutable MegaNode** list;
 		int s;
+
+        // keeps the Nodes of a deferred-copy list alive; empty otherwise
+        sharedNode_vector mSourceNodes;
 };
 
 class MegaChildrenListsPrivate : public MegaChildrenLists
@@ -2437,12 +2510,32 @@ private:
     MegaFilePut() {}
 };
 
-//Thread safe request queue
+// Thread safe request queue.  Producers (any thread calling into MegaApi)
+// push with a single atomic exchange onto a lock-free LIFO list; the SDK
+// thread drains that list in one go into a private deque, which restores
+// submission order and serves pop().  pop(), front() and removeListener()
+// are only ever called with the SDK lock held, so the deque itself needs
+// no lock of its own.
 class RequestQueue
 {
     protected:
+        struct QueuedRequest
+        {
+            MegaRequestPrivate* request;
+            QueuedRequest* next;
+            bool atFront;
+        };
+
+        // incoming lock-free list, newest first
+        std::atomic<QueuedRequest*> incoming{nullptr};
+
+        // drained requests in submission order; SDK-lock holders only
         std::deque<MegaRequestPrivate *> requests;
-        std::mutex mutex;
+
+        void pushNode(MegaRequestPrivate* request, bool atFront);
+
+        // move everything from the incoming list into the deque
+        void drainIncoming();
 
     public:
         RequestQueue();
@@ -2450,6 +2543,10 @@ class RequestQueue
         void push_front(MegaRequestPrivate *request);
         MegaRequestPrivate * pop();
         MegaRequestPrivate * front();
+
+        // true if a pop() would return something; consumer thread only
+        bool hasPending();
+
         void removeListener(MegaRequestListener *listener);
         void removeListener(MegaScheduledCopyListener *listener);
 };
@@ -2459,13 +2556,17 @@ class RequestQueue
 class TransferQueue
 {
     protected:
-        std::deque<MegaTransferPrivate *> transfers;
+        // lazy-bulk-erase deque: cancelling a folder or a long listener-owned
+        // batch marks entries and compacts once, instead of shuffling the
+        // whole deque per removed transfer
+        deque_with_lazy_bulk_erase<MegaTransferPrivate *> transfers;
         std::mutex mutex;
         int lastPushedTransferTag = 0;
 
     public:
         TransferQueue();
         void push(MegaTransferPrivate *transfer);
+        void pushAll(const std::vector<MegaTransferPrivate *>& batch);
         void push_front(MegaTransferPrivate *transfer);
         MegaTransferPrivate * pop();
         bool empty();
@@ -2795,6 +2896,23 @@ private:
 };
 
 
+class MegaSearchPagePrivate : public MegaSearchPage
+{
+public:
+    MegaSearchPagePrivate(size_t startingOffset, size_t size)
+        : mStartingOffset(startingOffset), mSize(size) {}
+
+    MegaSearchPagePrivate* copy() const override { return new MegaSearchPagePrivate(*this); }
+
+    size_t startingOffset() const override { return mStartingOffset; }
+    size_t size() const override { return mSize; }
+
+private:
+    size_t mStartingOffset;
+    size_t mSize;
+};
+
+
 class MegaApiImpl : public MegaApp
 {
     public:
@@ -2963,6 +3081,7 @@ class MegaApiImpl : public MegaApp
         void setThumbnailByHandle(MegaNode* node, MegaHandle attributehandle, MegaRequestListener *listener = NULL);
         void getPreview(MegaNode* node, const char *dstFilePath, MegaRequestListener *listener = NULL);
 		void cancelGetPreview(MegaNode* node, MegaRequestListener *listener = NULL);
+        void setThumbnailPriority(MegaHandle handle, bool priority);
         void setPreview(MegaNode* node, const char *srcFilePath, MegaRequestListener *listener = NULL);
         void putPreview(MegaBackgroundMediaUpload* node, const char *srcFilePath, MegaRequestListener *listener = NULL);
         void setPreviewByHandle(MegaNode* node, MegaHandle attributehandle, MegaRequestListener *listener = NULL);
@@ -3050,11 +3169,14 @@ class MegaApiImpl : public MegaApp
         void startUploadForSupport(const char* localPath, bool isSourceFileTemporary, FileSystemType fsType, MegaTransferListener* listener);
         void startUpload(bool startFirst, const char* localPath, MegaNode* parent, const char* fileName, const char* targetUser, int64_t mtime, int folderTransferTag, bool isBackup, const char* appData, bool isSourceFileTemporary, bool forceNewUpload, FileSystemType fsType, CancelToken cancelToken, MegaTransferListener* listener);
         MegaTransferPrivate* createUploadTransfer(bool startFirst, const char *localPath, MegaNode *parent, const char *fileName, const char *targetUser, int64_t mtime, int folderTransferTag, bool isBackup, const char *appData, bool isSourceFileTemporary, bool forceNewUpload, FileSystemType fsType, CancelToken cancelToken, MegaTransferListener *listener, const FileFingerprint* preFingerprintedFile = nullptr);
+        void startUploadBatch(bool startFirst, const MegaStringList* localPaths, MegaNode* parent, int64_t mtime, CancelToken cancelToken, MegaTransferListener* listener);
         void startDownload (bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener);
+        void startDownloadBatch(bool startFirst, MegaNodeList* nodes, const char* localFolder, CancelToken cancelToken, int collisionCheck, int collisionResolution, MegaTransferListener* listener);
         MegaTransferPrivate* createDownloadTransfer(bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener, FileSystemType fsType);
         void startStreaming(MegaNode* node, m_off_t startPos, m_off_t size, MegaTransferListener *listener);
         void setStreamingMinimumRate(int bytesPerSecond);
         void retryTransfer(MegaTransfer *transfer, MegaTransferListener *listener = NULL);
+        void signalTransferCancel(int transferTag);
         void cancelTransfer(MegaTransfer *transfer, MegaRequestListener *listener=NULL);
         void cancelTransferByTag(int transferTag, MegaRequestListener *listener = NULL);
         void cancelTransfers(int direction, MegaRequestListener *listener=NULL);
@@ -3072,11 +3194,22 @@ class MegaApiImpl : public MegaApp
         void setUploadMethod(int method);
         bool setMaxDownloadSpeed(m_off_t bpslimit);
         bool setMaxUploadSpeed(m_off_t bpslimit);
+        bool setMaxDownloadSpeed(int trafficClass, m_off_t bpslimit);
+        bool setMaxUploadSpeed(int trafficClass, m_off_t bpslimit);
+        void setSocketTuning(int receiveBufferSize, int sendBufferSize, const char* congestionAlgorithm, int notSentLowat);
         int getMaxDownloadSpeed();
         int getMaxUploadSpeed();
         int getCurrentDownloadSpeed();
         int getCurrentUploadSpeed();
         int getCurrentSpeed(int type);
+        char *getRetryTelemetry();
+        char *getPerformanceCounters();
+        char *getMemoryUsage();
+        char *getStallSamples();
+        bool startPerformanceTrace(const char *path);
+        void stopPerformanceTrace();
+        bool startWireCapture(const char *path);
+        void stopWireCapture();
         int getDownloadMethod();
         int getUploadMethod();
         MegaTransferData *getTransferData(MegaTransferListener *listener = NULL);
@@ -3085,6 +3218,7 @@ class MegaApiImpl : public MegaApp
         MegaTransferList *getTransfers();
         MegaTransferList *getStreamingTransfers();
         MegaTransfer* getTransferByTag(int transferTag);
+        bool getTransferProgressByTag(int transferTag, long long* transferredBytes, long long* totalBytes, long long* speed, long long* meanSpeed);
         MegaTransferList *getTransfers(int type);
         MegaTransferList *getChildTransfers(int transferTag);
         MegaTransferList *getTansfersByFolderTag(int folderTransferTag);
@@ -3188,6 +3322,10 @@ class MegaApiImpl : public MegaApp
         void resetTotalUploads();
         void updateStats();
         void setLRUCacheSize(unsigned long long size);
+        void setLRUCacheMaxBytes(unsigned long long maxBytes);
+        unsigned long long getLRUCacheHits();
+        unsigned long long getLRUCacheMisses();
+        void setChildrenPrefetchEnabled(bool enable);
         unsigned long long getNumNodes();
         unsigned long long getAccurateNumNodes();
         long long getTotalDownloadedBytes();
@@ -3199,9 +3337,14 @@ class MegaApiImpl : public MegaApp
 		int getNumChildren(MegaNode* parent);
 		int getNumChildFiles(MegaNode* parent);
         int getNumChildFolders(MegaNode* parent);
-        MegaNodeList* getChildren(const MegaSearchFilter* filter, int order, CancelToken cancelToken = CancelToken());
+        MegaNodeList* getChildren(const MegaSearchFilter* filter, int order, CancelToken cancelToken = CancelToken(), const MegaSearchPage* searchPage = nullptr);
         MegaNodeList* getChildren(const MegaNode *parent, int order, CancelToken cancelToken = CancelToken());
         MegaNodeList* getChildren(MegaNodeList *parentNodes, int order);
+        void prefetchNode(MegaNode* node);
+#ifdef ENABLE_CHAT
+        void prefetchChat(MegaHandle chatid);
+#endif
+        void cancelPrefetch();
         MegaNodeList* getVersions(MegaNode *node);
         int getNumVersions(MegaNode *node);
         bool hasVersions(MegaNode *node);
@@ -3221,6 +3364,8 @@ class MegaApiImpl : public MegaApp
         MegaUserList* getContacts();
         MegaUser* getContact(const char* uid);
         MegaUserAlertList* getUserAlerts();
+        int loadMoreUserAlerts(int count);
+        int getUnloadedUserAlertCount();
         int getNumUnreadUserAlerts();
         MegaNodeList *getInShares(MegaUser* user, int order);
         MegaNodeList *getInShares(int order);
@@ -3286,7 +3431,7 @@ public:
         MegaRecentActionBucketList* getRecentActions(unsigned days = 90, unsigned maxnodes = 500);
         void getRecentActionsAsync(unsigned days, unsigned maxnodes, MegaRequestListener *listener = NULL);
 
-        MegaNodeList* search(const MegaSearchFilter* filter, int order, CancelToken cancelToken);
+        MegaNodeList* search(const MegaSearchFilter* filter, int order, CancelToken cancelToken, const MegaSearchPage* searchPage = nullptr);
 
         // deprecated
         MegaNodeList* search(MegaNode *node, const char *searchString, CancelToken cancelToken, bool recursive = true, int order = MegaApi::ORDER_NONE, int mimeType = MegaApi::FILE_TYPE_DEFAULT, int target = MegaApi::SEARCH_TARGET_ALL, bool includeSensitive = true);
@@ -3584,6 +3729,13 @@ public:
         void fireOnTransferTemporaryError(MegaTransferPrivate *transfer, unique_ptr<MegaErrorPrivate> e);
         map<int, MegaTransferPrivate *> transferMap;
 
+        // counters of transfers between onTransferStart and onTransferFinish, so
+        // progress can be sampled from any thread without taking sdkMutex.  The
+        // mutex guards only this map and is never held while transfers are
+        // processed or callbacks fired.
+        std::mutex transferProgressMutex;
+        map<int, std::shared_ptr<MegaTransferPrivate::ProgressCounters>> transferProgressMap;
+
 
         MegaClient *getMegaClient();
         static FileFingerprint *getFileFingerprintInternal(const char *fingerprint);
@@ -3671,6 +3823,29 @@ private:
         mutex fingerprintingFsAccessMutex;
         MegaFileSystemAccess fingerprintingFsAccess;
 
+        // Capped MRU-first cache of upload fingerprints keyed by local path,
+        // revalidated by size+mtime (the same change heuristic transfer
+        // resume uses). A nightly backup re-uploading an unchanged tree gets
+        // its fingerprints from here instead of re-reading CRC samples from
+        // every file. Guarded by fingerprintingFsAccessMutex
+        struct CachedUploadFingerprint
+        {
+            std::string path;
+            FileFingerprint fingerprint;
+        };
+        std::list<CachedUploadFingerprint> mUploadFingerprints;
+        std::map<std::string, std::list<CachedUploadFingerprint>::iterator> mUploadFingerprintByPath;
+        static const size_t MAXUPLOADFINGERPRINTS = 131072;
+
+        // Result of the last successful account details fetch, used to answer
+        // repeat polls locally while it is fresh. Invalidated by account and
+        // storage actionpackets, on logout, and after MAXACCOUNTDETAILSAGE.
+        // Only accessed from the client thread
+        std::shared_ptr<AccountDetails> mCachedAccountDetails;
+        int mCachedAccountDetailsFlags = 0;
+        dstime mCachedAccountDetailsTime = 0;
+        static const dstime MAXACCOUNTDETAILSAGE = 3000; // deciseconds (5 minutes)
+
         mutex mLastRecievedLoggedMeMutex;
         sessiontype_t mLastReceivedLoggedInState = NOTLOGGEDIN;
         handle mLastReceivedLoggedInMeHandle = UNDEF;
@@ -3728,9 +3903,172 @@ private:
 
         set<MegaGlobalListener *> globalListeners;
         set<MegaListener *> listeners;
+
+        // per-listener callback timing, keyed by listener address: a blocking
+        // app listener stalls the whole dispatch loop, and these figures name
+        // the culprit.  Guarded by listenerStatsMutex so the report can be
+        // read without the SDK lock.
+        struct ListenerStats
+        {
+            uint64_t calls = 0;
+            uint64_t totalUs = 0;
+            uint64_t maxUs = 0;
+            const char* maxCallback = nullptr;  // name of the slowest callback seen
+        };
+        map<const void*, ListenerStats> listenerStats;
+        std::mutex listenerStatsMutex;
+
+        // RAII timer around one app listener invocation; accumulates stats
+        // and logs a warning when the callback blocked for too long
+        class CallbackWatch
+        {
+            MegaApiImpl* mApi;
+            const void* mListener;
+            const char* mCallback;
+            std::chrono::steady_clock::time_point mStart;
+
+        public:
+            CallbackWatch(MegaApiImpl* api, const void* listener, const char* callback);
+            ~CallbackWatch();
+        };
+
         retryreason_t waitingRequest;
-        std::recursive_timed_mutex sdkMutex;
-        using SdkMutexGuard = std::unique_lock<std::recursive_timed_mutex>;   // (equivalent to typedef)
+        // The SDK lock, in reader/writer form.  The SDK thread and every
+        // mutating entrypoint take it exclusively, exactly as the old
+        // recursive_timed_mutex was taken; pure node-read accessors take it
+        // shared, so concurrent reads (eg. a GUI thread walking the tree) no
+        // longer serialize behind one another.  Exclusive acquisition is
+        // recursive, since listener callbacks re-enter the API from the SDK
+        // thread, and shared acquisition degrades to a recursion count on a
+        // thread that already holds the lock exclusively (same callbacks,
+        // calling read accessors).  A thread holding only a shared lock must
+        // never request the exclusive one - that is the classic upgrade
+        // deadlock - so shared use stays confined to leaf, read-only
+        // accessors that call back into nothing.
+        class SdkMutex
+        {
+        public:
+            void lock()
+            {
+                if (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                {
+                    ++mDepth;
+                    return;
+                }
+                assert(mSharedDepth == 0);  // no shared-to-exclusive upgrades
+                mMutex.lock();
+                mOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                mDepth = 1;
+            }
+
+            bool try_lock()
+            {
+                if (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                {
+                    ++mDepth;
+                    return true;
+                }
+                if (!mMutex.try_lock())
+                {
+                    return false;
+                }
+                mOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                mDepth = 1;
+                return true;
+            }
+
+            template<class Rep, class Period>
+            bool try_lock_for(const std::chrono::duration<Rep, Period>& timeout)
+            {
+                if (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                {
+                    ++mDepth;
+                    return true;
+                }
+                if (!mMutex.try_lock_for(timeout))
+                {
+                    return false;
+                }
+                mOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                mDepth = 1;
+                return true;
+            }
+
+            void unlock()
+            {
+                assert(mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id());
+                if (--mDepth == 0)
+                {
+                    mOwner.store(std::thread::id(), std::memory_order_relaxed);
+                    mMutex.unlock();
+                }
+            }
+
+            void lock_shared()
+            {
+                if (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                {
+                    // already exclusive on this thread: everyone else is
+                    // excluded anyway, just count the recursion
+                    ++mDepth;
+                    return;
+                }
+                if (mSharedDepth++ == 0)
+                {
+                    mMutex.lock_shared();
+                }
+            }
+
+            bool try_lock_shared()
+            {
+                if (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                {
+                    ++mDepth;
+                    return true;
+                }
+                if (mSharedDepth == 0 && !mMutex.try_lock_shared())
+                {
+                    return false;
+                }
+                ++mSharedDepth;
+                return true;
+            }
+
+            void unlock_shared()
+            {
+                if (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                {
+                    // guards are scoped, so the exclusive hold this nested
+                    // into is necessarily still in place: just undo the count
+                    assert(mDepth > 1);
+                    --mDepth;
+                    return;
+                }
+                assert(mSharedDepth > 0);
+                if (--mSharedDepth == 0)
+                {
+                    mMutex.unlock_shared();
+                }
+            }
+
+        private:
+            std::shared_timed_mutex mMutex;
+
+            // which thread holds the lock exclusively, if any.  Only ever
+            // compared against the reading thread's own id, so relaxed
+            // ordering suffices: a thread always observes its own stores.
+            std::atomic<std::thread::id> mOwner;
+
+            // exclusive recursion depth; touched only by the owning thread
+            unsigned mDepth = 0;
+
+            // shared recursion depth of the current thread
+            static thread_local unsigned mSharedDepth;
+        };
+
+        SdkMutex sdkMutex;
+        using SdkMutexGuard = std::unique_lock<SdkMutex>;   // (equivalent to typedef)
+        using SdkReadGuard = std::shared_lock<SdkMutex>;    // node-read accessors only
         MegaTransferPrivate *currentTransfer;
         string appKey;
 
@@ -3742,6 +4080,12 @@ private:
         set<LocalPath> syncPathStateDeferredSet;
         mutex syncPathStateDeferredSetMutex;
 
+        // cancellation for prefetch hints: warming jobs capture the token that
+        // was current when the hint arrived; cancelPrefetch() trips it and
+        // installs a fresh one for subsequent hints
+        mutex mPrefetchMutex;
+        CancelToken mPrefetchToken{ false };
+
         int threadExit;
         void loop();
 
@@ -4154,6 +4498,10 @@ public:
     size_t availableCapacity() const;
     // Get the uv_buf_t for the consumer with as much buffered data as possible
     uv_buf_t nextBuffer();
+    // Same as nextBuffer, but returns both segments of a wrapped ring as separate
+    // buffers (up to 2) for a single scatter-gather write, instead of truncating
+    // the output at the end of the circular buffer. Returns the number of buffers.
+    unsigned nextBuffers(uv_buf_t (&bufs)[2]);
     // Increase the free data counter
     void freeData(size_t len);
     // Set upper bound limit for capacity
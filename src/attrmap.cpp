@@ -21,7 +21,230 @@
 
 #include "mega/attrmap.h"
 
+#include <new>
+
 namespace mega {
+
+namespace {
+
+// parse one serialized attribute record; returns NULL at the end of the blob
+const char* parseAttrRecord(const char* ptr, const char* end, nameid& id, const char*& value, unsigned short& valuelen)
+{
+    unsigned char l;
+
+    if (ptr >= end || !(l = static_cast<unsigned char>(*ptr++)))
+    {
+        return NULL;
+    }
+
+    if (ptr + l + sizeof valuelen > end)
+    {
+        return NULL;
+    }
+
+    id = 0;
+    while (l--)
+    {
+        id = (id << 8) + static_cast<unsigned char>(*ptr++);
+    }
+
+    valuelen = MemAccess::get<short>(ptr);
+    ptr += sizeof valuelen;
+
+    if (ptr + valuelen > end)
+    {
+        return NULL;
+    }
+
+    value = ptr;
+    return ptr + valuelen;
+}
+
+} // anonymous namespace
+
+std::mutex LazyAttrMap::mParseMutex;
+
+LazyAttrMap& LazyAttrMap::operator=(const attr_map& m)
+{
+    mMap = m;
+    mBlob.clear();
+    clearQuickCache();
+    mPending = false;
+    return *this;
+}
+
+LazyAttrMap& LazyAttrMap::operator=(const LazyAttrMap& other)
+{
+    clearQuickCache();
+
+    if (other.mPending.load(std::memory_order_acquire))
+    {
+        // a concurrent reader may be caching entries into 'other'
+        std::lock_guard<std::mutex> g(mParseMutex);
+        mMap = other.mMap;
+        mBlob = other.mBlob;
+        mPending = !mBlob.empty();
+        return *this;
+    }
+
+    mMap = other.mMap;
+    mBlob.clear();
+    mPending = false;
+    return *this;
+}
+
+void LazyAttrMap::adoptBlob(const char* ptr, size_t len)
+{
+    mMap.clear();
+    clearQuickCache();
+    mBlob.assign(ptr, len);
+    mPending = len > 0;
+}
+
+const string* LazyAttrMap::getquick(nameid id) const
+{
+    if (!mPending.load(std::memory_order_acquire))
+    {
+        // fully materialized: immutable under shared SDK locking
+        attr_map::const_iterator it = mMap.find(id);
+        return it == mMap.end() ? NULL : &it->second;
+    }
+
+    // still pending: several readers holding the SDK lock shared may probe
+    // this map at once, so the quick cache and blob need serializing.
+    // Cached entries live in a deque, whose elements never move, so
+    // returned pointers outlive the lock (and the later materialization)
+    std::lock_guard<std::mutex> g(mParseMutex);
+
+    // entries parsed out of the blob so far
+    if (const string* cached = findQuickEntry(id))
+    {
+        return cached;
+    }
+
+    if (!mPending)
+    {
+        return NULL;
+    }
+
+    const char* ptr = mBlob.data();
+    const char* end = ptr + mBlob.size();
+    nameid recordId;
+    const char* value;
+    unsigned short valuelen;
+
+    while ((ptr = parseAttrRecord(ptr, end, recordId, value, valuelen)))
+    {
+        if (recordId == id)
+        {
+            return addQuickEntry(id, value, valuelen);
+        }
+    }
+
+    return NULL;
+}
+
+void LazyAttrMap::serialize(string* d) const
+{
+    if (mPending.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> g(mParseMutex);
+        if (mPending)
+        {
+            // the blob already is the serialized form
+            d->append(mBlob);
+            return;
+        }
+    }
+
+    char buf[8];
+    unsigned char l;
+    unsigned short ll;
+
+    for (attr_map::const_iterator it = mMap.begin(); it != mMap.end(); it++)
+    {
+        if ((l = (unsigned char)AttrMap::nameid2string(it->first, buf)))
+        {
+            d->append((char*)&l, sizeof l);
+            d->append(buf, l);
+            ll = (unsigned short)it->second.size();
+            d->append((char*)&ll, sizeof ll);
+            d->append(it->second.data(), ll);
+        }
+    }
+}
+
+void LazyAttrMap::clear()
+{
+    mMap.clear();
+    mBlob.clear();
+    clearQuickCache();
+    mPending = false;
+}
+
+const string* LazyAttrMap::findQuickEntry(nameid id) const
+{
+    for (const QuickEntry* entry = mQuickCache; entry; entry = entry->mNext)
+    {
+        if (entry->mId == id)
+        {
+            return &entry->mValue;
+        }
+    }
+
+    return NULL;
+}
+
+const string* LazyAttrMap::addQuickEntry(nameid id, const char* value, unsigned short valuelen) const
+{
+    void* block = FixedBlockPool::poolFor(sizeof(QuickEntry)).allocate();
+    QuickEntry* entry = new (block) QuickEntry{mQuickCache, id, string(value, valuelen)};
+    mQuickCache = entry;
+    return &entry->mValue;
+}
+
+void LazyAttrMap::clearQuickCache()
+{
+    while (QuickEntry* entry = mQuickCache)
+    {
+        mQuickCache = entry->mNext;
+        entry->~QuickEntry();
+        FixedBlockPool::poolFor(sizeof(QuickEntry)).deallocate(entry);
+    }
+}
+
+attr_map& LazyAttrMap::materialized() const
+{
+    if (mPending.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> g(mParseMutex);
+
+        if (mPending)
+        {
+            // note that mQuickCache is left alone: pointers handed out by
+            // getquick() must stay valid, and its entries are verbatim
+            // copies of the blob records parsed here anyway
+            const char* ptr = mBlob.data();
+            const char* end = ptr + mBlob.size();
+            nameid id;
+            const char* value;
+            unsigned short valuelen;
+
+            while ((ptr = parseAttrRecord(ptr, end, id, value, valuelen)))
+            {
+                mMap[id].assign(value, valuelen);
+            }
+
+            mBlob.clear();
+
+            // release ordering: a reader seeing !mPending must see the built map
+            mPending.store(false, std::memory_order_release);
+        }
+    }
+
+    return mMap;
+}
+
 // approximate raw storage size of serialized AttrMap, not taking JSON escaping
 // or name length into account
 unsigned AttrMap::storagesize(int perrecord) const
@@ -108,46 +331,28 @@ nameid AttrMap::string2nameid(const char *a)
 // generate binary serialize of attr_map name-value pairs
 void AttrMap::serialize(string* d) const
 {
-    char buf[8];
-    unsigned char l;
-    unsigned short ll;
-
-    for (attr_map::const_iterator it = map.begin(); it != map.end(); it++)
-    {
-        if ((l = (unsigned char)nameid2string(it->first, buf)))
-        {
-            d->append((char*)&l, sizeof l);
-            d->append(buf, l);
-            ll = (unsigned short)it->second.size();
-            d->append((char*)&ll, sizeof ll);
-            d->append(it->second.data(), ll);
-        }
-    }
-
+    map.serialize(d);
     d->append("", 1);
 }
 
 // read binary serialize, return final offset
 const char* AttrMap::unserialize(const char* ptr , const char *end)
 {
+    // validate and measure the blob without building the map: parsing is
+    // deferred until the attributes are actually inspected
+    const char* start = ptr;
+    const char* blobEnd = ptr;
     unsigned char l;
     unsigned short ll;
-    nameid id;
 
     while ((ptr < end) && (l = *ptr++))
     {
-        id = 0;
-
         if (ptr + l + sizeof ll > end)
         {
             return NULL;
         }
 
-        while (l--)
-        {
-            id = (id << 8) + (unsigned char)*ptr++;
-        }
-
+        ptr += l;
         ll = MemAccess::get<short>(ptr);
         ptr += sizeof ll;
 
@@ -156,10 +361,12 @@ const char* AttrMap::unserialize(const char* ptr , const char *end)
             return NULL;
         }
 
-        map[id].assign(ptr, ll);
         ptr += ll;
+        blobEnd = ptr;   // excludes a trailing terminator byte
     }
 
+    map.adoptBlob(start, static_cast<size_t>(blobEnd - start));
+
     return ptr;
 }
 
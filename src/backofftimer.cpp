@@ -42,14 +42,18 @@ void BackoffTimer::backoff()
 {
     next = Waiter::ds + delta;
 
-    base <<= 1;
-
-    if (base > 6000)
+    // decorrelated jitter: draw the next delay uniformly from
+    // [base, 3 * previous delay] (capped at 10 minutes) instead of doubling
+    // a shared ladder with a little jitter on top.  Devices whose retries
+    // were synchronized by a common outage drift apart within a few rounds
+    // rather than hitting the servers in waves
+    dstime upper = delta > 2000 ? 6000 : delta * 3;
+    if (upper <= base)
     {
-        base = 6000;
+        upper = base + 1;
     }
 
-    delta = base + (dstime)((base / 2.0) * (rng.genuint32(RAND_MAX)/((double)RAND_MAX)));
+    delta = base + (dstime)((upper - base) * (rng.genuint32(RAND_MAX) / (double)RAND_MAX));
 }
 
 void BackoffTimer::backoff(dstime newdelta)
@@ -137,65 +141,261 @@ TimerWithBackoff::TimerWithBackoff(PrnGen &rng, int tag)
 }
 
 
-void BackoffTimerGroupTracker::update(dstime* waituntil, bool transfers)
+TimerWheel::Handle TimerWheel::insert(dstime when, BackoffTimerTracked* t)
 {
-    // This function performs a similar action as calling BackoffTimer::update for all the timers in the group,
-    // which is to say, the `waituntil` parameter will be updated with the soonest time that we would need to
-    // wake up from any of the timers in this group, should any of them be in a back-off state.
-    // There are also some side-effects specfic to transfers which are preserved from the old system.
+    if (!mNow)
+    {
+        mNow = Waiter::ds;
+    }
 
-    vector<BackoffTimerTracked*> v;
-    v.reserve(timeouts.size());
+    Handle h;
+
+    if (when <= mNow)
+    {
+        // already due (eg a fired timer with next==1): keep reporting it from
+        // advance() until its owner rearms or resets it
+        mOverdue.push_back(t);
+        h.level = LEVELS;
+        h.it = --mOverdue.end();
+        return h;
+    }
+
+    dstime horizon = (dstime(1) << (LEVELS * SLOTBITS)) - 1;
+    if (when - mNow > horizon)
+    {
+        // beyond the wheel's range: clamp for slot purposes, the entry gets
+        // re-cascaded (and re-clamped if need be) when its span comes up
+        when = mNow + horizon;
+    }
+
+    int level = 0;
+    while ((when - mNow) >> ((level + 1) * SLOTBITS))
+    {
+        level++;
+    }
+
+    // index off the current position by the scaled-down delta (never more
+    // than 63 ahead), so an entry can't alias into an already-passed slot
+    int slot = int(((mNow >> (level * SLOTBITS)) + ((when - mNow) >> (level * SLOTBITS))) & SLOTMASK);
+    mSlots[level][slot].push_back(t);
+    mOccupied[level] |= uint64_t(1) << slot;
+
+    h.level = level;
+    h.slot = slot;
+    h.it = --mSlots[level][slot].end();
+    return h;
+}
+
+void TimerWheel::remove(const Handle& h)
+{
+    if (h.level < 0)
+    {
+        return;
+    }
+
+    if (h.level == LEVELS)
+    {
+        mOverdue.erase(h.it);
+        return;
+    }
+
+    mSlots[h.level][h.slot].erase(h.it);
+    if (mSlots[h.level][h.slot].empty())
+    {
+        mOccupied[h.level] &= ~(uint64_t(1) << h.slot);
+    }
+}
+
+void TimerWheel::cascade(int level, int slot)
+{
+    if (!(mOccupied[level] & (uint64_t(1) << slot)))
+    {
+        return;
+    }
+
+    std::list<BackoffTimerTracked*> entries;
+    entries.swap(mSlots[level][slot]);
+    mOccupied[level] &= ~(uint64_t(1) << slot);
+
+    for (BackoffTimerTracked* t : entries)
+    {
+        // deadlines are stable while tracked (every timer operation untracks
+        // first), so re-reading nextset() here is safe
+        t->mTrackerPos = insert(t->nextset(), t);
+    }
+}
 
-    if (transfers)
+void TimerWheel::advance(dstime now, vector<BackoffTimerTracked*>* due)
+{
+    if (!mNow)
     {
-        for (auto t : timeouts)
+        mNow = now;
+    }
+
+    while (mNow < now)
+    {
+        if (!mOccupied[0])
         {
-            // put the ones to work on in a vector, as working on them changes their position in the map
-            if (t.first <= Waiter::ds)
+            // nothing in the fine level: jump to just before the next
+            // cascade boundary instead of ticking through empty slots
+            dstime boundary = mNow | SLOTMASK;
+            if (!mOccupied[1] && !mOccupied[2] && !mOccupied[3])
             {
-                v.push_back(t.second);
+                mNow = now;
+                break;
             }
-            else
+            if (boundary > mNow)
             {
-                break;
+                mNow = boundary < now ? boundary : now;
+                continue;
             }
         }
 
-        for (auto t : v)
+        ++mNow;
+
+        int slot = int(mNow & SLOTMASK);
+
+        // level 0 entries in this slot are due exactly now
+        if (mOccupied[0] & (uint64_t(1) << slot))
         {
-            t->update(waituntil);
-            if (t->armed())
+            for (BackoffTimerTracked* t : mSlots[0][slot])
             {
-                // fire the timer only once but keeping it armed
-                t->set(0);
-                LOG_debug << "Disabling armed transfer backoff";
+                t->mTrackerPos.level = -1;
+                due->push_back(t);
             }
+            mSlots[0][slot].clear();
+            mOccupied[0] &= ~(uint64_t(1) << slot);
         }
 
-    }
-    else
-    {
-        // put the ones to work on in a vector, as working on them changes their position in the map
-        for (auto t : timeouts)
+        // at span boundaries, pull the next coarse slot down a level
+        if (!slot)
         {
-            if (t.second->armed())
+            for (int level = 1; level < LEVELS; level++)
             {
-                v.push_back(t.second);
+                cascade(level, int((mNow >> (level * SLOTBITS)) & SLOTMASK));
+
+                if ((mNow >> (level * SLOTBITS)) & SLOTMASK)
+                {
+                    break;
+                }
             }
-            if (t.first > Waiter::ds)
+        }
+    }
+
+    // hand out the overdue list every pass, like the old scan did for timers
+    // left armed; they retrack themselves there until rearmed or reset
+    for (BackoffTimerTracked* t : mOverdue)
+    {
+        t->mTrackerPos.level = -1;
+        due->push_back(t);
+    }
+    mOverdue.clear();
+}
+
+dstime TimerWheel::next() const
+{
+    dstime best = NEVER;
+
+    for (int level = 0; level < LEVELS; level++)
+    {
+        if (!mOccupied[level])
+        {
+            continue;
+        }
+
+        int cur = int((mNow >> (level * SLOTBITS)) & SLOTMASK);
+
+        for (int off = 1; off <= SLOTS; off++)
+        {
+            if (mOccupied[level] & (uint64_t(1) << ((cur + off) & SLOTMASK)))
             {
+                dstime spanstart = ((mNow >> (level * SLOTBITS)) + off) << (level * SLOTBITS);
+                if (spanstart < best)
+                {
+                    best = spanstart;
+                }
                 break;
             }
         }
+    }
 
-        for (auto t : v)
+    return best;
+}
+
+void BackoffTimerGroupTracker::update(dstime* waituntil, bool transfers)
+{
+    // This function performs a similar action as calling BackoffTimer::update for all the timers in the group,
+    // which is to say, the `waituntil` parameter will be updated with the soonest time that we would need to
+    // wake up from any of the timers in this group, should any of them be in a back-off state.
+    // There are also some side-effects specfic to transfers which are preserved from the old system.
+
+    vector<BackoffTimerTracked*> v;
+    timeouts.advance(Waiter::ds, &v);
+
+    for (auto t : v)
+    {
+        // update may retrack the timer (as overdue) with next=1
+        t->update(waituntil);
+
+        if (transfers && t->armed())
         {
-            // update may set next=1 so we can't just call the first one.
-            t->update(waituntil);
+            // fire the timer only once but keeping it armed
+            t->set(0);
+            LOG_debug << "Disabling armed transfer backoff";
         }
+    }
 
+    // future deadlines, straight off the occupancy bitmaps
+    dstime next = timeouts.next();
+    if (next < *waituntil)
+    {
+        *waituntil = next;
+    }
+}
+
+void RetryTelemetry::record(endpoint_t ep, retryreason_t reason, dstime delayds)
+{
+    if (ep < 0 || ep >= ENDPOINTS || delayds == NEVER)
+    {
+        return;
+    }
+
+    Stats& s = mStats[ep];
+    s.count[reason >= 0 && reason <= RETRY_UNKNOWN ? reason : RETRY_UNKNOWN]++;
+    s.totalretries++;
+    s.totaldelayds += delayds;
+    s.lastdelayds = delayds;
+    if (delayds > s.maxdelayds)
+    {
+        s.maxdelayds = delayds;
     }
 }
 
+string RetryTelemetry::report() const
+{
+    static const char* endpointnames[ENDPOINTS] = { "cs", "sc", "transfer-get", "transfer-put" };
+
+    ostringstream s;
+    for (int ep = 0; ep < ENDPOINTS; ep++)
+    {
+        const Stats& st = mStats[ep];
+        if (!st.totalretries)
+        {
+            continue;
+        }
+
+        s << endpointnames[ep] << ": retries " << st.totalretries
+          << " delay ds total/max/last " << st.totaldelayds << "/" << st.maxdelayds << "/" << st.lastdelayds;
+
+#define DEFINE_RETRY_REASON_REPORT(index, name) \
+        if (st.count[index]) s << " " #name ":" << st.count[index];
+        DEFINE_RETRY_REASONS(DEFINE_RETRY_REASON_REPORT)
+#undef DEFINE_RETRY_REASON_REPORT
+
+        s << "\n";
+    }
+
+    return s.str();
+}
+
 } // namespace
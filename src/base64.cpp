@@ -22,7 +22,85 @@
 #include "mega/base64.h"
 #include "mega/utils.h"
 
+#if defined(__SSSE3__)
+#define BASE64_USE_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
 namespace mega {
+
+#ifdef BASE64_USE_SSSE3
+namespace {
+
+// encode 12 input bytes (16 are loaded) into 16 base64 chars, using the
+// modified alphabet ('-' and '_' instead of '+' and '/')
+inline void encodeBlock(const byte* b, char* a)
+{
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    const __m128i gather = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i in = _mm_shuffle_epi8(data, gather);
+
+    // split each 24-bit group into four 6-bit indices
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // classify each index and add the per-class ASCII offset
+    __m128i classes = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    classes = _mm_or_si128(classes, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8(71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, '-' - 62, '_' - 63, 'A', 0, 0);
+    const __m128i ascii = _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, classes));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a), ascii);
+}
+
+// decode 16 base64 chars into 12 output bytes (16 are stored); returns
+// false without storing if any of the 16 bytes is outside the modified
+// alphabet, leaving the caller's scalar loop to deal with the block
+inline bool decodeBlock(const char* a, byte* b)
+{
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+
+    const __m128i higher = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0f));
+    const __m128i lower = _mm_and_si128(input, _mm_set1_epi8(0x0f));
+
+    // bit (1 << higher nibble) of maskLUT[lower nibble] tells whether a
+    // byte is in the alphabet ('-' is 0x2d, '_' is 0x5f)
+    const __m128i maskLUT = _mm_setr_epi8(
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, 0x50,
+        0x50, 0x54, 0x50, 0x70);
+    const __m128i bitposLUT = _mm_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i M = _mm_shuffle_epi8(maskLUT, lower);
+    const __m128i bits = _mm_shuffle_epi8(bitposLUT, higher);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(M, bits), _mm_setzero_si128())))
+    {
+        return false;
+    }
+
+    // char + per-range shift = 6-bit value; '_' needs its own shift
+    const __m128i shiftLUT = _mm_setr_epi8(0, 0, 17, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i shift = _mm_shuffle_epi8(shiftLUT, higher);
+    const __m128i eq5f = _mm_cmpeq_epi8(input, _mm_set1_epi8(0x5f));
+    shift = _mm_or_si128(_mm_andnot_si128(eq5f, shift), _mm_and_si128(eq5f, _mm_set1_epi8(-32)));
+    const __m128i values = _mm_add_epi8(input, shift);
+
+    // pack four 6-bit values per 32-bit lane into three bytes
+    const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    const __m128i shuffled = _mm_shuffle_epi8(packed,
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(b), shuffled);
+    return true;
+}
+
+} // anonymous namespace
+#endif // BASE64_USE_SSSE3
 // modified base64 conversion (no trailing '=' and '-_' instead of '+/')
 unsigned char Base64::to64(byte c)
 {
@@ -105,6 +183,22 @@ int Base64::atob(const char* a, byte* b, int blen)
     int i;
     int p = 0;
 
+#ifdef BASE64_USE_SSSE3
+    // 16 chars -> 12 bytes at a time. The input is only NUL-delimited, so
+    // a 16-byte load must not cross into the next page; 16 bytes are also
+    // stored per block, hence the p + 16 bound. Any byte outside the
+    // alphabet (including the NUL) drops to the scalar loop below
+    while (p + 16 <= blen && (reinterpret_cast<uintptr_t>(a) & 0xfff) <= 0xff0)
+    {
+        if (!decodeBlock(a, b + p))
+        {
+            break;
+        }
+        a += 16;
+        p += 12;
+    }
+#endif
+
     for (;;)
     {
         for (i = 0; i < 4; i++)
@@ -223,6 +317,18 @@ int Base64::btoa(const byte* b, int blen, char* a)
 {
     int p = 0;
 
+#ifdef BASE64_USE_SSSE3
+    // 12 bytes -> 16 chars at a time; the load reads 16 input bytes, so
+    // stop while at least that much remains and finish off scalar
+    while (blen >= 16)
+    {
+        encodeBlock(b, a + p);
+        b += 12;
+        blen -= 12;
+        p += 16;
+    }
+#endif
+
     for (;;)
     {
         if (blen <= 0)
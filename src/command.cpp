@@ -38,6 +38,30 @@ Command::~Command()
 {
 }
 
+namespace {
+
+// pool granularity: subclasses within the same 64-byte bracket share a pool,
+// so the ~150 command types map onto a handful of slab sets
+size_t commandSizeClass(size_t size)
+{
+    const size_t granularity = 64;
+    return (size + granularity - 1) & ~(granularity - 1);
+}
+
+} // anonymous namespace
+
+void* Command::operator new(size_t size)
+{
+    return FixedBlockPool::poolFor(commandSizeClass(size)).allocate();
+}
+
+void Command::operator delete(void* ptr, size_t size)
+{
+    // with a virtual destructor in play, 'size' is the most-derived
+    // class's, so the block goes back to the pool it was carved from
+    FixedBlockPool::poolFor(commandSizeClass(size)).deallocate(ptr);
+}
+
 void Command::cancel()
 {
     canceled = true;
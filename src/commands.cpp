@@ -87,13 +87,12 @@ HttpReqFA::HttpReqFA(NodeOrUploadHandle cth, fatype ctype, bool usehttps, int ct
 
                 if (e == API_OK)
                 {
-                    LOG_debug << "Sending file attribute data";
-                    self->progressreported = 0;
-                    self->HttpReq::type = REQ_BINARY;
-                    self->posturl = url;
-
-                    // post sets the status for http processing state machine
-                    self->post(client, self->data->data(), static_cast<unsigned>(self->data->size()));
+                    // record the URL but defer the data POST until an upload
+                    // slot is free (see the activefa handling in exec()); this
+                    // lets the URL requests for a whole upload burst coalesce
+                    // into a single batched API request
+                    self->faurl = url;
+                    self->status = REQ_PREPARED;
                 }
                 else
                 {
@@ -105,6 +104,18 @@ HttpReqFA::HttpReqFA(NodeOrUploadHandle cth, fatype ctype, bool usehttps, int ct
     };
 }
 
+// start the data POST for an attribute whose upload URL has already arrived
+void HttpReqFA::postfadata(MegaClient* client)
+{
+    LOG_debug << "Sending file attribute data";
+    progressreported = 0;
+    HttpReq::type = REQ_BINARY;
+    posturl = faurl;
+
+    // post sets the status for http processing state machine
+    post(client, data->data(), static_cast<unsigned>(data->size()));
+}
+
 bool CommandPutFA::procresult(Result r, JSON& json)
 {
     if (r.wasErrorOrOK())
@@ -216,9 +227,19 @@ bool CommandGetFA::procresult(Result r, JSON& json)
 {
     fafc_map::iterator it = client->fafcs.find(part);
 
+    // with a transfer in progress this was a parallel URL prefetch: record
+    // the outcome but leave the in-flight request alone - exec() dispatches
+    // the queued fetches once the channel frees up
+    bool transferring = it != client->fafcs.end() && it->second->req.httpio;
+
+    if (it != client->fafcs.end())
+    {
+        it->second->urlfetching = false;
+    }
+
     if (r.wasErrorOrOK())
     {
-        if (it != client->fafcs.end())
+        if (it != client->fafcs.end() && !transferring)
         {
             faf_map::iterator fafsit;
             for (fafsit = it->second->fafs[0].begin(); fafsit != it->second->fafs[0].end(); )
@@ -252,9 +273,13 @@ bool CommandGetFA::procresult(Result r, JSON& json)
                     {
                         JSON::copystring(&it->second->posturl, p);
                         it->second->urltime = Waiter::ds;
-                        it->second->dispatch();
+
+                        if (!transferring)
+                        {
+                            it->second->dispatch();
+                        }
                     }
-                    else
+                    else if (!transferring)
                     {
                         faf_map::iterator fafsit;
                         for (fafsit = it->second->fafs[0].begin(); fafsit != it->second->fafs[0].end(); )
@@ -1886,26 +1911,16 @@ CommandShareKeyUpdate::CommandShareKeyUpdate(MegaClient*, handle sh, const char*
     endarray();
 }
 
-CommandShareKeyUpdate::CommandShareKeyUpdate(MegaClient* client, handle_vector* v)
+CommandShareKeyUpdate::CommandShareKeyUpdate(MegaClient* client, const vector<pair<handle, string>>& rewrites, size_t from, size_t to)
 {
-    shared_ptr<Node> n;
-    byte sharekey[SymmCipher::KEYLENGTH];
-
     cmd("k");
     beginarray("sr");
 
-    for (size_t i = v->size(); i--;)
+    for (size_t i = from; i < to; i++)
     {
-        handle h = (*v)[i];
-
-        if ((n = client->nodebyhandle(h)) && n->sharekey)
-        {
-            client->key.ecb_encrypt(n->sharekey->key, sharekey, SymmCipher::KEYLENGTH);
-
-            element(h, MegaClient::NODEHANDLE);
-            element(client->me, MegaClient::USERHANDLE);
-            element(sharekey, SymmCipher::KEYLENGTH);
-        }
+        element(rewrites[i].first, MegaClient::NODEHANDLE);
+        element(client->me, MegaClient::USERHANDLE);
+        element((const byte*)rewrites[i].second.data(), int(rewrites[i].second.size()));
     }
 
     endarray();
@@ -2272,17 +2287,11 @@ bool CommandSetPendingContact::procresult(Result r, JSON& json)
         handle pcrhandle = UNDEF;
         if (r.wasError(API_OK)) // response for delete & remind actions is always numeric
         {
-            // find the PCR by email
-            PendingContactRequest *pcr = NULL;
-            for (handlepcr_map::iterator it = client->pcrindex.begin();
-                 it != client->pcrindex.end(); it++)
+            // find the PCR by email (the numeric response carries no handle)
+            PendingContactRequest *pcr = client->findpcrbyemail(temail);
+            if (pcr)
             {
-                if (it->second->targetemail == temail)
-                {
-                    pcr = it->second.get();
-                    pcrhandle = pcr->id;
-                    break;
-                }
+                pcrhandle = pcr->id;
             }
 
             if (!pcr)
@@ -3374,6 +3383,8 @@ CommandGetUA::CommandGetUA(MegaClient* /*client*/, const char* uid, attr_t at, c
             client->app->getua_result(t, e);
         };
 
+    mMapKey = mapkey(uid, at, ph);
+
     if (ph && ph[0])
     {
         cmd("mcuga");
@@ -3390,8 +3401,67 @@ CommandGetUA::CommandGetUA(MegaClient* /*client*/, const char* uid, attr_t at, c
     tag = ctag;
 }
 
+CommandGetUA::~CommandGetUA()
+{
+    if (client)
+    {
+        auto it = client->mPendingGetUA.find(mMapKey);
+        if (it != client->mPendingGetUA.end() && it->second == this)
+        {
+            client->mPendingGetUA.erase(it);
+        }
+    }
+}
+
+string CommandGetUA::mapkey(const char* uid, attr_t at, const char* ph)
+{
+    string key = uid ? uid : "";
+    key += '\n';
+    key += std::to_string(at);
+    if (ph && ph[0])
+    {
+        key += '\n';
+        key += ph;
+    }
+    return key;
+}
+
+void CommandGetUA::addWaiter(int ctag, CompletionErr ce, CompletionBytes cb, CompletionTLV ctlv)
+{
+    // each wrapped callback first runs the chain built so far, then delivers
+    // to the new caller under its own tag
+    mCompletionErr = [this, ctag, prev = std::move(mCompletionErr), ce = std::move(ce)](error e)
+    {
+        prev(e);
+        client->restag = ctag;
+        ce ? ce(e) : client->app->getua_result(e);
+    };
+
+    mCompletionBytes = [this, ctag, prev = std::move(mCompletionBytes), cb = std::move(cb)](byte* b, unsigned l, attr_t type)
+    {
+        prev(b, l, type);
+        client->restag = ctag;
+        cb ? cb(b, l, type) : client->app->getua_result(b, l, type);
+    };
+
+    mCompletionTLV = [this, ctag, prev = std::move(mCompletionTLV), ctlv = std::move(ctlv)](TLVstore* t, attr_t type)
+    {
+        prev(t, type);
+        client->restag = ctag;
+        ctlv ? ctlv(t, type) : client->app->getua_result(t, type);
+    };
+}
+
 bool CommandGetUA::procresult(Result r, JSON& json)
 {
+    // stop coalescing before delivering: a completion callback may issue a
+    // fresh getua for this same attribute, which must not attach to us
+    auto itPending = client->mPendingGetUA.find(mMapKey);
+    if (itPending != client->mPendingGetUA.end() && itPending->second == this)
+    {
+        client->mPendingGetUA.erase(itPending);
+    }
+
     User *u = client->finduser(uid.c_str());
 
     if (r.wasErrorOrOK())
@@ -3399,10 +3469,10 @@ bool CommandGetUA::procresult(Result r, JSON& json)
         if (r.wasError(API_ENOENT) && u)
         {
             u->removeattr(at);
-            if (u->userhandle == client->me)
-            {
-                u->setNonExistingAttribute(at);
-            }
+            // for other users the marker expires after ATTR_CACHE_TTL (see
+            // MegaClient::getua), so a missing avatar or name no longer costs
+            // a round trip on every contact-list render
+            u->setNonExistingAttribute(at);
         }
 
         mCompletionErr(r.errorOrOK());
@@ -3756,26 +3826,15 @@ bool CommandGetUserEmail::procresult(Result r, JSON& json)
 }
 
 // set node keys (e.g. to convert asymmetric keys to symmetric ones)
-CommandNodeKeyUpdate::CommandNodeKeyUpdate(MegaClient* client, handle_vector* v)
+CommandNodeKeyUpdate::CommandNodeKeyUpdate(MegaClient*, const vector<pair<handle, string>>& rewrites, size_t from, size_t to)
 {
-    byte nodekey[FILENODEKEYLENGTH];
-
     cmd("k");
     beginarray("nk");
 
-    for (size_t i = v->size(); i--;)
+    for (size_t i = from; i < to; i++)
     {
-        handle h = (*v)[i];
-
-        shared_ptr<Node> n;
-
-        if ((n = client->nodebyhandle(h)))
-        {
-            client->key.ecb_encrypt((byte*)n->nodekey().data(), nodekey, n->nodekey().size());
-
-            element(h, MegaClient::NODEHANDLE);
-            element(nodekey, int(n->nodekey().size()));
-        }
+        element(rewrites[i].first, MegaClient::NODEHANDLE);
+        element((const byte*)rewrites[i].second.data(), int(rewrites[i].second.size()));
     }
 
     endarray();
@@ -3926,6 +3985,24 @@ bool CommandPubKeyRequest::procresult(Result r, JSON& json)
     {
         client->notifyuser(u);
     }
+    else if (len_pubk)
+    {
+        // temporary (non-contact) users are deleted right after use and have no
+        // state cache record, so remember the fetched key for later shares to
+        // the same target
+        if (client->mTempUserPubKeyCache.size() > 512)
+        {
+            client->mTempUserPubKeyCache.clear();
+        }
+        if (u->email.size())
+        {
+            client->mTempUserPubKeyCache[u->email] = u->pubk;
+        }
+        if (u->uid.size() && u->uid != u->email)
+        {
+            client->mTempUserPubKeyCache[u->uid] = u->pubk;
+        }
+    }
 
     return true;
 }
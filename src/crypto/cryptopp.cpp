@@ -78,6 +78,8 @@ void SymmCipher::setkey(const byte* newkey, int type)
     aescbc_e.SetKeyWithIV(key, KEYLENGTH, zeroiv);
     aescbc_d.SetKeyWithIV(key, KEYLENGTH, zeroiv);
 
+    aesctr_e.SetKeyWithIV(key, KEYLENGTH, zeroiv);
+
     aesccm8_e.SetKeyWithIV(key, KEYLENGTH, zeroiv);
     aesccm8_d.SetKeyWithIV(key, KEYLENGTH, zeroiv);
 
@@ -650,6 +652,30 @@ SymmCipher& SymmCipher::operator=(const SymmCipher& ref)
     return *this;
 }
 
+void SymmCipher::cbcmac(byte* mac, const byte* data, unsigned len)
+{
+    assert(!(len % BLOCKSIZE));
+
+    // the chain is strictly serial, but one ProcessData call over the whole run
+    // still avoids a function call and cipher setup per block
+    byte scratch[4096];
+
+    aescbc_e.Resynchronize(mac, BLOCKSIZE);
+
+    while (len)
+    {
+        unsigned n = len < sizeof scratch ? len : unsigned(sizeof scratch);
+        aescbc_e.ProcessData(scratch, data, n);
+        data += n;
+        len -= n;
+
+        if (!len)
+        {
+            memcpy(mac, scratch + n - BLOCKSIZE, BLOCKSIZE);
+        }
+    }
+}
+
 // encryption: data must be NUL-padded to BLOCKSIZE
 // decryption: data must be padded to BLOCKSIZE
 // len must be < 2^31
@@ -657,7 +683,7 @@ void SymmCipher::ctr_crypt(byte* data, unsigned len, m_off_t pos, ctr_iv ctriv,
 {
     assert(!(pos & (KEYLENGTH - 1)));
 
-    byte ctr[BLOCKSIZE], tmp[BLOCKSIZE];
+    byte ctr[BLOCKSIZE];
 
     MemAccess::set<int64_t>(ctr,ctriv);
     setint64(pos / BLOCKSIZE, ctr + sizeof ctriv);
@@ -668,43 +694,88 @@ void SymmCipher::ctr_crypt(byte* data, unsigned len, m_off_t pos, ctr_iv ctriv,
         memcpy(mac + sizeof ctriv, ctr, sizeof ctriv);
     }
 
-    while ((int)len > 0)
+    // whole padded blocks present in the buffer, and whole blocks covered by len
+    unsigned padded = (len + BLOCKSIZE - 1) / BLOCKSIZE * BLOCKSIZE;
+    unsigned whole = len / BLOCKSIZE * BLOCKSIZE;
+
+    // bulk keystream: Crypto++ CTR mode dispatches the whole run to the
+    // hardware AES pipeline (AES-NI/ARMv8-CE, detected at runtime) with the
+    // key schedule set up once in setkey()
+    if (encrypt)
     {
-        if (encrypt)
+        if (mac)
         {
-            if(mac)
-            {
-                xorblock(data, mac);
-                ecb_encrypt(mac);
-            }
-
-            ecb_encrypt(ctr, tmp);
-            xorblock(tmp, data);
+            // MAC over the plaintext, NUL padding included
+            cbcmac(mac, data, padded);
         }
-        else
+
+        aesctr_e.Resynchronize(ctr, BLOCKSIZE);
+        aesctr_e.ProcessData(data, data, padded);
+    }
+    else
+    {
+        aesctr_e.Resynchronize(ctr, BLOCKSIZE);
+        aesctr_e.ProcessData(data, data, padded);
+
+        if (mac)
         {
-            ecb_encrypt(ctr, tmp);
-            xorblock(tmp, data);
+            cbcmac(mac, data, whole);
 
-            if (mac)
+            if (len > whole)
             {
-                if (len >= (unsigned)BLOCKSIZE)
-                {
-                    xorblock(data, mac);
-                }
-                else
-                {
-                    xorblock(data, mac, len);
-                }
-
+                // the final partial block contributes only len % BLOCKSIZE plaintext bytes
+                xorblock(data + whole, mac, int(len - whole));
                 ecb_encrypt(mac);
             }
         }
+    }
+}
+
+void SymmCipher::ctr_crypt(const byte* src, byte* dst, unsigned len, m_off_t pos, ctr_iv ctriv, byte* mac, bool initmac)
+{
+    assert(!(pos & (KEYLENGTH - 1)));
+
+    byte ctr[BLOCKSIZE], last[BLOCKSIZE];
+
+    MemAccess::set<int64_t>(ctr,ctriv);
+    setint64(pos / BLOCKSIZE, ctr + sizeof ctriv);
+
+    if (mac && initmac)
+    {
+        memcpy(mac, ctr, sizeof ctriv);
+        memcpy(mac + sizeof ctriv, ctr, sizeof ctriv);
+    }
+
+    unsigned whole = len / BLOCKSIZE * BLOCKSIZE;
+
+    aesctr_e.Resynchronize(ctr, BLOCKSIZE);
+
+    if (whole)
+    {
+        if (mac)
+        {
+            cbcmac(mac, src, whole);
+        }
 
-        len -= BLOCKSIZE;
-        data += BLOCKSIZE;
+        aesctr_e.ProcessData(dst, src, whole);
+    }
+
+    if (len > whole)
+    {
+        // the source may not be readable beyond len (e.g. the end of a file
+        // mapping), so pad the final partial block locally
+        memset(last, 0, sizeof last);
+        memcpy(last, src + whole, len - whole);
+
+        if (mac)
+        {
+            xorblock(last, mac);
+            ecb_encrypt(mac);
+        }
 
-        incblock(ctr);
+        // the CTR state continues from the whole-block run
+        aesctr_e.ProcessData(last, last, BLOCKSIZE);
+        memcpy(dst + whole, last, BLOCKSIZE);
     }
 }
 
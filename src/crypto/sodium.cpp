@@ -134,6 +134,49 @@ bool EdDSA::verifyKey(const unsigned char *pubk, const unsigned long long pubkLe
                   (unsigned char*) signature.data(), signingPubKey);
 }
 
+std::vector<bool> EdDSA::verifyKeyBatch(const std::vector<KeySignature>& batch)
+{
+    // libsodium exposes no aggregated batch-verify primitive, but the entries
+    // are independent and crypto_sign_verify_detached is stateless, so fan the
+    // batch out across hardware threads
+    std::vector<char> results(batch.size(), 0);
+
+    size_t workers = std::min<size_t>(batch.size() / 2,
+                                      std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1);
+    workers = std::min<size_t>(workers, 8);
+
+    if (workers < 2)
+    {
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            const KeySignature& ks = batch[i];
+            results[i] = verifyKey(ks.pubk, ks.pubkLen, ks.sig, ks.signingPubKey);
+        }
+    }
+    else
+    {
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < workers; w++)
+        {
+            threads.emplace_back([&batch, &results, &next]()
+            {
+                for (size_t i = next++; i < batch.size(); i = next++)
+                {
+                    const KeySignature& ks = batch[i];
+                    results[i] = verifyKey(ks.pubk, ks.pubkLen, ks.sig, ks.signingPubKey);
+                }
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    return std::vector<bool>(results.begin(), results.end());
+}
+
 const std::string ECDH::TLV_KEY= "prCu255";
 
 ECDH::ECDH()
@@ -94,6 +94,22 @@ bool DbTable::next(uint32_t* type, string* data, SymmCipher* key)
     return false;
 }
 
+// get next record without decrypting
+bool DbTable::nextRaw(uint32_t* type, string* data)
+{
+    if (!next(type, data))
+    {
+        return false;
+    }
+
+    if (*type > nextid)
+    {
+        nextid = *type & - IDSPACING;
+    }
+
+    return true;
+}
+
 DBTableTransactionCommitter *DbTable::getTransactionCommitter() const
 {
     return mTransactionCommitter;
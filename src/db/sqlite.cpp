@@ -21,9 +21,74 @@
 
 #include "mega.h"
 
+#include <zlib.h>
+
 #ifdef USE_SQLITE
 namespace mega {
 
+namespace {
+
+// header of a compressed node blob: magic (with a format version byte) + the
+// uncompressed size, followed by a deflate stream
+const char NODE_BLOB_MAGIC[] = { 'M', 'Z', 'N', 'B', 1 };
+const size_t NODE_BLOB_HEADER_LEN = sizeof(NODE_BLOB_MAGIC) + sizeof(uint32_t);
+
+// Watches one statement execution and logs it if it ran longer than the
+// threshold, together with sqlite's per-statement counters (full-scan steps,
+// sorts, transient auto-indexes) and the prepared SQL text (bound values are
+// not included, only the query shape). This is what lets support tell a
+// degraded database on an aged account apart from network latency.
+class SqliteQueryWatch
+{
+    sqlite3_stmt* mStmt;
+    std::chrono::steady_clock::time_point mStart;
+
+public:
+    // queries at least this slow get logged
+    static const int LOG_THRESHOLD_MS = 100;
+
+    SqliteQueryWatch(sqlite3_stmt* stmt)
+        : mStmt(stmt)
+        , mStart(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~SqliteQueryWatch()
+    {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - mStart).count();
+
+        if (mStmt && ms >= LOG_THRESHOLD_MS)
+        {
+            int fullscan = sqlite3_stmt_status(mStmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+            int sorts = sqlite3_stmt_status(mStmt, SQLITE_STMTSTATUS_SORT, 1);
+            int autoindex = sqlite3_stmt_status(mStmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+            const char* sql = sqlite3_sql(mStmt);
+
+            LOG_warn << "Slow db query: " << ms << " ms, fullscan steps: " << fullscan
+                     << ", sorts: " << sorts << ", autoindexes: " << autoindex
+                     << ", sql: " << (sql ? sql : "(unavailable)");
+        }
+    }
+};
+
+// bumps the db query performance counters when it goes out of scope,
+// covering every exit path of the instrumented statement
+struct ScopedDbQueryCounter
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ~ScopedDbQueryCounter()
+    {
+        PerfCounters::get().add(PERF_DB_QUERIES);
+        PerfCounters::get().add(PERF_DB_QUERY_TIME_US,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+    }
+};
+
+} // anonymous namespace
+
 SqliteDbAccess::SqliteDbAccess(const LocalPath& rootPath)
   : mRootPath(rootPath)
 {
@@ -165,6 +230,14 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
         return nullptr;
     }
 
+    // Trigram-tokenized FTS5 index over node names, kept in sync by triggers. Substring
+    // search can use it instead of scanning the whole 'nodes' table. Not having it is
+    // not fatal: lookups fall back to the REGEXP scan (ie. SQLite without FTS5/trigram)
+    if (!createNameFulltextIndex(db))
+    {
+        LOG_warn << "Name full-text index unavailable, name searches will scan the nodes table";
+    }
+
 #if __ANDROID__
     // Android doesn't provide a temporal directory -> change default policy for temp
     // store (FILE=1) to avoid failures on large queries, so it relies on MEMORY=2
@@ -247,6 +320,20 @@ bool SqliteDbAccess::openDBAndCreateStatecache(sqlite3 **db, FileSystemAccess &f
         sqlite3_close(*db);
         return false;
     }
+
+    if (flags & DB_OPEN_FLAG_CONCURRENT)
+    {
+        // in WAL mode NORMAL only skips the fsync per commit, consistency is kept;
+        // the busy timeout makes readers on other threads wait out a checkpoint
+        // or commit instead of failing with SQLITE_BUSY
+        result = sqlite3_exec(*db, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+        if (result)
+        {
+            LOG_warn << "PRAGMA synchronous error " << sqlite3_errmsg(*db);
+        }
+
+        sqlite3_busy_timeout(*db, 3000);
+    }
 #endif /* ! TARGET_OS_IPHONE */
 
     string sql = "CREATE TABLE IF NOT EXISTS statecache (id INTEGER PRIMARY KEY ASC NOT NULL, content BLOB NOT NULL)";
@@ -424,6 +511,77 @@ bool SqliteDbAccess::copyMtimeFromFingerprint(sqlite3* db)
     return true;
 }
 
+bool SqliteDbAccess::createNameFulltextIndex(sqlite3* db)
+{
+    bool hasIndex = false;
+    string sql = "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'fts_nodes'";
+    int result = sqlite3_exec(db, sql.c_str(), [](void* hasTable, int colCount, char** colVals, char**)
+        {
+            *static_cast<bool*>(hasTable) = colCount && colVals[0][0] != '0';
+            return 0;
+        },
+        &hasIndex, nullptr);
+
+    if (result != SQLITE_OK)
+    {
+        LOG_err << "Db error while checking for 'fts_nodes' table: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    // The trigram tokenizer (SQLite >= 3.34) indexes every 3-char substring, so a
+    // MATCH against a quoted string behaves as a case insensitive substring lookup
+    sql = "CREATE VIRTUAL TABLE IF NOT EXISTS fts_nodes USING fts5(name, tokenize='trigram')";
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        // FTS5 or the trigram tokenizer are not compiled into this SQLite build
+        LOG_debug << "Db could not create 'fts_nodes' table: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    // Keep fts_nodes in sync with nodes, keyed by nodehandle (used as the FTS rowid).
+    // The insert trigger also deletes, so INSERT OR REPLACE on 'nodes' (which doesn't
+    // run delete triggers) cannot leave a stale entry behind
+    sql = "CREATE TRIGGER IF NOT EXISTS nodes_fts_insert AFTER INSERT ON nodes BEGIN "
+              "DELETE FROM fts_nodes WHERE rowid = new.nodehandle; "
+              "INSERT INTO fts_nodes(rowid, name) VALUES (new.nodehandle, new.name); "
+          "END;"
+          "CREATE TRIGGER IF NOT EXISTS nodes_fts_delete AFTER DELETE ON nodes BEGIN "
+              "DELETE FROM fts_nodes WHERE rowid = old.nodehandle; "
+          "END;"
+          "CREATE TRIGGER IF NOT EXISTS nodes_fts_update AFTER UPDATE OF name ON nodes BEGIN "
+              "DELETE FROM fts_nodes WHERE rowid = old.nodehandle; "
+              "INSERT INTO fts_nodes(rowid, name) VALUES (new.nodehandle, new.name); "
+          "END;";
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while creating 'fts_nodes' triggers: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (!hasIndex)
+    {
+        // index the names already present in an old 'nodes' table
+        sql = "INSERT INTO fts_nodes(rowid, name) SELECT nodehandle, name FROM nodes WHERE name IS NOT NULL";
+        if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            LOG_err << "Db error while populating 'fts_nodes': " << sqlite3_errmsg(db);
+            return false;
+        }
+    }
+
+    // The triggers keep the index current but leave its b-tree as many small
+    // segments, and short daily sessions never accumulate enough writes for
+    // fts5 to merge them on its own, so match speed would decay across
+    // restarts. Folding the segments at open is a no-op when already compact
+    sql = "INSERT INTO fts_nodes(fts_nodes) VALUES ('optimize')";
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_warn << "Db error while optimizing 'fts_nodes': " << sqlite3_errmsg(db);
+    }
+
+    return true;
+}
+
 SqliteDbTable::SqliteDbTable(PrnGen &rng, sqlite3* db, FileSystemAccess &fsAccess, const LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack)
   : DbTable(rng, checkAlwaysTransacted, dBErrorCallBack)
   , db(db)
@@ -494,6 +652,8 @@ bool SqliteDbTable::next(uint32_t* index, string* data)
         return false;
     }
 
+    ScopedDbQueryCounter qc;
+
     int rc = sqlite3_step(pStmt);
 
     if (rc != SQLITE_ROW)
@@ -521,6 +681,8 @@ bool SqliteDbTable::get(uint32_t index, string* data)
         return false;
     }
 
+    ScopedDbQueryCounter qc;
+
     sqlite3_stmt *stmt = nullptr;
     int rc;
 
@@ -558,6 +720,8 @@ bool SqliteDbTable::put(uint32_t index, char* data, unsigned len)
 
     checkTransaction();
 
+    ScopedDbQueryCounter qc;
+
     int sqlResult = SQLITE_OK;
     if (!mPutStmt)
     {
@@ -595,6 +759,8 @@ bool SqliteDbTable::del(uint32_t index)
 
     checkTransaction();
 
+    ScopedDbQueryCounter qc;
+
     int sqlResult = SQLITE_OK;
     if (!mDelStmt)
     {
@@ -654,6 +820,8 @@ void SqliteDbTable::commit()
 
     LOG_debug << "DB transaction COMMIT " << dbfile;
 
+    MEGA_TRACE_SCOPE("db_commit");
+
     int rc = sqlite3_exec(db, "COMMIT", 0, 0, NULL);
     errorHandler(rc, "Commit transaction", false);
 }
@@ -760,6 +928,7 @@ int SqliteAccountState::progressHandler(void *param)
 bool SqliteAccountState::processSqlQueryNodes(sqlite3_stmt *stmt, std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>& nodes)
 {
     assert(stmt);
+    SqliteQueryWatch watch(stmt);
     int sqlResult = SQLITE_ERROR;
     while ((sqlResult = sqlite3_step(stmt)) == SQLITE_ROW)
     {
@@ -782,6 +951,7 @@ bool SqliteAccountState::processSqlQueryNodes(sqlite3_stmt *stmt, std::vector<st
         if (data && size)
         {
             node.mNode = std::string(static_cast<const char*>(data), size);
+            decodeNodeBlob(node.mNode);
             nodes.insert(nodes.end(), std::make_pair(nodeHandle, std::move(node)));
         }
     }
@@ -793,6 +963,8 @@ bool SqliteAccountState::processSqlQueryNodes(sqlite3_stmt *stmt, std::vector<st
 
 bool SqliteAccountState::remove(NodeHandle nodehandle)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -812,6 +984,8 @@ bool SqliteAccountState::remove(NodeHandle nodehandle)
 
 bool SqliteAccountState::removeNodes()
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -827,6 +1001,8 @@ bool SqliteAccountState::removeNodes()
 
 void SqliteAccountState::updateCounter(NodeHandle nodeHandle, const std::string& nodeCounterBlob)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return;
@@ -837,7 +1013,7 @@ void SqliteAccountState::updateCounter(NodeHandle nodeHandle, const std::string&
     int sqlResult = SQLITE_OK;
     if (!mStmtUpdateNode)
     {
-        sqlResult = sqlite3_prepare_v2(db, "UPDATE nodes SET counter = ?  WHERE nodehandle = ?", -1, &mStmtUpdateNode, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "UPDATE nodes SET counter = ?  WHERE nodehandle = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtUpdateNode, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -859,6 +1035,8 @@ void SqliteAccountState::updateCounter(NodeHandle nodeHandle, const std::string&
 
 void SqliteAccountState::updateCounterAndFlags(NodeHandle nodeHandle, uint64_t flags, const std::string& nodeCounterBlob)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return;
@@ -869,7 +1047,7 @@ void SqliteAccountState::updateCounterAndFlags(NodeHandle nodeHandle, uint64_t f
     int sqlResult = SQLITE_OK;
     if (!mStmtUpdateNodeAndFlags)
     {
-        sqlResult = sqlite3_prepare_v2(db, "UPDATE nodes SET counter = ?, flags = ? WHERE nodehandle = ?", -1, &mStmtUpdateNodeAndFlags, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "UPDATE nodes SET counter = ?, flags = ? WHERE nodehandle = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtUpdateNodeAndFlags, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -893,6 +1071,8 @@ void SqliteAccountState::updateCounterAndFlags(NodeHandle nodeHandle, uint64_t f
 
 void SqliteAccountState::createIndexes()
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return;
@@ -912,6 +1092,14 @@ void SqliteAccountState::createIndexes()
         LOG_err << "Data base error while creating index (fingerprintindex): " << sqlite3_errmsg(db);
     }
 
+    // covering fingerprint -> handle index, so existence checks never read a node row
+    sql = "CREATE INDEX IF NOT EXISTS fingerprinthandleindex on nodes (fingerprint, nodehandle)";
+    result = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+    if (result)
+    {
+        LOG_err << "Data base error while creating index (fingerprinthandleindex): " << sqlite3_errmsg(db);
+    }
+
 #if defined( __ANDROID__) || defined(USE_IOS)
     sql = "CREATE INDEX IF NOT EXISTS origFingerprintindex on nodes (origFingerprint)";
     result = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
@@ -945,16 +1133,62 @@ void SqliteAccountState::createIndexes()
 
 void SqliteAccountState::remove()
 {
+    flushPutNodeBatch();
+
     finalise();
 
     SqliteDbTable::remove();
 }
 
+bool SqliteAccountState::useFtsNameIndex(const std::string& name)
+{
+    // the trigram tokenizer cannot match strings shorter than 3 characters
+    // (count code points, not bytes, so multi-byte UTF-8 chars are not overcounted)
+    size_t chars = 0;
+    for (char c : name)
+    {
+        chars += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    }
+    if (chars < 3)
+    {
+        return false;
+    }
+
+    if (mFtsNameIndexAvailable < 0)
+    {
+        sqlite3_stmt* stmt = nullptr;
+        mFtsNameIndexAvailable = db && sqlite3_prepare_v2(db, "SELECT rowid FROM fts_nodes WHERE fts_nodes MATCH 'abc'", -1, &stmt, nullptr) == SQLITE_OK;
+        sqlite3_finalize(stmt);
+    }
+
+    return mFtsNameIndexAvailable > 0;
+}
+
+std::string SqliteAccountState::ftsQuoteName(const std::string& name)
+{
+    // a double-quoted FTS5 string is matched verbatim, ie. as a substring under
+    // the trigram tokenizer; embedded quotes are escaped by doubling them
+    std::string quoted(1, '"');
+    for (char c : name)
+    {
+        quoted += c;
+        if (c == '"')
+        {
+            quoted += c;
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
 void SqliteAccountState::finalise()
 {
     sqlite3_finalize(mStmtPutNode);
     mStmtPutNode = nullptr;
 
+    sqlite3_finalize(mStmtPutNodeBatch);
+    mStmtPutNodeBatch = nullptr;
+
     sqlite3_finalize(mStmtUpdateNode);
     mStmtUpdateNode = nullptr;
 
@@ -979,9 +1213,15 @@ void SqliteAccountState::finalise()
     sqlite3_finalize(mStmtGetChildren);
     mStmtGetChildren = nullptr;
 
+    sqlite3_finalize(mStmtGetChildrenFts);
+    mStmtGetChildrenFts = nullptr;
+
     sqlite3_finalize(mStmtSearchNodes);
     mStmtSearchNodes = nullptr;
 
+    sqlite3_finalize(mStmtSearchNodesFts);
+    mStmtSearchNodesFts = nullptr;
+
     sqlite3_finalize(mStmtNodeByName);
     mStmtNodeByName = nullptr;
 
@@ -1000,6 +1240,9 @@ void SqliteAccountState::finalise()
     sqlite3_finalize(mStmtNodeByFp);
     mStmtNodeByFp = nullptr;
 
+    sqlite3_finalize(mStmtHandleByFp);
+    mStmtHandleByFp = nullptr;
+
     sqlite3_finalize(mStmtNodeByOrigFp);
     mStmtNodeByOrigFp = nullptr;
 
@@ -1028,68 +1271,239 @@ bool SqliteAccountState::put(Node *node)
 
     checkTransaction();
 
+    PutNodeRecord rec;
+    fillPutNodeRecord(rec, node);
+
+    if (mPutNodeBatchSize > 1)
+    {
+        mPutNodeBatch.emplace_back(std::move(rec));
+        if (mPutNodeBatch.size() >= mPutNodeBatchSize)
+        {
+            return flushPutNodeBatch();
+        }
+
+        return true;   // buffered; written at the latest when the transaction commits
+    }
+
+    return putNodeRecord(rec);
+}
+
+void SqliteAccountState::setPutBatchSize(unsigned size)
+{
+    flushPutNodeBatch();
+    mPutNodeBatchSize = std::max(1u, size);
+}
+
+void SqliteAccountState::setBlobCompression(bool enable)
+{
+    flushPutNodeBatch();
+    mCompressNodeBlobs = enable;
+}
+
+void SqliteAccountState::encodeNodeBlob(std::string& blob)
+{
+    uLongf compressedLen = compressBound(static_cast<uLong>(blob.size()));
+    std::string compressed(NODE_BLOB_HEADER_LEN + compressedLen, '\0');
+
+    memcpy(&compressed[0], NODE_BLOB_MAGIC, sizeof(NODE_BLOB_MAGIC));
+    uint32_t originalLen = static_cast<uint32_t>(blob.size());
+    memcpy(&compressed[sizeof(NODE_BLOB_MAGIC)], &originalLen, sizeof(originalLen));
+
+    if (compress2(reinterpret_cast<Bytef*>(&compressed[NODE_BLOB_HEADER_LEN]), &compressedLen,
+                  reinterpret_cast<const Bytef*>(blob.data()), static_cast<uLong>(blob.size()),
+                  Z_BEST_SPEED) != Z_OK)
+    {
+        return;   // keep the raw blob
+    }
+
+    compressed.resize(NODE_BLOB_HEADER_LEN + compressedLen);
+    if (compressed.size() < blob.size())
+    {
+        blob = std::move(compressed);
+    }
+}
+
+void SqliteAccountState::decodeNodeBlob(std::string& blob)
+{
+    if (blob.size() < NODE_BLOB_HEADER_LEN ||
+        memcmp(blob.data(), NODE_BLOB_MAGIC, sizeof(NODE_BLOB_MAGIC)))
+    {
+        return;   // raw blob
+    }
+
+    uint32_t originalLen;
+    memcpy(&originalLen, blob.data() + sizeof(NODE_BLOB_MAGIC), sizeof(originalLen));
+
+    std::string original(originalLen, '\0');
+    uLongf destLen = originalLen;
+    if (uncompress(reinterpret_cast<Bytef*>(&original[0]), &destLen,
+                   reinterpret_cast<const Bytef*>(blob.data() + NODE_BLOB_HEADER_LEN),
+                   static_cast<uLong>(blob.size() - NODE_BLOB_HEADER_LEN)) != Z_OK ||
+        destLen != originalLen)
+    {
+        LOG_err << "Failed to inflate a compressed node blob";
+        return;
+    }
+
+    blob = std::move(original);
+}
+
+void SqliteAccountState::fillPutNodeRecord(PutNodeRecord& rec, Node* node)
+{
+    node->serialize(&rec.mNode);
+    assert(rec.mNode.size());
+
+    if (mCompressNodeBlobs)
+    {
+        encodeNodeBlob(rec.mNode);
+    }
+
+    rec.mHandle = node->nodehandle;
+    rec.mParentHandle = node->parenthandle;
+    rec.mName = node->displayname();
+    node->FileFingerprint::serialize(&rec.mFingerprint);
+
+    attr_map::const_iterator attrIt = node->attrs.map.find(MAKENAMEID2('c', '0'));
+    if (attrIt != node->attrs.map.end())
+    {
+       rec.mOrigFingerprint = attrIt->second;
+    }
+
+    rec.mType = node->type;
+    rec.mSize = node->size;
+    rec.mShareType = node->getShareType();
+
+    // node->attrstring has value => node is encrypted
+    nameid favId = AttrMap::string2nameid("fav");
+    auto favIt = node->attrs.map.find(favId);
+    rec.mFav = (favIt != node->attrs.map.end() && favIt->second == "1"); // test 'fav' attr value (only "1" is valid)
+
+    rec.mCtime = node->ctime;
+    rec.mMtime = node->mtime;
+    rec.mFlags = node->getDBFlags();
+    rec.mCounter = node->getCounter().serialize();
+}
+
+void SqliteAccountState::bindPutNodeRecord(sqlite3_stmt* stmt, int row, const PutNodeRecord& rec)
+{
+    int col = row * 14;
+    sqlite3_bind_int64(stmt, col + 1, rec.mHandle);
+    sqlite3_bind_int64(stmt, col + 2, rec.mParentHandle);
+    sqlite3_bind_text(stmt, col + 3, rec.mName.c_str(), static_cast<int>(rec.mName.length()), SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, col + 4, rec.mFingerprint.data(), static_cast<int>(rec.mFingerprint.size()), SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, col + 5, rec.mOrigFingerprint.data(), static_cast<int>(rec.mOrigFingerprint.size()), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, col + 6, rec.mType);
+    sqlite3_bind_int64(stmt, col + 7, rec.mSize);
+    sqlite3_bind_int(stmt, col + 8, rec.mShareType);
+    sqlite3_bind_int(stmt, col + 9, rec.mFav);
+    sqlite3_bind_int64(stmt, col + 10, rec.mCtime);
+    sqlite3_bind_int64(stmt, col + 11, rec.mMtime);
+    sqlite3_bind_int64(stmt, col + 12, rec.mFlags);
+    sqlite3_bind_blob(stmt, col + 13, rec.mCounter.data(), static_cast<int>(rec.mCounter.size()), SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, col + 14, rec.mNode.data(), static_cast<int>(rec.mNode.size()), SQLITE_STATIC);
+}
+
+bool SqliteAccountState::putNodeRecord(const PutNodeRecord& rec)
+{
     int sqlResult = SQLITE_OK;
     if (!mStmtPutNode)
     {
-        sqlResult = sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO nodes (nodehandle, parenthandle, "
+        sqlResult = sqlite3_prepare_v3(db, "INSERT OR REPLACE INTO nodes (nodehandle, parenthandle, "
                                            "name, fingerprint, origFingerprint, type, size, share, fav, ctime, mtime, flags, counter, node) "
-                                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", -1, &mStmtPutNode, NULL);
+                                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", -1, SQLITE_PREPARE_PERSISTENT, &mStmtPutNode, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
     {
-        string nodeSerialized;
-        node->serialize(&nodeSerialized);
-        assert(nodeSerialized.size());
+        bindPutNodeRecord(mStmtPutNode, 0, rec);
+        sqlResult = sqlite3_step(mStmtPutNode);
+    }
+
+    errorHandler(sqlResult, "Put node", false);
+
+    sqlite3_reset(mStmtPutNode);
+
+    return sqlResult == SQLITE_DONE;
+}
+
+bool SqliteAccountState::flushPutNodeBatch()
+{
+    if (mPutNodeBatch.empty())
+    {
+        return true;
+    }
+
+    if (!db)
+    {
+        mPutNodeBatch.clear();
+        return false;
+    }
 
-        sqlite3_bind_int64(mStmtPutNode, 1, node->nodehandle);
-        sqlite3_bind_int64(mStmtPutNode, 2, node->parenthandle);
+    bool result = true;
+    size_t written = 0;
 
-        std::string name = node->displayname();
-        sqlite3_bind_text(mStmtPutNode, 3, name.c_str(), static_cast<int>(name.length()), SQLITE_STATIC);
+    // full chunks go through one cached multi-row statement each; per-row statement
+    // overhead is what dominates bulk imports, not the binds themselves
+    while (mPutNodeBatch.size() - written >= mPutNodeBatchSize)
+    {
+        int sqlResult = SQLITE_OK;
+        if (!mStmtPutNodeBatch)
+        {
+            std::string sqlQuery = "INSERT OR REPLACE INTO nodes (nodehandle, parenthandle, "
+                                   "name, fingerprint, origFingerprint, type, size, share, fav, ctime, mtime, flags, counter, node) "
+                                   "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+            for (unsigned i = 1; i < mPutNodeBatchSize; ++i)
+            {
+                sqlQuery += ", (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+            }
 
-        string fp;
-        node->FileFingerprint::serialize(&fp);
-        sqlite3_bind_blob(mStmtPutNode, 4, fp.data(), static_cast<int>(fp.size()), SQLITE_STATIC);
+            sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtPutNodeBatch, NULL);
+        }
 
-        std::string origFingerprint;
-        attr_map::const_iterator attrIt = node->attrs.map.find(MAKENAMEID2('c', '0'));
-        if (attrIt != node->attrs.map.end())
+        if (sqlResult == SQLITE_OK)
         {
-           origFingerprint = attrIt->second;
+            for (unsigned i = 0; i < mPutNodeBatchSize; ++i)
+            {
+                bindPutNodeRecord(mStmtPutNodeBatch, i, mPutNodeBatch[written + i]);
+            }
+
+            sqlResult = sqlite3_step(mStmtPutNodeBatch);
         }
-        sqlite3_bind_blob(mStmtPutNode, 5, origFingerprint.data(), static_cast<int>(origFingerprint.size()), SQLITE_STATIC);
-
-        sqlite3_bind_int(mStmtPutNode, 6, node->type);
-        sqlite3_bind_int64(mStmtPutNode, 7, node->size);
-
-        int shareType = node->getShareType();
-        sqlite3_bind_int(mStmtPutNode, 8, shareType);
-
-        // node->attrstring has value => node is encrypted
-        nameid favId = AttrMap::string2nameid("fav");
-        auto favIt = node->attrs.map.find(favId);
-        bool fav = (favIt != node->attrs.map.end() && favIt->second == "1"); // test 'fav' attr value (only "1" is valid)
-        sqlite3_bind_int(mStmtPutNode, 9, fav);
-        sqlite3_bind_int64(mStmtPutNode, 10, node->ctime);
-        sqlite3_bind_int64(mStmtPutNode, 11, node->mtime);
-        sqlite3_bind_int64(mStmtPutNode, 12, node->getDBFlags());
-        std::string nodeCountersBlob = node->getCounter().serialize();
-        sqlite3_bind_blob(mStmtPutNode, 13, nodeCountersBlob.data(), static_cast<int>(nodeCountersBlob.size()), SQLITE_STATIC);
-        sqlite3_bind_blob(mStmtPutNode, 14, nodeSerialized.data(), static_cast<int>(nodeSerialized.size()), SQLITE_STATIC);
 
-        sqlResult = sqlite3_step(mStmtPutNode);
+        errorHandler(sqlResult, "Put nodes", false);
+
+        sqlite3_reset(mStmtPutNodeBatch);
+
+        result = result && sqlResult == SQLITE_DONE;
+        written += mPutNodeBatchSize;
     }
 
-    errorHandler(sqlResult, "Put node", false);
+    // leftover rows, one by one
+    for (; written < mPutNodeBatch.size(); ++written)
+    {
+        result = putNodeRecord(mPutNodeBatch[written]) && result;
+    }
 
-    sqlite3_reset(mStmtPutNode);
+    mPutNodeBatch.clear();
+    return result;
+}
 
-    return sqlResult == SQLITE_DONE;
+void SqliteAccountState::commit()
+{
+    flushPutNodeBatch();
+    SqliteDbTable::commit();
+}
+
+void SqliteAccountState::abort()
+{
+    mPutNodeBatch.clear();   // these rows belong to the transaction being rolled back
+    SqliteDbTable::abort();
 }
 
 bool SqliteAccountState::getNode(NodeHandle nodehandle, NodeSerialized &nodeSerialized)
 {
+    flushPutNodeBatch();
+
     bool success = false;
     if (!db)
     {
@@ -1101,11 +1515,12 @@ bool SqliteAccountState::getNode(NodeHandle nodehandle, NodeSerialized &nodeSeri
     int sqlResult = SQLITE_OK;
     if (!mStmtGetNode)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT counter, node FROM nodes  WHERE nodehandle = ?", -1, &mStmtGetNode, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT counter, node FROM nodes  WHERE nodehandle = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtGetNode, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
     {
+        SqliteQueryWatch watch(mStmtGetNode);
         if ((sqlResult = sqlite3_bind_int64(mStmtGetNode, 1, nodehandle.as8byte())) == SQLITE_OK)
         {
             if((sqlResult = sqlite3_step(mStmtGetNode)) == SQLITE_ROW)
@@ -1120,6 +1535,7 @@ bool SqliteAccountState::getNode(NodeHandle nodehandle, NodeSerialized &nodeSeri
                 {
                     nodeSerialized.mNodeCounter.assign(static_cast<const char*>(dataNodeCounter), sizeNodeCounter);
                     nodeSerialized.mNode.assign(static_cast<const char*>(dataNodeSerialized), sizeNodeSerialized);
+                    decodeNodeBlob(nodeSerialized.mNode);
                     success = true;
                 }
             }
@@ -1139,6 +1555,8 @@ bool SqliteAccountState::getNode(NodeHandle nodehandle, NodeSerialized &nodeSeri
 
 bool SqliteAccountState::getNodesByOrigFingerprint(const std::string &fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized>> &nodes)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1147,7 +1565,7 @@ bool SqliteAccountState::getNodesByOrigFingerprint(const std::string &fingerprin
     int sqlResult = SQLITE_OK;
     if (!mStmtNodeByOrigFp)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT nodehandle, counter, node FROM nodes WHERE origfingerprint = ?", -1, &mStmtNodeByOrigFp, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT nodehandle, counter, node FROM nodes WHERE origfingerprint = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodeByOrigFp, NULL);
     }
 
     bool result = false;
@@ -1168,6 +1586,8 @@ bool SqliteAccountState::getNodesByOrigFingerprint(const std::string &fingerprin
 
 bool SqliteAccountState::getRootNodes(std::vector<std::pair<NodeHandle, NodeSerialized>> &nodes)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1194,9 +1614,35 @@ bool SqliteAccountState::getRootNodes(std::vector<std::pair<NodeHandle, NodeSeri
     return result;
 }
 
+bool SqliteAccountState::getAllNodes(std::vector<std::pair<NodeHandle, NodeSerialized>> &nodes)
+{
+    flushPutNodeBatch();
+
+    if (!db)
+    {
+        return false;
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    bool result = false;
+    int sqlResult = sqlite3_prepare_v2(db, "SELECT nodehandle, counter, node FROM nodes", -1, &stmt, NULL);
+    if (sqlResult == SQLITE_OK)
+    {
+        result = processSqlQueryNodes(stmt, nodes);
+    }
+
+    errorHandler(sqlResult, "Get all nodes", false);
+
+    sqlite3_finalize(stmt);
+
+    return result;
+}
+
 /** @deprecated */
 bool SqliteAccountState::getNodesWithSharesOrLink(std::vector<std::pair<NodeHandle, NodeSerialized>> &nodes, ShareType_t shareType)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1223,6 +1669,8 @@ bool SqliteAccountState::getNodesWithSharesOrLink(std::vector<std::pair<NodeHand
 /** @deprecated */
 bool SqliteAccountState::getChildren(NodeHandle parentHandle, std::vector<std::pair<NodeHandle, NodeSerialized>>& children, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1236,7 +1684,7 @@ bool SqliteAccountState::getChildren(NodeHandle parentHandle, std::vector<std::p
     int sqlResult = SQLITE_OK;
     if (!mStmtChildren)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT nodehandle, counter, node FROM nodes WHERE parenthandle = ?", -1, &mStmtChildren, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT nodehandle, counter, node FROM nodes WHERE parenthandle = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtChildren, NULL);
     }
 
     bool result = false;
@@ -1260,6 +1708,8 @@ bool SqliteAccountState::getChildren(NodeHandle parentHandle, std::vector<std::p
 
 bool SqliteAccountState::getChildrenFromType(NodeHandle parentHandle, nodetype_t nodeType, std::vector<std::pair<NodeHandle, NodeSerialized> >& children, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1274,7 +1724,7 @@ bool SqliteAccountState::getChildrenFromType(NodeHandle parentHandle, nodetype_t
 
     if (!mStmtChildrenFromType)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT nodehandle, counter, node FROM nodes WHERE parenthandle = ? AND type = ?", -1, &mStmtChildrenFromType, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT nodehandle, counter, node FROM nodes WHERE parenthandle = ? AND type = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtChildrenFromType, NULL);
     }
 
     bool result = false;
@@ -1301,6 +1751,8 @@ bool SqliteAccountState::getChildrenFromType(NodeHandle parentHandle, nodetype_t
 
 uint64_t SqliteAccountState::getNumberOfChildren(NodeHandle parentHandle)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1310,11 +1762,12 @@ uint64_t SqliteAccountState::getNumberOfChildren(NodeHandle parentHandle)
     int sqlResult = SQLITE_OK;
     if (!mStmtNumChildren)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT count(*) FROM nodes WHERE parenthandle = ?", -1, &mStmtNumChildren, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT count(*) FROM nodes WHERE parenthandle = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtNumChildren, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
     {
+        SqliteQueryWatch watch(mStmtNumChildren);
         if ((sqlResult = sqlite3_bind_int64(mStmtNumChildren, 1, parentHandle.as8byte())) == SQLITE_OK)
         {
             if ((sqlResult = sqlite3_step(mStmtNumChildren)) == SQLITE_ROW)
@@ -1331,8 +1784,10 @@ uint64_t SqliteAccountState::getNumberOfChildren(NodeHandle parentHandle)
     return numChildren;
 }
 
-bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, vector<pair<NodeHandle, NodeSerialized>>& children, CancelToken cancelFlag)
+bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, const mega::NodeSearchPage& page, vector<pair<NodeHandle, NodeSerialized>>& children, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1343,8 +1798,11 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, vecto
         sqlite3_progress_handler(db, NUM_VIRTUAL_MACHINE_INSTRUCTIONS, SqliteAccountState::progressHandler, static_cast<void*>(&cancelFlag));
     }
 
+    const bool useFts = useFtsNameIndex(filter.byName());
+    sqlite3_stmt*& stmtGetChildren = useFts ? mStmtGetChildrenFts : mStmtGetChildren;
+
     int sqlResult = SQLITE_OK;
-    if (!mStmtGetChildren)
+    if (!stmtGetChildren)
     {
         std::string sqlQuery = "SELECT n1.nodehandle, n1.counter, n1.node "
                                "FROM nodes n1 "
@@ -1359,12 +1817,16 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, vecto
                                                                                                                   ',' + std::to_string(MIME_TYPE_PDF) +
                                                                                                                   ',' + std::to_string(MIME_TYPE_PRESENTATION) +
                                                                                                                   ',' + std::to_string(MIME_TYPE_SPREADSHEET) + "))"
-                                              " OR n1.mimetype = ?))) "
-                                 "AND (n1.name REGEXP ?) ";
-        // Leading and trailing '*' will be added to argument '?' so we are looking for a substring of name
-        // Our REGEXP implementation is case insensitive
+                                              " OR n1.mimetype = ?))) ";
+        // Substring match on name: through the trigram FTS index when it can serve this
+        // lookup, with a scan over 'nodes' as fallback (both are case insensitive)
+        sqlQuery += useFts ? "AND (n1.nodehandle IN (SELECT rowid FROM fts_nodes WHERE fts_nodes MATCH ?)) "
+                           : "AND (n1.name REGEXP ?) "; // leading and trailing '*' will be added to argument '?'
+
+        // windowed look-ups bind the page here; unwindowed ones bind LIMIT -1 (no limit)
+        sqlQuery += "LIMIT ? OFFSET ?";
 
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtGetChildren, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmtGetChildren, NULL);
     }
 
     bool result = false;
@@ -1372,26 +1834,28 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, vecto
                      (filter.bySensitivity() ? (1 << Node::FLAGS_IS_MARKED_SENSTIVE) : 0); // filter by sensitivity
 
     if (sqlResult == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 1, flags)) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 2, filter.byLocationHandle())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtGetChildren, 3, filter.byNodeType())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtGetChildren, 4, filter.byNodeType())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 5, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 6, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 7, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 8, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 9, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 10, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 11, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtGetChildren, 12, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtGetChildren, 13, filter.byCategory())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtGetChildren, 14, filter.byCategory())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtGetChildren, 15, filter.byCategory())) == SQLITE_OK)
-    {
-        string wildCardName = '*' + filter.byName() + '*';
-        if ((sqlResult = sqlite3_bind_text(mStmtGetChildren, 16, wildCardName.c_str(), static_cast<int>(wildCardName.length()), SQLITE_STATIC)) == SQLITE_OK)
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 1, flags)) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 2, filter.byLocationHandle())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtGetChildren, 3, filter.byNodeType())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtGetChildren, 4, filter.byNodeType())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 5, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 6, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 7, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 8, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 9, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 10, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 11, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtGetChildren, 12, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtGetChildren, 13, filter.byCategory())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtGetChildren, 14, filter.byCategory())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtGetChildren, 15, filter.byCategory())) == SQLITE_OK)
+    {
+        string nameArg = useFts ? ftsQuoteName(filter.byName()) : '*' + filter.byName() + '*';
+        if ((sqlResult = sqlite3_bind_text(stmtGetChildren, 16, nameArg.c_str(), static_cast<int>(nameArg.length()), SQLITE_STATIC)) == SQLITE_OK &&
+            (sqlResult = sqlite3_bind_int64(stmtGetChildren, 17, page.size() ? static_cast<sqlite3_int64>(page.size()) : -1)) == SQLITE_OK &&
+            (sqlResult = sqlite3_bind_int64(stmtGetChildren, 18, static_cast<sqlite3_int64>(page.startingOffset()))) == SQLITE_OK)
         {
-            result = processSqlQueryNodes(mStmtGetChildren, children);
+            result = processSqlQueryNodes(stmtGetChildren, children);
         }
     }
 
@@ -1401,13 +1865,15 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, vecto
     string errMsg("Get children with filter");
     errorHandler(sqlResult, errMsg, true);
 
-    sqlite3_reset(mStmtGetChildren);
+    sqlite3_reset(stmtGetChildren);
 
     return result;
 }
 
 bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, vector<pair<NodeHandle, NodeSerialized>>& nodes, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1418,8 +1884,11 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, vector<pair
         sqlite3_progress_handler(db, NUM_VIRTUAL_MACHINE_INSTRUCTIONS, SqliteAccountState::progressHandler, static_cast<void*>(&cancelFlag));
     }
 
+    const bool useFts = useFtsNameIndex(filter.byName());
+    sqlite3_stmt*& stmtSearchNodes = useFts ? mStmtSearchNodesFts : mStmtSearchNodes;
+
     int sqlResult = SQLITE_OK;
-    if (!mStmtSearchNodes)
+    if (!stmtSearchNodes)
     {
         std::string sqlQuery = "SELECT n1.nodehandle, n1.counter, n1.node "
                                "FROM nodes n1 "
@@ -1434,12 +1903,13 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, vector<pair
                                                                                                                   ',' + std::to_string(MIME_TYPE_PDF) +
                                                                                                                   ',' + std::to_string(MIME_TYPE_PRESENTATION) +
                                                                                                                   ',' + std::to_string(MIME_TYPE_SPREADSHEET) + "))"
-                                              " OR n1.mimetype = ?))) "
-                                 "AND (n1.name REGEXP ?) ";
-        // Leading and trailing '*' will be added to argument '?' so we are looking for a substring of name
-        // Our REGEXP implementation is case insensitive
+                                              " OR n1.mimetype = ?))) ";
+        // Substring match on name: through the trigram FTS index when it can serve this
+        // lookup, with a scan over 'nodes' as fallback (both are case insensitive)
+        sqlQuery += useFts ? "AND (n1.nodehandle IN (SELECT rowid FROM fts_nodes WHERE fts_nodes MATCH ?)) "
+                           : "AND (n1.name REGEXP ?) "; // leading and trailing '*' will be added to argument '?'
 
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtSearchNodes, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmtSearchNodes, NULL);
     }
 
     bool result = false;
@@ -1447,27 +1917,27 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, vector<pair
                             (filter.bySensitivity() ? (1 << Node::FLAGS_IS_MARKED_SENSTIVE) : 0); // filter by sensitivity
 
     if (sqlResult == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 1, excludeFlags)) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 2, filter.byNodeType())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 3, filter.byNodeType())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 4, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 5, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 6, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 7, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 8, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 9, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 10, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int64(mStmtSearchNodes, 11, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 12, filter.byShareType())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 13, filter.byShareType())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 14, filter.byCategory())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 15, filter.byCategory())) == SQLITE_OK &&
-        (sqlResult = sqlite3_bind_int(mStmtSearchNodes, 16, filter.byCategory())) == SQLITE_OK)
-    {
-        string wildCardName = '*' + filter.byName() + '*';
-        if ((sqlResult = sqlite3_bind_text(mStmtSearchNodes, 17, wildCardName.c_str(), static_cast<int>(wildCardName.length()), SQLITE_STATIC)) == SQLITE_OK)
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 1, excludeFlags)) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 2, filter.byNodeType())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 3, filter.byNodeType())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 4, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 5, filter.byCreationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 6, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 7, filter.byCreationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 8, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 9, filter.byModificationTimeLowerLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 10, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int64(stmtSearchNodes, 11, filter.byModificationTimeUpperLimit())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 12, filter.byShareType())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 13, filter.byShareType())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 14, filter.byCategory())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 15, filter.byCategory())) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmtSearchNodes, 16, filter.byCategory())) == SQLITE_OK)
+    {
+        string nameArg = useFts ? ftsQuoteName(filter.byName()) : '*' + filter.byName() + '*';
+        if ((sqlResult = sqlite3_bind_text(stmtSearchNodes, 17, nameArg.c_str(), static_cast<int>(nameArg.length()), SQLITE_STATIC)) == SQLITE_OK)
         {
-            result = processSqlQueryNodes(mStmtSearchNodes, nodes);
+            result = processSqlQueryNodes(stmtSearchNodes, nodes);
         }
     }
 
@@ -1477,7 +1947,7 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, vector<pair
     string errMsg(filter.byShareType() == NO_SHARES ? "Search nodes with filter" : "Search shares or links with filter");
     errorHandler(sqlResult, errMsg, true);
 
-    sqlite3_reset(mStmtSearchNodes);
+    sqlite3_reset(stmtSearchNodes);
 
     return result;
 }
@@ -1485,6 +1955,8 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, vector<pair
 /** @deprecated */
 bool SqliteAccountState::searchForNodesByName(const std::string &name, std::vector<std::pair<NodeHandle, NodeSerialized>> &nodes, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1507,7 +1979,7 @@ bool SqliteAccountState::searchForNodesByName(const std::string &name, std::vect
         // Leading and trailing '*' will be added to argument '?' so we are looking for a substring of name
         // Our REGEXP implementation is case insensitive
 
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtNodeByName, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodeByName, NULL);
     }
 
     bool result = false;
@@ -1533,6 +2005,8 @@ bool SqliteAccountState::searchForNodesByName(const std::string &name, std::vect
 /** @deprecated */
 bool SqliteAccountState::searchForNodesByNameNoRecursive(const std::string& name, std::vector<std::pair<NodeHandle, NodeSerialized> >& nodes, NodeHandle parentHandle, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1554,7 +2028,7 @@ bool SqliteAccountState::searchForNodesByNameNoRecursive(const std::string& name
         // Leading and trailing '*' will be added to argument '?' so we are looking for a substring of name
         // Our REGEXP implementation is case insensitive
 
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtNodeByNameNoRecursive, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodeByNameNoRecursive, NULL);
     }
 
     bool result = false;
@@ -1583,6 +2057,8 @@ bool SqliteAccountState::searchForNodesByNameNoRecursive(const std::string& name
 /** @deprecated */
 bool SqliteAccountState::searchInShareOrOutShareByName(const std::string& name, std::vector<std::pair<NodeHandle, NodeSerialized> >& nodes, ShareType_t shareType, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1604,7 +2080,7 @@ bool SqliteAccountState::searchInShareOrOutShareByName(const std::string& name,
         // Leading and trailing '*' will be added to argument '?' so we are looking for a substring of name
         // Our REGEXP implementation is case insensitive
 
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtInShareOutShareByName, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtInShareOutShareByName, NULL);
     }
 
     bool result = false;
@@ -1635,6 +2111,8 @@ bool SqliteAccountState::searchInShareOrOutShareByName(const std::string& name,
 
 bool SqliteAccountState::getNodesByFingerprint(const std::string &fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized> > &nodes)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1643,7 +2121,7 @@ bool SqliteAccountState::getNodesByFingerprint(const std::string &fingerprint, s
     int sqlResult = SQLITE_OK;
     if (!mStmtNodesByFp)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT nodehandle, counter, node FROM nodes WHERE fingerprint = ?", -1, &mStmtNodesByFp, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT nodehandle, counter, node FROM nodes WHERE fingerprint = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodesByFp, NULL);
     }
 
     bool result = false;
@@ -1668,6 +2146,8 @@ bool SqliteAccountState::getNodesByFingerprint(const std::string &fingerprint, s
 
 bool SqliteAccountState::getNodeByFingerprint(const std::string &fingerprint, mega::NodeSerialized &node, NodeHandle& handle)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1676,7 +2156,7 @@ bool SqliteAccountState::getNodeByFingerprint(const std::string &fingerprint, me
     int sqlResult = SQLITE_OK;
     if (!mStmtNodeByFp)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT nodehandle, counter, node FROM nodes WHERE fingerprint = ? LIMIT 1", -1, &mStmtNodeByFp, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT nodehandle, counter, node FROM nodes WHERE fingerprint = ? LIMIT 1", -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodeByFp, NULL);
     }
 
     bool result = false;
@@ -1704,8 +2184,49 @@ bool SqliteAccountState::getNodeByFingerprint(const std::string &fingerprint, me
     return result;
 }
 
+bool SqliteAccountState::getHandleByFingerprint(const std::string& fingerprint, NodeHandle& handle)
+{
+    flushPutNodeBatch();
+
+    if (!db)
+    {
+        return false;
+    }
+
+    int sqlResult = SQLITE_OK;
+    if (!mStmtHandleByFp)
+    {
+        // answered entirely from 'fingerprinthandleindex', no node blob is touched
+        sqlResult = sqlite3_prepare_v3(db, "SELECT nodehandle FROM nodes WHERE fingerprint = ? LIMIT 1", -1, SQLITE_PREPARE_PERSISTENT, &mStmtHandleByFp, NULL);
+    }
+
+    bool result = false;
+    if (sqlResult == SQLITE_OK)
+    {
+        if ((sqlResult = sqlite3_bind_blob(mStmtHandleByFp, 1, fingerprint.data(), (int)fingerprint.size(), SQLITE_STATIC)) == SQLITE_OK)
+        {
+            if ((sqlResult = sqlite3_step(mStmtHandleByFp)) == SQLITE_ROW)
+            {
+                handle.set6byte(sqlite3_column_int64(mStmtHandleByFp, 0));
+                result = true;
+            }
+        }
+    }
+
+    if (sqlResult != SQLITE_OK && sqlResult != SQLITE_ROW && sqlResult != SQLITE_DONE)
+    {
+        errorHandler(sqlResult, "Get handle by fingerprint", false);
+    }
+
+    sqlite3_reset(mStmtHandleByFp);
+
+    return result;
+}
+
 bool SqliteAccountState::getRecentNodes(unsigned maxcount, m_time_t since, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1721,7 +2242,7 @@ bool SqliteAccountState::getRecentNodes(unsigned maxcount, m_time_t since, std::
     int sqlResult = SQLITE_OK;
     if (!mStmtRecents)
     {
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtRecents, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtRecents, NULL);
     }
 
     bool stepResult = false;
@@ -1750,6 +2271,8 @@ bool SqliteAccountState::getRecentNodes(unsigned maxcount, m_time_t since, std::
 
 bool SqliteAccountState::getFavouritesHandles(NodeHandle node, uint32_t count, std::vector<mega::NodeHandle> &nodes)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1765,7 +2288,7 @@ bool SqliteAccountState::getFavouritesHandles(NodeHandle node, uint32_t count, s
                                 "FROM nodes AS N INNER JOIN nodesCTE AS P ON (N.parenthandle = P.nodehandle AND P.type != " + std::to_string(FILENODE) + ")) SELECT node.nodehandle "
                                 "FROM nodesCTE AS node WHERE node.fav = 1";
 
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtFavourites, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtFavourites, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -1791,6 +2314,8 @@ bool SqliteAccountState::getFavouritesHandles(NodeHandle node, uint32_t count, s
 
 bool SqliteAccountState::childNodeByNameType(NodeHandle parentHandle, const std::string& name, nodetype_t nodeType, std::pair<NodeHandle, NodeSerialized> &node)
 {
+    flushPutNodeBatch();
+
     bool success = false;
     if (!db)
     {
@@ -1802,7 +2327,7 @@ bool SqliteAccountState::childNodeByNameType(NodeHandle parentHandle, const std:
     int sqlResult = SQLITE_OK;
     if (!mStmtChildNode)
     {
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtChildNode, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtChildNode, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -1838,6 +2363,8 @@ bool SqliteAccountState::childNodeByNameType(NodeHandle parentHandle, const std:
 
 bool SqliteAccountState::getNodeSizeTypeAndFlags(NodeHandle node, m_off_t& size, nodetype_t& nodeType, uint64_t& oldFlags)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -1846,7 +2373,7 @@ bool SqliteAccountState::getNodeSizeTypeAndFlags(NodeHandle node, m_off_t& size,
     int sqlResult = SQLITE_OK;
     if (!mStmtTypeAndSizeNode)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT type, size, flags FROM nodes WHERE nodehandle = ?", -1, &mStmtTypeAndSizeNode, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT type, size, flags FROM nodes WHERE nodehandle = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtTypeAndSizeNode, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -1874,6 +2401,8 @@ bool SqliteAccountState::getNodeSizeTypeAndFlags(NodeHandle node, m_off_t& size,
 
 bool SqliteAccountState::isAncestor(NodeHandle node, NodeHandle ancestor, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     bool result = false;
     if (!db)
     {
@@ -1894,7 +2423,7 @@ bool SqliteAccountState::isAncestor(NodeHandle node, NodeHandle ancestor, Cancel
     int sqlResult = SQLITE_OK;
     if (!mStmtIsAncestor)
     {
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtIsAncestor, NULL);
+        sqlResult = sqlite3_prepare_v3(db, sqlQuery.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtIsAncestor, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -1926,6 +2455,8 @@ bool SqliteAccountState::isAncestor(NodeHandle node, NodeHandle ancestor, Cancel
 
 uint64_t SqliteAccountState::getNumberOfNodes()
 {
+    flushPutNodeBatch();
+
     uint64_t count = 0;
     if (!db)
     {
@@ -1954,6 +2485,8 @@ uint64_t SqliteAccountState::getNumberOfNodes()
 
 uint64_t SqliteAccountState::getNumberOfChildrenByType(NodeHandle parentHandle, nodetype_t nodeType)
 {
+    flushPutNodeBatch();
+
     uint64_t count = 0;
     if (!db)
     {
@@ -1963,11 +2496,12 @@ uint64_t SqliteAccountState::getNumberOfChildrenByType(NodeHandle parentHandle,
     int sqlResult = SQLITE_OK;
     if (!mStmtNumChild)
     {
-        sqlResult = sqlite3_prepare_v2(db, "SELECT count(*) FROM nodes where parenthandle = ? AND type = ?", -1, &mStmtNumChild, NULL);
+        sqlResult = sqlite3_prepare_v3(db, "SELECT count(*) FROM nodes where parenthandle = ? AND type = ?", -1, SQLITE_PREPARE_PERSISTENT, &mStmtNumChild, NULL);
     }
 
     if (sqlResult == SQLITE_OK)
     {
+        SqliteQueryWatch watch(mStmtNumChild);
         if ((sqlResult = sqlite3_bind_int64(mStmtNumChild, 1, parentHandle.as8byte())) == SQLITE_OK)
         {
             if ((sqlResult = sqlite3_bind_int(mStmtNumChild, 2, nodeType)) == SQLITE_OK)
@@ -1993,6 +2527,8 @@ uint64_t SqliteAccountState::getNumberOfChildrenByType(NodeHandle parentHandle,
 /** @deprecated */
 bool SqliteAccountState::getNodesByMimetype(MimeType_t mimeType, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, Node::Flags requiredFlags, Node::Flags excludeFlags, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     if (!db)
     {
         return false;
@@ -2014,7 +2550,7 @@ bool SqliteAccountState::getNodesByMimetype(MimeType_t mimeType, std::vector<std
             .append(" AND n1.type =")
             .append(std::to_string(FILENODE));
 
-        sqlResult = sqlite3_prepare_v2(db, query.c_str(), -1, &mStmtNodeByMimeType, nullptr);
+        sqlResult = sqlite3_prepare_v3(db, query.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodeByMimeType, nullptr);
     }
     if (sqlResult == SQLITE_OK)
     {
@@ -2044,6 +2580,8 @@ bool SqliteAccountState::getNodesByMimetype(MimeType_t mimeType, std::vector<std
 /** @deprecated */
 bool SqliteAccountState::getNodesByMimetypeExclusiveRecursive(MimeType_t mimeType, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes, Node::Flags requiredFlags, Node::Flags excludeFlags, Node::Flags excludeRecursiveFlags, NodeHandle ancestorHandle, CancelToken cancelFlag)
 {
+    flushPutNodeBatch();
+
     assert(!ancestorHandle.isUndef());
     // must recurse from a specfic point
 
@@ -2075,7 +2613,7 @@ bool SqliteAccountState::getNodesByMimetypeExclusiveRecursive(MimeType_t mimeTyp
             "FROM nodesCTE AS node INNER JOIN nodes parent on node.parenthandle = parent.nodehandle AND ismimetype(node.name, ?) = 1 AND node.flags & ? = ? AND node.flags & ? = 0 AND parent.type != "
                             + std::to_string(FILENODE) + " AND node.type = " + std::to_string(FILENODE);
 
-        sqlResult = sqlite3_prepare_v2(db, query.c_str(), -1, &mStmtNodeByMimeTypeExcludeRecursiveFlags, nullptr);
+        sqlResult = sqlite3_prepare_v3(db, query.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &mStmtNodeByMimeTypeExcludeRecursiveFlags, nullptr);
     }
 
     if (sqlResult == SQLITE_OK)
@@ -43,6 +43,7 @@ File::File()
     syncxfer = false;
     fromInsycShare = false;
     temporaryfile = false;
+    forceNewUpload = false;
     tag = 0;
 }
 
@@ -336,6 +337,14 @@ void File::sendPutnodesOfUpload(MegaClient* client, UploadHandle fileAttrMatchHa
                         CommandPutNodes::Completion&& completion,
                         const m_time_t* overrideMtime, bool canChangeVault)
 {
+    if (cloneNode)
+    {
+        // an identical node was found when the transfer started: issue a
+        // server-side copy of it rather than referencing the uploaded data
+        sendPutnodesToCloneNode(client, cloneNode.get(), source, ovHandle, std::move(completion), canChangeVault);
+        return;
+    }
+
     vector<NewNode> newnodes(1);
     NewNode* newnode = &newnodes[0];
 
@@ -457,8 +466,21 @@ void File::sendPutnodesToCloneNode(MegaClient* client, Node* nodeToClone,
     else
     {
         NodeHandle th = h;
-        assert(syncxfer);
-        newnode->ovhandle = ovHandle;
+
+        if (syncxfer)
+        {
+            newnode->ovhandle = ovHandle;
+        }
+        else if (mVersioningOption != NoVersioning)
+        {
+            // for manual upload, let the API apply the `ov` according to the global versions_disabled flag.
+            std::shared_ptr<Node> n = client->nodeByHandle(th);
+            if (std::shared_ptr<Node> ovNode = client->getovnode(n.get(), &name))
+            {
+                newnode->ovhandle = ovNode->nodeHandle();
+            }
+        }
+
         client->reqs.add(new CommandPutNodes(client,
                                              th, NULL,
                                              mVersioningOption,
@@ -524,8 +546,20 @@ string File::displayname()
     return result;
 }
 
+trafficclass_t File::trafficclass() const
+{
+    return syncxfer ? TRAFFIC_SYNC : TRAFFIC_MANUAL;
+}
+
 #ifdef ENABLE_SYNC
 
+trafficclass_t SyncTransfer_inClient::trafficclass() const
+{
+    // backups are the only syncs allowed to change the Vault
+    return syncThreadSafeState && syncThreadSafeState->mCanChangeVault ? TRAFFIC_BACKUP
+                                                                       : TRAFFIC_SYNC;
+}
+
 void SyncTransfer_inClient::terminated(error e)
 {
     File::terminated(e);
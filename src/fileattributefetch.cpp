@@ -22,9 +22,177 @@
 #include "mega/fileattributefetch.h"
 #include "mega/megaclient.h"
 #include "mega/megaapp.h"
+#include "mega/db.h"
+#include "mega/utils.h"
 #include "mega/logging.h"
 
 namespace mega {
+
+FileAttributeCache::FileAttributeCache()
+{
+}
+
+FileAttributeCache::~FileAttributeCache()
+{
+}
+
+void FileAttributeCache::init(DbTable* table)
+{
+    mEntries.clear();
+    mTotalSize = 0;
+    mTable.reset(table);
+
+    if (!mTable)
+    {
+        return;
+    }
+
+    // build the in-memory index: dbid, size and recency per attribute handle
+    uint32_t dbid;
+    string record;
+
+    mTable->rewind();
+    while (mTable->next(&dbid, &record))
+    {
+        CacheableReader r(record);
+        handle fah;
+        uint16_t type;
+        int64_t lastuse;
+
+        if (!r.unserializehandle(fah) || !r.unserializeu16(type) || !r.unserializei64(lastuse))
+        {
+            mTable->del(dbid);
+            continue;
+        }
+
+        Entry& e = mEntries[fah];
+        e.dbid = dbid;
+        e.size = unsigned(r.end - r.ptr);
+        e.lastuse = lastuse;
+        mTotalSize += e.size;
+
+        if (dbid > mTable->nextid)
+        {
+            mTable->nextid = dbid;
+        }
+    }
+
+    LOG_debug << "File attribute cache loaded: " << mEntries.size() << " records, " << mTotalSize << " bytes";
+
+    evict();
+}
+
+bool FileAttributeCache::get(handle fah, string* data)
+{
+    map<handle, Entry>::iterator it = mEntries.find(fah);
+
+    if (!mTable || it == mEntries.end())
+    {
+        return false;
+    }
+
+    string record;
+
+    if (!mTable->get(it->second.dbid, &record))
+    {
+        mEntries.erase(it);
+        return false;
+    }
+
+    CacheableReader r(record);
+    handle storedfah;
+    uint16_t type;
+    int64_t lastuse;
+
+    if (!r.unserializehandle(storedfah) || !r.unserializeu16(type) || !r.unserializei64(lastuse) || storedfah != fah)
+    {
+        mTable->del(it->second.dbid);
+        mTotalSize -= it->second.size;
+        mEntries.erase(it);
+        return false;
+    }
+
+    data->assign(r.ptr, r.end - r.ptr);
+
+    // refresh recency so the record survives eviction across sessions
+    it->second.lastuse = m_time();
+    put(fah, type, data->data(), unsigned(data->size()));
+
+    return true;
+}
+
+void FileAttributeCache::put(handle fah, fatype t, const char* data, unsigned len)
+{
+    if (!mTable || !len || len > MAXSIZE / 4)
+    {
+        return;
+    }
+
+    Entry& e = mEntries[fah];
+
+    if (!e.dbid)
+    {
+        e.dbid = mTable->nextid += DbTable::IDSPACING;
+    }
+    else
+    {
+        mTotalSize -= e.size;
+    }
+
+    e.size = len;
+    e.lastuse = m_time();
+    mTotalSize += len;
+
+    string record;
+    CacheableWriter w(record);
+    w.serializehandle(fah);
+    w.serializeu16(t);
+    w.serializei64(e.lastuse);
+    w.serializebinary((byte*)data, len);
+
+    mTable->put(e.dbid, &record);
+
+    evict();
+}
+
+void FileAttributeCache::evict()
+{
+    while (mTable && mTotalSize > MAXSIZE && mEntries.size())
+    {
+        map<handle, Entry>::iterator oldest = mEntries.begin();
+
+        for (map<handle, Entry>::iterator it = mEntries.begin(); it != mEntries.end(); it++)
+        {
+            if (it->second.lastuse < oldest->second.lastuse)
+            {
+                oldest = it;
+            }
+        }
+
+        LOG_debug << "Evicting cached file attribute: " << toHandle(oldest->first);
+        mTable->del(oldest->second.dbid);
+        mTotalSize -= oldest->second.size;
+        mEntries.erase(oldest);
+    }
+}
+
+void FileAttributeCache::reset()
+{
+    mTable.reset();
+    mEntries.clear();
+    mTotalSize = 0;
+}
+
+void FileAttributeCache::remove()
+{
+    if (mTable)
+    {
+        mTable->remove();
+    }
+
+    reset();
+}
+
 FileAttributeFetchChannel::FileAttributeFetchChannel(MegaClient* client)
     : client(client), bt(client->rng), timeout(client->rng)
 {
@@ -33,31 +201,44 @@ FileAttributeFetchChannel::FileAttributeFetchChannel(MegaClient* client)
     urltime = 0;
     fahref = UNDEF;
     inbytes = 0;
+    urlfetching = false;
     e = API_EINTERNAL;
 }
 
-FileAttributeFetch::FileAttributeFetch(handle h, string key, fatype t, int ctag)
+FileAttributeFetch::FileAttributeFetch(handle h, string key, fatype t, int ctag, unsigned sn)
 {
     nodehandle = h;
     nodekey = key;
     type = t;
     retries = 0;
     tag = ctag;
+    seqno = sn;
 }
 
 void FileAttributeFetchChannel::dispatch()
 {
     faf_map::iterator it;
 
-    // reserve space
-    req.outbuf.clear();
-    req.outbuf.reserve((fafs[0].size() + fafs[1].size()) * sizeof(handle));
+    // the server streams attributes back in request order, so put attributes
+    // of nodes the app has flagged as visible first, then the most recently
+    // requested ones: those are what the user's viewport is waiting on right
+    // now, and they decode while the rest of the batch is still on the wire
+    struct Ordered
+    {
+        bool pri;
+        unsigned seqno;
+        handle fah;
+    };
+
+    vector<Ordered> order;
+    order.reserve(fafs[0].size() + fafs[1].size());
 
     for (int i = 2; i--; )
     {
         for (it = fafs[i].begin(); it != fafs[i].end(); )
         {
-            req.outbuf.append((char*)&it->first, sizeof(handle));
+            order.push_back(Ordered{ client->fapriority.count(it->second->nodehandle) > 0,
+                                     it->second->seqno, it->first });
 
             if (!i)
             {
@@ -72,6 +253,17 @@ void FileAttributeFetchChannel::dispatch()
         }
     }
 
+    std::sort(order.begin(), order.end(), [](const Ordered& a, const Ordered& b)
+              { return a.pri != b.pri ? a.pri : a.seqno > b.seqno; });
+
+    req.outbuf.clear();
+    req.outbuf.reserve(order.size() * sizeof(handle));
+
+    for (const auto& o : order)
+    {
+        req.outbuf.append((char*)&o.fah, sizeof(handle));
+    }
+
     if (req.outbuf.size())
     {
         LOG_debug << "Getting file attribute";
@@ -145,6 +337,9 @@ void FileAttributeFetchChannel::parse(int /*fac*/, bool final)
                 SymmCipher *cipher = client->getRecycledTemporaryNodeCipher(&it->second->nodekey);
                 if (cipher)
                 {
+                    // keep the wire form for the durable cache before decrypting in place
+                    client->facache.put(h, it->second->type, ptr, falen);
+
                     if (!cipher->cbc_decrypt((byte*)ptr, falen))
                     {
                         LOG_err << "Failed to CBC decrypt file attributes";
@@ -189,24 +189,65 @@ bool FileFingerprint::genfingerprint(FileAccess* fa, bool ignoremtime)
     {
         // large file: sparse coverage, four sparse CRC32s
         HashCRC32 crc32;
-        byte block[4 * sizeof crc];
-        const unsigned blocks = MAXFULL / unsigned(sizeof block * crc.size());
+        const unsigned blocksize = 4 * sizeof crc;
+        const unsigned blocks = MAXFULL / unsigned(blocksize * crc.size());
+
+        // plan all sampled offsets up front: for files not far above MAXFULL
+        // the samples sit close together (or overlap), so neighbouring blocks
+        // can be fetched with one read instead of one syscall per block
+        const unsigned samples = unsigned(crc.size()) * blocks;
+        std::vector<m_off_t> offsets(samples);
+
+        for (unsigned s = 0; s < samples; s++)
+        {
+            offsets[s] = (size - blocksize) * s / (samples - 1);
+        }
+
+        // let the kernel start fetching every sampled region before the reads begin
+        for (unsigned s = 0; s < samples; s++)
+        {
+            fa->fadvise(FileAccess::ACCESS_WILLNEED, offsets[s], blocksize);
+        }
+
+        // coalesce samples separated by less than one readahead window
+        static const m_off_t COALESCEGAP = 16384;
+        std::vector<byte> runbuf;
+        m_off_t runstart = 0;
+        m_off_t runlen = 0;
+        unsigned s = 0;
 
         for (unsigned i = 0; i < crc.size(); i++)
         {
-            for (unsigned j = 0; j < blocks; j++)
+            for (unsigned j = 0; j < blocks; j++, s++)
             {
-                if (!fa->frawread(block, sizeof block,
-                                  (size - sizeof block)
-                                  * (i * blocks + j)
-                                  / (crc.size() * blocks - 1), true, FSLogging::logOnError))
+                m_off_t offset = offsets[s];
+
+                if (!runlen || offset + blocksize > runstart + runlen)
                 {
-                    size = -1;
-                    fa->closef();
-                    return true;
+                    // extend the run while the next sample starts within
+                    // COALESCEGAP of its end, then fetch it in one read
+                    unsigned last = s;
+                    m_off_t end = offset + blocksize;
+
+                    while (last + 1 < samples && offsets[last + 1] <= end + COALESCEGAP)
+                    {
+                        last++;
+                        end = offsets[last] + blocksize;
+                    }
+
+                    runstart = offset;
+                    runlen = end - offset;
+                    runbuf.resize(size_t(runlen));
+
+                    if (!fa->frawread(runbuf.data(), unsigned(runlen), runstart, true, FSLogging::logOnError))
+                    {
+                        size = -1;
+                        fa->closef();
+                        return true;
+                    }
                 }
 
-                crc32.add(block, sizeof block);
+                crc32.add(runbuf.data() + (offset - runstart), blocksize);
             }
 
             crc32.get((byte*)&crcval);
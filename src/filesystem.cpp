@@ -386,6 +386,40 @@ int compareUtf(const LocalPath& s1, bool unescaping1, const LocalPath& s2, bool
         caseInsensitive ? Utils::toUpper: detail::identity);
 }
 
+uint64_t canonicalNameHash(const string& name)
+{
+    auto it = unicodeCodepointIterator(name);
+
+#ifdef _WIN32
+    it = detail::skipPrefix(it);
+#endif
+
+    // FNV-1a over the canonical codepoint sequence.  Case folding is applied
+    // unconditionally: for case sensitive syncs that only merges case variant
+    // names into the same hash bucket, and the compareUtf confirmation that
+    // follows a hash match still tells them apart.
+    uint64_t h = 14695981039346656037ull;
+
+    while (!it.end())
+    {
+        int c = it.get();
+
+        if (c == detail::escapeChar)
+        {
+            int ce = detail::decodeEscape(it);
+            if (ce != -1)
+            {
+                c = ce;
+            }
+        }
+
+        h ^= uint64_t(uint32_t(Utils::toUpper(c)));
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
 RemotePath::RemotePath(const string& path)
   : mPath(path)
 {
@@ -938,13 +972,87 @@ void FileSystemAccess::unescapefsincompatible(string *name) const
     }
 }
 
+namespace {
+
+// Memoizes NFC normalization results for non-ASCII strings.  Sync and
+// transfer path handling normalize the same names (directory components
+// especially) over and over, and utf8proc's NFC pass is expensive.
+class Utf8NormalizationCache
+{
+public:
+    // True if raw's normalization is known, in which case it's copied out.
+    bool lookup(const string& raw, string& normalized)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        auto it = mEntries.find(raw);
+
+        if (it == mEntries.end())
+            return false;
+
+        normalized = it->second;
+        return true;
+    }
+
+    void store(const string& raw, const string& normalized)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        // Crude but effective size bound; the set of unique names seen in
+        // a session is normally far smaller.
+        if (mEntries.size() >= MAXENTRIES)
+            mEntries.clear();
+
+        mEntries[raw] = normalized;
+    }
+
+private:
+    enum { MAXENTRIES = 65536 };
+
+    std::mutex mMutex;
+    std::unordered_map<string, string> mEntries;
+};
+
+Utf8NormalizationCache& utf8NormalizationCache()
+{
+    static Utf8NormalizationCache cache;
+    return cache;
+}
+
+} // anonymous namespace
+
 void LocalPath::utf8_normalize(string* filename)
 {
     if (!filename) return;
 
+    // ASCII is unchanged by NFC: skip utf8proc (and the cache) entirely.
+    bool ascii = true;
+
+    for (char c : *filename)
+    {
+        if (static_cast<unsigned char>(c) >= 0x80)
+        {
+            ascii = false;
+            break;
+        }
+    }
+
+    if (ascii) return;
+
+    // Each unique name needs normalizing only once per session.  Whole
+    // paths are cacheable too, but it's the components that repeat.
+    const bool cacheable = filename->size() <= 1024;
+
+    string result;
+
+    if (cacheable && utf8NormalizationCache().lookup(*filename, result))
+    {
+        *filename = std::move(result);
+        return;
+    }
+
     const char* cfilename = filename->c_str();
     size_t fnsize = filename->size();
-    string result;
 
     for (size_t i = 0; i < fnsize; )
     {
@@ -971,6 +1079,9 @@ void LocalPath::utf8_normalize(string* filename)
         i += strlen(substring);
     }
 
+    if (cacheable)
+        utf8NormalizationCache().store(*filename, result);
+
     *filename = std::move(result);
 }
 
@@ -1052,6 +1163,26 @@ void DirNotify::notify(NotificationDeque& q, LocalNode* l, Notification::ScanReq
     // filter when the notifications are processed.  Also, queueing it here is faster than logging the decision anyway.
 
     Notification n(immediate ? 0 : Waiter::ds, sr, std::move(path), l);
+
+    // Builds and similar bursts deliver thousands of events for the same few
+    // paths; fold exact repeats into a recent entry instead of queueing them
+    // all for the sync loop to resolve one by one.
+    if (q.coalesce(n))
+    {
+        return;
+    }
+
+    // If the queue has grown out of hand despite coalescing, collapse it into
+    // a full rescan via the same recovery path as a platform notification
+    // buffer overflow.
+    if (q.size() >= MAX_QUEUED_NOTIFICATIONS)
+    {
+        LOG_warn << "Filesystem notification queue overflowed, collapsing to full rescan";
+        q.clear();
+        ++mErrorCount;
+        return;
+    }
+
     q.pushBack(std::move(n));
 }
 
@@ -1099,6 +1230,18 @@ bool FileAccess::isfolder(const LocalPath& path)
     return type == FOLDERNODE;
 }
 
+bool FileAccess::fwriteZeros(unsigned, m_off_t)
+{
+    // no platform support: the caller writes the zeros out normally
+    return false;
+}
+
+bool FileAccess::fpreallocate(m_off_t)
+{
+    // no platform support: the file grows as it is written
+    return false;
+}
+
 // check if size and mtime are unchanged, then open for reading
 bool FileAccess::openf(FSLogging fsl)
 {
@@ -2395,7 +2538,13 @@ ScanService::ScanService()
 
     if (++mNumServices == 1)
     {
-        mWorker.reset(new Worker());
+        // scale the shared pool with the hardware: independent directories
+        // can be scanned and fingerprinted concurrently (each sync caps how
+        // many requests it keeps in flight)
+        size_t numThreads = std::max<size_t>(2,
+                std::min<size_t>(std::thread::hardware_concurrency(), 8));
+
+        mWorker.reset(new Worker(numThreads));
     }
 }
 
@@ -2435,8 +2584,7 @@ ScanService::ScanRequest::ScanRequest(shared_ptr<Waiter> waiter,
 }
 
 ScanService::Worker::Worker(size_t numThreads)
-    : mFsAccess(new FSACCESS_CLASS())
-    , mPending()
+    : mPending()
     , mPendingLock()
     , mPendingNotifier()
     , mThreads()
@@ -2501,12 +2649,18 @@ void ScanService::Worker::queue(ScanRequestPtr request)
 
 void ScanService::Worker::loop()
 {
+    // Each thread gets its own filesystem access: implementations aren't
+    // guaranteed to be safe to share between concurrently scanning threads.
+    FSACCESS_CLASS fsAccess;
+
     // We're ready when we have some work to do.
-    auto ready = [this]() { return !mPending.empty(); };
+    auto ready = [this]() { return !mPending.empty() || !mPendingBatches.empty(); };
 
     for ( ; ; )
     {
         ScanRequestPtr request;
+        FingerprintBatchPtr batch;
+        size_t batchIndex = 0;
 
         {
             // Wait for something to do.
@@ -2515,24 +2669,81 @@ void ScanService::Worker::loop()
 
             assert(ready()); // condition variable should have taken care of this
 
-            // Are we being told to terminate?
-            if (!mPending.front())
+            // Deferred fingerprints first: they complete scans already under way.
+            if (!mPendingBatches.empty())
             {
-                // Bail, don't deque the sentinel.
-                return;
+                batch = mPendingBatches.front();
+                batchIndex = batch->mNext++;
+
+                if (batch->mNext == batch->mDeferred.size())
+                {
+                    mPendingBatches.pop_front();
+                }
             }
+            else
+            {
+                // Are we being told to terminate?
+                if (!mPending.front())
+                {
+                    // Bail, don't deque the sentinel.
+                    return;
+                }
 
-            request = std::move(mPending.front());
-            mPending.pop_front();
+                request = std::move(mPending.front());
+                mPending.pop_front();
+            }
+        }
+
+        if (batch)
+        {
+            fingerprintOne(fsAccess, std::move(batch), batchIndex);
+            continue;
         }
 
         LOG_verbose << "Directory scan begins: " << request->mTargetPath;
         using namespace std::chrono;
         auto scanStart = high_resolution_clock::now();
 
-        // Process the request.
+        // Process the request.  CRCs of new or changed files are deferred so
+        // several threads can compute them at once below.
         unsigned nFingerprinted = 0;
-        auto result = scan(request, nFingerprinted);
+        vector<size_t> deferred;
+        auto result = scan(fsAccess, request, nFingerprinted, deferred);
+
+        if (result == SCAN_SUCCESS && deferred.size() > 1)
+        {
+            // Hand the fingerprints to the pool; whichever threads are free
+            // (this one included) compute them while other directories are
+            // being discovered.  Whoever finishes the last one completes the
+            // request.
+            auto batchPtr = std::make_shared<FingerprintBatch>();
+            batchPtr->mRequest = std::move(request);
+            batchPtr->mDeferred = std::move(deferred);
+            batchPtr->mRemaining = batchPtr->mDeferred.size();
+            batchPtr->mNumFingerprinted = nFingerprinted;
+            batchPtr->mScanStart = scanStart;
+
+            {
+                std::unique_lock<std::mutex> lock(mPendingLock);
+                mPendingBatches.emplace_back(std::move(batchPtr));
+            }
+
+            mPendingNotifier.notify_all();
+            continue;
+        }
+
+        // Too few deferred fingerprints to be worth sharing out.
+        for (size_t index : deferred)
+        {
+            LocalPath filePath = request->mTargetPath;
+            filePath.appendWithSeparator(request->mResults[index].localname, false);
+
+            if (fsAccess.scanFingerprint(filePath, request->mResults[index]))
+            {
+                ++nFingerprinted;
+            }
+        }
+
         auto scanEnd = high_resolution_clock::now();
 
         if (result == SCAN_SUCCESS)
@@ -2556,16 +2767,17 @@ void ScanService::Worker::loop()
 // regardless of multiple clients too - there is only one filesystem after all (but not singleton!!)
 CodeCounter::ScopeStats ScanService::syncScanTime = { "folderScan" };
 
-auto ScanService::Worker::scan(ScanRequestPtr request, unsigned& nFingerprinted) -> ScanResult
+auto ScanService::Worker::scan(FileSystemAccess& fsAccess, ScanRequestPtr request, unsigned& nFingerprinted, std::vector<size_t>& deferredFingerprints) -> ScanResult
 {
     CodeCounter::ScopeTimer rst(syncScanTime);
 
-    auto result = mFsAccess->directoryScan(request->mTargetPath,
+    auto result = fsAccess.directoryScan(request->mTargetPath,
         request->mExpectedFsid,
         request->mKnown,
         request->mResults,
         request->mFollowSymLinks,
-        nFingerprinted);
+        nFingerprinted,
+        &deferredFingerprints);
 
     // No need to keep this data around anymore.
     request->mKnown.clear();
@@ -2573,6 +2785,65 @@ auto ScanService::Worker::scan(ScanRequestPtr request, unsigned& nFingerprinted)
     return result;
 }
 
+void ScanService::Worker::fingerprintOne(FileSystemAccess& fsAccess, FingerprintBatchPtr batch, size_t index)
+{
+    CodeCounter::ScopeTimer rst(syncScanTime);
+
+    auto& request = batch->mRequest;
+    auto& node = request->mResults[batch->mDeferred[index]];
+
+    LocalPath filePath = request->mTargetPath;
+    filePath.appendWithSeparator(node.localname, false);
+
+    bool fingerprinted = fsAccess.scanFingerprint(filePath, node);
+
+    bool completed;
+    unsigned nFingerprinted;
+
+    {
+        std::unique_lock<std::mutex> lock(mPendingLock);
+
+        if (fingerprinted)
+        {
+            ++batch->mNumFingerprinted;
+        }
+
+        nFingerprinted = batch->mNumFingerprinted;
+        completed = --batch->mRemaining == 0;
+    }
+
+    // Only the last entry completes the request; until then its results,
+    // including the one written above, aren't visible to the sync thread.
+    if (!completed) return;
+
+    using namespace std::chrono;
+    auto scanEnd = high_resolution_clock::now();
+
+    LOG_verbose << "Directory scan complete for: " << request->mTargetPath
+        << " entries: " << request->mResults.size()
+        << " taking " << duration_cast<milliseconds>(scanEnd - batch->mScanStart).count() << "ms"
+        << " fingerprinted: " << nFingerprinted;
+
+    request->mScanResult = SCAN_SUCCESS;
+    request->mWaiter->notify();
+}
+
+bool FileSystemAccess::scanFingerprint(const LocalPath& filePath, FSNode& node)
+{
+    auto fa = newfileaccess(false);
+
+    if (!fa->fopen(filePath, true, false, FSLogging::logOnError))
+    {
+        // The file may be opened exclusively by another process.
+        // In this case, the fingerprint (the crc portion) is invalid (for now).
+        return false;
+    }
+
+    node.fingerprint.genfingerprint(fa.get());
+
+    return true;
+}
+
 unique_ptr<FSNode> FSNode::fromFOpened(FileAccess& fa, const LocalPath& fullPath, FileSystemAccess& fsa)
 {
     unique_ptr<FSNode> result(new FSNode);
@@ -21,7 +21,6 @@
 
 #include "mega.h"
 #include "mega/gfx.h"
-#include <numeric>
 
 namespace mega {
 
@@ -103,8 +102,8 @@ bool GfxProc::isvideo(const LocalPath& localfilename)
 
 void *GfxProc::threadEntryPoint(void *param)
 {
-    GfxProc* gfxProcessor = (GfxProc*)param;
-    gfxProcessor->loop();
+    Worker* worker = (Worker*)param;
+    worker->proc->loop(worker);
     return NULL;
 }
 
@@ -120,13 +119,13 @@ std::vector<GfxProc::Dimension> GfxProc::getJobDimensions(GfxJob *job)
     return jobDimensions;
 }
 
-void GfxProc::loop()
+void GfxProc::loop(Worker* worker)
 {
     GfxJob *job = NULL;
     while (!finished)
     {
-        waiter.init(NEVER);
-        waiter.wait();
+        worker->waiter.init(NEVER);
+        worker->waiter.wait();
         while ((job = requests.pop()))
         {
             if (finished)
@@ -135,9 +134,54 @@ void GfxProc::loop()
                 break;
             }
 
-            LOG_debug << "Processing media file: " << job->h;
+            std::vector<std::string> images;
+            if (job->cancelToken.isCancelled())
+            {
+                // deliver the job unprocessed so checkevents() unwinds any
+                // pending file attribute bookkeeping for it
+                LOG_debug << "Skipping cancelled media file: " << job->h;
+                images.resize(job->imagetypes.size());
+            }
+            else
+            {
+                LOG_debug << "Processing media file: " << job->h;
+
+                // the first worker shares its provider with the synchronous
+                // paths and must serialize with them; the others have the
+                // provider to themselves
+                std::unique_lock<std::mutex> g(mutex, std::defer_lock);
+                if (worker->provider == mGfxProvider.get())
+                {
+                    g.lock();
+                }
+
+                worker->provider->setrenderbudget(job->refinement ? 0 : RENDERBUDGETMS);
+                images = generateImagesHelper(worker->provider, job->localfilename, getJobDimensions(job));
+                bool partial = worker->provider->partialrender();
+                worker->provider->setrenderbudget(0);
+
+                if (g.owns_lock())
+                {
+                    g.unlock();
+                }
+
+                if (partial && job->h.isNodeHandle() && !job->refinement)
+                {
+                    // the budget ran out: deliver the degraded images now and
+                    // requeue a full-quality pass behind everything else
+                    LOG_debug << "Requeueing unbudgeted refinement render for " << job->h;
+                    GfxJob* refine = new GfxJob();
+                    refine->h = job->h;
+                    memcpy(refine->key, job->key, SymmCipher::KEYLENGTH);
+                    refine->localfilename = job->localfilename;
+                    refine->imagetypes = job->imagetypes;
+                    refine->cancelToken = job->cancelToken;
+                    refine->background = true;
+                    refine->refinement = true;
+                    requests.push(refine);
+                }
+            }
 
-            auto images = generateImages(job->localfilename, getJobDimensions(job));
             for (auto& image : images)
             {
                 string* jpeg = image.empty() ? nullptr : new string(std::move(image));
@@ -148,20 +192,6 @@ void GfxProc::loop()
             client->waiter->notify();
         }
     }
-
-    while ((job = requests.pop()))
-    {
-        delete job;
-    }
-
-    while ((job = responses.pop()))
-    {
-        for (unsigned i = 0; i < job->imagetypes.size(); i++)
-        {
-            delete job->images[i];
-        }
-        delete job;
-    }
 }
 
 int GfxProc::checkevents(Waiter *)
@@ -272,7 +302,7 @@ void IGfxProvider::transform(int& w, int& h, int& rw, int& rh, int& px, int& py)
 }
 
 // load bitmap image, generate all designated sizes, attach to specified upload/node handle
-int GfxProc::gendimensionsputfa(FileAccess* /*fa*/, const LocalPath& localfilename, NodeOrUploadHandle th, SymmCipher* key, int missing)
+int GfxProc::gendimensionsputfa(FileAccess* /*fa*/, const LocalPath& localfilename, NodeOrUploadHandle th, SymmCipher* key, int missing, CancelToken cancelToken)
 {
     LOG_debug << "Creating thumb/preview for " << localfilename;
 
@@ -280,6 +310,11 @@ int GfxProc::gendimensionsputfa(FileAccess* /*fa*/, const LocalPath& localfilena
     job->h = th;
     memcpy(job->key, key->key, SymmCipher::KEYLENGTH);
     job->localfilename = localfilename;
+    job->cancelToken = cancelToken;
+
+    // restoring attributes on an existing node is best-effort backfill;
+    // upload-handle jobs gate the completion of an active upload
+    job->background = th.isNodeHandle();
 
     int generatingAttrs = 0;
     for (fatype i = static_cast<fatype>(DIMENSIONS.size()); i--; )
@@ -298,39 +333,417 @@ int GfxProc::gendimensionsputfa(FileAccess* /*fa*/, const LocalPath& localfilena
     }
 
     requests.push(job);
-    waiter.notify();
+    for (auto& worker : mWorkers)
+    {
+        worker->waiter.notify();
+    }
     return generatingAttrs;
 }
 
-std::vector<std::string> GfxProc::generateImagesHelper(const LocalPath& localfilepath, const std::vector<Dimension>& dimensions)
+// header-only facts about an image, gathered without decoding it
+struct ImageProbe
+{
+    enum { FORMAT_UNKNOWN, FORMAT_JPEG, FORMAT_PNG } format = FORMAT_UNKNOWN;
+
+    // pixel dimensions from the JPEG SOF or PNG IHDR header
+    int w = 0;
+    int h = 0;
+
+    // EXIF orientation tag; 1 is upright, anything else needs the decoder's rotation
+    int orientation = 1;
+
+    // embedded EXIF thumbnail (a plain JPEG), if IFD1 advertises one
+    m_off_t thumboffset = 0;
+    unsigned thumbsize = 0;
+    int thumbw = 0;
+    int thumbh = 0;
+
+    m_off_t filesize = 0;
+};
+
+// how much of the file the probe reads: the EXIF APP1 segment is capped at
+// 64 KB and headers directly follow it, so this covers them comfortably
+const unsigned PROBEREADSIZE = 128 * 1024;
+
+// largest original JPEG we attach byte-for-byte instead of re-encoding
+const m_off_t MAXRAWATTACHSIZE = 2 * 1024 * 1024;
+
+static unsigned be16(const byte* p)
+{
+    return (unsigned(p[0]) << 8) | p[1];
+}
+
+static unsigned be32(const byte* p)
+{
+    return (unsigned(p[0]) << 24) | (unsigned(p[1]) << 16) | (unsigned(p[2]) << 8) | p[3];
+}
+
+static unsigned exif16(const byte* p, bool bigendian)
+{
+    return bigendian ? be16(p) : unsigned(p[0]) | (unsigned(p[1]) << 8);
+}
+
+static unsigned exif32(const byte* p, bool bigendian)
+{
+    return bigendian ? be32(p) : unsigned(p[0]) | (unsigned(p[1]) << 8) | (unsigned(p[2]) << 16) | (unsigned(p[3]) << 24);
+}
+
+// extract the frame dimensions from the SOF segment of a JPEG header
+static bool scanjpegsof(const byte* data, size_t size, int& w, int& h)
+{
+    if (size < 4 || data[0] != 0xff || data[1] != 0xd8)
+    {
+        return false;
+    }
+
+    size_t pos = 2;
+    while (pos + 4 <= size)
+    {
+        if (data[pos] != 0xff)
+        {
+            break;
+        }
+
+        byte marker = data[pos + 1];
+        if (marker == 0xff)
+        {
+            pos++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd9))
+        {
+            pos += 2;
+            continue;
+        }
+        if (marker == 0xda)
+        {
+            // start of scan: the headers are over
+            break;
+        }
+
+        size_t len = be16(data + pos + 2);
+        if (len < 2 || pos + 2 + len > size)
+        {
+            break;
+        }
+
+        if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc)
+        {
+            if (len < 7 || pos + 9 > size)
+            {
+                break;
+            }
+            h = static_cast<int>(be16(data + pos + 5));
+            w = static_cast<int>(be16(data + pos + 7));
+            return w > 0 && h > 0;
+        }
+
+        pos += 2 + len;
+    }
+
+    return false;
+}
+
+// parse the TIFF structure inside an APP1 Exif segment: IFD0 for the
+// orientation tag, IFD1 for the embedded thumbnail location
+static void parseexif(const byte* tiff, size_t size, m_off_t tifffileoffset, ImageProbe& probe)
+{
+    if (size < 8)
+    {
+        return;
+    }
+
+    bool bigendian;
+    if (tiff[0] == 'M' && tiff[1] == 'M')
+    {
+        bigendian = true;
+    }
+    else if (tiff[0] == 'I' && tiff[1] == 'I')
+    {
+        bigendian = false;
+    }
+    else
+    {
+        return;
+    }
+
+    if (exif16(tiff + 2, bigendian) != 42)
+    {
+        return;
+    }
+
+    unsigned thumboffset = 0, thumbsize = 0;
+
+    unsigned ifd = exif32(tiff + 4, bigendian);
+    for (int pass = 0; pass < 2; pass++)    // IFD0 (main image), then IFD1 (thumbnail)
+    {
+        if (!ifd || ifd + 2 > size)
+        {
+            return;
+        }
+
+        unsigned entries = exif16(tiff + ifd, bigendian);
+        if (ifd + 2 + entries * 12 + 4 > size)
+        {
+            return;
+        }
+
+        for (unsigned i = 0; i < entries; i++)
+        {
+            const byte* e = tiff + ifd + 2 + i * 12;
+            unsigned tag = exif16(e, bigendian);
+            if (!pass && tag == 0x0112)         // Orientation
+            {
+                unsigned o = exif16(e + 8, bigendian);
+                if (o >= 1 && o <= 8)
+                {
+                    probe.orientation = static_cast<int>(o);
+                }
+            }
+            else if (pass && tag == 0x0201)     // JPEGInterchangeFormat
+            {
+                thumboffset = exif32(e + 8, bigendian);
+            }
+            else if (pass && tag == 0x0202)     // JPEGInterchangeFormatLength
+            {
+                thumbsize = exif32(e + 8, bigendian);
+            }
+        }
+
+        ifd = exif32(tiff + ifd + 2 + entries * 12, bigendian);
+    }
+
+    if (thumboffset && thumbsize)
+    {
+        probe.thumboffset = tifffileoffset + thumboffset;
+        probe.thumbsize = thumbsize;
+        if (size_t(thumboffset) + thumbsize <= size)
+        {
+            scanjpegsof(tiff + thumboffset, thumbsize, probe.thumbw, probe.thumbh);
+        }
+    }
+}
+
+static bool probejpeg(const byte* data, size_t size, ImageProbe& probe)
+{
+    if (size < 4 || data[0] != 0xff || data[1] != 0xd8)
+    {
+        return false;
+    }
+
+    size_t pos = 2;
+    while (pos + 4 <= size)
+    {
+        if (data[pos] != 0xff)
+        {
+            break;
+        }
+
+        byte marker = data[pos + 1];
+        if (marker == 0xff)
+        {
+            pos++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd9))
+        {
+            pos += 2;
+            continue;
+        }
+        if (marker == 0xda)
+        {
+            break;
+        }
+
+        size_t len = be16(data + pos + 2);
+        if (len < 2 || pos + 2 + len > size)
+        {
+            break;
+        }
+
+        if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc)
+        {
+            if (len < 7)
+            {
+                break;
+            }
+            probe.h = static_cast<int>(be16(data + pos + 5));
+            probe.w = static_cast<int>(be16(data + pos + 7));
+        }
+        else if (marker == 0xe1 && len > 8 && !memcmp(data + pos + 4, "Exif\0\0", 6))
+        {
+            parseexif(data + pos + 10, len - 8, m_off_t(pos) + 10, probe);
+        }
+
+        pos += 2 + len;
+    }
+
+    if (probe.w > 0 && probe.h > 0)
+    {
+        probe.format = ImageProbe::FORMAT_JPEG;
+        return true;
+    }
+    return false;
+}
+
+static bool probepng(const byte* data, size_t size, ImageProbe& probe)
+{
+    static const byte signature[] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+    if (size < 24 || memcmp(data, signature, sizeof signature) || memcmp(data + 12, "IHDR", 4))
+    {
+        return false;
+    }
+
+    probe.w = static_cast<int>(be32(data + 16));
+    probe.h = static_cast<int>(be32(data + 20));
+    if (probe.w <= 0 || probe.h <= 0)
+    {
+        return false;
+    }
+
+    probe.format = ImageProbe::FORMAT_PNG;
+    return true;
+}
+
+static bool readfilechunk(FileSystemAccess* fsaccess, const LocalPath& localfilepath, m_off_t offset, unsigned len, string* out)
+{
+    auto fa = fsaccess->newfileaccess();
+    if (!fa->fopen(localfilepath, true, false, FSLogging::logOnError) || offset + len > fa->size)
+    {
+        return false;
+    }
+
+    out->resize(len);
+    return fa->frawread((byte*)&(*out)[0], len, offset, true, FSLogging::logOnError);
+}
+
+// cheap header-only read of dimensions, orientation and embedded thumbnail
+static bool probeimage(FileSystemAccess* fsaccess, const LocalPath& localfilepath, ImageProbe& probe)
+{
+    auto fa = fsaccess->newfileaccess();
+    if (!fa->fopen(localfilepath, true, false, FSLogging::logOnError))
+    {
+        return false;
+    }
+
+    unsigned n = unsigned(std::min<m_off_t>(fa->size, PROBEREADSIZE));
+    if (n < 24)
+    {
+        return false;
+    }
+
+    string buf;
+    buf.resize(n);
+    if (!fa->frawread((byte*)&buf[0], n, 0, true, FSLogging::logOnError))
+    {
+        return false;
+    }
+
+    probe.filesize = fa->size;
+    const byte* data = (const byte*)buf.data();
+    return probejpeg(data, n, probe) || probepng(data, n, probe);
+}
+
+std::vector<std::string> GfxProc::generateImagesHelper(IGfxProvider* provider, const LocalPath& localfilepath, const std::vector<Dimension>& dimensions)
 {
     std::vector<std::string> images(dimensions.size());
 
-    int maxDimension = std::accumulate(
-        dimensions.begin(),
-        dimensions.end(),
-        0, 
-        [](int max, const Dimension& d) { return std::max(max, std::max(d.width, d.height)); });
+    // header-only probe (JPEG SOF/EXIF, PNG IHDR): when it tells us the
+    // decoder has nothing to add, the full decode below can be skipped
+    ImageProbe probe;
+    probeimage(client->fsaccess.get(), localfilepath, probe);
+
+    size_t pending = dimensions.size();
+
+    if (probe.format == ImageProbe::FORMAT_JPEG && probe.orientation == 1
+            && probe.filesize <= MAXRAWATTACHSIZE)
+    {
+        // an upright JPEG already inside the target bounding box would come
+        // out of decode+reencode at the same dimensions but lower quality:
+        // attach the original bytes instead
+        string original;
+        for (unsigned int i = 0; i < dimensions.size(); ++i)
+        {
+            int boxw = dimensions[i].width;
+            int boxh = dimensions[i].height ? dimensions[i].height : dimensions[i].width;
+            if (probe.w > boxw || probe.h > boxh)
+            {
+                continue;
+            }
+            if (original.empty()
+                    && !readfilechunk(client->fsaccess.get(), localfilepath, 0, unsigned(probe.filesize), &original))
+            {
+                break;
+            }
+            images[i] = original;
+            pending--;
+        }
+        if (!pending)
+        {
+            LOG_debug << "Original JPEG reused for all attributes, decode skipped";
+            return images;
+        }
+    }
+
+    // does the embedded EXIF thumbnail cover everything still missing?
+    int maxDimension = 0;
+    bool thumbcovers = probe.thumbw > 0 && probe.orientation == 1;
+    for (unsigned int i = 0; i < dimensions.size(); ++i)
+    {
+        if (!images[i].empty())
+        {
+            continue;
+        }
+        const Dimension& d = dimensions[i];
+        maxDimension = std::max(maxDimension, std::max(d.width, d.height));
+        thumbcovers &= d.height ? (probe.thumbw >= d.width || probe.thumbh >= d.height)
+                                : (std::min(probe.thumbw, probe.thumbh) >= d.width);
+    }
+
+    bool loaded = false;
+    if (thumbcovers)
+    {
+        // decode those few KB instead of the full multi-megapixel image
+        string thumb;
+        if (readfilechunk(client->fsaccess.get(), localfilepath, probe.thumboffset, probe.thumbsize, &thumb))
+        {
+            loaded = provider->readbitmapmem((const byte*)thumb.data(), thumb.size());
+            if (loaded)
+            {
+                LOG_debug << "Scaling embedded EXIF thumbnail, full decode skipped";
+            }
+        }
+    }
+
+    if (!loaded)
+    {
+        loaded = provider->readbitmap(client->fsaccess.get(), localfilepath, maxDimension);
+    }
 
-    if (mGfxProvider->readbitmap(client->fsaccess.get(), localfilepath, maxDimension))
+    if (loaded)
     {
         for (unsigned int i = 0; i < dimensions.size(); ++i)
         {
+            if (!images[i].empty())
+            {
+                continue;
+            }
+
             string jpeg;
             int width = dimensions[i].width, height = dimensions[i].height;
-            if (mGfxProvider->width() < width && mGfxProvider->height() < height)
+            if (provider->width() < width && provider->height() < height)
             {
                 LOG_debug << "Skipping upsizing of local preview";
-                width = mGfxProvider->width();
-                height = mGfxProvider->height();
+                width = provider->width();
+                height = provider->height();
             }
 
-            if (mGfxProvider->resizebitmap(width, height, &jpeg))
+            if (provider->resizebitmap(width, height, &jpeg))
             {
                 images[i] = std::move(jpeg);
             }
         }
-        mGfxProvider->freebitmap();
+        provider->freebitmap();
     }
 
     return images;
@@ -339,13 +752,13 @@ std::vector<std::string> GfxProc::generateImagesHelper(const LocalPath& localfil
 std::vector<std::string> GfxProc::generateImages(const LocalPath& localfilepath, const std::vector<Dimension>& dimensions)
 {
     std::lock_guard<std::mutex> g(mutex);
-    return generateImagesHelper(localfilepath, dimensions);
+    return generateImagesHelper(mGfxProvider.get(), localfilepath, dimensions);
 }
 
 std::string GfxProc::generateOneImage(const LocalPath& localfilepath, const Dimension& dimension)
 {
     std::lock_guard<std::mutex> g(mutex);
-    return generateImagesHelper(localfilepath, std::vector<Dimension>{ dimension })[0];
+    return generateImagesHelper(mGfxProvider.get(), localfilepath, std::vector<Dimension>{ dimension })[0];
 }
 
 bool GfxProc::savefa(const LocalPath& localfilepath, const Dimension& dimension, LocalPath& localdstpath)
@@ -378,26 +791,82 @@ bool GfxProc::savefa(const LocalPath& localfilepath, const Dimension& dimension,
 }
 
 GfxProc::GfxProc(std::unique_ptr<IGfxProvider> middleware)
+    : GfxProc(std::move(middleware), nullptr, 1)
+{
+}
+
+GfxProc::GfxProc(std::unique_ptr<IGfxProvider> middleware, std::function<std::unique_ptr<IGfxProvider>()> providerFactory, unsigned workerCount)
     : mGfxProvider(std::move(middleware))
+    , mProviderFactory(std::move(providerFactory))
+    , mWorkerCount(workerCount ? workerCount : 1)
 {
     client = NULL;
     finished = false;
 }
 
+void GfxProc::setjobpriority(handle h, bool up)
+{
+    requests.prioritize(h, up);
+}
+
 void GfxProc::startProcessingThread()
 {
-    thread.start(threadEntryPoint, this);
+    unsigned count = mWorkerCount;
+    if (count > 1 && !mProviderFactory)
+    {
+        // no way to mint extra thread-confined providers
+        count = 1;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        auto worker = ::mega::make_unique<Worker>();
+        worker->proc = this;
+        if (i == 0)
+        {
+            worker->provider = mGfxProvider.get();
+        }
+        else
+        {
+            worker->ownedProvider = mProviderFactory();
+            if (!worker->ownedProvider)
+            {
+                break;
+            }
+            worker->provider = worker->ownedProvider.get();
+        }
+        worker->thread.start(threadEntryPoint, worker.get());
+        mWorkers.push_back(std::move(worker));
+    }
     threadstarted = true;
 }
 
 GfxProc::~GfxProc()
 {
     finished = true;
-    waiter.notify();
     assert(threadstarted);
-    if (threadstarted)
+    for (auto& worker : mWorkers)
+    {
+        worker->waiter.notify();
+    }
+    for (auto& worker : mWorkers)
     {
-        thread.join();
+        worker->thread.join();
+    }
+
+    GfxJob *job;
+    while ((job = requests.pop()))
+    {
+        delete job;
+    }
+
+    while ((job = responses.pop()))
+    {
+        for (auto image : job->images)
+        {
+            delete image;
+        }
+        delete job;
     }
 }
 
@@ -409,24 +878,54 @@ GfxJobQueue::GfxJobQueue()
 void GfxJobQueue::push(GfxJob *job)
 {
     mutex.lock();
-    jobs.push_back(job);
+    (job->background ? backgroundJobs : jobs).push_back(job);
     mutex.unlock();
 }
 
 GfxJob *GfxJobQueue::pop()
 {
     mutex.lock();
-    if (jobs.empty())
+    std::deque<GfxJob *>& lane = jobs.empty() ? backgroundJobs : jobs;
+    if (lane.empty())
     {
         mutex.unlock();
         return NULL;
     }
-    GfxJob *job = jobs.front();
-    jobs.pop_front();
+
+    // serve jobs for nodes in the app's viewport before the rest of the lane
+    std::deque<GfxJob *>::iterator chosen = lane.begin();
+    if (!prioritized.empty())
+    {
+        for (std::deque<GfxJob *>::iterator it = lane.begin(); it != lane.end(); it++)
+        {
+            if ((*it)->h.isNodeHandle() && prioritized.count((*it)->h.nodeHandle().as8byte()))
+            {
+                chosen = it;
+                break;
+            }
+        }
+    }
+
+    GfxJob *job = *chosen;
+    lane.erase(chosen);
     mutex.unlock();
     return job;
 }
 
+void GfxJobQueue::prioritize(handle h, bool up)
+{
+    mutex.lock();
+    if (up)
+    {
+        prioritized.insert(h);
+    }
+    else
+    {
+        prioritized.erase(h);
+    }
+    mutex.unlock();
+}
+
 GfxJob::GfxJob()
 {
 
@@ -27,6 +27,16 @@ namespace mega {
 GfxProviderExternal::GfxProviderExternal()
 {
     processor = NULL;
+    ownprocessor = false;
+    failures = 0;
+}
+
+GfxProviderExternal::~GfxProviderExternal()
+{
+    if (ownprocessor)
+    {
+        delete processor;
+    }
 }
 
 void GfxProviderExternal::setProcessor(MegaGfxProcessor *processor)
@@ -34,6 +44,12 @@ void GfxProviderExternal::setProcessor(MegaGfxProcessor *processor)
 	this->processor = processor;
 }
 
+void GfxProviderExternal::setOwnedProcessor(MegaGfxProcessor *processor)
+{
+    this->processor = processor;
+    ownprocessor = true;
+}
+
 bool GfxProviderExternal::isgfx(string* name)
 {
 	if(!processor) return false;
@@ -65,17 +81,19 @@ bool GfxProviderExternal::readbitmap(FileSystemAccess* /*fa*/, const LocalPath&
     if(!processor) return false;
 
 	bool result = processor->readBitmap(localname.platformEncoded().c_str());
-	if(!result) return false;
+	if(!result) return false;    // unsupported file, not a processor health issue
 
 	w = processor->getWidth();
     if(w <= 0)
     {
+        failures++;
         return false;
     }
 
 	h = processor->getHeight();
     if(h <= 0)
     {
+        failures++;
         return false;
     }
 
@@ -92,14 +110,43 @@ bool GfxProviderExternal::resizebitmap(int rw, int rh, string* jpegout)
 
     int size = processor->getBitmapDataSize(w, h, px, py, rw, rh);
     jpegout->resize(size);
-    if(size <= 0) return false;
+    if(size <= 0)
+    {
+        failures++;
+        return false;
+    }
 
-    return processor->getBitmapData((char *)jpegout->data(), jpegout->size());
+    if (!processor->getBitmapData((char *)jpegout->data(), jpegout->size()))
+    {
+        failures++;
+        return false;
+    }
+
+    failures = 0;
+    return true;
 }
 
 void GfxProviderExternal::freebitmap()
 {
 	processor->freeBitmap();
+
+    // a processor that keeps accepting images and then failing on them is
+    // presumed wedged (leaked or corrupted state in the app's implementation):
+    // swap in a fresh instance between images, if the app can mint one
+    if (failures >= MAXFAILURES)
+    {
+        if (MegaGfxProcessor* fresh = processor->createProcessor())
+        {
+            LOG_warn << "External gfx processor failed " << failures << " images in a row, replacing it";
+            if (ownprocessor)
+            {
+                delete processor;
+            }
+            processor = fresh;
+            ownprocessor = true;
+        }
+        failures = 0;
+    }
 }
 
 const char *GfxProviderExternal::supportedformats()
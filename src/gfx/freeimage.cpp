@@ -38,6 +38,14 @@ typedef const char freeimage_filename_char_t;
 #define OLD_FREEIMAGE
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GFX_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define GFX_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
 
 #ifdef HAVE_FFMPEG
 extern "C" {
@@ -527,9 +535,9 @@ bool GfxProviderFreeImage::readbitmapPdf(FileSystemAccess* fa, const LocalPath&
         workingDir = LocalPath::fromPlatformEncodedAbsolute(tmpPath.c_str());
     }
 
-    unique_ptr<char[]> data = PdfiumReader::readBitmapFromPdf(w, h, orientation, imagePath, fa, workingDir);
+    unique_ptr<char[]> data = PdfiumReader::readBitmapFromPdf(w, h, orientation, imagePath, fa, workingDir, renderbudgetms, &lastrenderpartial);
 #else
-    unique_ptr<char[]> data = PdfiumReader::readBitmapFromPdf(w, h, orientation, imagePath, fa);
+    unique_ptr<char[]> data = PdfiumReader::readBitmapFromPdf(w, h, orientation, imagePath, fa, renderbudgetms, &lastrenderpartial);
 #endif
 
     if (!data || !w || !h)
@@ -580,6 +588,7 @@ const char *GfxProviderFreeImage::supportedvideoformats()
 
 bool GfxProviderFreeImage::readbitmap(FileSystemAccess* fa, const LocalPath& localname, int size)
 {
+    lastrenderpartial = false;
 
     bool bitmapLoaded = false;
     string extension;
@@ -623,6 +632,98 @@ bool GfxProviderFreeImage::readbitmap(FileSystemAccess* fa, const LocalPath& loc
     return true;
 }
 
+bool GfxProviderFreeImage::readbitmapmem(const byte* data, size_t len)
+{
+    lastrenderpartial = false;
+
+    FIMEMORY* hmem = FreeImage_OpenMemory((BYTE*)data, (DWORD)len);
+    if (!hmem)
+    {
+        return false;
+    }
+
+    FREE_IMAGE_FORMAT fif = FreeImage_GetFileTypeFromMemory(hmem, 0);
+    if (fif != FIF_UNKNOWN)
+    {
+        dib = FreeImage_LoadFromMemory(fif, hmem,
+                                       (fif == FIF_JPEG) ? JPEG_EXIFROTATE | JPEG_FAST : 0);
+    }
+    FreeImage_CloseMemory(hmem);
+
+    if (!dib)
+    {
+        return false;
+    }
+
+    w = static_cast<int>(FreeImage_GetWidth(dib));
+    h = static_cast<int>(FreeImage_GetHeight(dib));
+
+    return w > 0 && h > 0;
+}
+
+#if defined(GFX_USE_SSE2) || defined(GFX_USE_NEON)
+namespace {
+
+// rounded byte-wise average of two equal-length rows
+void averageRowBytes(const BYTE* a, const BYTE* b, BYTE* dst, size_t n)
+{
+    size_t i = 0;
+#ifdef GFX_USE_SSE2
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+    }
+#else
+    for (; i + 16 <= n; i += 16)
+    {
+        vst1q_u8(dst + i, vrhaddq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] = static_cast<BYTE>((a[i] + b[i] + 1) >> 1);
+    }
+}
+
+// halve a 24 bpp bitmap in both dimensions by averaging each 2x2 pixel block
+FIBITMAP* downscaleByHalf24(FIBITMAP* dib, int w, int h)
+{
+    int dw = w / 2;
+    int dh = h / 2;
+    FIBITMAP* out = FreeImage_Allocate(dw, dh, 24);
+    if (!out)
+    {
+        return NULL;
+    }
+
+    std::vector<BYTE> merged(static_cast<size_t>(w) * 3);
+    std::vector<BYTE> averaged(static_cast<size_t>(w) * 3);
+
+    for (int y = 0; y < dh; y++)
+    {
+        const BYTE* r0 = FreeImage_GetScanLine(dib, 2 * y);
+        const BYTE* r1 = FreeImage_GetScanLine(dib, 2 * y + 1);
+        BYTE* d = FreeImage_GetScanLine(out, y);
+
+        // vertical, then horizontal: both are plain byte averages, so the
+        // BGR channel layout never needs deinterleaving
+        averageRowBytes(r0, r1, merged.data(), static_cast<size_t>(w) * 3);
+        averageRowBytes(merged.data(), merged.data() + 3, averaged.data(), static_cast<size_t>(w - 1) * 3);
+
+        for (int x = 0; x < dw; x++)
+        {
+            memcpy(d + x * 3, averaged.data() + x * 6, 3);
+        }
+    }
+
+    return out;
+}
+
+} // anonymous namespace
+#endif
+
 bool GfxProviderFreeImage::resizebitmap(int rw, int rh, string* jpegout)
 {
     FIBITMAP* tdib;
@@ -633,12 +734,36 @@ bool GfxProviderFreeImage::resizebitmap(int rw, int rh, string* jpegout)
 
     if (dib == NULL) return false;
 
+    int srcw = w, srch = h;
+
     transform(w, h, rw, rh, px, py);
 
     if (!w || !h) return false;
 
     jpegout->clear();
 
+#if defined(GFX_USE_SSE2) || defined(GFX_USE_NEON)
+    // box-prefilter big downscales: averaging 2x2 blocks vectorizes, and
+    // every pass quarters the pixels FreeImage's scalar rescale below has
+    // left to touch. Stop while still at least twice the target size so the
+    // final bilinear pass keeps its quality
+    if (FreeImage_GetImageType(dib) == FIT_BITMAP && FreeImage_GetBPP(dib) == 24)
+    {
+        while (srcw >= 2 * w && srch >= 2 * h)
+        {
+            if (!(tdib = downscaleByHalf24(dib, srcw, srch)))
+            {
+                break;
+            }
+
+            FreeImage_Unload(dib);
+            dib = tdib;
+            srcw /= 2;
+            srch /= 2;
+        }
+    }
+#endif
+
     if ((tdib = FreeImage_Rescale(dib, w, h, FILTER_BILINEAR)))
     {
         FreeImage_Unload(dib);
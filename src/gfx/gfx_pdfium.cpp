@@ -22,11 +22,26 @@
 #include "mega/gfx/gfx_pdfium.h"
 
 #ifdef HAVE_PDFIUM
+#include <fpdf_progressive.h>
+
+#include <chrono>
 
 #define MAX_PDF_MEM_SIZE 1024*1024*100
 
 namespace mega {
 
+namespace {
+
+// pause callback for progressive rendering: pdfium polls this between page
+// objects, so a render deadline is honoured without banding the page ourselves
+FPDF_BOOL renderDeadlinePassed(IFSDK_PAUSE* pause)
+{
+    return std::chrono::steady_clock::now()
+            >= *static_cast<const std::chrono::steady_clock::time_point*>(pause->user);
+}
+
+} // anonymous namespace
+
 std::mutex PdfiumReader::pdfMutex;
 unsigned PdfiumReader::initialized = 0;
 
@@ -56,9 +71,9 @@ void PdfiumReader::destroy()
 }
 
 #ifdef _WIN32
-std::unique_ptr<char[]> PdfiumReader::readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa, const LocalPath &workingDirFolder)
+std::unique_ptr<char[]> PdfiumReader::readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa, const LocalPath &workingDirFolder, unsigned budgetms, bool* partialrender)
 #else
-std::unique_ptr<char[]> PdfiumReader::readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa)
+std::unique_ptr<char[]> PdfiumReader::readBitmapFromPdf(int &w, int &h, int &orientation, const LocalPath &path, FileSystemAccess* fa, unsigned budgetms, bool* partialrender)
 #endif
 {
 
@@ -159,7 +174,36 @@ std::unique_ptr<char[]> PdfiumReader::readBitmapFromPdf(int &w, int &h, int &ori
                 }
 
                 FPDFBitmap_FillRect(bitmap, 0, 0, w, h, 0xFFFFFFFF);
-                FPDF_RenderPageBitmap(bitmap, page, 0, 0, w, h, 2, 0);
+
+                // render progressively under the wall-clock budget: a
+                // pathological page yields whatever was finished in time (on a
+                // white background) instead of wedging the worker for minutes
+                std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+                        + std::chrono::milliseconds(budgetms ? budgetms : 86400000u);   // no budget: a day away
+
+                IFSDK_PAUSE pause;
+                pause.version = 1;
+                pause.NeedToPauseNow = renderDeadlinePassed;
+                pause.user = &deadline;
+
+                bool partial = false;
+                int state = FPDF_RenderPageBitmap_Start(bitmap, page, 0, 0, w, h, 2, 0, &pause);
+                while (state == FPDF_RENDER_TOBECONTINUED)
+                {
+                    if (budgetms && std::chrono::steady_clock::now() >= deadline)
+                    {
+                        LOG_warn << "PDF render budget (" << budgetms << " ms) exhausted, keeping partial page for " << path;
+                        partial = true;
+                        break;
+                    }
+                    state = FPDF_RenderPage_Continue(page, &pause);
+                }
+                FPDF_RenderPage_Close(page);
+
+                if (partialrender)
+                {
+                    *partialrender = partial;
+                }
                 FPDFBitmap_Destroy(bitmap);
                 FPDF_ClosePage(page);
                 FPDF_CloseDocument(pdf_doc);
@@ -0,0 +1,248 @@
+/**
+ * @file turbojpeg.cpp
+ * @brief Accelerated JPEG decoding on top of the FreeImage graphics layer
+ *
+ * (c) 2014 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega.h"
+#include "mega/gfx/turbojpeg.h"
+
+#if defined(USE_FREEIMAGE) && defined(HAVE_TURBOJPEG)
+
+#include <turbojpeg.h>
+
+// JPEGs larger than this are left to the inherited decoder, which streams
+// from the file instead of needing the whole image in memory
+#define MAX_TURBOJPEG_MEM_SIZE (64 * 1048576)
+
+namespace mega {
+
+GfxProviderTurboJpeg::GfxProviderTurboJpeg()
+{
+    decoder = tjInitDecompress();
+    if (!decoder)
+    {
+        LOG_warn << "TurboJPEG decompressor unavailable, JPEG decoding stays on FreeImage";
+    }
+}
+
+GfxProviderTurboJpeg::~GfxProviderTurboJpeg()
+{
+    if (decoder)
+    {
+        tjDestroy(decoder);
+    }
+}
+
+// returns the EXIF orientation tag (1..8), or 1 if absent: TurboJPEG hands
+// back the pixels exactly as stored, so camera rotations must be applied to
+// the decoded bitmap afterwards
+static int exiforientation(const byte* data, size_t size)
+{
+    size_t pos = 2;
+    while (pos + 4 <= size && data[pos] == 0xff)
+    {
+        byte marker = data[pos + 1];
+        if (marker == 0xda)
+        {
+            break;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd9))
+        {
+            pos += 2;
+            continue;
+        }
+
+        size_t len = (size_t(data[pos + 2]) << 8) | data[pos + 3];
+        if (len < 2 || pos + 2 + len > size)
+        {
+            break;
+        }
+
+        if (marker == 0xe1 && len >= 20 && !memcmp(data + pos + 4, "Exif\0\0", 6))
+        {
+            const byte* t = data + pos + 10;
+            size_t tsize = len - 8;
+            bool be = t[0] == 'M' && t[1] == 'M';
+
+            if (be || (t[0] == 'I' && t[1] == 'I'))
+            {
+                auto r16 = [t, be](size_t o) { return be ? (t[o] << 8) | t[o + 1] : (t[o + 1] << 8) | t[o]; };
+
+                size_t ifd = be ? (size_t(r16(4)) << 16) | r16(6) : (size_t(r16(6)) << 16) | r16(4);
+                if (ifd && ifd + 2 <= tsize)
+                {
+                    unsigned entries = unsigned(r16(ifd));
+                    for (unsigned i = 0; i < entries && ifd + 2 + (i + 1) * 12 <= tsize; i++)
+                    {
+                        size_t e = ifd + 2 + i * 12;
+                        if (r16(e) == 0x0112)   // Orientation
+                        {
+                            int o = r16(e + 8);
+                            return o >= 1 && o <= 8 ? o : 1;
+                        }
+                    }
+                }
+            }
+            break;
+        }
+
+        pos += 2 + len;
+    }
+
+    return 1;
+}
+
+bool GfxProviderTurboJpeg::decodejpeg(const byte* data, size_t len, int size)
+{
+    int jw = 0, jh = 0, subsamp = 0, colorspace = 0;
+
+    if (!decoder
+            || tjDecompressHeader3(static_cast<tjhandle>(decoder), data, static_cast<unsigned long>(len),
+                                   &jw, &jh, &subsamp, &colorspace)
+            || jw <= 0 || jh <= 0)
+    {
+        return false;
+    }
+
+    // pick the largest IDCT-domain downscale that keeps the bigger dimension
+    // at or above the size hint (mirrors FreeImage's JPEG size flag)
+    tjscalingfactor chosen = { 1, 1 };
+    int numfactors = 0;
+    tjscalingfactor* factors = tjGetScalingFactors(&numfactors);
+
+    if (factors && size > 0)
+    {
+        for (int i = 0; i < numfactors; i++)
+        {
+            if (factors[i].num > factors[i].denom)
+            {
+                continue;   // never upscale
+            }
+
+            int scaled = TJSCALED(std::max(jw, jh), factors[i]);
+            if (scaled >= size && scaled < TJSCALED(std::max(jw, jh), chosen))
+            {
+                chosen = factors[i];
+            }
+        }
+    }
+
+    int dw = TJSCALED(jw, chosen);
+    int dh = TJSCALED(jh, chosen);
+
+    std::unique_ptr<BYTE[]> pixels(new (std::nothrow) BYTE[size_t(dw) * dh * 3]);
+    if (!pixels)
+    {
+        return false;
+    }
+
+    if (tjDecompress2(static_cast<tjhandle>(decoder), data, static_cast<unsigned long>(len),
+                      pixels.get(), dw, dw * 3, dh, TJPF_BGR, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE))
+    {
+        return false;
+    }
+
+    dib = FreeImage_ConvertFromRawBits(pixels.get(), dw, dh, dw * 3, 24,
+                                       FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, TRUE);
+    if (!dib)
+    {
+        return false;
+    }
+
+    auto replace = [this](FIBITMAP* r)
+    {
+        if (r)
+        {
+            FreeImage_Unload(dib);
+            dib = r;
+        }
+    };
+
+    switch (exiforientation(data, len))
+    {
+        case 2:
+            FreeImage_FlipHorizontal(dib);
+            break;
+        case 3:
+            replace(FreeImage_Rotate(dib, 180));
+            break;
+        case 4:
+            FreeImage_FlipVertical(dib);
+            break;
+        case 5:
+            replace(FreeImage_Rotate(dib, 270));
+            FreeImage_FlipHorizontal(dib);
+            break;
+        case 6:
+            replace(FreeImage_Rotate(dib, 270));
+            break;
+        case 7:
+            replace(FreeImage_Rotate(dib, 270));
+            FreeImage_FlipVertical(dib);
+            break;
+        case 8:
+            replace(FreeImage_Rotate(dib, 90));
+            break;
+    }
+
+    w = static_cast<int>(FreeImage_GetWidth(dib));
+    h = static_cast<int>(FreeImage_GetHeight(dib));
+
+    return w > 0 && h > 0;
+}
+
+bool GfxProviderTurboJpeg::readbitmap(FileSystemAccess* fa, const LocalPath& localname, int size)
+{
+    string ext;
+    if (decoder && fa->getextension(localname, ext) && (ext == ".jpg" || ext == ".jpeg"))
+    {
+        auto jpegFile = fa->newfileaccess();
+        if (jpegFile->fopen(localname, true, false, FSLogging::logOnError)
+                && jpegFile->size > 2 && jpegFile->size <= MAX_TURBOJPEG_MEM_SIZE)
+        {
+            std::unique_ptr<byte[]> buffer(new (std::nothrow) byte[size_t(jpegFile->size)]);
+            if (buffer
+                    && jpegFile->frawread(buffer.get(), static_cast<unsigned>(jpegFile->size), 0, true, FSLogging::logOnError)
+                    && decodejpeg(buffer.get(), size_t(jpegFile->size), size))
+            {
+                lastrenderpartial = false;
+                return true;
+            }
+        }
+        LOG_debug << "TurboJPEG decode unsuitable or failed, falling back to FreeImage for " << localname;
+    }
+
+    // not a JPEG, or this one defeated TurboJPEG: inherited path per image
+    return GfxProviderFreeImage::readbitmap(fa, localname, size);
+}
+
+bool GfxProviderTurboJpeg::readbitmapmem(const byte* data, size_t len)
+{
+    lastrenderpartial = false;
+
+    if (decoder && len > 2 && data[0] == 0xff && data[1] == 0xd8 && decodejpeg(data, len, 0))
+    {
+        return true;
+    }
+
+    return GfxProviderFreeImage::readbitmapmem(data, len);
+}
+
+} // namespace
+#endif
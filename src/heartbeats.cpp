@@ -273,6 +273,13 @@ void BackupMonitor::updateOrRegisterSync(UnifiedSync& us)
     assert(!ISUNDEF(backupId)); // syncs are registered before adding them
 #endif
 
+    if (us.mBackupInfo && us.mBackupInfo->matches(us, syncs.mDownloadsPaused, syncs.mUploadsPaused))
+    {
+        // nothing changed since the last sp we sent; skip the full
+        // BackupInfoSync construction this runs into every beat
+        return;
+    }
+
     auto currentInfo = BackupInfoSync(us, syncs.mDownloadsPaused, syncs.mUploadsPaused);
     if (!us.mBackupInfo || currentInfo != *us.mBackupInfo)
     {
@@ -284,6 +291,20 @@ void BackupMonitor::updateOrRegisterSync(UnifiedSync& us)
     us.mBackupInfo = ::mega::make_unique<BackupInfoSync>(currentInfo);
 }
 
+bool BackupInfoSync::matches(const UnifiedSync& us, bool pauseDown, bool pauseUp) const
+{
+    // compared in rough order of cost; deviceId and driveId are derived from
+    // the device and the configured drive, which cannot change while the
+    // fields below stay equal
+    return backupId == us.mConfig.mBackupId &&
+           subState == us.mConfig.mError &&
+           state == getSyncState(us, pauseDown, pauseUp) &&
+           type == getSyncType(us.mConfig) &&
+           nodeHandle == us.mConfig.mRemoteNode &&
+           backupName == us.mConfig.mName &&
+           localFolder == us.mConfig.getLocalPath();
+}
+
 bool BackupInfoSync::operator==(const BackupInfoSync& o) const
 {
     return  backupId == o.backupId &&
@@ -355,23 +376,18 @@ void BackupMonitor::beatBackupInfo(UnifiedSync& us)
 
         hbs->mSending = true;
 
-        auto backupId = us.mConfig.mBackupId;
-        auto status = hbs->sphbStatus();
-        auto pendingUps = static_cast<uint32_t>(reportCounts.mUploads.mPending);
-        auto pendingDowns = static_cast<uint32_t>(reportCounts.mUploads.mPending);
-        auto lastAction = hbs->lastAction();
-        auto lastItemUpdated = hbs->lastItemUpdated();
-
-        syncs.queueClient([=](MegaClient& mc, DBTableTransactionCommitter& committer)
-            {
-                mc.reqs.add(
-                    new CommandBackupPutHeartBeat(&mc, backupId, status,
-                        progress, pendingUps, pendingDowns,
-                        lastAction, lastItemUpdated,
-                        [hbs](Error){
-                            hbs->mSending = false;
-                        }));
-            });
+        // gathered here and queued once per beat, so 30 backups falling due
+        // together cost one client-thread hop instead of 30
+        PendingHeartBeat phb;
+        phb.backupId = us.mConfig.mBackupId;
+        phb.status = hbs->sphbStatus();
+        phb.progress = progress;
+        phb.pendingUps = static_cast<uint32_t>(reportCounts.mUploads.mPending);
+        phb.pendingDowns = static_cast<uint32_t>(reportCounts.mUploads.mPending);
+        phb.lastAction = hbs->lastAction();
+        phb.lastItemUpdated = hbs->lastItemUpdated();
+        phb.hbs = hbs;
+        mPendingBeats.push_back(std::move(phb));
 
         if (progress >= 100)
         {
@@ -393,6 +409,29 @@ void BackupMonitor::beat()
             beatBackupInfo(*us);
         }
     };
+
+    if (!mPendingBeats.empty())
+    {
+        // all heartbeats that fell due this beat share one trip to the
+        // client thread, and from there one cs batch
+        auto batch = std::make_shared<vector<PendingHeartBeat>>(std::move(mPendingBeats));
+        mPendingBeats.clear();
+
+        syncs.queueClient([batch](MegaClient& mc, DBTableTransactionCommitter& committer)
+            {
+                for (auto& b : *batch)
+                {
+                    auto hbs = b.hbs;
+                    mc.reqs.add(
+                        new CommandBackupPutHeartBeat(&mc, b.backupId, b.status,
+                            b.progress, b.pendingUps, b.pendingDowns,
+                            b.lastAction, b.lastItemUpdated,
+                            [hbs](Error){
+                                hbs->mSending = false;
+                            }));
+                }
+            });
+    }
 }
 
 #endif
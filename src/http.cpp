@@ -26,6 +26,8 @@
 #include "mega/base64.h"
 #include "mega/testhooks.h"
 
+#include <zlib.h>
+
 #if defined(WIN32)
 #include <winhttp.h>
 #endif
@@ -135,11 +137,19 @@ bool HttpIO::inetisback()
 
 void HttpIO::updatedownloadspeed(m_off_t size)
 {
+    if (size)
+    {
+        PerfCounters::get().add(PERF_BYTES_DOWNLOADED, size);
+    }
     downloadSpeed = downloadSpeedController.calculateSpeed(size);
 }
 
 void HttpIO::updateuploadspeed(m_off_t size)
 {
+    if (size)
+    {
+        PerfCounters::get().add(PERF_BYTES_UPLOADED, size);
+    }
     uploadSpeed = uploadSpeedController.calculateSpeed(size);
 }
 
@@ -388,6 +398,234 @@ m_off_t HttpIO::getmaxuploadspeed()
     return 0;
 }
 
+bool HttpIO::setmaxdownloadspeed(trafficclass_t tc, m_off_t bpslimit)
+{
+    trafficshaper[GET].setreserved(tc, bpslimit);
+    return true;
+}
+
+bool HttpIO::setmaxuploadspeed(trafficclass_t tc, m_off_t bpslimit)
+{
+    trafficshaper[PUT].setreserved(tc, bpslimit);
+    return true;
+}
+
+m_off_t HttpIO::getmaxdownloadspeed(trafficclass_t tc)
+{
+    return trafficshaper[GET].reserved(tc);
+}
+
+m_off_t HttpIO::getmaxuploadspeed(trafficclass_t tc)
+{
+    return trafficshaper[PUT].reserved(tc);
+}
+
+void HttpIO::setsockettuning(const SocketTuning& tuning)
+{
+    std::lock_guard<std::mutex> g(sockettuningmutex);
+    sockettuning = tuning;
+}
+
+HttpIO::SocketTuning HttpIO::getsockettuning()
+{
+    std::lock_guard<std::mutex> g(sockettuningmutex);
+    return sockettuning;
+}
+
+void TrafficShaper::setcap(m_off_t bps)
+{
+    mCap = bps;
+
+    // don't grant a stale burst accumulated while unlimited
+    for (int tc = TRAFFIC_CLASSES; tc--; )
+    {
+        mTokens[tc] = 0;
+    }
+
+    mShared = 0;
+    mLastRefill = Waiter::ds;
+}
+
+void TrafficShaper::setreserved(trafficclass_t tc, m_off_t bps)
+{
+    refill();
+    mReserved[tc] = bps;
+    if (mTokens[tc] > bps)
+    {
+        mTokens[tc] = bps;
+    }
+}
+
+bool TrafficShaper::active() const
+{
+    if (!mCap)
+    {
+        return false;
+    }
+
+    for (int tc = TRAFFIC_CLASSES; tc--; )
+    {
+        if (mReserved[tc])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TrafficShaper::refill()
+{
+    dstime delta = Waiter::ds - mLastRefill;
+    if (!delta)
+    {
+        return;
+    }
+
+    if (delta > 10)
+    {
+        delta = 10;
+    }
+
+    mLastRefill = Waiter::ds;
+
+    m_off_t sharedrate = mCap;
+    for (int tc = TRAFFIC_CLASSES; tc--; )
+    {
+        if (mReserved[tc])
+        {
+            mTokens[tc] += mReserved[tc] * delta / 10;
+            if (mTokens[tc] > mReserved[tc])
+            {
+                mTokens[tc] = mReserved[tc];
+            }
+            sharedrate -= mReserved[tc];
+        }
+    }
+
+    // whatever is not reserved feeds the borrowable pool (oversubscribed
+    // reservations leave nothing to borrow)
+    if (sharedrate > 0)
+    {
+        mShared += sharedrate * delta / 10;
+        if (mShared > mCap)
+        {
+            mShared = mCap;
+        }
+    }
+}
+
+m_off_t TrafficShaper::avail(trafficclass_t tc)
+{
+    refill();
+    return mTokens[tc] + mShared;
+}
+
+void TrafficShaper::consume(trafficclass_t tc, m_off_t len)
+{
+    refill();
+
+    m_off_t fromown = len < mTokens[tc] ? len : mTokens[tc];
+    mTokens[tc] -= fromown;
+
+    // overshoot beyond an avail() check is carried as debt against the
+    // shared pool and paid back by subsequent refills
+    mShared -= len - fromown;
+}
+
+int LatencyHistogram::bucketindex(uint64_t value)
+{
+    if (value < SUBBUCKETS)
+    {
+        return static_cast<int>(value);
+    }
+
+    int octave = 0;
+    uint64_t v = value;
+    while (v >= SUBBUCKETS * 2)
+    {
+        v >>= 1;
+        ++octave;
+    }
+
+    // v is now in [SUBBUCKETS, SUBBUCKETS * 2): the sub-bucket within the octave
+    int index = octave * SUBBUCKETS + static_cast<int>(v - SUBBUCKETS) + SUBBUCKETS;
+    return index < OCTAVES * SUBBUCKETS ? index : OCTAVES * SUBBUCKETS - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    ++mBuckets[bucketindex(value)];
+    ++mCount;
+    mSum += value;
+    if (value > mMax)
+    {
+        mMax = value;
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (int i = 0; i < OCTAVES * SUBBUCKETS; i++)
+    {
+        mBuckets[i] += other.mBuckets[i];
+    }
+    mCount += other.mCount;
+    mSum += other.mSum;
+    if (other.mMax > mMax)
+    {
+        mMax = other.mMax;
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    if (!mCount)
+    {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(mCount));
+    if (rank >= mCount)
+    {
+        rank = mCount - 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < OCTAVES * SUBBUCKETS; i++)
+    {
+        seen += mBuckets[i];
+        if (seen > rank)
+        {
+            // lower edge of bucket i
+            if (i < 2 * SUBBUCKETS)
+            {
+                return static_cast<uint64_t>(i);
+            }
+            int octave = i / SUBBUCKETS - 1;
+            int sub = i % SUBBUCKETS;
+            return (static_cast<uint64_t>(SUBBUCKETS) + static_cast<uint64_t>(sub)) << octave;
+        }
+    }
+    return mMax;
+}
+
+std::string LatencyHistogram::report() const
+{
+    if (!mCount)
+    {
+        return std::string();
+    }
+
+    ostringstream s;
+    s << "n=" << mCount
+      << " p50=" << percentile(50)
+      << " p90=" << percentile(90)
+      << " p99=" << percentile(99)
+      << " max=" << mMax;
+    return s.str();
+}
+
 void HttpReq::post(MegaClient* client, const char* data, unsigned len)
 {
     if (httpio)
@@ -478,6 +716,7 @@ HttpReq::HttpReq(bool b)
     protect = false;
     minspeed = false;
     mChunked = false;
+    outgzipped = false;
 
     init();
 }
@@ -508,6 +747,49 @@ void HttpReq::init()
     mRedirectURL.clear();
 }
 
+// gzip the request body in place (for Content-Encoding: gzip)
+void HttpReq::gzipRequestBody()
+{
+    assert(!outgzipped);
+
+    z_stream z{};
+    // windowBits + 16 selects the gzip wrapper
+    if (deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return;
+    }
+
+    string compressed;
+    compressed.resize(deflateBound(&z, static_cast<uLong>(out->size())));
+
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(out->data()));
+    z.avail_in = static_cast<uInt>(out->size());
+    z.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    z.avail_out = static_cast<uInt>(compressed.size());
+
+    int result = deflate(&z, Z_FINISH);
+    size_t compressedSize = compressed.size() - z.avail_out;
+    deflateEnd(&z);
+
+    if (result != Z_STREAM_END || compressedSize >= out->size())
+    {
+        // incompressible (or tiny): send it as it is
+        return;
+    }
+
+    compressed.resize(compressedSize);
+    LOG_debug << logname << "Compressed request body from " << out->size()
+              << " to " << compressedSize << " bytes";
+
+    // take the compressed body into our own buffer: 'out' may be aliasing an
+    // externally owned string (eg. the request dispatcher's idempotence
+    // cache), which must keep the uncompressed JSON for retries
+    outbuf = std::move(compressed);
+    out = &outbuf;
+    outgzipped = true;
+}
+
 const char* HttpReq::getMethodString()
 {
     switch(method)
@@ -561,12 +843,20 @@ void HttpReq::put(void* data, unsigned len, bool purge)
 
 
 HttpReq::http_buf_t::http_buf_t(byte* b, size_t s, size_t e)
-    : start(s), end(e), buf(b)
+    : start(s), end(e), buf(b), accounted(b ? e : 0)
 {
+    if (accounted)
+    {
+        MemoryAccounting::get().add(MEM_TRANSFERBUFFERS, static_cast<int64_t>(accounted));
+    }
 }
 
 HttpReq::http_buf_t::~http_buf_t()
 {
+    if (accounted)
+    {
+        MemoryAccounting::get().sub(MEM_TRANSFERBUFFERS, static_cast<int64_t>(accounted));
+    }
     delete[] buf;
 }
 
@@ -575,6 +865,7 @@ void HttpReq::http_buf_t::swap(http_buf_t& other)
     byte* tb = buf; buf = other.buf; other.buf = tb;
     size_t ts = start; start = other.start; other.start = ts;
     size_t te = end; end = other.end; other.end = te;
+    size_t ta = accounted; accounted = other.accounted; other.accounted = ta;
 }
 
 bool HttpReq::http_buf_t::isNull() const
@@ -624,11 +915,23 @@ void HttpReq::purge(size_t numbytes)
 {
     inpurge += numbytes;
 
-    if (mChunked)
+    // Erasing the front of 'in' for every consumed chunk would memmove the
+    // unconsumed tail each time, which hurts on multi-hundred-MB chunked
+    // fetchnodes responses. The purge is deferred until it is worth paying for
+    // (incoming data also applies it on append, see HttpReq::put). Code that
+    // accesses HttpReq::in directly instead of data()/size() must call
+    // flushinpurge() first.
+    static const size_t PURGE_THRESHOLD = 1048576;
+    if (mChunked && inpurge >= PURGE_THRESHOLD)
+    {
+        flushinpurge();
+    }
+}
+
+void HttpReq::flushinpurge()
+{
+    if (inpurge)
     {
-        // Immediate purge because there are several places
-        // in the code directly accesing HttpReq::in instead
-        // of HttpReq::data() and HttpReq::size()
         in.erase(0, inpurge);
         inpurge = 0;
     }
@@ -793,7 +1096,14 @@ bool EncryptByChunks::encrypt(m_off_t pos, m_off_t npos, string& urlSuffix)
 
         // The chunk is fully encrypted but finished==false for now,
         // we only set finished after confirmation of the chunk uploading.
-        macs->ctr_encrypt(startpos, key, buf, unsigned(chunksize), startpos, ctriv, false);
+        if (const byte* src = nextsource(unsigned(chunksize)))
+        {
+            macs->ctr_encrypt(startpos, key, src, buf, unsigned(chunksize), startpos, ctriv, false);
+        }
+        else
+        {
+            macs->ctr_encrypt(startpos, key, buf, unsigned(chunksize), startpos, ctriv, false);
+        }
 
         LOG_debug << "Encrypted chunk: " << startpos << " - " << endpos << "   Size: " << chunksize;
 
@@ -827,18 +1137,43 @@ byte* EncryptBufferByChunks::nextbuffer(unsigned bufsize)
     return pos;
 }
 
+EncryptMappedByChunks::EncryptMappedByChunks(const byte* src, byte* dst, SymmCipher* k, chunkmac_map* m, uint64_t iv)
+    : EncryptBufferByChunks(dst, k, m, iv)
+    , srcstart(src)
+{
+}
+
+const byte* EncryptMappedByChunks::nextsource(unsigned bufsize)
+{
+    const byte* pos = srcstart;
+    srcstart += bufsize;
+    return pos;
+}
+
 // prepare chunk for uploading: mac and encrypt
 void HttpReqUL::prepare(const char* tempurl, SymmCipher* key,
                         uint64_t ctriv, m_off_t pos,
                         m_off_t npos)
 {
-    EncryptBufferByChunks eb((byte*)out->data(), key, &mChunkmacs, ctriv);
-
     string urlSuffix;
-    eb.encrypt(pos, npos, urlSuffix);
+    size = (unsigned)(npos - pos);
+
+    if (mMappedSource)
+    {
+        // zero-copy source: encrypt straight from the mapped file into the
+        // (reused) output buffer, with no intermediate read
+        out->resize(size + ((-(int)size) & (SymmCipher::BLOCKSIZE - 1)));
+        EncryptMappedByChunks eb(mMappedSource.get(), (byte*)out->data(), key, &mChunkmacs, ctriv);
+        eb.encrypt(pos, npos, urlSuffix);
+        mMappedSource.reset();  // release the mapping as soon as the ciphertext is ready
+    }
+    else
+    {
+        EncryptBufferByChunks eb((byte*)out->data(), key, &mChunkmacs, ctriv);
+        eb.encrypt(pos, npos, urlSuffix);
+    }
 
     // unpad for POSTing
-    size = (unsigned)(npos - pos);
     out->resize(size);
 
     setreq((tempurl + urlSuffix).c_str(), REQ_BINARY);
@@ -27,18 +27,132 @@
 #include "mega/logging.h"
 #include "mega/mega_utf8proc.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define JSON_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace mega {
 
 bool g_jsonLoggingOn = false;
 #define JSON_verbose if (g_jsonLoggingOn) LOG_verbose
 
+const char* JSON::strscan(const char* p)
+{
+#ifdef JSON_USE_SSE2
+    // scalar until 16-byte alignment, so the aligned loads below can't touch
+    // a page the string doesn't
+    while (reinterpret_cast<uintptr_t>(p) & 15)
+    {
+        if (!*p || *p == '"' || *p == '\\')
+        {
+            return p;
+        }
+        p++;
+    }
+
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i zero = _mm_setzero_si128();
+
+    for (;;)
+    {
+        __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, zero),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                 _mm_cmpeq_epi8(chunk, backslash)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask)
+        {
+#ifdef _MSC_VER
+            unsigned long offset;
+            _BitScanForward(&offset, static_cast<unsigned long>(mask));
+            return p + offset;
+#else
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+        }
+        p += 16;
+    }
+#else
+#ifdef JSON_USE_NEON
+    while (reinterpret_cast<uintptr_t>(p) & 15)
+    {
+        if (!*p || *p == '"' || *p == '\\')
+        {
+            return p;
+        }
+        p++;
+    }
+
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t zero = vdupq_n_u8(0);
+
+    for (;;)
+    {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint8x16_t hits = vorrq_u8(vceqq_u8(chunk, zero),
+                                   vorrq_u8(vceqq_u8(chunk, quote),
+                                            vceqq_u8(chunk, backslash)));
+#if defined(__aarch64__) || defined(_M_ARM64)
+        if (!vmaxvq_u8(hits))
+        {
+            p += 16;
+            continue;
+        }
+#else
+        uint8x8_t narrowed = vorr_u8(vget_low_u8(hits), vget_high_u8(hits));
+        if (!(vget_lane_u32(vreinterpret_u32_u8(narrowed), 0)
+              | vget_lane_u32(vreinterpret_u32_u8(narrowed), 1)))
+        {
+            p += 16;
+            continue;
+        }
+#endif
+        break;   // a delimiter is within this block; pinpoint it below
+    }
+#endif
+
+    for (;;)
+    {
+        if (!*p || *p == '"' || *p == '\\')
+        {
+            return p;
+        }
+        p++;
+    }
+#endif
+}
+
 // store array or object in string s
 // reposition after object
 bool JSON::storeobject(string* s)
+{
+    std::string_view v;
+
+    if (!storeobject(v))
+    {
+        return false;
+    }
+
+    if (s)
+    {
+        s->assign(v.data(), v.size());
+    }
+
+    return true;
+}
+
+// store a non-owning view of the array, object or value in v
+// reposition after object
+bool JSON::storeobject(std::string_view& v)
 {
     int openobject[2] = { 0 };
     const char* ptr;
-    bool escaped = false;
 
     while (*(const signed char*)pos > 0 && *pos <= ' ')
     {
@@ -75,13 +189,18 @@ bool JSON::storeobject(string* s)
         {
             ptr++;
 
-            while (*ptr && (escaped || *ptr != '"'))
+            for (;;)
             {
-                escaped = *ptr == '\\' && !escaped;
-                ptr++;
+                ptr = strscan(ptr);
+                if (*ptr == '\\' && ptr[1])
+                {
+                    ptr += 2;   // skip the escaped character
+                    continue;
+                }
+                break;
             }
 
-            if (!*ptr)
+            if (*ptr != '"')
             {
                 LOG_err << "Parse error (\")";
                 return false;
@@ -108,16 +227,13 @@ bool JSON::storeobject(string* s)
 
         if (!openobject[0] && !openobject[1])
         {
-            if (s)
+            if (*pos == '"')
             {
-                if (*pos == '"')
-                {
-                    s->assign(pos + 1, ptr - pos - 2);
-                }
-                else
-                {
-                    s->assign(pos, ptr - pos);
-                }
+                v = std::string_view(pos + 1, static_cast<size_t>(ptr - pos - 2));
+            }
+            else
+            {
+                v = std::string_view(pos, static_cast<size_t>(ptr - pos));
             }
 
             pos = ptr;
@@ -245,8 +361,15 @@ std::string JSON::getname()
 
 std::string JSON::getnameWithoutAdvance() const
 {
-    const char* ptr = pos;
     string name;
+    getnameWithoutAdvance(name);
+    return name;
+}
+
+void JSON::getnameWithoutAdvance(string& name) const
+{
+    const char* ptr = pos;
+    name.clear();
 
     if (*ptr == ',' || *ptr == ':')
     {
@@ -255,14 +378,13 @@ std::string JSON::getnameWithoutAdvance() const
 
     if (*ptr++ == '"')
     {
+        const char* start = ptr;
         while (*ptr && *ptr != '"')
         {
-            name += *ptr;
             ptr++;
         }
+        name.assign(start, static_cast<size_t>(ptr - start));
     }
-
-    return name;
 }
 
 // pos points to [,]"name":...
@@ -501,6 +623,20 @@ const char* JSON::getvalue()
     return r;
 }
 
+// return a view of the JSON payload data, length included
+std::string_view JSON::getvalueview()
+{
+    if (*pos == ':' || *pos == ',')
+    {
+        pos++;
+    }
+
+    std::string_view v;
+    storeobject(v);
+
+    return v;
+}
+
 std::uint64_t JSON::getfsfp()
 {
     return gethandle(sizeof(std::uint64_t));
@@ -758,6 +894,19 @@ void JSON::copystring(string* s, const char* p)
     }
 }
 
+// copy a view produced by getvalueview()/storeobject() (no unescaping)
+void JSON::copystring(string* s, std::string_view v)
+{
+    if (v.data())
+    {
+        s->assign(v.data(), v.size());
+    }
+    else
+    {
+        s->clear();
+    }
+}
+
 string JSON::stripWhitespace(const string& text)
 {
     return stripWhitespace(text.c_str());
@@ -791,11 +940,23 @@ string JSON::stripWhitespace(const char* text)
     return result;
 }
 
+std::atomic<size_t> JSONWriter::mSizeHint{256};
+
 JSONWriter::JSONWriter()
   : mJson()
   , mLevels()
   , mLevel(-1)
 {
+    mJson.reserve(mSizeHint.load(std::memory_order_relaxed));
+}
+
+void JSONWriter::noteFinalSize(size_t n)
+{
+    // exponentially weighted average, capped so that one huge putnodes
+    // batch does not inflate every subsequent writer
+    n = std::min<size_t>(n, 16384);
+    size_t hint = mSizeHint.load(std::memory_order_relaxed);
+    mSizeHint.store(hint - hint / 8 + n / 8, std::memory_order_relaxed);
 }
 
 void JSONWriter::cmd(const char* cmd)
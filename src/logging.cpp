@@ -24,6 +24,7 @@
 
 #include "mega/logging.h"
 
+#include <chrono>
 #include <ctime>
 
 namespace mega {
@@ -191,4 +192,178 @@ void ExclusiveLogger::log(const char *time, int loglevel, const char *source, co
     );
 }
 
+
+AsyncRingLogger::AsyncRingLogger(Logger* sink, size_t capacity)
+    : mSink(sink)
+{
+    size_t slots = 2;
+    while (slots < capacity)
+    {
+        slots <<= 1;
+    }
+    mSlotMask = slots - 1;
+
+    mSlots.reset(new Slot[slots]);
+    for (size_t i = 0; i < slots; ++i)
+    {
+        // slot i is free to receive the message with ticket i
+        mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+    }
+
+    mDrainThread = std::thread([this]() { drainLoop(); });
+}
+
+AsyncRingLogger::~AsyncRingLogger()
+{
+    mExit.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> g(mWakeMutex);
+        mWakeCV.notify_one();
+    }
+    mDrainThread.join();
+}
+
+bool AsyncRingLogger::enqueue(const char* time, int loglevel, const char* source, std::string&& message)
+{
+    uint64_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot& slot = mSlots[pos & mSlotMask];
+        uint64_t seq = slot.mSequence.load(std::memory_order_acquire);
+        if (seq == pos)
+        {
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.mLevel = loglevel;
+                slot.mTime = time ? time : "";
+                slot.mSource = source ? source : "";
+                slot.mMessage = std::move(message);
+                slot.mSequence.store(pos + 1, std::memory_order_release);
+
+                // only take the wake mutex if the drain thread announced it is asleep;
+                // a missed race here is covered by its periodic timed wakeup
+                if (mDrainSleeping.load(std::memory_order_relaxed))
+                {
+                    std::lock_guard<std::mutex> g(mWakeMutex);
+                    mWakeCV.notify_one();
+                }
+                return true;
+            }
+        }
+        else if (seq < pos)
+        {
+            // the consumer has not freed this slot yet - the ring is full.
+            // Dropping is deliberate: a logger that blocks the producing
+            // thread would reintroduce the tax this class removes
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncRingLogger::log(const char *time, int loglevel, const char *source, const char *message
+#ifdef ENABLE_LOG_PERFORMANCE
+    , const char **directMessages, size_t *directMessagesSizes, unsigned numberMessages
+#endif
+)
+{
+    std::string text = message ? message : "";
+
+#ifdef ENABLE_LOG_PERFORMANCE
+    // direct message pointers are only valid for the duration of this call,
+    // so they are folded into the copied text here
+    for (unsigned i = 0; i < numberMessages; ++i)
+    {
+        text.append(directMessages[i], directMessagesSizes[i]);
+    }
+#endif
+
+    enqueue(time, loglevel, source, std::move(text));
+}
+
+void AsyncRingLogger::flush()
+{
+    while (mDequeuePos.load(std::memory_order_acquire) < mEnqueuePos.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void AsyncRingLogger::drainLoop()
+{
+    // prevent deadlock cycles if the sink itself logs
+    SimpleLogger::mThreadLocalLoggingDisabled = true;
+
+    for (;;)
+    {
+        uint64_t pos = mDequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = mSlots[pos & mSlotMask];
+        uint64_t seq = slot.mSequence.load(std::memory_order_acquire);
+        if (seq == pos + 1)
+        {
+            int level = slot.mLevel;
+            std::string time = std::move(slot.mTime);
+            std::string source = std::move(slot.mSource);
+            std::string message = std::move(slot.mMessage);
+
+            // free the slot for the producer mSlotMask + 1 tickets ahead
+            slot.mSequence.store(pos + mSlotMask + 1, std::memory_order_release);
+
+            if (mSink)
+            {
+                mSink->log(time.empty() ? nullptr : time.c_str(), level,
+                           source.empty() ? nullptr : source.c_str(), message.c_str()
+#ifdef ENABLE_LOG_PERFORMANCE
+                           , nullptr, nullptr, 0
+#endif
+                );
+            }
+
+            // advanced only after the sink returns, so flush() really means delivered
+            mDequeuePos.store(pos + 1, std::memory_order_release);
+            continue;
+        }
+
+        // the ring is drained - account for anything lost while it was full
+        uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+        if (dropped != mDroppedReported)
+        {
+            if (mSink)
+            {
+                std::string warning = "AsyncRingLogger: dropped " + std::to_string(dropped - mDroppedReported) + " messages (ring full)";
+                mSink->log(nullptr, logWarning, nullptr, warning.c_str()
+#ifdef ENABLE_LOG_PERFORMANCE
+                           , nullptr, nullptr, 0
+#endif
+                );
+            }
+            mDroppedReported = dropped;
+        }
+
+        if (mExit.load(std::memory_order_acquire))
+        {
+            // recheck after the exit flag: the destructor only sets it once,
+            // so an empty ring here is final
+            if (slot.mSequence.load(std::memory_order_acquire) != pos + 1)
+            {
+                break;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(mWakeMutex);
+        mDrainSleeping.store(true, std::memory_order_relaxed);
+        if (slot.mSequence.load(std::memory_order_acquire) != pos + 1 && !mExit.load(std::memory_order_acquire))
+        {
+            // the timeout is a backstop for the unsynchronized mDrainSleeping probe
+            mWakeCV.wait_for(lk, std::chrono::milliseconds(100));
+        }
+        mDrainSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
 } // namespace
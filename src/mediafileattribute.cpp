@@ -737,6 +737,159 @@ bool MediaFileInfo::timeToRetryMediaPropertyExtraction(const std::string& fileat
     return false;
 }
 
+// byte range of container payload (sample data) that carries no codec metadata
+struct MediaPayloadRegion
+{
+    m_off_t start;
+    m_off_t end;
+};
+
+static uint32_t mediaProbeU32(const byte* b)
+{
+    return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | b[3];
+}
+
+// EBML variable-length integer at b (n bytes available); returns the value and
+// sets len, with the length marker kept (for IDs) or cleared (for sizes)
+static uint64_t mediaProbeVint(const byte* b, unsigned n, unsigned& len, bool keepmarker)
+{
+    len = 0;
+    if (!n || !b[0])
+    {
+        return 0;
+    }
+
+    unsigned l = 1;
+    while (!(b[0] & (0x80 >> (l - 1))))
+    {
+        l++;
+    }
+    if (l > n)
+    {
+        return 0;
+    }
+
+    uint64_t v = keepmarker ? b[0] : b[0] & (0xff >> l);
+    for (unsigned i = 1; i < l; i++)
+    {
+        v = (v << 8) | b[i];
+    }
+    len = l;
+    return v;
+}
+
+// Walk the top-level structure of the container and record the byte ranges of
+// pure payload (MP4/MOV 'mdat' and friends, Matroska/WebM Clusters) so the
+// metadata read loop below can hop over them instead of streaming through:
+// everything mediainfo needs lives in the header boxes ('moov', EBML header,
+// Tracks/Info) or is reached by an explicit parser seek. Best effort - an
+// unrecognized container just leaves the list empty.
+static void mediaProbePayloadRegions(FileAccess* fa, vector<MediaPayloadRegion>& regions)
+{
+    byte buf[16];
+    if (fa->size < (m_off_t)sizeof(buf) || !fa->frawread(buf, sizeof(buf), 0, true, FSLogging::logExceptFileNotFound))
+    {
+        return;
+    }
+
+    if (mediaProbeU32(buf) == 0x1a45dfa3)   // EBML: Matroska/WebM
+    {
+        // skip the EBML header, enter the Segment, then walk its children up
+        // to the first Cluster: all codec metadata (SeekHead/Info/Tracks)
+        // precedes the clusters, and anything behind them (Cues) is reached
+        // via Open_Buffer_Continue_GoTo_Get
+        m_off_t pos = 0;
+        bool insegment = false;
+
+        for (int guard = 64; guard-- && pos + 2 < fa->size; )
+        {
+            byte ebuf[24];
+            unsigned n = unsigned(std::min<m_off_t>(fa->size - pos, sizeof(ebuf)));
+            if (!fa->frawread(ebuf, n, pos, true, FSLogging::logOnError))
+            {
+                return;
+            }
+
+            unsigned idlen, sizelen;
+            uint64_t id = mediaProbeVint(ebuf, n, idlen, true);
+            uint64_t elementsize = mediaProbeVint(ebuf + idlen, n - idlen, sizelen, false);
+            if (!idlen || !sizelen)
+            {
+                return;
+            }
+
+            if (id == 0x18538067 && !insegment)   // Segment: descend
+            {
+                insegment = true;
+                pos += idlen + sizelen;
+                continue;
+            }
+
+            if (id == 0x1f43b675)   // Cluster: payload from here on
+            {
+                regions.push_back(MediaPayloadRegion{ pos + m_off_t(idlen + sizelen), fa->size });
+                return;
+            }
+
+            // unknown-size element (all value bits set): cannot walk past it
+            if (elementsize == (~0ull >> (64 - 7 * sizelen)))
+            {
+                return;
+            }
+
+            pos += idlen + sizelen + m_off_t(elementsize);
+        }
+        return;
+    }
+
+    uint32_t type = mediaProbeU32(buf + 4);
+    if (type != MAKENAMEID4('f', 't', 'y', 'p') && type != MAKENAMEID4('m', 'o', 'o', 'v')
+            && type != MAKENAMEID4('m', 'd', 'a', 't') && type != MAKENAMEID4('w', 'i', 'd', 'e')
+            && type != MAKENAMEID4('s', 'k', 'i', 'p') && type != MAKENAMEID4('f', 'r', 'e', 'e'))
+    {
+        return;
+    }
+
+    // ISO base media (MP4/MOV/3GP/HEIF): walk the top-level boxes and record
+    // the extents of those that only hold sample data, keeping each box
+    // header readable so the parser still sees the box before the hop
+    m_off_t pos = 0;
+    for (int guard = 64; guard-- && pos + 8 <= fa->size; )
+    {
+        if (!fa->frawread(buf, unsigned(std::min<m_off_t>(fa->size - pos, sizeof(buf))), pos, true, FSLogging::logOnError))
+        {
+            return;
+        }
+
+        m_off_t hdr = 8;
+        m_off_t boxsize = mediaProbeU32(buf);
+        type = mediaProbeU32(buf + 4);
+
+        if (boxsize == 1 && pos + 16 <= fa->size)   // 64-bit largesize
+        {
+            boxsize = (m_off_t(mediaProbeU32(buf + 8)) << 32) | mediaProbeU32(buf + 12);
+            hdr = 16;
+        }
+        else if (boxsize == 0)   // box extends to end of file
+        {
+            boxsize = fa->size - pos;
+        }
+
+        if (boxsize < hdr || boxsize > fa->size - pos)
+        {
+            return;
+        }
+
+        if (type == MAKENAMEID4('m', 'd', 'a', 't') || type == MAKENAMEID4('f', 'r', 'e', 'e')
+                || type == MAKENAMEID4('s', 'k', 'i', 'p') || type == MAKENAMEID4('w', 'i', 'd', 'e'))
+        {
+            regions.push_back(MediaPayloadRegion{ pos + hdr, pos + boxsize });
+        }
+
+        pos += boxsize;
+    }
+}
+
 bool mediaInfoOpenFileWithLimits(MediaInfoLib::MediaInfo& mi, LocalPath& filename, FileAccess* fa, unsigned maxBytesToRead, unsigned maxSeconds)
 {
     if (!fa->fopen(filename, true, false, FSLogging::logOnError))
@@ -747,6 +900,13 @@ bool mediaInfoOpenFileWithLimits(MediaInfoLib::MediaInfo& mi, LocalPath& filenam
 
     m_off_t filesize = fa->size;
     size_t totalBytesRead = 0;
+
+    // map the payload extents up front so the sequential scan below spends
+    // the byte budget on header regions only, instead of wading through
+    // gigabytes of sample data in large videos
+    vector<MediaPayloadRegion> payload;
+    mediaProbePayloadRegions(fa, payload);
+
     mi.Open_Buffer_Init(filesize, 0);
     m_off_t readpos = 0;
     m_time_t startTime = 0;
@@ -757,7 +917,28 @@ bool mediaInfoOpenFileWithLimits(MediaInfoLib::MediaInfo& mi, LocalPath& filenam
     {
         byte buf[30 * 1024];
 
+        // hop over payload reached sequentially (explicit parser seeks below
+        // may still land inside a region, eg Cues behind the first Cluster)
+        for (const MediaPayloadRegion& region : payload)
+        {
+            if (readpos == region.start && region.end > readpos)
+            {
+                readpos = region.end;
+                mi.Open_Buffer_Init(filesize, readpos);
+            }
+        }
+
         unsigned n = unsigned(std::min<m_off_t>(filesize - readpos, sizeof(buf)));
+
+        // never let a chunk swallow the start of a payload region, so the hop
+        // above triggers right after its header is delivered
+        for (const MediaPayloadRegion& region : payload)
+        {
+            if (readpos < region.start && readpos + n > region.start)
+            {
+                n = unsigned(region.start - readpos);
+            }
+        }
         if (n == 0)
         {
             break;
@@ -41,6 +41,8 @@
  */
 
 
+#include <string.h>
+
 #include "mega/mega_utf8proc.h"
 #include "mega_utf8proc_data.c"
 
@@ -690,6 +692,21 @@ UTF8PROC_DLLEXPORT utf8proc_ssize_t utf8proc_reencode(utf8proc_int32_t *buffer,
   }
 }
 
+/* Length of the leading ASCII run of str, scanned eight bytes at a time. */
+static utf8proc_ssize_t ascii_run_length(
+  const utf8proc_uint8_t *str, utf8proc_ssize_t len
+) {
+  utf8proc_ssize_t i = 0;
+  unsigned long long word;
+  for (; i + 8 <= len; i += 8) {
+    memcpy(&word, str + i, sizeof word);
+    if (word & 0x8080808080808080ULL) break;
+  }
+  for (; i < len; i++)
+    if (str[i] >= 0x80) break;
+  return i;
+}
+
 UTF8PROC_DLLEXPORT utf8proc_ssize_t utf8proc_map(
   const utf8proc_uint8_t *str, utf8proc_ssize_t strlen, utf8proc_uint8_t **dstptr, utf8proc_option_t options
 ) {
@@ -703,6 +720,34 @@ UTF8PROC_DLLEXPORT utf8proc_ssize_t utf8proc_map_custom(
   utf8proc_int32_t *buffer;
   utf8proc_ssize_t result;
   *dstptr = NULL;
+  /* Fast path: a pure-ASCII string -- the overwhelmingly common case for
+   * file names -- is a fixed point of decomposition, composition and the
+   * stability check, so it can be copied straight through without ever
+   * entering the two-pass decompose/reencode machinery.  Options that can
+   * rewrite ASCII itself (case folding, lumping, control character and
+   * newline handling, grapheme boundaries) still take the full path. */
+  if (!custom_func && !(options & (UTF8PROC_CASEFOLD | UTF8PROC_LUMP |
+      UTF8PROC_STRIPCC | UTF8PROC_NLF2LS | UTF8PROC_NLF2PS |
+      UTF8PROC_CHARBOUND))) {
+    utf8proc_ssize_t asciilen = -1;
+    if (options & UTF8PROC_NULLTERM) {
+      /* the length isn't known up front, so scan bytewise to the
+       * terminator instead of by words */
+      const utf8proc_uint8_t *s = str;
+      while (*s && *s < 0x80) s++;
+      if (!*s) asciilen = s - str;
+    } else if (ascii_run_length(str, strlen) == strlen) {
+      asciilen = strlen;
+    }
+    if (asciilen >= 0) {
+      utf8proc_uint8_t *copy = (utf8proc_uint8_t *) malloc((size_t)asciilen + 1);
+      if (!copy) return UTF8PROC_ERROR_NOMEM;
+      memcpy(copy, str, (size_t)asciilen);
+      copy[asciilen] = 0;
+      *dstptr = copy;
+      return asciilen;
+    }
+  }
   result = utf8proc_decompose_custom(str, strlen, NULL, 0, options, custom_func, custom_data);
   if (result < 0) return result;
   buffer = (utf8proc_int32_t *) malloc(result * sizeof(utf8proc_int32_t) + 1);
@@ -1283,6 +1283,11 @@ long long MegaTransfer::getMeanSpeed() const
     return 0;
 }
 
+const char* MegaTransfer::getStats() const
+{
+    return NULL;
+}
+
 long long MegaTransfer::getDeltaSize() const
 {
 	return 0;
@@ -1643,6 +1648,26 @@ MegaRequestListener::~MegaRequestListener()
 { }
 
 
+MegaOneShotRequestListener* MegaOneShotRequestListener::create(std::function<void(MegaApi*, MegaRequest*, MegaError*)> completion)
+{
+    return new MegaOneShotRequestListener(std::move(completion));
+}
+
+MegaOneShotRequestListener::MegaOneShotRequestListener(std::function<void(MegaApi*, MegaRequest*, MegaError*)> completion)
+    : mCompletion(std::move(completion))
+{
+}
+
+void MegaOneShotRequestListener::onRequestFinish(MegaApi* api, MegaRequest* request, MegaError* e)
+{
+    if (mCompletion)
+    {
+        mCompletion(api, request, e);
+    }
+
+    delete this;
+}
+
 SynchronousRequestListener::SynchronousRequestListener()
 {
     listener = NULL;
@@ -2653,6 +2678,11 @@ void MegaApi::cancelGetPreview(MegaNode* node, MegaRequestListener *listener)
 	pImpl->cancelGetPreview(node, listener);
 }
 
+void MegaApi::setThumbnailPriority(MegaHandle handle, bool priority)
+{
+    pImpl->setThumbnailPriority(handle, priority);
+}
+
 void MegaApi::setPreview(MegaNode* node, const char *srcFilePath, MegaRequestListener *listener)
 {
     pImpl->setPreview(node, srcFilePath, listener);
@@ -3373,6 +3403,21 @@ bool MegaApi::setMaxUploadSpeed(long long bpslimit)
     return pImpl->setMaxUploadSpeed(bpslimit);
 }
 
+bool MegaApi::setMaxDownloadSpeed(int trafficClass, long long bpslimit)
+{
+    return pImpl->setMaxDownloadSpeed(trafficClass, bpslimit);
+}
+
+bool MegaApi::setMaxUploadSpeed(int trafficClass, long long bpslimit)
+{
+    return pImpl->setMaxUploadSpeed(trafficClass, bpslimit);
+}
+
+void MegaApi::setSocketTuning(int receiveBufferSize, int sendBufferSize, const char* congestionAlgorithm, int notSentLowat)
+{
+    pImpl->setSocketTuning(receiveBufferSize, sendBufferSize, congestionAlgorithm, notSentLowat);
+}
+
 int MegaApi::getCurrentDownloadSpeed()
 {
     return pImpl->getCurrentDownloadSpeed();
@@ -3388,6 +3433,46 @@ int MegaApi::getCurrentSpeed(int type)
     return pImpl->getCurrentSpeed(type);
 }
 
+char *MegaApi::getRetryTelemetry()
+{
+    return pImpl->getRetryTelemetry();
+}
+
+char *MegaApi::getPerformanceCounters()
+{
+    return pImpl->getPerformanceCounters();
+}
+
+char *MegaApi::getMemoryUsage()
+{
+    return pImpl->getMemoryUsage();
+}
+
+char *MegaApi::getStallSamples()
+{
+    return pImpl->getStallSamples();
+}
+
+bool MegaApi::startPerformanceTrace(const char *path)
+{
+    return pImpl->startPerformanceTrace(path);
+}
+
+void MegaApi::stopPerformanceTrace()
+{
+    pImpl->stopPerformanceTrace();
+}
+
+bool MegaApi::startWireCapture(const char *path)
+{
+    return pImpl->startWireCapture(path);
+}
+
+void MegaApi::stopWireCapture()
+{
+    pImpl->stopWireCapture();
+}
+
 int MegaApi::getDownloadMethod()
 {
     return pImpl->getDownloadMethod();
@@ -3433,6 +3518,11 @@ MegaTransfer *MegaApi::getTransferByTag(int transferTag)
     return pImpl->getTransferByTag(transferTag);
 }
 
+bool MegaApi::getTransferProgressByTag(int transferTag, long long* transferredBytes, long long* totalBytes, long long* speed, long long* meanSpeed)
+{
+    return pImpl->getTransferProgressByTag(transferTag, transferredBytes, totalBytes, speed, meanSpeed);
+}
+
 MegaTransferList *MegaApi::getTransfers(int type)
 {
     return pImpl->getTransfers(type);
@@ -3480,6 +3570,11 @@ void MegaApi::startUpload(const char *localPath, MegaNode *parent, const char *f
                        false /*forceNewUpload*/, FS_UNKNOWN, convertToCancelToken(cancelToken), listener);
 }
 
+void MegaApi::startUploadBatch(const MegaStringList* localPaths, MegaNode* parent, int64_t mtime, bool startFirst, MegaCancelToken* cancelToken, MegaTransferListener* listener)
+{
+    pImpl->startUploadBatch(startFirst, localPaths, parent, mtime, convertToCancelToken(cancelToken), listener);
+}
+
 void MegaApi::startUploadForChat(const char *localPath, MegaNode *parent, const char *appData, bool isSourceTemporary, const char* fileName, MegaTransferListener *listener)
 {
     pImpl->startUpload(true /*startFirst*/, localPath, parent, fileName, NULL /*targetUser*/, INVALID_CUSTOM_MOD_TIME /*mtime*/,
@@ -3492,6 +3587,11 @@ void MegaApi::startDownload(MegaNode* node, const char* localPath, const char *c
     pImpl->startDownload(startFirst, node, localPath, customName, 0 /*folderTransferTag*/, appData, convertToCancelToken(cancelToken), collisionCheck, collisionResolution, undelete, listener);
 }
 
+void MegaApi::startDownloadBatch(MegaNodeList* nodes, const char* localFolder, bool startFirst, MegaCancelToken* cancelToken, int collisionCheck, int collisionResolution, MegaTransferListener* listener)
+{
+    pImpl->startDownloadBatch(startFirst, nodes, localFolder, convertToCancelToken(cancelToken), collisionCheck, collisionResolution, listener);
+}
+
 void MegaApi::cancelTransfer(MegaTransfer *t, MegaRequestListener *listener)
 {
     pImpl->cancelTransfer(t, listener);
@@ -3884,6 +3984,16 @@ MegaUserAlertList* MegaApi::getUserAlerts()
     return pImpl->getUserAlerts();
 }
 
+int MegaApi::loadMoreUserAlerts(int count)
+{
+    return pImpl->loadMoreUserAlerts(count);
+}
+
+int MegaApi::getUnloadedUserAlertCount()
+{
+    return pImpl->getUnloadedUserAlertCount();
+}
+
 int MegaApi::getNumUnreadUserAlerts()
 {
     return pImpl->getNumUnreadUserAlerts();
@@ -4194,6 +4304,11 @@ MegaNodeList* MegaApi::search(const MegaSearchFilter* filter, int order, MegaCan
     return pImpl->search(filter, order, convertToCancelToken(cancelToken));
 }
 
+MegaNodeList* MegaApi::search(const MegaSearchFilter* filter, int order, MegaCancelToken* cancelToken, const MegaSearchPage* searchPage)
+{
+    return pImpl->search(filter, order, convertToCancelToken(cancelToken), searchPage);
+}
+
 MegaNodeList* MegaApi::search(MegaNode* n, const char* searchString, bool recursive, int order)
 {
     return pImpl->search(n, searchString, CancelToken(), recursive, order);
@@ -4399,6 +4514,11 @@ MegaNodeList *MegaApi::getChildren(const MegaSearchFilter* filter, int order, Me
     return pImpl->getChildren(filter, order, convertToCancelToken(cancelToken));
 }
 
+MegaNodeList *MegaApi::getChildren(const MegaSearchFilter* filter, int order, MegaCancelToken* cancelToken, const MegaSearchPage* searchPage)
+{
+    return pImpl->getChildren(filter, order, convertToCancelToken(cancelToken), searchPage);
+}
+
 MegaNodeList *MegaApi::getChildren(MegaNode* p, int order, MegaCancelToken* cancelToken)
 {
     return pImpl->getChildren(p, order, convertToCancelToken(cancelToken));
@@ -4409,6 +4529,23 @@ MegaNodeList *MegaApi::getChildren(MegaNodeList *parentNodes, int order)
     return pImpl->getChildren(parentNodes, order);
 }
 
+void MegaApi::prefetchNode(MegaNode *node)
+{
+    pImpl->prefetchNode(node);
+}
+
+#ifdef ENABLE_CHAT
+void MegaApi::prefetchChat(MegaHandle chatid)
+{
+    pImpl->prefetchChat(chatid);
+}
+#endif
+
+void MegaApi::cancelPrefetch()
+{
+    pImpl->cancelPrefetch();
+}
+
 MegaNodeList *MegaApi::getVersions(MegaNode *node)
 {
     return pImpl->getVersions(node);
@@ -4504,6 +4641,26 @@ void MegaApi::setLRUCacheSize(unsigned long long size)
     pImpl->setLRUCacheSize(size);
 }
 
+void MegaApi::setLRUCacheMaxBytes(unsigned long long maxBytes)
+{
+    pImpl->setLRUCacheMaxBytes(maxBytes);
+}
+
+unsigned long long MegaApi::getLRUCacheHits()
+{
+    return pImpl->getLRUCacheHits();
+}
+
+unsigned long long MegaApi::getLRUCacheMisses()
+{
+    return pImpl->getLRUCacheMisses();
+}
+
+void MegaApi::setChildrenPrefetchEnabled(bool enable)
+{
+    pImpl->setChildrenPrefetchEnabled(enable);
+}
+
 long long MegaApi::getTotalDownloadedBytes()
 {
     return pImpl->getTotalDownloadedBytes();
@@ -6048,6 +6205,11 @@ const char* MegaGfxProcessor::supportedVideoFormats()
     return "all";
 }
 
+MegaGfxProcessor* MegaGfxProcessor::createProcessor()
+{
+    return NULL;
+}
+
 MegaGfxProcessor::~MegaGfxProcessor() { }
 MegaPricing::~MegaPricing() { }
 
@@ -6642,6 +6804,34 @@ MegaInputStream::~MegaInputStream()
 }
 
 
+MegaSearchPage::MegaSearchPage()
+{
+}
+
+MegaSearchPage* MegaSearchPage::createInstance(size_t startingOffset, size_t size)
+{
+    return new MegaSearchPagePrivate(startingOffset, size);
+}
+
+MegaSearchPage* MegaSearchPage::copy() const
+{
+    return nullptr;
+}
+
+MegaSearchPage::~MegaSearchPage()
+{
+}
+
+size_t MegaSearchPage::startingOffset() const
+{
+    return 0;
+}
+
+size_t MegaSearchPage::size() const
+{
+    return 0;
+}
+
 MegaSearchFilter::MegaSearchFilter()
 {
 }
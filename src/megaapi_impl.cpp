@@ -62,14 +62,67 @@
 
 namespace mega {
 
+thread_local unsigned MegaApiImpl::SdkMutex::mSharedDepth = 0;
+
+namespace {
+
+// Refcounted interning pool for strings duplicated across many MegaNode
+// instances: big accounts hold hundreds of thousands of identically named
+// nodes ("IMG_0001.jpg", "node_modules" trees), and fingerprints recur
+// across versions and copies. intern() returns a pointer valid until the
+// matching release(); identical values share a single allocation.
+class InternedStringPool
+{
+public:
+    static const char* intern(const char* s)
+    {
+        if (!s)
+        {
+            return NULL;
+        }
+
+        std::lock_guard<std::mutex> g(mMutex);
+        auto it = mPool.emplace(s, 0).first;
+        ++it->second;
+        return it->first.c_str();   // map keys stay put until erased
+    }
+
+    static void release(const char* s)
+    {
+        if (!s)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> g(mMutex);
+        auto it = mPool.find(s);
+        assert(it != mPool.end() && it->second > 0);
+        if (it != mPool.end() && !--it->second)
+        {
+            mPool.erase(it);
+        }
+    }
+
+private:
+    // MegaNode objects are constructed and destroyed on arbitrary app
+    // threads, so the pool serializes on its own mutex
+    static std::mutex mMutex;
+    static std::map<std::string, unsigned> mPool;
+};
+
+std::mutex InternedStringPool::mMutex;
+std::map<std::string, unsigned> InternedStringPool::mPool;
+
+} // anonymous namespace
+
 MegaNodePrivate::MegaNodePrivate(const char *name, int type, int64_t size, int64_t ctime, int64_t mtime, uint64_t nodehandle,
                                  const string *nodekey, const string *fileattrstring, const char *fingerprint, const char *originalFingerprint, MegaHandle owner, MegaHandle parentHandle,
                                  const char *privateauth, const char *publicauth, bool ispublic, bool isForeign, const char *chatauth, bool isNodeKeyDecrypted)
 : MegaNode()
 {
-    this->name = MegaApi::strdup(name);
-    this->fingerprint = MegaApi::strdup(fingerprint);
-    this->originalfingerprint = MegaApi::strdup(originalFingerprint);
+    this->name = InternedStringPool::intern(name);
+    this->fingerprint = InternedStringPool::intern(fingerprint);
+    this->originalfingerprint = InternedStringPool::intern(originalFingerprint);
     this->customAttrs = NULL;
     this->duration = -1;
     this->width = -1;
@@ -118,9 +171,9 @@ MegaNodePrivate::MegaNodePrivate(const char *name, int type, int64_t size, int64
 MegaNodePrivate::MegaNodePrivate(MegaNode *node)
 : MegaNode()
 {
-    this->name = MegaApi::strdup(node->getName());
-    this->fingerprint = MegaApi::strdup(node->getFingerprint());
-    this->originalfingerprint = MegaApi::strdup(node->getOriginalFingerprint());
+    this->name = InternedStringPool::intern(node->getName());
+    this->fingerprint = InternedStringPool::intern(node->getFingerprint());
+    this->originalfingerprint = InternedStringPool::intern(node->getOriginalFingerprint());
     this->customAttrs = NULL;
 
     MegaNodePrivate *np = dynamic_cast<MegaNodePrivate *>(node);
@@ -214,7 +267,7 @@ MegaNodePrivate::MegaNodePrivate(MegaNode *node)
 MegaNodePrivate::MegaNodePrivate(Node *node)
 : MegaNode()
 {
-    this->name = MegaApi::strdup(node->displayname());
+    this->name = InternedStringPool::intern(node->displayname());
     this->fingerprint = NULL;
     this->originalfingerprint = NULL;
     this->children = NULL;
@@ -225,7 +278,7 @@ MegaNodePrivate::MegaNodePrivate(Node *node)
         string fingerprint;
         node->serializefingerprint(&fingerprint);
         string result = MegaNodePrivate::addAppPrefixToFingerprint(fingerprint, node->size);
-        this->fingerprint = MegaApi::strdup(result.c_str());
+        this->fingerprint = InternedStringPool::intern(result.c_str());
     }
 
     this->duration = -1;
@@ -240,10 +293,130 @@ MegaNodePrivate::MegaNodePrivate(Node *node)
     this->mFavourite = false;
     this->mLabel = LBL_UNKNOWN;
 
+    // defer everything derived from the attribute map: most nodes handed out
+    // in lists never have these fields read, and copying the (possibly still
+    // unparsed) snapshot is far cheaper than extracting them per node
+    mDeferredAttrs = node->attrs.map;
+    mAttrsDeferred = true;
+
+    if (node->type == FILENODE && node->client
+            && node->client->unshareablekey.size() == Base64Str<SymmCipher::KEYLENGTH>::STRLEN
+            && mDeferredAttrs.getquick(AttrMap::string2nameid("gp")))
+    {
+        // decrypting "gp" needs the client's master key, which is no longer
+        // reachable once the snapshot is parsed: derive the cipher up front
+        mUnshareableCipher.reset(new SymmCipher);
+        node->client->setkey(mUnshareableCipher.get(), node->client->unshareablekey.data());
+    }
+
+    this->type = node->type;
+    this->size = node->size;
+    this->ctime = node->ctime;
+    this->mtime = node->mtime;
+    this->nodehandle = node->nodehandle;
+    this->parenthandle = node->parent ? node->parent->nodehandle : INVALID_HANDLE;
+    this->owner = node->owner;
+
+    mIsNodeKeyDecrypted = node->attrstring == nullptr;  // it's reset after node's key decryption successfull
+    this->fileattrstring = node->fileattrstring;
+    this->nodekey = node->nodekeyUnchecked();
+
+    this->changed = 0;
+    if(node->changed.attrs)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_ATTRIBUTES;
+    }
+    if(node->changed.ctime)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_TIMESTAMP;
+    }
+    if(node->changed.fileattrstring)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_FILE_ATTRIBUTES;
+    }
+    if(node->changed.inshare)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_INSHARE;
+    }
+    if(node->changed.outshares)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_OUTSHARE;
+    }
+    if(node->changed.pendingshares)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_PENDINGSHARE;
+    }
+    if(node->changed.owner)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_OWNER;
+    }
+    if(node->changed.parent)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_PARENT;
+    }
+    if(node->changed.removed)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_REMOVED;
+    }
+    if(node->changed.publiclink)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_PUBLIC_LINK;
+    }
+    if(node->changed.newnode)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_NEW;
+    }
+    if (node->changed.name)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_NAME;
+    }
+    if (node->changed.favourite)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_FAVOURITE;
+    }
+    if (node->changed.counter)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_COUNTER;
+    }
+    if (node->changed.sensitive)
+    {
+        this->changed |= MegaNode::CHANGE_TYPE_SENSITIVE;
+    }
+
+    this->thumbnailAvailable = (node->hasfileattribute(0) != 0);
+    this->previewAvailable = (node->hasfileattribute(1) != 0);
+    this->isPublicNode = false;
+    this->foreign = false;
+
+    // if there's only one share and it has no user --> public link
+    this->outShares = (node->outshares) ? (node->outshares->size() > 1 || node->outshares->begin()->second->user) : false;
+    this->inShare = node->inshare != nullptr;
+    this->plink = node->plink ? new PublicLink(*node->plink) : NULL;
+    this->mNewLinkFormat = node->client->mNewLinkFormat;
+    if (plink && type == FOLDERNODE && node->sharekey)
+    {
+        char key[FOLDERNODEKEYLENGTH*4/3+3];
+        Base64::btoa(node->sharekey->key, FOLDERNODEKEYLENGTH, key);
+        this->sharekey = new string(key);
+    }
+    else
+    {
+        this->sharekey = NULL;
+    }
+}
+
+void MegaNodePrivate::ensureAttrDerivedFields()
+{
+    if (!mAttrsDeferred)
+    {
+        return;
+    }
+    mAttrsDeferred = false;
+
     char buf[10];
-    for (attr_map::iterator it = node->attrs.map.begin(); it != node->attrs.map.end(); it++)
+    for (attr_map::iterator it = mDeferredAttrs.begin(); it != mDeferredAttrs.end(); it++)
     {
-        int attrlen = node->attrs.nameid2string(it->first, buf);
+        int attrlen = AttrMap::nameid2string(it->first, buf);
         buf[attrlen] = '\0';
         if (buf[0] == '_')
         {
@@ -259,14 +432,14 @@ MegaNodePrivate::MegaNodePrivate(Node *node)
         {
             if (it->first == AttrMap::string2nameid("d"))
             {
-               if (node->type == FILENODE)
+               if (type == FILENODE)
                {
                    duration = int(Base64::atoi(&it->second));
                }
             }
             else if (it->first == AttrMap::string2nameid("l") || it->first == AttrMap::string2nameid("gp"))
             {
-                if (node->type == FILENODE)
+                if (type == FILENODE)
                 {
                     string coords = it->second;
                     if ((it->first == AttrMap::string2nameid("l") && coords.size() != 8) ||
@@ -279,14 +452,12 @@ MegaNodePrivate::MegaNodePrivate(Node *node)
                         bool ok = true;
                         if (it->first == AttrMap::string2nameid("gp"))
                         {
-                            if (node->client && node->client->unshareablekey.size() == Base64Str<SymmCipher::KEYLENGTH>::STRLEN && coords.size() == Base64Str<16>::STRLEN)
+                            if (mUnshareableCipher && coords.size() == Base64Str<16>::STRLEN)
                             {
-                                SymmCipher c;
                                 byte data[SymmCipher::BLOCKSIZE] = { 0 };
                                 Base64::atob(coords.data(), data, Base64Str<SymmCipher::BLOCKSIZE>::STRLEN);
 
-                                node->client->setkey(&c, node->client->unshareablekey.data());
-                                c.ctr_crypt(data, SymmCipher::BLOCKSIZE, 0, 0, NULL, false);
+                                mUnshareableCipher->ctr_crypt(data, SymmCipher::BLOCKSIZE, 0, 0, NULL, false);
                                 ok = !memcmp(data, "unshare/", 8);
                                 if (ok)
                                 {
@@ -342,11 +513,11 @@ MegaNodePrivate::MegaNodePrivate(Node *node)
             }
             else if (it->first == AttrMap::string2nameid("c") && !fingerprint)
             {
-                fingerprint = MegaApi::strdup(it->second.c_str());
+                fingerprint = InternedStringPool::intern(it->second.c_str());
             }
             else if (it->first == AttrMap::string2nameid("c0"))
             {
-                originalfingerprint = MegaApi::strdup(it->second.c_str());
+                originalfingerprint = InternedStringPool::intern(it->second.c_str());
             }
             else if (it->first == AttrMap::string2nameid("fav"))
             {
@@ -417,100 +588,8 @@ MegaNodePrivate::MegaNodePrivate(Node *node)
         }
     }
 
-    this->type = node->type;
-    this->size = node->size;
-    this->ctime = node->ctime;
-    this->mtime = node->mtime;
-    this->nodehandle = node->nodehandle;
-    this->parenthandle = node->parent ? node->parent->nodehandle : INVALID_HANDLE;
-    this->owner = node->owner;
-
-    mIsNodeKeyDecrypted = node->attrstring == nullptr;  // it's reset after node's key decryption successfull
-    this->fileattrstring = node->fileattrstring;
-    this->nodekey = node->nodekeyUnchecked();
-
-    this->changed = 0;
-    if(node->changed.attrs)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_ATTRIBUTES;
-    }
-    if(node->changed.ctime)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_TIMESTAMP;
-    }
-    if(node->changed.fileattrstring)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_FILE_ATTRIBUTES;
-    }
-    if(node->changed.inshare)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_INSHARE;
-    }
-    if(node->changed.outshares)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_OUTSHARE;
-    }
-    if(node->changed.pendingshares)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_PENDINGSHARE;
-    }
-    if(node->changed.owner)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_OWNER;
-    }
-    if(node->changed.parent)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_PARENT;
-    }
-    if(node->changed.removed)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_REMOVED;
-    }
-    if(node->changed.publiclink)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_PUBLIC_LINK;
-    }
-    if(node->changed.newnode)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_NEW;
-    }
-    if (node->changed.name)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_NAME;
-    }
-    if (node->changed.favourite)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_FAVOURITE;
-    }
-    if (node->changed.counter)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_COUNTER;
-    }
-    if (node->changed.sensitive)
-    {
-        this->changed |= MegaNode::CHANGE_TYPE_SENSITIVE;
-    }
-
-    this->thumbnailAvailable = (node->hasfileattribute(0) != 0);
-    this->previewAvailable = (node->hasfileattribute(1) != 0);
-    this->isPublicNode = false;
-    this->foreign = false;
-
-    // if there's only one share and it has no user --> public link
-    this->outShares = (node->outshares) ? (node->outshares->size() > 1 || node->outshares->begin()->second->user) : false;
-    this->inShare = node->inshare != nullptr;
-    this->plink = node->plink ? new PublicLink(*node->plink) : NULL;
-    this->mNewLinkFormat = node->client->mNewLinkFormat;
-    if (plink && type == FOLDERNODE && node->sharekey)
-    {
-        char key[FOLDERNODEKEYLENGTH*4/3+3];
-        Base64::btoa(node->sharekey->key, FOLDERNODEKEYLENGTH, key);
-        this->sharekey = new string(key);
-    }
-    else
-    {
-        this->sharekey = NULL;
-    }
+    mDeferredAttrs.clear();
+    mUnshareableCipher.reset();
 }
 
 string* MegaNodePrivate::getSharekey()
@@ -539,6 +618,8 @@ char *MegaNodePrivate::serialize()
 
 bool MegaNodePrivate::serialize(string *d) const
 {
+    const_cast<MegaNodePrivate*>(this)->ensureAttrDerivedFields();
+
     CacheableWriter w(*d);
     w.serializecstr(name, true);
     w.serializecstr(fingerprint, true);
@@ -653,21 +734,25 @@ const char* MegaNodePrivate::getName()
 
 const char *MegaNodePrivate::getFingerprint()
 {
+    ensureAttrDerivedFields();
     return fingerprint;
 }
 
 const char *MegaNodePrivate::getOriginalFingerprint()
 {
+    ensureAttrDerivedFields();
     return originalfingerprint;
 }
 
 bool MegaNodePrivate::hasCustomAttrs()
 {
+    ensureAttrDerivedFields();
     return customAttrs != NULL;
 }
 
 MegaStringList *MegaNodePrivate::getCustomAttrNames()
 {
+    ensureAttrDerivedFields();
     if (!customAttrs)
     {
         return new MegaStringList();
@@ -683,6 +768,7 @@ MegaStringList *MegaNodePrivate::getCustomAttrNames()
 
 const char *MegaNodePrivate::getCustomAttr(const char *attrName)
 {
+    ensureAttrDerivedFields();
     if (!customAttrs)
     {
         return NULL;
@@ -705,6 +791,7 @@ const char *MegaNodePrivate::getCustomAttr(const char *attrName)
 
 int MegaNodePrivate::getDuration()
 {
+    ensureAttrDerivedFields();
     if (type == MegaNode::TYPE_FILE && nodekey.size() == FILENODEKEYLENGTH && fileattrstring.size())
     {
         uint32_t* attrKey = (uint32_t*)(nodekey.data() + FILENODEKEYLENGTH / 2);
@@ -722,16 +809,19 @@ int MegaNodePrivate::getDuration()
 
 bool MegaNodePrivate::isFavourite()
 {
+    ensureAttrDerivedFields();
     return mFavourite;
 }
 
 bool MegaNodePrivate::isMarkedSensitive()
 {
+    ensureAttrDerivedFields();
     return mMarkedSensitive;
 }
 
 int MegaNodePrivate::getLabel()
 {
+    ensureAttrDerivedFields();
     return mLabel;
 }
 
@@ -817,11 +907,13 @@ int MegaNodePrivate::getVideocodecid()
 
 double MegaNodePrivate::getLatitude()
 {
+    ensureAttrDerivedFields();
     return latitude;
 }
 
 double MegaNodePrivate::getLongitude()
 {
+    ensureAttrDerivedFields();
     return longitude;
 }
 
@@ -842,6 +934,7 @@ int64_t MegaNodePrivate::getModificationTime()
 
 MegaHandle MegaNodePrivate::getRestoreHandle()
 {
+    ensureAttrDerivedFields();
     return restorehandle;
 }
 
@@ -912,6 +1005,7 @@ MegaHandle MegaNodePrivate::getPublicHandle()
 
 MegaNode* MegaNodePrivate::getPublicNode()
 {
+    ensureAttrDerivedFields();
     if (!plink || plink->isExpired())
     {
         return NULL;
@@ -992,11 +1086,13 @@ MegaHandle MegaNodePrivate::getOwner() const
 
 const char* MegaNodePrivate::getDeviceId() const
 {
+    const_cast<MegaNodePrivate*>(this)->ensureAttrDerivedFields();
     return mDeviceId.c_str();
 }
 
 const char* MegaNodePrivate::getS4() const
 {
+    const_cast<MegaNodePrivate*>(this)->ensureAttrDerivedFields();
     return mS4.c_str();
 }
 
@@ -1850,10 +1946,8 @@ void MegaNodePrivate::setChildren(MegaNodeList *children)
 
 void MegaNodePrivate::setName(const char *newName)
 {
-    if (name)
-        delete [] name;
-
-    name = MegaApi::strdup(newName);
+    InternedStringPool::release(name);
+    name = InternedStringPool::intern(newName);
 }
 
 string *MegaNodePrivate::getPublicAuth()
@@ -1868,9 +1962,9 @@ const char *MegaNodePrivate::getChatAuth()
 
 MegaNodePrivate::~MegaNodePrivate()
 {
-    delete[] name;
-    delete[] fingerprint;
-    delete[] originalfingerprint;
+    InternedStringPool::release(name);
+    InternedStringPool::release(fingerprint);
+    InternedStringPool::release(originalfingerprint);
     delete [] chatAuth;
     delete customAttrs;
     delete plink;
@@ -2014,6 +2108,14 @@ MegaUserPrivate::MegaUserPrivate(User *user) : MegaUser()
     {
         changed |= MegaUser::CHANGE_CC_PREFS;
     }
+    if (user->changed.show || user->changed.ctime)
+    {
+        changed |= MegaUser::CHANGE_TYPE_VISIBILITY;
+    }
+    if (user->changed.sharing)
+    {
+        changed |= MegaUser::CHANGE_TYPE_SHARING;
+    }
 }
 
 MegaUserPrivate::MegaUserPrivate(MegaUser *user) : MegaUser()
@@ -2607,11 +2709,9 @@ MegaTransferPrivate::MegaTransferPrivate(int type, MegaTransferListener *listene
     this->maxRetries = 7;
     this->time = -1;
     this->startTime = 0;
-    this->transferredBytes = 0;
-    this->totalBytes = 0;
+    this->mProgress = std::make_shared<ProgressCounters>();
     this->fileName = NULL;
     this->transfer = NULL;
-    this->speed = 0;
     this->deltaSize = 0;
     this->updateTime = 0;
     this->publicNode = NULL;
@@ -2626,13 +2726,13 @@ MegaTransferPrivate::MegaTransferPrivate(int type, MegaTransferListener *listene
     this->appData = NULL;
     this->state = STATE_NONE;
     this->priority = 0;
-    this->meanSpeed = 0;
     this->notificationNumber = 0;
     this->mStage = MegaTransfer::STAGE_NONE;
 }
 
 MegaTransferPrivate::MegaTransferPrivate(const MegaTransferPrivate *transfer)
 {
+    mProgress = std::make_shared<ProgressCounters>();   // copies are independent snapshots
     path = NULL;
     parentPath = NULL;
     fileName = NULL;
@@ -2661,6 +2761,10 @@ MegaTransferPrivate::MegaTransferPrivate(const MegaTransferPrivate *transfer)
     this->setFileName(transfer->getFileName());
     this->setSpeed(transfer->getSpeed());
     this->setMeanSpeed(transfer->getMeanSpeed());
+    if (const char* stats = transfer->getStats())
+    {
+        this->setStats(stats);
+    }
     this->setDeltaSize(transfer->getDeltaSize());
     this->setUpdateTime(transfer->getUpdateTime());
     this->setPublicNode(transfer->getPublicNode());
@@ -2706,12 +2810,12 @@ int MegaTransferPrivate::getTag() const
 
 long long MegaTransferPrivate::getSpeed() const
 {
-    return speed;
+    return mProgress->speed.load(std::memory_order_relaxed);
 }
 
 long long MegaTransferPrivate::getMeanSpeed() const
 {
-    return meanSpeed;
+    return mProgress->meanSpeed.load(std::memory_order_relaxed);
 }
 
 long long MegaTransferPrivate::getDeltaSize() const
@@ -2791,12 +2895,12 @@ int64_t MegaTransferPrivate::getStartTime() const
 
 long long MegaTransferPrivate::getTransferredBytes() const
 {
-    return transferredBytes;
+    return mProgress->transferredBytes.load(std::memory_order_relaxed);
 }
 
 long long MegaTransferPrivate::getTotalBytes() const
 {
-    return totalBytes;
+    return mProgress->totalBytes.load(std::memory_order_relaxed);
 }
 
 const char* MegaTransferPrivate::getPath() const
@@ -3144,12 +3248,22 @@ void MegaTransferPrivate::setTag(int tag)
 
 void MegaTransferPrivate::setSpeed(long long speed)
 {
-    this->speed = speed;
+    mProgress->speed.store(speed, std::memory_order_relaxed);
 }
 
 void MegaTransferPrivate::setMeanSpeed(long long meanSpeed)
 {
-    this->meanSpeed = meanSpeed;
+    mProgress->meanSpeed.store(meanSpeed, std::memory_order_relaxed);
+}
+
+void MegaTransferPrivate::setStats(const string& stats)
+{
+    mStats = stats;
+}
+
+const char* MegaTransferPrivate::getStats() const
+{
+    return mStats.empty() ? NULL : mStats.c_str();
 }
 
 void MegaTransferPrivate::setDeltaSize(long long deltaSize)
@@ -3234,12 +3348,12 @@ void MegaTransferPrivate::setStartTime(int64_t startTime)
 
 void MegaTransferPrivate::setTransferredBytes(long long transferredBytes)
 {
-    this->transferredBytes = transferredBytes;
+    mProgress->transferredBytes.store(transferredBytes, std::memory_order_relaxed);
 }
 
 void MegaTransferPrivate::setTotalBytes(long long totalBytes)
 {
-    this->totalBytes = totalBytes;
+    mProgress->totalBytes.store(totalBytes, std::memory_order_relaxed);
 }
 
 void MegaTransferPrivate::setLastBytes(char *lastBytes)
@@ -4864,40 +4978,51 @@ const integer_map* MegaIntegerMapPrivate::getMap() const
     return &mIntegerMap;
 }
 
+MegaStringListPrivate::MegaStringListPrivate()
+    : mList(std::make_shared<string_vector>())
+{
+}
+
 MegaStringListPrivate::MegaStringListPrivate(string_vector&& v)
-    : mList(std::move(v))
+    : mList(std::make_shared<string_vector>(std::move(v)))
 {
 }
 
 MegaStringList *MegaStringListPrivate::copy() const
 {
+    // shares the backing buffer; a later add() on either list detaches it
     return new MegaStringListPrivate(*this);
 }
 
 const char *MegaStringListPrivate::get(int i) const
 {
-    if((i < 0) || (static_cast<size_t>(i) >= mList.size()))
+    if((i < 0) || (static_cast<size_t>(i) >= mList->size()))
         return nullptr;
 
-    return mList[i].c_str();
+    return (*mList)[i].c_str();
 }
 
 int MegaStringListPrivate::size() const
 {
-    return int(mList.size());
+    return int(mList->size());
 }
 
 void MegaStringListPrivate::add(const char *value)
 {
     if (value)
     {
-        mList.push_back(value);
+        if (mList.use_count() > 1)
+        {
+            // shared with a copy: detach before mutating
+            mList = std::make_shared<string_vector>(*mList);
+        }
+        mList->push_back(value);
     }
 }
 
 const string_vector& MegaStringListPrivate::getVector()
 {
-    return mList;
+    return *mList;
 }
 
 bool operator==(const MegaStringList& lhs, const MegaStringList& rhs)
@@ -5036,13 +5161,22 @@ MegaNodeListPrivate::MegaNodeListPrivate(const MegaNodeListPrivate *nodeList, bo
     }
 }
 
-MegaNodeListPrivate::MegaNodeListPrivate(sharedNode_vector& v)
+MegaNodeListPrivate::MegaNodeListPrivate(sharedNode_vector& v, bool deferNodeCopies)
 {
     list = NULL;
     s = static_cast<int>(v.size());
     if (!s) return;
 
     list = new MegaNode*[s];
+
+    if (deferNodeCopies)
+    {
+        // keep the nodes alive and copy each one on first access instead
+        mSourceNodes = v;
+        std::fill(list, list + s, nullptr);
+        return;
+    }
+
     for (int i = 0; i < s; i++)
         list[i] = MegaNodePrivate::fromNode(v[i].get());
 }
@@ -5082,6 +5216,12 @@ MegaNode *MegaNodeListPrivate::get(int i) const
     if(!list || (i < 0) || (i >= s))
         return NULL;
 
+    if (!list[i] && i < static_cast<int>(mSourceNodes.size()))
+    {
+        // deferred-copy list: materialize this entry on first access
+        list[i] = MegaNodePrivate::fromNode(mSourceNodes[i].get());
+    }
+
     return list[i];
 }
 
@@ -6044,12 +6184,36 @@ void MegaApiImpl::init(MegaApi *api, const char *appKey, MegaGfxProcessor* proce
     {
         auto externalGfx = ::mega::make_unique<GfxProviderExternal>();
         externalGfx->setProcessor(processor);
-        gfxAccess = new GfxProc(std::move(externalGfx));
+
+        // apps implementing MegaGfxProcessor::createProcessor get a worker per
+        // extra instance, minted up front so the pool is warm before the first
+        // job; the default NULL keeps the single sequential instance as before
+        unsigned gfxWorkers = std::thread::hardware_concurrency();
+        gfxWorkers = gfxWorkers ? std::min<unsigned>(gfxWorkers, 4) : 1;
+        gfxAccess = new GfxProc(std::move(externalGfx),
+                                [processor]() -> std::unique_ptr<IGfxProvider>
+                                {
+                                    MegaGfxProcessor* extra = processor->createProcessor();
+                                    if (!extra)
+                                    {
+                                        return nullptr;
+                                    }
+                                    auto provider = ::mega::make_unique<GfxProviderExternal>();
+                                    provider->setOwnedProcessor(extra);
+                                    return provider;
+                                },
+                                gfxWorkers);
         gfxAccess->startProcessingThread();
     }
     else
     {
-        gfxAccess = new GfxProc(::mega::make_unique<MegaGfxProvider>());
+        // internal providers are default-constructible, so give each gfx
+        // worker its own; decoding is memory-hungry, so keep the pool modest
+        unsigned gfxWorkers = std::thread::hardware_concurrency();
+        gfxWorkers = gfxWorkers ? std::min<unsigned>(gfxWorkers, 4) : 1;
+        gfxAccess = new GfxProc(::mega::make_unique<MegaGfxProvider>(),
+                                []() -> std::unique_ptr<IGfxProvider> { return ::mega::make_unique<MegaGfxProvider>(); },
+                                gfxWorkers);
         gfxAccess->startProcessingThread();
     }
 
@@ -6063,6 +6227,18 @@ void MegaApiImpl::init(MegaApi *api, const char *appKey, MegaGfxProcessor* proce
     {
         this->appKey = appKey;
     }
+    if (clientWorkerThreadCount == 1)
+    {
+        // historical default: a single worker serializes all chunk encrypt/decrypt/MAC
+        // work, capping transfer crypto at one core.  Chunk MAC streams are independent,
+        // so scale the pool with the machine and let several in-flight chunks progress
+        // concurrently.  Apps needing a specific count can pass one explicitly
+        // (0 keeps crypto synchronous on the SDK thread).
+        unsigned cores = std::thread::hardware_concurrency();
+        clientWorkerThreadCount = cores ? std::min<unsigned>(cores, 8) : 1;
+        LOG_debug << "Scaling crypto worker threads to " << clientWorkerThreadCount;
+    }
+
     client = new MegaClient(this, waiter, httpio, dbAccess, gfxAccess, appKey, userAgent, clientWorkerThreadCount);
 
 #if defined(_WIN32)
@@ -7063,9 +7239,10 @@ MegaProxy *MegaApiImpl::getAutoProxySettings()
 
 void MegaApiImpl::loop()
 {
-#ifdef _WIN32
+    // hold the HTTP layer's big lock for the lifetime of this thread; the
+    // waiter releases it while blocked so the network layer's own threads
+    // can service sockets in the meantime
     httpio->lock();
-#endif
 
     while(true)
     {
@@ -7075,6 +7252,14 @@ void MegaApiImpl::loop()
             r = client->preparewait();
         }
 
+        // drain bursts completely before sleeping again: work queued by the
+        // app while the previous batch was being processed should not cost a
+        // wakeup round trip per item
+        if (!r && (requestQueue.hasPending() || !transferQueue.empty()))
+        {
+            r = Waiter::NEEDEXEC;
+        }
+
         if (!r)
         {
             r = client->dowait();
@@ -7110,6 +7295,8 @@ void MegaApiImpl::loop()
     SdkMutexGuard g(sdkMutex);
     delete client;
     client = nullptr;
+
+    httpio->unlock();
 }
 
 bool MegaApiImpl::createLocalFolder(const char *path)
@@ -7493,6 +7680,12 @@ void MegaApiImpl::cancelGetPreview(MegaNode* node, MegaRequestListener *listener
     cancelGetNodeAttribute(node, GfxProc::PREVIEW, listener);
 }
 
+void MegaApiImpl::setThumbnailPriority(MegaHandle handle, bool priority)
+{
+    SdkMutexGuard g(sdkMutex);
+    client->setfapriority(handle, priority);
+}
+
 void MegaApiImpl::setPreview(MegaNode* node, const char *srcFilePath, MegaRequestListener *listener)
 {
     setNodeAttribute(node, GfxProc::PREVIEW, srcFilePath, INVALID_HANDLE, listener);
@@ -8678,6 +8871,34 @@ bool MegaApiImpl::setMaxUploadSpeed(m_off_t bpslimit)
     return client->setmaxuploadspeed(bpslimit);
 }
 
+bool MegaApiImpl::setMaxDownloadSpeed(int trafficClass, m_off_t bpslimit)
+{
+    if (trafficClass < 0 || trafficClass >= TRAFFIC_CLASSES)
+    {
+        return false;
+    }
+
+    SdkMutexGuard g(sdkMutex);
+    return client->setmaxdownloadspeed(trafficclass_t(trafficClass), bpslimit);
+}
+
+bool MegaApiImpl::setMaxUploadSpeed(int trafficClass, m_off_t bpslimit)
+{
+    if (trafficClass < 0 || trafficClass >= TRAFFIC_CLASSES)
+    {
+        return false;
+    }
+
+    SdkMutexGuard g(sdkMutex);
+    return client->setmaxuploadspeed(trafficclass_t(trafficClass), bpslimit);
+}
+
+void MegaApiImpl::setSocketTuning(int receiveBufferSize, int sendBufferSize, const char* congestionAlgorithm, int notSentLowat)
+{
+    SdkMutexGuard g(sdkMutex);
+    client->setsockettuning(receiveBufferSize, sendBufferSize, congestionAlgorithm, notSentLowat);
+}
+
 int MegaApiImpl::getMaxDownloadSpeed()
 {
     return int(client->getmaxdownloadspeed());
@@ -8711,6 +8932,87 @@ int MegaApiImpl::getCurrentSpeed(int type)
     }
 }
 
+char *MegaApiImpl::getRetryTelemetry()
+{
+    SdkMutexGuard g(sdkMutex);
+    if (!client)
+    {
+        return NULL;
+    }
+
+    return MegaApi::strdup(client->retryTelemetry.report().c_str());
+}
+
+char *MegaApiImpl::getPerformanceCounters()
+{
+    // the registry is process-wide and lock-free, no need for the SDK mutex
+    string report = PerfCounters::get().report();
+
+    // one line per app listener that has received callbacks, so a blocking
+    // listener can be identified by address and worst callback
+    {
+        std::lock_guard<std::mutex> g(listenerStatsMutex);
+        for (auto& it : listenerStats)
+        {
+            ostringstream s;
+            s << "listener " << it.first << ": calls=" << it.second.calls
+              << " total_us=" << it.second.totalUs << " max_us=" << it.second.maxUs
+              << " worst=" << (it.second.maxCallback ? it.second.maxCallback : "-") << "\n";
+            report.append(s.str());
+        }
+    }
+    return MegaApi::strdup(report.c_str());
+}
+
+char *MegaApiImpl::getMemoryUsage()
+{
+    // the registry is process-wide and lock-free, no need for the SDK mutex
+    string report = MemoryAccounting::get().report();
+#ifdef USE_SQLITE
+    // sqlite keeps its own allocator accounting; read it at snapshot time
+    // rather than instrumenting every allocation it makes
+    ostringstream s;
+    s << "sqlite: current=" << sqlite3_memory_used() << " peak=" << sqlite3_memory_highwater(0) << "\n";
+    report.append(s.str());
+#endif
+    return MegaApi::strdup(report.c_str());
+}
+
+char *MegaApiImpl::getStallSamples()
+{
+    // deliberately no sdkMutex here: this is called by watchdogs precisely
+    // when the SDK thread may be wedged, and the sampler has its own brief
+    // internal lock that the stuck thread cannot be holding mid-pass
+    return MegaApi::strdup(client->stallSampler.report().c_str());
+}
+
+bool MegaApiImpl::startPerformanceTrace(const char *path)
+{
+#ifdef MEGASDK_TRACE_EVENTS_ENABLED
+    return path ? TraceRecorder::get().start(path) : false;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void MegaApiImpl::stopPerformanceTrace()
+{
+#ifdef MEGASDK_TRACE_EVENTS_ENABLED
+    TraceRecorder::get().stop();
+#endif
+}
+
+bool MegaApiImpl::startWireCapture(const char *path)
+{
+    return path ? WireCapture::get().start(path) : false;
+}
+
+void MegaApiImpl::stopWireCapture()
+{
+    WireCapture::get().stop();
+}
+
 int MegaApiImpl::getDownloadMethod()
 {
     if (client->autodownport)
@@ -8857,6 +9159,41 @@ MegaTransfer *MegaApiImpl::getTransferByTag(int transferTag)
     return value;
 }
 
+bool MegaApiImpl::getTransferProgressByTag(int transferTag, long long* transferredBytes, long long* totalBytes, long long* speed, long long* meanSpeed)
+{
+    // deliberately does not take sdkMutex: the counters are published atomically
+    // by the SDK thread, so UIs can sample them on a timer without slowing
+    // transfers down or blocking behind transfer processing
+    std::shared_ptr<MegaTransferPrivate::ProgressCounters> counters;
+    {
+        std::lock_guard<std::mutex> g(transferProgressMutex);
+        auto it = transferProgressMap.find(transferTag);
+        if (it == transferProgressMap.end())
+        {
+            return false;
+        }
+        counters = it->second;
+    }
+
+    if (transferredBytes)
+    {
+        *transferredBytes = counters->transferredBytes.load(std::memory_order_relaxed);
+    }
+    if (totalBytes)
+    {
+        *totalBytes = counters->totalBytes.load(std::memory_order_relaxed);
+    }
+    if (speed)
+    {
+        *speed = counters->speed.load(std::memory_order_relaxed);
+    }
+    if (meanSpeed)
+    {
+        *meanSpeed = counters->meanSpeed.load(std::memory_order_relaxed);
+    }
+    return true;
+}
+
 MegaTransferList *MegaApiImpl::getTransfers(int type)
 {
     if(type != MegaTransfer::TYPE_DOWNLOAD && type != MegaTransfer::TYPE_UPLOAD)
@@ -9022,6 +9359,12 @@ MegaTransferPrivate* MegaApiImpl::createUploadTransfer(bool startFirst, const ch
     transfer->setAppData(appData);
     transfer->setSourceFileTemporary(isSourceFileTemporary);
     transfer->setStartFirst(startFirst);
+    if (!cancelToken.exists())
+    {
+        // give every transfer real token storage, so cancelTransfer() can
+        // signal the engine without waiting for the request queue
+        cancelToken = CancelToken(false);
+    }
     transfer->setCancelToken(cancelToken);
     transfer->setBackupTransfer(isBackup);
 
@@ -9071,7 +9414,42 @@ MegaTransferPrivate* MegaApiImpl::createUploadTransfer(bool startFirst, const ch
 
             if (fa->type == FILENODE) // just file nodes have a valid fingerprint
             {
-                transfer->fingerprint_onDisk.genfingerprint(fa.get());
+                // fingerprint-first admission: a file unchanged since its last
+                // upload (same size+mtime at the same path) reuses the cached
+                // fingerprint instead of re-reading CRC samples off disk, so a
+                // repeat backup of an unchanged tree never opens file content
+                // before the clone-by-fingerprint check in sendPendingTransfers
+                auto cached = mUploadFingerprintByPath.find(localPath);
+                if (cached != mUploadFingerprintByPath.end() &&
+                    cached->second->fingerprint.size == fa->size &&
+                    cached->second->fingerprint.mtime == fa->mtime)
+                {
+                    transfer->fingerprint_onDisk = cached->second->fingerprint;
+                    mUploadFingerprints.splice(mUploadFingerprints.begin(), mUploadFingerprints, cached->second);
+                }
+                else
+                {
+                    transfer->fingerprint_onDisk.genfingerprint(fa.get());
+                    if (transfer->fingerprint_onDisk.isvalid)
+                    {
+                        if (cached != mUploadFingerprintByPath.end())
+                        {
+                            cached->second->fingerprint = transfer->fingerprint_onDisk;
+                            mUploadFingerprints.splice(mUploadFingerprints.begin(), mUploadFingerprints, cached->second);
+                        }
+                        else
+                        {
+                            mUploadFingerprints.push_front({localPath, transfer->fingerprint_onDisk});
+                            mUploadFingerprintByPath[localPath] = mUploadFingerprints.begin();
+
+                            if (mUploadFingerprints.size() > MAXUPLOADFINGERPRINTS)
+                            {
+                                mUploadFingerprintByPath.erase(mUploadFingerprints.back().path);
+                                mUploadFingerprints.pop_back();
+                            }
+                        }
+                    }
+                }
             }
         }
     }
@@ -9099,6 +9477,44 @@ void MegaApiImpl::startUploadForSupport(const char* localPath, bool isSourceFile
     waiter->notify();
 }
 
+void MegaApiImpl::startUploadBatch(bool startFirst, const MegaStringList* localPaths, MegaNode* parent, int64_t mtime, CancelToken cancelToken, MegaTransferListener* listener)
+{
+    if (!localPaths || !localPaths->size())
+    {
+        return;
+    }
+
+    // figure out the fs type once per source directory rather than once per
+    // file (it is expensive, and batches overwhelmingly come from one folder)
+    map<string, FileSystemType> dirFsTypes;
+
+    std::vector<MegaTransferPrivate*> batch;
+    batch.reserve(size_t(localPaths->size()));
+
+    for (int i = 0; i < localPaths->size(); i++)
+    {
+        const char* localPath = localPaths->get(i);
+        if (!localPath)
+        {
+            continue;
+        }
+
+        string parentDir = LocalPath::fromAbsolutePath(localPath).parentPath().toPath(false);
+        auto it = dirFsTypes.find(parentDir);
+        if (it == dirFsTypes.end())
+        {
+            it = dirFsTypes.emplace(parentDir, fsAccess->getlocalfstype(LocalPath::fromAbsolutePath(localPath))).first;
+        }
+
+        batch.push_back(createUploadTransfer(startFirst, localPath, parent, nullptr /*fileName*/, nullptr /*targetUser*/, mtime,
+                                             0 /*folderTransferTag*/, false /*isBackup*/, nullptr /*appData*/, false /*isSourceFileTemporary*/,
+                                             false /*forceNewUpload*/, it->second, cancelToken, listener));
+    }
+
+    transferQueue.pushAll(batch);
+    waiter->notify();
+}
+
 void MegaApiImpl::startDownload (bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener)
 {
     FileSystemType fsType = fsAccess->getlocalfstype(LocalPath::fromAbsolutePath(localPath));
@@ -9107,6 +9523,39 @@ void MegaApiImpl::startDownload (bool startFirst, MegaNode *node, const char* lo
     waiter->notify();
 }
 
+void MegaApiImpl::startDownloadBatch(bool startFirst, MegaNodeList* nodes, const char* localFolder, CancelToken cancelToken, int collisionCheck, int collisionResolution, MegaTransferListener* listener)
+{
+    if (!nodes || !nodes->size() || !localFolder)
+    {
+        return;
+    }
+
+    // shared setup for the whole batch: one fs type lookup and a single
+    // destination folder path, each file keeping its cloud name
+    string parentPath(localFolder);
+    if (!parentPath.empty() && parentPath.back() != LocalPath::localPathSeparator_utf8)
+    {
+        parentPath += LocalPath::localPathSeparator_utf8;
+    }
+    FileSystemType fsType = fsAccess->getlocalfstype(LocalPath::fromAbsolutePath(localFolder));
+
+    std::vector<MegaTransferPrivate*> batch;
+    batch.reserve(size_t(nodes->size()));
+
+    for (int i = 0; i < nodes->size(); i++)
+    {
+        if (MegaNode* node = nodes->get(i))
+        {
+            batch.push_back(createDownloadTransfer(startFirst, node, parentPath.c_str(), nullptr /*customName*/,
+                                                   0 /*folderTransferTag*/, nullptr /*appData*/, cancelToken,
+                                                   collisionCheck, collisionResolution, false /*undelete*/, listener, fsType));
+        }
+    }
+
+    transferQueue.pushAll(batch);
+    waiter->notify();
+}
+
 MegaTransferPrivate* MegaApiImpl::createDownloadTransfer(bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener, FileSystemType fsType)
 {
     assert(!undelete || node);
@@ -9142,6 +9591,12 @@ MegaTransferPrivate* MegaApiImpl::createDownloadTransfer(bool startFirst, MegaNo
     transfer->setMaxRetries(maxRetries);
     transfer->setAppData(appData);
     transfer->setStartFirst(startFirst);
+    if (!cancelToken.exists())
+    {
+        // give every transfer real token storage, so cancelTransfer() can
+        // signal the engine without waiting for the request queue
+        cancelToken = CancelToken(false);
+    }
     transfer->setCancelToken(cancelToken);
     transfer->setCollisionCheck(collisionCheck);
     transfer->setCollisionResolution(collisionResolution);
@@ -9165,12 +9620,29 @@ MegaTransferPrivate* MegaApiImpl::createDownloadTransfer(bool startFirst, MegaNo
     return transfer;
 }
 
+// Flip a transfer's cancel token from the calling thread. The engine checks
+// the token before every slot doio() pass, so the data flow stops within one
+// chunk instead of waiting for the queued cancel request to be processed.
+// Bookkeeping (fireOnTransferFinish etc.) still happens on the worker loop.
+void MegaApiImpl::signalTransferCancel(int transferTag)
+{
+    SdkReadGuard rg(sdkMutex);
+
+    MegaTransferPrivate* megaTransfer = getMegaTransferPrivate(transferTag);
+    if (megaTransfer && !megaTransfer->isFolderTransfer() &&
+        !megaTransfer->isStreamingTransfer() && !megaTransfer->isSyncTransfer())
+    {
+        megaTransfer->accessCancelToken().cancel();
+    }
+}
+
 void MegaApiImpl::cancelTransfer(MegaTransfer *t, MegaRequestListener *listener)
 {
     MegaRequestPrivate *request = new MegaRequestPrivate(MegaRequest::TYPE_CANCEL_TRANSFER, listener);
     if(t)
     {
         request->setTransferTag(t->getTag());
+        signalTransferCancel(t->getTag());
     }
 
     request->performTransferRequest = [this, request](TransferDbCommitter& committer)
@@ -9186,6 +9658,7 @@ void MegaApiImpl::cancelTransferByTag(int transferTag, MegaRequestListener *list
 {
     MegaRequestPrivate *request = new MegaRequestPrivate(MegaRequest::TYPE_CANCEL_TRANSFER, listener);
     request->setTransferTag(transferTag);
+    signalTransferCancel(transferTag);
 
     request->performTransferRequest = [this, request](TransferDbCommitter& committer)
     {
@@ -11013,6 +11486,18 @@ MegaUserAlertList* MegaApiImpl::getUserAlerts()
     return new MegaUserAlertListPrivate(v.data(), int(v.size()), client);
 }
 
+int MegaApiImpl::loadMoreUserAlerts(int count)
+{
+    SdkMutexGuard g(sdkMutex);
+    return count > 0 ? int(client->useralerts.loadOlderAlertPage(size_t(count))) : 0;
+}
+
+int MegaApiImpl::getUnloadedUserAlertCount()
+{
+    SdkMutexGuard g(sdkMutex);
+    return int(client->useralerts.unloadedAlertCount());
+}
+
 int MegaApiImpl::getNumUnreadUserAlerts()
 {
     int result = 0;
@@ -12045,7 +12530,22 @@ char* strcasestr(const char* string, const char* substring)
 
 #endif
 
-MegaNodeList* MegaApiImpl::search(const MegaSearchFilter* filter, int order, CancelToken cancelToken)
+// cut the window described by 'page' out of an already ordered result set
+static void applySearchPage(sharedNode_vector& results, const MegaSearchPage* page)
+{
+    if (!page)
+    {
+        return;
+    }
+
+    size_t from = std::min(page->startingOffset(), results.size());
+    size_t to = page->size() ? std::min(from + page->size(), results.size()) : results.size();
+
+    results.erase(results.begin() + static_cast<ptrdiff_t>(to), results.end());
+    results.erase(results.begin(), results.begin() + static_cast<ptrdiff_t>(from));
+}
+
+MegaNodeList* MegaApiImpl::search(const MegaSearchFilter* filter, int order, CancelToken cancelToken, const MegaSearchPage* searchPage)
 {
     if (!filter ||
         (filter->byNodeType() == MegaNode::TYPE_FOLDER && filter->byCategory() != MegaApi::FILE_TYPE_DEFAULT))
@@ -12057,7 +12557,7 @@ MegaNodeList* MegaApiImpl::search(const MegaSearchFilter* filter, int order, Can
 
     // search
     {
-        SdkMutexGuard g(sdkMutex);
+        SdkReadGuard g(sdkMutex);
 
         switch (filter->byLocation())
         {
@@ -12083,6 +12583,11 @@ MegaNodeList* MegaApiImpl::search(const MegaSearchFilter* filter, int order, Can
 
     // order
     sortByComparatorFunction(searchResults, order, *client);
+
+    // recursive matches are post-filtered by ancestry in NodeManager, so the
+    // window can only be cut here, after the result set is complete and sorted
+    applySearchPage(searchResults, searchPage);
+
     MegaNodeListPrivate* nodeList = new MegaNodeListPrivate(searchResults);
 
     return nodeList;
@@ -12434,7 +12939,7 @@ long long MegaApiImpl::getSize(MegaNode *n)
         return megaSizeProcessor.getTotalBytes();
     }
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     std::shared_ptr<Node> node = client->nodebyhandle(n->getHandle());
     if(!node)
     {
@@ -12484,6 +12989,10 @@ void MegaApiImpl::transfer_failed(Transfer* t, const Error& e, dstime timeleft)
         {
             continue;
         }
+        if (t->slot)
+        {
+            transfer->setStats(t->slot->statsReport());
+        }
         processTransferFailed(t, transfer, e, timeleft);
     }
 }
@@ -12514,7 +13023,7 @@ MegaNode *MegaApiImpl::getNodeByFingerprint(const char *fingerprint)
 {
     if(!fingerprint) return NULL;
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     return MegaNodePrivate::fromNode(getNodeByFingerprintInternal(fingerprint).get());
 }
 
@@ -12526,7 +13035,7 @@ MegaNodeList *MegaApiImpl::getNodesByFingerprint(const char *fingerprint)
         return new MegaNodeListPrivate();
     }
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     sharedNode_vector nodes = client->mNodeManager.getNodesByFingerprint(*fp);
     return new MegaNodeListPrivate(nodes);
 }
@@ -12556,7 +13065,7 @@ MegaNode *MegaApiImpl::getExportableNodeByFingerprint(const char *fingerprint, c
         return NULL;
     }
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     sharedNode_vector nodes = client->mNodeManager.getNodesByFingerprint(*fp);
     for (auto &node : nodes)
     {
@@ -12590,7 +13099,7 @@ MegaNode *MegaApiImpl::getNodeByFingerprint(const char *fingerprint, MegaNode* p
 {
     if(!fingerprint) return NULL;
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     std::shared_ptr<Node> p;
     if(parent)
     {
@@ -12644,7 +13153,7 @@ char *MegaApiImpl::getCRC(MegaNode *n)
 {
     if(!n) return NULL;
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     std::shared_ptr<Node> node = client->nodebyhandle(n->getHandle());
     if(!node || node->type != FILENODE || node->size < 0 || !node->isvalid)
     {
@@ -12765,6 +13274,10 @@ void MegaApiImpl::transfer_complete(Transfer *t)
     MegaTransferPrivate* transfer = getMegaTransferPrivate(t->tag);
     if (transfer)
     {
+        if (t->slot)
+        {
+            transfer->setStats(t->slot->statsReport());
+        }
         transfer->setTransfer(nullptr);
     }
 }
@@ -13281,6 +13794,9 @@ void MegaApiImpl::mediadetection_ready()
 
 void MegaApiImpl::storagesum_changed(int64_t newsum)
 {
+    // the cached account details no longer reflect the real usage
+    mCachedAccountDetails.reset();
+
     MegaEventPrivate *event = new MegaEventPrivate(MegaEvent::EVENT_STORAGE_SUM_CHANGED);
     event->setNumber(newsum);
     fireOnEvent(event);
@@ -13805,6 +14321,9 @@ void MegaApiImpl::useralerts_updated(UserAlert::Base** b, int count)
 
 void MegaApiImpl::account_updated()
 {
+    // plan, status or quota limits may have changed
+    mCachedAccountDetails.reset();
+
     fireOnAccountUpdate();
 }
 
@@ -14534,6 +15053,7 @@ void MegaApiImpl::clearing()
 #ifdef ENABLE_SYNC
     mCachedMegaSyncPrivate.reset();
 #endif
+    mCachedAccountDetails.reset();
 }
 
 void MegaApiImpl::notify_retry(dstime dsdelta, retryreason_t reason)
@@ -15126,7 +15646,10 @@ void MegaApiImpl::nodes_updated(sharedNode_vector* nodes, int count)
     MegaNodeList *nodeList = NULL;
     if (nodes != NULL)
     {
-        nodeList = new MegaNodeListPrivate(*nodes);
+        // one shared snapshot goes to every listener; nodes are only copied
+        // out of it for the entries a listener actually inspects (listeners
+        // that keep data beyond the callback must copy(), as ever)
+        nodeList = new MegaNodeListPrivate(*nodes, true);
         fireOnNodesUpdate(nodeList);
     }
     else
@@ -15156,9 +15679,17 @@ void MegaApiImpl::account_details(AccountDetails*, bool, bool, bool, bool, bool,
     {
         bool storage_requested = request->getNumDetails() & 0x01;
         if (storage_requested && !request->getAccountDetails()->storage_max)
+        {
             fireOnRequestFinish(request, make_unique<MegaErrorPrivate>(MegaError::API_EACCESS));
+        }
         else
+        {
+            // remember the result to answer repeat polls without a round trip
+            mCachedAccountDetails = std::make_shared<AccountDetails>(*request->getAccountDetails());
+            mCachedAccountDetailsFlags = request->getNumDetails();
+            mCachedAccountDetailsTime = Waiter::ds;
             fireOnRequestFinish(request, make_unique<MegaErrorPrivate>(MegaError::API_OK));
+        }
     }
 }
 
@@ -16355,23 +16886,69 @@ bool MegaApiImpl::removeGlobalListener(MegaGlobalListener* listener)
     return globalListeners.erase(listener) > 0;
 }
 
+namespace {
+    // a listener holding up the dispatch loop for this long gets named in the log
+    const uint64_t SLOW_CALLBACK_WARN_US = 100000;
+}
+
+MegaApiImpl::CallbackWatch::CallbackWatch(MegaApiImpl* api, const void* listener, const char* callback)
+    : mApi(api)
+    , mListener(listener)
+    , mCallback(callback)
+    , mStart(std::chrono::steady_clock::now())
+{
+}
+
+MegaApiImpl::CallbackWatch::~CallbackWatch()
+{
+    uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - mStart).count());
+
+    PerfCounters::get().add(PERF_LISTENER_CALLBACKS);
+    PerfCounters::get().add(PERF_LISTENER_TIME_US, static_cast<int64_t>(us));
+
+    {
+        std::lock_guard<std::mutex> g(mApi->listenerStatsMutex);
+        ListenerStats& stats = mApi->listenerStats[mListener];
+        stats.calls++;
+        stats.totalUs += us;
+        if (us > stats.maxUs)
+        {
+            stats.maxUs = us;
+            stats.maxCallback = mCallback;
+        }
+    }
+
+    if (us >= SLOW_CALLBACK_WARN_US)
+    {
+        PerfCounters::get().add(PERF_SLOW_LISTENER_CALLBACKS);
+        LOG_warn << "Slow app listener: " << mCallback << " blocked the dispatch loop for "
+                 << (us / 1000) << " ms (listener " << mListener << ")";
+    }
+}
+
 void MegaApiImpl::fireOnRequestStart(MegaRequestPrivate *request)
 {
     assert(threadId == std::this_thread::get_id());
     LOG_info << client->clientname << "Request (" << request->getRequestString() << ") starting";
     for(set<MegaRequestListener *>::iterator it = requestListeners.begin(); it != requestListeners.end() ;)
     {
-        (*it++)->onRequestStart(api, request);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestStart");
+        listener->onRequestStart(api, request);
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onRequestStart(api, request);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestStart");
+        listener->onRequestStart(api, request);
     }
 
     MegaRequestListener* listener = request->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onRequestStart");
         listener->onRequestStart(api, request);
     }
 }
@@ -16409,17 +16986,22 @@ void MegaApiImpl::fireOnRequestFinish(MegaRequestPrivate *request, unique_ptr<Me
 
     for(set<MegaRequestListener *>::iterator it = requestListeners.begin(); it != requestListeners.end() ;)
     {
-        (*it++)->onRequestFinish(api, request, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestFinish");
+        listener->onRequestFinish(api, request, e.get());
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onRequestFinish(api, request, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestFinish");
+        listener->onRequestFinish(api, request, e.get());
     }
 
     MegaRequestListener* listener = request->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onRequestFinish");
         listener->onRequestFinish(api, request, e.get());
     }
 
@@ -16434,17 +17016,22 @@ void MegaApiImpl::fireOnRequestUpdate(MegaRequestPrivate *request)
 
     for(set<MegaRequestListener *>::iterator it = requestListeners.begin(); it != requestListeners.end() ;)
     {
-        (*it++)->onRequestUpdate(api, request);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestUpdate");
+        listener->onRequestUpdate(api, request);
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onRequestUpdate(api, request);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestUpdate");
+        listener->onRequestUpdate(api, request);
     }
 
     MegaRequestListener* listener = request->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onRequestUpdate");
         listener->onRequestUpdate(api, request);
     }
 }
@@ -16457,17 +17044,22 @@ void MegaApiImpl::fireOnRequestTemporaryError(MegaRequestPrivate *request, uniqu
 
     for(set<MegaRequestListener *>::iterator it = requestListeners.begin(); it != requestListeners.end() ;)
     {
-        (*it++)->onRequestTemporaryError(api, request, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestTemporaryError");
+        listener->onRequestTemporaryError(api, request, e.get());
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onRequestTemporaryError(api, request, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onRequestTemporaryError");
+        listener->onRequestTemporaryError(api, request, e.get());
     }
 
     MegaRequestListener* listener = request->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onRequestTemporaryError");
         listener->onRequestTemporaryError(api, request, e.get());
     }
 }
@@ -16478,19 +17070,30 @@ void MegaApiImpl::fireOnTransferStart(MegaTransferPrivate *transfer)
     notificationNumber++;
     transfer->setNotificationNumber(notificationNumber);
 
+    {
+        // publish the progress counters for lock-free sampling by other threads
+        std::lock_guard<std::mutex> g(transferProgressMutex);
+        transferProgressMap[transfer->getTag()] = transfer->getProgressCounters();
+    }
+
     for(set<MegaTransferListener *>::iterator it = transferListeners.begin(); it != transferListeners.end() ;)
     {
-        (*it++)->onTransferStart(api, transfer);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferStart");
+        listener->onTransferStart(api, transfer);
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onTransferStart(api, transfer);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferStart");
+        listener->onTransferStart(api, transfer);
     }
 
     MegaTransferListener* listener = transfer->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onTransferStart");
         listener->onTransferStart(api, transfer);
     }
 }
@@ -16526,22 +17129,32 @@ void MegaApiImpl::fireOnTransferFinish(MegaTransferPrivate *transfer, unique_ptr
 
     for(set<MegaTransferListener *>::iterator it = transferListeners.begin(); it != transferListeners.end() ;)
     {
-        (*it++)->onTransferFinish(api, transfer, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferFinish");
+        listener->onTransferFinish(api, transfer, e.get());
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onTransferFinish(api, transfer, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferFinish");
+        listener->onTransferFinish(api, transfer, e.get());
     }
 
     MegaTransferListener* listener = transfer->getListener();
     if (listener)
     {
+        CallbackWatch watch(this, listener, "onTransferFinish");
         listener->onTransferFinish(api, transfer, e.get());
     }
 
     transferMap.erase(transfer->getTag());
 
+    {
+        std::lock_guard<std::mutex> g(transferProgressMutex);
+        transferProgressMap.erase(transfer->getTag());
+    }
+
     if (transfer->isStreamingTransfer())
     {
         client->removeAppData(transfer);
@@ -16559,17 +17172,22 @@ void MegaApiImpl::fireOnTransferTemporaryError(MegaTransferPrivate *transfer, un
 
     for(set<MegaTransferListener *>::iterator it = transferListeners.begin(); it != transferListeners.end() ;)
     {
-        (*it++)->onTransferTemporaryError(api, transfer, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferTemporaryError");
+        listener->onTransferTemporaryError(api, transfer, e.get());
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onTransferTemporaryError(api, transfer, e.get());
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferTemporaryError");
+        listener->onTransferTemporaryError(api, transfer, e.get());
     }
 
     MegaTransferListener* listener = transfer->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onTransferTemporaryError");
         listener->onTransferTemporaryError(api, transfer, e.get());
     }
 }
@@ -16587,17 +17205,22 @@ void MegaApiImpl::fireOnTransferUpdate(MegaTransferPrivate *transfer)
 
     for(set<MegaTransferListener *>::iterator it = transferListeners.begin(); it != transferListeners.end() ;)
     {
-        (*it++)->onTransferUpdate(api, transfer);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferUpdate");
+        listener->onTransferUpdate(api, transfer);
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onTransferUpdate(api, transfer);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onTransferUpdate");
+        listener->onTransferUpdate(api, transfer);
     }
 
     MegaTransferListener* listener = transfer->getListener();
     if(listener)
     {
+        CallbackWatch watch(this, listener, "onTransferUpdate");
         listener->onTransferUpdate(api, transfer);
     }
 }
@@ -16644,11 +17267,15 @@ void MegaApiImpl::fireOnUsersUpdate(MegaUserList *users)
 
     for(set<MegaGlobalListener *>::iterator it = globalListeners.begin(); it != globalListeners.end() ;)
     {
-        (*it++)->onUsersUpdate(api, users);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onUsersUpdate");
+        listener->onUsersUpdate(api, users);
     }
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onUsersUpdate(api, users);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onUsersUpdate");
+        listener->onUsersUpdate(api, users);
     }
 }
 
@@ -16658,11 +17285,15 @@ void MegaApiImpl::fireOnUserAlertsUpdate(MegaUserAlertList *userAlerts)
 
     for(set<MegaGlobalListener *>::iterator it = globalListeners.begin(); it != globalListeners.end() ;)
     {
-        (*it++)->onUserAlertsUpdate(api, userAlerts);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onUserAlertsUpdate");
+        listener->onUserAlertsUpdate(api, userAlerts);
     }
     for (set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end();)
     {
-        (*it++)->onUserAlertsUpdate(api, userAlerts);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onUserAlertsUpdate");
+        listener->onUserAlertsUpdate(api, userAlerts);
     }
 }
 
@@ -16672,11 +17303,15 @@ void MegaApiImpl::fireOnContactRequestsUpdate(MegaContactRequestList *requests)
 
     for(set<MegaGlobalListener *>::iterator it = globalListeners.begin(); it != globalListeners.end() ;)
     {
-        (*it++)->onContactRequestsUpdate(api, requests);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onContactRequestsUpdate");
+        listener->onContactRequestsUpdate(api, requests);
     }
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onContactRequestsUpdate(api, requests);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onContactRequestsUpdate");
+        listener->onContactRequestsUpdate(api, requests);
     }
 }
 
@@ -16686,11 +17321,15 @@ void MegaApiImpl::fireOnNodesUpdate(MegaNodeList *nodes)
 
     for(set<MegaGlobalListener *>::iterator it = globalListeners.begin(); it != globalListeners.end() ;)
     {
-        (*it++)->onNodesUpdate(api, nodes);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onNodesUpdate");
+        listener->onNodesUpdate(api, nodes);
     }
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onNodesUpdate(api, nodes);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onNodesUpdate");
+        listener->onNodesUpdate(api, nodes);
     }
 }
 
@@ -16699,11 +17338,15 @@ void MegaApiImpl::fireOnAccountUpdate()
     assert(threadId == std::this_thread::get_id());
     for(set<MegaGlobalListener *>::iterator it = globalListeners.begin(); it != globalListeners.end() ;)
     {
-        (*it++)->onAccountUpdate(api);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onAccountUpdate");
+        listener->onAccountUpdate(api);
     }
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onAccountUpdate(api);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onAccountUpdate");
+        listener->onAccountUpdate(api);
     }
 }
 
@@ -16713,11 +17356,15 @@ void MegaApiImpl::fireOnSetsUpdate(MegaSetList* sets)
 
     for (set<MegaGlobalListener*>::iterator it = globalListeners.begin(); it != globalListeners.end();)
     {
-        (*it++)->onSetsUpdate(api, sets);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onSetsUpdate");
+        listener->onSetsUpdate(api, sets);
     }
     for (set<MegaListener*>::iterator it = listeners.begin(); it != listeners.end();)
     {
-        (*it++)->onSetsUpdate(api, sets);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onSetsUpdate");
+        listener->onSetsUpdate(api, sets);
     }
 }
 
@@ -16727,11 +17374,15 @@ void MegaApiImpl::fireOnSetElementsUpdate(MegaSetElementList* elements)
 
     for (set<MegaGlobalListener*>::iterator it = globalListeners.begin(); it != globalListeners.end();)
     {
-        (*it++)->onSetElementsUpdate(api, elements);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onSetElementsUpdate");
+        listener->onSetElementsUpdate(api, elements);
     }
     for (set<MegaListener*>::iterator it = listeners.begin(); it != listeners.end();)
     {
-        (*it++)->onSetElementsUpdate(api, elements);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onSetElementsUpdate");
+        listener->onSetElementsUpdate(api, elements);
     }
 }
 
@@ -16740,12 +17391,16 @@ void MegaApiImpl::fireOnEvent(MegaEventPrivate *event)
     LOG_debug << "Sending " << event->getEventString() << " to app." << event->getValidDataToString();
     for(set<MegaGlobalListener *>::iterator it = globalListeners.begin(); it != globalListeners.end() ;)
     {
-        (*it++)->onEvent(api, event);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onEvent");
+        listener->onEvent(api, event);
     }
 
     for(set<MegaListener *>::iterator it = listeners.begin(); it != listeners.end() ;)
     {
-        (*it++)->onEvent(api, event);
+        auto* listener = *it++;
+        CallbackWatch watch(this, listener, "onEvent");
+        listener->onEvent(api, event);
     }
 
     delete event;
@@ -17767,7 +18422,7 @@ int MegaApiImpl::getNumChildren(MegaNode* p)
         return 0;
     }
 
-    SdkMutexGuard lock(sdkMutex);
+    SdkReadGuard lock(sdkMutex);
     return static_cast<int>(client->getNumberOfChildren(NodeHandle().set6byte(p->getHandle())));
 }
 
@@ -17778,7 +18433,7 @@ int MegaApiImpl::getNumChildFiles(MegaNode* p)
         return 0;
     }
 
-    SdkMutexGuard lock(sdkMutex);
+    SdkReadGuard lock(sdkMutex);
     std::shared_ptr<Node> parent = client->nodebyhandle(p->getHandle());
     if (!parent || parent->type == FILENODE)
     {
@@ -17795,7 +18450,7 @@ int MegaApiImpl::getNumChildFolders(MegaNode* p)
         return 0;
     }
 
-    SdkMutexGuard lock(sdkMutex);
+    SdkReadGuard lock(sdkMutex);
     std::shared_ptr<Node> parent = client->nodebyhandle(p->getHandle());
     if (!parent || parent->type == FILENODE)
     {
@@ -17806,7 +18461,7 @@ int MegaApiImpl::getNumChildFolders(MegaNode* p)
 }
 
 
-MegaNodeList *MegaApiImpl::getChildren(const MegaSearchFilter* filter, int order, CancelToken cancelToken)
+MegaNodeList *MegaApiImpl::getChildren(const MegaSearchFilter* filter, int order, CancelToken cancelToken, const MegaSearchPage* searchPage)
 {
     // validations
     if (!filter || filter->byLocationHandle() == INVALID_HANDLE ||
@@ -17818,9 +18473,19 @@ MegaNodeList *MegaApiImpl::getChildren(const MegaSearchFilter* filter, int order
 
     NodeSearchFilter nf;
     nf.copyFrom(*filter);
+
+    if (searchPage && order == MegaApi::ORDER_NONE)
+    {
+        // no ordering requested: let the db query skip and limit the rows
+        sharedNode_vector results = client->mNodeManager.getChildren(nf, cancelToken,
+            NodeSearchPage(searchPage->startingOffset(), searchPage->size()));
+        return new MegaNodeListPrivate(results);
+    }
+
     sharedNode_vector results = client->mNodeManager.getChildren(nf, cancelToken);
 
     sortByComparatorFunction(results, order, *client);
+    applySearchPage(results, searchPage);
     return new MegaNodeListPrivate(results);
 }
 
@@ -17833,7 +18498,7 @@ MegaNodeList *MegaApiImpl::getChildren(const MegaNode* p, int order, CancelToken
 
     sharedNode_vector childrenNodes;
 
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
 
     std::shared_ptr<Node> parent = client->nodebyhandle(p->getHandle());
     if (parent && parent->type != FILENODE)
@@ -17853,7 +18518,7 @@ MegaNodeList *MegaApiImpl::getChildren(const MegaNode* p, int order, CancelToken
 
 MegaNodeList *MegaApiImpl::getChildren(MegaNodeList *parentNodes, int order)
 {
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
 
     // prepare a vector with children of every parent node all together
     sharedNode_vector childrenNodes;
@@ -17882,13 +18547,85 @@ MegaNodeList *MegaApiImpl::getChildren(MegaNodeList *parentNodes, int order)
     return new MegaNodeListPrivate(childrenNodes);
 }
 
-sharedNode_vector NodeManager::getChildren(const NodeSearchFilter& filter, CancelToken cancelFlag)
+void MegaApiImpl::prefetchNode(MegaNode* node)
+{
+    if (!node || node->getType() == MegaNode::TYPE_FILE)
+    {
+        return;
+    }
+
+    MegaHandle h = node->getHandle();
+
+    CancelToken token;
+    {
+        std::lock_guard<std::mutex> g(mPrefetchMutex);
+        token = mPrefetchToken;
+    }
+
+    // discardable: a hint that never runs was just a missed optimization
+    client->mAsyncQueue.push([this, h, token](SymmCipher&)
+    {
+        if (token.isCancelled())
+        {
+            return; // navigation moved elsewhere before we were scheduled
+        }
+
+        SdkReadGuard guard(sdkMutex);
+
+        std::shared_ptr<Node> parent = client->nodebyhandle(h);
+        if (parent && parent->type != FILENODE)
+        {
+            // loading the child list is enough: NodeManager keeps the nodes
+            // cached in memory for the real navigation that follows
+            client->getChildren(parent.get(), token);
+        }
+    }, true);
+}
+
+#ifdef ENABLE_CHAT
+void MegaApiImpl::prefetchChat(MegaHandle chatid)
+{
+    CancelToken token;
+    {
+        std::lock_guard<std::mutex> g(mPrefetchMutex);
+        token = mPrefetchToken;
+    }
+
+    client->mAsyncQueue.push([this, chatid, token](SymmCipher&)
+    {
+        if (token.isCancelled())
+        {
+            return;
+        }
+
+        SdkMutexGuard g(sdkMutex); // hydration mutates the chat
+
+        textchat_map::iterator it = client->chats.find(chatid);
+        if (it != client->chats.end())
+        {
+            // touching the lazily-parsed state hydrates attachments and
+            // scheduled meetings now instead of when the chat is opened
+            it->second->getAttachments();
+            it->second->getSchedMeetings();
+        }
+    }, true);
+}
+#endif
+
+void MegaApiImpl::cancelPrefetch()
+{
+    std::lock_guard<std::mutex> g(mPrefetchMutex);
+    mPrefetchToken.cancel();
+    mPrefetchToken = CancelToken(false);
+}
+
+sharedNode_vector NodeManager::getChildren(const NodeSearchFilter& filter, CancelToken cancelFlag, const NodeSearchPage& page)
 {
     LockGuard g(mMutex);
-    return getChildren_internal(filter, cancelFlag);
+    return getChildren_internal(filter, cancelFlag, page);
 }
 
-sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filter, CancelToken cancelFlag)
+sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filter, CancelToken cancelFlag, const NodeSearchPage& page)
 {
     assert(mMutex.owns_lock());
 
@@ -17911,7 +18648,7 @@ sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filt
 
     // db look-up
     vector<pair<NodeHandle, NodeSerialized>> nodesFromTable;
-    if (!mTable->getChildren(filter, nodesFromTable, cancelFlag))
+    if (!mTable->getChildren(filter, page, nodesFromTable, cancelFlag))
     {
         return sharedNode_vector();
     }
@@ -17981,7 +18718,7 @@ MegaNodeList* MegaApiImpl::getChildrenFromType(MegaNode* p, int type, int order,
         return new MegaNodeListPrivate();
     }
 
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
 
     sharedNode_vector childrenNodes = client->mNodeManager.getChildrenFromType(NodeHandle().set6byte(p->getHandle()), static_cast<nodetype_t>(type), cancelToken);
     sortByComparatorFunction(childrenNodes, order, *client);
@@ -18048,7 +18785,7 @@ std::shared_ptr<Node> MegaApiImpl::getNodeByFingerprintInternal(const char *fing
         return NULL;
     }
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     return client->mNodeManager.getNodeByFingerprint(*fp);
 }
 
@@ -18061,7 +18798,7 @@ std::shared_ptr<Node> MegaApiImpl::getNodeByFingerprintInternal(const char *fing
     }
 
     std::shared_ptr<Node> n = NULL;
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     sharedNode_vector nodes = client->mNodeManager.getNodesByFingerprint(*fp);
     if (nodes.size())
     {
@@ -18106,7 +18843,7 @@ MegaNode* MegaApiImpl::getParentNode(MegaNode* n)
 {
     if(!n) return NULL;
 
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     std::shared_ptr<Node> node = client->nodebyhandle(n->getHandle());
     if(!node)
     {
@@ -18120,7 +18857,7 @@ char* MegaApiImpl::getNodePath(MegaNode *node)
 {
     if(!node) return nullptr;
 
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
     std::shared_ptr<Node> n = client->nodebyhandle(node->getHandle());
     if(!n)
     {
@@ -18131,7 +18868,7 @@ char* MegaApiImpl::getNodePath(MegaNode *node)
 
 char* MegaApiImpl::getNodePathByNodeHandle(MegaHandle handle)
 {
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
     std::shared_ptr<Node> n = client->nodebyhandle(handle);
     if(!n)
     {
@@ -18142,7 +18879,7 @@ char* MegaApiImpl::getNodePathByNodeHandle(MegaHandle handle)
 
 MegaNode* MegaApiImpl::getNodeByPath(const char *path, MegaNode* node)
 {
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
 
     std::shared_ptr<Node> root = nullptr;
 
@@ -18162,7 +18899,7 @@ MegaNode* MegaApiImpl::getNodeByPath(const char *path, MegaNode* node)
 
 MegaNode* MegaApiImpl::getNodeByPathOfType(const char* path, MegaNode* node, int type)
 {
-    SdkMutexGuard guard(sdkMutex);
+    SdkReadGuard guard(sdkMutex);
 
     std::shared_ptr<Node> root = nullptr;
 
@@ -18185,7 +18922,7 @@ MegaNode* MegaApiImpl::getNodeByPathOfType(const char* path, MegaNode* node, int
 MegaNode* MegaApiImpl::getNodeByHandle(handle handle)
 {
     if(handle == UNDEF) return NULL;
-    SdkMutexGuard g(sdkMutex);
+    SdkReadGuard g(sdkMutex);
     return MegaNodePrivate::fromNode(client->nodebyhandle(handle).get());
 }
 
@@ -18590,6 +19327,7 @@ unsigned MegaApiImpl::sendPendingTransfers(TransferQueue *queue, MegaRecursiveOp
 
                     f->setTransfer(transfer); // sets internal `megaTransfer`, different from internal `transfer`!
                     f->cancelToken = transfer->accessCancelToken();
+                    f->forceNewUpload = transfer->isForceNewUpload(); // so startxfer won't satisfy a forced upload by cloning
 
                     error result = API_OK;
                     bool started = client->startxfer(PUT, f, committer, true, startFirst, transfer->isBackupTransfer(), UseLocalVersioningFlag, &result, nextTag);
@@ -19175,6 +19913,48 @@ void MegaApiImpl::sendPendingRequests()
             }
         }
 
+        if (request->performReadOnlyRequest)
+        {
+            // read-scoped: run on a client worker thread under the shared SDK
+            // lock, concurrently with other read-scoped requests, so CPU-heavy
+            // look-ups don't stall the request pipeline behind them. With no
+            // worker threads configured the body executes inline instead
+            MegaRequestPrivate* readRequest = request;
+            int readRequestTag = request->getTag();
+            client->mAsyncQueue.push([this, readRequest, readRequestTag](SymmCipher&)
+            {
+                SdkReadGuard rg(sdkMutex);
+
+                // the request may have been finished and deleted while this job
+                // was queued (abortPendingActions fires failure on everything in
+                // requestMap on logout); requestMap only changes under the
+                // exclusive lock, so this shared-locked check is conclusive
+                auto it = requestMap.find(readRequestTag);
+                if (it == requestMap.end() || it->second != readRequest)
+                {
+                    return;
+                }
+
+                error err = readRequest->performReadOnlyRequest();
+                if (err)
+                {
+                    LOG_err << "Error running read-scoped request: " << err;
+                }
+
+                // completion must fire on the SDK thread (fireOnRequestFinish
+                // only sanctions the sync thread as a cross-thread caller), so
+                // marshal it back through requestQueue like the sync thread does
+                auto ePtr = new MegaErrorPrivate(err);
+                readRequest->performFireOnRequestFinish = [this, readRequest, ePtr]()
+                {
+                    fireOnRequestFinish(readRequest, std::unique_ptr<MegaErrorPrivate>(ePtr));
+                };
+                requestQueue.push(readRequest);
+                waiter->notify();
+            }, false);
+            continue;
+        }
+
         if (request->performRequest)
         {
             // the action should result in request destruction via fireOnRequestFinish
@@ -20360,6 +21140,18 @@ void MegaApiImpl::getAccountDetails(bool storage, bool transfer, bool pro, bool
             }
             request->setNumber(numReqs);
 
+            // answer the poll locally when every requested category is covered
+            // by a fresh fetch that no actionpacket has invalidated since
+            if (mCachedAccountDetails
+                    && (numDetails & ~mCachedAccountDetailsFlags) == 0
+                    && Waiter::ds - mCachedAccountDetailsTime < MAXACCOUNTDETAILSAGE)
+            {
+                LOG_debug << "Answering account details request from cache";
+                *request->getAccountDetails() = *mCachedAccountDetails;
+                fireOnRequestFinish(request, make_unique<MegaErrorPrivate>(API_OK));
+                return API_OK;
+            }
+
             client->getaccountdetails(request->getAccountDetails(), storage, transfer, pro, transactions, purchases, sessions, request->getAccess());
             return API_OK;
         };
@@ -24284,7 +25076,8 @@ void MegaApiImpl::getFolderInfo(MegaNode* node, MegaRequestListener* listener)
         request->setNodeHandle(node->getHandle());
     }
 
-    request->performRequest = [this, request]()
+    // counting a large tree is CPU-bound and touches nothing writable
+    request->performReadOnlyRequest = [this, request]()
         {
             MegaHandle h = request->getNodeHandle();
             if (ISUNDEF(h))
@@ -24306,8 +25099,6 @@ void MegaApiImpl::getFolderInfo(MegaNode* node, MegaRequestListener* listener)
             NodeCounter nc = node->getCounter();
             std::unique_ptr<MegaFolderInfo> folderInfo = make_unique<MegaFolderInfoPrivate>((int)nc.files, (int)nc.folders, (int)nc.versions, nc.storage, nc.versionStorage);
             request->setMegaFolderInfo(folderInfo.get());
-
-            fireOnRequestFinish(request, make_unique<MegaErrorPrivate>(API_OK));
             return API_OK;
         };
 
@@ -25265,6 +26056,26 @@ void MegaApiImpl::setLRUCacheSize(unsigned long long size)
     client->mNodeManager.setCacheLRUMaxSize(size);
 }
 
+void MegaApiImpl::setLRUCacheMaxBytes(unsigned long long maxBytes)
+{
+    client->mNodeManager.setCacheLRUMaxBytes(maxBytes);
+}
+
+unsigned long long MegaApiImpl::getLRUCacheHits()
+{
+    return client->mNodeManager.getCacheLRUHits();
+}
+
+unsigned long long MegaApiImpl::getLRUCacheMisses()
+{
+    return client->mNodeManager.getCacheLRUMisses();
+}
+
+void MegaApiImpl::setChildrenPrefetchEnabled(bool enable)
+{
+    client->mNodeManager.enableChildPrefetch(enable);
+}
+
 long long MegaApiImpl::getTotalDownloadedBytes()
 {
     return totalDownloadedBytes;
@@ -26339,6 +27150,18 @@ void TransferQueue::push(MegaTransferPrivate *transfer)
     transfer->setPlaceInQueue(++lastPushedTransferTag);
 }
 
+void TransferQueue::pushAll(const std::vector<MegaTransferPrivate *>& batch)
+{
+    // one lock acquisition for the whole batch, so queueing many thousands of
+    // transfers doesn't contend with the SDK thread once per file
+    std::lock_guard<std::mutex> g(mutex);
+    for (MegaTransferPrivate* transfer : batch)
+    {
+        transfers.push_back(transfer);
+        transfer->setPlaceInQueue(++lastPushedTransferTag);
+    }
+}
+
 void TransferQueue::push_front(MegaTransferPrivate *transfer)
 {
     std::lock_guard<std::mutex> g(mutex);
@@ -26379,8 +27202,13 @@ std::vector<MegaTransferPrivate *> TransferQueue::popUpTo(int lastQueuedTransfer
 {
     std::lock_guard<std::mutex> g(mutex);
     std::vector<MegaTransferPrivate*> toret;
-    for (auto it = transfers.begin(); it != transfers.end();)
+    for (auto it = transfers.begin(true); it != transfers.end(true); ++it)
     {
+        if (it->isErased())
+        {
+            continue;
+        }
+
         MegaTransferPrivate *transfer = *it;
         if (transfer->getPlaceInQueue() > lastQueuedTransfer)
         {
@@ -26390,11 +27218,7 @@ std::vector<MegaTransferPrivate *> TransferQueue::popUpTo(int lastQueuedTransfer
         if (!transfer->isSyncTransfer() && transfer->getType() == direction)
         {
             toret.push_back(transfer);
-            it = transfers.erase(it);
-        }
-        else
-        {
-            it++;
+            transfers.erase(it);
         }
     }
     return toret;
@@ -26409,19 +27233,21 @@ void TransferQueue::removeWithFolderTag(int folderTag, std::function<void(MegaTr
     // may have been locked during other MegaApi function calls.
     std::lock_guard<std::mutex> g(mutex);
 
-    for (auto it = transfers.begin(); it != transfers.end();)
+    for (auto it = transfers.begin(true); it != transfers.end(true); ++it)
     {
-        if ((*it)->getFolderTransferTag() == folderTag)
+        if (it->isErased())
+        {
+            continue;
+        }
+
+        MegaTransferPrivate* transfer = *it;
+        if (transfer->getFolderTransferTag() == folderTag)
         {
             if (callback)
             {
-                callback(*it);
+                callback(transfer);
             }
-            it = transfers.erase(it);
-        }
-        else
-        {
-            it++;
+            transfers.erase(it);
         }
     }
 }
@@ -26430,21 +27256,20 @@ void TransferQueue::removeListener(MegaTransferListener *listener)
 {
     std::lock_guard<std::mutex> g(mutex);
 
-    std::deque<MegaTransferPrivate *>::iterator it = transfers.begin();
-    while(it != transfers.end())
+    for (auto it = transfers.begin(); it != transfers.end(); ++it)
     {
         MegaTransferPrivate *transfer = (*it);
         if(transfer->getListener() == listener)
             transfer->setListener(NULL);
-        it++;
     }
 }
 
 void TransferQueue::setAllCancelled(CancelToken cancelled, int direction)
 {
     std::lock_guard<std::mutex> g(mutex);
-    for (auto& t : transfers)
+    for (auto it = transfers.begin(); it != transfers.end(); ++it)
     {
+        MegaTransferPrivate* t = *it;
         if (t->getType() == direction
             && !t->isSyncTransfer()
             && !t->isStreamingTransfer())
@@ -26458,21 +27283,65 @@ RequestQueue::RequestQueue()
 {
 }
 
+void RequestQueue::pushNode(MegaRequestPrivate* request, bool atFront)
+{
+    QueuedRequest* node = new QueuedRequest{request, incoming.load(std::memory_order_relaxed), atFront};
+
+    // standard lock-free list push; on failure node->next was refreshed
+    // with the current head
+    while (!incoming.compare_exchange_weak(node->next, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+    {
+    }
+}
+
+void RequestQueue::drainIncoming()
+{
+    QueuedRequest* node = incoming.exchange(nullptr, std::memory_order_acquire);
+
+    // the list is newest first: reverse it so it can be applied in
+    // submission order
+    QueuedRequest* reversed = nullptr;
+    while (node)
+    {
+        QueuedRequest* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+
+    while (reversed)
+    {
+        if (reversed->atFront)
+        {
+            // part of a request already being processed: overtake the queue
+            requests.push_front(reversed->request);
+        }
+        else
+        {
+            requests.push_back(reversed->request);
+        }
+
+        QueuedRequest* done = reversed;
+        reversed = reversed->next;
+        delete done;
+    }
+}
+
 void RequestQueue::push(MegaRequestPrivate *request)
 {
-    std::lock_guard<std::mutex> g(mutex);
-    requests.push_back(request);
+    pushNode(request, false);
 }
 
 void RequestQueue::push_front(MegaRequestPrivate *request)
 {
-    std::lock_guard<std::mutex> g(mutex);
-    requests.push_front(request);
+    pushNode(request, true);
 }
 
 MegaRequestPrivate *RequestQueue::pop()
 {
-    std::lock_guard<std::mutex> g(mutex);
+    drainIncoming();
     if(requests.empty())
     {
         return NULL;
@@ -26482,9 +27351,14 @@ MegaRequestPrivate *RequestQueue::pop()
     return request;
 }
 
+bool RequestQueue::hasPending()
+{
+    return incoming.load(std::memory_order_acquire) || !requests.empty();
+}
+
 MegaRequestPrivate *RequestQueue::front()
 {
-    std::lock_guard<std::mutex> g(mutex);
+    drainIncoming();
     if(requests.empty())
     {
         return NULL;
@@ -26495,7 +27369,7 @@ MegaRequestPrivate *RequestQueue::front()
 
 void RequestQueue::removeListener(MegaRequestListener *listener)
 {
-    std::lock_guard<std::mutex> g(mutex);
+    drainIncoming();
 
     std::deque<MegaRequestPrivate *>::iterator it = requests.begin();
     while(it != requests.end())
@@ -26509,7 +27383,7 @@ void RequestQueue::removeListener(MegaRequestListener *listener)
 
 void RequestQueue::removeListener(MegaScheduledCopyListener *listener)
 {
-    std::lock_guard<std::mutex> g(mutex);
+    drainIncoming();
 
     std::deque<MegaRequestPrivate *>::iterator it = requests.begin();
     while(it != requests.end())
@@ -29830,6 +30704,37 @@ uv_buf_t StreamingBuffer::nextBuffer()
     return uv_buf_init(outbuf, (unsigned int)(len));
 }
 
+unsigned StreamingBuffer::nextBuffers(uv_buf_t (&bufs)[2])
+{
+    if (!size)
+    {
+        // no data available
+        return 0;
+    }
+
+    // prepare output buffers, splitting at the wrap point instead of truncating
+    size_t len = size < maxOutputSize ? size : maxOutputSize;
+    size_t firstLen = len;
+    unsigned count = 1;
+    if (outpos + len > capacity)
+    {
+        firstLen = capacity - outpos;
+        bufs[1] = uv_buf_init(buffer, (unsigned int)(len - firstLen));
+        count = 2;
+        LOG_debug << "[Streaming] Available length exceeds limits of circular buffer: "
+                    << "Adding a second output buffer of " << (len - firstLen) << " bytes from the beginning"
+                    << " [outpos = " << outpos << ", len = " << len << ", capacity = " << capacity << "]";
+    }
+    bufs[0] = uv_buf_init(buffer + outpos, (unsigned int)firstLen);
+
+    // update the internal state
+    size -= len;
+    outpos += len;
+    outpos %= capacity;
+
+    return count;
+}
+
 void StreamingBuffer::freeData(size_t len)
 {
     LOG_verbose << "[Streaming] Streaming buffer free data: len = " << len << ", actual free = " << free << ", new free = " << (free+len) << ", size = " << size << " [capacity = " << capacity << "]";
@@ -32671,10 +33576,7 @@ void MegaHTTPServer::sendHeaders(MegaHTTPContext *httpctx, string *headers)
 {
     LOG_debug << "Response headers: " << *headers;
     httpctx->streamingBuffer.append(headers->data(), headers->size());
-    uv_buf_t resbuf = httpctx->streamingBuffer.nextBuffer();
     httpctx->size += headers->size();
-    httpctx->lastBuffer = resbuf.base;
-    httpctx->lastBufferLen = resbuf.len;
 
     if (httpctx->transfer)
     {
@@ -32685,6 +33587,10 @@ void MegaHTTPServer::sendHeaders(MegaHTTPContext *httpctx, string *headers)
 #ifdef ENABLE_EVT_TLS
     if (httpctx->server->useTLS)
     {
+        uv_buf_t resbuf = httpctx->streamingBuffer.nextBuffer();
+        httpctx->lastBuffer = resbuf.base;
+        httpctx->lastBufferLen = resbuf.len;
+
         assert (resbuf.len);
         int err = evt_tls_write(httpctx->evt_tls, resbuf.base, resbuf.len, onWriteFinished_tls);
         if (err <= 0)
@@ -32696,9 +33602,18 @@ void MegaHTTPServer::sendHeaders(MegaHTTPContext *httpctx, string *headers)
     else
     {
 #endif
+        uv_buf_t resbufs[2] = { uv_buf_init(NULL, 0), uv_buf_init(NULL, 0) };
+        unsigned nbufs = httpctx->streamingBuffer.nextBuffers(resbufs);
+        if (!nbufs)
+        {
+            nbufs = 1;
+        }
+        httpctx->lastBuffer = resbufs[0].base;
+        httpctx->lastBufferLen = resbufs[0].len + (nbufs > 1 ? resbufs[1].len : 0);
+
         uv_write_t *req = new uv_write_t();
         req->data = httpctx;
-        if (int err = uv_write(req, (uv_stream_t*)&httpctx->tcphandle, &resbuf, 1, onWriteFinished))
+        if (int err = uv_write(req, (uv_stream_t*)&httpctx->tcphandle, resbufs, nbufs, onWriteFinished))
         {
             delete req;
             LOG_warn << "Finishing due to an error sending the response: " << err;
@@ -32789,23 +33704,23 @@ void MegaHTTPServer::sendNextBytes(MegaHTTPContext *httpctx)
         return;
     }
 
-    uv_buf_t resbuf = httpctx->streamingBuffer.nextBuffer();
-    uv_mutex_unlock(&httpctx->mutex);
-
-    if (!resbuf.len)
-    {
-        LOG_debug << "[Streaming] Skipping write. No data available. " << httpctx->streamingBuffer.bufferStatus();
-        return;
-    }
-
-    LOG_verbose << "Writing " << resbuf.len << " bytes";
-    httpctx->rangeWritten += resbuf.len;
-    httpctx->lastBuffer = resbuf.base;
-    httpctx->lastBufferLen = resbuf.len;
-
 #ifdef ENABLE_EVT_TLS
     if (httpctx->server->useTLS)
     {
+        uv_buf_t resbuf = httpctx->streamingBuffer.nextBuffer();
+        uv_mutex_unlock(&httpctx->mutex);
+
+        if (!resbuf.len)
+        {
+            LOG_debug << "[Streaming] Skipping write. No data available. " << httpctx->streamingBuffer.bufferStatus();
+            return;
+        }
+
+        LOG_verbose << "Writing " << resbuf.len << " bytes";
+        httpctx->rangeWritten += resbuf.len;
+        httpctx->lastBuffer = resbuf.base;
+        httpctx->lastBufferLen = resbuf.len;
+
         //notice this, contrary to !useTLS is synchronous
         int err = evt_tls_write(httpctx->evt_tls, resbuf.base, resbuf.len, onWriteFinished_tls);
         if (err <= 0)
@@ -32817,10 +33732,28 @@ void MegaHTTPServer::sendNextBytes(MegaHTTPContext *httpctx)
     else
     {
 #endif
+        // hand both segments of a wrapped ring to one scatter-gather write,
+        // so the wrap point neither truncates the write nor costs a copy
+        uv_buf_t resbufs[2];
+        unsigned nbufs = httpctx->streamingBuffer.nextBuffers(resbufs);
+        uv_mutex_unlock(&httpctx->mutex);
+
+        if (!nbufs)
+        {
+            LOG_debug << "[Streaming] Skipping write. No data available. " << httpctx->streamingBuffer.bufferStatus();
+            return;
+        }
+
+        size_t len = resbufs[0].len + (nbufs > 1 ? resbufs[1].len : 0);
+        LOG_verbose << "Writing " << len << " bytes";
+        httpctx->rangeWritten += len;
+        httpctx->lastBuffer = resbufs[0].base;
+        httpctx->lastBufferLen = len;
+
         uv_write_t *req = new uv_write_t();
         req->data = httpctx;
 
-        if (int err = uv_write(req, (uv_stream_t*)&httpctx->tcphandle, &resbuf, 1, onWriteFinished))
+        if (int err = uv_write(req, (uv_stream_t*)&httpctx->tcphandle, resbufs, nbufs, onWriteFinished))
         {
             delete req;
             LOG_warn << "[Streaming] Finishing due to an error in uv_write: " << err;
@@ -36276,18 +37209,19 @@ void MegaEventPrivate::setHandle(const MegaHandle &handle)
 }
 
 MegaHandleListPrivate::MegaHandleListPrivate()
+    : mList(std::make_shared<std::vector<MegaHandle>>())
 {
-
 }
 
 MegaHandleListPrivate::MegaHandleListPrivate(const MegaHandleListPrivate *hList)
 {
+    // shares the backing buffer; a later addMegaHandle() detaches it
     mList = hList->mList;
 }
 
 MegaHandleListPrivate::MegaHandleListPrivate(const vector<handle> &handles)
+    : mList(std::make_shared<std::vector<MegaHandle>>(handles.begin(), handles.end()))
 {
-    mList = handles;
 }
 
 MegaHandleListPrivate::~MegaHandleListPrivate()
@@ -36304,9 +37238,9 @@ MegaHandle MegaHandleListPrivate::get(unsigned int i) const
 {
     MegaHandle h = INVALID_HANDLE;
 
-    if (i < mList.size())
+    if (i < mList->size())
     {
-        h = mList.at(i);
+        h = mList->at(i);
     }
 
     return h;
@@ -36314,12 +37248,17 @@ MegaHandle MegaHandleListPrivate::get(unsigned int i) const
 
 unsigned int MegaHandleListPrivate::size() const
 {
-    return unsigned(mList.size());
+    return unsigned(mList->size());
 }
 
 void MegaHandleListPrivate::addMegaHandle(MegaHandle h)
 {
-    mList.push_back(h);
+    if (mList.use_count() > 1)
+    {
+        // shared with a copy: detach before mutating
+        mList = std::make_shared<std::vector<MegaHandle>>(*mList);
+    }
+    mList->push_back(h);
 }
 
 MegaIntegerListPrivate::MegaIntegerListPrivate(const vector<int8_t>& bytesList)
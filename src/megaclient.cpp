@@ -79,6 +79,9 @@ const int MegaClient::MAXQUEUEDFA = 30;
 // maximum number of concurrent putfa
 const int MegaClient::MAXPUTFA = 10;
 
+// maximum number of putfa upload URL requests activated together
+const int MegaClient::MAXPUTFABATCH = 64;
+
 #ifdef ENABLE_SYNC
 // //bin/SyncDebris/yyyy-mm-dd base folder name
 const char* const MegaClient::SYNCDEBRISFOLDERNAME = "SyncDebris";
@@ -568,6 +571,7 @@ void MegaClient::mergenewshare(NewShare *s, bool notify, bool skipWriteInDb)
             if (n->inshare)
             {
                 n->inshare->user->sharing.erase(n->nodehandle);
+                n->inshare->user->changed.sharing = true;
                 notifyuser(n->inshare->user);
                 n->inshare.reset();
             }
@@ -702,6 +706,7 @@ void MegaClient::mergenewshare(NewShare *s, bool notify, bool skipWriteInDb)
                         {
                             n->inshare.reset(new Share(finduser(s->peer, 1), s->access, s->ts, NULL));
                             n->inshare->user->sharing.insert(n->nodehandle);
+                            n->inshare->user->changed.sharing = true;
                         }
 
                         if (notify)
@@ -1050,20 +1055,27 @@ bool MegaClient::isValidFolderLink()
     return false;
 }
 
-shared_ptr<Node> MegaClient::getrootnode(shared_ptr<Node> node)
+shared_ptr<Node> MegaClient::getrootnode(const shared_ptr<Node>& node)
 {
     if (!node)
     {
         return NULL;
     }
 
-    std::shared_ptr<Node> n = node;
+    // raw-pointer hops: 'node' pins its whole ancestor chain (each node holds
+    // a strong ref to its parent), so no refcount churn is needed per level
+    Node* n = node.get();
     while (n->parent)
     {
-        n = n->parent;
+        n = n->parent.get();
+    }
+
+    if (n == node.get())
+    {
+        return node;
     }
 
-    return n;
+    return n->mNodePosition->second.getNodeInRam();
 }
 
 bool MegaClient::isPrivateNode(NodeHandle h)
@@ -1886,6 +1898,8 @@ std::string MegaClient::getWritableLinkAuthKey(handle nodeHandle)
 void MegaClient::exec()
 {
     CodeCounter::ScopeTimer ccst(performanceStats.execFunction);
+    MEGA_TRACE_SCOPE("MegaClient::exec");
+    StallSamplerPass samplerPass(stallSampler);
 
     WAIT_CLASS::bumpds();
 
@@ -2030,6 +2044,17 @@ void MegaClient::exec()
         // file attribute puts (handled sequentially as a FIFO)
         if (activefa.size())
         {
+            // URL acquisition is batched for the whole burst; the data POSTs
+            // behind those URLs are limited to MAXPUTFA at a time
+            int inflightfa = 0;
+            for (auto& fa : activefa)
+            {
+                if (static_cast<reqstatus_t>(fa->status) == REQ_INFLIGHT)
+                {
+                    inflightfa++;
+                }
+            }
+
             TransferDbCommitter committer(tctable);
             auto curfa = activefa.begin();
             while (curfa != activefa.end())
@@ -2057,6 +2082,13 @@ void MegaClient::exec()
                             // remove from list
                             handle fah = MemAccess::get<handle>(fa->in.data());
 
+                            // seed the durable cache with the attribute just
+                            // stored; it is already in encrypted wire form
+                            if (const string* faData = fa->encryptedData())
+                            {
+                                facache.put(fah, fa->type, faData->data(), unsigned(faData->size()));
+                            }
+
                             if (fa->th.isUndef())
                             {
                                 // client app requested the upload without a node yet, and it will use the fa handle
@@ -2142,6 +2174,16 @@ void MegaClient::exec()
                         faretrying = true;
                         break;
 
+                    case REQ_PREPARED:
+                        // upload URL received (batched with the rest of the
+                        // burst); start the data POST when a slot is free
+                        if (inflightfa < MAXPUTFA)
+                        {
+                            fa->postfadata(this);
+                            inflightfa++;
+                        }
+                        break;
+
                     case REQ_INFLIGHT:
                         // check if the transfer/file was cancelled while we were waiting for fa response (only for file uploads, not Node updates or app-requested fa put)
                         if (!fa->th.isNodeHandle())
@@ -2269,6 +2311,7 @@ void MegaClient::exec()
                         // fetches pending for this unconnected channel - dispatch fresh connection
                         LOG_debug << "Getting fresh download URL";
                         fc->timeout.reset();
+                        fc->urlfetching = true;
                         reqs.add(new CommandGetFA(this, cit->first, fc->fahref));
                         fc->req.status = REQ_INFLIGHT;
                     }
@@ -2279,10 +2322,23 @@ void MegaClient::exec()
                         fc->dispatch();
                     }
                 }
+                else if (fc->req.status == REQ_INFLIGHT && fc->req.httpio && !fc->urlfetching
+                         && fc->fafs[0].size()
+                         && (!fc->urltime || (Waiter::ds - fc->urltime) > 600))
+                {
+                    // fetches queued up behind an active transfer and the URL
+                    // will be stale by the time it finishes: refresh it in
+                    // parallel so the next batch goes out the moment the
+                    // channel frees up, instead of paying a cs round trip then
+                    LOG_debug << "Prefetching fresh download URL";
+                    fc->urlfetching = true;
+                    reqs.add(new CommandGetFA(this, cit->first, fc->fahref));
+                }
             }
         }
 
         // handle API client-server requests
+        bool csResponseReceived = false;
         for (;;)
         {
             // do we have an API request outstanding?
@@ -2294,6 +2350,11 @@ void MegaClient::exec()
                 if (pendingcs->status == REQ_SUCCESS || pendingcs->status == REQ_FAILURE)
                 {
                     performanceStats.csRequestWaitTime.stop();
+                    PerfCounters::get().sub(PERF_CS_INFLIGHT);
+                    if (pendingcs->status == REQ_SUCCESS && WireCapture::get().capturing())
+                    {
+                        WireCapture::get().record("cs", "in", string(), pendingcs->in);
+                    }
                 }
 
                 switch (static_cast<reqstatus_t>(pendingcs->status))
@@ -2333,6 +2394,9 @@ void MegaClient::exec()
                         abortlockrequest();
                         app->request_response_progress(pendingcs->bufpos, -1);
 
+                        // chunked requests defer purges; 'in' is read directly below
+                        pendingcs->flushinpurge();
+
                         if ((!pendingcs->mChunked && pendingcs->in != "-3" && pendingcs->in != "-4")
                             || (pendingcs->mChunked && (reqs.chunkedProgress() || (pendingcs->in != "-3" && pendingcs->in != "-4"))))
                         {
@@ -2340,6 +2404,7 @@ void MegaClient::exec()
                                 || (pendingcs->mChunked && (reqs.chunkedProgress() || *pendingcs->in.c_str() == '[' || pendingcs->in.empty())))
                             {
                                 CodeCounter::ScopeTimer ccst(performanceStats.csSuccessProcessingTime);
+                                StallSamplerPhase ssp(stallSampler, StallSampler::PHASE_CS_RESPONSE);
 
                                 if (fetchingnodes && fnstats.timeToFirstByte == NEVER)
                                 {
@@ -2355,8 +2420,10 @@ void MegaClient::exec()
 
                                 if (!pendingcs->mChunked)
                                 {
-                                    // request succeeded, process result array
-                                    reqs.serverresponse(std::move(pendingcs->in), this);
+                                    // request succeeded; queue the result array. It is
+                                    // processed after the next batch (if one is ready) has
+                                    // been put on the wire, overlapping that round trip
+                                    reqs.queueResponse(std::move(pendingcs->in));
                                 }
                                 else
                                 {
@@ -2370,28 +2437,12 @@ void MegaClient::exec()
                                     assert(!reqs.chunkedProgress());
                                 }
 
+                                csResponseReceived = true;
+
                                 WAIT_CLASS::bumpds();
 
                                 delete pendingcs;
                                 pendingcs = NULL;
-
-                                notifypurge();
-                                if (sctable && pendingsccommit && !reqs.readyToSend() && scsn.ready())
-                                {
-                                    LOG_debug << "Executing postponed DB commit 2 (sessionid: " << string(sessionid, sizeof(sessionid)) << ")";
-                                    sctable->commit();
-                                    assert(!sctable->inTransaction());
-                                    sctable->begin();
-                                    app->notify_dbcommit();
-                                    pendingsccommit = false;
-                                }
-
-                                if (auto completion = std::move(mOnCSCompletion))
-                                {
-                                    LOG_debug << "calling mOnCSCompletion after request reply processing";  // track possible lack of logout callbacks
-                                    assert(mOnCSCompletion == nullptr);
-                                    completion(this);
-                                }
                             }
                             else
                             {
@@ -2515,6 +2566,7 @@ void MegaClient::exec()
                         if (!reason) reason = RETRY_UNKNOWN;
 
                         btcs.backoff();
+                        retryTelemetry.record(RetryTelemetry::ENDPOINT_CS, reason, btcs.retryin());
                         app->notify_retry(btcs.retryin(), reason);
                         csretrying = true;
                         LOG_warn << "Retrying cs request in " << btcs.retryin() << " ds";
@@ -2544,7 +2596,13 @@ void MegaClient::exec()
 
                     bool suppressSID, v3;
                     string idempotenceId;
-                    *pendingcs->out = reqs.serverrequest(suppressSID, pendingcs->includesFetchingNodes, v3, this, idempotenceId);
+
+                    // stream the batch body straight out of the dispatcher's
+                    // idempotence cache: curl pulls it through the read
+                    // callback, so large putnodes batches are posted without
+                    // ever being copied into the request's own buffer
+                    const string& batchBody = reqs.serverrequest(suppressSID, pendingcs->includesFetchingNodes, v3, this, idempotenceId);
+                    pendingcs->out = const_cast<string*>(&batchBody);
 
                     pendingcs->posturl = httpio->APIURL;
                     pendingcs->posturl.append("cs?id=");
@@ -2573,6 +2631,13 @@ void MegaClient::exec()
                     }
 
                     performanceStats.csRequestWaitTime.start();
+                    PerfCounters::get().add(PERF_CS_REQUESTS);
+                    PerfCounters::get().add(PERF_CS_INFLIGHT);
+                    if (WireCapture::get().capturing())
+                    {
+                        WireCapture::get().record("cs", "out", WireCapture::redactUrl(pendingcs->posturl),
+                                                  pendingcs->out ? *pendingcs->out : string());
+                    }
                     pendingcs->post(this);
                     continue;
                 }
@@ -2584,6 +2649,31 @@ void MegaClient::exec()
             break;
         }
 
+        if (csResponseReceived)
+        {
+            // the next batch, if one was ready, is already on the wire: its
+            // round trip overlaps the local processing of the response
+            reqs.processQueuedResponses(this);
+
+            notifypurge();
+            if (sctable && pendingsccommit && !reqs.readyToSend() && scsn.ready())
+            {
+                LOG_debug << "Executing postponed DB commit 2 (sessionid: " << string(sessionid, sizeof(sessionid)) << ")";
+                sctable->commit();
+                assert(!sctable->inTransaction());
+                sctable->begin();
+                app->notify_dbcommit();
+                pendingsccommit = false;
+            }
+
+            if (auto completion = std::move(mOnCSCompletion))
+            {
+                LOG_debug << "calling mOnCSCompletion after request reply processing";  // track possible lack of logout callbacks
+                assert(mOnCSCompletion == nullptr);
+                completion(this);
+            }
+        }
+
         // handle the request for the last 50 UserAlerts
         if (pendingscUserAlerts)
         {
@@ -2612,6 +2702,9 @@ void MegaClient::exec()
                     if (e == API_EAGAIN || e == API_ERATELIMIT)
                     {
                         btsc.backoff();
+                        retryTelemetry.record(RetryTelemetry::ENDPOINT_SC,
+                                              e == API_ERATELIMIT ? RETRY_RATE_LIMIT : RETRY_SERVERS_BUSY,
+                                              btsc.retryin());
                         pendingscUserAlerts.reset();
                         LOG_warn << "Backing off before retrying useralerts request: " << btsc.retryin();
                         break;
@@ -2659,8 +2752,14 @@ void MegaClient::exec()
 
                 if (*pendingsc->in.c_str() == '{')
                 {
+                    if (WireCapture::get().capturing())
+                    {
+                        WireCapture::get().record("sc", "in", string(), pendingsc->in);
+                    }
                     insca = false;
                     insca_notlast = false;
+                    mScResponseArrival = Waiter::tickTime;
+                    performanceStats.scBytesAtArrival.record(pendingsc->in.size());
                     jsonsc.begin(pendingsc->in.c_str());
                     jsonsc.enterobject();
                     break;
@@ -2762,6 +2861,9 @@ void MegaClient::exec()
                 {
                     // failure, repeat with capped exponential backoff
                     btsc.backoff();
+                    retryTelemetry.record(RetryTelemetry::ENDPOINT_SC,
+                                          pendingscTimedOut ? RETRY_CONNECTIVITY : RETRY_UNKNOWN,
+                                          btsc.retryin());
                     LOG_debug << clientname << "sc backing off with delay ds: " << btsc.retryin();
                 }
                 break;
@@ -2837,6 +2939,11 @@ void MegaClient::exec()
                 pendingsc->posturl.append(scsn.text());
                 pendingsc->posturl.append(getAuthURI(false, true));
 
+                if (WireCapture::get().capturing())
+                {
+                    WireCapture::get().record("sc", "out", WireCapture::redactUrl(pendingsc->posturl), string());
+                }
+
                 pendingsc->type = REQ_JSON;
                 pendingsc->post(this);
             }
@@ -3174,6 +3281,15 @@ int MegaClient::preparewait()
     // get current dstime and clear wait events
     WAIT_CLASS::bumpds();
 
+    if (mExecSliceYielded)
+    {
+        // a phase ran out of its time slice and yielded: resume it right
+        // away instead of sleeping
+        mExecSliceYielded = false;
+        ++performanceStats.prepwaitImmediate;
+        return Waiter::NEEDEXEC;
+    }
+
 #ifdef ENABLE_SYNC
     if (!syncs.clientThreadActions.empty())
     {
@@ -3290,6 +3406,9 @@ int MegaClient::preparewait()
             btugexpiration.update(&nds);
         }
 
+        // release composite user alerts once their aggregation window closes
+        useralerts.updateAggregateDeadline(&nds);
+
         // detect stuck network
         if (EVER(httpio->lastdata) && !pendingcs)
         {
@@ -3514,7 +3633,7 @@ bool MegaClient::abortbackoff(bool includexfers)
         r = true;
     }
 
-    if (activefa.size() < MAXPUTFA && btpfa.arm())
+    if (activefa.size() < MAXPUTFABATCH && btpfa.arm())
     {
         r = true;
     }
@@ -3561,11 +3680,21 @@ void MegaClient::dispatchTransfers()
     // do we have any transfer slots available?
     if (!slotavail())
     {
-        LOG_verbose << "No slots available";
-        return;
+        // all seats taken: an interactive transfer that has waited past its
+        // latency target may bump the lowest-priority bulk transfer
+        TransferDbCommitter committer(tctable);
+        if (!transferlist.preemptforinteractive(committer))
+        {
+            LOG_verbose << "No slots available";
+            return;
+        }
     }
 
     CodeCounter::ScopeTimer ccst(performanceStats.dispatchTransfers);
+    MEGA_TRACE_SCOPE("dispatchTransfers");
+    StallSamplerPhase ssp(stallSampler, StallSampler::PHASE_TRANSFERS);
+
+    mExecSlice.start(EXECSLICEMS);
 
     struct counter
     {
@@ -3622,21 +3751,27 @@ void MegaClient::dispatchTransfers()
         {
             TransferCategory tc(t);
 
-            // If we have one very big file, that is enough to max out the bandwidth by itself; get that one done quickly (without preventing more small files).
-            if (counters[tc.index()].hasVeryBig)
+            // interactive transfers are latency-bound: never hold them back
+            // to shape bulk throughput (their count is still capped by the
+            // per-direction limits above)
+            if (!t->interactive)
             {
-                return false;
-            }
+                // If we have one very big file, that is enough to max out the bandwidth by itself; get that one done quickly (without preventing more small files).
+                if (counters[tc.index()].hasVeryBig)
+                {
+                    return false;
+                }
 
-            // queue up enough transfers that we can expect to keep busy for at least the next 30 seconds in this category
-            m_off_t speed = (tc.direction == GET) ? httpio->downloadSpeed : httpio->uploadSpeed;
-            m_off_t targetOutstanding = 30 * speed;
-            targetOutstanding = std::max<m_off_t>(targetOutstanding, 2 * 1024 * 1024);
-            targetOutstanding = std::min<m_off_t>(targetOutstanding, 100 * 1024 * 1024);
+                // queue up enough transfers that we can expect to keep busy for at least the next 30 seconds in this category
+                m_off_t speed = (tc.direction == GET) ? httpio->downloadSpeed : httpio->uploadSpeed;
+                m_off_t targetOutstanding = 30 * speed;
+                targetOutstanding = std::max<m_off_t>(targetOutstanding, 2 * 1024 * 1024);
+                targetOutstanding = std::min<m_off_t>(targetOutstanding, 100 * 1024 * 1024);
 
-            if (counters[tc.index()].remainingsum >= targetOutstanding)
-            {
-                return false;
+                if (counters[tc.index()].remainingsum >= targetOutstanding)
+                {
+                    return false;
+                }
             }
 
             counters[tc.index()].addnew(t->size);
@@ -3666,6 +3801,15 @@ void MegaClient::dispatchTransfers()
                 return;
             }
 
+            if (mExecSlice.exceeded())
+            {
+                // out of slice: the remaining candidates stay queued and are
+                // picked up by the next exec() pass
+                ++performanceStats.execSliceYields;
+                mExecSliceYielded = true;
+                return;
+            }
+
             if (category.direction == PUT && queuedfa.size() > MAXQUEUEDFA)
             {
                 // file attribute jam? halt uploads.
@@ -3849,6 +3993,13 @@ void MegaClient::dispatchTransfers()
                             << " Contiguous: " << progresscontiguous
                             << " Partial: " << p << " Size: " << nexttransfer->size
                             << " ultoken: " << (nexttransfer->ultoken != NULL);
+
+                        if (nexttransfer->type == GET && nexttransfer->size > 0)
+                        {
+                            // reserve the full extent up front where possible, so
+                            // chunks arriving out of order don't fragment the file
+                            ts->fa->fpreallocate(nexttransfer->size);
+                        }
                     }
                     else
                     {
@@ -3877,6 +4028,36 @@ void MegaClient::dispatchTransfers()
                             continue;
                         }
 
+                        // the whole file will be read once, front to back
+                        ts->fa->fadvise(FileAccess::ACCESS_SEQUENTIAL, 0, 0);
+
+                        if (nexttransfer->deferredfpverification)
+                        {
+                            // resumed upload: re-read the CRC on a worker, overlapped with the
+                            // first chunks.  The slot checks the result in doio() and restarts
+                            // the upload from scratch if the file was modified
+                            nexttransfer->deferredfpverification = false;
+                            nexttransfer->deferredfpmismatch = std::make_shared<std::atomic<bool>>(false);
+
+                            std::shared_ptr<FileAccess> wfa(fsaccess->newfileaccess().release());
+                            auto localname = nexttransfer->localfilename;
+                            FileFingerprint expected = *(FileFingerprint*)nexttransfer;
+                            auto mismatch = nexttransfer->deferredfpmismatch;
+
+                            mAsyncQueue.push([wfa, localname, expected, mismatch](SymmCipher&)
+                            {
+                                FileFingerprint check;
+                                if (wfa->fopen(localname, true, false, FSLogging::logOnError))
+                                {
+                                    check.genfingerprint(wfa.get());
+                                }
+                                if (!check.isvalid || !(check == expected))
+                                {
+                                    mismatch->store(true);
+                                }
+                            }, true);   // discardable - if the transfer is being torn down, the check no longer matters
+                        }
+
                         // create thumbnail/preview imagery, if applicable (FIXME: do not re-create upon restart)
                         if (!nexttransfer->localfilename.empty() && nexttransfer->uploadhandle.isUndef())
                         {
@@ -3885,7 +4066,9 @@ void MegaClient::dispatchTransfers()
                             if (!gfxdisabled && gfx && gfx->isgfx(nexttransfer->localfilename))
                             {
                                 // we want all imagery to be safely tucked away before completing the upload, so we bump minfa
-                                int bitmask = gfx->gendimensionsputfa(ts->fa, nexttransfer->localfilename, NodeOrUploadHandle(nexttransfer->uploadhandle), nexttransfer->transfercipher(), -1);
+                                // cancelling the transfer also abandons any imagery still queued for it
+                                int bitmask = gfx->gendimensionsputfa(ts->fa, nexttransfer->localfilename, NodeOrUploadHandle(nexttransfer->uploadhandle), nexttransfer->transfercipher(), -1,
+                                                                      nexttransfer->files.empty() ? CancelToken() : nexttransfer->files.front()->cancelToken);
 
                                 if (bitmask & (1 << GfxProc::THUMBNAIL))
                                 {
@@ -4101,8 +4284,7 @@ void MegaClient::freeq(direction_t d)
         delete transferPtr.second;
     }
     multi_transfers[d].clear();
-    transferlist.transfers[GET].clear();
-    transferlist.transfers[PUT].clear();
+    transferlist.clear();
 }
 
 bool MegaClient::isFetchingNodesPendingCS()
@@ -4276,7 +4458,11 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
     mNodeManager.setTable(nullptr);
     pendingsccommit = false;
 
+    // capture storage server addresses resolved during the session too
+    savednscache();
     statusTable.reset();
+    facache.reset();
+    mDnsCacheRecord = DnsCacheRecord(); // dbid belongs to the table just closed
 
     me = UNDEF;
     uid.clear();
@@ -4347,10 +4533,18 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
     userid = 0;
     mNodeManager.reset();
 
-    reqs.clear();
+    if (pendingcs && pendingcs->status == REQ_INFLIGHT)
+    {
+        // the response will never be processed, so it no longer counts as pending
+        PerfCounters::get().sub(PERF_CS_INFLIGHT);
+    }
 
+    // cancel the in-flight cs request before clearing the dispatcher: its
+    // body is streamed from the dispatcher's cached batch JSON
     delete pendingcs;
     pendingcs = NULL;
+
+    reqs.clear();
     scsn.clear();
     mBlocked = false;
     mBlockedSet = false;
@@ -4459,6 +4653,8 @@ void MegaClient::removeCaches()
         statusTable.reset();
     }
 
+    facache.remove();
+
     disabletransferresumption();
 }
 
@@ -4572,8 +4768,13 @@ bool MegaClient::procsc()
     actionpacketsCurrent = false;
 
     CodeCounter::ScopeTimer ccst(performanceStats.scProcessingTime);
+    MEGA_TRACE_SCOPE("procsc");
+    StallSamplerPhase ssp(stallSampler, StallSampler::PHASE_SC_PROCESSING);
     nameid name;
 
+    // every (re)entry gets a fresh slice, so progress is always made
+    mExecSlice.start(EXECSLICEMS);
+
     std::shared_ptr<Node> lastAPDeletedNode;
 
     for (;;)
@@ -4615,6 +4816,7 @@ bool MegaClient::procsc()
                     break;
 
                 case EOO:
+                    PerfCounters::get().set(PERF_SC_BACKLOG, 0);
                     if (!useralerts.isDeletedSharedNodesStashEmpty())
                     {
 			useralerts.purgeNodeVersionsFromStash();
@@ -4634,11 +4836,23 @@ bool MegaClient::procsc()
                             notifypurge();
                             if (sctable)
                             {
-                                LOG_debug << "DB transaction COMMIT (sessionid: " << string(sessionid, sizeof(sessionid)) << ")";
-                                sctable->commit();
-                                assert(!sctable->inTransaction());
-                                sctable->begin();
-                                pendingsccommit = false;
+                                if (loggedIntoFolder())
+                                {
+                                    // ephemeral folder-link session: fire fetchnodes_result
+                                    // first so the viewer renders without waiting for the
+                                    // whole-tree fsync; the commit follows through the
+                                    // normal deferred machinery once the client idles
+                                    LOG_debug << "Deferring DB commit until after fetchnodes_result (folder link)";
+                                    pendingsccommit = true;
+                                }
+                                else
+                                {
+                                    LOG_debug << "DB transaction COMMIT (sessionid: " << string(sessionid, sizeof(sessionid)) << ")";
+                                    sctable->commit();
+                                    assert(!sctable->inTransaction());
+                                    sctable->begin();
+                                    pendingsccommit = false;
+                                }
                             }
 
                             WAIT_CLASS::bumpds();
@@ -4657,7 +4871,10 @@ bool MegaClient::procsc()
 
                             enabletransferresumption();
                             app->fetchnodes_result(API_OK);
-                            app->notify_dbcommit();
+                            if (!pendingsccommit)
+                            {
+                                app->notify_dbcommit();
+                            }
                             fetchnodesAlreadyCompletedThisSession = true;
 
                             WAIT_CLASS::bumpds();
@@ -4689,6 +4906,14 @@ bool MegaClient::procsc()
                         app->nodes_current();
                         LOG_debug << "Cloud node tree up to date";
 
+                        // warm the contact attribute cache in one batched
+                        // request, ahead of the first contact-list render
+                        prefetchContactAttributes();
+
+                        // the API hosts are resolved by now; snapshot them
+                        // so the next session starts without DNS lookups
+                        savednscache();
+
 #ifdef ENABLE_SYNC
                         // Don't start sync activity until `statecurrent` as it could take actions based on old state
                         // The reworked sync code can figure out what to do once fully up to date.
@@ -4851,6 +5076,23 @@ bool MegaClient::procsc()
 
         if (insca)
         {
+            // cooperative time slice: hand the thread back and resume from
+            // this packet on the next exec() pass, so a huge actionpacket
+            // batch cannot stall everything else for its full duration.
+            // Not between the halves of a move (deletion noted, addition
+            // pending), as that would misreport it as delete+add.
+            if (!lastAPDeletedNode && mExecSlice.exceeded())
+            {
+                ++performanceStats.execSliceYields;
+                mExecSliceYielded = true;
+                if (pendingsc)  // replay harnesses drive procsc without a pendingsc
+                {
+                    PerfCounters::get().set(PERF_SC_BACKLOG,
+                        static_cast<int64_t>(pendingsc->in.size() - static_cast<size_t>(jsonsc.pos - pendingsc->in.data())));
+                }
+                return false;
+            }
+
             auto actionpacketStart = jsonsc.pos;
             if (jsonsc.enterobject())
             {
@@ -4869,6 +5111,14 @@ bool MegaClient::procsc()
                 // the "a" attribute is guaranteed to be the first in the object
                 if (jsonsc.getnameid() == 'a')
                 {
+                    PerfCounters::get().add(PERF_SC_PACKETS);
+                    if (mScResponseArrival != std::chrono::steady_clock::time_point())
+                    {
+                        // tickTime rather than now(): once per packet, and only
+                        // cross-pass staleness (catch-up) is of interest here
+                        performanceStats.scArrivalToParse.record(static_cast<uint64_t>(
+                            std::chrono::duration_cast<std::chrono::milliseconds>(Waiter::tickTime - mScResponseArrival).count()));
+                    }
                     if (!statecurrent)
                     {
                         fnstats.actionPackets++;
@@ -5512,6 +5762,22 @@ error MegaClient::getfa(handle h, string *fileattrstring, const string &nodekey,
     }
     else
     {
+        // served locally from the durable attribute cache?
+        string cached;
+        if (facache.get(fah, &cached))
+        {
+            SymmCipher* cipher = getRecycledTemporaryNodeCipher(&nodekey);
+
+            if (cipher && !(cached.size() & (SymmCipher::BLOCKSIZE - 1))
+                    && cipher->cbc_decrypt((byte*)&cached[0], cached.size()))
+            {
+                LOG_debug << "File attribute served from local cache: " << toHandle(fah);
+                restag = reqtag;
+                app->fa_complete(h, t, cached.data(), uint32_t(cached.size()));
+                return API_OK;
+            }
+        }
+
         // add file attribute cluster channel and set cluster reference node handle
         FileAttributeFetchChannel** fafcp = &fafcs[c];
 
@@ -5529,7 +5795,7 @@ error MegaClient::getfa(handle h, string *fileattrstring, const string &nodekey,
 
             if (!*fafp)
             {
-                *fafp = new FileAttributeFetch(h, nodekey, t, reqtag);
+                *fafp = new FileAttributeFetch(h, nodekey, t, reqtag, fafseqno++);
             }
             else
             {
@@ -5548,6 +5814,25 @@ error MegaClient::getfa(handle h, string *fileattrstring, const string &nodekey,
     }
 }
 
+// viewport hint: the app raises nodes it is currently displaying so their
+// pending attribute fetches and generation jobs are served first
+void MegaClient::setfapriority(handle h, bool up)
+{
+    if (up)
+    {
+        fapriority.insert(h);
+    }
+    else
+    {
+        fapriority.erase(h);
+    }
+
+    if (gfx)
+    {
+        gfx->setjobpriority(h, up);
+    }
+}
+
 // build pending attribute string for this handle and remove
 void MegaClient::pendingattrstring(UploadHandle h, string* fa)
 {
@@ -5591,7 +5876,11 @@ bool MegaClient::putfa(NodeOrUploadHandle th, fatype t, SymmCipher* key, int tag
 
 void MegaClient::activatefa()
 {
-    while (activefa.size() < MAXPUTFA && queuedfa.size())
+    // issue the URL requests for the whole burst at once: commands added in
+    // the same cycle travel in one batched API request, so a bulk upload pays
+    // one round trip for its attribute URLs instead of one per attribute.
+    // The data POSTs still trickle through MAXPUTFA slots (see exec())
+    while (activefa.size() < MAXPUTFABATCH && queuedfa.size())
     {
         auto curfa = queuedfa.begin();
         shared_ptr<HttpReqFA> fa = *curfa;
@@ -5600,7 +5889,7 @@ void MegaClient::activatefa()
 
         LOG_debug << "Adding file attribute to the active queue";
 
-        fa->status = REQ_GET_URL;  // will become REQ_INFLIGHT after we get the URL and start data upload.  Don't delete while the reqs subsystem would end up with a dangling pointer
+        fa->status = REQ_GET_URL;  // will become REQ_PREPARED once the URL arrives, REQ_INFLIGHT when the data upload starts.  Don't delete while the reqs subsystem would end up with a dangling pointer
         reqs.add(fa->getURLForFACmd());
     }
 }
@@ -6486,7 +6775,9 @@ void MegaClient::sc_userattr()
     handle uh = UNDEF;
     User *u = NULL;
 
-    string ua, uav;
+    mParseScratch.reset();
+    string& ua = mParseScratch.get();
+    string& uav = mParseScratch.get();
     string_vector ualist;    // stores attribute names
     string_vector uavlist;   // stores attribute versions
     string_vector::const_iterator itua, ituav;
@@ -7968,6 +8259,11 @@ void MegaClient::notifypurge(void)
         return;
     }
 
+    // notifications must be delivered in one piece, so this phase cannot
+    // yield mid-way; account for overruns so they show up in the stats
+    TimeSliceBudget slice;
+    slice.start(EXECSLICEMS);
+
     int i, t;
 
     handle tscsn = cachedscsn;
@@ -7982,6 +8278,12 @@ void MegaClient::notifypurge(void)
 #endif
             || cachedscsn != tscsn)
     {
+        if (mScResponseArrival != std::chrono::steady_clock::time_point())
+        {
+            performanceStats.scArrivalToNotify.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - mScResponseArrival).count()));
+        }
 
         if (scsn.ready())
         {
@@ -7994,9 +8296,21 @@ void MegaClient::notifypurge(void)
     // purge of notifications related to nodes have been moved to NodeManager since NodesOnDemand
     mNodeManager.notifyPurge();
 
+    if (mScResponseArrival != std::chrono::steady_clock::time_point() && !jsonsc.pos)
+    {
+        // the sc response is fully parsed and listeners have now seen its node
+        // changes - the pipeline for it ends here.  Intermediate deliveries
+        // while a large response is still being sliced keep the stamp, so
+        // later packets of the same response still measure against arrival.
+        performanceStats.scArrivalToDelivery.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - mScResponseArrival).count()));
+        mScResponseArrival = std::chrono::steady_clock::time_point();
+    }
+
     if ((t = int(pcrnotify.size())))
     {
-        if (!fetchingnodes)
+        if (!catchingUpOnActionpackets())
         {
             app->pcrs_updated(&pcrnotify[0], t);
         }
@@ -8008,6 +8322,7 @@ void MegaClient::notifypurge(void)
 
             if (pcr->removed())
             {
+                unindexpcr(pcr);
                 pcrindex.erase(pcr->id);
             }
             else
@@ -8023,9 +8338,22 @@ void MegaClient::notifypurge(void)
     // users are never deleted (except at account cancellation)
     if ((t = int(usernotify.size())))
     {
-        if (!fetchingnodes)
+        // only fan out users with a recorded field-level delta; repeated
+        // actionpackets that changed nothing visible are still purged below,
+        // but the app is not told to re-render for them
+        user_vector changedusers;
+        changedusers.reserve(usernotify.size());
+        for (i = 0; i < t; i++)
         {
-            app->users_updated(&usernotify[0], t);
+            if (usernotify[i]->anyChanged())
+            {
+                changedusers.push_back(usernotify[i]);
+            }
+        }
+
+        if (!changedusers.empty() && !catchingUpOnActionpackets())
+        {
+            app->users_updated(&changedusers[0], int(changedusers.size()));
         }
 
         for (i = 0; i < t; i++)
@@ -8071,7 +8399,7 @@ void MegaClient::notifypurge(void)
 #ifdef ENABLE_CHAT
     if ((t = int(chatnotify.size())))
     {
-        if (!fetchingnodes)
+        if (!catchingUpOnActionpackets())
         {
             app->chats_updated(&chatnotify, t);
         }
@@ -8092,6 +8420,12 @@ void MegaClient::notifypurge(void)
 #endif
 
     totalNodes.store(mNodeManager.getNodeCount());
+
+    if (slice.exceeded())
+    {
+        ++performanceStats.execSliceOverruns;
+        LOG_verbose << "notifypurge overran its time slice";
+    }
 }
 
 void MegaClient::persistAlert(UserAlert::Base* a)
@@ -9154,13 +9488,15 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
 
     if (j->enterobject())
     {
+        mParseScratch.reset();
+
         handle h = UNDEF, ph = UNDEF;
         handle u = 0, su = UNDEF;
         nodetype_t t = TYPE_UNKNOWN;
-        const char* a = NULL;
-        const char* k = NULL;
-        const char* fa = NULL;
-        const char *sk = NULL;
+        std::string_view a;
+        std::string_view k;
+        std::string_view fa;
+        std::string_view sk;
         accesslevel_t rl = ACCESS_UNKNOWN;
         m_off_t s = NEVER;
         m_time_t ts = -1, sts = -1;
@@ -9193,11 +9529,11 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     break;
 
                 case 'a':   // attributes
-                    a = j->getvalue();
+                    a = j->getvalueview();
                     break;
 
                 case 'k':   // key(s)
-                    k = j->getvalue();
+                    k = j->getvalueview();
                     break;
 
                 case 's':   // file size
@@ -9213,7 +9549,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     break;
 
                 case MAKENAMEID2('f', 'a'):  // file attributes
-                    fa = j->getvalue();
+                    fa = j->getvalueview();
                     break;
 
                     // inbound share attributes
@@ -9222,7 +9558,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     break;
 
                 case MAKENAMEID2('s', 'k'):  // share key
-                    sk = j->getvalue();
+                    sk = j->getvalueview();
                     break;
 
                 case MAKENAMEID2('s', 'u'):  // sharing user
@@ -9257,11 +9593,11 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                 {
                     warn("Missing parent");
                 }
-                else if (!a)
+                else if (!a.data())
                 {
                     warn("Missing node attributes");
                 }
-                else if (!k)
+                else if (!k.data())
                 {
                     warn("Missing node key");
                 }
@@ -9273,7 +9609,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
             }
         }
 
-        if (fa && t != FILENODE)
+        if (fa.data() && t != FILENODE)
         {
             warn("Spurious file attributes");
         }
@@ -9320,7 +9656,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     }
                 }
 
-                if (a && k && n->attrstring)
+                if (a.data() && k.data() && n->attrstring)
                 {
                     LOG_warn << "Updating the key of a NO_KEY node";
                     JSON::copystring(n->attrstring.get(), a);
@@ -9329,7 +9665,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
             }
             else
             {
-                vector<byte> buf(SymmCipher::KEYLENGTH);
+                vector<byte> buf;   // sized on demand: most nodes are not incoming shares
 
                 if (!ISUNDEF(su))
                 {
@@ -9351,19 +9687,20 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     {
                         if (!mKeyManager.isSecure() || !mKeyManager.generation())
                         {
-                            if (sk)
+                            if (sk.data())
                             {
-                                decryptkey(sk, buf.data(), static_cast<int>(buf.size()), &key, 1, h);
+                                buf.resize(SymmCipher::KEYLENGTH);
+                                decryptkey(sk.data(), buf.data(), static_cast<int>(buf.size()), &key, 1, h);
                             }
                         }
                         else
                         {
-                            sk = nullptr;
+                            sk = std::string_view();
                         }
                     }
                 }
 
-                string fas;
+                string& fas = mParseScratch.get();
 
                 JSON::copystring(&fas, fa);
 
@@ -9378,7 +9715,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     sts = ts;
                 }
 
-                n = std::make_shared<Node>(*this, NodeHandle().set6byte(h), NodeHandle().set6byte(ph), t, s, u, fas.c_str(), ts);
+                n = std::allocate_shared<Node>(PooledAllocator<Node>(), *this, NodeHandle().set6byte(h), NodeHandle().set6byte(ph), t, s, u, fas.c_str(), ts);
                 n->changed.newnode = true;
                 n->changed.modifiedByThisClient = modifiedByThisClient;
 
@@ -9408,8 +9745,8 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
 
                 if (!ISUNDEF(su))   // node represents an incoming share
                 {
-                    newshares.push_back(new NewShare(h, 0, su, rl, sts, sk ? buf.data() : NULL));
-                    if (sk) // only if the key is valid, add it to the repository
+                    newshares.push_back(new NewShare(h, 0, su, rl, sts, sk.data() ? buf.data() : NULL));
+                    if (sk.data()) // only if the key is valid, add it to the repository
                     {
                         mNewKeyRepository[NodeHandle().set6byte(h)] = std::move(buf);
                     }
@@ -9714,7 +10051,7 @@ void MegaClient::readipc(JSON *j)
                         }
                         else
                         {
-                            pcrindex[p].reset(new PendingContactRequest(p, m, NULL, ts, uts, msg, false));
+                            mappcr(p, unique_ptr<PendingContactRequest>(new PendingContactRequest(p, m, NULL, ts, uts, msg, false)));
                         }
 
                         break;
@@ -9793,11 +10130,15 @@ void MegaClient::readopc(JSON *j)
 
                         if (pcrindex[p] != NULL)
                         {
+                            // may be completing an "empty" PCR created by findpcr()
+                            // for an outgoing share, so (re)index it
+                            unindexpcr(pcrindex[p].get());
                             pcrindex[p]->update(e, m, ts, uts, msg, true);
+                            indexpcr(pcrindex[p].get());
                         }
                         else
                         {
-                            pcrindex[p].reset(new PendingContactRequest(p, e, m, ts, uts, msg, true));
+                            mappcr(p, unique_ptr<PendingContactRequest>(new PendingContactRequest(p, e, m, ts, uts, msg, true)));
                         }
 
                         break;
@@ -10031,17 +10372,99 @@ void MegaClient::sendkeyrewrites()
 
     if (sharekeyrewrite.size())
     {
-        reqs.add(new CommandShareKeyUpdate(this, &sharekeyrewrite));
+        sendkeyrewrites(sharekeyrewrite, true);
         sharekeyrewrite.clear();
     }
 
     if (nodekeyrewrite.size())
     {
-        reqs.add(new CommandNodeKeyUpdate(this, &nodekeyrewrite));
+        sendkeyrewrites(nodekeyrewrite, false);
         nodekeyrewrite.clear();
     }
 }
 
+void MegaClient::sendkeyrewrites(handle_vector& v, bool sharekeys)
+{
+    // resolve handles and collect the plaintext keys on the client thread
+    // (node access is not thread-safe)
+    vector<pair<handle, string>> rewrites;
+    rewrites.reserve(v.size());
+
+    for (handle h : v)
+    {
+        if (shared_ptr<Node> n = nodebyhandle(h))
+        {
+            if (sharekeys)
+            {
+                if (n->sharekey)
+                {
+                    rewrites.emplace_back(h, string((const char*)n->sharekey->key, SymmCipher::KEYLENGTH));
+                }
+            }
+            else
+            {
+                rewrites.emplace_back(h, n->nodekey());
+            }
+        }
+    }
+
+    // re-encrypt under the master key, fanning large rotations out across
+    // hardware threads (each worker uses its own copy of the master key)
+    auto encryptrange = [&rewrites](SymmCipher& cipher, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            string& k = rewrites[i].second;
+            cipher.ecb_encrypt((byte*)k.data(), (byte*)k.data(), k.size());
+        }
+    };
+
+    size_t workers = std::min<size_t>(rewrites.size() / 4096,
+                                      std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1);
+    workers = std::min<size_t>(workers, 8);
+
+    if (workers < 2)
+    {
+        encryptrange(key, 0, rewrites.size());
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < workers; w++)
+        {
+            threads.emplace_back([this, w, workers, &rewrites, &encryptrange]()
+            {
+                SymmCipher masterkey(key);
+                encryptrange(masterkey, rewrites.size() * w / workers, rewrites.size() * (w + 1) / workers);
+            });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    // emit in bounded chunks so the request dispatcher can pipeline them and
+    // a retried batch never resends the whole rotation
+    for (size_t i = 0; i < rewrites.size(); i += MAXKEYREWRITESPERCOMMAND)
+    {
+        size_t end = std::min<size_t>(rewrites.size(), i + MAXKEYREWRITESPERCOMMAND);
+
+        if (sharekeys)
+        {
+            reqs.add(new CommandShareKeyUpdate(this, rewrites, i, end));
+        }
+        else
+        {
+            reqs.add(new CommandNodeKeyUpdate(this, rewrites, i, end));
+        }
+
+        LOG_debug << "Queued " << (sharekeys ? "share" : "node") << " key rewrites: "
+                  << end << "/" << rewrites.size();
+    }
+}
+
 // user/contact list
 bool MegaClient::readusers(JSON* j, bool actionpackets)
 {
@@ -10066,18 +10489,25 @@ int MegaClient::readuser(JSON* j, bool actionpackets)
 {
     if (j->enterobject())
     {
+        mParseScratch.reset();
+
         handle uh = 0;
         visibility_t v = VISIBILITY_UNKNOWN;    // new share objects do not override existing visibility
         m_time_t ts = 0;
         const char* m = NULL;
         nameid name;
         BizMode bizMode = BIZ_MODE_UNKNOWN;
-        string pubk, puEd255, puCu255, sigPubk, sigCu255;
+        string& pubk = mParseScratch.get();
+        string& puEd255 = mParseScratch.get();
+        string& puCu255 = mParseScratch.get();
+        string& sigPubk = mParseScratch.get();
+        string& sigCu255 = mParseScratch.get();
+        string& fieldName = mParseScratch.get();
 
         bool exit = false;
         while (!exit)
         {
-            string fieldName = j->getnameWithoutAdvance();
+            j->getnameWithoutAdvance(fieldName);
             name = j->getnameid();
             switch (name)
             {
@@ -10174,7 +10604,7 @@ int MegaClient::readuser(JSON* j, bool actionpackets)
         {
             if (actionpackets && v >= 0 && v <= 3 && statecurrent)
             {
-                string email;
+                string& email = mParseScratch.get();
                 JSON::copystring(&email, m);
                 useralerts.add(new UserAlert::ContactChange(v, uh, email, ts, useralerts.nextId()));
             }
@@ -10185,6 +10615,13 @@ int MegaClient::readuser(JSON* j, bool actionpackets)
                 const string oldEmail = u->email;
                 mapuser(uh, m);
 
+                if (notify && u->email.size())
+                {
+                    // brand new user: record the e-mail as its first delta, so
+                    // the notification is not dropped as an empty one
+                    u->changed.email = true;
+                }
+
                 u->mBizMode = bizMode;
 
                 // The attributes received during the "ug" also include the version.
@@ -10429,7 +10866,7 @@ void MegaClient::login2(const char *email, const char *password, string *salt, c
     string bsalt;
     Base64::atob(*salt, bsalt);
 
-    vector<byte> derivedKey = deriveKey(password, bsalt, 2 * SymmCipher::KEYLENGTH);
+    vector<byte> derivedKey = deriveKeyCached(password, bsalt, 2 * SymmCipher::KEYLENGTH);
 
     login2(email, derivedKey.data(), pin);
 }
@@ -10586,7 +11023,7 @@ error MegaClient::validatepwd(const char* pswd)
     }
     else if (accountversion == 2)
     {
-        vector<byte> dk = deriveKey(pswd, accountsalt, 2 * SymmCipher::KEYLENGTH);
+        vector<byte> dk = deriveKeyCached(pswd, accountsalt, 2 * SymmCipher::KEYLENGTH);
         dk = vector<byte>(dk.data() + SymmCipher::KEYLENGTH, dk.data() + 2 * SymmCipher::KEYLENGTH);
         reqs.add(new CommandValidatePassword(this, u->email.c_str(), dk));
 
@@ -10624,12 +11061,9 @@ bool MegaClient::validatepwdlocally(const char* pswd)
             return false;
         }
 
-        byte derivedKey[2 * SymmCipher::KEYLENGTH];
-        CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA512> pbkdf2;
-        pbkdf2.DeriveKey(derivedKey, sizeof(derivedKey), 0, (byte*)pswd, strlen(pswd),
-            (const byte*)accountsalt.data(), accountsalt.size(), 100000);
+        vector<byte> derivedKey = deriveKeyCached(pswd, accountsalt, 2 * SymmCipher::KEYLENGTH);
 
-        SymmCipher cipher(derivedKey);
+        SymmCipher cipher(derivedKey.data());
         cipher.ecb_decrypt((byte*)tmpk.data());
     }
     else
@@ -10800,6 +11234,9 @@ void MegaClient::opensctable()
             int recycleDBVersion = (DbAccess::LEGACY_DB_VERSION == DbAccess::LAST_DB_VERSION_WITHOUT_NOD || DbAccess::LEGACY_DB_VERSION == DbAccess::LAST_DB_VERSION_WITHOUT_SRW) ?
                                             DB_OPEN_FLAG_RECYCLE :
                                             0;
+            // node lookups run from the sync and gfx threads too: don't let them
+            // fail behind a statecache commit
+            recycleDBVersion |= DB_OPEN_FLAG_CONCURRENT;
             sctable.reset(dbaccess->openTableWithNodes(rng, *fsaccess, dbname, recycleDBVersion, [this](DBError error)
             {
                 handleDbError(error);
@@ -10813,6 +11250,13 @@ void MegaClient::opensctable()
                 assert(nodeTable);
                 mNodeManager.setTable(nodeTable);
 
+                // read-optimized snapshot sidecar of the nodes table: if one from a
+                // previous session is still at the current scsn, node loads are
+                // served from the mapping instead of sqlite
+                LocalPath snapshotPath = dbaccess->rootPath();
+                snapshotPath.appendWithSeparator(LocalPath::fromRelativePath("megaclient_nodes_" + dbname + ".snapshot"), true);
+                mNodeManager.setSnapshotPath(snapshotPath);
+
                 // DB connection always has a transaction started (applies to both tables, statecache and nodes)
                 // We only commit once we have an up to date SCSN and the table state matches it.
                 sctable->begin();
@@ -10851,6 +11295,15 @@ void MegaClient::doOpenStatusTable()
             {
                 handleDbError(error);
             }));
+
+            // the durable file attribute cache is scoped to the account the
+            // same way; it survives logouts that keep the session alive
+            dbname.replace(0, strlen("status_"), "facache_");
+
+            facache.init(dbaccess->open(rng, *fsaccess, dbname, DB_OPEN_FLAG_RECYCLE, [this](DBError error)
+            {
+                handleDbError(error);
+            }));
         }
     }
 }
@@ -11097,9 +11550,52 @@ PendingContactRequest* MegaClient::findpcr(handle p)
     return pcr.get();
 }
 
+PendingContactRequest* MegaClient::findpcrbyemail(const string& targetemail)
+{
+    map<string, handle>::iterator it = mPcrByTargetEmail.find(targetemail);
+    if (it != mPcrByTargetEmail.end())
+    {
+        handlepcr_map::iterator pit = pcrindex.find(it->second);
+        if (pit != pcrindex.end())
+        {
+            return pit->second.get();
+        }
+    }
+
+    return NULL;
+}
+
+void MegaClient::indexpcr(PendingContactRequest* pcr)
+{
+    // incoming requests have no target e-mail - only outgoing ones are indexed
+    if (pcr->isoutgoing && pcr->targetemail.size())
+    {
+        mPcrByTargetEmail[pcr->targetemail] = pcr->id;
+    }
+}
+
+void MegaClient::unindexpcr(PendingContactRequest* pcr)
+{
+    if (pcr->targetemail.size())
+    {
+        map<string, handle>::iterator it = mPcrByTargetEmail.find(pcr->targetemail);
+        if (it != mPcrByTargetEmail.end() && it->second == pcr->id)
+        {
+            mPcrByTargetEmail.erase(it);
+        }
+    }
+}
+
 void MegaClient::mappcr(handle id, unique_ptr<PendingContactRequest>&& pcr)
 {
-    pcrindex[id] = std::move(pcr);
+    auto& slot = pcrindex[id];
+    if (slot)
+    {
+        unindexpcr(slot.get());
+    }
+
+    slot = std::move(pcr);
+    indexpcr(slot.get());
 }
 
 bool MegaClient::discardnotifieduser(User *u)
@@ -11249,6 +11745,17 @@ User *MegaClient::getUserForSharing(const char *uid)
                 u->isTemporary = true;
             }
         }
+
+        if (u && !u->pubk.isvalid())
+        {
+            // serve repeated sharing operations to the same non-contact from the
+            // session cache instead of refetching the key
+            auto cached = mTempUserPubKeyCache.find(u->uid);
+            if (cached != mTempUserPubKeyCache.end())
+            {
+                u->pubk = cached->second;
+            }
+        }
     }
     return u;
 }
@@ -11267,7 +11774,7 @@ void MegaClient::rewriteforeignkeys(std::shared_ptr<Node> n)
 
     if (nodekeyrewrite.size())
     {
-        reqs.add(new CommandNodeKeyUpdate(this, &nodekeyrewrite));
+        sendkeyrewrites(nodekeyrewrite, false);
         nodekeyrewrite.clear();
     }
 }
@@ -12020,7 +12527,11 @@ bool MegaClient::getua(User* u, const attr_t at, int ctag, mega::CommandGetUA::C
         const string *cachedav = u->getattr(at);
         int tag = (ctag != -1) ? ctag : reqtag;
 
-        if (cachedav && u->isattrvalid(at))
+        // entries for users we get no actionpackets for cannot be invalidated
+        // coherently, so they only live for ATTR_CACHE_TTL
+        bool fresh = !u->isTemporary || m_time() - u->getattrts(at) < User::ATTR_CACHE_TTL;
+
+        if (cachedav && u->isattrvalid(at) && fresh)
         {
             if (User::scope(at) == '*') // private attribute, TLV encoding
             {
@@ -12038,15 +12549,29 @@ bool MegaClient::getua(User* u, const attr_t at, int ctag, mega::CommandGetUA::C
                 return true;
             }
         }
-        else if (u->nonExistingAttribute(at))  // only own user attrs get marked as "no exits"
+        else if (u->nonExistingAttribute(at)
+                 && (u->userhandle == me || m_time() - u->getattrts(at) < User::ATTR_CACHE_TTL))
         {
-            assert(u->userhandle == me);
+            // own-user markers stay coherent via actionpackets; negative
+            // entries for other users expire so a late-set attribute shows up
             restag = tag;
             completionErr ? completionErr(API_ENOENT) : app->getua_result(API_ENOENT);
         }
         else
         {
-            reqs.add(new CommandGetUA(this, u->uid.c_str(), at, NULL, tag, completionErr, completionBytes, completionTLV));
+            // share an identical fetch already in flight instead of issuing
+            // a duplicate round trip
+            const string mapkey = CommandGetUA::mapkey(u->uid.c_str(), at, NULL);
+            auto it = mPendingGetUA.find(mapkey);
+            if (it != mPendingGetUA.end())
+            {
+                it->second->addWaiter(tag, completionErr, completionBytes, completionTLV);
+                return false;
+            }
+
+            CommandGetUA* cmd = new CommandGetUA(this, u->uid.c_str(), at, NULL, tag, completionErr, completionBytes, completionTLV);
+            reqs.add(cmd);
+            mPendingGetUA[mapkey] = cmd;
             return false;
         }
     }
@@ -12057,7 +12582,53 @@ void MegaClient::getua(const char *email_handle, const attr_t at, const char *ph
 {
     if (email_handle && at != ATTR_UNKNOWN)
     {
-        reqs.add(new CommandGetUA(this, email_handle, at, ph, (ctag != -1) ? ctag : reqtag, ce, cb, ctlv));
+        const string mapkey = CommandGetUA::mapkey(email_handle, at, ph);
+        auto it = mPendingGetUA.find(mapkey);
+        if (it != mPendingGetUA.end())
+        {
+            it->second->addWaiter((ctag != -1) ? ctag : reqtag, ce, cb, ctlv);
+            return;
+        }
+
+        CommandGetUA* cmd = new CommandGetUA(this, email_handle, at, ph, (ctag != -1) ? ctag : reqtag, ce, cb, ctlv);
+        reqs.add(cmd);
+        mPendingGetUA[mapkey] = cmd;
+    }
+}
+
+void MegaClient::prefetchContactAttributes()
+{
+    // queue fetches for the name attributes the contact list renders first;
+    // they all go out in a single batched cs request, instead of one round
+    // trip per contact when the app scrolls through the list.
+    // Completions are no-ops: the cache update happens in
+    // CommandGetUA::procresult, and no app callback is wanted for a prefetch
+    unsigned queued = 0;
+
+    for (auto& it : users)
+    {
+        User* u = &it.second;
+        if (u->userhandle == me || u->show != VISIBLE)
+        {
+            continue;
+        }
+
+        for (attr_t at : { ATTR_FIRSTNAME, ATTR_LASTNAME })
+        {
+            if (!u->isattrvalid(at) && !u->nonExistingAttribute(at))
+            {
+                getua(u, at, 0,
+                      [](error) {},
+                      [](byte*, unsigned, attr_t) {},
+                      [](TLVstore*, attr_t) {});
+                queued++;
+            }
+        }
+    }
+
+    if (queued)
+    {
+        LOG_debug << "Prefetching " << queued << " contact name attributes";
     }
 }
 
@@ -13506,6 +14077,40 @@ vector<byte> MegaClient::deriveKey(const char* password, const string& salt, siz
     return derivedKey;
 }
 
+vector<byte> MegaClient::deriveKeyCached(const char* password, const string& salt, size_t derivedKeySize)
+{
+    if (mDerivedKeyPepper.empty())
+    {
+        mDerivedKeyPepper.resize(SymmCipher::KEYLENGTH);
+        rng.genblock((byte*)mDerivedKeyPepper.data(), mDerivedKeyPepper.size());
+    }
+
+    string digest;
+    digest.resize(32);
+    HMACSHA256 hmac((const byte*)mDerivedKeyPepper.data(), mDerivedKeyPepper.size());
+    hmac.add((const byte*)password, strlen(password));
+    hmac.get((byte*)digest.data());
+
+    for (const CachedDerivedKey& c : mDerivedKeyCache)
+    {
+        if (c.hmac == digest && c.salt == salt && c.keySize == derivedKeySize)
+        {
+            return c.key;
+        }
+    }
+
+    vector<byte> derivedKey = deriveKey(password, salt, derivedKeySize);
+
+    if (mDerivedKeyCache.size() >= 4)
+    {
+        mDerivedKeyCache.erase(mDerivedKeyCache.begin());
+    }
+
+    mDerivedKeyCache.push_back(CachedDerivedKey{std::move(digest), salt, derivedKeySize, derivedKey});
+
+    return derivedKey;
+}
+
 // create ephemeral session
 void MegaClient::createephemeral()
 {
@@ -13637,14 +14242,56 @@ bool MegaClient::fetchsc(DbTable* sctable)
 
     sctable->rewind();
 
-    bool hasNext = sctable->next(&id, &data, &key);
-    WAIT_CLASS::bumpds();
-    fnstats.timeToFirstByte = Waiter::ds - fnstats.startTime;
+    // -- read-ahead pipeline --
+    // Row fetch and record decryption run on a reader thread while this thread
+    // unserializes and inserts: session resume is largely CPU bound in
+    // unserialization, so overlapping the two stages puts a second core to work.
+    // The sqlite connection is opened in serialized mode, so the consumer's
+    // del() calls interleave safely with the reader's cursor. The queue is
+    // bounded so a slow consumer doesn't pull the whole table into RAM.
+    struct ScRecord
+    {
+        uint32_t id = 0;
+        string data;
+    };
+    std::deque<ScRecord> readAhead;
+    std::mutex readAheadMutex;
+    std::condition_variable readAheadCV;
+    bool readerFinished = false;
+    bool consumerStopped = false;
+    static const size_t MAX_READAHEAD = 256;
+
+    // the reader decrypts records with its own cipher: other record types
+    // unserialized on this thread may use MegaClient::key concurrently
+    SymmCipher readerKey(key);
+
+    std::thread reader([&]()
+    {
+        ScRecord record;
+        while (sctable->next(&record.id, &record.data, &readerKey))
+        {
+            std::unique_lock<std::mutex> lock(readAheadMutex);
+            readAheadCV.wait(lock, [&]() { return readAhead.size() < MAX_READAHEAD || consumerStopped; });
+            if (consumerStopped)
+            {
+                break;
+            }
+
+            readAhead.push_back(std::move(record));
+            lock.unlock();
+            readAheadCV.notify_one();
+        }
+
+        std::lock_guard<std::mutex> lock(readAheadMutex);
+        readerFinished = true;
+        readAheadCV.notify_one();
+    });
 
     bool isDbUpgraded = false;      // true when legacy DB is migrated to NOD's DB schema
 
     std::map<NodeHandle, std::vector<std::shared_ptr<Node> >> delayedParents;
-    while (hasNext)
+
+    auto processRecord = [&]() -> bool
     {
         switch (id & (DbTable::IDSPACING - 1))
         {
@@ -13709,11 +14356,9 @@ bool MegaClient::fetchsc(DbTable* sctable)
 
             case CACHEDALERT:
             {
-                if (!useralerts.unserializeAlert(&data, id))
-                {
-                    LOG_err << "Failed - user notification read error";
-                    // don't break execution, just ignore it
-                }
+                // queued raw: only the newest page is materialized after the
+                // scan, the rest stay serialized until the app pages them in
+                useralerts.queueAlertDbRecord(&data, id);
                 break;
             }
 
@@ -13759,11 +14404,56 @@ bool MegaClient::fetchsc(DbTable* sctable)
                 break;
             }
         }
-        hasNext = sctable->next(&id, &data, &key);
+
+        return true;
+    };
+
+    bool ok = true;
+    bool firstRecord = true;
+    while (ok)
+    {
+        ScRecord record;
+        {
+            std::unique_lock<std::mutex> lock(readAheadMutex);
+            readAheadCV.wait(lock, [&]() { return !readAhead.empty() || readerFinished; });
+            if (readAhead.empty())
+            {
+                break;
+            }
+
+            record = std::move(readAhead.front());
+            readAhead.pop_front();
+        }
+        readAheadCV.notify_one();
+
+        if (firstRecord)
+        {
+            firstRecord = false;
+            WAIT_CLASS::bumpds();
+            fnstats.timeToFirstByte = Waiter::ds - fnstats.startTime;
+        }
+
+        id = record.id;
+        data = std::move(record.data);
+        ok = processRecord();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(readAheadMutex);
+        consumerStopped = true;
+    }
+    readAheadCV.notify_one();
+    reader.join();
+
+    if (!ok)
+    {
+        return false;
     }
 
     LOG_debug << "Max dbId after resume session: " << id;
 
+    useralerts.materializeResidentAlerts();
+
     if (isDbUpgraded)   // nodes loaded during migration from `statecache` to `nodes` table and kept in RAM
     {
         LOG_info << "Upgrading cache to NOD";
@@ -13846,6 +14536,17 @@ bool MegaClient::fetchStatusTable(DbTable* table)
                 }
                 break;
             }
+
+            case CACHEDDNS:
+            {
+                mDnsCacheRecord.dbid = id;
+                mDnsCacheRecord.blob = data;
+                if (httpio)
+                {
+                    httpio->importdnscache(data);
+                }
+                break;
+            }
         }
         hasNext = table->next(&id, &data, &key);
     }
@@ -13853,6 +14554,25 @@ bool MegaClient::fetchStatusTable(DbTable* table)
     return true;
 }
 
+void MegaClient::savednscache()
+{
+    if (!statusTable || !httpio)
+    {
+        return;
+    }
+
+    string blob;
+    if (!httpio->exportdnscache(&blob) || blob == mDnsCacheRecord.blob)
+    {
+        return;
+    }
+
+    mDnsCacheRecord.blob = std::move(blob);
+
+    DBTableTransactionCommitter committer(statusTable);
+    statusTable->put(CACHEDDNS, &mDnsCacheRecord, &key);
+}
+
 void MegaClient::purgeOrphanTransfers(bool remove)
 {
     bool purgeOrphanTransfers = statecurrent;
@@ -14398,25 +15118,15 @@ void MegaClient::initializekeys()
             return;
         }
 
-        // Verify signatures for Cu25519
-        if (!sigCu255.size() ||
-                !EdDSA::verifyKey((unsigned char*) puCu255.data(),
-                                    puCu255.size(),
-                                    &sigCu255,
-                                    (unsigned char*) puEd255.data()))
-        {
-            LOG_warn << "Signature of public key for Cu25519 not found or mismatch";
-
-            sendevent(99413, "Signature of Cu25519 public key mismatch", 0);
-
-            clearKeys();
-            resetKeyring();
-            return;
-        }
+        // Collect the key signatures and verify them in a single batch
+        std::vector<EdDSA::KeySignature> sigbatch;
+        sigbatch.push_back({(unsigned char*) puCu255.data(), puCu255.size(),
+                            &sigCu255, (unsigned char*) puEd255.data()});
 
+        string pubkstr;
         if (loggedin() != EPHEMERALACCOUNTPLUSPLUS)   // E++ accounts don't have RSA keys
         {
-            // Verify signature for RSA public key
+            // Sign the RSA public key if not yet signed
             if (pubk.isvalid() && sigPubk.empty())
             {
                 string pubkStr;
@@ -14429,7 +15139,6 @@ void MegaClient::initializekeys()
                 putua(&attrs, 0);
             }
 
-            string pubkstr;
             if (pubk.isvalid())
             {
                 pubk.serializekeyforjs(pubkstr);
@@ -14452,19 +15161,32 @@ void MegaClient::initializekeys()
                 return;
             }
 
-            if (!EdDSA::verifyKey((unsigned char*) pubkstr.data(),
-                                        pubkstr.size(),
-                                        &sigPubk,
-                                        (unsigned char*) puEd255.data()))
-            {
-                LOG_warn << "Verification of signature of public key for RSA failed";
+            sigbatch.push_back({(unsigned char*) pubkstr.data(), pubkstr.size(),
+                                &sigPubk, (unsigned char*) puEd255.data()});
+        }
 
-                sendevent(99414, "Verification of signature of public key for RSA failed", 0);
+        std::vector<bool> sigok = EdDSA::verifyKeyBatch(sigbatch);
 
-                clearKeys();
-                resetKeyring();
-                return;
-            }
+        if (!sigok[0])  // verifyKeyBatch rejects an empty sigCu255 too
+        {
+            LOG_warn << "Signature of public key for Cu25519 not found or mismatch";
+
+            sendevent(99413, "Signature of Cu25519 public key mismatch", 0);
+
+            clearKeys();
+            resetKeyring();
+            return;
+        }
+
+        if (sigbatch.size() > 1 && !sigok[1])
+        {
+            LOG_warn << "Verification of signature of public key for RSA failed";
+
+            sendevent(99414, "Verification of signature of public key for RSA failed", 0);
+
+            clearKeys();
+            resetKeyring();
+            return;
         }
 
         if (mKeyManager.generation() && asymkey.isvalid(AsymmCipher::PRIVKEY) && !mKeyManager.getPrivRSA().size())
@@ -15293,6 +16015,7 @@ void MegaClient::purgenodesusersabortsc(bool keepOwnUser)
 
     newshares.clear();
     mNewKeyRepository.clear();
+    mUnwrappedNodeKeys.clear();
     usernotify.clear();
     pcrnotify.clear();
     useralerts.clear();
@@ -15336,6 +16059,12 @@ void MegaClient::purgenodesusersabortsc(bool keepOwnUser)
     }
 
     pcrindex.clear();
+    mPcrByTargetEmail.clear();
+
+    mTempUserPubKeyCache.clear();
+
+    mDerivedKeyCache.clear();
+    mDerivedKeyPepper.clear();
 
     scsn.clear();
 
@@ -16572,6 +17301,7 @@ bool MegaClient::startxfer(direction_t d, File* f, TransferDbCommitter& committe
 
             if (startfirst)
             {
+                t->interactive = true;
                 transferlist.movetofirst(t, committer);
             }
 
@@ -16704,7 +17434,7 @@ bool MegaClient::startxfer(direction_t d, File* f, TransferDbCommitter& committe
                 {
                     if (d == PUT)
                     {
-                        if (f->genfingerprint(fa.get()))
+                        if (fa->size != t->size || fa->mtime != t->mtime)
                         {
                             LOG_warn << "The local file has been modified: " << t->localfilename;
                             t->tempurls.clear();
@@ -16713,6 +17443,15 @@ bool MegaClient::startxfer(direction_t d, File* f, TransferDbCommitter& committe
                             t->ultoken.reset();
                             t->pos = 0;
                         }
+                        else
+                        {
+                            // size and mtime match the interrupted upload.  Rather than
+                            // re-reading the whole file here (which serializes the resume of
+                            // large batches behind disk reads), verify the full fingerprint
+                            // on a worker thread once the transfer is dispatched, overlapped
+                            // with the first chunks
+                            t->deferredfpverification = true;
+                        }
                     }
                     else
                     {
@@ -16735,6 +17474,7 @@ bool MegaClient::startxfer(direction_t d, File* f, TransferDbCommitter& committe
             }
 
             t->skipserialization = donotpersist;
+            t->interactive = startfirst;
 
             t->lastaccesstime = m_time();
             t->tag = tag;
@@ -16765,6 +17505,52 @@ bool MegaClient::startxfer(direction_t d, File* f, TransferDbCommitter& committe
             {
                 t->failed(API_EPAYWALL, committer);
             }
+            else if (d == PUT && !f->syncxfer && !f->forceNewUpload)
+            {
+                // Can this upload be satisfied by a server-side copy of an
+                // identical node already in the cloud?  (The sync upload path
+                // makes this same check before queueing its transfer.)
+                std::shared_ptr<Node> cloneNode;
+                sharedNode_vector candidates = mNodeManager.getNodesByFingerprint(*f);
+                for (auto& n : candidates)
+                {
+                    string ext1, ext2;
+                    fsaccess->getextension(f->getLocalname(), ext1);
+                    n->getExtension(ext2, n->displayname());
+                    if (!ext1.empty() && ext1[0] == '.') ext1.erase(0, 1);
+                    if (!ext2.empty() && ext2[0] == '.') ext2.erase(0, 1);
+
+                    if (n->nodekey().size() && treatAsIfFileDataEqual(*n, ext1, *f, ext2))
+                    {
+                        cloneNode = n;
+                        break;
+                    }
+                }
+
+                if (cloneNode)
+                {
+                    LOG_debug << "Cloning node rather than uploading: " << cloneNode->displaypath() << " for " << f->getLocalname();
+                    f->cloneNode = cloneNode;
+
+                    // completed() dereferences the upload token; none was issued for a clone
+                    if (!t->ultoken)
+                    {
+                        t->ultoken.reset(new UploadToken());
+                    }
+
+                    // complete the transfer immediately: sendPutnodesOfUpload
+                    // will issue the putnodes from the clone node, and the
+                    // app receives the usual callback sequence
+                    t->state = TRANSFERSTATE_COMPLETED;
+                    t->completefiles();
+                    app->transfer_complete(t);
+                    delete t;
+
+                    *cause = API_OK;
+
+                    return true;
+                }
+            }
         }
 
         assert( (f->h.isUndef() && f->targetuser.size() && (f->targetuser.size() == 11 || f->targetuser.find("@")!=string::npos) ) // <- uploading to inbox
@@ -17181,6 +17967,26 @@ bool MegaClient::setmaxuploadspeed(m_off_t bpslimit)
     return httpio->setmaxuploadspeed(bpslimit >= 0 ? bpslimit : 0);
 }
 
+bool MegaClient::setmaxdownloadspeed(trafficclass_t tc, m_off_t bpslimit)
+{
+    return httpio->setmaxdownloadspeed(tc, bpslimit >= 0 ? bpslimit : 0);
+}
+
+bool MegaClient::setmaxuploadspeed(trafficclass_t tc, m_off_t bpslimit)
+{
+    return httpio->setmaxuploadspeed(tc, bpslimit >= 0 ? bpslimit : 0);
+}
+
+void MegaClient::setsockettuning(int rcvbuf, int sndbuf, const char* congestionalg, int notsentlowat)
+{
+    HttpIO::SocketTuning tuning;
+    tuning.rcvbuf = rcvbuf > 0 ? rcvbuf : 0;
+    tuning.sndbuf = sndbuf > 0 ? sndbuf : 0;
+    tuning.notsentlowat = notsentlowat > 0 ? notsentlowat : 0;
+    tuning.congestionalg = congestionalg ? congestionalg : "";
+    httpio->setsockettuning(tuning);
+}
+
 m_off_t MegaClient::getmaxdownloadspeed()
 {
     return httpio->getmaxdownloadspeed();
@@ -18092,7 +18898,16 @@ std::string MegaClient::PerformanceStats::report(bool reset, HttpIO* httpio, Wai
         << " cs requests sent/received: " << reqs.csRequestsSent << "/" << reqs.csRequestsCompleted << " batches: " << reqs.csBatchesSent << "/" << reqs.csBatchesReceived << "\n"
         << " transfers active time: " << transfersActiveTime.report(reset) << "\n"
         << " transfer starts/finishes: " << transferStarts << " " << transferFinishes << "\n"
+        << " transfer chunk latency ms: " << transferChunkLatency.report() << "\n"
+        << " transfer ttfb ms: " << transferTimeToFirstByte.report() << "\n"
+        << " transfer conn throughput KB/s: " << transferConnThroughput.report() << "\n"
+        << " sc arrival to parse ms: " << scArrivalToParse.report() << "\n"
+        << " sc arrival to notify ms: " << scArrivalToNotify.report() << "\n"
+        << " sc arrival to delivery ms: " << scArrivalToDelivery.report() << "\n"
+        << " sc response bytes: " << scBytesAtArrival.report() << "\n"
         << " transfer temperror/fails: " << transferTempErrors << " " << transferFails << "\n"
+        << " raid conn switches start/slow/error: " << raidConnSwitchesSlowStart << " " << raidConnSwitchesSlowness << " " << raidConnSwitchesError << "\n"
+        << " exec slice yields/overruns: " << execSliceYields << " " << execSliceOverruns << "\n"
         << " nowait reason: immedate: " << prepwaitImmediate << " zero: " << prepwaitZero << " httpio: " << prepwaitHttpio << " fsaccess: " << prepwaitFsaccess << " nonzero waits: " << nonzeroWait << "\n";
 #ifdef USE_CURL
     if (auto curlhttpio = dynamic_cast<CurlHttpIO*>(httpio))
@@ -18117,6 +18932,8 @@ std::string MegaClient::PerformanceStats::report(bool reset, HttpIO* httpio, Wai
     if (reset)
     {
         transferStarts = transferFinishes = transferTempErrors = transferFails = 0;
+        raidConnSwitchesSlowStart = raidConnSwitchesSlowness = raidConnSwitchesError = 0;
+        execSliceYields = execSliceOverruns = 0;
         prepwaitImmediate = prepwaitZero = prepwaitHttpio = prepwaitFsaccess = nonzeroWait = 0;
     }
     return s.str();
@@ -18547,8 +19364,8 @@ error MegaClient::readSetsAndElements(JSON& j, map<handle, Set>& newSets, map<ha
 
 size_t MegaClient::decryptAllSets(map<handle, Set>& newSets, map<handle, elementsmap_t>& newElements, map<handle, SetElement::NodeMetadata>* nodeData)
 {
-    size_t elCount = 0;
-
+    // Set-level decryption stays on this thread: there are few Sets, and it
+    // needs the master key and public-preview state
     for (auto itS = newSets.begin(); itS != newSets.end();)
     {
         error e = decryptSetData(itS->second);
@@ -18561,56 +19378,138 @@ size_t MegaClient::decryptAllSets(map<handle, Set>& newSets, map<handle, element
             continue;
         }
 
-        auto itEls = newElements.find(itS->first);
-        if (itEls != newElements.end())
+        ++itS;
+    }
+
+    // Element decryption is pure AES/TLV work keyed off the (already decrypted)
+    // Set keys. An album fetch can carry thousands of Elements, so batch it in
+    // chunks across the worker pool instead of unwrapping key by key inline
+    struct ElementDecryptJob
+    {
+        SetElement* el = nullptr;
+        const Set* set = nullptr;
+        SetElement::NodeMetadata* nodeMeta = nullptr;   // only set when 'at' needs decrypting
+        error e = API_OK;
+        bool nodeMetaOk = false;
+    };
+
+    vector<ElementDecryptJob> jobs;
+    set<handle> claimedNodes; // first Element referencing a node claims its metadata, as the serial path did
+    for (auto& itS : newSets)
+    {
+        auto itEls = newElements.find(itS.first);
+        if (itEls == newElements.end())
+        {
+            continue;
+        }
+
+        for (auto& itE : itEls->second)
         {
-            for (auto itE = itEls->second.begin(); itE != itEls->second.end();)
+            ElementDecryptJob job;
+            job.el = &itE.second;
+            job.set = &itS.second;
+
+            if (nodeData)
             {
-                // decrypt element key and attrs
-                e = decryptElementData(itE->second, itS->second.key());
-                if (e != API_OK)
+                auto itNode = nodeData->find(itE.second.node());
+                if (itNode != nodeData->end() && !itNode->second.at.empty()
+                        && claimedNodes.insert(itE.second.node()).second)
                 {
-                    LOG_err << "Failed to decrypt element attributes. "
-                            << "Element id = " << toHandle(itE->first) << ", Element key << " << Base64::btoa(itE->second.key())
-                            << ", Set id = " << toHandle(itS->first) << ", Set key = " << Base64::btoa(itS->second.key()) << ", e = " << e;
-                    assert(false && "failed to decrypt Element attributes"); // failed to decrypt Element attributes
-
-                    itE = itEls->second.erase(itE);
-                    continue;
+                    job.nodeMeta = &itNode->second;
                 }
+            }
 
-                // fill in node attributes in case of having foreign node
-                if (nodeData)
-                {
-                    auto itNode = nodeData->find(itE->second.node());
-                    if (itNode != nodeData->end())
-                    {
-                        SetElement::NodeMetadata& nodeMeta = itNode->second;
+            jobs.push_back(job);
+        }
+    }
 
-                        if (!nodeMeta.at.empty() && decryptNodeMetadata(nodeMeta, itE->second.key()))
-                        {
-                            itE->second.setNodeMetadata(std::move(nodeMeta));
-                        }
+    if (!jobs.empty())
+    {
+        static const size_t DECRYPT_ELEMENTS_CHUNK = 256;
+        size_t chunks = (jobs.size() + DECRYPT_ELEMENTS_CHUNK - 1) / DECRYPT_ELEMENTS_CHUNK;
+        std::mutex doneMutex;
+        std::condition_variable doneCV;
+        size_t chunksLeft = chunks;
 
-                        nodeData->erase(itNode);
-                    }
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            size_t begin = chunk * DECRYPT_ELEMENTS_CHUNK;
+            size_t end = std::min(begin + DECRYPT_ELEMENTS_CHUNK, jobs.size());
 
-                    if (!itE->second.nodeMetadata())
+            mAsyncQueue.push([&jobs, &doneMutex, &doneCV, &chunksLeft, begin, end](SymmCipher& cipher)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    ElementDecryptJob& job = jobs[i];
+                    job.e = decryptElementData(*job.el, job.set->key(), cipher);
+                    if (job.e == API_OK && job.nodeMeta)
                     {
-                        LOG_err << "Invalid node for element. "
-                                << "Element id = " << toHandle(itE->first) << ", Element key << " << Base64::btoa(itE->second.key())
-                                << ", Set id = " << toHandle(itS->first) << ", Set key = " << Base64::btoa(itS->second.key());
-                        itE = itEls->second.erase(itE);
-                        continue;
+                        job.nodeMetaOk = decryptNodeMetadata(*job.nodeMeta, job.el->key(), cipher);
                     }
                 }
 
-                ++elCount;
-                ++itE;
-            }
+                std::lock_guard<std::mutex> g(doneMutex);
+                if (!--chunksLeft)
+                {
+                    doneCV.notify_one();
+                }
+            }, false);
         }
 
-        ++itS;
+        std::unique_lock<std::mutex> g(doneMutex);
+        doneCV.wait(g, [&chunksLeft]() { return !chunksLeft; });
+    }
+
+    // merge the results back on this thread, keeping the serial-path semantics
+    // for failures: drop the Element, keep going
+    size_t elCount = 0;
+    size_t jobIdx = 0;
+
+    for (auto& itS : newSets)
+    {
+        auto itEls = newElements.find(itS.first);
+        if (itEls == newElements.end())
+        {
+            continue;
+        }
+
+        for (auto itE = itEls->second.begin(); itE != itEls->second.end();)
+        {
+            ElementDecryptJob& job = jobs[jobIdx++];
+            assert(job.el == &itE->second);
+
+            if (job.e != API_OK)
+            {
+                LOG_err << "Failed to decrypt element attributes. "
+                        << "Element id = " << toHandle(itE->first) << ", Element key << " << Base64::btoa(itE->second.key())
+                        << ", Set id = " << toHandle(itS.first) << ", Set key = " << Base64::btoa(itS.second.key()) << ", e = " << job.e;
+                assert(false && "failed to decrypt Element attributes"); // failed to decrypt Element attributes
+
+                itE = itEls->second.erase(itE);
+                continue;
+            }
+
+            // fill in node attributes in case of having foreign node
+            if (nodeData)
+            {
+                if (job.nodeMeta && job.nodeMetaOk)
+                {
+                    itE->second.setNodeMetadata(std::move(*job.nodeMeta));
+                }
+
+                if (!itE->second.nodeMetadata())
+                {
+                    LOG_err << "Invalid node for element. "
+                            << "Element id = " << toHandle(itE->first) << ", Element key << " << Base64::btoa(itE->second.key())
+                            << ", Set id = " << toHandle(itS.first) << ", Set key = " << Base64::btoa(itS.second.key());
+                    itE = itEls->second.erase(itE);
+                    continue;
+                }
+            }
+
+            ++elCount;
+            ++itE;
+        }
     }
 
     return elCount;
@@ -18666,6 +19565,11 @@ error MegaClient::decryptSetData(Set& s)
 }
 
 error MegaClient::decryptElementData(SetElement& el, const string& setKey)
+{
+    return decryptElementData(el, setKey, tmpnodecipher);
+}
+
+error MegaClient::decryptElementData(SetElement& el, const string& setKey, SymmCipher& cipher)
 {
     if (!el.id() || el.id() == UNDEF || !el.node() || el.node() == UNDEF || el.key().empty())
     {
@@ -18673,13 +19577,13 @@ error MegaClient::decryptElementData(SetElement& el, const string& setKey)
         return API_EINTERNAL;
     }
 
-    tmpnodecipher.setkey(&setKey);
-    el.setKey(decryptKey(el.key(), tmpnodecipher));
+    cipher.setkey(&setKey);
+    el.setKey(decryptKey(el.key(), cipher));
 
     // decrypt attrs
     if (el.hasEncrAttrs())
     {
-        auto decryptFunc = [this](const string& in, const string& k, string_map& out) { return decryptAttrs(in, k, out); };
+        auto decryptFunc = [&cipher](const string& in, const string& k, string_map& out) { return decryptAttrs(in, k, out, cipher); };
         if (!el.decryptAttributes(decryptFunc))
         {
             LOG_err << "Sets: Unable to decrypt Element attrs " << toHandle(el.id());
@@ -18690,7 +19594,7 @@ error MegaClient::decryptElementData(SetElement& el, const string& setKey)
     return API_OK;
 }
 
-string MegaClient::decryptKey(const string& k, SymmCipher& cipher) const
+string MegaClient::decryptKey(const string& k, SymmCipher& cipher)
 {
     unique_ptr<byte[]> decrKey(new byte[k.size()]{ 0 });
     std::copy_n(k.begin(), k.size(), decrKey.get());
@@ -18733,6 +19637,11 @@ string MegaClient::encryptAttrs(const string_map& attrs, const string& encryptio
 }
 
 bool MegaClient::decryptAttrs(const string& attrs, const string& decrKey, string_map& output)
+{
+    return decryptAttrs(attrs, decrKey, output, tmpnodecipher);
+}
+
+bool MegaClient::decryptAttrs(const string& attrs, const string& decrKey, string_map& output, SymmCipher& cipher)
 {
     if (attrs.empty())
     {
@@ -18742,13 +19651,13 @@ bool MegaClient::decryptAttrs(const string& attrs, const string& decrKey, string
 
     assert(decrKey.size() == SymmCipher::KEYLENGTH || decrKey.size() == FILENODEKEYLENGTH);
 
-    if (!tmpnodecipher.setkey(&decrKey))
+    if (!cipher.setkey(&decrKey))
     {
         LOG_err << "Sets: Failed to assign key to cipher when decrypting attrs";
         return false;
     }
 
-    unique_ptr<TLVstore> sTlv(TLVstore::containerToTLVrecords(&attrs, &tmpnodecipher));
+    unique_ptr<TLVstore> sTlv(TLVstore::containerToTLVrecords(&attrs, &cipher));
     if (!sTlv)
     {
         LOG_err << "Sets: Failed to build TLV container of attrs";
@@ -19008,11 +19917,16 @@ error MegaClient::readSingleNodeMetadata(JSON& j, SetElement::NodeMetadata& eln)
     }
 }
 
-bool MegaClient::decryptNodeMetadata(SetElement::NodeMetadata& nodeMeta, const string& key)
+bool MegaClient::decryptNodeMetadata(SetElement::NodeMetadata& nodeMeta, const string& key, SymmCipher& cipher)
 {
-    SymmCipher* cipher = getRecycledTemporaryNodeCipher(&key);
+    if (!cipher.setkey(&key))
+    {
+        LOG_err << "Decrypting node attributes failed (invalid key). Node Handle = " << toNodeHandle(nodeMeta.h);
+        return false;
+    }
+
     std::unique_ptr<byte[]> buf;
-    buf.reset(Node::decryptattr(cipher, nodeMeta.at.c_str(), nodeMeta.at.size()));
+    buf.reset(Node::decryptattr(&cipher, nodeMeta.at.c_str(), nodeMeta.at.size()));
     if (!buf)
     {
         LOG_err << "Decrypting node attributes failed. Node Handle = " << toNodeHandle(nodeMeta.h);
@@ -19815,7 +20729,7 @@ void MegaClient::notifysetelement(SetElement* e)
 
 void MegaClient::notifypurgesets()
 {
-    if (!fetchingnodes)
+    if (!catchingUpOnActionpackets())
     {
         app->sets_updated(setnotify.data(), (int)setnotify.size());
     }
@@ -19840,7 +20754,7 @@ void MegaClient::notifypurgesets()
 
 void MegaClient::notifypurgesetelements()
 {
-    if (!fetchingnodes)
+    if (!catchingUpOnActionpackets())
     {
         app->setelements_updated(setelementnotify.data(), (int)setelementnotify.size());
     }
@@ -21672,6 +22586,12 @@ bool ScDbStateRecord::serialize(string* s) const
     return s;
 }
 
+bool DnsCacheRecord::serialize(string* s) const
+{
+    s->append(blob);
+    return true;
+}
+
 ScDbStateRecord ScDbStateRecord::unserialize(const std::string& data)
 {
     unsigned char ef[8] = {0, };
@@ -96,6 +96,38 @@ Node::~Node()
 
     client->mNodeManager.decreaseNumNodesInRam();
 }
+
+size_t Node::estimatedRamUsage() const
+{
+    size_t size = sizeof(Node);
+
+    size += nodekeyUnchecked().capacity();
+    size += fileattrstring.capacity();
+
+    if (attrstring)
+    {
+        size += sizeof(string) + attrstring->capacity();
+    }
+
+    for (const auto& attr : attrs.map)
+    {
+        // approximate per-entry overhead of the map plus the stored value
+        size += attr.second.capacity() + 3 * sizeof(void*);
+    }
+
+    if (sharekey)
+    {
+        size += sizeof(SymmCipher);
+    }
+
+    if (plink)
+    {
+        size += sizeof(PublicLink) + plink->mAuthKey.capacity();
+    }
+
+    return size;
+}
+
 int Node::getShareType() const
 {
     int shareType = ShareType_t::NO_SHARES;
@@ -524,7 +556,7 @@ nameid Node::getExtensionNameId(const std::string& ext)
 }
 
 // update node key data from JSON
-void Node::setkeyfromjson(const char* k)
+void Node::setkeyfromjson(std::string_view k)
 {
     string tmp;
     JSON::copystring(&tmp, k);
@@ -550,6 +582,13 @@ void Node::setKey(const string& key)
     nodekeydata = key;
     if (keyApplied()) ++client->mAppliedKeyNodeCount;
     assert(client->mAppliedKeyNodeCount >= 0);
+
+    // cached unwraps of the previous key no longer match
+    client->mUnwrappedNodeKeys.erase(nodeHandle());
+    if (keyApplied())
+    {
+        client->mUnwrappedNodeKeys.put(nodeHandle(), nodekeydata);
+    }
 }
 
 std::shared_ptr<Node> Node::unserialize(MegaClient& client, const std::string *d, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares)
@@ -701,7 +740,7 @@ std::shared_ptr<Node> Node::unserialize(MegaClient& client, const std::string *d
         skey = NULL;
     }
 
-    shared_ptr<Node> n = std::make_shared<Node>(client, NodeHandle().set6byte(h), NodeHandle().set6byte(ph), t, s, u, fa, ts);
+    shared_ptr<Node> n = std::allocate_shared<Node>(PooledAllocator<Node>(), client, NodeHandle().set6byte(h), NodeHandle().set6byte(ph), t, s, u, fa, ts);
 
     // read inshare, outshares, or pending shares
     while (numshares)   // inshares: -1, outshare/s: num_shares
@@ -872,29 +911,34 @@ bool Node::serialize(string* d) const
     short numshares;
     m_off_t s;
 
+    // the fixed fields go through a stack batcher: one string append per
+    // run instead of one per field
+    d->reserve(d->size() + 128 + nodekeydata.size() + fileattrstring.size());
+    BatchedWriter w(*d);
+
     s = type ? -type : size;
 
-    d->append((char*)&s, sizeof s);
+    w.appendvalue(s);
 
-    d->append((char*)&nodehandle, MegaClient::NODEHANDLE);
+    w.append(&nodehandle, MegaClient::NODEHANDLE);
 
     if (parenthandle != UNDEF)
     {
-        d->append((char*)&parenthandle, MegaClient::NODEHANDLE);
+        w.append(&parenthandle, MegaClient::NODEHANDLE);
     }
     else
     {
-        d->append("\0\0\0\0\0", MegaClient::NODEHANDLE);
+        w.appendfill(MegaClient::NODEHANDLE, '\0');
     }
 
-    d->append((char*)&owner, MegaClient::USERHANDLE);
+    w.append(&owner, MegaClient::USERHANDLE);
 
     // FIXME: use Serialize64
     time_t ts = 0;  // we don't want to break backward compatibility by changing the size (where m_time_t differs)
-    d->append((char*)&ts, sizeof(ts));
+    w.appendvalue(ts);
 
     ts = (time_t)ctime;
-    d->append((char*)&ts, sizeof(ts));
+    w.appendvalue(ts);
 
     if (attrstring)
     {
@@ -909,46 +953,46 @@ bool Node::serialize(string* d) const
             length = FILENODEKEYLENGTH;
         }
 
-        d->append(length, '\0');
+        w.appendfill(length, '\0');
     }
     else
     {
-        d->append(nodekeydata);
+        w.append(nodekeydata);
     }
 
     if (type == FILENODE)
     {
         ll = static_cast<unsigned short>(fileattrstring.size() + 1);
-        d->append((char*)&ll, sizeof ll);
-        d->append(fileattrstring.c_str(), ll);
+        w.appendvalue(ll);
+        w.append(fileattrstring.c_str(), ll);
     }
 
     char isExported = plink ? 1 : 0;
-    d->append((char*)&isExported, 1);
+    w.appendvalue(isExported);
 
     char hasLinkCreationTs = plink ? 1 : 0;
-    d->append((char*)&hasLinkCreationTs, 1);
+    w.appendvalue(hasLinkCreationTs);
 
     if (isExported && plink && plink->mAuthKey.size())
     {
         auto authKeySize = (char)plink->mAuthKey.size();
-        d->append((char*)&authKeySize, sizeof(authKeySize));
-        d->append(plink->mAuthKey.data(), authKeySize);
+        w.appendvalue(authKeySize);
+        w.append(plink->mAuthKey.data(), authKeySize);
     }
     else
     {
-        d->append("", 1);
+        w.appendfill(1, '\0');
     }
 
-    d->append(1, static_cast<char>(!!attrstring));
+    w.appendfill(1, static_cast<char>(!!attrstring));
 
     if (attrstring)
     {
-        d->append(1, '\1');
+        w.appendfill(1, '\1');
     }
 
     // Use these bytes for extensions.
-    d->append(4, '\0');
+    w.appendfill(4, '\0');
 
     if (inshare)
     {
@@ -967,19 +1011,21 @@ bool Node::serialize(string* d) const
         }
     }
 
-    d->append((char*)&numshares, sizeof numshares);
+    w.appendvalue(numshares);
 
     if (numshares)
     {
         if (sharekey)
         {
-            d->append((char*)sharekey->key, SymmCipher::KEYLENGTH);
+            w.append(sharekey->key, SymmCipher::KEYLENGTH);
         }
         else // with ^!keys, shares may not receive the sharekey along with the share's data
         {
-            d->append(SymmCipher::KEYLENGTH, '\0');
+            w.appendfill(SymmCipher::KEYLENGTH, '\0');
         }
 
+        w.flush();
+
         if (inshare)
         {
             inshare->serialize(d);
@@ -1003,16 +1049,17 @@ bool Node::serialize(string* d) const
         }
     }
 
+    w.flush();
     attrs.serialize(d);
 
     if (isExported)
     {
-        d->append((char*) &plink->ph, MegaClient::NODEHANDLE);
-        d->append((char*) &plink->ets, sizeof(plink->ets));
-        d->append((char*) &plink->takendown, sizeof(plink->takendown));
+        w.append(&plink->ph, MegaClient::NODEHANDLE);
+        w.appendvalue(plink->ets);
+        w.appendvalue(plink->takendown);
         if (hasLinkCreationTs)
         {
-            d->append((char*) &plink->cts, sizeof(plink->cts));
+            w.appendvalue(plink->cts);
         }
     }
 
@@ -1021,13 +1068,13 @@ bool Node::serialize(string* d) const
     {
         // Write node key data.
         uint32_t length = static_cast<uint32_t>(nodekeydata.size());
-        d->append((char*)&length, sizeof(length));
-        d->append(nodekeydata, 0, length);
+        w.appendvalue(length);
+        w.append(nodekeydata.data(), length);
 
         // Write attribute string data.
         length = static_cast<uint32_t>(attrstring->size());
-        d->append((char*)&length, sizeof(length));
-        d->append(*attrstring, 0, length);
+        w.appendvalue(length);
+        w.append(attrstring->data(), length);
     }
 
     return true;
@@ -1136,6 +1183,16 @@ void Node::setattr()
         delete[] buf;
 
         attrstring.reset();
+        mPendingAttrDecryption = false;
+    }
+}
+
+void Node::ensureAttrsDecrypted()
+{
+    if (mPendingAttrDecryption)
+    {
+        mPendingAttrDecryption = false;
+        setattr();
     }
 }
 
@@ -1304,6 +1361,8 @@ bool Node::hasName() const
 // return file/folder name or special status strings
 const char* Node::displayname() const
 {
+    const_cast<Node*>(this)->ensureAttrsDecrypted();
+
     // not yet decrypted
     if (attrstring)
     {
@@ -1311,11 +1370,10 @@ const char* Node::displayname() const
         return "NO_KEY";
     }
 
-    attr_map::const_iterator it;
-
-    it = attrs.map.find('n');
+    // reads straight from the serialized blob if the map wasn't materialized
+    const string* name = attrs.map.getquick('n');
 
-    if (it == attrs.map.end())
+    if (!name)
     {
         if (type < ROOTNODE || type > RUBBISHNODE)
         {
@@ -1324,13 +1382,13 @@ const char* Node::displayname() const
         return "CRYPTO_ERROR";
     }
 
-    if (!it->second.size())
+    if (!name->size())
     {
         LOG_debug << "BLANK " << type << " " << size << " " << nodehandle;
         return "BLANK";
     }
 
-    return it->second.c_str();
+    return name->c_str();
 }
 
 string Node::displaypath() const
@@ -1438,7 +1496,7 @@ int Node::hasfileattribute(const string *fileattrstring, fatype t)
 }
 
 // attempt to apply node key - sets nodekey to a raw key if successful
-bool Node::applykey()
+bool Node::applykey(bool deferAttrDecryption)
 {
     if (type > FOLDERNODE)
     {
@@ -1451,6 +1509,66 @@ bool Node::applykey()
         return false;
     }
 
+    unsigned keylength = (type == FILENODE) ? FILENODEKEYLENGTH : FOLDERNODEKEYLENGTH;
+
+    // an earlier unwrap of this node's key may have outlived the Node object
+    // itself (eg. evicted from RAM and reloaded from DB since)
+    string cachedKey;
+    if (client->mUnwrappedNodeKeys.get(nodeHandle(), cachedKey) && cachedKey.size() == keylength)
+    {
+        commitUnwrappedKey((const byte*)cachedKey.data(), keylength, deferAttrDecryption);
+        bool cacheApplied = keyApplied();
+        if (!cacheApplied)
+        {
+            // stale entry: the node's key changed since it was cached
+            client->mUnwrappedNodeKeys.erase(nodeHandle());
+        }
+        return cacheApplied;
+    }
+
+    const char* k = NULL;
+    SymmCipher* sc = resolveKeySource(k);
+
+    if (!sc)
+    {
+        // no suitable key available yet - bail (it might arrive soon)
+        return false;
+    }
+
+    byte key[FILENODEKEYLENGTH];
+
+    if (client->decryptkey(k, key, keylength, sc, 0, nodehandle))
+    {
+        commitUnwrappedKey(key, keylength, deferAttrDecryption);
+    }
+
+    bool applied = keyApplied();
+    if (applied)
+    {
+        // share the unwrap with later lookups - including ones for reloaded
+        // copies of this node, after this object is evicted from RAM
+        client->mUnwrappedNodeKeys.put(nodeHandle(), nodekeydata);
+    }
+    else
+    {
+        LOG_warn << "Failed to apply key for node: " << Base64Str<MegaClient::NODEHANDLE>(nodehandle);
+        // keys could be missing due to nested inshares with multiple users: user A shares a folder 1
+        // with user B and folder 1 has a subfolder folder 1_1. User A shares folder 1_1 with user C
+        // and user C adds some files, which will be undecryptable for user B.
+        // The ticket SDK-1959 aims to mitigate the problem. Uncomment next line when done:
+        // assert(applied);
+        // This can also happen due to a race condition between the creation / destruction of shares
+        // the retrieval keys using "pk" and the update of the "^!keys" attribute.
+        // If a folder is shared / unshared / shared, it's possible to reach this code with the old share
+        // key, that could be in "mNewKeyRepository" (not in n->sharekey because Node::testShareKey is
+        // used to prevent it).
+    }
+
+    return applied;
+}
+
+SymmCipher* Node::resolveKeySource(const char*& wrappedKey)
+{
     int l = -1;
     size_t t = 0;
     handle h;
@@ -1530,50 +1648,49 @@ bool Node::applykey()
         }
         else
         {
-            return false;
+            return NULL;
         }
     }
 
-    byte key[FILENODEKEYLENGTH];
-    unsigned keylength = (type == FILENODE) ? FILENODEKEYLENGTH : FOLDERNODEKEYLENGTH;
+    wrappedKey = k;
+    return sc;
+}
 
-    if (client->decryptkey(k, key, keylength, sc, 0, nodehandle))
+void Node::commitUnwrappedKey(const byte* unwrappedKey, unsigned keylength, bool deferAttrDecryption)
+{
+    std::string undecryptedKey = nodekeydata;
+    client->mAppliedKeyNodeCount++;
+    nodekeydata.assign((const char*)unwrappedKey, keylength);
+
+    bool attrsOk;
+    if (deferAttrDecryption && attrstring)
+    {
+        // decrypting checks the key (magic number prefix), but parsing the
+        // attributes and rebuilding the map is left until they are read
+        SymmCipher* cipher = nodecipher();
+        byte* buf = cipher ? decryptattr(cipher, attrstring->c_str(), attrstring->size()) : nullptr;
+        attrsOk = buf != nullptr;
+        mPendingAttrDecryption = attrsOk;
+        delete[] buf;
+    }
+    else
     {
-        std::string undecryptedKey = nodekeydata;
-        client->mAppliedKeyNodeCount++;
-        nodekeydata.assign((const char*)key, keylength);
         setattr();
-        if (attrstring)
-        {
-            if (foreignkey)
-            {
-                // Decryption with a foreign share key failed.
-                // Restoring the undecrypted node key because an updated
-                // share key can be received later.
-                client->mAppliedKeyNodeCount--;
-                nodekeydata = undecryptedKey;
-            }
-            LOG_warn << "Failed to decrypt attributes for node: " << toNodeHandle(nodehandle);
-        }
+        attrsOk = !attrstring;
     }
 
-    bool applied = keyApplied();
-    if (!applied)
+    if (!attrsOk)
     {
-        LOG_warn << "Failed to apply key for node: " << Base64Str<MegaClient::NODEHANDLE>(nodehandle);
-        // keys could be missing due to nested inshares with multiple users: user A shares a folder 1
-        // with user B and folder 1 has a subfolder folder 1_1. User A shares folder 1_1 with user C
-        // and user C adds some files, which will be undecryptable for user B.
-        // The ticket SDK-1959 aims to mitigate the problem. Uncomment next line when done:
-        // assert(applied);
-        // This can also happen due to a race condition between the creation / destruction of shares
-        // the retrieval keys using "pk" and the update of the "^!keys" attribute.
-        // If a folder is shared / unshared / shared, it's possible to reach this code with the old share
-        // key, that could be in "mNewKeyRepository" (not in n->sharekey because Node::testShareKey is
-        // used to prevent it).
+        if (foreignkey)
+        {
+            // Decryption with a foreign share key failed.
+            // Restoring the undecrypted node key because an updated
+            // share key can be received later.
+            client->mAppliedKeyNodeCount--;
+            nodekeydata = undecryptedKey;
+        }
+        LOG_warn << "Failed to decrypt attributes for node: " << toNodeHandle(nodehandle);
     }
-
-    return applied;
 }
 
 bool Node::testShareKey(const byte *shareKey)
@@ -1681,10 +1798,10 @@ std::shared_ptr<Node> Node::latestFileVersion() const
 
 unsigned Node::depth() const
 {
-    auto node = latestFileVersion();
+    const Node* node = latestFileVersion().get();   // 'this' pins the chain; raw hops avoid refcount churn
     unsigned depth = 0u;
 
-    for ( ; node->parent.get(); node = node->parent)
+    for ( ; node->parent.get(); node = node->parent.get())
         ++depth;
 
     return depth;
@@ -1800,14 +1917,15 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
             }
         }
 
-        if (slocalname && (
+        if (slocalname && parent->hasRare() && (
             parentChange || shortnameChange))
         {
             // remove existing child linkage for slocalname
-            auto it = parent->schildren.find(*slocalname);
-            if (it != parent->schildren.end() && it->second == this)
+            auto& sc = parent->rare().schildren;
+            auto it = sc.find(*slocalname);
+            if (it != sc.end() && it->second == this)
             {
-                parent->schildren.erase(it);
+                sc.erase(it);
             }
         }
     }
@@ -1826,6 +1944,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
         // set new name
         localname = newlocalpath;
         toName_of_localname = localname.toName(*sync->syncs.fsaccess);
+        mNameHash = canonicalNameHash(toName_of_localname);
     }
 
     if (shortnameChange)
@@ -1862,7 +1981,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
     {
         // it's quite possible that the new folder still has an older LocalNode with clashing shortname, that represents a file/folder since moved, but which we don't know about yet.
         // just assign the new one, we forget the old reference.  The other LocalNode will not remove this one since the LocalNode* will not match.
-        parent->schildren[*slocalname] = this;
+        parent->rare().schildren[*slocalname] = this;
     }
 
     // reset treestate
@@ -1930,6 +2049,103 @@ void LocalNode::bumpnagleds()
     nagleds = Waiter::ds + 11;
 }
 
+namespace {
+
+// Pooled storage for LocalNode.  Nodes are carved from fixed-size chunks and
+// recycled through a free list, so each node costs exactly one slot instead
+// of a general-purpose heap allocation with its header and fragmentation.
+// Chunks are retained for the lifetime of the process: the pool's peak is set
+// by the largest tree synced, which a long-running client reaches again
+// anyway.
+class LocalNodePool
+{
+public:
+    void* allocate(size_t size)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        if (!mFreeList)
+        {
+            grow(size);
+        }
+
+        FreeSlot* slot = mFreeList;
+        mFreeList = slot->next;
+        return slot;
+    }
+
+    void deallocate(void* ptr)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+        slot->next = mFreeList;
+        mFreeList = slot;
+    }
+
+private:
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    static const size_t NODES_PER_CHUNK = 256;
+
+    void grow(size_t size)
+    {
+        // round the slot size up so every slot stays suitably aligned
+        size_t slotSize = (size + alignof(std::max_align_t) - 1)
+                          & ~(alignof(std::max_align_t) - 1);
+
+        mChunks.emplace_back(new char[slotSize * NODES_PER_CHUNK]);
+
+        char* chunk = mChunks.back().get();
+
+        for (size_t i = NODES_PER_CHUNK; i--; )
+        {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + i * slotSize);
+            slot->next = mFreeList;
+            mFreeList = slot;
+        }
+    }
+
+    vector<std::unique_ptr<char[]>> mChunks;
+    FreeSlot* mFreeList = nullptr;
+    std::mutex mMutex;
+};
+
+LocalNodePool& localNodePool()
+{
+    // deliberately leaked: LocalNodes owned by objects with static storage
+    // duration must be able to return their slots during teardown
+    static LocalNodePool* pool = new LocalNodePool;
+    return *pool;
+}
+
+} // anonymous namespace
+
+void* LocalNode::operator new(size_t size)
+{
+    if (size != sizeof(LocalNode))
+    {
+        // the pool only serves slots of exactly sizeof(LocalNode)
+        return ::operator new(size);
+    }
+
+    return localNodePool().allocate(size);
+}
+
+void LocalNode::operator delete(void* ptr, size_t size)
+{
+    if (size != sizeof(LocalNode))
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    localNodePool().deallocate(ptr);
+}
+
 LocalNode::LocalNode(Sync* csync)
 : sync(csync)
 , scanAgain(TREE_RESOLVED)
@@ -1959,6 +2175,9 @@ LocalNode::LocalNode(Sync* csync)
     syncedCloudNodeHandle_it = sync->syncs.localnodeByNodeHandle.end();
 
     sync->syncs.totalLocalNodes++;
+
+    // fixed footprint only - the contained paths are small against sizeof(LocalNode)
+    MemoryAccounting::get().add(MEM_LOCALNODES, sizeof(LocalNode));
 }
 
 // initialize fresh LocalNode object - must be called exactly once
@@ -2014,6 +2233,7 @@ void LocalNode::init(nodetype_t ctype, LocalNode* cparent, const LocalPath& cful
     {
         localname = cfullpath;
         toName_of_localname = localname.toName(*sync->syncs.fsaccess);
+        mNameHash = canonicalNameHash(toName_of_localname);
         slocalname.reset(shortname && *shortname != localname ? shortname.release() : nullptr);
 
         mExclusionState = ES_INCLUDED;
@@ -2075,6 +2295,7 @@ void LocalNode::trimRareFields()
             !rareFields->createFolderHere &&
             !rareFields->removeNodeHere &&
             rareFields->unlinkHere.expired() &&
+            rareFields->schildren.empty() &&
             rareFields->localFSRenamedToThisName.empty())
         {
             rareFields.reset();
@@ -2098,6 +2319,13 @@ void LocalNode::setScanAgain(bool doParent, bool doHere, bool doBelow, dstime de
         scanObsolete = true;
     }
 
+    if (doHere)
+    {
+        // something changed in this folder specifically; the previous scan's
+        // signature no longer stands for its content
+        scanSigDigest = 0;
+    }
+
     auto state = TreeState((doHere?1u:0u) << 1 | (doBelow?1u:0u));
 
     if (state >= TREE_ACTION_HERE && delayds > 0)
@@ -2329,6 +2557,95 @@ bool isDoNotSyncFileName(const string& name)
            || name == "Icon\x0d";  // on mac, icon for the folder (maybe automatic or if the user chooses an icon?).  Awkward for the control character.  Possibly only produced by older OS?
 }
 
+// Per-entry hash for folder scan signatures (FNV-1a over the identifying
+// fields).  Entries are combined by addition so the digest is independent of
+// enumeration order and can be recomputed from the children map.
+static uint64_t scanSignatureEntryHash(const LocalPath& localname, nodetype_t type, const FileFingerprint& fp, handle fsid)
+{
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const void* bytes, size_t len)
+    {
+        for (auto p = static_cast<const unsigned char*>(bytes); len--; )
+        {
+            h = (h ^ *p++) * 1099511628211ull;
+        }
+    };
+
+    string name = localname.platformEncoded();
+    mix(name.data(), name.size());
+    mix(&type, sizeof(type));
+    mix(&fp.size, sizeof(fp.size));
+    mix(&fp.mtime, sizeof(fp.mtime));
+    mix(&fsid, sizeof(fsid));
+    return h;
+}
+
+bool LocalNode::scanSignatureUnchanged(const SyncRow& row) const
+{
+    if (!scanSigDigest || neverScanned || !row.fsNode)
+    {
+        return false;
+    }
+
+    // expired signatures force a real scan: that is the escape hatch for
+    // changes a directory mtime cannot show
+    if (Waiter::ds >= scanSigRecordedDs + SCAN_SIGNATURE_TTL_DS)
+    {
+        return false;
+    }
+
+    // the folder must still be the same filesystem object, seen at the same mtime
+    if (row.fsNode->fsid != fsid_asScanned ||
+        row.fsNode->fingerprint.mtime != scanSigMtime)
+    {
+        return false;
+    }
+
+    // and the data we would reuse must still digest to what that scan
+    // produced (lastFolderScan may since have been replaced with results for
+    // an outdated fsid, or freed once the children were proven to regenerate
+    // it exactly - in which case we digest the children instead)
+    uint64_t digest;
+
+    if (lastFolderScan)
+    {
+        digest = 1;
+        for (auto& f : *lastFolderScan)
+        {
+            digest += 1 + scanSignatureEntryHash(f.localname, f.type, f.fingerprint, f.fsid);
+        }
+    }
+    else
+    {
+        digest = 1;
+        for (auto& childIt : children)
+        {
+            if (childIt.second->fsid_asScanned != UNDEF)
+            {
+                // count entries the same way the recorded digest did
+                digest += 1 + scanSignatureEntryHash(childIt.second->localname,
+                                                     childIt.second->type,
+                                                     childIt.second->scannedFingerprint,
+                                                     childIt.second->fsid_asScanned);
+            }
+        }
+    }
+
+    return digest == scanSigDigest;
+}
+
+void LocalNode::clearScanSignatures()
+{
+    scanSigDigest = 0;
+    for (auto& childIt : children)
+    {
+        if (childIt.second->type != FILENODE)
+        {
+            childIt.second->clearScanSignatures();
+        }
+    }
+}
+
 bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
 {
     bool syncHere = false;
@@ -2339,17 +2656,34 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
 
     std::shared_ptr<ScanService::ScanRequest> ourScanRequest = scanInProgress ? rare().scanRequest  : nullptr;
 
-    std::shared_ptr<ScanService::ScanRequest>* availableScanSlot = nullptr;
-    if (!sync->mActiveScanRequestGeneral || sync->mActiveScanRequestGeneral->completed())
-    {
-        availableScanSlot = &sync->mActiveScanRequestGeneral;
-    }
-    else if (neverScanned &&
-            (!sync->mActiveScanRequestUnscanned || sync->mActiveScanRequestUnscanned->completed()))
+    if (!ourScanRequest && scanSignatureUnchanged(row))
     {
-        availableScanSlot = &sync->mActiveScanRequestUnscanned;
+        // The folder and the entries we hold for it still match the last
+        // completed scan, so satisfy this rescan from those results instead
+        // of going back to disk.  setScanAgain() with doHere and the
+        // signature TTL bound how long we can keep doing so.
+        LOG_verbose << sync->syncname << "Folder scan signature unchanged, reusing previous results for: " << fullPath.localPath;
+
+        scanDelayUntil = Waiter::ds + 20; // don't scan too frequently
+        scanAgain = TREE_RESOLVED;
+        setSyncAgain(false, true, false);
+        return true;
     }
 
+    // drop completed requests so they free their slots
+    auto& activeScans = sync->mActiveScanRequests;
+    activeScans.erase(std::remove_if(activeScans.begin(), activeScans.end(),
+                                     [](const std::shared_ptr<ScanService::ScanRequest>& r)
+                                     {
+                                         return !r || r->completed();
+                                     }),
+                      activeScans.end());
+
+    // general rescans may not take the last slot: it stays reserved for
+    // never-scanned folders so the initial scan always progresses
+    bool availableScanSlot = activeScans.size() + 1 < Sync::MAX_ACTIVE_SCAN_REQUESTS
+                          || (neverScanned && activeScans.size() < Sync::MAX_ACTIVE_SCAN_REQUESTS);
+
     if (!ourScanRequest && availableScanSlot)
     {
         // we can start a single new request if we are still recursing and the last request from this sync completed already
@@ -2419,16 +2753,16 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
                 row.fsNode->fsid, false, move(priorScanChildren), sync->syncs.waiter);
 
             rare().scanRequest = ourScanRequest;
-            *availableScanSlot = ourScanRequest;
+            activeScans.push_back(ourScanRequest);
 
-            LOG_verbose << sync->syncname << "Issuing Directory scan request for : " << fullPath.localPath << (availableScanSlot == &sync->mActiveScanRequestUnscanned ? " (in unscanned slot)" : "");
+            LOG_verbose << sync->syncname << "Issuing Directory scan request for : " << fullPath.localPath << " (" << activeScans.size() << " of " << Sync::MAX_ACTIVE_SCAN_REQUESTS << " slots in use)";
         }
     }
     else if (ourScanRequest &&
              ourScanRequest->completed())
     {
-        if (ourScanRequest == sync->mActiveScanRequestGeneral) sync->mActiveScanRequestGeneral.reset();
-        if (ourScanRequest == sync->mActiveScanRequestUnscanned) sync->mActiveScanRequestUnscanned.reset();
+        activeScans.erase(std::remove(activeScans.begin(), activeScans.end(), ourScanRequest),
+                          activeScans.end());
 
         scanInProgress = false;
 
@@ -2474,6 +2808,9 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
 
             LOG_verbose << sync->syncname << "Received " << lastFolderScan->size() << " directory scan results for: " << fullPath.localPath;
 
+            ++sync->mScannedFolders;
+            sync->mScannedItems += lastFolderScan->size();
+
             if (neverScanned)
             {
                 neverScanned = 0;
@@ -2482,6 +2819,26 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
                 LOG_verbose << sync->syncname << "Remaining known unscanned folders: " << sync->threadSafeState->neverScannedFolderCount.load();
             }
 
+            // Record the scan signature so an unchanged subtree can be pruned
+            // from later full rescans.  Skip folders modified within mtime
+            // granularity of the scan: a write landing in the same timestamp
+            // tick would be invisible to the signature (FAT stores 2s steps).
+            if (m_time() - row.fsNode->fingerprint.mtime > 2)
+            {
+                uint64_t digest = 1;
+                for (auto& f : *lastFolderScan)
+                {
+                    digest += 1 + scanSignatureEntryHash(f.localname, f.type, f.fingerprint, f.fsid);
+                }
+                scanSigMtime = row.fsNode->fingerprint.mtime;
+                scanSigDigest = digest;
+                scanSigRecordedDs = Waiter::ds;
+            }
+            else
+            {
+                scanSigDigest = 0;
+            }
+
             scanDelayUntil = Waiter::ds + 20; // don't scan too frequently
             scanAgain = TREE_RESOLVED;
             setSyncAgain(false, true, false);
@@ -2772,6 +3129,7 @@ LocalNode::~LocalNode()
 
     sync->syncs.totalLocalNodes--;
     sync->threadSafeState->incrementSyncNodeCount(type, -1);
+    MemoryAccounting::get().sub(MEM_LOCALNODES, sizeof(LocalNode));
 
     // remove parent association
     if (parent)
@@ -2909,14 +3267,28 @@ string LocalNode::debugGetParentList()
 // locate child by localname or slocalname
 LocalNode* LocalNode::childbyname(LocalPath* localname)
 {
-    localnode_map::iterator it;
-
-    if (!localname || ((it = children.find(*localname)) == children.end() && (it = schildren.find(*localname)) == schildren.end()))
+    if (!localname)
     {
         return NULL;
     }
 
-    return it->second;
+    auto it = children.find(*localname);
+    if (it != children.end())
+    {
+        return it->second;
+    }
+
+    if (hasRare())
+    {
+        auto& sc = rare().schildren;
+        auto sit = sc.find(*localname);
+        if (sit != sc.end())
+        {
+            return sit->second;
+        }
+    }
+
+    return NULL;
 }
 
 LocalNode* LocalNode::findChildWithSyncedNodeHandle(NodeHandle h)
@@ -3342,6 +3714,10 @@ WatchResult LocalNode::watch(const LocalPath& path, handle fsid)
     if (!sync->dirnotify)
         return WR_SUCCESS;
 
+    // A filesystem-wide fanotify mark already covers every directory.
+    if (static_cast<LinuxDirNotify&>(*sync->dirnotify).usingFanotify())
+        return WR_SUCCESS;
+
     // Do we need to (re)create a watch?
     if (mWatchHandle == fsid)
     {
@@ -3441,6 +3817,8 @@ ExclusionState LocalNode::calcExcluded(RemotePathPair namePath, nodetype_t type,
             // Should we only consider inheritable filter rules?
             inherited = inherited || node != this;
 
+            ++sync->mFilterEvaluations;
+
             // Check for a filter match.
             auto result = node->filterChainRO().match(namePath, type, inherited);
 
@@ -28,6 +28,63 @@
 
 namespace mega {
 
+namespace {
+
+// Allocator that records the size of the blocks requested through it. Used to
+// measure the tree node allocation a nodemanagernode_map performs internally,
+// which the standard gives no portable way to name directly.
+template <typename T>
+struct AllocationSizeProbe
+{
+    using value_type = T;
+
+    size_t* mRecorded;
+
+    explicit AllocationSizeProbe(size_t* recorded)
+        : mRecorded(recorded)
+    {
+    }
+
+    template <typename U>
+    AllocationSizeProbe(const AllocationSizeProbe<U>& other)
+        : mRecorded(other.mRecorded)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        *mRecorded = n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const AllocationSizeProbe<U>&) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AllocationSizeProbe<U>&) const { return false; }
+};
+
+// Block size mNodes hands to its pool per inserted node; the probe map shares
+// the value type and comparator, so its tree node layout matches
+size_t nodesMapBlockSize(NodeManager& nodeManager)
+{
+    size_t blockSize = 0;
+
+    using ProbeAllocator = AllocationSizeProbe<std::pair<const NodeHandle, NodeManagerNode>>;
+    std::map<NodeHandle, NodeManagerNode, std::less<NodeHandle>, ProbeAllocator>
+        probe{std::less<NodeHandle>(), ProbeAllocator(&blockSize)};
+
+    probe.emplace(NodeHandle(), NodeManagerNode(nodeManager, NodeHandle()));
+    return blockSize;
+}
+
+} // anonymous namespace
+
 
 NodeManager::NodeManager(MegaClient& client)
     : mClient(client)
@@ -35,6 +92,11 @@ NodeManager::NodeManager(MegaClient& client)
 {
 }
 
+NodeManager::~NodeManager()
+{
+    stopPrefetchThread();
+}
+
 void NodeManager::setTable(DBTableNodes *table)
 {
     LockGuard g(mMutex);
@@ -259,8 +321,15 @@ std::shared_ptr<Node> NodeManager::getNodeByHandle_internal(NodeHandle handle)
     }
 
     std::shared_ptr<Node> node = getNodeInRAM(handle);
-    if (!node)
+    if (node)
     {
+        ++mCacheLRUHits;
+        PerfCounters::get().add(PERF_NODE_CACHE_HITS);
+    }
+    else
+    {
+        ++mCacheLRUMisses;
+        PerfCounters::get().add(PERF_NODE_CACHE_MISSES);
         node = getNodeFromDataBase(handle);
     }
 
@@ -270,7 +339,133 @@ std::shared_ptr<Node> NodeManager::getNodeByHandle_internal(NodeHandle handle)
 sharedNode_list NodeManager::getChildren(const Node *parent, CancelToken cancelToken)
 {
     LockGuard g(mMutex);
-    return getChildren_internal(parent, cancelToken);
+    sharedNode_list children = getChildren_internal(parent, cancelToken);
+
+    // the caller is about to display this folder: bulk-resolve any attributes
+    // whose decryption was deferred by applykey()
+    for (auto& child : children)
+    {
+        child->ensureAttrsDecrypted();
+    }
+
+    if (mPrefetchEnabled && parent)
+    {
+        schedulePrefetchAround(parent);
+    }
+
+    return children;
+}
+
+void NodeManager::enableChildPrefetch(bool enable)
+{
+    mPrefetchEnabled = enable;
+
+    if (enable)
+    {
+        std::lock_guard<std::mutex> g(mPrefetchMutex);
+        if (!mPrefetchThread.joinable())
+        {
+            mPrefetchStop = false;
+            mPrefetchThread = std::thread([this]() { prefetchLoop(); });
+        }
+    }
+}
+
+bool NodeManager::childPrefetchEnabled() const
+{
+    return mPrefetchEnabled;
+}
+
+void NodeManager::schedulePrefetchAround(const Node* parent)
+{
+    assert(mMutex.owns_lock());
+
+    // warm the expanded folder's siblings...
+    queuePrefetch(parent->parentHandle());
+
+    // ...and the listings of its first subfolders (grandchild rows)
+    unsigned queued = 0;
+    for (auto& itNode : mNodes)
+    {
+        // only consider children already in RAM: they were just loaded by
+        // getChildren_internal, so this doesn't add DB work on this thread
+        shared_ptr<Node> child = itNode.second.getNodeInRam(false);
+        if (child && child->type == FOLDERNODE && child->parentHandle() == parent->nodeHandle())
+        {
+            queuePrefetch(child->nodeHandle());
+            if (++queued == 16)
+            {
+                break;
+            }
+        }
+    }
+}
+
+void NodeManager::queuePrefetch(NodeHandle parent)
+{
+    if (parent.isUndef())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> g(mPrefetchMutex);
+    if (std::find(mPrefetchQueue.begin(), mPrefetchQueue.end(), parent) != mPrefetchQueue.end())
+    {
+        return;
+    }
+
+    if (mPrefetchQueue.size() >= MAX_PREFETCH_QUEUE)
+    {
+        mPrefetchQueue.pop_front();   // oldest hint is the least likely to still matter
+    }
+
+    mPrefetchQueue.push_back(parent);
+    mPrefetchCV.notify_one();
+}
+
+void NodeManager::prefetchLoop()
+{
+    for (;;)
+    {
+        NodeHandle target;
+        {
+            std::unique_lock<std::mutex> lock(mPrefetchMutex);
+            mPrefetchCV.wait(lock, [this]() { return mPrefetchStop || !mPrefetchQueue.empty(); });
+            if (mPrefetchStop)
+            {
+                return;
+            }
+
+            target = mPrefetchQueue.front();
+            mPrefetchQueue.pop_front();
+        }
+
+        if (!mPrefetchEnabled)
+        {
+            continue;   // drain silently while disabled
+        }
+
+        LockGuard g(mMutex);
+        shared_ptr<Node> parent = getNodeByHandle_internal(target);
+        if (parent)
+        {
+            getChildren_internal(parent.get());
+        }
+    }
+}
+
+void NodeManager::stopPrefetchThread()
+{
+    {
+        std::lock_guard<std::mutex> g(mPrefetchMutex);
+        mPrefetchStop = true;
+    }
+    mPrefetchCV.notify_one();
+
+    if (mPrefetchThread.joinable())
+    {
+        mPrefetchThread.join();
+    }
 }
 
 sharedNode_list NodeManager::getChildren_internal(const Node *parent, CancelToken cancelToken)
@@ -709,6 +904,42 @@ sharedNode_vector NodeManager::getNodesByFingerprint_internal(FileFingerprint &f
     return nodes;
 }
 
+NodeHandle NodeManager::handleByFingerprint(FileFingerprint& fingerprint)
+{
+    LockGuard g(mMutex);
+    return handleByFingerprint_internal(fingerprint);
+}
+
+NodeHandle NodeManager::handleByFingerprint_internal(FileFingerprint& fingerprint)
+{
+    assert(mMutex.owns_lock());
+
+    NodeHandle handle;
+    if (!mTable || mNodes.empty())
+    {
+        assert(false);
+        return handle;
+    }
+
+    auto it = mFingerPrints.find(&fingerprint);
+    if (it != mFingerPrints.end())
+    {
+        return static_cast<Node*>(*it)->nodeHandle();
+    }
+
+    // a previous lookup already brought every match into RAM: no match there means none at all
+    if (mFingerPrints.allFingerprintsAreLoaded(&fingerprint))
+    {
+        return handle;
+    }
+
+    std::string fingerprintString;
+    fingerprint.FileFingerprint::serialize(&fingerprintString);
+    mTable->getHandleByFingerprint(fingerprintString, handle);
+
+    return handle;
+}
+
 sharedNode_vector NodeManager::getNodesByOrigFingerprint(const std::string &fingerprint, Node *parent)
 {
     LockGuard g(mMutex);
@@ -1050,7 +1281,7 @@ void NodeManager::updateTreeCounter(std::shared_ptr<Node> origin, NodeCounter nc
     }
 }
 
-NodeCounter NodeManager::calculateNodeCounter(const NodeHandle& nodehandle, nodetype_t parentType, std::shared_ptr<Node> node, bool isInRubbish)
+NodeCounter NodeManager::calculateNodeCounter(const NodeHandle& nodehandle, nodetype_t parentType, std::shared_ptr<Node> node, bool isInRubbish, NodeHandle parentHandle)
 {
     assert(mMutex.owns_lock());
 
@@ -1072,10 +1303,16 @@ NodeCounter NodeManager::calculateNodeCounter(const NodeHandle& nodehandle, node
     }
     else
     {
-        if (!mTable->getNodeSizeTypeAndFlags(nodehandle, nodeSize, nodeType, flags))
+        if (!skeletonGet(nodehandle, nodeSize, nodeType, flags))
         {
-            assert(false);
-            return nc;
+            if (!mTable->getNodeSizeTypeAndFlags(nodehandle, nodeSize, nodeType, flags))
+            {
+                assert(false);
+                return nc;
+            }
+
+            // memoize, so the next walk over this subtree stays off the DB
+            skeletonPutRow(nodehandle, parentHandle, nodeType, nodeSize, flags);
         }
         std::bitset<Node::FLAGS_SIZE> bitset(flags);
         flags = Node::getDBFlags(flags, isInRubbish, parentType == FILENODE, bitset.test(Node::FLAGS_IS_MARKED_SENSTIVE));
@@ -1093,7 +1330,7 @@ NodeCounter NodeManager::calculateNodeCounter(const NodeHandle& nodehandle, node
         for (auto& itNode : *children)
         {
             shared_ptr<Node> child = itNode.second ? itNode.second->getNodeInRam() : nullptr;
-            nc += calculateNodeCounter(itNode.first, nodeType, child, isInRubbish);
+            nc += calculateNodeCounter(itNode.first, nodeType, child, isInRubbish, nodehandle);
         }
     }
 
@@ -1246,12 +1483,21 @@ void NodeManager::cleanNodes_internal()
     mFingerPrints.clear();
     mNodes.clear();
     mCacheLRU.clear();
+    MemoryAccounting::get().sub(MEM_NODES, static_cast<int64_t>(mCacheLRUUsedBytes));
+    mCacheLRUUsedBytes = 0;
+    mCacheLRUPinned.clear();
+    PerfCounters::get().sub(PERF_NODES_IN_RAM, static_cast<int64_t>(mNodesInRam));
     mNodesInRam = 0;
     mNodeToWriteInDb.reset();
     mNodeNotify.clear();
 
     rootnodes.clear();
 
+    mSnapshot.unmap();
+
+    mSkeleton = NodeSkeleton();
+    mSkeletonRow.clear();
+
     if (mTable) mTable->removeNodes();
 
     mInitialized = false;
@@ -1317,16 +1563,151 @@ void NodeManager::applyKeys_internal(uint32_t appliedKeys)
 
     if (mNodes.size() > appliedKeys)
     {
+        // nodes still waiting for their key: a large batch (e.g. joining a big
+        // share) has its AES unwraps spread over the worker threads first
+        sharedNode_vector pending;
+        for (auto& it : mNodes)
+        {
+            if (shared_ptr<Node> node = it.second.getNodeInRam(false))
+            {
+                if (!node->keyApplied() && node->nodekeyUnchecked().size())
+                {
+                    pending.push_back(node);
+                }
+            }
+        }
+
+        if (pending.size() >= UNWRAP_KEYS_PARALLEL_THRESHOLD)
+        {
+            unwrapKeysParallel(pending);
+        }
+
+        // the serial pass picks up whatever the parallel pass didn't
+        // (RSA-wrapped keys, keys that only just became resolvable) and is a
+        // cheap no-op for nodes whose key was already committed
         for (auto& it : mNodes)
         {
             if (shared_ptr<Node> node = it.second.getNodeInRam(false))
             {
-               node->applykey();
+               node->applykey(mClient.mLazyAttrDecryption);
             }
         }
     }
 }
 
+void NodeManager::unwrapKeysParallel(const sharedNode_vector& pending)
+{
+    assert(mMutex.owns_lock());
+
+    struct UnwrapJob
+    {
+        Node* mNode;
+        const char* mWrapped;
+        byte mCipherKey[SymmCipher::KEYLENGTH];
+        byte mUnwrapped[FILENODEKEYLENGTH];
+        unsigned mKeyLength;
+        bool mDone = false;
+    };
+
+    // resolve the key source for each node on this thread: that part walks
+    // shared state (share keys, the key repository, other nodes)
+    std::vector<UnwrapJob> jobs;
+    jobs.reserve(pending.size());
+    for (auto& node : pending)
+    {
+        const char* k = NULL;
+        SymmCipher* sc = node->resolveKeySource(k);
+        if (!sc)
+        {
+            continue;
+        }
+
+        const char* end = k;
+        while (*end && *end != '"' && *end != '/')
+        {
+            end++;
+        }
+
+        if (end - k > 4 * FILENODEKEYLENGTH / 3 + 1)
+        {
+            // RSA-wrapped: needs the client's private key and triggers a key
+            // rewrite, keep it on the serial path
+            continue;
+        }
+
+        UnwrapJob job;
+        job.mNode = node.get();
+        job.mWrapped = k;
+        memcpy(job.mCipherKey, sc->key, sizeof(job.mCipherKey));
+        job.mKeyLength = (node->type == FILENODE) ? FILENODEKEYLENGTH : FOLDERNODEKEYLENGTH;
+        jobs.push_back(job);
+    }
+
+    if (jobs.empty())
+    {
+        return;
+    }
+
+    size_t chunks = (jobs.size() + UNWRAP_KEYS_CHUNK - 1) / UNWRAP_KEYS_CHUNK;
+    std::mutex doneMutex;
+    std::condition_variable doneCV;
+    size_t chunksLeft = chunks;
+
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        size_t begin = chunk * UNWRAP_KEYS_CHUNK;
+        size_t end = std::min(begin + UNWRAP_KEYS_CHUNK, jobs.size());
+
+        mClient.mAsyncQueue.push([&jobs, &doneMutex, &doneCV, &chunksLeft, begin, end](SymmCipher& cipher)
+        {
+            byte currentKey[SymmCipher::KEYLENGTH];
+            bool haveKey = false;
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                UnwrapJob& job = jobs[i];
+                if (!haveKey || memcmp(currentKey, job.mCipherKey, sizeof(currentKey)))
+                {
+                    cipher.setkey(job.mCipherKey);
+                    memcpy(currentKey, job.mCipherKey, sizeof(currentKey));
+                    haveKey = true;
+                }
+
+                if (Base64::atob(job.mWrapped, job.mUnwrapped, static_cast<int>(job.mKeyLength))
+                        == static_cast<int>(job.mKeyLength))
+                {
+                    cipher.ecb_decrypt(job.mUnwrapped, job.mKeyLength);
+                    job.mDone = true;
+                }
+            }
+
+            std::lock_guard<std::mutex> g(doneMutex);
+            if (!--chunksLeft)
+            {
+                doneCV.notify_one();
+            }
+        }, false);
+    }
+
+    {
+        std::unique_lock<std::mutex> g(doneMutex);
+        doneCV.wait(g, [&chunksLeft]() { return !chunksLeft; });
+    }
+
+    // merge the results back on this thread
+    unsigned committed = 0;
+    for (auto& job : jobs)
+    {
+        if (job.mDone)
+        {
+            job.mNode->commitUnwrappedKey(job.mUnwrapped, job.mKeyLength, mClient.mLazyAttrDecryption);
+            committed++;
+        }
+    }
+
+    LOG_debug << "Applied " << committed << " of " << pending.size() << " pending node keys in parallel";
+}
+
 void NodeManager::notifyPurge()
 {
     // only lock to get the nodes to report
@@ -1342,7 +1723,7 @@ void NodeManager::notifyPurge()
     {
         mClient.applykeys();
 
-        if (!mClient.fetchingnodes)
+        if (!mClient.catchingUpOnActionpackets())
         {
             assert(!mMutex.owns_lock());
             mClient.app->nodes_updated(&nodesToReport, static_cast<int>(nodesToReport.size()));
@@ -1372,6 +1753,7 @@ void NodeManager::notifyPurge()
                 if (n->inshare)
                 {
                     n->inshare->user->sharing.erase(n->nodehandle);
+                    n->inshare->user->changed.sharing = true;
                     mClient.notifyuser(n->inshare->user);
                 }
             }
@@ -1415,12 +1797,16 @@ void NodeManager::notifyPurge()
                 if (n->mNodePosition->second.mLRUPosition != invalidCacheLRUPos())
                 {
                     mCacheLRU.erase(n->mNodePosition->second.mLRUPosition);
+                    mCacheLRUUsedBytes -= std::min<uint64_t>(mCacheLRUUsedBytes, n->mRamUsageAtLRU);
+                    MemoryAccounting::get().sub(MEM_NODES, static_cast<int64_t>(n->mRamUsageAtLRU));
+                    n->mRamUsageAtLRU = 0;
                 }
 
                 mNodes.erase(n->mNodePosition);
                 n->mNodePosition = mNodes.end();
 
                 mTable->remove(h);
+                skeletonRemove(h);
 
                 removed += 1;
             }
@@ -1465,6 +1851,13 @@ bool NodeManager::loadNodes_internal()
         return false;
     }
 
+    // Pre-carve pool slabs for every statecache row, so resuming a large
+    // account never grows mNodes' backing pool in the middle of the load
+    if (uint64_t count = mTable->getNumberOfNodes())
+    {
+        FixedBlockPool::poolFor(nodesMapBlockSize(*this)).reserveBlocks(static_cast<size_t>(count));
+    }
+
     sharedNode_vector rootnodes = getRootNodes_internal();
     // We can't base in `user.sharing` because it's set yet. We have to get from DB
     sharedNode_vector inshares = getNodesWithInShares_internal();  // it includes nested inshares
@@ -1655,11 +2048,13 @@ void NodeManager::insertNodeCacheLRU(std::shared_ptr<Node> node)
 void NodeManager::increaseNumNodesInRam()
 {
     mNodesInRam++;
+    PerfCounters::get().add(PERF_NODES_IN_RAM);
 }
 
 void NodeManager::decreaseNumNodesInRam()
 {
     mNodesInRam--;
+    PerfCounters::get().sub(PERF_NODES_IN_RAM);
 }
 
 uint64_t NodeManager::getCacheLRUMaxSize() const
@@ -1680,6 +2075,57 @@ uint64_t NodeManager::getNumNodesAtCacheLRU() const
     return mCacheLRU.size();
 }
 
+uint64_t NodeManager::getCacheLRUMaxBytes() const
+{
+    return mCacheLRUMaxBytes;
+}
+
+void NodeManager::setCacheLRUMaxBytes(uint64_t cacheLRUMaxBytes)
+{
+    LockGuard g(mMutex);
+    mCacheLRUMaxBytes = cacheLRUMaxBytes;
+
+    unLoadNodeFromCacheLRU(); // check if it's necessary unload nodes
+}
+
+uint64_t NodeManager::getCacheLRUUsedBytes() const
+{
+    LockGuard g(mMutex);
+    return mCacheLRUUsedBytes;
+}
+
+uint64_t NodeManager::getCacheLRUHits() const
+{
+    return mCacheLRUHits;
+}
+
+uint64_t NodeManager::getCacheLRUMisses() const
+{
+    return mCacheLRUMisses;
+}
+
+void NodeManager::pinNodeToCacheLRU(NodeHandle h)
+{
+    LockGuard g(mMutex);
+    ++mCacheLRUPinned[h];
+}
+
+void NodeManager::unpinNodeFromCacheLRU(NodeHandle h)
+{
+    LockGuard g(mMutex);
+    auto it = mCacheLRUPinned.find(h);
+    if (it == mCacheLRUPinned.end())
+    {
+        return;
+    }
+
+    if (!--it->second)
+    {
+        mCacheLRUPinned.erase(it);
+        unLoadNodeFromCacheLRU(); // eviction may have been deferred by the pin
+    }
+}
+
 void NodeManager::initCompleted_internal()
 {
     assert(mMutex.owns_lock());
@@ -1697,6 +2143,10 @@ void NodeManager::initCompleted_internal()
     }
 
     mTable->createIndexes();
+
+    // the node tree is complete and committed: refresh the read-only snapshot
+    rebuildSnapshot_internal();
+
     mInitialized = true;
 }
 
@@ -1711,8 +2161,13 @@ void NodeManager::insertNodeCacheLRU_internal(std::shared_ptr<Node> node)
     if (node->mNodePosition->second.mLRUPosition != mCacheLRU.end())
     {
         mCacheLRU.erase(node->mNodePosition->second.mLRUPosition);
+        mCacheLRUUsedBytes -= std::min<uint64_t>(mCacheLRUUsedBytes, node->mRamUsageAtLRU);
+        MemoryAccounting::get().sub(MEM_NODES, static_cast<int64_t>(node->mRamUsageAtLRU));
     }
 
+    node->mRamUsageAtLRU = node->estimatedRamUsage();
+    mCacheLRUUsedBytes += node->mRamUsageAtLRU;
+    MemoryAccounting::get().add(MEM_NODES, static_cast<int64_t>(node->mRamUsageAtLRU));
     node->mNodePosition->second.mLRUPosition = mCacheLRU.insert(mCacheLRU.begin(), node);
     unLoadNodeFromCacheLRU(); // check if it's necessary unload nodes
 
@@ -1727,12 +2182,29 @@ void NodeManager::insertNodeCacheLRU_internal(std::shared_ptr<Node> node)
 void NodeManager::unLoadNodeFromCacheLRU()
 {
     assert(mMutex.owns_lock() && "Mutex should be locked by this thread");
-    while (mCacheLRU.size() > mCacheLRUMaxSize)
+
+    auto overBudget = [this]()
+    {
+        return mCacheLRU.size() > mCacheLRUMaxSize || mCacheLRUUsedBytes > mCacheLRUMaxBytes;
+    };
+
+    // evict least-recently-used nodes first, skipping pinned ones
+    auto it = mCacheLRU.end();
+    while (overBudget() && it != mCacheLRU.begin())
     {
-        std::shared_ptr<Node> node = mCacheLRU.back();
+        --it;
+        std::shared_ptr<Node> node = *it;
+        if (mCacheLRUPinned.find(node->nodeHandle()) != mCacheLRUPinned.end())
+        {
+            continue; // pinned by an active transfer or sync, keep it resident
+        }
+
         removeFingerprint(node.get(), true);
         node->mNodePosition->second.mLRUPosition = invalidCacheLRUPos();
-        mCacheLRU.pop_back();
+        mCacheLRUUsedBytes -= std::min<uint64_t>(mCacheLRUUsedBytes, node->mRamUsageAtLRU);
+        MemoryAccounting::get().sub(MEM_NODES, static_cast<int64_t>(node->mRamUsageAtLRU));
+        node->mRamUsageAtLRU = 0;
+        it = mCacheLRU.erase(it);
     }
 }
 
@@ -1889,6 +2361,10 @@ void NodeManager::dumpNodes_internal()
     }
 
     mTable->createIndexes();
+
+    // the node tree is complete and committed: refresh the read-only snapshot
+    rebuildSnapshot_internal();
+
     mInitialized = true;
 }
 
@@ -1980,7 +2456,12 @@ shared_ptr<Node> NodeManager::getNodeFromDataBase(NodeHandle handle)
 
     shared_ptr<Node> node = nullptr;
     NodeSerialized nodeSerialized;
-    if (mTable->getNode(handle, nodeSerialized))
+    if (snapshotIsCurrent() && mSnapshot.getNode(handle, nodeSerialized))
+    {
+        // page faults on the mapped snapshot are much cheaper than sqlite SELECTs
+        node = getNodeFromNodeSerialized(nodeSerialized);
+    }
+    else if (mTable->getNode(handle, nodeSerialized))
     {
         node = getNodeFromNodeSerialized(nodeSerialized);
     }
@@ -1988,6 +2469,48 @@ shared_ptr<Node> NodeManager::getNodeFromDataBase(NodeHandle handle)
     return node;
 }
 
+bool NodeManager::snapshotIsCurrent() const
+{
+    return mSnapshot.isMapped()
+            && mClient.scsn.ready()
+            && mSnapshot.tag() == mClient.scsn.text();
+}
+
+void NodeManager::setSnapshotPath(const LocalPath& path)
+{
+    LockGuard g(mMutex);
+    mSnapshotPath = path;
+    if (!mSnapshot.map(mSnapshotPath, mClient.key))
+    {
+        mSnapshot.unmap();
+    }
+}
+
+void NodeManager::rebuildSnapshot_internal()
+{
+    assert(mMutex.owns_lock());
+
+    if (mSnapshotPath.empty() || !mTable)
+    {
+        return;
+    }
+
+    mSnapshot.unmap();   // release the previous generation before replacing the file
+
+    if (!mClient.scsn.ready())
+    {
+        return;
+    }
+
+    std::vector<std::pair<NodeHandle, NodeSerialized>> records;
+    if (mTable->getAllNodes(records)
+            && NodeTableSnapshot::build(mSnapshotPath, mClient.scsn.text(), records,
+                                        mClient.key, mClient.rng))
+    {
+        mSnapshot.map(mSnapshotPath, mClient.key);
+    }
+}
+
 sharedNode_vector NodeManager::getRootNodesAndInshares()
 {
     assert(mMutex.owns_lock());
@@ -2135,6 +2658,75 @@ void NodeManager::putNodeInDb(Node* node) const
     }
 
     mTable->put(node);
+
+    skeletonPutRow(node->nodeHandle(), node->parentHandle(), node->type, node->size, node->getDBFlags());
+}
+
+void NodeManager::skeletonPutRow(NodeHandle h, NodeHandle parent, nodetype_t type, m_off_t size, uint64_t flags) const
+{
+    auto it = mSkeletonRow.find(h);
+    if (it == mSkeletonRow.end())
+    {
+        mSkeletonRow[h] = mSkeleton.mHandles.size();
+        mSkeleton.mHandles.push_back(h);
+        mSkeleton.mParents.push_back(parent);
+        mSkeleton.mTypes.push_back(type);
+        mSkeleton.mSizes.push_back(size);
+        mSkeleton.mFlags.push_back(flags);
+    }
+    else
+    {
+        size_t row = it->second;
+        mSkeleton.mParents[row] = parent;
+        mSkeleton.mTypes[row] = type;
+        mSkeleton.mSizes[row] = size;
+        mSkeleton.mFlags[row] = flags;
+    }
+}
+
+void NodeManager::skeletonRemove(NodeHandle h)
+{
+    auto it = mSkeletonRow.find(h);
+    if (it == mSkeletonRow.end())
+    {
+        return;
+    }
+
+    // swap the last row into the hole so the columns stay dense
+    size_t row = it->second;
+    size_t last = mSkeleton.mHandles.size() - 1;
+    if (row != last)
+    {
+        NodeHandle lastHandle = mSkeleton.mHandles[last];
+        mSkeleton.mHandles[row] = lastHandle;
+        mSkeleton.mParents[row] = mSkeleton.mParents[last];
+        mSkeleton.mTypes[row] = mSkeleton.mTypes[last];
+        mSkeleton.mSizes[row] = mSkeleton.mSizes[last];
+        mSkeleton.mFlags[row] = mSkeleton.mFlags[last];
+        mSkeletonRow[lastHandle] = row;
+    }
+
+    mSkeleton.mHandles.pop_back();
+    mSkeleton.mParents.pop_back();
+    mSkeleton.mTypes.pop_back();
+    mSkeleton.mSizes.pop_back();
+    mSkeleton.mFlags.pop_back();
+    mSkeletonRow.erase(it);
+}
+
+bool NodeManager::skeletonGet(NodeHandle h, m_off_t& size, nodetype_t& type, uint64_t& flags) const
+{
+    auto it = mSkeletonRow.find(h);
+    if (it == mSkeletonRow.end())
+    {
+        return false;
+    }
+
+    size_t row = it->second;
+    size = mSkeleton.mSizes[row];
+    type = mSkeleton.mTypes[row];
+    flags = mSkeleton.mFlags[row];
+    return true;
 }
 
 size_t NodeManager::nodeNotifySize() const
@@ -0,0 +1,252 @@
+/**
+ * @file nodesnapshot.cpp
+ * @brief Memory-mapped read-only snapshot of the "nodes" DB table
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega/nodesnapshot.h"
+#include "mega/logging.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mega {
+
+const char NodeTableSnapshot::MAGIC[8] = { 'M', 'N', 'S', 'N', 'A', 'P', '0', '2' };
+
+namespace {
+
+struct SnapshotHeader
+{
+    char magic[8];
+    char tag[16];       // scsn the snapshot was built at, NUL padded
+    uint64_t nonce;     // mixed into each record's CTR IV, fresh per build
+    uint64_t count;     // number of index entries following this header
+};
+
+// each record gets its own CTR stream: the handle is unique within a snapshot
+// and the nonce differs between builds, so IVs are never reused under the key
+uint64_t recordIv(uint64_t nonce, uint64_t handle)
+{
+    return nonce ^ handle;
+}
+
+} // anonymous
+
+NodeTableSnapshot::~NodeTableSnapshot()
+{
+    unmap();
+}
+
+bool NodeTableSnapshot::build(const LocalPath& path, const std::string& scsnTag,
+                              const std::vector<std::pair<NodeHandle, NodeSerialized>>& records,
+                              SymmCipher& cacheKey, PrnGen& rng)
+{
+#ifdef _WIN32
+    (void)path;
+    (void)scsnTag;
+    (void)records;
+    (void)cacheKey;
+    (void)rng;
+    return false;
+#else
+    if (scsnTag.empty() || scsnTag.size() >= sizeof(SnapshotHeader().tag))
+    {
+        return false;
+    }
+
+    std::string target = path.platformEncoded();
+    std::string temporary = target + ".tmp";
+
+    FILE* f = fopen(temporary.c_str(), "wb");
+    if (!f)
+    {
+        LOG_warn << "Unable to create node snapshot file: " << temporary;
+        return false;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    memcpy(header.tag, scsnTag.data(), scsnTag.size());
+    rng.genblock(reinterpret_cast<byte*>(&header.nonce), sizeof(header.nonce));
+    header.count = records.size();
+
+    // index entries are sorted by handle so readers can binary-search them
+    std::vector<IndexEntry> index;
+    index.reserve(records.size());
+    uint64_t offset = sizeof(SnapshotHeader) + records.size() * sizeof(IndexEntry);
+    for (const auto& record : records)
+    {
+        IndexEntry entry;
+        entry.handle = record.first.as8byte();
+        entry.offset = offset;
+        entry.nodeLen = static_cast<uint32_t>(record.second.mNode.size());
+        entry.counterLen = static_cast<uint32_t>(record.second.mNodeCounter.size());
+        index.push_back(entry);
+        offset += entry.nodeLen + entry.counterLen;
+    }
+
+    std::sort(index.begin(), index.end(), [](const IndexEntry& a, const IndexEntry& b)
+    {
+        return a.handle < b.handle;
+    });
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && (index.empty() || fwrite(index.data(), sizeof(IndexEntry), index.size(), f) == index.size());
+    std::string payload;
+    for (auto it = records.begin(); ok && it != records.end(); ++it)
+    {
+        const NodeSerialized& ns = it->second;
+        payload = ns.mNode + ns.mNodeCounter;
+        if (!payload.empty())
+        {
+            cacheKey.ctr_crypt(reinterpret_cast<byte*>(&payload[0]),
+                               static_cast<unsigned>(payload.size()), 0,
+                               recordIv(header.nonce, it->first.as8byte()), NULL, true);
+            ok = fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+        }
+    }
+
+    ok = !fclose(f) && ok;
+
+    if (!ok || rename(temporary.c_str(), target.c_str()))
+    {
+        LOG_warn << "Failed to write node snapshot: " << target;
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    LOG_debug << "Node snapshot written with " << records.size() << " records at scsn " << scsnTag;
+    return true;
+#endif
+}
+
+bool NodeTableSnapshot::map(const LocalPath& path, SymmCipher& cacheKey)
+{
+#ifdef _WIN32
+    (void)path;
+    (void)cacheKey;
+    return false;
+#else
+    unmap();
+
+    std::string target = path.platformEncoded();
+    int fd = open(target.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);   // the mapping keeps its own reference to the file
+    if (base == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const SnapshotHeader* header = static_cast<const SnapshotHeader*>(base);
+    size_t indexBytes = static_cast<size_t>(header->count) * sizeof(IndexEntry);
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC))
+            || sizeof(SnapshotHeader) + indexBytes > static_cast<size_t>(st.st_size))
+    {
+        LOG_warn << "Discarding malformed node snapshot: " << target;
+        munmap(base, static_cast<size_t>(st.st_size));
+        return false;
+    }
+
+    mBase = static_cast<const char*>(base);
+    mSize = static_cast<size_t>(st.st_size);
+    mCount = header->count;
+    mIndex = reinterpret_cast<const IndexEntry*>(mBase + sizeof(SnapshotHeader));
+    mTag.assign(header->tag, strnlen(header->tag, sizeof(header->tag)));
+    mNonce = header->nonce;
+    mKey = cacheKey;
+
+    LOG_debug << "Node snapshot mapped with " << mCount << " records at scsn " << mTag;
+    return true;
+#endif
+}
+
+void NodeTableSnapshot::unmap()
+{
+#ifndef _WIN32
+    if (mBase)
+    {
+        munmap(const_cast<char*>(mBase), mSize);
+    }
+#endif
+    mBase = nullptr;
+    mSize = 0;
+    mCount = 0;
+    mIndex = nullptr;
+    mTag.clear();
+    mNonce = 0;
+}
+
+bool NodeTableSnapshot::getNode(NodeHandle handle, NodeSerialized& nodeSerialized) const
+{
+    if (!mBase)
+    {
+        return false;
+    }
+
+    uint64_t h = handle.as8byte();
+    const IndexEntry* end = mIndex + mCount;
+    const IndexEntry* it = std::lower_bound(mIndex, end, h, [](const IndexEntry& entry, uint64_t value)
+    {
+        return entry.handle < value;
+    });
+
+    if (it == end || it->handle != h)
+    {
+        return false;
+    }
+
+    if (it->offset + it->nodeLen + it->counterLen > mSize)
+    {
+        return false;   // truncated file; treat the record as missing
+    }
+
+    std::string payload(mBase + it->offset, it->nodeLen + it->counterLen);
+    if (!payload.empty())
+    {
+        mKey.ctr_crypt(reinterpret_cast<byte*>(&payload[0]),
+                       static_cast<unsigned>(payload.size()), 0,
+                       recordIv(mNonce, h), NULL, false);
+    }
+    nodeSerialized.mNode.assign(payload, 0, it->nodeLen);
+    nodeSerialized.mNodeCounter.assign(payload, it->nodeLen, it->counterLen);
+    return true;
+}
+
+} // namespace
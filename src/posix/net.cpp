@@ -27,6 +27,10 @@
 #include <openssl/err.h>
 #endif
 
+#ifndef _WIN32
+#include <netinet/tcp.h>
+#endif
+
 #if defined(__ANDROID__) && ARES_VERSION >= 0x010F00
 #include <jni.h>
 extern JavaVM *MEGAjvm;
@@ -153,6 +157,28 @@ SockInfo::~SockInfo()
 
 std::mutex CurlHttpIO::curlMutex;
 
+// One curl share for the whole process, refcounted across CurlHttpIO
+// instances: DNS results, TLS sessions and (curl permitting) idle
+// connections are reused between instances, so a box running one MegaApi
+// per tenant doesn't resolve, handshake and connect the same API hosts
+// once per instance. Each instance runs its own network thread, hence the
+// lock callbacks. Sessions stay isolated: nothing session-scoped (cookies,
+// auth) is shared
+static std::mutex curlShareCtrlMutex;
+static CURLSH* curlShareHandle = NULL;
+static unsigned curlShareUsers = 0;
+static std::mutex curlShareLocks[CURL_LOCK_DATA_LAST];
+
+static void share_lock_function(CURL*, curl_lock_data data, curl_lock_access, void*)
+{
+    curlShareLocks[data].lock();
+}
+
+static void share_unlock_function(CURL*, curl_lock_data data, void*)
+{
+    curlShareLocks[data].unlock();
+}
+
 #if defined(USE_OPENSSL) && !defined(OPENSSL_IS_BORINGSSL)
 
 std::recursive_mutex **CurlHttpIO::sslMutexes = NULL;
@@ -258,6 +284,13 @@ CurlHttpIO::CurlHttpIO()
     curlipv6 = data->features & CURL_VERSION_IPV6;
     LOG_debug << "IPv6 enabled: " << curlipv6;
 
+#if LIBCURL_VERSION_NUM >= 0x072f00 // At least cURL 7.47.0 (CURL_HTTP_VERSION_2TLS)
+    curlhttp2 = data->features & CURL_VERSION_HTTP2;
+#else
+    curlhttp2 = false;
+#endif
+    LOG_debug << "HTTP/2 enabled: " << curlhttp2;
+
     dnsok = false;
     reset = false;
     statechange = false;
@@ -342,18 +375,35 @@ CurlHttpIO::CurlHttpIO()
     curl_multi_setopt(curlm[API], CURLMOPT_SOCKETDATA, this);
     curl_multi_setopt(curlm[API], CURLMOPT_TIMERFUNCTION, api_timer_callback);
     curl_multi_setopt(curlm[API], CURLMOPT_TIMERDATA, this);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (curlhttp2)
+    {
+        // share one HTTP/2 connection between concurrent API transfers
+        curl_multi_setopt(curlm[API], CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+#endif
     curltimeoutreset[API] = -1;
     arerequestspaused[API] = false;
+    removedcurlsockets[API] = 0;
 
     curl_multi_setopt(curlm[GET], CURLMOPT_SOCKETFUNCTION, download_socket_callback);
     curl_multi_setopt(curlm[GET], CURLMOPT_SOCKETDATA, this);
     curl_multi_setopt(curlm[GET], CURLMOPT_TIMERFUNCTION, download_timer_callback);
     curl_multi_setopt(curlm[GET], CURLMOPT_TIMERDATA, this);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (curlhttp2)
+    {
+        // reuse a multiplexed connection for file attribute fetches where
+        // the server offers HTTP/2; plain downloads are unaffected
+        curl_multi_setopt(curlm[GET], CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+#endif
 #ifdef _WIN32
     curl_multi_setopt(curlm[GET], CURLMOPT_MAXCONNECTS, 200);
 #endif
     curltimeoutreset[GET] = -1;
     arerequestspaused[GET] = false;
+    removedcurlsockets[GET] = 0;
 
     curl_multi_setopt(curlm[PUT], CURLMOPT_SOCKETFUNCTION, upload_socket_callback);
     curl_multi_setopt(curlm[PUT], CURLMOPT_SOCKETDATA, this);
@@ -365,10 +415,23 @@ CurlHttpIO::CurlHttpIO()
 
     curltimeoutreset[PUT] = -1;
     arerequestspaused[PUT] = false;
+    removedcurlsockets[PUT] = 0;
 
-    curlsh = curl_share_init();
-    curl_share_setopt(curlsh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
-    curl_share_setopt(curlsh, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    {
+        std::lock_guard<std::mutex> g(curlShareCtrlMutex);
+        if (!curlShareUsers++)
+        {
+            curlShareHandle = curl_share_init();
+            curl_share_setopt(curlShareHandle, CURLSHOPT_LOCKFUNC, share_lock_function);
+            curl_share_setopt(curlShareHandle, CURLSHOPT_UNLOCKFUNC, share_unlock_function);
+            curl_share_setopt(curlShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(curlShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900 // at least cURL 7.57.0 (cross-handle connection reuse)
+            curl_share_setopt(curlShareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
+        curlsh = curlShareHandle;
+    }
 
     contenttypejson = curl_slist_append(NULL, "Content-Type: application/json");
     contenttypejson = curl_slist_append(contenttypejson, "Expect:");
@@ -737,6 +800,7 @@ void CurlHttpIO::processcurlevents(direction_t d)
     SockInfoMap *socketmap = &curlsockets[d];
     bool *paused = &arerequestspaused[d];
 
+#if defined(_WIN32)
     for (SockInfoMap::iterator it = socketmap->begin(); !(*paused) && it != socketmap->end();)
     {
         SockInfo &info = (it++)->second;
@@ -745,7 +809,6 @@ void CurlHttpIO::processcurlevents(direction_t d)
             continue;
         }
 
-#if defined(_WIN32)
         bool read, write;
         if (info.checkEvent(read, write)) // if checkEvent returns true, both `read` and `write` have been set.
         {
@@ -754,7 +817,59 @@ void CurlHttpIO::processcurlevents(direction_t d)
                                      (read ? CURL_CSELECT_IN : 0)
                                    | (write ? CURL_CSELECT_OUT : 0), &dummy);
         }
+    }
+#elif defined(USE_POLL) || defined(USE_EPOLL) || defined(USE_KQUEUE)
+    // after wait() the fd sets hold only the sockets that actually fired:
+    // merge-walk the two sorted sets and act on each ready socket once with
+    // its combined readiness, instead of probing every registered socket -
+    // with hundreds of mostly idle connections this touches only the live
+    // ones (unrelated fds, eg the other directions', simply miss the map)
+    auto rit = rfds->begin();
+    auto wit = wfds->begin();
+
+    while (!(*paused) && (rit != rfds->end() || wit != wfds->end()))
+    {
+        int fd;
+        int ready;
+
+        if (wit == wfds->end() || (rit != rfds->end() && *rit <= *wit))
+        {
+            fd = *rit++;
+            ready = CURL_CSELECT_IN;
+            if (wit != wfds->end() && *wit == fd)
+            {
+                ready |= CURL_CSELECT_OUT;
+                wit++;
+            }
+        }
+        else
+        {
+            fd = *wit++;
+            ready = CURL_CSELECT_OUT;
+        }
+
+        SockInfoMap::iterator it = socketmap->find(fd);
+        if (it != socketmap->end() && it->second.mode)
+        {
+            int mask = ((it->second.mode & SockInfo::READ) ? (ready & CURL_CSELECT_IN) : 0)
+                     | ((it->second.mode & SockInfo::WRITE) ? (ready & CURL_CSELECT_OUT) : 0);
+            if (mask)
+            {
+                curl_multi_socket_action(curlm[d], fd, mask, &dummy);
+            }
+        }
+    }
 #else
+    // select() leaves no efficient way to enumerate ready fds: test each
+    // registered socket against the fd sets as before
+    for (SockInfoMap::iterator it = socketmap->begin(); !(*paused) && it != socketmap->end();)
+    {
+        SockInfo &info = (it++)->second;
+        if (!info.mode)
+        {
+            continue;
+        }
+
         if (((info.mode & SockInfo::READ) && MEGA_FD_ISSET(info.fd, rfds)) || ((info.mode & SockInfo::WRITE) && MEGA_FD_ISSET(info.fd, wfds)))
         {
             curl_multi_socket_action(curlm[d], info.fd,
@@ -762,8 +877,8 @@ void CurlHttpIO::processcurlevents(direction_t d)
                                      | (((info.mode & SockInfo::WRITE) && MEGA_FD_ISSET(info.fd, wfds)) ? CURL_CSELECT_OUT : 0),
                                      &dummy);
         }
-#endif
     }
+#endif
 
     if (curltimeoutreset[d] >= 0 && curltimeoutreset[d] <= Waiter::ds)
     {
@@ -772,22 +887,43 @@ void CurlHttpIO::processcurlevents(direction_t d)
         curl_multi_socket_action(curlm[d], CURL_SOCKET_TIMEOUT, 0, &dummy);
     }
 
-    for (SockInfoMap::iterator it = socketmap->begin(); it != socketmap->end();)
+    if (removedcurlsockets[d])
     {
-        SockInfo &info = it->second;
-        if (!info.mode)
-        {
-            socketmap->erase(it++);
-        }
-        else
+        removedcurlsockets[d] = 0;
+
+        for (SockInfoMap::iterator it = socketmap->begin(); it != socketmap->end();)
         {
-            it++;
+            SockInfo &info = it->second;
+            if (!info.mode)
+            {
+                socketmap->erase(it++);
+            }
+            else
+            {
+                it++;
+            }
         }
     }
 }
 
 CurlHttpIO::~CurlHttpIO()
 {
+#ifndef WIN32
+    if (mNetThread.joinable())
+    {
+        // the app thread holds the big lock for its whole lifetime (see
+        // MegaApiImpl::loop), so release it here to let the network thread
+        // observe the exit flag and wind down before we tear curl down
+        mNetThreadExit = true;
+        mNetWaiter->notify();
+        if (mLockDepth > 0)
+        {
+            mCsHTTP.unlock();
+        }
+        mNetThread.join();
+    }
+#endif
+
     disconnecting = true;
 #ifdef MEGA_USE_C_ARES
     ares_destroy(ares);
@@ -795,7 +931,17 @@ CurlHttpIO::~CurlHttpIO()
     curl_multi_cleanup(curlm[API]);
     curl_multi_cleanup(curlm[GET]);
     curl_multi_cleanup(curlm[PUT]);
-    curl_share_cleanup(curlsh);
+    {
+        // this instance's easy handles are gone with the multis above, so
+        // the last instance out can safely tear the process share down
+        std::lock_guard<std::mutex> g(curlShareCtrlMutex);
+        if (!--curlShareUsers)
+        {
+            curl_share_cleanup(curlShareHandle);
+            curlShareHandle = NULL;
+        }
+    }
+    curlsh = NULL;
 
 #ifdef MEGA_USE_C_ARES
     closearesevents();
@@ -824,6 +970,73 @@ CurlHttpIO::~CurlHttpIO()
 
 int CurlHttpIO::instanceCount = 0;
 
+void CurlHttpIO::lock()
+{
+    mCsHTTP.lock();
+
+#ifndef WIN32
+    if (++mLockDepth == 1 && !mNetThread.joinable())
+    {
+        // first use of the locking contract: hand the sockets over to a
+        // dedicated servicing thread.  Apps that never call lock() keep
+        // the old inline servicing in doio()
+        mNetWaiter.reset(new WAIT_CLASS());
+        mNetThread = std::thread([this]() { networkThread(); });
+    }
+#else
+    ++mLockDepth;
+#endif
+}
+
+void CurlHttpIO::unlock()
+{
+    --mLockDepth;
+    mCsHTTP.unlock();
+}
+
+void CurlHttpIO::wakeNetworkThread()
+{
+#ifndef WIN32
+    if (mNetThread.joinable())
+    {
+        mNetWaiter->notify();
+    }
+#endif
+}
+
+#ifndef WIN32
+void CurlHttpIO::networkThread()
+{
+    mCsHTTP.lock();
+
+    // all curl/ares sockets are registered against our own waiter from now
+    // on; it releases the big lock whenever we block
+    waiter = mNetWaiter.get();
+    mNetWaiter->pcsHTTP = &mCsHTTP;
+
+    while (!mNetThreadExit)
+    {
+        WAIT_CLASS::bumpds();
+
+        bool events = doiointernal();
+        statechange |= events;
+
+        if ((events || partialdata[GET] || partialdata[PUT]) && mClientWaiter)
+        {
+            // completed requests and fresh transfer data need client
+            // attention - wake it so exec() picks them up
+            mClientWaiter->notify();
+        }
+
+        mNetWaiter->init(NEVER);
+        addeventsinternal();
+        mNetWaiter->wait();
+    }
+
+    mCsHTTP.unlock();
+}
+#endif
+
 void CurlHttpIO::setuseragent(string* u)
 {
     useragent = *u;
@@ -851,6 +1064,7 @@ void CurlHttpIO::setdnsservers(const char* servers)
 void CurlHttpIO::disconnect()
 {
     LOG_debug << "Reinitializing the network layer";
+    wakeNetworkThread();
     disconnecting = true;
     assert(!numconnections[API] && !numconnections[GET] && !numconnections[PUT]);
 
@@ -903,18 +1117,35 @@ void CurlHttpIO::disconnect()
     curl_multi_setopt(curlm[API], CURLMOPT_SOCKETDATA, this);
     curl_multi_setopt(curlm[API], CURLMOPT_TIMERFUNCTION, api_timer_callback);
     curl_multi_setopt(curlm[API], CURLMOPT_TIMERDATA, this);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (curlhttp2)
+    {
+        // share one HTTP/2 connection between concurrent API transfers
+        curl_multi_setopt(curlm[API], CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+#endif
     curltimeoutreset[API] = -1;
     arerequestspaused[API] = false;
+    removedcurlsockets[API] = 0;
 
     curl_multi_setopt(curlm[GET], CURLMOPT_SOCKETFUNCTION, download_socket_callback);
     curl_multi_setopt(curlm[GET], CURLMOPT_SOCKETDATA, this);
     curl_multi_setopt(curlm[GET], CURLMOPT_TIMERFUNCTION, download_timer_callback);
     curl_multi_setopt(curlm[GET], CURLMOPT_TIMERDATA, this);
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (curlhttp2)
+    {
+        // reuse a multiplexed connection for file attribute fetches where
+        // the server offers HTTP/2; plain downloads are unaffected
+        curl_multi_setopt(curlm[GET], CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+#endif
 #ifdef _WIN32
     curl_multi_setopt(curlm[GET], CURLMOPT_MAXCONNECTS, 200);
 #endif
     curltimeoutreset[GET] = -1;
     arerequestspaused[GET] = false;
+    removedcurlsockets[GET] = 0;
 
 
     curl_multi_setopt(curlm[PUT], CURLMOPT_SOCKETFUNCTION, upload_socket_callback);
@@ -926,6 +1157,7 @@ void CurlHttpIO::disconnect()
 #endif
     curltimeoutreset[PUT] = -1;
     arerequestspaused[PUT] = false;
+    removedcurlsockets[PUT] = 0;
 
     disconnecting = false;
 #ifdef MEGA_USE_C_ARES
@@ -950,12 +1182,16 @@ void CurlHttpIO::disconnect()
 bool CurlHttpIO::setmaxdownloadspeed(m_off_t bpslimit)
 {
     maxspeed[GET] = bpslimit;
+    trafficshaper[GET].setcap(bpslimit);
+    wakeNetworkThread();
     return true;
 }
 
 bool CurlHttpIO::setmaxuploadspeed(m_off_t bpslimit)
 {
     maxspeed[PUT] = bpslimit;
+    trafficshaper[PUT].setcap(bpslimit);
+    wakeNetworkThread();
     return true;
 }
 
@@ -999,6 +1235,55 @@ bool CurlHttpIO::cacheresolvedurls(const std::vector<string>& urls, std::vector<
     return true;
 }
 
+bool CurlHttpIO::exportdnscache(string* data)
+{
+    CacheableWriter w(*data);
+    size_t count = 0;
+
+    for (const auto& it : dnscache)
+    {
+        const CurlDNSEntry& entry = it.second;
+        if (it.first.size() && (entry.ipv4.size() || entry.ipv6.size()))
+        {
+            w.serializestring(it.first);
+            w.serializestring(entry.ipv4);
+            w.serializestring(entry.ipv6);
+            count++;
+        }
+    }
+
+    return count > 0;
+}
+
+void CurlHttpIO::importdnscache(const string& data)
+{
+    CacheableReader r(data);
+    string host, ipv4, ipv6;
+    size_t count = 0;
+
+    while (r.unserializestring(host))
+    {
+        if (!r.unserializestring(ipv4) || !r.unserializestring(ipv6))
+        {
+            LOG_err << "Truncated DNS cache snapshot";
+            break;
+        }
+
+        // don't overwrite entries already resolved in this session
+        CurlDNSEntry& entry = dnscache[host];
+        if (entry.ipv4.empty() && entry.ipv6.empty())
+        {
+            entry.ipv4 = ipv4;
+            entry.ipv4timestamp = Waiter::ds;
+            entry.ipv6 = ipv6;
+            entry.ipv6timestamp = Waiter::ds;
+            count++;
+        }
+    }
+
+    NET_debug << "Imported " << count << " DNS cache entries from the previous session";
+}
+
 // wake up from cURL I/O
 void CurlHttpIO::addevents(Waiter* w, int)
 {
@@ -1006,7 +1291,24 @@ void CurlHttpIO::addevents(Waiter* w, int)
     CodeCounter::ScopeTimer ccst(countCurlHttpIOAddevents);
 #endif
 
+#ifndef WIN32
+    if (mNetThread.joinable())
+    {
+        // the network thread's waiter owns the sockets and timeouts; the
+        // client thread only releases the big lock while blocked and gets
+        // woken through notify() on completions
+        mClientWaiter = w;
+        ((WAIT_CLASS*)w)->pcsHTTP = &mCsHTTP;
+        return;
+    }
+#endif
+
     waiter = (WAIT_CLASS*)w;
+    addeventsinternal();
+}
+
+void CurlHttpIO::addeventsinternal()
+{
     long curltimeoutms = -1;
 
 #ifdef MEGA_USE_C_ARES
@@ -1460,7 +1762,7 @@ void CurlHttpIO::send_request(CurlHttpContext* httpctx)
 
     LOG_debug << httpctx->req->logname << req->getMethodString() << " target URL: " << getSafeUrl(req->posturl);
 
-    if (req->binary)
+    if (req->binary || req->outgzipped)
     {
         LOG_debug << httpctx->req->logname << "[sending " << (data ? len : req->out->size()) << " bytes of raw data]";
     }
@@ -1481,6 +1783,10 @@ void CurlHttpIO::send_request(CurlHttpContext* httpctx)
     }
 
     httpctx->headers = clone_curl_slist(req->type == REQ_JSON ? httpio->contenttypejson : httpio->contenttypebinary);
+    if (req->outgzipped)
+    {
+        httpctx->headers = curl_slist_append(httpctx->headers, "Content-Encoding: gzip");
+    }
     httpctx->posturl = req->posturl;
 
 #ifdef MEGA_USE_C_ARES
@@ -1563,6 +1869,28 @@ void CurlHttpIO::send_request(CurlHttpContext* httpctx)
         // Some networks (eg vodafone UK) seem to block TLS 1.3 ClientHello.  1.2 is secure, and works:
         curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2 | CURL_SSLVERSION_MAX_TLSv1_2);
 
+#if LIBCURL_VERSION_NUM >= 0x072f00
+        if (httpio->curlhttp2 && httpctx->d != PUT)
+        {
+            // negotiate HTTP/2 via ALPN, transparently falling back to
+            // HTTP/1.1 against servers that don't offer it
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            if (httpctx->d == API)
+            {
+                // prefer multiplexing onto the established API connection
+                // over opening another one per request
+                curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+            }
+        }
+#endif
+
+        if (int tunedrcvbuf = httpio->getsockettuning().rcvbuf)
+        {
+            // grow curl's read buffer alongside the kernel buffer, so large
+            // receive windows are drained in fewer, bigger reads
+            curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, std::min(long(tunedrcvbuf), 524288L));
+        }
+
         if (httpio->maxspeed[GET] && httpio->maxspeed[GET] <= 102400)
         {
             LOG_debug << "Low maxspeed, set curl buffer size to 4 KB";
@@ -1885,6 +2213,16 @@ int CurlHttpIO::debug_callback(CURL*, curl_infotype type, char* data, size_t siz
 // POST request to URL
 void CurlHttpIO::post(HttpReq* req, const char* data, unsigned len)
 {
+    // the notification is sticky, so waking here (we hold the big lock until
+    // all new handles are registered) is as good as waking on return
+    wakeNetworkThread();
+
+    if (gzipRequestThreshold && !req->binary && !data && !req->outgzipped
+        && req->type == REQ_JSON && req->out->size() >= gzipRequestThreshold)
+    {
+        req->gzipRequestBody();
+    }
+
     CurlHttpContext* httpctx = new CurlHttpContext;
     httpctx->curl = NULL;
     httpctx->httpio = this;
@@ -1991,7 +2329,10 @@ void CurlHttpIO::post(HttpReq* req, const char* data, unsigned len)
 
     req->in.clear();
     req->status = REQ_INFLIGHT;
-    req->postStartTime = std::chrono::steady_clock::now();
+    // tickTime rather than now(), so that elapsed-time deltas taken against
+    // the per-iteration timestamp can never come out negative
+    req->postStartTime = Waiter::tickTime;
+    req->firstByteTime = std::chrono::steady_clock::time_point();
 
     if (proxyip.size() && req->method != METHOD_NONE)
     {
@@ -2072,6 +2413,8 @@ void CurlHttpIO::post(HttpReq* req, const char* data, unsigned len)
 
 void CurlHttpIO::setproxy(Proxy* proxy)
 {
+    wakeNetworkThread();
+
     // clear the previous proxy IP
     proxyip.clear();
 
@@ -2121,6 +2464,8 @@ void CurlHttpIO::cancel(HttpReq* req)
 {
     if (req->httpiohandle)
     {
+        wakeNetworkThread();
+
         CurlHttpContext* httpctx = (CurlHttpContext*)req->httpiohandle;
         if (httpctx->curl)
         {
@@ -2170,6 +2515,22 @@ m_off_t CurlHttpIO::postpos(void* handle)
 
 // process events
 bool CurlHttpIO::doio()
+{
+#ifndef WIN32
+    if (mNetThread.joinable())
+    {
+        // the network thread services the sockets; we run under the big
+        // lock, so just collect the state changes it accumulated
+        bool result = statechange;
+        statechange = false;
+        return result;
+    }
+#endif
+
+    return doiointernal();
+}
+
+bool CurlHttpIO::doiointernal()
 {
     bool result;
     statechange = false;
@@ -2578,6 +2939,18 @@ size_t CurlHttpIO::read_data(void* ptr, size_t size, size_t nmemb, void* source)
         if (!isApi)
         {
             long maxbytes = long( (httpio->maxspeed[PUT] - httpio->uploadSpeed) * (SpeedController::SPEED_MEAN_MAX_INTERVAL_DS / 10) - httpio->partialdata[PUT] );
+
+            TrafficShaper& shaper = httpio->trafficshaper[PUT];
+            if (shaper.active())
+            {
+                // limit this class to its bucket plus whatever it can borrow
+                m_off_t classbytes = shaper.avail(req->trafficclass);
+                if (maxbytes > classbytes)
+                {
+                    maxbytes = long(classbytes);
+                }
+            }
+
             if (maxbytes <= 0)
             {
                 httpio->pausedrequests[PUT].insert(httpctx->curl);
@@ -2589,6 +2962,11 @@ size_t CurlHttpIO::read_data(void* ptr, size_t size, size_t nmemb, void* source)
             {
                 nread = maxbytes;
             }
+
+            if (shaper.active())
+            {
+                shaper.consume(req->trafficclass, nread);
+            }
             httpio->partialdata[PUT] += nread;
         }
     }
@@ -2613,19 +2991,31 @@ size_t CurlHttpIO::write_data(void* ptr, size_t size, size_t nmemb, void* target
             bool isApi = (req->type == REQ_JSON);
             if (!isApi && !isUpload)
             {
-                if ((httpio->downloadSpeed + 10 * (httpio->partialdata[GET] + len) / SpeedController::SPEED_MEAN_MAX_INTERVAL_DS) > httpio->maxspeed[GET])
+                TrafficShaper& shaper = httpio->trafficshaper[GET];
+
+                if ((httpio->downloadSpeed + 10 * (httpio->partialdata[GET] + len) / SpeedController::SPEED_MEAN_MAX_INTERVAL_DS) > httpio->maxspeed[GET]
+                    || (shaper.active() && shaper.avail(req->trafficclass) < len))
                 {
                     CurlHttpContext* httpctx = (CurlHttpContext*)req->httpiohandle;
                     httpio->pausedrequests[GET].insert(httpctx->curl);
                     httpio->arerequestspaused[GET] = true;
                     return CURL_WRITEFUNC_PAUSE;
                 }
+
+                if (shaper.active())
+                {
+                    shaper.consume(req->trafficclass, len);
+                }
                 httpio->partialdata[GET] += len;
             }
         }
 
         if (len)
         {
+            if (req->firstByteTime == std::chrono::steady_clock::time_point())
+            {
+                req->firstByteTime = Waiter::tickTime;
+            }
             req->put(ptr, len, true);
         }
 
@@ -2735,52 +3125,68 @@ int CurlHttpIO::seek_data(void *userp, curl_off_t offset, int origin)
     return CURL_SEEKFUNC_OK;
 }
 
-int CurlHttpIO::socket_callback(CURL *, curl_socket_t s, int what, void *userp, void *, direction_t d)
+int CurlHttpIO::socket_callback(CURL *, curl_socket_t s, int what, void *userp, void *socketp, direction_t d)
 {
     CurlHttpIO *httpio = (CurlHttpIO *)userp;
     SockInfoMap &socketmap = httpio->curlsockets[d];
 
+    // the SockInfo cached with curl_multi_assign below comes back in
+    // socketp, saving a map lookup on every state change (map nodes are
+    // stable, so the pointer survives unrelated inserts and erases)
+    SockInfo* info = (SockInfo*)socketp;
+
     if (what == CURL_POLL_REMOVE)
     {
-        auto it = socketmap.find(s);
-        if (it != socketmap.end())
+        if (!info)
+        {
+            auto it = socketmap.find(s);
+            info = it != socketmap.end() ? &it->second : nullptr;
+        }
+
+        if (info)
         {
             LOG_debug << "Removing socket " << s;
 
 #if defined(_WIN32)
-            it->second.closeEvent();
+            info->closeEvent();
 #endif
-            it->second.mode = 0;
+            info->mode = 0;
+            httpio->removedcurlsockets[d]++;
         }
     }
     else
     {
-        auto it = socketmap.find(s);
-        if (it == socketmap.end())
+        if (!info)
         {
-            LOG_debug << "Adding curl socket " << s << " to " << what;
+            auto it = socketmap.find(s);
+            if (it == socketmap.end())
+            {
+                LOG_debug << "Adding curl socket " << s << " to " << what;
 #ifdef WIN32
-            auto pair = socketmap.emplace(s, SockInfo(httpio->mSocketsWaitEvent));
+                auto pair = socketmap.emplace(s, SockInfo(httpio->mSocketsWaitEvent));
 #else
-            auto pair = socketmap.emplace(s, SockInfo());
+                auto pair = socketmap.emplace(s, SockInfo());
 #endif
-            it = pair.first;
-        }
-        else
-        {
-            // Networking seems to be fine after performance improvments, no need for this logging anymore - but keep it in comments for a while to inform people debugging older logs
-            //LOG_debug << "Setting curl socket " << s << " to " << what;
+                it = pair.first;
+            }
+            else
+            {
+                // Networking seems to be fine after performance improvments, no need for this logging anymore - but keep it in comments for a while to inform people debugging older logs
+                //LOG_debug << "Setting curl socket " << s << " to " << what;
+            }
+
+            info = &it->second;
+            curl_multi_assign(httpio->curlm[d], s, info);
         }
 
-        auto& info = it->second;
-        info.fd = s;
-        info.mode = what;
+        info->fd = s;
+        info->mode = what;
 #if defined(_WIN32)
-        info.createAssociateEvent();
+        info->createAssociateEvent();
 
         if (what & CURL_POLL_OUT)
         {
-            info.signalledWrite = true;
+            info->signalledWrite = true;
         }
 #endif
     }
@@ -2791,11 +3197,48 @@ int CurlHttpIO::socket_callback(CURL *, curl_socket_t s, int what, void *userp,
 // This one was causing us to issue additional c-ares requests, when normal usage already sends those requests
 // CURL doco: When set, this callback function gets called by libcurl when the socket has been created, but before the connect call to allow applications to change specific socket options.The callback's purpose argument identifies the exact purpose for this particular socket:
 
-int CurlHttpIO::sockopt_callback(void *clientp, curl_socket_t, curlsocktype)
+int CurlHttpIO::sockopt_callback(void *clientp, curl_socket_t s, curlsocktype)
 {
-#ifdef MEGA_USE_C_ARES
     HttpReq *req = (HttpReq*)clientp;
     CurlHttpIO* httpio = (CurlHttpIO*)req->httpio;
+
+    if (httpio)
+    {
+        // apply the app-requested kernel socket tuning before the connect;
+        // refusals are logged and otherwise ignored, leaving the OS defaults
+        HttpIO::SocketTuning tuning = httpio->getsockettuning();
+
+        if (tuning.rcvbuf > 0
+                && setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char*)&tuning.rcvbuf, sizeof(tuning.rcvbuf)))
+        {
+            LOG_warn << "Failed to set SO_RCVBUF to " << tuning.rcvbuf << ": errno " << errno;
+        }
+
+        if (tuning.sndbuf > 0
+                && setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char*)&tuning.sndbuf, sizeof(tuning.sndbuf)))
+        {
+            LOG_warn << "Failed to set SO_SNDBUF to " << tuning.sndbuf << ": errno " << errno;
+        }
+
+#ifdef TCP_NOTSENT_LOWAT
+        if (tuning.notsentlowat > 0
+                && setsockopt(s, IPPROTO_TCP, TCP_NOTSENT_LOWAT, (const char*)&tuning.notsentlowat, sizeof(tuning.notsentlowat)))
+        {
+            LOG_warn << "Failed to set TCP_NOTSENT_LOWAT to " << tuning.notsentlowat << ": errno " << errno;
+        }
+#endif
+
+#ifdef TCP_CONGESTION
+        if (!tuning.congestionalg.empty()
+                && setsockopt(s, IPPROTO_TCP, TCP_CONGESTION, tuning.congestionalg.c_str(), socklen_t(tuning.congestionalg.size())))
+        {
+            // typically the algorithm module (eg. bbr) is not loaded or not permitted
+            LOG_warn << "Failed to set TCP_CONGESTION to '" << tuning.congestionalg << "': errno " << errno;
+        }
+#endif
+    }
+
+#ifdef MEGA_USE_C_ARES
     CurlHttpContext* httpctx = (CurlHttpContext*)req->httpiohandle;
     if (httpio && !httpio->disconnecting
             && httpctx && httpctx->isCachedIp && !httpctx->ares_pending && httpio->dnscache[httpctx->hostname].mNeedsResolvingAgain)
@@ -26,11 +26,36 @@
     #include <poll.h> //poll
 #endif
 
+#ifdef USE_EPOLL
+    #include <sys/epoll.h>
+#endif
+
+#ifdef USE_KQUEUE
+    #include <sys/event.h>
+    #include <sys/time.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/eventfd.h>
+#endif
+
 namespace mega {
 dstime Waiter::ds;
+std::chrono::steady_clock::time_point Waiter::tickTime;
 
 PosixWaiter::PosixWaiter()
 {
+#ifdef __linux__
+    // a single eventfd replaces the wakeup pipe: notifying threads bump a
+    // counter and one 8-byte read drains any number of coalesced wakeups,
+    // so a burst of completions costs one syscall round trip, not one each
+    m_pipe[0] = m_pipe[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_pipe[0] < 0)
+    {
+        LOG_fatal << "Error creating eventfd";
+        throw std::runtime_error("Error creating eventfd");
+    }
+#else
     // pipe to be able to leave the select() call
     if (pipe(m_pipe) < 0)
     {
@@ -42,6 +67,23 @@ PosixWaiter::PosixWaiter()
     {
         LOG_err << "fcntl error";
     }
+#endif
+
+#ifdef USE_EPOLL
+    m_kernelfd = epoll_create1(0);
+    if (m_kernelfd < 0)
+    {
+        LOG_fatal << "Error creating epoll instance";
+        throw std::runtime_error("Error creating epoll instance");
+    }
+#elif defined(USE_KQUEUE)
+    m_kernelfd = kqueue();
+    if (m_kernelfd < 0)
+    {
+        LOG_fatal << "Error creating kqueue instance";
+        throw std::runtime_error("Error creating kqueue instance");
+    }
+#endif
 
     maxfd = -1;
 }
@@ -49,7 +91,12 @@ PosixWaiter::PosixWaiter()
 PosixWaiter::~PosixWaiter()
 {
     close(m_pipe[0]);
+#ifndef __linux__
     close(m_pipe[1]);
+#endif
+#if defined(USE_EPOLL) || defined(USE_KQUEUE)
+    close(m_kernelfd);
+#endif
 }
 
 void PosixWaiter::init(dstime ds)
@@ -65,13 +112,14 @@ void PosixWaiter::init(dstime ds)
 }
 
 // update monotonously increasing timestamp in deciseconds
+// (a single clock read serves both the decisecond tick and the cached
+// fine-grained timestamp)
 void Waiter::bumpds()
 {
-    timespec ts;
-
-    m_clock_getmonotonictime(&ts);
+    tickTime = std::chrono::steady_clock::now();
 
-    ds = static_cast<dstime>(ts.tv_sec * 10 + ts.tv_nsec / 100000000);
+    ds = static_cast<dstime>(std::chrono::duration_cast<std::chrono::milliseconds>(
+             tickTime.time_since_epoch()).count() / 100);
 }
 
 // update maxfd for select()
@@ -103,6 +151,14 @@ int PosixWaiter::wait()
     int numfd = 0;
     timeval tv;
 
+    // our fd sets were filled while holding the HTTP lock; from here on they
+    // are private to this thread, so the network thread can have the lock
+    // while we block
+    if (pcsHTTP)
+    {
+        pcsHTTP->unlock();
+    }
+
     //Pipe added to rfds to be able to leave select() when needed
     MEGA_FD_SET(m_pipe[0], &rfds);
 
@@ -116,7 +172,130 @@ int PosixWaiter::wait()
         tv.tv_usec = (suseconds_t)(us - tv.tv_sec * 1000000);
     }
 
-#ifdef USE_POLL
+#ifdef USE_EPOLL
+    // Update the persistent kernel interest set from this cycle's fd sets.
+    // Registrations are refreshed unconditionally: a closed fd leaves the
+    // epoll set implicitly and its number may have been reused for a new
+    // socket since the last cycle, so an unchanged mask proves nothing. Each
+    // update is O(1) in the kernel and the wait itself scales with the number
+    // of ready fds, not registered ones - and there is no FD_SETSIZE cap.
+    std::map<int, uint32_t> desired;
+    for (auto& fd : rfds) desired[fd] |= EPOLLIN;
+    for (auto& fd : wfds) desired[fd] |= EPOLLOUT;
+    for (auto& fd : efds) desired[fd] |= EPOLLPRI;
+
+    for (std::map<int, uint32_t>::iterator it = m_registered.begin(); it != m_registered.end(); )
+    {
+        if (desired.find(it->first) == desired.end())
+        {
+            epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            epoll_ctl(m_kernelfd, EPOLL_CTL_DEL, it->first, &ev);
+            m_registered.erase(it++);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    for (auto& d : desired)
+    {
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = d.second;
+        ev.data.fd = d.first;
+
+        if (epoll_ctl(m_kernelfd, EPOLL_CTL_MOD, d.first, &ev)
+                && (errno != ENOENT || epoll_ctl(m_kernelfd, EPOLL_CTL_ADD, d.first, &ev)))
+        {
+            LOG_warn << "epoll_ctl failed for fd " << d.first << " errno: " << errno;
+            m_registered.erase(d.first);
+        }
+        else
+        {
+            m_registered[d.first] = d.second;
+        }
+    }
+
+    epoll_event evs[128];
+    numfd = epoll_wait(m_kernelfd, evs, 128, maxds + 1 ? int(maxds * 100) : -1);
+#elif defined(USE_KQUEUE)
+    // Same idea with kqueue, where EV_ADD both registers and updates: the
+    // whole refresh travels in the changelist of the single kevent() call
+    // that also waits. kqueue has no urgent-data filter, so efds ride on
+    // EVFILT_READ. Deletions of auto-removed fds come back as EV_ERROR
+    // entries in the event list and are filtered out below.
+    std::map<int, uint32_t> desired;   // bit 0: read, bit 1: write
+    for (auto& fd : rfds) desired[fd] |= 1;
+    for (auto& fd : efds) desired[fd] |= 1;
+    for (auto& fd : wfds) desired[fd] |= 2;
+
+    std::vector<struct kevent> changes;
+    changes.reserve(desired.size() * 2 + m_registered.size() * 2);
+
+    struct kevent ev;
+    for (std::map<int, uint32_t>::iterator it = m_registered.begin(); it != m_registered.end(); )
+    {
+        if (desired.find(it->first) == desired.end())
+        {
+            if (it->second & 1)
+            {
+                EV_SET(&ev, it->first, EVFILT_READ, EV_DELETE, 0, 0, 0);
+                changes.push_back(ev);
+            }
+            if (it->second & 2)
+            {
+                EV_SET(&ev, it->first, EVFILT_WRITE, EV_DELETE, 0, 0, 0);
+                changes.push_back(ev);
+            }
+            m_registered.erase(it++);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    for (auto& d : desired)
+    {
+        uint32_t& registered = m_registered[d.first];
+
+        if (d.second & 1)
+        {
+            EV_SET(&ev, d.first, EVFILT_READ, EV_ADD, 0, 0, 0);
+            changes.push_back(ev);
+        }
+        else if (registered & 1)
+        {
+            EV_SET(&ev, d.first, EVFILT_READ, EV_DELETE, 0, 0, 0);
+            changes.push_back(ev);
+        }
+
+        if (d.second & 2)
+        {
+            EV_SET(&ev, d.first, EVFILT_WRITE, EV_ADD, 0, 0, 0);
+            changes.push_back(ev);
+        }
+        else if (registered & 2)
+        {
+            EV_SET(&ev, d.first, EVFILT_WRITE, EV_DELETE, 0, 0, 0);
+            changes.push_back(ev);
+        }
+
+        registered = d.second;
+    }
+
+    struct kevent evs[128];
+    timespec kts, *ktsp = NULL;
+    if (maxds + 1)
+    {
+        kts.tv_sec = maxds / 10;
+        kts.tv_nsec = long(maxds % 10) * 100000000L;
+        ktsp = &kts;
+    }
+    numfd = kevent(m_kernelfd, changes.data(), int(changes.size()), evs, 128, ktsp);
+#elif defined(USE_POLL)
     dstime ms = 1000 / 10 * maxds;
 
     auto total = rfds.size() +  wfds.size() +  efds.size();
@@ -149,16 +328,26 @@ int PosixWaiter::wait()
     numfd = select(maxfd + 1, &rfds, &wfds, &efds, maxds + 1 ? &tv : NULL);
 #endif
 
-    // empty pipe
-    uint8_t buf;
+    if (pcsHTTP)
+    {
+        pcsHTTP->lock();
+    }
+
+    // drain accumulated notifications
     bool external = false;
 
     {
         std::lock_guard<std::mutex> g(mMutex);
+#ifdef __linux__
+        uint64_t count;
+        external = read(m_pipe[0], &count, sizeof count) == sizeof count;
+#else
+        uint8_t buf;
         while (read(m_pipe[0], &buf, sizeof buf) > 0)
         {
             external = true;
         }
+#endif
         alreadyNotified = false;
     }
 
@@ -169,7 +358,25 @@ int PosixWaiter::wait()
     }
 
     // request exec() to be run only if a non-ignored fd was triggered
-#ifdef USE_POLL
+#ifdef USE_EPOLL
+    for (int i = 0; i < numfd; i++)
+    {
+        if (!MEGA_FD_ISSET(evs[i].data.fd, &ignorefds))
+        {
+            return NEEDEXEC;
+        }
+    }
+    return 0;
+#elif defined(USE_KQUEUE)
+    for (int i = 0; i < numfd; i++)
+    {
+        if (!(evs[i].flags & EV_ERROR) && !MEGA_FD_ISSET(int(evs[i].ident), &ignorefds))
+        {
+            return NEEDEXEC;
+        }
+    }
+    return 0;
+#elif defined(USE_POLL)
     for (unsigned int i = 0 ; i < total ; i++)
     {
         if  ((fds[i].revents & (POLLIN_SET | POLLOUT_SET | POLLEX_SET) )  && !MEGA_FD_ISSET(fds[i].fd, &ignorefds) )
@@ -191,7 +398,12 @@ void PosixWaiter::notify()
     std::lock_guard<std::mutex> g(mMutex);
     if (!alreadyNotified)
     {
+#ifdef __linux__
+        uint64_t one = 1;
+        auto w = write(m_pipe[1], &one, sizeof one);
+#else
         auto w = write(m_pipe[1], "0", 1);
+#endif
         if (w <= 0)
         {
             LOG_warn << "PosixWaiter::notify(), write returned " << w;
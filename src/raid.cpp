@@ -27,6 +27,14 @@
 
 #undef min //avoids issues with std::min
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAID_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define RAID_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace mega
 {
 
@@ -340,6 +348,22 @@ void RaidBufferManager::bufferWriteCompleted(unsigned connectionNum, bool succes
     }
 }
 
+std::shared_ptr<RaidBufferManager::FilePiece> RaidBufferManager::detachOutputBuffer(unsigned connectionNum)
+{
+    std::shared_ptr<FilePiece> piece;
+    auto aob = asyncoutputbuffers.find(connectionNum);
+    if (aob != asyncoutputbuffers.end())
+    {
+        piece.swap(aob->second);
+    }
+    return piece;
+}
+
+void RaidBufferManager::detachedWriteCompleted(FilePiece& r)
+{
+    bufferWriteCompletedAction(r);
+}
+
 void RaidBufferManager::bufferWriteCompletedAction(FilePiece&)
 {
     // overridden for Transfers
@@ -598,6 +622,29 @@ RaidBufferManager::FilePiece* RaidBufferManager::combineRaidParts(size_t partsle
 void RaidBufferManager::recoverSectorFromParity(byte* dest, byte* inputbufs[], unsigned offset)
 {
     assert(sizeof(m_off_t)*2 == RAIDSECTOR);
+#if defined(RAID_USE_SSE2)
+    // one sector is exactly one vector: xor the present parts branchlessly
+    // from zero rather than special-casing the first one
+    __m128i x = _mm_setzero_si128();
+    for (unsigned i = RAIDPARTS; i--; )
+    {
+        if (inputbufs[i])
+        {
+            x = _mm_xor_si128(x, _mm_loadu_si128((const __m128i*)(inputbufs[i] + offset)));
+        }
+    }
+    _mm_storeu_si128((__m128i*)dest, x);
+#elif defined(RAID_USE_NEON)
+    uint8x16_t x = vdupq_n_u8(0);
+    for (unsigned i = RAIDPARTS; i--; )
+    {
+        if (inputbufs[i])
+        {
+            x = veorq_u8(x, vld1q_u8(inputbufs[i] + offset));
+        }
+    }
+    vst1q_u8(dest, x);
+#else
     bool set = false;
     for (unsigned i = RAIDPARTS; i--; )
     {
@@ -615,6 +662,7 @@ void RaidBufferManager::recoverSectorFromParity(byte* dest, byte* inputbufs[], u
             }
         }
     }
+#endif
 }
 
 void RaidBufferManager::combineLastRaidLine(byte* dest, size_t remainingbytes)
@@ -782,6 +830,14 @@ bool RaidBufferManager::tryRaidHttpGetErrorRecovery(unsigned errorConnectionNum,
         }
 
         unusedRaidConnection = errorConnectionNum;
+        if (incrementErrors)
+        {
+            raidConnectionSwitchesError += 1;
+        }
+        else
+        {
+            raidConnectionSwitchesSlowness += 1;
+        }
         return true;
     }
     else
@@ -808,6 +864,7 @@ bool RaidBufferManager::detectSlowestRaidConnection(unsigned thisConnection, uns
         {
             unusedRaidConnection = slowestConnection;
             raidrequestpartpos[unusedRaidConnection] = raidpartspos;
+            raidConnectionSwitchesSlowStart += 1;
             return true;
         }
     }
@@ -834,6 +891,33 @@ unsigned RaidBufferManager::getUnusedRaidConnection() const
     return unusedRaidConnection;
 }
 
+void RaidBufferManager::tuneRaidLinesPerChunk(m_off_t maxRequestSize)
+{
+    if (!isRaid())
+    {
+        return;
+    }
+
+    unsigned lines = static_cast<unsigned>(maxRequestSize / (RAIDPARTS * 3 * RAIDSECTOR));
+    lines -= lines % 1024;
+
+    // wider envelope than the static sizing in setIsRaid, since these values
+    // come from the measured bandwidth-delay product rather than a platform guess
+    lines = std::min<unsigned>(lines, 512 * 1024);
+    lines = std::max<unsigned>(lines, 16 * 1024);
+
+    if (lines != raidLinesPerChunk)
+    {
+        LOG_debug << "Tuned raid lines per chunk from " << raidLinesPerChunk << " to " << lines;
+        raidLinesPerChunk = lines;
+    }
+}
+
+unsigned RaidBufferManager::getRaidLinesPerChunk() const
+{
+    return raidLinesPerChunk;
+}
+
 m_off_t RaidBufferManager::progress() const
 {
     assert(isRaid());
@@ -875,7 +959,7 @@ m_off_t& TransferBufferManager::transferPos(unsigned connectionNum)
 {
     return isRaid() ? RaidBufferManager::transferPos(connectionNum) : transfer->pos;
 }
-std::pair<m_off_t, m_off_t> TransferBufferManager::nextNPosForConnection(unsigned connectionNum, m_off_t maxRequestSize, unsigned connectionCount, bool& newInputBufferSupplied, bool& pauseConnectionForRaid, m_off_t uploadSpeed)
+std::pair<m_off_t, m_off_t> TransferBufferManager::nextNPosForConnection(unsigned connectionNum, m_off_t maxRequestSize, unsigned connectionCount, bool& newInputBufferSupplied, bool& pauseConnectionForRaid, m_off_t uploadSpeed, m_off_t downloadSpeed, unsigned errorCount)
 {
     // returning a pair for clarity - specifying the beginning and end position of the next data block, as the 'current pos' may be updated during this function
     newInputBufferSupplied = false;
@@ -916,6 +1000,22 @@ std::pair<m_off_t, m_off_t> TransferBufferManager::nextNPosForConnection(unsigne
         else if (transfer->type == GET)
         {
             maxReqSize = (transfer->size - transfer->progresscompleted) / connectionCount / 2;
+
+            // scale with measured throughput: target about two seconds of
+            // data per connection, so fast links issue fewer, larger
+            // requests while slow or freshly started ones keep small ranges
+            // and quick feedback
+            m_off_t speedsize = std::max<m_off_t>(0x100000, downloadSpeed * 2 / static_cast<m_off_t>(connectionCount));
+
+            // back off after transient errors - retransmitting a large range
+            // on a lossy connection wastes more than the round trips saved
+            speedsize >>= std::min<unsigned>(errorCount, 4);
+
+            if (maxReqSize > speedsize)
+            {
+                maxReqSize = speedsize;
+            }
+
             if (maxReqSize > maxRequestSize)
             {
                 maxReqSize = maxRequestSize;
@@ -972,26 +1072,31 @@ m_off_t DirectReadBufferManager::calcOutputChunkPos(m_off_t acquiredpos)
 }
 
 void DirectReadBufferManager::finalize(FilePiece& fp)
+{
+    decryptInPlace(fp.buf.datastart(), fp.buf.datalen(), fp.pos);
+}
+
+void DirectReadBufferManager::decryptInPlace(byte* buf, size_t len, m_off_t pos)
 {
     int r, l, t;
 
     // decrypt, pass to app and erase
-    r = fp.pos & (SymmCipher::BLOCKSIZE - 1);
-    t = int(fp.buf.datalen());
+    r = pos & (SymmCipher::BLOCKSIZE - 1);
+    t = int(len);
 
     if (r)
     {
-        byte buf[SymmCipher::BLOCKSIZE];
-        l = static_cast<int>(sizeof buf - r);
+        byte blockbuf[SymmCipher::BLOCKSIZE];
+        l = static_cast<int>(sizeof blockbuf - r);
 
         if (l > t)
         {
             l = t;
         }
 
-        memcpy(buf + r, fp.buf.datastart(), l);
-        directRead->drn->symmcipher.ctr_crypt(buf, sizeof buf, fp.pos - r, directRead->drn->ctriv, NULL, false);
-        memcpy(fp.buf.datastart(), buf + r, l);
+        memcpy(blockbuf + r, buf, l);
+        directRead->drn->symmcipher.ctr_crypt(blockbuf, sizeof blockbuf, pos - r, directRead->drn->ctriv, NULL, false);
+        memcpy(buf, blockbuf + r, l);
     }
     else
     {
@@ -1001,7 +1106,7 @@ void DirectReadBufferManager::finalize(FilePiece& fp)
     if (t > l)
     {
         // the buffer has some extra at the end to allow full blocksize decrypt at the end
-        directRead->drn->symmcipher.ctr_crypt(fp.buf.datastart() + l, t - l, fp.pos + l, directRead->drn->ctriv, NULL, false);
+        directRead->drn->symmcipher.ctr_crypt(buf + l, t - l, pos + l, directRead->drn->ctriv, NULL, false);
     }
 }
 
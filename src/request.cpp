@@ -36,6 +36,7 @@ void Request::add(Command* c)
     // Once this becomes the in-progress request, it must not have anything added
     assert(cachedJSON.empty());
 
+    mEstimatedBytes += c->estimatedSize() + 3;  // ,{...}
     cmds.push_back(unique_ptr<Command>(c));
 }
 
@@ -44,12 +45,27 @@ size_t Request::size() const
     return cmds.size();
 }
 
-string Request::get(bool& suppressSID, MegaClient* client, char reqidCounter[10], string& idempotenceId) const
+const string& Request::get(bool& suppressSID, MegaClient* client, char reqidCounter[10], string& idempotenceId) const
 {
     if (cachedJSON.empty())
     {
+        // finalize each command body first, so the batch buffer can be
+        // allocated once at its exact size instead of growing append by append
+        vector<pair<const char*, size_t>> bodies;
+        bodies.reserve(cmds.size());
+
+        size_t total = 2;   // []
+        for (auto& cmd : cmds)
+        {
+            const char* body = cmd->getJSON(client);
+            bodies.emplace_back(body, strlen(body));
+            total += bodies.back().second + 3;  // ,{...}
+            JSONWriter::noteFinalSize(bodies.back().second);
+        }
+
         // concatenate all command objects, resulting in an API request
         string& req = cachedJSON;
+        req.reserve(total);
         req = "[";
 
         cachedSuppressSID = true; // only if all commands in batch are suppressSID
@@ -59,7 +75,7 @@ string Request::get(bool& suppressSID, MegaClient* client, char reqidCounter[10]
         for (int i = 0; i < (int)cmds.size(); i++)
         {
             req.append(i ? ",{" : "{");
-            req.append(cmds[i]->getJSON(client));
+            req.append(bodies[i].first, bodies[i].second);
             req.append("}");
             cachedSuppressSID = cachedSuppressSID && cmds[i]->suppressSID;
             ++counts[cmds[i]->commandStr];
@@ -173,6 +189,27 @@ m_off_t Request::processChunk(const char* chunk, MegaClient *client)
     assert(isFetchNodes());
 
     m_off_t consumed = 0;
+
+    // resuming after a connection drop: the response is re-delivered from its
+    // first byte, so discard what the splitter already went through. Commands
+    // keep all state parsed so far (for fetchnodes, the node batches already
+    // written into the open statecache transaction)
+    m_off_t skipped = 0;
+    if (mChunkedResumeSkip)
+    {
+        size_t avail = strlen(chunk);
+        if (avail <= mChunkedResumeSkip)
+        {
+            mChunkedResumeSkip -= avail;
+            return static_cast<m_off_t>(avail);
+        }
+
+        skipped = static_cast<m_off_t>(mChunkedResumeSkip);
+        chunk += mChunkedResumeSkip;
+        mChunkedResumeSkip = 0;
+        LOG_debug << "Resuming chunked request parsing at byte " << mChunkedProgress;
+    }
+
     Command& cmd = *cmds[0];
     client->restag = cmd.tag;
     cmd.client = client;
@@ -220,7 +257,7 @@ m_off_t Request::processChunk(const char* chunk, MegaClient *client)
         clear();
     }
 
-    return consumed;
+    return consumed + skipped;
 }
 
 m_off_t Request::totalChunkedProgress()
@@ -357,14 +394,21 @@ void Request::servererror(const std::string& e, MegaClient* client)
 void Request::clear()
 {
     cmds.clear();
+    mEstimatedBytes = 0;
     jsonresponse.clear();
     json.pos = NULL;
     processindex = 0;
     mJsonSplitter.clear();
     mChunkedProgress = 0;
+    mChunkedResumeSkip = 0;
     stopProcessing = false;
 }
 
+void Request::prepareChunkedResume()
+{
+    mChunkedResumeSkip = mChunkedProgress;
+}
+
 bool Request::empty() const
 {
     return cmds.empty();
@@ -375,6 +419,7 @@ void Request::swap(Request& r)
     // we use swap to move between queues, but process only after it gets into the completedreqs
     cmds.swap(r.cmds);
     std::swap(mV3, r.mV3);
+    std::swap(mEstimatedBytes, r.mEstimatedBytes);
 
     std::swap(cachedJSON, r.cachedJSON);
     std::swap(cachedIdempotenceId, r.cachedIdempotenceId);
@@ -424,6 +469,11 @@ void RequestDispatcher::add(Command *c)
         LOG_debug << "Starting an additional Request due to MAX_COMMANDS";
         nextreqs.push_back(Request());
     }
+    if (nextreqs.back().estimatedBytes() >= MAX_BATCH_BYTES)
+    {
+        LOG_debug << "Starting an additional Request due to MAX_BATCH_BYTES";
+        nextreqs.push_back(Request());
+    }
     if (c->batchSeparately && !nextreqs.back().empty())
     {
         LOG_debug << "Starting an additional Request for a batch-separately command";
@@ -449,6 +499,13 @@ void RequestDispatcher::add(Command *c)
 
 bool RequestDispatcher::readyToSend() const
 {
+    if (mReceived.size() > 1)
+    {
+        // one response is being processed and another is already queued
+        // behind it: drain those before putting a third batch on the wire
+        return false;
+    }
+
     if (!inflightreq.empty())
     {
         // retry of prior attempt. Otherwise, we are waiting response, so not ready
@@ -464,15 +521,24 @@ bool RequestDispatcher::readyToSend() const
 bool RequestDispatcher::cmdsInflight() const
 {
     // stays true even through network errors, -3, retries, etc until we get that response
-    return !inflightreq.empty();
+    // (and until received responses have been processed, for seqtag purposes)
+    return !inflightreq.empty() || !mReceived.empty();
 }
 
 Command* RequestDispatcher::getCurrentCommand(bool currSeqtagSeen)
 {
-    return currSeqtagSeen ? inflightreq.getCurrentCommand() : nullptr;
+    if (!currSeqtagSeen)
+    {
+        return nullptr;
+    }
+
+    // command processing happens in the front queued response; the inflight
+    // slot is only processed directly for chunked (fetchnodes) requests
+    return mReceived.empty() ? inflightreq.getCurrentCommand()
+                             : mReceived.front().req.getCurrentCommand();
 }
 
-string RequestDispatcher::serverrequest(bool& suppressSID, bool &includesFetchingNodes, bool& v3, MegaClient* client, string& idempotenceId)
+const string& RequestDispatcher::serverrequest(bool& suppressSID, bool &includesFetchingNodes, bool& v3, MegaClient* client, string& idempotenceId)
 {
     if (!inflightreq.empty() && inflightFailReason != RETRY_NONE)
     {
@@ -490,7 +556,7 @@ string RequestDispatcher::serverrequest(bool& suppressSID, bool &includesFetchin
             nextreqs.push_back(Request());
         }
     }
-    string requestJSON = inflightreq.get(suppressSID, client, reqid, idempotenceId);
+    const string& requestJSON = inflightreq.get(suppressSID, client, reqid, idempotenceId);
     includesFetchingNodes = inflightreq.isFetchNodes();
     v3 = inflightreq.mV3;
 #ifdef MEGA_MEASURE_CODE
@@ -513,24 +579,78 @@ void RequestDispatcher::inflightFailure(retryreason_t reason)
     // just track whether we do need to resend, for cmdsInflight() signal
     assert(reason != RETRY_NONE);
     inflightFailReason = reason;
+
+    if (inflightreq.totalChunkedProgress())
+    {
+        // a partially parsed chunked response (fetchnodes): resume parsing of
+        // the re-delivered response at the last consumed chunk, rather than
+        // dropping everything and redownloading the full payload. If the new
+        // delivery doesn't match byte for byte, the splitter fails and the
+        // command restarts from scratch, as it always did
+        inflightreq.prepareChunkedResume();
+    }
 }
 
-void RequestDispatcher::serverresponse(std::string&& movestring, MegaClient *client)
+void RequestDispatcher::queueResponse(std::string&& movestring)
 {
-    CodeCounter::ScopeTimer ccst(client->performanceStats.csResponseProcessingTime);
-
 #ifdef MEGA_MEASURE_CODE
     csBatchesReceived += 1;
     csRequestsCompleted += inflightreq.size();
 #endif
-    processing = true;
-    inflightreq.serverresponse(std::move(movestring), client);
-    inflightreq.process(client);
-    processing = false;
-    if (clearWhenSafe)
+    assert(!inflightreq.empty());
+    assert(mReceived.size() < 2);
+
+    mReceived.emplace_back();
+    mReceived.back().req.swap(inflightreq);
+    mReceived.back().response = std::move(movestring);
+}
+
+bool RequestDispatcher::processQueuedResponses(MegaClient* client)
+{
+    bool any = false;
+
+    while (!mReceived.empty())
     {
-        clear();
+        ReceivedResponse& front = mReceived.front();
+
+        processing = true;
+        {
+            CodeCounter::ScopeTimer ccst(client->performanceStats.csResponseProcessingTime);
+
+            if (!front.started)
+            {
+                front.started = true;
+                if (front.isError)
+                {
+                    front.req.servererror(front.response, client);
+                }
+                else
+                {
+                    front.req.serverresponse(std::move(front.response), client);
+                }
+            }
+            front.req.process(client);
+        }
+        any = true;
+        processing = false;
+
+        if (clearWhenSafe)
+        {
+            clear();
+            return any;
+        }
+
+        if (!front.req.empty())
+        {
+            // paused waiting for sc catch-up of the current seqtag;
+            // continueProcessing() resumes once it arrives
+            return any;
+        }
+
+        mReceived.pop_front();
     }
+
+    return any;
 }
 
 size_t RequestDispatcher::serverChunk(const char *chunk, MegaClient *client)
@@ -554,28 +674,23 @@ void RequestDispatcher::servererror(const std::string& e, MegaClient *client)
 {
     // notify all the commands in the batch of the failure
     // so that they can deallocate memory, take corrective action etc.
-    processing = true;
-    inflightreq.servererror(e, client);
-    inflightreq.process(client);
-    assert(inflightreq.empty());
+    // Queued behind any earlier response so that it cannot overtake one
+    // that is still being processed
+    assert(!inflightreq.empty());
+
+    mReceived.emplace_back();
+    mReceived.back().req.swap(inflightreq);
+    mReceived.back().response = e;
+    mReceived.back().isError = true;
     inflightFailReason = RETRY_NONE;
-    processing = false;
-    if (clearWhenSafe)
-    {
-        clear();
-    }
+
+    processQueuedResponses(client);
 }
 
 void RequestDispatcher::continueProcessing(MegaClient* client)
 {
-    assert(!inflightreq.empty());
-    processing = true;
-    inflightreq.process(client);
-    processing = false;
-    if (clearWhenSafe)
-    {
-        clear();
-    }
+    assert(!mReceived.empty());
+    processQueuedResponses(client);
 }
 
 void RequestDispatcher::clear()
@@ -585,11 +700,20 @@ void RequestDispatcher::clear()
         // we are being called from a command that is in progress (eg. logout) - delay wiping the data structure until that call ends.
         clearWhenSafe = true;
         inflightreq.stopProcessing = true;
+        if (!mReceived.empty())
+        {
+            mReceived.front().req.stopProcessing = true;
+        }
     }
     else
     {
         inflightreq.clear();
         inflightFailReason = RETRY_NONE;
+        for (auto& r : mReceived)
+        {
+            r.req.clear();
+        }
+        mReceived.clear();
         for (auto& r : nextreqs)
         {
             r.clear();
@@ -21,17 +21,47 @@
 
 #include "mega/serialize64.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// the encoding stores the value's bytes least significant first, so on a
+// little-endian target a plain 8-byte move produces/consumes it directly
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || \
+    defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#define SERIALIZE64_LITTLE_ENDIAN 1
+#endif
+
 namespace mega {
 int Serialize64::serialize(byte* bytes, uint64_t value)
 {
-    byte byteCount = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    int byteCount = value ? (71 - __builtin_clzll(value)) / 8 : 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long msb;
+    int byteCount = _BitScanReverse64(&msb, value) ? (int(msb) + 8) / 8 : 0;
+#else
+    int byteCount = 0;
 
-    while (value)
+    for (uint64_t v = value; v; v >>= 8)
     {
-        bytes[++byteCount] = (byte)value;
+        byteCount++;
+    }
+#endif
+
+    bytes[0] = (byte)byteCount;
+
+#ifdef SERIALIZE64_LITTLE_ENDIAN
+    // one unconditional store; bytes beyond byteCount are scratch (the
+    // buffer is sizeof(value) + 1 by contract)
+    memcpy(bytes + 1, &value, sizeof(value));
+#else
+    for (int i = 1; i <= byteCount; i++)
+    {
+        bytes[i] = (byte)value;
         value >>= 8;
     }
-    bytes[0] = byteCount;
+#endif
 
     return byteCount + 1;
 }
@@ -45,6 +75,17 @@ int Serialize64::unserialize(byte* bytes, int blen, uint64_t* value)
         return -1;
     }
 
+#ifdef SERIALIZE64_LITTLE_ENDIAN
+    if (blen > (int)sizeof(*value))
+    {
+        // load all eight bytes at once and mask off the unencoded ones
+        uint64_t v;
+        memcpy(&v, bytes + 1, sizeof(v));
+        *value = byteCount ? v & (~uint64_t(0) >> (64 - 8 * byteCount)) : 0;
+        return byteCount + 1;
+    }
+#endif
+
     *value = 0;
 
     while (byteCount)
@@ -62,25 +62,14 @@ void ShareNodeKeys::add(std::shared_ptr<Node> n, std::shared_ptr<Node> sn, bool
 // add a nodecore (!sn: all relevant shares, otherwise starting from sn, fixed: only sn)
 void ShareNodeKeys::add(const string& nodekey, handle nodehandle, std::shared_ptr<Node> sn, bool includeParentChain, const byte* item, int itemlen)
 {
-    char buf[96];
-    char* ptr;
-    byte key[FILENODEKEYLENGTH];
-
     int addnode = 0;
 
-    // emit all share nodekeys for known shares
+    // record all share nodekeys for known shares (the AES wrap itself is
+    // deferred to wrappending() so it can run across threads for large trees)
     do {
         if (sn->sharekey)
         {
-            snprintf(buf, sizeof(buf), ",%d,%d,\"", addshare(sn), (int)items.size());
-
-            sn->sharekey->ecb_encrypt((byte*)nodekey.data(), key, nodekey.size());
-
-            ptr = strchr(buf + 5, 0);
-            ptr += Base64::btoa(key, int(nodekey.size()), ptr);
-            *ptr++ = '"';
-
-            keys.append(buf, ptr - buf);
+            pending.push_back(PendingKey{nodekey, addshare(sn), (int)items.size()});
             addnode = 1;
         }
     } while (includeParentChain && (sn = sn->parent));
@@ -100,8 +89,89 @@ void ShareNodeKeys::add(const string& nodekey, handle nodehandle, std::shared_pt
     }
 }
 
+void ShareNodeKeys::wrappending()
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    // wrap one pending entry, appending its cr fragment to out
+    auto wrap = [](const PendingKey& pk, SymmCipher& cipher, string& out)
+    {
+        char buf[96];
+        byte key[FILENODEKEYLENGTH];
+
+        snprintf(buf, sizeof(buf), ",%d,%d,\"", pk.shareindex, pk.itemindex);
+
+        cipher.ecb_encrypt((byte*)pk.nodekey.data(), key, pk.nodekey.size());
+
+        char* ptr = strchr(buf + 5, 0);
+        ptr += Base64::btoa(key, int(pk.nodekey.size()), ptr);
+        *ptr++ = '"';
+
+        out.append(buf, ptr - buf);
+    };
+
+    // only fan out when the batch is large enough to amortize thread startup
+    size_t workers = std::min<size_t>(pending.size() / 4096,
+                                      std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1);
+    workers = std::min<size_t>(workers, 8);
+
+    if (workers < 2)
+    {
+        for (const PendingKey& pk : pending)
+        {
+            wrap(pk, *shares[static_cast<size_t>(pk.shareindex)]->sharekey, keys);
+        }
+    }
+    else
+    {
+        // each worker wraps a contiguous range into its own buffer with its own
+        // copies of the share keys (SymmCipher is not thread-safe); appending
+        // the buffers in range order keeps the cr blob byte-identical to
+        // sequential processing
+        std::vector<string> parts(workers);
+        std::vector<std::thread> threads;
+
+        for (size_t w = 0; w < workers; w++)
+        {
+            threads.emplace_back([this, w, workers, &parts, &wrap]()
+            {
+                std::vector<std::unique_ptr<SymmCipher>> localkeys(shares.size());
+
+                size_t begin = pending.size() * w / workers;
+                size_t end = pending.size() * (w + 1) / workers;
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    const PendingKey& pk = pending[i];
+                    auto& cipher = localkeys[static_cast<size_t>(pk.shareindex)];
+
+                    if (!cipher)
+                    {
+                        cipher.reset(new SymmCipher(*shares[static_cast<size_t>(pk.shareindex)]->sharekey));
+                    }
+
+                    wrap(pk, *cipher, parts[w]);
+                }
+            });
+        }
+
+        for (size_t w = 0; w < workers; w++)
+        {
+            threads[w].join();
+            keys.append(parts[w]);
+        }
+    }
+
+    pending.clear();
+}
+
 void ShareNodeKeys::get(Command* c, bool skiphandles)
 {
+    wrappending();
+
     if (keys.size())
     {
         c->beginarray("cr");
@@ -0,0 +1,197 @@
+/**
+ * @file stallsampler.cpp
+ * @brief always-on sampling of exec() passes for post-hoc stall diagnosis
+ *
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega/stallsampler.h"
+#include "mega/utils.h"
+
+#include <sstream>
+
+namespace mega {
+
+namespace {
+
+uint32_t elapsedUs(std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - since).count();
+    return us > 0 ? static_cast<uint32_t>(std::min<int64_t>(us, UINT32_MAX)) : 0;
+}
+
+} // anonymous
+
+StallSampler::phase_t StallSampler::Sample::dominantPhase() const
+{
+    phase_t dominant = PHASE_OTHER;
+    for (int p = 1; p < PHASES; p++)
+    {
+        if (phaseUs[p] > phaseUs[dominant])
+        {
+            dominant = static_cast<phase_t>(p);
+        }
+    }
+    return dominant;
+}
+
+const char* StallSampler::phaseName(phase_t p)
+{
+    static const char* const names[PHASES] = {
+        "other",
+        "cs_response",
+        "sc_processing",
+        "transfers",
+    };
+    return p < PHASES ? names[p] : "?";
+}
+
+void StallSampler::beginPass()
+{
+    mPassStart = mPhaseStart = std::chrono::steady_clock::now();
+    mPhase = PHASE_OTHER;
+    memset(mPhaseUs, 0, sizeof(mPhaseUs));
+    mInPass = true;
+}
+
+void StallSampler::enterPhase(phase_t p)
+{
+    if (!mInPass)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    mPhaseUs[mPhase] += elapsedUs(mPhaseStart, now);
+    mPhaseStart = now;
+    mPhase = p;
+}
+
+void StallSampler::endPass()
+{
+    if (!mInPass)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    mPhaseUs[mPhase] += elapsedUs(mPhaseStart, now);
+    mInPass = false;
+
+    Sample sample;
+    sample.when = m_time();
+    sample.durationUs = elapsedUs(mPassStart, now);
+    memcpy(sample.phaseUs, mPhaseUs, sizeof(sample.phaseUs));
+
+    std::function<void(const Sample&)> stalled;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mRing[mNext] = sample;
+        mNext = (mNext + 1) % RINGSIZE;
+        if (mCount < RINGSIZE)
+        {
+            mCount++;
+        }
+        if (sample.durationUs > mWorst.durationUs)
+        {
+            mWorst = sample;
+        }
+        if (mCallback && sample.durationUs >= mThresholdMs * 1000)
+        {
+            stalled = mCallback;
+        }
+    }
+
+    // run the callback outside the lock so it can call snapshot()/report()
+    if (stalled)
+    {
+        stalled(sample);
+    }
+}
+
+std::vector<StallSampler::Sample> StallSampler::snapshot() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    std::vector<Sample> samples;
+    samples.reserve(mCount);
+    unsigned start = mCount < RINGSIZE ? 0 : mNext;
+    for (unsigned i = 0; i < mCount; i++)
+    {
+        samples.push_back(mRing[(start + i) % RINGSIZE]);
+    }
+    return samples;
+}
+
+StallSampler::Sample StallSampler::worstStall() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mWorst;
+}
+
+std::string StallSampler::report() const
+{
+    std::vector<Sample> samples = snapshot();
+    Sample worst = worstStall();
+
+    std::ostringstream s;
+    s << "worst: " << worst.durationUs << "us " << phaseName(worst.dominantPhase()) << " at " << worst.when << "\n";
+    for (const Sample& sample : samples)
+    {
+        s << sample.when << " " << sample.durationUs << "us";
+        for (int p = 0; p < PHASES; p++)
+        {
+            if (sample.phaseUs[p])
+            {
+                s << " " << phaseName(static_cast<phase_t>(p)) << "=" << sample.phaseUs[p] << "us";
+            }
+        }
+        s << "\n";
+    }
+    return s.str();
+}
+
+void StallSampler::setStallCallback(unsigned thresholdMs, std::function<void(const Sample&)> cb)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mThresholdMs = thresholdMs;
+    mCallback = std::move(cb);
+}
+
+StallSamplerPhase::StallSamplerPhase(StallSampler& sampler, StallSampler::phase_t p)
+    : mSampler(sampler)
+    , mPrevious(sampler.currentPhase())
+{
+    mSampler.enterPhase(p);
+}
+
+StallSamplerPhase::~StallSamplerPhase()
+{
+    mSampler.enterPhase(mPrevious);
+}
+
+StallSamplerPass::StallSamplerPass(StallSampler& sampler)
+    : mSampler(sampler)
+{
+    mSampler.beginPass();
+}
+
+StallSamplerPass::~StallSamplerPass()
+{
+    mSampler.endPass();
+}
+
+} // namespace
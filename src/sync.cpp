@@ -52,7 +52,15 @@ bool PerSyncStats::operator==(const PerSyncStats& other)
             numFiles == other.numFiles &&
             numFolders == other.numFolders &&
             numUploads == other.numUploads &&
-            numDownloads == other.numDownloads;
+            numDownloads == other.numDownloads &&
+            scannedFolders == other.scannedFolders &&
+            scannedItems == other.scannedItems &&
+            filterEvaluations == other.filterEvaluations &&
+            moveChecks == other.moveChecks &&
+            folderVisits == other.folderVisits &&
+            queuedNotifications == other.queuedNotifications &&
+            queuedDbChanges == other.queuedDbChanges &&
+            lastDbFlushMs == other.lastDbFlushMs;
 }
 
 bool PerSyncStats::operator!=(const PerSyncStats& other)
@@ -756,6 +764,10 @@ Sync::~Sync()
     // unlock tmp lock
     tmpfa.reset();
 
+    // Flush any still-queued changes before closing the db (the sync may
+    // be suspended here and resumed later from this state).
+    cachenodes();
+
     // Deleting localnodes after this will not remove them from the db.
     statecachetable.reset();
 
@@ -892,18 +904,91 @@ void Sync::readstatecache()
 
     // bulk-load cached nodes into tmap
     assert(!memcmp(syncs.syncKey.key, syncs.mClient.key.key, sizeof(syncs.syncKey.key)));
-    while (statecachetable->next(&cid, &cachedata, &syncs.syncKey))
+
+    // The rows are read sequentially (one sqlite cursor), but decryption and
+    // unserialization - the bulk of resume time on a large sync - run in
+    // batches on the client worker pool while this thread keeps reading.
+    // With zero worker threads the batches execute inline, as before.
+    // A row that fails to decrypt is skipped and ends up tidied away with
+    // the orphans below, rather than abandoning every row behind it
+    std::mutex doneMutex;
+    std::condition_variable doneCV;
+    size_t batchesInFlight = 0;
+
+    using RowBatch = vector<pair<uint32_t, string>>;
+    const size_t rowsPerBatch = 4096;
+    const size_t maxBatchesInFlight = 2 * std::max<unsigned>(1, std::thread::hardware_concurrency());
+
+    auto dispatch = [&](std::shared_ptr<RowBatch> batch)
     {
-        uint32_t parentID = 0;
+        {
+            // bound the raw rows held in memory while workers catch up
+            std::unique_lock<std::mutex> g(doneMutex);
+            doneCV.wait(g, [&]() { return batchesInFlight < maxBatchesInFlight; });
+            ++batchesInFlight;
+        }
 
-        if (auto l = LocalNode::unserialize(*this, cachedata, parentID))
+        syncs.mClient.mAsyncQueue.push([this, batch, &tmap, &numLocalNodes, &doneMutex, &doneCV, &batchesInFlight](SymmCipher& sc)
         {
-            l->dbid = cid;
-            tmap.emplace(parentID, l.release());
-            numLocalNodes += 1;
+            sc.setkey(syncs.syncKey.key);
+
+            vector<pair<uint32_t, LocalNode*>> loaded;
+            loaded.reserve(batch->size());
+
+            for (auto& row : *batch)
+            {
+                if (!PaddedCBC::decrypt(&row.second, &sc))
+                {
+                    LOG_err << "Sync statecache row " << row.first << " failed to decrypt";
+                    continue;
+                }
+
+                uint32_t parentID = 0;
+                if (auto l = LocalNode::unserialize(*this, row.second, parentID))
+                {
+                    l->dbid = row.first;
+                    loaded.emplace_back(parentID, l.release());
+                }
+            }
+
+            std::lock_guard<std::mutex> g(doneMutex);
+            for (auto& ln : loaded)
+            {
+                tmap.emplace(ln.first, ln.second);
+            }
+            numLocalNodes += unsigned(loaded.size());
+            --batchesInFlight;
+            doneCV.notify_all();
+        }, false);
+    };
+
+    auto batch = std::make_shared<RowBatch>();
+    while (statecachetable->nextRaw(&cid, &cachedata))
+    {
+        if (!cid)
+        {
+            continue;
+        }
+
+        batch->emplace_back(cid, std::move(cachedata));
+
+        if (batch->size() >= rowsPerBatch)
+        {
+            dispatch(std::move(batch));
+            batch = std::make_shared<RowBatch>();
         }
     }
 
+    if (!batch->empty())
+    {
+        dispatch(std::move(batch));
+    }
+
+    {
+        std::unique_lock<std::mutex> g(doneMutex);
+        doneCV.wait(g, [&]() { return batchesInFlight == 0; });
+    }
+
     // recursively build LocalNode tree
     {
         DBTableTransactionCommitter committer(statecachetable);
@@ -948,9 +1033,12 @@ void Sync::statecachedel(LocalNode* l)
         return;
     }
 
-    if (l->dbid && statecachetable)
+    if (l->dbid)
     {
-        statecachetable->del(l->dbid);
+        // Deletion is deferred; rows are removed in bulk when the
+        // queues are flushed.  Dbids are never reused, so a deferred
+        // delete cannot clobber a row written in the meantime.
+        deleteq.insert(l->dbid);
     }
     l->dbid = 0;
 
@@ -987,15 +1075,26 @@ void Sync::cachenodes()
     if (!statecachetable)
     {
         insertq.clear();
+        deleteq.clear();
         return;
     }
 
-    if (insertq.size())
+    if (deleteq.size() || insertq.size())
     {
-        LOG_debug << syncname << "Saving LocalNode database with " << insertq.size() << " additions";
+        LOG_debug << syncname << "Saving LocalNode database with " << insertq.size() << " additions and " << deleteq.size() << " deletions";
+
+        auto flushStart = std::chrono::high_resolution_clock::now();
 
         DBTableTransactionCommitter committer(statecachetable);
 
+        // deletions
+        for (uint32_t dbid : deleteq)
+        {
+            statecachetable->del(dbid);
+        }
+
+        deleteq.clear();
+
         // additions - we iterate until completion or until we get stuck
         bool added;
 
@@ -1024,6 +1123,35 @@ void Sync::cachenodes()
             LOG_err << "LocalNode caching did not complete";
             assert(false);
         }
+
+        // include the commit itself in the measured latency (a no-op if we
+        // are nested inside an outer committer's transaction)
+        committer.commitNow();
+
+        mLastDbFlushMs = unsigned(std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::high_resolution_clock::now() - flushStart).count());
+    }
+
+    mLastStatecacheFlush = syncs.waiter->ds;
+}
+
+void Sync::cachenodesIfDue()
+{
+    assert(syncs.onSyncThread());
+
+    if (insertq.empty() && deleteq.empty())
+    {
+        return;
+    }
+
+    // Flush immediately once plenty of changes have accumulated, otherwise
+    // wait out the interval, so that mass operations (eg. a branch switch
+    // touching 100k files) are written in a few large transactions rather
+    // than one commit per pass of the sync loop.
+    if (insertq.size() + deleteq.size() >= MAXSTATECACHEQUEUE
+        || syncs.waiter->ds >= mLastStatecacheFlush + STATECACHEFLUSHINTERVAL)
+    {
+        cachenodes();
     }
 }
 
@@ -1147,9 +1275,24 @@ LocalNode* Sync::localnodebypath(LocalNode* l, const LocalPath& localpath, Local
             *parent = l;
         }
 
-        localnode_map::iterator it;
-        if ((it = l->children.find(component)) == l->children.end()
-            && (it = l->schildren.find(component)) == l->schildren.end())
+        LocalNode* child = nullptr;
+
+        localnode_map::iterator it = l->children.find(component);
+        if (it != l->children.end())
+        {
+            child = it->second;
+        }
+        else if (l->hasRare())
+        {
+            auto& sc = l->rare().schildren;
+            auto sit = sc.find(component);
+            if (sit != sc.end())
+            {
+                child = sit->second;
+            }
+        }
+
+        if (!child)
         {
             // no full match: store residual path, return NULL with the
             // matching component LocalNode in parent
@@ -1166,7 +1309,7 @@ LocalNode* Sync::localnodebypath(LocalNode* l, const LocalPath& localpath, Local
             return NULL;
         }
 
-        l = it->second;
+        l = child;
     }
 
     // full match: no residual path, return corresponding LocalNode
@@ -1513,6 +1656,8 @@ bool Sync::checkSpecialFile(SyncRow& child, SyncRow& parent, SyncPath& path)
 
 bool Sync::checkLocalPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath, bool& rowResult, bool belowRemovedCloudNode)
 {
+    ++mMoveChecks;
+
     // We have detected that this LocalNode might be a move/rename target (the moved-to location).
     // Ie, there is a new/different FSItem in this row.
     // This function detects whether this is in fact a move or not, and takes care of performing the corresponding cloud move
@@ -2642,6 +2787,8 @@ bool Sync::checkForCompletedCloudMoveToHere(SyncRow& row, SyncRow& parentRow, Sy
 
 bool Sync::checkCloudPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath, bool& rowResult, bool belowRemovedFsNode)
 {
+    ++mMoveChecks;
+
     // We have detected that this LocalNode might be a move/rename target (the moved-to location).
     // Ie, there is a new/different CloudNode in this row.
     // This function detects whether this is in fact a move or not, and takes care of performing the corresponding local move/rename
@@ -3295,13 +3442,23 @@ dstime Sync::procscanq()
             if (nearest->scanDelayUntil >= syncs.waiter->ds)
             {
                 // self-caused notifications shouldn't cause extra waiting
-                --nearest->expectedSelfNotificationCount;
+                // (a coalesced notification stands for `count` raw events)
+                unsigned consumed = std::min(nearest->expectedSelfNotificationCount,
+                                             notification.count);
 
-                SYNC_verbose << "Skipping self-notification (remaining: "
-                    << nearest->expectedSelfNotificationCount << ") at: "
-                    << nearest->getLocalPath();
+                nearest->expectedSelfNotificationCount -= consumed;
 
-                continue;
+                if (consumed == notification.count)
+                {
+                    SYNC_verbose << "Skipping self-notification (remaining: "
+                        << nearest->expectedSelfNotificationCount << ") at: "
+                        << nearest->getLocalPath();
+
+                    continue;
+                }
+
+                // more coalesced events arrived than we caused ourselves,
+                // so something else changed too: fall through and scan
             }
             else
             {
@@ -6868,9 +7025,24 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
     vector<SyncRow> triplets;
     triplets.reserve(cloudNodes.size() + syncParent.children.size() + fsNodes.size());
 
-    for (auto& cn : cloudNodes)          triplets.emplace_back(&cn, nullptr, nullptr);
-    for (auto& sn : syncParent.children) triplets.emplace_back(nullptr, sn.second, nullptr);
-    for (auto& fsn : fsNodes)            triplets.emplace_back(nullptr, nullptr, &fsn);
+    // Canonical name hashes are computed once per row here (or reused from the
+    // LocalNode's cache), so the O(n log n) comparisons below are hash probes
+    // rather than repeated per-character case folding and escape decoding.
+    for (auto& cn : cloudNodes)
+    {
+        triplets.emplace_back(&cn, nullptr, nullptr);
+        triplets.back().mNameHash = canonicalNameHash(cn.name);
+    }
+    for (auto& sn : syncParent.children)
+    {
+        triplets.emplace_back(nullptr, sn.second, nullptr);
+        triplets.back().mNameHash = sn.second->mNameHash;
+    }
+    for (auto& fsn : fsNodes)
+    {
+        triplets.emplace_back(nullptr, nullptr, &fsn);
+        triplets.back().mNameHash = canonicalNameHash(fsn.toName_of_localname(*syncs.fsaccess));
+    }
 
     auto tripletCompare = [this](const SyncRow& lhs, const SyncRow& rhs) -> int {
         // Sanity.
@@ -6879,6 +7051,14 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
         assert(!lhs.syncNode || !lhs.syncNode->localname.empty());
         assert(!rhs.syncNode || !rhs.syncNode->localname.empty());
 
+        // Differing hashes mean the names cannot be equal, so hash order is
+        // sufficient; matching names always hash equally and fall through to
+        // the full comparison, which also resolves the rare collision.
+        if (lhs.mNameHash != rhs.mNameHash)
+        {
+            return lhs.mNameHash < rhs.mNameHash ? -1 : 1;
+        }
+
         // Although it would be great to efficiently compare cloud names in utf8 directly against filesystem names
         // in utf16, without any conversions or copied and manipulated strings, unfortunately we have
         // a few obstacles to that.  Mainly, that the utf8 encoding can differ - especially on Mac
@@ -7089,9 +7269,13 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
     if (!(row.syncNode->scanRequired() || row.syncNode->mightHaveMoves() || row.syncNode->syncRequired()))
     {
         //SYNC_verbose << syncname << "No scanning/moving/syncing needed at " << logTriplet(row, fullPath);
+        ++syncs.mSyncFlags->foldersPrunedThisPass;
         return true;
     }
 
+    ++syncs.mSyncFlags->foldersVisitedThisPass;
+    ++mFolderVisits;
+
     SYNC_verbose << syncname << (belowRemovedCloudNode ? "belowRemovedCloudNode " : "") << (belowRemovedFsNode ? "belowRemovedFsNode " : "")
         << "Entering folder with "
         << row.syncNode->scanAgain  << "-"
@@ -11828,6 +12012,7 @@ void Syncs::syncLoop()
         bool earlyExit = false;
         auto recurseStart = std::chrono::high_resolution_clock::now();
         CodeCounter::ScopeTimer rst(mClient.performanceStats.recursiveSyncTime);
+        MEGA_TRACE_SCOPE("recursiveSync");
 
         if (!lastLoopEarlyExit)
         {
@@ -11841,6 +12026,8 @@ void Syncs::syncLoop()
         }
 
         unsigned skippedForScanning = 0;
+        mSyncFlags->foldersVisitedThisPass = 0;
+        mSyncFlags->foldersPrunedThisPass = 0;
 
         for (auto& us : mSyncVec)
         {
@@ -11862,6 +12049,10 @@ void Syncs::syncLoop()
                         // Reset the error counter.
                         notifier->mErrorCount.store(0);
 
+                        // Changes may have gone unseen, so scan signatures
+                        // can't be trusted to prune any of this rescan.
+                        sync->localroot->clearScanSignatures();
+
                         // Rescan everything from the root down.
                         sync->localroot->setScanAgain(false, true, true, 5);
                     }
@@ -11900,16 +12091,32 @@ void Syncs::syncLoop()
                     }
                 }
 
+                if (!sync->localroot->scanRequired() &&
+                    !sync->localroot->mightHaveMoves() &&
+                    !sync->localroot->syncRequired())
                 {
-                    bool activeIncomplete = sync->mActiveScanRequestGeneral &&
-                        !sync->mActiveScanRequestGeneral->completed();
+                    // Quiet tree: nothing is marked dirty anywhere below the
+                    // root, so skip the pass for this sync entirely rather
+                    // than building root rows and taking the tree lock just
+                    // for recursiveSync() to return at its first check.
+                    if (sync->isBackupAndMirroring())
+                    {
+                        sync->setBackupMonitoring();
+                    }
+                }
+                else
+                {
+                    size_t incompleteScans = 0;
+                    for (auto& r : sync->mActiveScanRequests)
+                    {
+                        incompleteScans += r && !r->completed();
+                    }
 
-                    bool unscannedIncomplete = sync->mActiveScanRequestUnscanned &&
-                        !sync->mActiveScanRequestUnscanned->completed();
+                    bool generalSlotFree = incompleteScans + 1 < Sync::MAX_ACTIVE_SCAN_REQUESTS;
+                    bool unscannedSlotFree = incompleteScans < Sync::MAX_ACTIVE_SCAN_REQUESTS &&
+                        sync->threadSafeState->neverScannedFolderCount.load() > 0;
 
-                    if ((activeIncomplete && unscannedIncomplete) ||
-                        (activeIncomplete && sync->threadSafeState->neverScannedFolderCount.load() == 0) ||
-                        (unscannedIncomplete && !sync->mActiveScanRequestGeneral))
+                    if (!generalSlotFree && !unscannedSlotFree)
                     {
                         // Save CPU by not starting another recurse of the LocalNode tree
                         // if a scan is not finished yet.  Scans can take a fair while for large
@@ -11941,7 +12148,7 @@ void Syncs::syncLoop()
                             earlyExit = true;
                         }
 
-                        sync->cachenodes();
+                        sync->cachenodesIfDue();
                     }
 
                     if (!earlyExit)
@@ -11973,6 +12180,15 @@ void Syncs::syncLoop()
                 SyncTransferCounts stc = sync->threadSafeState->transferCounts();
                 counts.numUploads = stc.mUploads.mPending;
                 counts.numDownloads = stc.mDownloads.mPending;
+                counts.scannedFolders = sync->mScannedFolders;
+                counts.scannedItems = sync->mScannedItems;
+                counts.filterEvaluations = sync->mFilterEvaluations;
+                counts.moveChecks = sync->mMoveChecks;
+                counts.folderVisits = sync->mFolderVisits;
+                counts.queuedNotifications = sync->dirnotify ?
+                    uint32_t(sync->dirnotify->fsEventq.size()) : 0u;
+                counts.queuedDbChanges = uint32_t(sync->insertq.size() + sync->deleteq.size());
+                counts.lastDbFlushMs = sync->mLastDbFlushMs;
                 if (us->lastReportedDisplayStats != counts)
                 {
                     mClient.app->syncupdate_stats(us->mConfig.mBackupId, counts);
@@ -11999,6 +12215,8 @@ void Syncs::syncLoop()
                         std::chrono::high_resolution_clock::now() - recurseStart).count());
 
         LOG_verbose << "recursiveSync took ms: " << lastRecurseMs
+                    << " visited folders: " << mSyncFlags->foldersVisitedThisPass
+                    << " pruned subtrees: " << mSyncFlags->foldersPrunedThisPass
                     << (skippedForScanning ? " (" + std::to_string(skippedForScanning)+ " skipped due to ongoing scanning)" : "")
                     << (mSyncFlags->noProgressCount ? " no progress count: " + std::to_string(mSyncFlags->noProgressCount) : "");
 
@@ -12329,6 +12547,8 @@ void Syncs::setSyncsNeedFullSync(bool andFullScan, bool andReFingerprint, handle
                 us->mSync->localroot->setSyncAgain(false, true, true);
                 if (andFullScan)
                 {
+                    // an explicitly requested rescan must really go to disk
+                    us->mSync->localroot->clearScanSignatures();
                     us->mSync->localroot->setScanAgain(false, true, true, 0);
                     if (andReFingerprint)
                     {
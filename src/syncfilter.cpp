@@ -58,6 +58,15 @@ public:
     // True if this filter matches the string pair p.
     virtual bool match(const RemotePathPair& p) const = 0;
 
+    // The uppercased name this filter matches exactly, if it is a
+    // case-insensitive literal name filter; null otherwise.
+    //
+    // See FilterChain::compile().
+    virtual const string* indexableName() const
+    {
+        return nullptr;
+    }
+
     virtual string debugDescription() const = 0;
 
 protected:
@@ -87,6 +96,8 @@ public:
 
     bool match(const RemotePathPair& p) const override;
 
+    const string* indexableName() const override;
+
     string debugDescription() const override;
 }; /* NameFilter */
 
@@ -112,6 +123,16 @@ public:
     // True if this matcher matches the string s.
     virtual bool match(const string& s) const = 0;
 
+    // The uppercased literal this matcher compares against, if it is a
+    // case-insensitive literal; null otherwise.
+    //
+    // FilterChain uses this to fold runs of literal name filters into a
+    // single hash table.
+    virtual const string* caselessLiteral() const
+    {
+        return nullptr;
+    }
+
     virtual string debugDescription() const = 0;
 
 protected:
@@ -127,11 +148,42 @@ public:
     // True if the wildcard pattern matches the string s.
     bool match(const string& s) const override;
 
+    const string* caselessLiteral() const override;
+
     string debugDescription() const override;
 
 private:
+    // How match(...) evaluates the pattern.
+    //
+    // Most patterns in practice are literals or simple "*.ext" style
+    // wildcards; these are classified once at load time so that matching
+    // can avoid the general wildcard walk.
+    enum Strategy
+    {
+        // Pattern contains no metacharacters: exact comparison.
+        GS_LITERAL,
+        // Pattern is "text*": prefix comparison.
+        GS_PREFIX,
+        // Pattern is "*text": suffix comparison.
+        GS_SUFFIX,
+        // Pattern is "*text*": substring search.
+        GS_SUBSTRING,
+        // Anything else: general wildcard match.
+        GS_WILDCARD
+    }; /* Strategy */
+
+    // True if the pattern matches the (already case-folded) string s.
+    bool matches(const string& s) const;
+
     const string mPattern;
     const bool mCaseSensitive;
+
+    // Classification of mPattern, computed on construction.
+    Strategy mStrategy;
+
+    // mPattern stripped of its leading/trailing '*' when the strategy
+    // is prefix, suffix or substring.
+    string mText;
 }; /* GlobMatcher */
 
 class RegexMatcher
@@ -522,6 +574,45 @@ void FilterChain::clear()
     mFingerprint = FileFingerprint();
     mSizeFilter.reset();
     mStringFilters.clear();
+    mMatchSteps.clear();
+    mNameTables.clear();
+}
+
+void FilterChain::compile()
+{
+    mMatchSteps.clear();
+    mNameTables.clear();
+
+    // Filters are evaluated in reverse order of definition.
+    for (auto i = mStringFilters.rbegin(); i != mStringFilters.rend(); ++i)
+    {
+        const StringFilter* filter = i->get();
+
+        // Can this filter be folded into a name table?
+        if (const string* name = filter->indexableName())
+        {
+            // Start a new run if the previous step isn't one.
+            if (mMatchSteps.empty() || mMatchSteps.back().filter)
+            {
+                MatchStep step;
+
+                step.table = mNameTables.size();
+
+                mMatchSteps.emplace_back(step);
+                mNameTables.emplace_back();
+            }
+
+            // Earlier entries in a run take precedence.
+            mNameTables[mMatchSteps.back().table][*name].emplace_back(filter);
+            continue;
+        }
+
+        MatchStep step;
+
+        step.filter = filter;
+
+        mMatchSteps.emplace_back(step);
+    }
 }
 
 FilterLoadResult FilterChain::load(FileSystemAccess& fsAccess, const LocalPath& path)
@@ -621,6 +712,9 @@ FilterLoadResult FilterChain::load(FileAccess& fileAccess)
     mStringFilters = std::move(stringFilters);
     mSizeFilter = std::move(sizeFilter);
 
+    // Rebuild the compiled evaluation plan.
+    compile();
+
     LOG_info << "New exclusion rules from file are as follows";
     for (auto &e : mStringFilters)
     {
@@ -642,19 +736,53 @@ ExclusionState FilterChain::match(const RemotePathPair& p,
 {
     if (!mLoadSucceeded) return ES_UNKNOWN;
 
-    auto i = mStringFilters.rbegin();
-    auto j = mStringFilters.rend();
+    // Uppercased name, needed only if some name table will be consulted.
+    string name;
+
+    if (!mNameTables.empty())
+    {
+        name = toUpper(p.first);
+    }
 
-    for ( ; i != j; ++i)
+    for (auto& step : mMatchSteps)
     {
-        if (onlyInheritable && !(*i)->inheritable())
+        if (!step.filter)
         {
+            // Folded run of literal name filters: a single lookup stands
+            // in for testing each filter in the run.
+            auto& table = mNameTables[step.table];
+
+            auto entry = table.find(name);
+
+            if (entry == table.end())
+            {
+                continue;
+            }
+
+            for (const StringFilter* filter : entry->second)
+            {
+                if (onlyInheritable && !filter->inheritable())
+                {
+                    continue;
+                }
+
+                if (filter->applicable(type))
+                {
+                    return filter->inclusion() ? ES_INCLUDED : ES_EXCLUDED;
+                }
+            }
+
             continue;
         }
 
-        if ((*i)->applicable(type) && (*i)->match(p))
+        if (onlyInheritable && !step.filter->inheritable())
         {
-            return (*i)->inclusion() ? ES_INCLUDED : ES_EXCLUDED;
+            continue;
+        }
+
+        if (step.filter->applicable(type) && step.filter->match(p))
+        {
+            return step.filter->inclusion() ? ES_INCLUDED : ES_EXCLUDED;
         }
     }
 
@@ -784,6 +912,11 @@ bool NameFilter::match(const RemotePathPair& p) const
     return StringFilter::match(p.first);
 }
 
+const string* NameFilter::indexableName() const
+{
+    return mMatcher->caselessLiteral();
+}
+
 string NameFilter::debugDescription() const
 {
     string s = "name: " + mMatcher->debugDescription();
@@ -819,17 +952,84 @@ string PathFilter::debugDescription() const
 GlobMatcher::GlobMatcher(const string &pattern, const bool caseSensitive)
   : mPattern(caseSensitive ? pattern : toUpper(pattern))
   , mCaseSensitive(caseSensitive)
+  , mStrategy(GS_WILDCARD)
+  , mText()
 {
+    // Classify the pattern so that match(...) can take a fast path.
+    //
+    // A '?' anywhere, or a '*' in the pattern's interior, requires the
+    // general wildcard walk.
+    if (mPattern.find('?') != string::npos)
+        return;
+
+    const size_t first = mPattern.find('*');
+    const size_t last = mPattern.rfind('*');
+
+    if (first == string::npos)
+    {
+        mStrategy = GS_LITERAL;
+    }
+    else if (first == last)
+    {
+        if (first == 0)
+        {
+            mStrategy = GS_SUFFIX;
+            mText = mPattern.substr(1);
+        }
+        else if (first == mPattern.size() - 1)
+        {
+            mStrategy = GS_PREFIX;
+            mText = mPattern.substr(0, first);
+        }
+    }
+    else if (first == 0
+             && last == mPattern.size() - 1
+             && mPattern.find('*', 1) == last)
+    {
+        mStrategy = GS_SUBSTRING;
+        mText = mPattern.substr(1, mPattern.size() - 2);
+    }
 }
 
 bool GlobMatcher::match(const string& s) const
 {
     if (mCaseSensitive)
     {
-        return wildcardMatch(s, mPattern);
+        return matches(s);
+    }
+
+    return matches(toUpper(s));
+}
+
+bool GlobMatcher::matches(const string& s) const
+{
+    switch (mStrategy)
+    {
+    case GS_LITERAL:
+        return s == mPattern;
+    case GS_PREFIX:
+        return s.size() >= mText.size()
+               && !s.compare(0, mText.size(), mText);
+    case GS_SUFFIX:
+        return s.size() >= mText.size()
+               && !s.compare(s.size() - mText.size(), mText.size(), mText);
+    case GS_SUBSTRING:
+        return s.find(mText) != string::npos;
+    case GS_WILDCARD:
+        break;
+    }
+
+    return wildcardMatch(s, mPattern);
+}
+
+const string* GlobMatcher::caselessLiteral() const
+{
+    if (mStrategy == GS_LITERAL && !mCaseSensitive)
+    {
+        return &mPattern;
     }
 
-    return wildcardMatch(toUpper(s), mPattern);
+    return nullptr;
 }
 
 string GlobMatcher::debugDescription() const
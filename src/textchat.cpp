@@ -523,7 +523,7 @@ bool TextChat::serialize(string *d) const
     d->append((char*)&ou, sizeof ou);
     d->append((char*)&ts, sizeof(ts));
 
-    char hasAttachments = attachedNodes.size() != 0;
+    char hasAttachments = attachedNodes.size() != 0 || mDeferredAttachments.size() != 0;
     d->append((char*)&hasAttachments, 1);
 
     d->append((char*)&flags, 1);
@@ -539,12 +539,17 @@ bool TextChat::serialize(string *d) const
 
     d->append((char*)&chatOptions, 1);
 
-    char hasSheduledMeetings = !mScheduledMeetings.empty() ? 1 : 0;
+    char hasSheduledMeetings = (!mScheduledMeetings.empty() || !mDeferredSchedMeetings.empty()) ? 1 : 0;
     d->append((char*)&hasSheduledMeetings, 1);
 
     d->append("\0\0\0", 3); // additional bytes for backwards compatibility
 
-    if (hasAttachments)
+    if (mDeferredAttachments.size())
+    {
+        // never hydrated since unserialize() captured it: already in wire format
+        d->append(mDeferredAttachments);
+    }
+    else if (hasAttachments)
     {
         ll = (unsigned short)attachedNodes.size();  // number of nodes with granted access
         d->append((char*)&ll, sizeof ll);
@@ -569,7 +574,12 @@ bool TextChat::serialize(string *d) const
         d->append((char*) unifiedKey.data(), unifiedKey.size());
     }
 
-    if (hasSheduledMeetings)
+    if (mDeferredSchedMeetings.size())
+    {
+        // never hydrated since unserialize() captured it: already in wire format
+        d->append(mDeferredSchedMeetings);
+    }
+    else if (hasSheduledMeetings)
     {
         // serialize the number of scheduledMeetings
         ll = static_cast<unsigned short>(mScheduledMeetings.size());
@@ -614,10 +624,10 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
     m_time_t ts;
     byte flags;
     char hasAttachments;
-    attachments_map attachedNodes;
+    string deferredAttachments;
     bool publicchat;
     string unifiedKey;
-    std::vector<string> scheduledMeetingsStr;
+    string deferredSchedMeetings;
 
     unsigned short ll;
     const char* ptr = d->data();
@@ -728,6 +738,10 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
 
     if (hasAttachments)
     {
+        // bounds-check the block, but defer building the attachments map until
+        // the chat is actually used (see hydrateDeferred())
+        const char* attachmentsBegin = ptr;
+
         unsigned short numNodes = 0;
         if (ptr + sizeof numNodes > end)
         {
@@ -739,33 +753,24 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
 
         for (int i = 0; i < numNodes; i++)
         {
-            handle h = UNDEF;
             unsigned short numUsers = 0;
-            if (ptr + sizeof h + sizeof numUsers > end)
+            if (ptr + sizeof(handle) + sizeof numUsers > end)
             {
                 return NULL;
             }
-
-            h = MemAccess::get<handle>(ptr);
-            ptr += sizeof h;
+            ptr += sizeof(handle);  // nodehandle
 
             numUsers = MemAccess::get<unsigned short>(ptr);
             ptr += sizeof numUsers;
 
-            handle uh = UNDEF;
-            if (ptr + (numUsers * sizeof(uh)) > end)
+            if (ptr + (numUsers * sizeof(handle)) > end)
             {
                 return NULL;
             }
-
-            for (int j = 0; j < numUsers; j++)
-            {
-                uh = MemAccess::get<handle>(ptr);
-                ptr += sizeof uh;
-
-                attachedNodes[h].insert(uh);
-            }
+            ptr += numUsers * sizeof(handle);   // userhandles
         }
+
+        deferredAttachments.assign(attachmentsBegin, static_cast<size_t>(ptr - attachmentsBegin));
     }
 
     if (hasUnifiedKey)
@@ -790,7 +795,10 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
 
     if (hasScheduledMeeting)
     {
-        // unserialize the number of scheduled meetings
+        // bounds-check the records, but defer ScheduledMeeting parsing - it is by
+        // far the most expensive part of loading a cached chat
+        const char* schedMeetingsBegin = ptr;
+
         unsigned short schedMeetingsSize = 0;
         if (ptr + sizeof schedMeetingsSize > end)
         {
@@ -815,11 +823,10 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
             {
                 return NULL;
             }
-
-            std::string aux(ptr, len);
-            scheduledMeetingsStr.emplace_back(aux);
             ptr += len;
         }
+
+        deferredSchedMeetings.assign(schedMeetingsBegin, static_cast<size_t>(ptr - schedMeetingsBegin));
     }
 
     if (ptr < end)
@@ -827,19 +834,6 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
         return NULL;
     }
 
-    vector<unique_ptr<ScheduledMeeting>> schedMeetings;
-    for (const auto& i : scheduledMeetingsStr)
-    {
-        ScheduledMeeting* auxMeet = ScheduledMeeting::unserialize(i, id);
-        if (!auxMeet)
-        {
-            LOG_err << "Failure at schedule meeting unserialization";
-            assert(auxMeet);
-            return NULL;
-        }
-        schedMeetings.push_back(std::unique_ptr<ScheduledMeeting>(auxMeet));
-    }
-
     TextChat*& chat = client->chats[id]; // use reference to pointer to avoid 3 searches instead of one
     if (!chat)
     {
@@ -860,17 +854,80 @@ TextChat* TextChat::unserialize(class MegaClient *client, string *d)
     chat->resetTag();
     chat->ts = ts;
     chat->flags = flags;
-    chat->attachedNodes = attachedNodes;
+    chat->attachedNodes.clear();
     chat->unifiedKey = unifiedKey;
     chat->meeting = meetingRoom;
     chat->chatOptions = chatOptions;
 
-    for (auto& sm : schedMeetings)
+    // attachments and scheduled meetings are hydrated on first access
+    chat->mDeferredAttachments = std::move(deferredAttachments);
+    chat->mDeferredSchedMeetings = std::move(deferredSchedMeetings);
+
+    return chat;
+}
+
+// parse the attachment map and scheduled meetings captured by unserialize().
+// Both blocks were bounds-checked there, so the walks below cannot overrun.
+void TextChat::hydrateDeferred()
+{
+    if (mDeferredAttachments.empty() && mDeferredSchedMeetings.empty())
     {
-        chat->addSchedMeeting(std::move(sm), false /*notify*/);
+        return;
     }
 
-    return chat;
+    // detach the blobs first: addSchedMeeting() below re-enters this function
+    string attachments, schedMeetings;
+    attachments.swap(mDeferredAttachments);
+    schedMeetings.swap(mDeferredSchedMeetings);
+
+    if (attachments.size())
+    {
+        const char* ptr = attachments.data();
+
+        unsigned short numNodes = MemAccess::get<unsigned short>(ptr);
+        ptr += sizeof numNodes;
+
+        for (int i = 0; i < numNodes; i++)
+        {
+            handle h = MemAccess::get<handle>(ptr);
+            ptr += sizeof h;
+
+            unsigned short numUsers = MemAccess::get<unsigned short>(ptr);
+            ptr += sizeof numUsers;
+
+            for (int j = 0; j < numUsers; j++)
+            {
+                attachedNodes[h].insert(MemAccess::get<handle>(ptr));
+                ptr += sizeof(handle);
+            }
+        }
+    }
+
+    if (schedMeetings.size())
+    {
+        const char* ptr = schedMeetings.data();
+
+        unsigned short schedMeetingsSize = MemAccess::get<unsigned short>(ptr);
+        ptr += sizeof schedMeetingsSize;
+
+        for (auto i = 0; i < schedMeetingsSize; ++i)
+        {
+            unsigned short len = MemAccess::get<unsigned short>(ptr);
+            ptr += sizeof len;
+
+            ScheduledMeeting* sm = ScheduledMeeting::unserialize(std::string(ptr, len), id);
+            ptr += len;
+
+            if (!sm)
+            {
+                LOG_err << "Failure at schedule meeting unserialization";
+                assert(sm);
+                continue;
+            }
+
+            addSchedMeeting(std::unique_ptr<ScheduledMeeting>(sm), false /*notify*/);
+        }
+    }
 }
 
 void TextChat::setChatId(handle newId)
@@ -1011,11 +1068,13 @@ m_time_t TextChat::getTs() const
 
 const attachments_map& TextChat::getAttachments() const
 {
+    const_cast<TextChat*>(this)->hydrateDeferred();
     return attachedNodes;
 }
 
 handle_set TextChat::getUsersOfAttachment(handle a) const
 {
+    const_cast<TextChat*>(this)->hydrateDeferred();
     auto ita = attachedNodes.find(a);
     if (ita != attachedNodes.end())
     {
@@ -1027,6 +1086,7 @@ handle_set TextChat::getUsersOfAttachment(handle a) const
 
 bool TextChat::isUserOfAttachment(handle a, handle uid) const
 {
+    const_cast<TextChat*>(this)->hydrateDeferred();
     auto ita = attachedNodes.find(a);
     if (ita != attachedNodes.end())
     {
@@ -1038,6 +1098,7 @@ bool TextChat::isUserOfAttachment(handle a, handle uid) const
 
 void TextChat::addUserForAttachment(handle a, handle uid)
 {
+    hydrateDeferred();
     attachedNodes[a].insert(uid);
 }
 
@@ -1058,6 +1119,7 @@ byte TextChat::getChatOptions() const
 
 bool TextChat::hasScheduledMeeting(handle smid) const
 {
+    const_cast<TextChat*>(this)->hydrateDeferred();
     return mScheduledMeetings.find(smid) != mScheduledMeetings.end();
 }
 
@@ -1096,6 +1158,8 @@ void TextChat::resetTag()
 
 bool TextChat::setNodeUserAccess(handle h, handle uh, bool revoke)
 {
+    hydrateDeferred();
+
     if (revoke)
     {
         attachments_map::iterator uhit = attachedNodes.find(h);
@@ -1151,6 +1215,7 @@ void TextChat::addUpdatedSchedMeetingOccurrence(std::unique_ptr<ScheduledMeeting
 
 const ScheduledMeeting* TextChat::getSchedMeetingById(handle id) const
 {
+    const_cast<TextChat*>(this)->hydrateDeferred();
     auto it = mScheduledMeetings.find(id);
     if (it != mScheduledMeetings.end())
     {
@@ -1161,11 +1226,14 @@ const ScheduledMeeting* TextChat::getSchedMeetingById(handle id) const
 
 const map<handle/*schedId*/, std::unique_ptr<ScheduledMeeting>>& TextChat::getSchedMeetings() const
 {
+    const_cast<TextChat*>(this)->hydrateDeferred();
     return mScheduledMeetings;
 }
 
 bool TextChat::addSchedMeeting(std::unique_ptr<ScheduledMeeting> sm, bool notify)
 {
+    hydrateDeferred();
+
     if (!sm)
     {
         assert(false);
@@ -1197,6 +1265,8 @@ bool TextChat::addSchedMeeting(std::unique_ptr<ScheduledMeeting> sm, bool notify
 
 bool TextChat::removeSchedMeeting(handle schedId)
 {
+    hydrateDeferred();
+
     assert(schedId != UNDEF);
     if (mScheduledMeetings.find(schedId) == mScheduledMeetings.end())
     {
@@ -1209,11 +1279,14 @@ bool TextChat::removeSchedMeeting(handle schedId)
 
 void TextChat::removeSchedMeetingsList(const handle_set& schedList)
 {
+    hydrateDeferred();
     for_each(begin(schedList), end(schedList), [this](handle sm) { deleteSchedMeeting(sm); });
 }
 
 handle_set TextChat::removeChildSchedMeetings(handle parentSchedId)
 {
+    hydrateDeferred();
+
     // remove all scheduled meeting whose parent is parentSchedId
     handle_set deletedChildren;
     for (auto it = mScheduledMeetings.begin(); it != mScheduledMeetings.end(); it++)
@@ -1231,6 +1304,8 @@ handle_set TextChat::removeChildSchedMeetings(handle parentSchedId)
 
 bool TextChat::updateSchedMeeting(std::unique_ptr<ScheduledMeeting> sm)
 {
+    hydrateDeferred();
+
     assert(sm);
     auto it = mScheduledMeetings.find(sm->schedId());
     if (it == mScheduledMeetings.end())
@@ -1251,6 +1326,8 @@ bool TextChat::updateSchedMeeting(std::unique_ptr<ScheduledMeeting> sm)
 
 bool TextChat::addOrUpdateSchedMeeting(std::unique_ptr<ScheduledMeeting> sm, bool notify)
 {
+    hydrateDeferred();
+
     if (!sm)
     {
         LOG_err << "addOrUpdateSchedMeeting: invalid scheduled meeting provided";
@@ -0,0 +1,131 @@
+/**
+ * @file mega/tracing.cpp
+ * @brief opt-in chrome://tracing event emission for performance diagnosis
+ *
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega/tracing.h"
+
+#ifdef MEGASDK_TRACE_EVENTS_ENABLED
+
+#include <thread>
+
+namespace mega {
+
+TraceRecorder& TraceRecorder::get()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+bool TraceRecorder::start(const char* path)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    if (mFile)
+    {
+        return false;
+    }
+
+    mFile = fopen(path, "w");
+    if (!mFile)
+    {
+        return false;
+    }
+
+    fputs("[", mFile);
+    mFirstEvent = true;
+    mEvents.reserve(FLUSH_THRESHOLD);
+    mRecording.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    if (!mFile)
+    {
+        return;
+    }
+
+    mRecording.store(false, std::memory_order_release);
+    flush();
+    fputs("]\n", mFile);
+    fclose(mFile);
+    mFile = nullptr;
+}
+
+void TraceRecorder::record(const char* name, char ph, std::chrono::steady_clock::time_point ts,
+                           std::chrono::microseconds dur, uint64_t id)
+{
+    Event ev;
+    ev.name = name;
+    ev.ph = ph;
+    ev.ts = std::chrono::duration_cast<std::chrono::microseconds>(ts.time_since_epoch()).count();
+    ev.dur = dur.count();
+    ev.tid = static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    ev.id = id;
+
+    std::lock_guard<std::mutex> g(mMutex);
+
+    if (!mRecording.load(std::memory_order_relaxed))
+    {
+        // lost the race with stop()
+        return;
+    }
+
+    mEvents.push_back(ev);
+    if (mEvents.size() >= FLUSH_THRESHOLD)
+    {
+        flush();
+    }
+}
+
+void TraceRecorder::flush()
+{
+    for (const Event& ev : mEvents)
+    {
+        fprintf(mFile, "%s\n{\"name\":\"%s\",\"cat\":\"mega\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":%llu",
+                mFirstEvent ? "" : ",",
+                ev.name, ev.ph,
+                (long long)ev.ts,
+                (unsigned long long)ev.tid);
+
+        if (ev.ph == 'X')
+        {
+            fprintf(mFile, ",\"dur\":%lld", (long long)ev.dur);
+        }
+        if (ev.ph == 'b' || ev.ph == 'e')
+        {
+            fprintf(mFile, ",\"id\":%llu", (unsigned long long)ev.id);
+        }
+        if (ev.ph == 'i')
+        {
+            fputs(",\"s\":\"t\"", mFile);
+        }
+        fputs("}", mFile);
+        mFirstEvent = false;
+    }
+    mEvents.clear();
+    fflush(mFile);
+}
+
+} // namespace
+
+#endif
@@ -160,15 +160,64 @@ Transfer::~Transfer()
 
     if (finished)
     {
+        bool preserved = false;
         if (type == GET && !localfilename.empty())
         {
             if (!keepDownloadTarget)
-                client->fsaccess->unlinklocal(localfilename);
+            {
+                preserved = preserveDownloadProgress(committer);
+                if (!preserved)
+                {
+                    client->fsaccess->unlinklocal(localfilename);
+                }
+            }
+        }
+        if (!preserved)
+        {
+            client->transfercachedel(this, committer);
         }
-        client->transfercachedel(this, committer);
     }
 }
 
+bool Transfer::preserveDownloadProgress(TransferDbCommitter* committer)
+{
+    if (type != GET
+            || state == TRANSFERSTATE_COMPLETED
+            || !progresscompleted
+            || !chunkmacs.size()     // cleared on MAC failure: nothing verified to keep
+            || downloadFileHandle.isUndef()
+            || skipserialization
+            || !client->tctable)
+    {
+        return false;
+    }
+
+    // round-trip through the serialized form, exactly as if the client had
+    // restarted with this download half done: startxfer() finds the copy in
+    // the cached-transfer pool by node handle and resumes from its chunk MACs.
+    // If it is never claimed, purgeOrphanTransfers() reaps it after two days
+    lastaccesstime = m_time();
+    string d;
+    if (!serialize(&d))
+    {
+        return false;
+    }
+
+    Transfer* t = unserialize(client, &d, client->multi_cachedtransfers);
+    if (!t)
+    {
+        return false;
+    }
+
+    t->dbid = dbid;    // the copy takes over the existing db record
+    t->lastaccesstime = lastaccesstime;
+    client->transfercacheadd(t, committer);
+
+    LOG_debug << "Preserving " << progresscompleted << " of " << size
+              << " downloaded bytes for a later retry of node " << downloadFileHandle;
+    return true;
+}
+
 bool Transfer::serialize(string *d) const
 {
     assert(localfilename.empty() || localfilename.isAbsolute());
@@ -404,6 +453,9 @@ void Transfer::failed(const Error& e, TransferDbCommitter& committer, dstime tim
         if (!slot)
         {
             bt.backoff(timeleft ? timeleft : NEVER);
+            client->retryTelemetry.record(type == PUT ? RetryTelemetry::ENDPOINT_TRANSFER_PUT
+                                                      : RetryTelemetry::ENDPOINT_TRANSFER_GET,
+                                          RETRY_RATE_LIMIT, timeleft ? timeleft : NEVER);
             client->activateoverquota(timeleft, (e == API_EPAYWALL));
             client->app->transfer_failed(this, e, timeleft);
             ++client->performanceStats.transferTempErrors;
@@ -441,6 +493,28 @@ void Transfer::failed(const Error& e, TransferDbCommitter& committer, dstime tim
     else if (e != API_EBUSINESSPASTDUE)
     {
         bt.backoff();
+
+        retryreason_t reason = RETRY_UNKNOWN;
+        if (e == API_EAGAIN)
+        {
+            reason = RETRY_SERVERS_BUSY;
+        }
+        else if (e == API_ERATELIMIT || e == API_ETOOMANY)
+        {
+            reason = RETRY_RATE_LIMIT;
+        }
+        else if (e == API_EREAD || e == API_EWRITE)
+        {
+            reason = RETRY_LOCAL_LOCK;
+        }
+        else if (e == API_EFAILED || e == API_EINCOMPLETE)
+        {
+            reason = RETRY_CONNECTIVITY;
+        }
+        client->retryTelemetry.record(type == PUT ? RetryTelemetry::ENDPOINT_TRANSFER_PUT
+                                                  : RetryTelemetry::ENDPOINT_TRANSFER_GET,
+                                      reason, bt.retryin());
+
         state = TRANSFERSTATE_RETRYING;
         client->app->transfer_failed(this, e, timeleft);
         ++client->performanceStats.transferTempErrors;
@@ -608,6 +682,21 @@ bool Transfer::isForSupport() const
     return type == PUT && !files.empty() && files.back()->targetuser == MegaClient::SUPPORT_USER_HANDLE;
 }
 
+trafficclass_t Transfer::trafficclass() const
+{
+    trafficclass_t tc = TRAFFIC_BACKUP;
+
+    for (File* f : files)
+    {
+        if (f->trafficclass() < tc)
+        {
+            tc = f->trafficclass();
+        }
+    }
+
+    return files.empty() ? TRAFFIC_MANUAL : tc;
+}
+
 FileDistributor::TargetNameExistsResolution Transfer::toTargetNameExistsResolution(CollisionResolution resolution)
 {
     switch (resolution) {
@@ -1109,6 +1198,7 @@ DirectReadNode::DirectReadNode(MegaClient* cclient, handle ch, bool cp, SymmCiph
 
     retries = 0;
     size = 0;
+    nextseqpos = -1;
 
     pendingcmd = NULL;
 
@@ -1269,7 +1359,7 @@ void DirectReadNode::cmdresult(const Error &e, dstime timeleft)
                 // DirectRead starting
                 m_off_t streamingMaxReqSize = dr->drMaxReqSize();
                 LOG_debug << "Direct read node size = " << dr->drn->size << ", streaming max request size: " << streamingMaxReqSize;
-                dr->drbuf.setIsRaid(dr->drn->tempurls, dr->offset, dr->offset + dr->count, dr->drn->size, streamingMaxReqSize);
+                dr->drbuf.setIsRaid(dr->drn->tempurls, dr->offset, dr->offset + dr->count + dr->readahead, dr->drn->size, streamingMaxReqSize);
             }
             else
             {
@@ -1306,9 +1396,135 @@ void DirectReadNode::schedule(dstime deltads)
     }
 }
 
+const size_t DirectReadSegmentCache::MAX_BYTES = 16 * 1024 * 1024;
+const size_t DirectReadSegmentCache::MAX_SEGMENT_BYTES = 4 * 1024 * 1024;
+
+// readahead sizing for sequential read patterns
+const m_off_t DirectReadNode::MIN_READAHEAD = 256 * 1024;
+const m_off_t DirectReadNode::MAX_READAHEAD = 2 * 1024 * 1024;
+
+void DirectReadSegmentCache::store(m_off_t pos, const byte* data, size_t len)
+{
+    // trim off any prefix that is already cached
+    size_t already;
+    if (lookup(pos, already))
+    {
+        if (already >= len)
+        {
+            return;
+        }
+        pos += already;
+        data += already;
+        len -= already;
+    }
+
+    // and don't run into the following segment either
+    map<m_off_t, Segment>::iterator next = mSegments.lower_bound(pos);
+    if (next != mSegments.end() && next->first < pos + m_off_t(len))
+    {
+        len = size_t(next->first - pos);
+        if (!len)
+        {
+            return;
+        }
+    }
+
+    map<m_off_t, Segment>::iterator prev = mSegments.lower_bound(pos);
+    if (prev != mSegments.begin()
+            && (--prev)->first + m_off_t(prev->second.data.size()) == pos
+            && prev->second.data.size() + len <= MAX_SEGMENT_BYTES)
+    {
+        // sequential delivery: extend the segment we appended to last time
+        prev->second.data.append((const char*)data, len);
+        prev->second.lastUse = ++mUseCounter;
+    }
+    else
+    {
+        Segment& s = mSegments[pos];
+        s.data.assign((const char*)data, len);
+        s.lastUse = ++mUseCounter;
+    }
+    mTotalBytes += len;
+
+    while (mTotalBytes > MAX_BYTES && mSegments.size() > 1)
+    {
+        map<m_off_t, Segment>::iterator oldest = mSegments.begin();
+        for (map<m_off_t, Segment>::iterator it = mSegments.begin(); it != mSegments.end(); it++)
+        {
+            if (it->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = it;
+            }
+        }
+        mTotalBytes -= oldest->second.data.size();
+        mSegments.erase(oldest);
+    }
+}
+
+const byte* DirectReadSegmentCache::lookup(m_off_t pos, size_t& len)
+{
+    len = 0;
+    map<m_off_t, Segment>::iterator it = mSegments.upper_bound(pos);
+    if (it == mSegments.begin())
+    {
+        return NULL;
+    }
+    --it;
+
+    m_off_t end = it->first + m_off_t(it->second.data.size());
+    if (pos >= end)
+    {
+        return NULL;
+    }
+
+    it->second.lastUse = ++mUseCounter;
+    len = size_t(end - pos);
+    return (const byte*)it->second.data.data() + (pos - it->first);
+}
+
 void DirectReadNode::enqueue(m_off_t offset, m_off_t count, int reqtag, void* appdata)
 {
-    new DirectRead(this, count, offset, reqtag, appdata);
+    // bounded reads first consult the segment cache for a prefix: a seek back
+    // into a recently played range often needs no DirectRead at all
+    // (count == 0 is an open-ended read to the end of the file)
+    bool bounded = count > 0;
+    size_t cachedlen;
+    const byte* cached;
+    while (count > 0 && (cached = segmentcache.lookup(offset, cachedlen)))
+    {
+        size_t n = cachedlen < size_t(count) ? cachedlen : size_t(count);
+        LOG_verbose << "DirectReadNode: serving " << n << " bytes at " << offset << " from the segment cache";
+        if (!client->app->pread_data(const_cast<byte*>(cached), m_off_t(n), offset, 0, 0, appdata))
+        {
+            // the app cancelled the read, or it is now complete
+            return;
+        }
+        offset += n;
+        count -= n;
+    }
+
+    if (bounded && !count)
+    {
+        // fully served from the cache; a follow-on read from here is still sequential
+        nextseqpos = offset;
+        return;
+    }
+
+    // players probe with many small sequential ranges (mp4 headers especially).
+    // Extend such reads predictively: the extra bytes only feed the segment
+    // cache, where the next probe finds them without another round trip
+    m_off_t readahead = 0;
+    if (bounded)
+    {
+        if (offset == nextseqpos && size && offset + count < size)
+        {
+            readahead = std::min<m_off_t>(std::max<m_off_t>(count * 2, MIN_READAHEAD), MAX_READAHEAD);
+            readahead = std::min<m_off_t>(readahead, size - (offset + count));
+        }
+        nextseqpos = offset + count;
+    }
+
+    new DirectRead(this, count, offset, reqtag, appdata, readahead);
 }
 
 bool DirectReadSlot::processAnyOutputPieces()
@@ -1318,20 +1534,38 @@ bool DirectReadSlot::processAnyOutputPieces()
     std::shared_ptr<TransferBufferManager::FilePiece> outputPiece;
     while (continueDirectRead && (outputPiece = mDr->drbuf.getAsyncOutputBufferPointer(0)))
     {
-        size_t len = outputPiece->buf.datalen();
-        mSpeed = mSpeedController.calculateSpeed(len);
-        mMeanSpeed = mSpeedController.getMeanSpeed();
-        mDr->drn->client->httpio->updatedownloadspeed(len);
+        continueDirectRead = deliverBytes(outputPiece->buf.datastart(), outputPiece->buf.datalen());
+        mDr->drbuf.bufferWriteCompleted(0, true);
+    }
+    return continueDirectRead;
+}
+
+bool DirectReadSlot::deliverBytes(byte* buf, size_t len)
+{
+    mSpeed = mSpeedController.calculateSpeed(len);
+    mMeanSpeed = mSpeedController.getMeanSpeed();
+    mDr->drn->client->httpio->updatedownloadspeed(len);
 
+    // everything fetched feeds the segment cache, including readahead past the
+    // requested range, which is fetched for the cache alone
+    mDr->drn->segmentcache.store(mPos, buf, len);
+
+    // count == 0 is an open-ended read: the app range runs to the end of the file
+    m_off_t appEnd = mDr->count ? mDr->offset + mDr->count : mDr->drn->size;
+    size_t appbytes = mPos < appEnd ? static_cast<size_t>(std::min<m_off_t>(m_off_t(len), appEnd - mPos)) : 0;
+
+    bool continueDirectRead = true;
+    if (appbytes)
+    {
         if (mDr->appdata)
         {
             mSlotThroughput.first += static_cast<m_off_t>(len);
-            auto lastDataTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mSlotStartTime).count();
+            auto lastDataTime = std::chrono::duration_cast<std::chrono::milliseconds>(Waiter::tickTime - mSlotStartTime).count();
             mSlotThroughput.second = static_cast<m_off_t>(lastDataTime);
             LOG_verbose << "DirectReadSlot -> Delivering assembled part ->"
-                        << "len = " << len << ", speed = " << mSpeed << ", meanSpeed = " << (mMeanSpeed / 1024) << " KB/s"
+                        << "len = " << appbytes << ", speed = " << mSpeed << ", meanSpeed = " << (mMeanSpeed / 1024) << " KB/s"
                         << ", slotThroughput = " << ((calcThroughput(mSlotThroughput.first, mSlotThroughput.second) * 1000) / 1024) << " KB/s]" << " [this = " << this << "]";
-            continueDirectRead = mDr->drn->client->app->pread_data(outputPiece->buf.datastart(), len, mPos, mSpeed, mMeanSpeed, mDr->appdata);
+            continueDirectRead = mDr->drn->client->app->pread_data(buf, appbytes, mPos, mSpeed, mMeanSpeed, mDr->appdata);
         }
         else
         {
@@ -1339,16 +1573,22 @@ bool DirectReadSlot::processAnyOutputPieces()
             mDr->drn->client->sendevent(99472, "DirectRead detected with a null transfer");
             continueDirectRead = false;
         }
-        mDr->drbuf.bufferWriteCompleted(0, true);
 
-        if (continueDirectRead)
+        if (!continueDirectRead && mDr->readahead > 0 && mPos + m_off_t(appbytes) >= appEnd)
         {
-            mPos += len;
-            mDr->drn->partiallen += len;
-            mDr->progress += len;
-            mMinComparableThroughput = static_cast<m_off_t>(len);
+            // the app has everything it asked for: carry on with the remaining
+            // readahead, which only feeds the segment cache
+            continueDirectRead = true;
         }
     }
+
+    if (continueDirectRead)
+    {
+        mPos += len;
+        mDr->drn->partiallen += len;
+        mDr->progress += len;
+        mMinComparableThroughput = static_cast<m_off_t>(len);
+    }
     return continueDirectRead;
 }
 
@@ -1599,7 +1839,7 @@ bool DirectReadSlot::doio()
             if (req->in.size())
             {
                 unsigned n = static_cast<unsigned>(req->in.size());
-                auto lastDataTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - req->postStartTime).count();
+                auto lastDataTime = std::chrono::duration_cast<std::chrono::milliseconds>(Waiter::tickTime - req->postStartTime).count();
                 m_off_t chunkTime = static_cast<m_off_t>(lastDataTime) - mThroughput[connectionNum].second;
 
                 unsigned minChunkSize;
@@ -1662,16 +1902,39 @@ bool DirectReadSlot::doio()
                                 << ", aggregated throughput = " << (aggregatedThroughput / 1024) << " KB/s"
                                 << ", maxChunkSize = " << (maxChunkSize / 1024) << " KBs]"
                                 << ", [req->pos_pre = " << (req->pos) << ", req->pos_now = " << (req->pos + n) << "]" << " [this = " << this << "]";
-                    RaidBufferManager::FilePiece* np = new RaidBufferManager::FilePiece(req->pos, n);
-                    memcpy(np->buf.datastart(), req->in.c_str(), n);
+                    if (isRaid)
+                    {
+                        // raid parts need their own buffer regardless: reassembly interleaves sectors from all of them
+                        RaidBufferManager::FilePiece* np = new RaidBufferManager::FilePiece(req->pos, n);
+                        memcpy(np->buf.datastart(), req->in.c_str(), n);
 
-                    req->in.erase(0, n);
-                    req->contentlength -= n;
-                    req->bufpos = 0;
-                    req->pos += n;
+                        req->in.erase(0, n);
+                        req->contentlength -= n;
+                        req->bufpos = 0;
+                        req->pos += n;
 
-                    unsigned submittingConnection = isRaid ? connectionNum : 0;
-                    mDr->drbuf.submitBuffer(submittingConnection, np);
+                        mDr->drbuf.submitBuffer(static_cast<unsigned>(connectionNum), np);
+                    }
+                    else
+                    {
+                        // zero-copy streaming: decrypt in the network buffer itself and deliver it to the
+                        // app by reference, consuming the bytes only once the app has taken them
+                        byte* chunk = reinterpret_cast<byte*>(&req->in[0]);
+                        mDr->drbuf.decryptInPlace(chunk, n, req->pos);
+                        bool continueDirectRead = deliverBytes(chunk, n);
+
+                        req->in.erase(0, n);
+                        req->contentlength -= n;
+                        req->bufpos = 0;
+                        req->pos += n;
+
+                        if (!continueDirectRead)
+                        {
+                            LOG_debug << "DirectReadSlot [conn " << connectionNum << "] Transfer is finished after in-place delivery. Removing DirectRead" << " [this = " << this << "]";
+                            delete mDr;
+                            return true;
+                        }
+                    }
 
                     if (n > mMaxChunkSubmitted)
                     {
@@ -1758,8 +2021,10 @@ bool DirectReadSlot::doio()
                     }
                     else
                     {
-                        if (!mDr->appdata)
+                        if (!mDr->appdata && mPos < (mDr->count ? mDr->offset + mDr->count : mDr->drn->size))
                         {
+                            // a null transfer is only legitimate once all the app's bytes
+                            // are delivered and just cache readahead remains to fetch
                             LOG_err << "DirectReadSlot [conn " << connectionNum << "] There is a chunk request, but transfer is already deleted. This should never happen. Aborting" << " [this = " << this << "]";
                             mDr->drn->client->sendevent(99472, "DirectRead detected with a null transfer");
                             delete mDr;
@@ -1864,7 +2129,7 @@ m_off_t DirectRead::drMaxReqSize() const
     return std::max(drn->size / numParts, TransferSlot::MAX_REQ_SIZE);
 }
 
-DirectRead::DirectRead(DirectReadNode* cdrn, m_off_t ccount, m_off_t coffset, int creqtag, void* cappdata)
+DirectRead::DirectRead(DirectReadNode* cdrn, m_off_t ccount, m_off_t coffset, int creqtag, void* cappdata, m_off_t creadahead)
     : drbuf(this)
 {
     LOG_debug << "[DirectRead::DirectRead] New DirectRead [cappdata = " << cappdata << "]" << " [this = " << this << "]";
@@ -1872,6 +2137,7 @@ DirectRead::DirectRead(DirectReadNode* cdrn, m_off_t ccount, m_off_t coffset, in
 
     count = ccount;
     offset = coffset;
+    readahead = creadahead;
     progress = 0;
     reqtag = creqtag;
     appdata = cappdata;
@@ -1885,7 +2151,7 @@ DirectRead::DirectRead(DirectReadNode* cdrn, m_off_t ccount, m_off_t coffset, in
         // we already have tempurl(s): queue for immediate fetching
         m_off_t streamingMaxReqSize = drMaxReqSize();
         LOG_debug << "Direct read start -> direct read node size = " << drn->size << ", streaming max request size: " << streamingMaxReqSize;
-        drbuf.setIsRaid(drn->tempurls, offset, offset + count, drn->size, streamingMaxReqSize);
+        drbuf.setIsRaid(drn->tempurls, offset, offset + count + readahead, drn->size, streamingMaxReqSize);
         drq_it = drn->client->drq.insert(drn->client->drq.end(), this);
     }
     else
@@ -1955,6 +2221,7 @@ DirectReadSlot::DirectReadSlot(DirectRead* cdr)
         mReqs.push_back(make_unique<HttpReq>(true));
         mReqs.back()->status = REQ_READY;
         mReqs.back()->type = REQ_BINARY;
+        mReqs.back()->trafficclass = TRAFFIC_STREAMING;
     }
     LOG_verbose << "[DirectReadSlot::DirectReadSlot] Num requests: " << numReqs << " [this = " << this << "]";
     mThroughput.resize(mReqs.size());
@@ -1980,7 +2247,7 @@ DirectReadSlot::DirectReadSlot(DirectRead* cdr)
         mMaxChunkSize -= mMaxChunkSize % RAIDSECTOR;
     }
     mMinComparableThroughput = DirectReadSlot::DEFAULT_MIN_COMPARABLE_THROUGHPUT;
-    mSlotStartTime = std::chrono::steady_clock::now();
+    mSlotStartTime = Waiter::tickTime;
 }
 
 DirectReadSlot::~DirectReadSlot()
@@ -1999,6 +2266,19 @@ TransferList::TransferList()
     currentpriority = PRIORITY_START;
 }
 
+void TransferList::indexInsert(Transfer* transfer)
+{
+    if (transfer->state != TRANSFERSTATE_PAUSED)
+    {
+        mDispatchIndex[transfer->type][transfer->priority] = transfer;
+    }
+}
+
+void TransferList::indexErase(Transfer* transfer)
+{
+    mDispatchIndex[transfer->type].erase(transfer->priority);
+}
+
 void TransferList::addtransfer(Transfer *transfer, TransferDbCommitter& committer, bool startFirst)
 {
     if (transfer->state != TRANSFERSTATE_PAUSED)
@@ -2016,6 +2296,7 @@ void TransferList::addtransfer(Transfer *transfer, TransferDbCommitter& committe
             transfer->priority = dstit->transfer->priority - PRIORITY_STEP;
             prepareIncreasePriority(transfer, transfers[transfer->type].end(), dstit, committer);
             transfers[transfer->type].push_front(transfer);
+            indexInsert(transfer);
         }
         else
         {
@@ -2023,6 +2304,7 @@ void TransferList::addtransfer(Transfer *transfer, TransferDbCommitter& committe
             transfer->priority = currentpriority;
             assert(!transfers[transfer->type].size() || transfers[transfer->type][transfers[transfer->type].size() - 1]->priority < transfer->priority);
             transfers[transfer->type].push_back(transfer);
+            indexInsert(transfer);
         }
 
         client->transfercacheadd(transfer, &committer);
@@ -2032,6 +2314,7 @@ void TransferList::addtransfer(Transfer *transfer, TransferDbCommitter& committe
         transfer_list::iterator it = std::lower_bound(transfers[transfer->type].begin(), transfers[transfer->type].end(), LazyEraseTransferPtr(transfer), priority_comparator);
         assert(it == transfers[transfer->type].end() || it->transfer->priority != transfer->priority);
         transfers[transfer->type].insert(it, transfer);
+        indexInsert(transfer);
     }
 }
 
@@ -2041,6 +2324,7 @@ void TransferList::removetransfer(Transfer *transfer)
     if (getIterator(transfer, it, true))
     {
         transfers[transfer->type].erase(it);
+        indexErase(transfer);
     }
 }
 
@@ -2103,10 +2387,12 @@ void TransferList::movetransfer(transfer_list::iterator it, transfer_list::itera
         prepareDecreasePriority(transfer, it, dstit);
 
         transfers[transfer->type].erase(it);
+        indexErase(transfer);
         currentpriority += PRIORITY_STEP;
         transfer->priority = currentpriority;
         assert(!transfers[transfer->type].size() || transfers[transfer->type][transfers[transfer->type].size() - 1]->priority < transfer->priority);
         transfers[transfer->type].push_back(transfer);
+        indexInsert(transfer);
         client->transfercacheadd(transfer, &committer);
         client->app->transfer_update(transfer);
         return;
@@ -2141,7 +2427,9 @@ void TransferList::movetransfer(transfer_list::iterator it, transfer_list::itera
         {
             Transfer *t = transfers[transfer->type][i];
             LOG_debug << "Adjusting priority of transfer " << i << " to " << fixedPriority;
+            indexErase(t);
             t->priority = fixedPriority;
+            indexInsert(t);
             client->transfercacheadd(t, &committer);
             client->app->transfer_update(t);
             fixedPriority += PRIORITY_STEP;
@@ -2150,6 +2438,7 @@ void TransferList::movetransfer(transfer_list::iterator it, transfer_list::itera
         LOG_debug << "Fixed priority: " << fixedPriority;
     }
 
+    indexErase(transfer);
     transfer->priority = newpriority;
     if (srcindex > dstindex)
     {
@@ -2165,6 +2454,7 @@ void TransferList::movetransfer(transfer_list::iterator it, transfer_list::itera
     transfer_list::iterator fit = transfers[transfer->type].begin() + dstindex;
     assert(fit == transfers[transfer->type].end() || fit->transfer->priority != transfer->priority);
     transfers[transfer->type].insert(fit, transfer);
+    indexInsert(transfer);
     client->transfercacheadd(transfer, &committer);
     client->app->transfer_update(transfer);
 }
@@ -2260,6 +2550,7 @@ error TransferList::pause(Transfer *transfer, bool enable, TransferDbCommitter&
     if (!enable)
     {
         transfer->state = TRANSFERSTATE_QUEUED;
+        indexInsert(transfer);
 
         transfer_list::iterator it;
         if (getIterator(transfer, it))
@@ -2286,6 +2577,7 @@ error TransferList::pause(Transfer *transfer, bool enable, TransferDbCommitter&
             transfer->slot = NULL;
         }
         transfer->state = TRANSFERSTATE_PAUSED;
+        indexErase(transfer);
         client->transfercacheadd(transfer, &committer);
         client->app->transfer_update(transfer);
         return API_OK;
@@ -2294,6 +2586,14 @@ error TransferList::pause(Transfer *transfer, bool enable, TransferDbCommitter&
     return API_EFAILED;
 }
 
+void TransferList::clear()
+{
+    transfers[GET].clear();
+    transfers[PUT].clear();
+    mDispatchIndex[GET].clear();
+    mDispatchIndex[PUT].clear();
+}
+
 auto TransferList::begin(direction_t direction) -> transfer_list::iterator
 {
     return transfers[direction].begin();
@@ -2338,57 +2638,155 @@ std::array<vector<Transfer*>, 6> TransferList::nexttransfers(std::function<bool(
 
     for (direction_t direction : putget)
     {
-        for (Transfer *transfer : transfers[direction])
+        // walk the dispatch index rather than the full list, so a large paused
+        // backlog costs nothing here.  Transfers cancelled via cancel token are
+        // reaped in dispatchTransfers() before this is called; the per-entry
+        // check below handles candidates whose files were cancelled meanwhile.
+        // Two passes per direction: interactive transfers first, then bulk
+        // ones fill whatever capacity remains.
+        auto& candidates = mDispatchIndex[direction];
+        for (int interactivepass = 1; interactivepass >= 0; interactivepass--)
         {
-            if (!transfer->slot)
+            for (auto ci = candidates.begin(); ci != candidates.end(); )
             {
-                // check for cancellation here before we go to the trouble of requesting a download/upload URL
-                transfer->removeCancelledTransferFiles(&committer);
-                if (transfer->files.empty())
+                Transfer* transfer = ci->second;
+                ci++;   // ahead of possible removal of this entry below
+                if (transfer->interactive != (interactivepass > 0))
                 {
-                    transfer->removeAndDeleteSelf(TRANSFERSTATE_CANCELLED);
                     continue;
                 }
-            }
 
-            // don't traverse the whole list if we already have as many as we are going to get
-            if (!directionContinuefunction(direction)) break;
+                if (!transfer->slot)
+                {
+                    // check for cancellation here before we go to the trouble of requesting a download/upload URL
+                    transfer->removeCancelledTransferFiles(&committer);
+                    if (transfer->files.empty())
+                    {
+                        transfer->removeAndDeleteSelf(TRANSFERSTATE_CANCELLED);
+                        continue;
+                    }
+                }
 
-            bool continueLarge = true;
-            bool continueSmall = true;
+                // don't traverse the whole list if we already have as many as we are going to get
+                if (!directionContinuefunction(direction)) break;
 
-            if ((!transfer->slot && isReady(transfer))
-                || (transfer->asyncopencontext
-                    && transfer->asyncopencontext->finished))
-            {
-                TransferCategory tc(transfer);
+                bool continueLarge = true;
+                bool continueSmall = true;
 
-                if (tc.sizetype == LARGEFILE && continueLarge)
+                if ((!transfer->slot && isReady(transfer))
+                    || (transfer->asyncopencontext
+                        && transfer->asyncopencontext->finished))
                 {
-                    continueLarge = continuefunction(transfer);
-                    if (continueLarge)
+                    TransferCategory tc(transfer);
+
+                    if (tc.sizetype == LARGEFILE && continueLarge)
                     {
-                        chosenTransfers[tc.index()].push_back(transfer);
+                        continueLarge = continuefunction(transfer);
+                        if (continueLarge)
+                        {
+                            chosenTransfers[tc.index()].push_back(transfer);
+                        }
                     }
-                }
-                else if (tc.sizetype == SMALLFILE && continueSmall)
-                {
-                    continueSmall = continuefunction(transfer);
-                    if (continueSmall)
+                    else if (tc.sizetype == SMALLFILE && continueSmall)
+                    {
+                        continueSmall = continuefunction(transfer);
+                        if (continueSmall)
+                        {
+                            chosenTransfers[tc.index()].push_back(transfer);
+                        }
+                    }
+                    if (!continueLarge && !continueSmall)
                     {
-                        chosenTransfers[tc.index()].push_back(transfer);
+                        break;
                     }
                 }
-                if (!continueLarge && !continueSmall)
-                {
-                    break;
-                }
             }
         }
     }
     return chosenTransfers;
 }
 
+// with every slot taken, give a latency-bound interactive transfer a chance
+// to take over a slot from a bulk transfer
+bool TransferList::preemptforinteractive(TransferDbCommitter& committer)
+{
+    static direction_t putget[] = { PUT, GET };
+
+    Transfer* waiting = nullptr;
+    for (direction_t direction : putget)
+    {
+        // interactive transfers are moved to the front on start, so only the
+        // head of the index needs looking at; the bound keeps this O(1) even
+        // when a saturated bulk backlog is queued behind
+        unsigned scanned = 0;
+        for (auto& entry : mDispatchIndex[direction])
+        {
+            Transfer* t = entry.second;
+            if (t->interactive && !t->slot && isReady(t))
+            {
+                waiting = t;
+                break;
+            }
+            if (++scanned >= 64)
+            {
+                break;
+            }
+        }
+        if (waiting) break;
+    }
+
+    if (!waiting)
+    {
+        mInteractiveWaitingSince = NEVER;
+        return false;
+    }
+
+    if (!EVER(mInteractiveWaitingSince))
+    {
+        mInteractiveWaitingSince = Waiter::ds;
+    }
+
+    if (Waiter::ds - mInteractiveWaitingSince < INTERACTIVELATENCYDS)
+    {
+        // within the latency target: a slot may yet free up by itself
+        return false;
+    }
+
+    // kick the active bulk transfer with the lowest dispatch priority
+    // (ie. the largest priority value) in the waiting transfer's direction
+    Transfer* victim = nullptr;
+    for (transferslot_list::iterator it = client->tslots.begin(); it != client->tslots.end(); it++)
+    {
+        Transfer* t = (*it)->transfer;
+        if (t && t->type == waiting->type && t->slot && !t->interactive
+                && t->state == TRANSFERSTATE_ACTIVE
+                && t->priority > waiting->priority
+                && (!victim || t->priority > victim->priority))
+        {
+            victim = t;
+        }
+    }
+
+    if (!victim)
+    {
+        return false;
+    }
+
+    LOG_debug << "Bumping bulk transfer to seat a waiting interactive one";
+    if (victim->client->ststatus != STORAGE_RED || victim->type == GET)
+    {
+        victim->bt.arm();
+    }
+    delete victim->slot;
+    victim->slot = NULL;
+    victim->state = TRANSFERSTATE_QUEUED;
+    client->transfercacheadd(victim, &committer);
+    client->app->transfer_update(victim);
+
+    mInteractiveWaitingSince = NEVER;
+    return true;
+}
+
 Transfer *TransferList::transferat(direction_t direction, unsigned int position)
 {
     if (transfers[direction].size() > position)
@@ -60,6 +60,9 @@ const dstime TransferSlot::XFERTIMEOUT = 600;
 // max time without progress callbacks
 const dstime TransferSlot::PROGRESSTIMEOUT = 10;
 
+// interval between connection scaling decisions
+const dstime TransferSlot::CONNECTION_SCALE_INTERVAL_DS = 150;
+
 // max request size for downloads
 #if defined(__ANDROID__) || defined(USE_IOS)
     const m_off_t TransferSlot::MAX_REQ_SIZE = 2097152; // 2 MB
@@ -71,6 +74,18 @@ const dstime TransferSlot::PROGRESSTIMEOUT = 10;
 
 const m_off_t TransferSlot::MAX_GAP_SIZE = 256 * 1024 * 1024; // 256 MB
 
+// floor for the autotuned download request size
+const m_off_t TransferSlot::MIN_REQ_SIZE = 1048576; // 1 MB
+
+// write-behind: flush a coalesced run of download pieces once it reaches this size
+const m_off_t TransferSlot::WRITE_BEHIND_FLUSH_SIZE = 8 * 1024 * 1024; // 8 MB
+
+// write-behind: memory budget per transfer; exceeding it drains the whole pool
+const m_off_t TransferSlot::WRITE_BEHIND_MAX_BYTES = 32 * 1024 * 1024; // 32 MB
+
+// smaller zero runs aren't worth a hole (typical filesystem block size)
+const m_off_t TransferSlot::SPARSE_WRITE_MIN_SIZE = 4096;
+
 TransferSlot::TransferSlot(Transfer* ctransfer)
     : fa(ctransfer->client->fsaccess->newfileaccess(), ctransfer)
     , retrybt(ctransfer->client->rng, ctransfer->client->transferSlotsBackoff)
@@ -84,6 +99,8 @@ TransferSlot::TransferSlot(Transfer* ctransfer)
     errorcount = 0;
     lasterror = API_OK;
 
+    MEGA_TRACE_ASYNC_BEGIN("TransferSlot", this);
+
     failure = false;
     retrying = false;
 
@@ -97,6 +114,19 @@ TransferSlot::TransferSlot(Transfer* ctransfer)
 
     slots_it = transfer->client->tslots.end();
 
+    if (transfer->type == GET)
+    {
+        // keep the nodes being downloaded resident while the transfer is active
+        for (File* f : transfer->files)
+        {
+            if (!f->h.isUndef())
+            {
+                transfer->client->mNodeManager.pinNodeToCacheLRU(f->h);
+                mPinnedNodeHandles.push_back(f->h);
+            }
+        }
+    }
+
     maxRequestSize = MAX_REQ_SIZE;
 #if defined(_WIN32)
     MEMORYSTATUSEX statex;
@@ -132,6 +162,10 @@ TransferSlot::TransferSlot(Transfer* ctransfer)
         LOG_warn << "[Windows] Error getting RAM usage info";
     }
 #endif
+
+    // ceiling for BDP-driven request size growth.  If the memory probe already
+    // had to reduce the request size, there is no headroom to grow into
+    mMaxTunedRequestSize = maxRequestSize == MAX_REQ_SIZE ? MAX_REQ_SIZE * 4 : maxRequestSize;
 }
 
 bool TransferSlot::createconnectionsonce()
@@ -144,9 +178,27 @@ bool TransferSlot::createconnectionsonce()
             return false;   // too soon, we don't know raid / non-raid yet
         }
 
-        connections = transferbuf.isRaid() ? RAIDPARTS : (transfer->size > 131072 ? transfer->client->connections[transfer->type] : 1);
-        LOG_debug << "Populating transfer slot with " << connections << " connections, max request size of " << maxRequestSize << " bytes";
+        if (transferbuf.isRaid())
+        {
+            // raid geometry is fixed: one connection per part
+            connections = RAIDPARTS;
+            mActiveConnections = RAIDPARTS;
+        }
+        else if (transfer->size > 131072)
+        {
+            // allocate up to the hard maximum; updateconnectionscaling() decides how
+            // many to actually use, starting from the configured static setting
+            connections = static_cast<int>(MegaClient::MAX_NUM_CONNECTIONS);
+            mActiveConnections = std::min<int>(transfer->client->connections[transfer->type], connections);
+        }
+        else
+        {
+            connections = 1;
+            mActiveConnections = 1;
+        }
+        LOG_debug << "Populating transfer slot with " << connections << " connections (" << mActiveConnections << " initially active), max request size of " << maxRequestSize << " bytes";
         reqs.resize(connections);
+        mNextReqs.resize(connections);
         mReqSpeeds.resize(connections);
         asyncIO = new AsyncIOContext*[connections]();
     }
@@ -158,6 +210,22 @@ bool TransferSlot::createconnectionsonce()
 TransferSlot::~TransferSlot()
 {
     LOG_verbose << "Deleting TransferSlot";
+    MEGA_TRACE_ASYNC_END("TransferSlot", this);
+
+    if (mChunkLatency.count())
+    {
+        // fold this slot's samples into the session-wide histograms
+        transfer->client->performanceStats.transferChunkLatency.merge(mChunkLatency);
+        transfer->client->performanceStats.transferTimeToFirstByte.merge(mTimeToFirstByte);
+        transfer->client->performanceStats.transferConnThroughput.merge(mConnThroughput);
+        LOG_debug << "Transfer stats: " << statsReport();
+    }
+    if (transferbuf.raidConnectionSwitchesSlowStart || transferbuf.raidConnectionSwitchesSlowness || transferbuf.raidConnectionSwitchesError)
+    {
+        transfer->client->performanceStats.raidConnSwitchesSlowStart += transferbuf.raidConnectionSwitchesSlowStart;
+        transfer->client->performanceStats.raidConnSwitchesSlowness += transferbuf.raidConnectionSwitchesSlowness;
+        transfer->client->performanceStats.raidConnSwitchesError += transferbuf.raidConnectionSwitchesError;
+    }
     if (transfer->type == GET && !transfer->finished
             && transfer->progresscompleted != transfer->size
             && !transfer->asyncopencontext)
@@ -230,6 +298,14 @@ TransferSlot::~TransferSlot()
             }
         }
 
+        if (fa && !mPendingWrites.empty())
+        {
+            // push out whatever the write-behind pool still holds
+            m_off_t donebefore = transfer->progresscompleted;
+            flushwrites(true);
+            cachetransfer |= transfer->progresscompleted != donebefore;
+        }
+
         bool anyData = true;
         while (anyData)
         {
@@ -247,7 +323,8 @@ TransferSlot::~TransferSlot()
                         outputPiece->finalize(true, transfer->size, transfer->ctriv, cipher, &transfer->chunkmacs);
                     }
                     anyData = true;
-                    if (fa && fa->fwrite(outputPiece->buf.datastart(), static_cast<unsigned>(outputPiece->buf.datalen()), outputPiece->pos))
+                    if (fa && (sparseWritePiece(*fa, *outputPiece) ||
+                               fa->fwrite(outputPiece->buf.datastart(), static_cast<unsigned>(outputPiece->buf.datalen()), outputPiece->pos)))
                     {
                         LOG_verbose << "[TransferSlot::~TransferSlot] Conn " << i << " : Sync write succeeded (size: " << outputPiece->buf.datalen() << ")";
                         transferbuf.bufferWriteCompleted(i, true);
@@ -271,6 +348,11 @@ TransferSlot::~TransferSlot()
 
     transfer->slot = NULL;
 
+    for (const NodeHandle& h : mPinnedNodeHandles)
+    {
+        transfer->client->mNodeManager.unpinNodeFromCacheLRU(h);
+    }
+
     if (slots_it != transfer->client->tslots.end())
     {
         // advance main loop iterator if deleting next in line
@@ -281,6 +363,15 @@ TransferSlot::~TransferSlot()
 
         transfer->client->tslots.erase(slots_it);
         transfer->client->performanceStats.transferFinishes += 1;
+
+        if (transfer->finished && !transfer->client->multi_transfers[transfer->type].empty())
+        {
+            // warm handoff: refill the freed seat right away instead of sitting
+            // out the dispatch cool-down, so the next queued transfer's tempurl
+            // request goes out while this transfer's storage-server connections
+            // are still warm in the transport layer's connection cache
+            transfer->client->nextDispatchTransfersDs = Waiter::ds;
+        }
     }
 
     if (pendingcmd)
@@ -302,6 +393,26 @@ TransferSlot::~TransferSlot()
     delete[] asyncIO;
 }
 
+string TransferSlot::statsReport() const
+{
+    string s;
+    if (mChunkLatency.count())
+    {
+        s.append("chunk_ms[").append(mChunkLatency.report()).append("]");
+        if (mTimeToFirstByte.count())
+        {
+            s.append(" ttfb_ms[").append(mTimeToFirstByte.report()).append("]");
+        }
+        s.append(" conn_kbps[").append(mConnThroughput.report()).append("]");
+        s.append(" reqsize[").append(std::to_string(maxRequestSize)).append("]");
+        if (transferbuf.isRaid())
+        {
+            s.append(" raidlines[").append(std::to_string(transferbuf.getRaidLinesPerChunk())).append("]");
+        }
+    }
+    return s;
+}
+
 void TransferSlot::toggleport(HttpReqXfer *req)
 {
     if (!memcmp(req->posturl.c_str(), "http:", 5))
@@ -407,9 +518,34 @@ bool TransferSlot::checkDownloadTransferFinished(TransferDbCommitter& committer,
 {
     if (transfer->progresscompleted == transfer->size)
     {
+        if (transfer->size && !mMacVerifyResult)
+        {
+            // verify the meta MAC on a worker so the event loop (and with it,
+            // every other transfer) doesn't stall on the AES pass over the
+            // chunk macs.  The file shows as COMPLETING until the result lands
+            transfer->state = TRANSFERSTATE_COMPLETING;
+            client->app->transfer_update(transfer);
+
+            mMacVerifyResult = std::make_shared<std::atomic<int>>(0);
+            auto result = mMacVerifyResult;
+            auto macs = transfer->chunkmacs;  // worker gets its own copy: the transfer may be cancelled meanwhile
+            auto transferkey = transfer->transferkey;
+            auto metamac = transfer->metamac;
+            client->mAsyncQueue.push([result, macs, transferkey, metamac](SymmCipher& sc) mutable
+            {
+                sc.setkey(transferkey.data());
+                *result = macs.macsmac(&sc) == metamac ? 1 : -1;
+            }, false, reinterpret_cast<uintptr_t>(transfer));  // not discardable: a shutdown mustn't leave the result unset while the slot polls for it
+        }
+
+        if (mMacVerifyResult && *mMacVerifyResult == 0)
+        {
+            return false;   // verification still running; doio polls again when the worker wakes the loop
+        }
+
         // verify meta MAC
         if (!transfer->size
-            || (macsmac(&transfer->chunkmacs) == transfer->metamac)
+            || *mMacVerifyResult == 1
             || checkMetaMacWithMissingLateEntries())
         {
             client->transfercacheadd(transfer, &committer);
@@ -453,6 +589,7 @@ bool TransferSlot::testForSlowRaidConnection(unsigned connectionNum, bool& incre
         {
             m_off_t averageOtherRate = 0;
             unsigned otherCount = 0;
+            bool allOthersWaitingOnThis = true;
             for (unsigned j = RAIDPARTS; j--; )
             {
                 if (j != connectionNum && !transferbuf.isUnusedRaidConection(j))
@@ -463,6 +600,13 @@ bool TransferSlot::testForSlowRaidConnection(unsigned connectionNum, bool& incre
                         ++otherCount;
                         averageOtherRate += mReqSpeeds[j].lastRequestSpeed();
                     }
+                    else if (mReqSpeeds[j].requestElapsedDs() > 50)
+                    {
+                        // still streaming, but has run long enough for its measured rate to be meaningful
+                        ++otherCount;
+                        averageOtherRate += mReqSpeeds[j].lastRequestSpeed();
+                        allOthersWaitingOnThis = false;
+                    }
                     else
                     {
                         return false;
@@ -473,15 +617,23 @@ bool TransferSlot::testForSlowRaidConnection(unsigned connectionNum, bool& incre
             averageOtherRate /=  otherCount ? otherCount : 1;
             m_off_t thisRate = mReqSpeeds[connectionNum].lastRequestSpeed();
 
-            if (thisRate < averageOtherRate / 2     // this is less than half of avg of other connections
+            // once the peers are all blocked waiting on this connection, a 2x deficit is enough to unload it.
+            // while they are still streaming we act earlier, but only on a clear outlier and not too often,
+            // trading a bounded refetch against the whole download running at the pace of the worst server
+            m_off_t requiredDeficit = allOthersWaitingOnThis ? 2 : 4;
+
+            if (thisRate * requiredDeficit < averageOtherRate
                     && averageOtherRate > 50 * 1024 // avg is more than 50KB/s
-                    && thisRate < 1024 * 1024)      // this is less than 1MB/s
+                    && thisRate < 1024 * 1024       // this is less than 1MB/s
+                    && (allOthersWaitingOnThis || Waiter::ds - mLastRaidSlownessSwitch > 300))
             {
                 LOG_warn << "Raid connection " << connectionNum
                          << " is much slower than its peers, with speed " << thisRate
-                         << " while they are managing " << averageOtherRate;
+                         << " while they are managing " << averageOtherRate
+                         << (allOthersWaitingOnThis ? " (and all are waiting on it)" : " (unloading it early)");
 
                 mRaidChannelSwapsForSlowness += 1;
+                mLastRaidSlownessSwitch = Waiter::ds;
                 incrementErrors = false;
                 return true;
             }
@@ -494,6 +646,8 @@ bool TransferSlot::testForSlowRaidConnection(unsigned connectionNum, bool& incre
 void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 {
     CodeCounter::ScopeTimer pbt(client->performanceStats.transferslotDoio);
+    MEGA_TRACE_SCOPE("TransferSlot::doio");
+    StallSamplerPhase ssp(client->stallSampler, StallSampler::PHASE_TRANSFERS);
 
     if (!fa || (transfer->size && transfer->progresscompleted == transfer->size)
             || (transfer->type == PUT && transfer->ultoken))
@@ -550,6 +704,35 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
         return transfer->failed(lasterror, committer);
     }
 
+    if (transfer->deferredfpmismatch && transfer->deferredfpmismatch->load())
+    {
+        // the deferred fingerprint check found the local file modified since the
+        // interrupted upload: discard the resumed progress and start over
+        LOG_warn << "The local file has been modified: " << transfer->localfilename;
+        transfer->deferredfpmismatch.reset();
+        transfer->tempurls.clear();
+        transfer->chunkmacs.clear();
+        transfer->progresscompleted = 0;
+        transfer->ultoken.reset();
+        transfer->pos = 0;
+        return transfer->failed(API_EREAD, committer);
+    }
+
+    updateconnectionscaling();
+    updatereadaheadwindow();
+
+    if (mMacVerifyResult && checkDownloadTransferFinished(committer, client))
+    {
+        // the off-thread meta-MAC check concluded and the transfer completed or failed
+        return;
+    }
+
+    if (mFlushWriteBehind && completewritebehind(committer, backoff))
+    {
+        // a previously failed write-behind flush was retried and the transfer finished or failed
+        return;
+    }
+
     // main loop over connections
     for (int i = connections; i--; )
     {
@@ -578,6 +761,17 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     downloadRequest->status = REQ_SUCCESS;
                 }
             }
+            else if (reqs[i]->status == REQ_FAILURE && reqs[i]->httpstatus == 200 && transfer->type == GET)
+            {
+                // plain download failed partway through the range: salvage the
+                // chunk-aligned prefix as a normal success and refetch only the
+                // missing tail, instead of retransmitting the whole range
+                HttpReqDL* downloadRequest = static_cast<HttpReqDL*>(reqs[i].get());
+                if (downloadRequest->contentlength == downloadRequest->size && trySalvageTruncatedChunk(downloadRequest, i))
+                {
+                    downloadRequest->status = REQ_SUCCESS;
+                }
+            }
 
             switch (static_cast<reqstatus_t>(reqs[i]->status))
             {
@@ -625,6 +819,22 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     lastdata = Waiter::ds;
                     transfer->lastaccesstime = m_time();
 
+                    {
+                        auto latencyms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            Waiter::tickTime - reqs[i]->postStartTime).count();
+                        if (latencyms > 0)
+                        {
+                            mChunkLatency.record(static_cast<uint64_t>(latencyms));
+                            mConnThroughput.record(static_cast<uint64_t>(reqs[i]->size * 1000 / latencyms / 1024));
+                        }
+                        if (reqs[i]->firstByteTime != std::chrono::steady_clock::time_point())
+                        {
+                            auto ttfbms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                reqs[i]->firstByteTime - reqs[i]->postStartTime).count();
+                            mTimeToFirstByte.record(static_cast<uint64_t>(ttfbms > 0 ? ttfbms : 0));
+                        }
+                    }
+
                     LOG_debug << "Conn " << i << " : Transfer request finished (" << connDirectionToStr(transfer->type) << ")"
                             << " " << reqs[i]->pos << " - " << (reqs[i]->pos + reqs[i]->size)
                             << "   Size: " << reqs[i]->size
@@ -681,6 +891,27 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                                 }
                             }
 
+                            // read-ahead chunks claimed while requests were on the wire need the
+                            // same treatment: their ranges can only still be outstanding in the
+                            // resumed-transfer case above, and their MACs belong in the mac-of-macs
+                            for (int j = connections; j--; )
+                            {
+                                if (mNextReqs[j])
+                                {
+                                    while (mNextReqs[j]->status == REQ_ENCRYPTING)
+                                    {
+                                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                    }
+
+                                    if (mNextReqs[j]->status == REQ_PREPARED)
+                                    {
+                                        LOG_debug << "Conn " << i << " : Including chunk MACs from read-ahead chunk on connection " << j;
+                                        transfer->progresscompleted += mNextReqs[j]->size;
+                                        transfer->chunkmacs.finishedUploadChunks(static_cast<HttpReqUL*>(mNextReqs[j].get())->mChunkmacs);
+                                    }
+                                }
+                            }
+
                             transfer->chunkmacs.finishedUploadChunks(static_cast<HttpReqUL*>(reqs[i].get())->mChunkmacs);
                             transfer->progresscompleted += reqs[i]->size;
                             LOG_debug << "Conn " << i << " : Progress completed: " << transfer->progresscompleted << "/" << transfer->size;
@@ -719,6 +950,7 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 
                                 lasterror = e;
                                 errorcount++;
+                                PerfCounters::get().add(PERF_CHUNK_RETRIES);
                                 reqs[i]->status = REQ_PREPARED;
                                 break;
                             }
@@ -753,6 +985,13 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                         transfer->progresscompleted += reqs[i]->size;
                         LOG_debug << "Conn " << i << " : Progress completed: " << transfer->progresscompleted << "/" << transfer->size;
 
+                        if (fa)
+                        {
+                            // the uploaded range will not be read again: drop its cached
+                            // pages so bulk uploads don't evict hot application data
+                            fa->fadvise(FileAccess::ACCESS_DONTNEED, reqs[i]->pos, reqs[i]->size);
+                        }
+
                         updatecontiguousprogress();
 
                         if (transfer->progresscompleted == transfer->size)
@@ -821,7 +1060,7 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                                         sc.setkey(transferkey.data());
                                         outputPiece->finalize(true, filesize, ctriv, &sc, nullptr);
                                         req->status = REQ_DECRYPTED;
-                                    }, false);  // not discardable:  if we downloaded the data, don't waste it - decrypt and write as much as we can to file
+                                    }, false, reinterpret_cast<uintptr_t>(transfer));  // not discardable:  if we downloaded the data, don't waste it - decrypt and write as much as we can to file
                                 }
                                 else
                                 {
@@ -855,8 +1094,18 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                             client->sendevent(99430, "Invalid chunk size", 0);
 
                             LOG_warn << "Conn " << i << " : Invalid chunk size: " << reqs[i]->size << " - " << reqs[i]->bufpos;
+
+                            if (!transferbuf.isRaid() && trySalvageTruncatedChunk(downloadRequest, i))
+                            {
+                                // prefix kept: go round again so the shortened
+                                // request is processed as a normal success
+                                i = connections;
+                                continue;
+                            }
+
                             lasterror = API_EREAD;
                             errorcount++;
+                            PerfCounters::get().add(PERF_CHUNK_RETRIES);
                             reqs[i]->status = REQ_PREPARED;
                             break;
                         }
@@ -884,7 +1133,25 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                         // this must return the same piece we just decrypted, since we have not asked the transferbuf to discard it yet.
                         auto outputPiece = transferbuf.getAsyncOutputBufferPointer(i);
 
-                        if (fa->asyncavailable())
+                        if (sparseWritePiece(*fa, *outputPiece))
+                        {
+                            // all-zero piece recorded as a hole: complete it as an instant write
+                            LOG_verbose << "Conn " << i << " : Skipped physical write of all-zero piece at " << outputPiece->pos << " (size: " << outputPiece->buf.datalen() << ")";
+                            transferbuf.bufferWriteCompleted(i, true);
+                            errorcount = 0;
+                            transfer->failcount = 0;
+
+                            updatecontiguousprogress();
+
+                            if (checkDownloadTransferFinished(committer, client))
+                            {
+                                return;
+                            }
+
+                            client->transfercacheadd(transfer, &committer);
+                            reqs[i]->status = REQ_READY;
+                        }
+                        else if (fa->asyncavailable())
                         {
                             if (asyncIO[i])
                             {
@@ -901,34 +1168,18 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                         }
                         else
                         {
-                            if (fa->fwrite(outputPiece->buf.datastart(), static_cast<unsigned>(outputPiece->buf.datalen()), outputPiece->pos))
-                            {
-                                LOG_verbose << "Conn " << i << " : Sync write succeeded (size: " << outputPiece->buf.datalen() << ")";
-                                transferbuf.bufferWriteCompleted(i, true);
-                                errorcount = 0;
-                                transfer->failcount = 0;
-                                updatecontiguousprogress();
-                            }
-                            else
-                            {
-                                LOG_err << "Conn " << i << " : Error saving finished chunk (size: " << outputPiece->buf.datalen() << ")";
-                                if (!fa->retry)
-                                {
-                                    transferbuf.bufferWriteCompleted(i, false);  // discard failed data so we don't retry on slot deletion
-                                    return transfer->failed(API_EWRITE, committer);
-                                }
-                                lasterror = API_EWRITE;
-                                backoff = 2;
-                                break;
-                            }
+                            // write-behind: pool the decrypted piece so adjacent pieces can be
+                            // coalesced into larger ascending writes, and free the connection
+                            LOG_verbose << "Conn " << i << " : Pooling piece at " << outputPiece->pos << " for write-behind (size: " << outputPiece->buf.datalen() << ")";
+                            transferbuf.detachOutputBuffer(i);
+                            mPendingWriteBytes += m_off_t(outputPiece->buf.datalen());
+                            mPendingWrites[outputPiece->pos] = std::move(outputPiece);
+                            reqs[i]->status = REQ_READY;
 
-                            if (checkDownloadTransferFinished(committer, client))
+                            if (completewritebehind(committer, backoff))
                             {
                                 return;
                             }
-
-                            client->transfercacheadd(transfer, &committer);
-                            reqs[i]->status = REQ_READY;
                         }
                     }
                     break;
@@ -965,7 +1216,7 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                                         sc.setkey(transferkey.data());
                                         req->prepare(finaltempurl.c_str(), &sc, ctriv, pos, npos);
                                         req->status = REQ_PREPARED;
-                                    }, true);   // discardable - if the transfer or client are being destroyed, we won't be sending that data.
+                                    }, true, reinterpret_cast<uintptr_t>(transfer));   // discardable - if the transfer or client are being destroyed, we won't be sending that data.
                             }
                             else
                             {
@@ -1046,11 +1297,29 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 
         if (!failure)
         {
-            if (!reqs[i] || (reqs[i]->status == REQ_READY))
+            if (i >= mActiveConnections && (!reqs[i] || reqs[i]->status == REQ_READY))
+            {
+                // parked by downward connection scaling: don't start new requests
+                // on this channel (whatever was in flight on it has completed)
+                if (transfer->type == PUT && mNextReqs[i])
+                {
+                    // ...except a read-ahead chunk already claimed for this
+                    // channel: its range belongs to it and must still upload
+                    reqs[i] = std::move(mNextReqs[i]);
+                }
+            }
+            else if ((!reqs[i] || reqs[i]->status == REQ_READY) && transfer->type == PUT && mNextReqs[i])
+            {
+                // read-ahead pipeline: install the chunk claimed and
+                // pre-encrypted while the previous request was on the wire;
+                // it posts as soon as its worker reaches REQ_PREPARED
+                reqs[i] = std::move(mNextReqs[i]);
+            }
+            else if (!reqs[i] || (reqs[i]->status == REQ_READY))
             {
                 bool newInputBufferSupplied = false;
                 bool pauseConnectionInputForRaid = false;
-                std::pair<m_off_t, m_off_t> posrange = transferbuf.nextNPosForConnection(i, maxRequestSize, connections, newInputBufferSupplied, pauseConnectionInputForRaid, client->httpio->uploadSpeed);
+                std::pair<m_off_t, m_off_t> posrange = transferbuf.nextNPosForConnection(i, maxRequestSize, mActiveConnections, newInputBufferSupplied, pauseConnectionInputForRaid, client->httpio->uploadSpeed, client->httpio->downloadSpeed, errorcount);
 
                 // we might have a raid-reassembled block to write, or a previously loaded block, or a skip block to process.
                 bool newOutputBufferSupplied = false;
@@ -1063,6 +1332,17 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     newOutputBufferSupplied = true;
                 }
 
+                if (!newOutputBufferSupplied && !newInputBufferSupplied && !pauseConnectionInputForRaid
+                        && transfer->type == GET && !transferbuf.isRaid() && !mRetryRanges.empty())
+                {
+                    // a salvaged truncated chunk left a hole behind the claim
+                    // cursor, invisible to nextNPosForConnection: refetch it
+                    // before claiming any fresh range
+                    posrange = mRetryRanges.front();
+                    mRetryRanges.pop_front();
+                    LOG_debug << "Conn " << i << " : Refetching salvaged chunk tail. Pos: " << posrange.first << " to npos: " << posrange.second;
+                }
+
                 if (newOutputBufferSupplied || newInputBufferSupplied || pauseConnectionInputForRaid)
                 {
                     // process supplied block, or just wait until other connections catch up a bit
@@ -1075,6 +1355,7 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     {
                         reqs[i].reset(transfer->type == PUT ? (HttpReqXfer*)new HttpReqUL() : (HttpReqXfer*)new HttpReqDL());
                         reqs[i]->logname = client->clientname + (transfer->type == PUT ? "U" : "D") + std::to_string(++client->transferHttpCounter) + " ";
+                        reqs[i]->trafficclass = transfer->trafficclass();
                     }
 
                     bool prepare = true;
@@ -1087,7 +1368,40 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                         // For uploads, these are always on chunk boundaries so no need to worry about partials.
                         static_cast<HttpReqUL*>(reqs[i].get())->mChunkmacs.clear();
 
-                        if (fa->asyncavailable())
+                        std::shared_ptr<const byte> mappedSrc;
+                        if (!asyncIO[i] && (mappedSrc = fa->mmapread(pos, size)))
+                        {
+                            // zero-copy source: encrypt straight from the mapped file
+                            // into the request's (reused) output buffer on a worker
+                            // thread, with no read into an intermediate buffer
+                            string finaltempurl = transferbuf.tempURL(i);
+                            if (client->usealtupport && !memcmp(finaltempurl.c_str(), "http:", 5))
+                            {
+                                size_t index = finaltempurl.find("/", 8);
+                                if (index != string::npos && finaltempurl.find(":", 8) == string::npos)
+                                {
+                                    finaltempurl.insert(index, ":8080");
+                                }
+                            }
+
+                            auto req = reqs[i];    // shared_ptr so no object is deleted out from under the worker
+                            auto transferkey = transfer->transferkey;
+                            auto ctriv = transfer->ctriv;
+                            m_off_t npos = posrange.second;
+                            static_cast<HttpReqUL*>(req.get())->mMappedSource = std::move(mappedSrc);
+                            req->pos = pos;
+                            req->status = REQ_ENCRYPTING;
+
+                            client->mAsyncQueue.push([req, transferkey, ctriv, finaltempurl, pos, npos](SymmCipher& sc)
+                                {
+                                    sc.setkey(transferkey.data());
+                                    req->prepare(finaltempurl.c_str(), &sc, ctriv, pos, npos);
+                                    req->status = REQ_PREPARED;
+                                }, true, reinterpret_cast<uintptr_t>(transfer));   // discardable - the mapping is released with the request either way
+
+                            prepare = false;
+                        }
+                        else if (fa->asyncavailable())
                         {
                             if (asyncIO[i])
                             {
@@ -1154,6 +1468,19 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 
     if (transfer->type == PUT)
     {
+        // keep the encrypt stage ahead of the network: while a connection's
+        // request is on the wire, claim and pre-encrypt its next range
+        if (!failure && fa && transfer->size)
+        {
+            for (int i = 0; i < mActiveConnections; i++)
+            {
+                if (reqs[i] && reqs[i]->status == REQ_INFLIGHT && !mNextReqs[i])
+                {
+                    prepareuploadreadahead(unsigned(i));
+                }
+            }
+        }
+
         // Get the number of reqs in flight and the position of the earliest for...
         int numInflight = 0;
         m_off_t earliestPosInFlight = 0;
@@ -1209,6 +1536,7 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
         // for Raid, additionally we need the raid data that's waiting to be recombined
         p += transferbuf.progress();
     }
+    p += mPendingWriteBytes;   // downloaded and decrypted, awaiting a coalesced write
     p += transfer->progresscompleted;
 
     if (p != progressreported || (Waiter::ds - lastprogressreport) > PROGRESSTIMEOUT)
@@ -1352,6 +1680,220 @@ m_off_t TransferSlot::updatecontiguousprogress()
 }
 
 
+void TransferSlot::updateconnectionscaling()
+{
+    if (transferbuf.isRaid() || connections <= 1)
+    {
+        return;     // raid geometry is fixed, and small files stay on one connection
+    }
+
+    if (!mLastScaleDecision)
+    {
+        // let the first interval elapse before judging anything
+        mLastScaleDecision = Waiter::ds;
+        return;
+    }
+
+    if (Waiter::ds - mLastScaleDecision < CONNECTION_SCALE_INTERVAL_DS)
+    {
+        return;
+    }
+    mLastScaleDecision = Waiter::ds;
+
+    m_off_t currentSpeed = mTransferSpeed.getMeanSpeed();
+
+    if (errorcount)
+    {
+        // transient failures usually mean congestion or server throttling:
+        // reduce concurrency rather than piling on more requests
+        if (mActiveConnections > 1)
+        {
+            --mActiveConnections;
+            LOG_debug << "Connection scaling: down to " << mActiveConnections
+                      << " after " << errorcount << " transient errors (" << currentSpeed << " B/s)";
+        }
+        mLastScaleWasUp = false;
+    }
+    else if (mLastScaleWasUp && currentSpeed * 100 < mSpeedAtLastScale * 105)
+    {
+        // the extra connection gained less than 5% - concurrency is not the
+        // bottleneck here, give it back
+        --mActiveConnections;
+        mLastScaleWasUp = false;
+        LOG_debug << "Connection scaling: no gain from last increase, back to " << mActiveConnections
+                  << " (" << currentSpeed << " B/s, was " << mSpeedAtLastScale << " B/s)";
+    }
+    else if (mActiveConnections < connections
+             && currentSpeed >= mSpeedAtLastScale
+             && transfer->size - transfer->progresscompleted > m_off_t(mActiveConnections) * maxRequestSize)
+    {
+        // still scaling well and plenty of file left: try one more connection
+        ++mActiveConnections;
+        mLastScaleWasUp = true;
+        LOG_debug << "Connection scaling: up to " << mActiveConnections << " (" << currentSpeed << " B/s)";
+    }
+
+    mSpeedAtLastScale = currentSpeed;
+}
+
+void TransferSlot::updatereadaheadwindow()
+{
+    if (transfer->type != GET || !connections)
+    {
+        return;
+    }
+
+    if (!mLastReadAheadTune)
+    {
+        // let the first interval elapse so the mean speed and ttfb settle
+        mLastReadAheadTune = Waiter::ds;
+        return;
+    }
+
+    if (Waiter::ds - mLastReadAheadTune < CONNECTION_SCALE_INTERVAL_DS)
+    {
+        return;
+    }
+    mLastReadAheadTune = Waiter::ds;
+
+    m_off_t currentSpeed = mTransferSpeed.getMeanSpeed();
+    if (currentSpeed <= 0 || !mTimeToFirstByte.count())
+    {
+        return;     // nothing measured yet
+    }
+
+    // bandwidth-delay product of this path, from the measured time to first byte
+    m_off_t ttfbMs = m_off_t(mTimeToFirstByte.percentile(50));
+    m_off_t bdp = currentSpeed * ttfbMs / 1000;
+
+    // aim to keep two BDPs in flight per dispatching connection, so the next
+    // request is already on the wire while the previous response drains
+    int dispatching = transferbuf.isRaid() ? RAIDPARTS - 1 : std::max<int>(mActiveConnections, 1);
+    m_off_t target = 2 * bdp / dispatching;
+
+    if (mPendingWriteBytes > WRITE_BEHIND_MAX_BYTES / 2)
+    {
+        // the write-behind pool is backing up: the disk, not the window, is the
+        // bottleneck, and the pooled pieces are already costing memory
+        target = std::min<m_off_t>(target, maxRequestSize / 2);
+    }
+
+    target = std::max<m_off_t>(target, MIN_REQ_SIZE);
+    target = std::min<m_off_t>(target, mMaxTunedRequestSize);
+
+    // at most double or halve per interval, and ignore drift below a third
+    m_off_t newsize = std::min<m_off_t>(std::max<m_off_t>(target, maxRequestSize / 2), maxRequestSize * 2);
+    if ((newsize > maxRequestSize ? newsize - maxRequestSize : maxRequestSize - newsize) * 3 < maxRequestSize)
+    {
+        return;
+    }
+
+    LOG_debug << "Read-ahead tuning: request size " << maxRequestSize << " -> " << newsize
+              << " (speed " << currentSpeed << " B/s, ttfb " << ttfbMs << " ms, "
+              << dispatching << " connections)";
+    maxRequestSize = newsize;
+
+    if (transferbuf.isRaid())
+    {
+        transferbuf.tuneRaidLinesPerChunk(maxRequestSize);
+    }
+}
+
+bool TransferSlot::sparseWritePiece(FileAccess& fa, TransferBufferManager::FilePiece& piece)
+{
+    const byte* data = piece.buf.datastart();
+    size_t len = size_t(piece.buf.datalen());
+
+    return m_off_t(len) >= SPARSE_WRITE_MIN_SIZE
+           && !*data
+           && !memcmp(data, data + 1, len - 1)
+           && fa.fwriteZeros(unsigned(len), piece.pos);
+}
+
+bool TransferSlot::flushwrites(bool flushall)
+{
+    if (mPendingWriteBytes > WRITE_BEHIND_MAX_BYTES)
+    {
+        flushall = true;
+    }
+
+    for (auto it = mPendingWrites.begin(); it != mPendingWrites.end(); )
+    {
+        // measure the run of adjacent pieces starting at this one
+        auto runend = it;
+        m_off_t runbytes = 0;
+        for (m_off_t nextpos = it->first; runend != mPendingWrites.end() && runend->first == nextpos; runend++)
+        {
+            runbytes += m_off_t(runend->second->buf.datalen());
+            nextpos = runend->first + m_off_t(runend->second->buf.datalen());
+        }
+
+        if (!flushall && runbytes < WRITE_BEHIND_FLUSH_SIZE)
+        {
+            it = runend;   // keep pooling until the neighbouring pieces arrive
+            continue;
+        }
+
+        LOG_verbose << "Write-behind flush of " << runbytes << " bytes at " << it->first << " (" << mPendingWriteBytes << " pooled)";
+        while (it != runend)
+        {
+            TransferBufferManager::FilePiece& r = *it->second;
+            if (!sparseWritePiece(*fa, r) &&
+                !fa->fwrite(r.buf.datastart(), static_cast<unsigned>(r.buf.datalen()), r.pos))
+            {
+                LOG_err << "Error writing pooled chunk at " << r.pos << " (size: " << r.buf.datalen() << ")";
+                return false;
+            }
+            transferbuf.detachedWriteCompleted(r);
+            mPendingWriteBytes -= m_off_t(r.buf.datalen());
+            it = mPendingWrites.erase(it);
+        }
+    }
+    return true;
+}
+
+bool TransferSlot::completewritebehind(TransferDbCommitter& committer, dstime& backoff)
+{
+    mFlushWriteBehind = false;
+
+    // everything pooled must go out when the last piece has arrived, or when
+    // chunks must hit the file in strict order to unblock the next request
+    bool flushall = transfer->progresscompleted + mPendingWriteBytes == transfer->size
+                 || (transfer->client->orderdownloadedchunks && !transferbuf.isRaid());
+
+    m_off_t donebefore = transfer->progresscompleted;
+    bool flushok = flushwrites(flushall);
+
+    if (transfer->progresscompleted != donebefore)
+    {
+        errorcount = 0;
+        transfer->failcount = 0;
+        updatecontiguousprogress();
+
+        if (checkDownloadTransferFinished(committer, transfer->client))
+        {
+            return true;
+        }
+        transfer->client->transfercacheadd(transfer, &committer);
+    }
+
+    if (!flushok)
+    {
+        if (!fa->retry)
+        {
+            // discard pooled data so we don't retry on slot deletion
+            mPendingWrites.clear();
+            mPendingWriteBytes = 0;
+            transfer->failed(API_EWRITE, committer);
+            return true;
+        }
+        lasterror = API_EWRITE;
+        backoff = 2;
+        mFlushWriteBehind = true;
+    }
+    return false;
+}
+
 void TransferSlot::prepareRequest(const std::shared_ptr<HttpReqXfer>& httpReq, const string& tempURL, m_off_t pos, m_off_t npos)
 {
     string finaltempURL = tempURL;
@@ -1374,6 +1916,91 @@ void TransferSlot::prepareRequest(const std::shared_ptr<HttpReqXfer>& httpReq, c
     httpReq->status = REQ_PREPARED;
 }
 
+// while connection i's request is on the wire, claim the next range and
+// encrypt it on a worker thread, so the connection reposts the moment the
+// current request completes instead of idling through read + encrypt
+void TransferSlot::prepareuploadreadahead(unsigned i)
+{
+    MegaClient* client = transfer->client;
+
+    bool newInputBufferSupplied = false;
+    bool pauseConnectionInputForRaid = false;
+    std::pair<m_off_t, m_off_t> posrange = transferbuf.nextNPosForConnection(i, maxRequestSize, mActiveConnections, newInputBufferSupplied, pauseConnectionInputForRaid, client->httpio->uploadSpeed, client->httpio->downloadSpeed, errorcount);
+
+    if (posrange.second <= posrange.first)
+    {
+        return;
+    }
+
+    m_off_t pos = posrange.first;
+    unsigned size = unsigned(posrange.second - pos);
+
+    auto req = std::make_shared<HttpReqUL>();
+    req->logname = client->clientname + "U" + std::to_string(++client->transferHttpCounter) + " ";
+
+    std::shared_ptr<const byte> mappedSrc = fa->mmapread(pos, size);
+    if (!mappedSrc && !fa->fread(req->out, size, (-(int)size) & (SymmCipher::BLOCKSIZE - 1), pos, FSLogging::logOnError))
+    {
+        // leave the range unclaimed; the regular path retries it with full
+        // error handling once the connection is free
+        return;
+    }
+
+    string finaltempurl = transferbuf.tempURL(i);
+    if (client->usealtupport && !memcmp(finaltempurl.c_str(), "http:", 5))
+    {
+        size_t index = finaltempurl.find("/", 8);
+        if (index != string::npos && finaltempurl.find(":", 8) == string::npos)
+        {
+            finaltempurl.insert(index, ":8080");
+        }
+    }
+
+    auto transferkey = transfer->transferkey;
+    auto ctriv = transfer->ctriv;
+    m_off_t npos = posrange.second;
+    req->mMappedSource = std::move(mappedSrc);
+    req->pos = pos;
+    req->status = REQ_ENCRYPTING;
+
+    std::shared_ptr<HttpReqXfer> xreq = req;
+    client->mAsyncQueue.push([xreq, transferkey, ctriv, finaltempurl, pos, npos](SymmCipher& sc)
+        {
+            sc.setkey(transferkey.data());
+            xreq->prepare(finaltempurl.c_str(), &sc, ctriv, pos, npos);
+            xreq->status = REQ_PREPARED;
+        }, true, reinterpret_cast<uintptr_t>(transfer));   // discardable - the transfer may be gone by the time the worker runs
+
+    mNextReqs[i] = std::move(xreq);
+    transferbuf.transferPos(i) = std::max<m_off_t>(transferbuf.transferPos(i), npos);
+}
+
+bool TransferSlot::trySalvageTruncatedChunk(HttpReqDL* downloadRequest, int channel)
+{
+    assert(!transferbuf.isRaid());
+
+    m_off_t salvageable = ChunkedHash::chunkfloor(downloadRequest->dlpos + downloadRequest->bufpos) - downloadRequest->dlpos;
+    if (salvageable <= 0)
+    {
+        return false;
+    }
+
+    if (salvageable < m_off_t(downloadRequest->size))
+    {
+        // the hole is behind the claim cursor; a ready connection picks it up
+        LOG_debug << "Conn " << channel << " : Salvaging " << salvageable << " of " << downloadRequest->size
+                  << " bytes from truncated chunk at " << downloadRequest->dlpos
+                  << ", refetching only the remaining " << (m_off_t(downloadRequest->size) - salvageable);
+        mRetryRanges.push_back(std::make_pair(downloadRequest->dlpos + salvageable,
+                                              downloadRequest->dlpos + m_off_t(downloadRequest->size)));
+        PerfCounters::get().add(PERF_CHUNK_RETRIES);
+    }
+
+    downloadRequest->bufpos = salvageable;
+    downloadRequest->size = unsigned(salvageable);
+    return true;
+}
+
 std::pair<error, dstime> TransferSlot::processRequestFailure(MegaClient* client, const std::shared_ptr<HttpReqXfer>& httpReq, dstime& backoff, int channel)
 {
     LOG_warn << "Conn " << channel << " : Failed chunk. HTTP status: " << httpReq->httpstatus;
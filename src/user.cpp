@@ -24,10 +24,13 @@
 #include "mega/logging.h"
 #include "mega/base64.h"
 
+#include <algorithm>
+
 namespace mega {
 
 constexpr char User::NO_VERSION[];
 constexpr char User::NON_EXISTING[];
+constexpr m_time_t User::ATTR_CACHE_TTL;
 
 User::User(const char* cemail)
 {
@@ -227,6 +230,7 @@ User* User::unserialize(MegaClient* client, string* d)
 
     client->mapuser(uh, m.c_str());
     u->set(v, ts);
+    memset(&u->changed, 0, sizeof(u->changed)); // loading from cache is not a delta
     u->resetTag();
     u->mBizMode = bizMode;
 
@@ -407,12 +411,14 @@ void User::setattr(attr_t at, string *av, string *v)
     }
 
     attrsv[at] = v ? *v : NO_VERSION;
+    attrts[at] = m_time();
 }
 
 void User::invalidateattr(attr_t at)
 {
     setChanged(at);
     attrsv.erase(at);
+    attrts.erase(at);
 }
 
 void User::removeattr(attr_t at, const string *version)
@@ -423,6 +429,7 @@ void User::removeattr(attr_t at, const string *version)
     }
 
     attrs.erase(at);
+    attrts.erase(at);
     if (version)
     {
         attrsv[at] = *version;
@@ -433,6 +440,12 @@ void User::removeattr(attr_t at, const string *version)
     }
 }
 
+m_time_t User::getattrts(attr_t at) const
+{
+    auto it = attrts.find(at);
+    return it != attrts.end() ? it->second : 0;
+}
+
 // updates the user attribute value+version only if different
 int User::updateattr(attr_t at, std::string *av, std::string *v)
 {
@@ -462,6 +475,7 @@ void User::setNonExistingAttribute(attr_t at)
     // Set special value (-9) at attrsv map to indicate that attribute doesn't exist
     assert(attrs.find(at) == attrs.end());
     attrsv[at] = NON_EXISTING;
+    attrts[at] = m_time();
 }
 
 // returns the value if there is value (even if it's invalid by now)
@@ -823,164 +837,98 @@ string User::attr2longname(attr_t type)
 }
 
 
-attr_t User::string2attr(const char* name)
+namespace {
+
+// the known attribute names and their types, sorted so a lookup is a single
+// binary search instead of a strcmp per candidate
+struct AttrNameMapping
 {
-    if (!strcmp(name, "*keyring"))
-    {
-        return ATTR_KEYRING;
-    }
-    else if (!strcmp(name, "*!authring"))
-    {
-        return ATTR_AUTHRING;
-    }
-    else if (!strcmp(name, "*!authCu255"))
-    {
-        return ATTR_AUTHCU255;
-    }
-    else if (!strcmp(name, "*!lstint"))
-    {
-        return ATTR_LAST_INT;
-    }
-    else if (!strcmp(name, "+puCu255"))
-    {
-        return ATTR_CU25519_PUBK;
-    }
-    else if (!strcmp(name, "+puEd255"))
-    {
-        return ATTR_ED25519_PUBK;
-    }
-    else if (!strcmp(name, "+sigPubk"))
-    {
-        return ATTR_SIG_RSA_PUBK;
-    }
-    else if (!strcmp(name, "+sigCu255"))
-    {
-        return ATTR_SIG_CU255_PUBK;
-    }
-    else if (!strcmp(name, "+a"))
-    {
-        return ATTR_AVATAR;
-    }
-    else if (!strcmp(name, "firstname"))
-    {
-        return ATTR_FIRSTNAME;
-    }
-    else if (!strcmp(name, "lastname"))
-    {
-        return ATTR_LASTNAME;
-    }
-    else if (!strcmp(name, "country"))
-    {
-        return ATTR_COUNTRY;
-    }
-    else if (!strcmp(name, "birthday"))
-    {
-        return ATTR_BIRTHDAY;
-    }
-    else if(!strcmp(name, "birthmonth"))
-    {
-        return ATTR_BIRTHMONTH;
-    }
-    else if(!strcmp(name, "birthyear"))
-    {
-        return ATTR_BIRTHYEAR;
-    }
-    else if(!strcmp(name, "^!lang"))
-    {
-        return ATTR_LANGUAGE;
-    }
-    else if(!strcmp(name, "^!prd"))
-    {
-        return ATTR_PWD_REMINDER;
-    }
-    else if(!strcmp(name, "^!dv"))
-    {
-        return ATTR_DISABLE_VERSIONS;
-    }
-    else if(!strcmp(name, "^!nokit"))
-    {
-        return ATTR_NO_CALLKIT;
-    }
-    else if(!strcmp(name, "^clv"))
-    {
-        return ATTR_CONTACT_LINK_VERIFICATION;
-    }
-    else if(!strcmp(name, "*!rp"))
-    {
-        return ATTR_RICH_PREVIEWS;
-    }
-    else if(!strcmp(name, "^!lastPsa"))
-    {
-        return ATTR_LAST_PSA;
-    }
-    else if(!strcmp(name, "^!rubbishtime"))
-    {
-        return ATTR_RUBBISH_TIME;
-    }
-    else if(!strcmp(name, "^!usl"))
-    {
-        return ATTR_STORAGE_STATE;
-    }
-    else if(!strcmp(name, "*!geo"))
-    {
-        return ATTR_GEOLOCATION;
-    }
-    else if (!strcmp(name, "*!cam"))
-    {
-        return ATTR_CAMERA_UPLOADS_FOLDER;
-    }
-    else if(!strcmp(name, "*!cf"))
-    {
-        return ATTR_MY_CHAT_FILES_FOLDER;
-    }
-    else if(!strcmp(name, "^!ps"))
-    {
-        return ATTR_PUSH_SETTINGS;
-    }
-    else if (!strcmp(name, "*~usk"))
-    {
-        return ATTR_UNSHAREABLE_KEY;
-    }
-    else if (!strcmp(name, "*!>alias"))
-    {
-        return ATTR_ALIAS;
-    }
-    else if (!strcmp(name, "*!dn"))
-    {
-        return ATTR_DEVICE_NAMES;
-    }
-    else if (!strcmp(name, "^!bak"))
-    {
-        return ATTR_MY_BACKUPS_FOLDER;
-    }
-    else if (!strcmp(name, "^!csp"))
-    {
-        return ATTR_COOKIE_SETTINGS;
-    }
-    else if (!strcmp(name, "*~jscd"))
-    {
-        return ATTR_JSON_SYNC_CONFIG_DATA;
-    }
-    else if (!strcmp(name, "^!keys"))
-    {
-        return ATTR_KEYS;
-    }
-    else if (!strcmp(name, "*!aPrefs"))
-    {
-        return ATTR_APPS_PREFS;
-    }
-    else if (!strcmp(name, "*!ccPref"))
+    const char* name;
+    attr_t attr;
+};
+
+constexpr AttrNameMapping attrNameTable[] = {
+    { "*!>alias",       ATTR_ALIAS },
+    { "*!aPrefs",       ATTR_APPS_PREFS },
+    { "*!authCu255",    ATTR_AUTHCU255 },
+    { "*!authring",     ATTR_AUTHRING },
+    { "*!cam",          ATTR_CAMERA_UPLOADS_FOLDER },
+    { "*!ccPref",       ATTR_CC_PREFS },
+    { "*!cf",           ATTR_MY_CHAT_FILES_FOLDER },
+    { "*!dn",           ATTR_DEVICE_NAMES },
+    { "*!geo",          ATTR_GEOLOCATION },
+    { "*!lstint",       ATTR_LAST_INT },
+    { "*!rp",           ATTR_RICH_PREVIEWS },
+    { "*keyring",       ATTR_KEYRING },
+    { "*~jscd",         ATTR_JSON_SYNC_CONFIG_DATA },
+    { "*~usk",          ATTR_UNSHAREABLE_KEY },
+    { "+a",             ATTR_AVATAR },
+    { "+puCu255",       ATTR_CU25519_PUBK },
+    { "+puEd255",       ATTR_ED25519_PUBK },
+    { "+sigCu255",      ATTR_SIG_CU255_PUBK },
+    { "+sigPubk",       ATTR_SIG_RSA_PUBK },
+    { "^!bak",          ATTR_MY_BACKUPS_FOLDER },
+    { "^!csp",          ATTR_COOKIE_SETTINGS },
+    { "^!dv",           ATTR_DISABLE_VERSIONS },
+    { "^!keys",         ATTR_KEYS },
+    { "^!lang",         ATTR_LANGUAGE },
+    { "^!lastPsa",      ATTR_LAST_PSA },
+    { "^!nokit",        ATTR_NO_CALLKIT },
+    { "^!prd",          ATTR_PWD_REMINDER },
+    { "^!ps",           ATTR_PUSH_SETTINGS },
+    { "^!rubbishtime",  ATTR_RUBBISH_TIME },
+    { "^!usl",          ATTR_STORAGE_STATE },
+    { "^!weldlg",       ATTR_VISIBLE_WELCOME_DIALOG },
+    { "^clv",           ATTR_CONTACT_LINK_VERIFICATION },
+    { "birthday",       ATTR_BIRTHDAY },
+    { "birthmonth",     ATTR_BIRTHMONTH },
+    { "birthyear",      ATTR_BIRTHYEAR },
+    { "country",        ATTR_COUNTRY },
+    { "firstname",      ATTR_FIRSTNAME },
+    { "lastname",       ATTR_LASTNAME },
+};
+
+constexpr bool attrNameLess(const char* a, const char* b)
+{
+    while (*a && *a == *b)
     {
-        return ATTR_CC_PREFS;
+        ++a;
+        ++b;
     }
-    else if(!strcmp(name, "^!weldlg"))
+    return static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+}
+
+constexpr bool attrNameTableSorted()
+{
+    for (size_t i = 1; i < sizeof(attrNameTable) / sizeof(attrNameTable[0]); ++i)
     {
-        return ATTR_VISIBLE_WELCOME_DIALOG;
+        if (!attrNameLess(attrNameTable[i - 1].name, attrNameTable[i].name))
+        {
+            return false;
+        }
     }
-    else
+    return true;
+}
+
+// the binary search relies on the order; a misplaced addition fails the build
+static_assert(attrNameTableSorted(), "attrNameTable must stay sorted");
+
+} // anonymous namespace
+
+attr_t User::string2attr(const char* name)
+{
+    auto it = std::lower_bound(std::begin(attrNameTable), std::end(attrNameTable), name,
+                               [](const AttrNameMapping& entry, const char* n)
+                               {
+                                   return strcmp(entry.name, n) < 0;
+                               });
+
+    if (it != std::end(attrNameTable) && !strcmp(it->name, name))
     {
-        return ATTR_UNKNOWN;   // attribute not recognized
+        return it->attr;
     }
+
+    return ATTR_UNKNOWN;   // attribute not recognized
 }
 
 int User::needversioning(attr_t at)
@@ -1541,10 +1489,27 @@ void User::resetTag()
 // update user attributes
 void User::set(visibility_t v, m_time_t ct)
 {
+    if (show != v)
+    {
+        changed.show = true;
+    }
+
+    if (ctime != ct)
+    {
+        changed.ctime = true;
+    }
+
     show = v;
     ctime = ct;
 }
 
+bool User::anyChanged() const
+{
+    decltype(changed) none;
+    memset(&none, 0, sizeof(none));
+    return memcmp(&changed, &none, sizeof(changed)) != 0;
+}
+
 string User::attributePrefixInTLV(attr_t type, bool modifier)
 {
     if (type == ATTR_DEVICE_NAMES && modifier)
@@ -1932,15 +1932,77 @@ void UserAlerts::add(UserAlertRaw& un)
     }
 }
 
-UserAlert::Base* UserAlerts::findAlertToCombineWith(const UserAlert::Base* a, nameid t) const
+bool UserAlerts::combineKey(const UserAlert::Base* a, std::tuple<nameid, handle, handle>& key) const
 {
-    if (a->type == t)
+    if (a->type == UserAlert::type_put)
     {
-        auto ait = std::find_if(alerts.rbegin(), alerts.rend(), [](UserAlert::Base* b) { return !b->removed(); });
-        return ait != alerts.rend() && (*ait)->type == t ? *ait : nullptr;
+        const UserAlert::NewSharedNodes* np = dynamic_cast<const UserAlert::NewSharedNodes*>(a);
+        if (!np || ISUNDEF(np->parentHandle))
+        {
+            return false;
+        }
+
+        key = std::make_tuple(a->type, a->user(), np->parentHandle);
+        return true;
     }
 
-    return nullptr;
+    if (a->type == UserAlert::type_d || a->type == UserAlert::type_u)
+    {
+        key = std::make_tuple(a->type, a->user(), UNDEF);
+        return true;
+    }
+
+    return false;
+}
+
+bool UserAlerts::aggregateHeld(UserAlert::Base* a) const
+{
+    if (a->removed())
+    {
+        return false; // removals must reach the app (and the db) without delay
+    }
+
+    auto it = mOpenAggregates.find(a);
+    if (it == mOpenAggregates.end())
+    {
+        return false;
+    }
+
+    return Waiter::ds - it->second.lastMerge < AGGREGATE_QUIET_DS
+        && Waiter::ds - it->second.opened < AGGREGATE_MAX_HOLD_DS;
+}
+
+void UserAlerts::forgetAggregate(UserAlert::Base* a)
+{
+    mOpenAggregates.erase(a);
+
+    std::tuple<nameid, handle, handle> key;
+    if (combineKey(a, key))
+    {
+        auto it = mCombineIndex.find(key);
+        if (it != mCombineIndex.end() && it->second == a)
+        {
+            mCombineIndex.erase(it);
+        }
+    }
+}
+
+void UserAlerts::updateAggregateDeadline(dstime* nds) const
+{
+    for (auto& it : mOpenAggregates)
+    {
+        if (!it.first->notified)
+        {
+            continue; // nothing pending for the app
+        }
+
+        dstime deadline = std::min<dstime>(it.second.lastMerge + AGGREGATE_QUIET_DS,
+                                           it.second.opened + AGGREGATE_MAX_HOLD_DS);
+        if (deadline < *nds)
+        {
+            *nds = deadline;
+        }
+    }
 }
 
 void UserAlerts::add(UserAlert::Base* unb)
@@ -1969,73 +2031,75 @@ void UserAlerts::add(UserAlert::Base* unb)
         return;
     }
 
-    // attempt to combine with previous NewSharedNodes
-    UserAlert::Base* cmb = findAlertToCombineWith(unb, UserAlert::type_put);
-    if (cmb)
+    // attempt to collapse share-activity alerts into their open composite
+    std::tuple<nameid, handle, handle> key;
+    if (combineKey(unb, key))
     {
-        // If it's file/folders added, and the prior one is for the same user and within 5 mins then we can combine instead
-        UserAlert::NewSharedNodes* np = dynamic_cast<UserAlert::NewSharedNodes*>(unb);
-        UserAlert::NewSharedNodes* op = dynamic_cast<UserAlert::NewSharedNodes*>(cmb);
-        if (np && op)
+        auto cit = mCombineIndex.find(key);
+        UserAlert::Base* cmb = cit != mCombineIndex.end() ? cit->second : nullptr;
+
+        // if the prior one is within 5 mins then we can combine instead
+        if (cmb && !cmb->removed() && unb->ts() - cmb->ts() < 300)
         {
-            if (np->user() == op->user() && np->ts() - op->ts() < 300 &&
-                np->parentHandle == op->parentHandle && !ISUNDEF(np->parentHandle))
+            bool merged = false;
+            if (unb->type == UserAlert::type_put)
             {
-                op->fileNodeHandles.insert(end(op->fileNodeHandles), begin(np->fileNodeHandles), end(np->fileNodeHandles));
-                op->folderNodeHandles.insert(end(op->folderNodeHandles),
-                                             begin(np->folderNodeHandles), end(np->folderNodeHandles));
-                LOG_debug << "Merged user alert, type " << np->type << " ts " << np->ts();
-
-                notifyAlert(op, false, 0);
-
-                delete unb;
-                return;
+                UserAlert::NewSharedNodes* np = dynamic_cast<UserAlert::NewSharedNodes*>(unb);
+                UserAlert::NewSharedNodes* op = dynamic_cast<UserAlert::NewSharedNodes*>(cmb);
+                if (np && op)
+                {
+                    op->fileNodeHandles.insert(end(op->fileNodeHandles), begin(np->fileNodeHandles), end(np->fileNodeHandles));
+                    op->folderNodeHandles.insert(end(op->folderNodeHandles),
+                                                 begin(np->folderNodeHandles), end(np->folderNodeHandles));
+                    merged = true;
+                }
             }
-        }
-    }
-
-    // attempt to combine with previous RemovedSharedNode
-    cmb = findAlertToCombineWith(unb, UserAlert::type_d);
-    if (cmb)
-    {
-        // If it's file/folders removed, and the prior one is for the same user and within 5 mins then we can combine instead
-        UserAlert::RemovedSharedNode* nd = dynamic_cast<UserAlert::RemovedSharedNode*>(unb);
-        UserAlert::RemovedSharedNode* od = dynamic_cast<UserAlert::RemovedSharedNode*>(cmb);
-        if (nd && od)
-        {
-            if (nd->user() == od->user() && nd->ts() - od->ts() < 300)
+            else if (unb->type == UserAlert::type_d)
             {
-                od->nodeHandles.insert(end(od->nodeHandles), begin(nd->nodeHandles), end(nd->nodeHandles));
-                LOG_debug << "Merged user alert, type " << nd->type << " ts " << nd->ts();
-
-                notifyAlert(od, false, 0);
-
-                delete unb;
-                return;
+                UserAlert::RemovedSharedNode* nd = dynamic_cast<UserAlert::RemovedSharedNode*>(unb);
+                UserAlert::RemovedSharedNode* od = dynamic_cast<UserAlert::RemovedSharedNode*>(cmb);
+                if (nd && od)
+                {
+                    od->nodeHandles.insert(end(od->nodeHandles), begin(nd->nodeHandles), end(nd->nodeHandles));
+                    merged = true;
+                }
+            }
+            else // UserAlert::type_u
+            {
+                UserAlert::UpdatedSharedNode* nd = dynamic_cast<UserAlert::UpdatedSharedNode*>(unb);
+                UserAlert::UpdatedSharedNode* od = dynamic_cast<UserAlert::UpdatedSharedNode*>(cmb);
+                if (nd && od)
+                {
+                    od->nodeHandles.insert(end(od->nodeHandles), begin(nd->nodeHandles), end(nd->nodeHandles));
+                    merged = true;
+                }
             }
-        }
-    }
 
-    // attempt to combine with previous UpdatedSharedNode
-    cmb = findAlertToCombineWith(unb, UserAlert::type_u);
-    if (cmb)
-    {
-        // If it's file/folders updated, and the prior one is for the same user and within 5 mins then we can combine instead
-        UserAlert::UpdatedSharedNode* nd = dynamic_cast<UserAlert::UpdatedSharedNode*>(unb);
-        UserAlert::UpdatedSharedNode* od = dynamic_cast<UserAlert::UpdatedSharedNode*>(cmb);
-        if (nd && od)
-        {
-            if (nd->user() == od->user() && nd->ts() - od->ts() < 300)
+            if (merged)
             {
-                od->nodeHandles.insert(end(od->nodeHandles), begin(nd->nodeHandles), end(nd->nodeHandles));
-                LOG_debug << "Merged user alert, type " << nd->type << " ts " << nd->ts();
+                LOG_debug << "Merged user alert, type " << unb->type << " ts " << unb->ts();
 
-                notifyAlert(od, false, 0);
+                // keep the composite withheld while the storm lasts; a
+                // composite already released to the app reopens its window
+                AggregateWindow& w = mOpenAggregates[cmb];
+                if (!w.opened)
+                {
+                    w.opened = Waiter::ds;
+                }
+                w.lastMerge = Waiter::ds;
+
+                notifyAlert(cmb, false, 0);
 
                 delete unb;
                 return;
             }
         }
+
+        // no composite to join: this alert becomes the candidate, and is
+        // itself withheld for the quiet window in case a storm follows
+        mCombineIndex[key] = unb;
+        AggregateWindow& w = mOpenAggregates[unb];
+        w.opened = w.lastMerge = Waiter::ds;
     }
 
     // check for previous Payment-Reminder to ignore
@@ -2692,12 +2756,16 @@ void UserAlerts::onAcknowledgeReceived()
 void UserAlerts::clear()
 {
     useralertnotify.clear();
+    mOpenAggregates.clear();
+    mCombineIndex.clear();
 
     for (Alerts::iterator i = alerts.begin(); i != alerts.end(); ++i)
     {
         delete *i;
     }
     alerts.clear();
+    coldAlerts.clear();
+    onDemandResident = 0;
 
     begincatchup = false;
     catchupdone = false;
@@ -2714,12 +2782,22 @@ UserAlerts::~UserAlerts()
 }
 
 bool UserAlerts::unserializeAlert(string* d, uint32_t dbid)
+{
+    if (UserAlert::Base* a = unserializeAlertRecord(d, dbid))
+    {
+        add(a); // takes ownership of a
+        return true;
+    }
+    return false;
+}
+
+UserAlert::Base* UserAlerts::unserializeAlertRecord(string* d, uint32_t dbid)
 {
     nameid type = 0;
     CacheableReader r(*d);
     if (!r.unserializecompressedu64(type))
     {
-        return false;
+        return nullptr;
     }
     r.eraseused(*d);
 
@@ -2791,11 +2869,53 @@ bool UserAlerts::unserializeAlert(string* d, uint32_t dbid)
     if (a)
     {
         a->dbid = dbid;
-        add(a); // takes ownership of a
-        return true;
     }
+    return a;
+}
 
-    return false;
+void UserAlerts::queueAlertDbRecord(string* d, uint32_t dbid)
+{
+    // no parsing at this point - login only pays for the newest page
+    coldAlerts.emplace_back(dbid, std::move(*d));
+}
+
+void UserAlerts::materializeResidentAlerts()
+{
+    size_t n = std::min(coldAlerts.size(), residentAlertPage);
+    for (auto it = coldAlerts.end() - static_cast<ptrdiff_t>(n); it != coldAlerts.end(); ++it)
+    {
+        if (!unserializeAlert(&it->second, it->first))
+        {
+            LOG_err << "Failed - user notification read error";
+            // don't break execution, just ignore it
+        }
+    }
+    coldAlerts.erase(coldAlerts.end() - static_cast<ptrdiff_t>(n), coldAlerts.end());
+
+    if (!coldAlerts.empty())
+    {
+        LOG_debug << coldAlerts.size() << " older user alerts left in serialized form, available on demand";
+    }
+}
+
+size_t UserAlerts::loadOlderAlertPage(size_t count)
+{
+    size_t loaded = 0;
+    while (loaded < count && !coldAlerts.empty())
+    {
+        auto& record = coldAlerts.back();
+        if (UserAlert::Base* a = unserializeAlertRecord(&record.second, record.first))
+        {
+            // these were aggregated when first created and are already in the
+            // db, so they go straight onto the front of the resident window -
+            // no combine logic, no notification, no re-persist
+            alerts.push_front(a);
+            ++onDemandResident;
+            ++loaded;
+        }
+        coldAlerts.pop_back();
+    }
+    return loaded;
 }
 
 void UserAlerts::initscalerts() // called after sc50 response has been received
@@ -2817,11 +2937,29 @@ void UserAlerts::purgescalerts() // called from MegaClient::notifypurge()
 
     trimAlertsToMaxCount();
 
-    // send notification for all current alerts, even if some overflowed already
-    LOG_debug << "Notifying " << useralertnotify.size() << " user alerts";
-    mc.app->useralerts_updated(&useralertnotify[0], (int)useralertnotify.size());
-
+    // withhold composites whose aggregation window is still open - the app
+    // hears about a storm once, with final counts, not once per packet
+    useralert_vector ready;
+    useralert_vector held;
     for (auto a : useralertnotify)
+    {
+        (aggregateHeld(a) ? held : ready).push_back(a);
+    }
+
+    if (ready.empty())
+    {
+        return;
+    }
+
+    if (!mc.catchingUpOnActionpackets())
+    {
+        // send notification for all current alerts, even if some overflowed already
+        LOG_debug << "Notifying " << ready.size() << " user alerts ("
+                  << held.size() << " still aggregating)";
+        mc.app->useralerts_updated(&ready[0], (int)ready.size());
+    }
+
+    for (auto a : ready)
     {
         mc.persistAlert(a); // persist to db (add/update/remove)
 
@@ -2831,20 +2969,26 @@ void UserAlerts::purgescalerts() // called from MegaClient::notifypurge()
             assert(it != alerts.end());
             alerts.erase(it);
 
+            forgetAggregate(a);
             delete a;
         }
         else
         {
             a->notified = false;
+
+            // close the window; a later merge reopens it from scratch
+            mOpenAggregates.erase(a);
         }
     }
 
-    useralertnotify.clear();
+    useralertnotify = std::move(held);
 }
 
 void UserAlerts::trimAlertsToMaxCount()
 {
-    static constexpr size_t maxAlertCount = 200; // value mentioned in the requirements
+    // resident cap from the requirements, widened by whatever history the app
+    // has explicitly paged back in
+    const size_t maxAlertCount = residentAlertPage + onDemandResident;
 
     if (alerts.size() < maxAlertCount)  return;
 
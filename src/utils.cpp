@@ -28,6 +28,7 @@
 
 #include <iomanip>
 #include <cctype>
+#include <deque>
 
 #if defined(_WIN32) && defined(_MSC_VER)
 #include <sys/timeb.h>
@@ -518,6 +519,18 @@ void chunkmac_map::ctr_encrypt(m_off_t chunkid, SymmCipher *cipher, byte *chunks
     chunk.finished = finishesChunk;  // when encrypting for uploads, only set finished after confirmation of the chunk uploading.
 }
 
+void chunkmac_map::ctr_encrypt(m_off_t chunkid, SymmCipher *cipher, const byte *src, byte *dst, unsigned chunksize, m_off_t startpos, int64_t ctriv, bool finishesChunk)
+{
+    assert(chunkid == startpos);
+    assert(startpos > macsmacSoFarPos);
+
+    // as above, but encrypting from a read-only source (e.g. a mapped file) into dst
+    auto& chunk = mMacMap[chunkid];
+    cipher->ctr_crypt(src, dst, unsigned(chunksize), startpos, ctriv, chunk.mac, true);
+    chunk.offset = 0;
+    chunk.finished = finishesChunk;  // when encrypting for uploads, only set finished after confirmation of the chunk uploading.
+}
+
 
 void chunkmac_map::ctr_decrypt(m_off_t chunkid, SymmCipher *cipher, byte *chunkstart, unsigned chunksize, m_off_t startpos, int64_t ctriv, bool finishesChunk)
 {
@@ -2598,29 +2611,114 @@ std::pair<bool, int64_t> generateMetaMac(SymmCipher &cipher, InputStreamAccess &
     static const unsigned int SZ_1024K = 1l << 20;
     static const unsigned int SZ_128K  = 128l << 10;
 
-    std::unique_ptr<byte[]> buffer(new byte[SZ_1024K + SymmCipher::BLOCKSIZE]);
     chunkmac_map chunkMacs;
     unsigned int chunkLength = 0;
     m_off_t current = 0;
     m_off_t remaining = isAccess.size();
 
+    // Each chunk's AES-CTR MAC depends only on its own data and position, so for
+    // large files we compute them on a few worker threads while this thread keeps
+    // reading.  Only the final meta-MAC reduction is order-dependent, and that is
+    // one AES block operation per chunk once the workers have finished.
+    struct Chunk
+    {
+        std::unique_ptr<byte[]> data;
+        unsigned int length = 0;
+        m_off_t pos = 0;
+    };
+
+    unsigned workers = std::min<unsigned>(std::thread::hardware_concurrency(), 4);
+    if (workers < 2 || remaining <= SZ_1024K * 4)
+    {
+        // not worth the thread startup, or reading is all there is to overlap with
+        workers = 0;
+    }
+
+    std::mutex chunkMutex;
+    std::condition_variable chunkCV;
+    std::deque<Chunk> pendingChunks;
+    bool complete = false;
+    std::vector<std::thread> threads;
+
+    for (unsigned i = workers; i--; )
+    {
+        threads.emplace_back([&]()
+        {
+            SymmCipher workerCipher(cipher);
+            chunkmac_map workerMacs;
+            for (;;)
+            {
+                Chunk chunk;
+                {
+                    std::unique_lock<std::mutex> lock(chunkMutex);
+                    chunkCV.wait(lock, [&]() { return complete || !pendingChunks.empty(); });
+                    if (pendingChunks.empty())
+                    {
+                        break;
+                    }
+                    chunk = std::move(pendingChunks.front());
+                    pendingChunks.pop_front();
+                }
+                chunkCV.notify_all();
+                workerMacs.ctr_encrypt(chunk.pos, &workerCipher, chunk.data.get(), chunk.length, chunk.pos, iv, true);
+            }
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            workerMacs.copyEntriesTo(chunkMacs);
+        });
+    }
+
+    bool readOk = true;
     while (remaining > 0)
     {
         chunkLength =
           std::min(chunkLength + SZ_128K,
                    static_cast<unsigned int>(std::min<m_off_t>(remaining, SZ_1024K)));
 
-        if (!isAccess.read(&buffer[0], chunkLength))
-            return std::make_pair(false, 0l);
+        std::unique_ptr<byte[]> buffer(new byte[chunkLength + SymmCipher::BLOCKSIZE]);
+
+        if (!isAccess.read(buffer.get(), chunkLength))
+        {
+            readOk = false;
+            break;
+        }
 
         memset(&buffer[chunkLength], 0, SymmCipher::BLOCKSIZE);
 
-        chunkMacs.ctr_encrypt(current, &cipher, buffer.get(), chunkLength, current, iv, true);
+        if (workers)
+        {
+            {
+                // bound the backlog so memory use stays at a few MB
+                std::unique_lock<std::mutex> lock(chunkMutex);
+                chunkCV.wait(lock, [&]() { return pendingChunks.size() < workers * 2; });
+                pendingChunks.emplace_back(Chunk{std::move(buffer), chunkLength, current});
+            }
+            chunkCV.notify_all();
+        }
+        else
+        {
+            chunkMacs.ctr_encrypt(current, &cipher, buffer.get(), chunkLength, current, iv, true);
+        }
 
         current += chunkLength;
         remaining -= chunkLength;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        complete = true;
+    }
+    chunkCV.notify_all();
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    if (!readOk)
+    {
+        return std::make_pair(false, 0l);
+    }
+
     return std::make_pair(true, chunkMacs.macsmac(&cipher));
 }
 
@@ -2640,7 +2738,7 @@ bool CompareLocalFileMetaMacWithNode(FileAccess* fa, Node* node)
     return CompareLocalFileMetaMacWithNodeKey(fa, node->nodekey(), node->type);
 }
 
-void MegaClientAsyncQueue::push(std::function<void(SymmCipher&)> f, bool discardable)
+void MegaClientAsyncQueue::push(std::function<void(SymmCipher&)> f, bool discardable, uint64_t affinity)
 {
     if (mThreads.empty())
     {
@@ -2653,8 +2751,11 @@ void MegaClientAsyncQueue::push(std::function<void(SymmCipher&)> f, bool discard
     {
         {
             std::lock_guard<std::mutex> g(mMutex);
-            mQueue.emplace_back(discardable, std::move(f));
+            size_t shard = affinity ? affinity % mShards.size()
+                                    : mNextShard++ % mShards.size();
+            mShards[shard].emplace_back(discardable, std::move(f));
         }
+        // any woken worker finds the job: its own shard first, stealing otherwise
         mConditionVariable.notify_one();
     }
 }
@@ -2662,17 +2763,19 @@ void MegaClientAsyncQueue::push(std::function<void(SymmCipher&)> f, bool discard
 MegaClientAsyncQueue::MegaClientAsyncQueue(Waiter& w, unsigned threadCount)
     : mWaiter(w)
 {
-    for (int i = threadCount; i--; )
+    mShards.resize(threadCount ? threadCount : 1);
+    for (unsigned i = 0; i < threadCount; ++i)
     {
         try
         {
-            mThreads.emplace_back([this]()
+            mThreads.emplace_back([this, i]()
             {
-                asyncThreadLoop();
+                asyncThreadLoop(i);
             });
         }
         catch (std::system_error& e)
         {
+            // an ownerless shard is harmless: its jobs get stolen
             LOG_err << "Failed to start worker thread: " << e.what();
             break;
         }
@@ -2683,7 +2786,10 @@ MegaClientAsyncQueue::MegaClientAsyncQueue(Waiter& w, unsigned threadCount)
 MegaClientAsyncQueue::~MegaClientAsyncQueue()
 {
     clearDiscardable();
-    push(nullptr, false);
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mExiting = true;    // workers drain every shard before exiting
+    }
     mConditionVariable.notify_all();
     LOG_warn << "~MegaClientAsyncQueue() joining threads";
     for (auto& t : mThreads)
@@ -2696,11 +2802,14 @@ MegaClientAsyncQueue::~MegaClientAsyncQueue()
 void MegaClientAsyncQueue::clearDiscardable()
 {
     std::lock_guard<std::mutex> g(mMutex);
-    auto newEnd = std::remove_if(mQueue.begin(), mQueue.end(), [](Entry& entry){ return entry.discardable; });
-    mQueue.erase(newEnd, mQueue.end());
+    for (auto& shard : mShards)
+    {
+        auto newEnd = std::remove_if(shard.begin(), shard.end(), [](Entry& entry){ return entry.discardable; });
+        shard.erase(newEnd, shard.end());
+    }
 }
 
-void MegaClientAsyncQueue::asyncThreadLoop()
+void MegaClientAsyncQueue::asyncThreadLoop(size_t shard)
 {
     SymmCipher cipher;
     for (;;)
@@ -2708,13 +2817,34 @@ void MegaClientAsyncQueue::asyncThreadLoop()
         std::function<void(SymmCipher&)> f;
         {
             std::unique_lock<std::mutex> g(mMutex);
-            mConditionVariable.wait(g, [this]() { return !mQueue.empty(); });
-            assert(!mQueue.empty());
-            f = std::move(mQueue.front().f);
-            if (!f) return;   // nullptr is not popped, and causes all the threads to exit
-            mQueue.pop_front();
+            mConditionVariable.wait(g, [this]()
+            {
+                return mExiting ||
+                       std::any_of(mShards.begin(), mShards.end(),
+                                   [](const std::deque<Entry>& q) { return !q.empty(); });
+            });
+
+            // own shard first: affinity keeps related jobs on this thread
+            std::deque<Entry>* source = &mShards[shard];
+            for (size_t i = 1; source->empty() && i < mShards.size(); ++i)
+            {
+                // steal the oldest job of the next loaded shard
+                source = &mShards[(shard + i) % mShards.size()];
+            }
+
+            if (source->empty())
+            {
+                assert(mExiting);
+                return;
+            }
+
+            f = std::move(source->front().f);
+            source->pop_front();
+        }
+        if (f)
+        {
+            f(cipher);
         }
-        f(cipher);
         mWaiter.notify();
     }
 }
@@ -3285,5 +3415,133 @@ bool is_digit(unsigned int ch)
     return std::isdigit(static_cast<unsigned char>(ch));
 }
 
+FixedBlockPool::FixedBlockPool(size_t blockSize, unsigned blocksPerSlab)
+    : mBlockSize(std::max(blockSize, sizeof(FreeBlock)))
+    , mBlocksPerSlab(blocksPerSlab)
+{
+}
+
+FixedBlockPool::~FixedBlockPool()
+{
+    for (char* slab : mSlabs)
+    {
+        ::operator delete(slab);
+    }
+}
+
+void FixedBlockPool::carveSlab()
+{
+    char* slab = static_cast<char*>(::operator new(mBlockSize * mBlocksPerSlab));
+    mSlabs.push_back(slab);
+
+    for (unsigned i = 0; i < mBlocksPerSlab; ++i)
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * mBlockSize);
+        block->mNext = mFreeList;
+        mFreeList = block;
+    }
+
+    mFreeBlocks += mBlocksPerSlab;
+}
+
+void* FixedBlockPool::allocate()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    if (!mFreeList)
+    {
+        carveSlab();
+    }
+
+    FreeBlock* block = mFreeList;
+    mFreeList = block->mNext;
+    --mFreeBlocks;
+    return block;
+}
+
+void FixedBlockPool::deallocate(void* p)
+{
+    if (!p)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->mNext = mFreeList;
+    mFreeList = block;
+    ++mFreeBlocks;
+}
+
+void FixedBlockPool::reserveBlocks(size_t count)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    while (mFreeBlocks < count)
+    {
+        carveSlab();
+    }
+}
+
+FixedBlockPool& FixedBlockPool::poolFor(size_t blockSize)
+{
+    static std::mutex poolsMutex;
+    static std::map<size_t, std::unique_ptr<FixedBlockPool>> pools;
+
+    std::lock_guard<std::mutex> g(poolsMutex);
+    auto& pool = pools[blockSize];
+    if (!pool)
+    {
+        pool.reset(new FixedBlockPool(blockSize));
+    }
+
+    return *pool;
+}
+
+std::string PerfCounters::report() const
+{
+    static const char* const names[PERF_COUNTERS] = {
+        "cs_requests",
+        "cs_inflight",
+        "sc_packets",
+        "sc_backlog_bytes",
+        "nodes_in_ram",
+        "node_cache_hits",
+        "node_cache_misses",
+        "bytes_downloaded",
+        "bytes_uploaded",
+        "chunk_retries",
+        "db_queries",
+        "db_query_time_us",
+        "listener_callbacks",
+        "listener_time_us",
+        "slow_listener_callbacks",
+    };
+
+    ostringstream s;
+    for (int c = 0; c < PERF_COUNTERS; c++)
+    {
+        s << names[c] << ":" << value(static_cast<perfcounter_t>(c)) << "\n";
+    }
+    return s.str();
+}
+
+std::string MemoryAccounting::report() const
+{
+    static const char* const names[MEM_SUBSYSTEMS] = {
+        "nodes",
+        "localnodes",
+        "transferbuffers",
+    };
+
+    ostringstream s;
+    for (int m = 0; m < MEM_SUBSYSTEMS; m++)
+    {
+        memsubsystem_t subsystem = static_cast<memsubsystem_t>(m);
+        s << names[m] << ": current=" << current(subsystem) << " peak=" << peak(subsystem) << "\n";
+    }
+    return s.str();
+}
+
 } // namespace mega
 
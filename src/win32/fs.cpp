@@ -1845,7 +1845,7 @@ bool  WinFileSystemAccess::checkForSymlink(const LocalPath& lp)
     return false;
 }
 
-ScanResult WinFileSystemAccess::directoryScan(const LocalPath& path, handle expectedFsid, map<LocalPath, FSNode>& known, std::vector<FSNode>& results, bool followSymLinks, unsigned& nFingerprinted)
+ScanResult WinFileSystemAccess::directoryScan(const LocalPath& path, handle expectedFsid, map<LocalPath, FSNode>& known, std::vector<FSNode>& results, bool followSymLinks, unsigned& nFingerprinted, std::vector<size_t>* deferredFingerprints)
 {
     assert(path.isAbsolute());
     assert(!followSymLinks && "Symlinks are not supported on Windows!");
@@ -1991,21 +1991,21 @@ ScanResult WinFileSystemAccess::directoryScan(const LocalPath& path, handle expe
                         result.fingerprint = std::move(it->second.fingerprint);
                         known.erase(it);
                     }
+                    else if (deferredFingerprints)
+                    {
+                        // Computed later by the ScanService's fingerprint
+                        // stage, overlapped with further discovery.
+                        deferredFingerprints->push_back(results.size());
+                    }
                     else
                     {
                         LocalPath p = path;
                         p.appendWithSeparator(result.localname, false);
-                        auto fa = newfileaccess();
-                        if (fa->fopen(p, true, false, FSLogging::logOnError))
+
+                        if (scanFingerprint(p, result))
                         {
-                            result.fingerprint.genfingerprint(fa.get());
                             nFingerprinted += 1;
                         }
-                        else
-                        {
-                            // The file may be opened exclusively by another process
-                            // In this case, the fingerprint (the crc portion) is invalid (for now)
-                        }
                     }
                 }
 
@@ -24,6 +24,7 @@
 
 namespace mega {
 dstime Waiter::ds;
+std::chrono::steady_clock::time_point Waiter::tickTime;
 
 WinWaiter::WinWaiter()
 {
@@ -40,7 +41,10 @@ WinWaiter::~WinWaiter()
 // FIXME: restore thread safety for applications using multiple MegaClient objects
 void Waiter::bumpds()
 {
-	ds = dstime(GetTickCount64() / 100);
+    tickTime = std::chrono::steady_clock::now();
+
+    ds = dstime(std::chrono::duration_cast<std::chrono::milliseconds>(
+             tickTime.time_since_epoch()).count() / 100);
 }
 
 // wait for events (socket, I/O completion, timeout + application events)
@@ -0,0 +1,133 @@
+/**
+ * @file wirecapture.cpp
+ * @brief capture of cs/sc traffic with timing, for record-and-replay analysis
+ *
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega/wirecapture.h"
+
+namespace mega {
+
+namespace {
+
+// JSON string escaping: backslash, quote, and control characters
+void appendEscaped(std::string& out, const std::string& s)
+{
+    for (char c : s)
+    {
+        if (c == '\\' || c == '"')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+}
+
+} // anonymous
+
+WireCapture& WireCapture::get()
+{
+    static WireCapture capture;
+    return capture;
+}
+
+bool WireCapture::start(const char* path)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (mFile)
+    {
+        return false;
+    }
+
+    mFile = fopen(path, "w");
+    if (!mFile)
+    {
+        return false;
+    }
+
+    mStart = std::chrono::steady_clock::now();
+    mCapturing.store(true, std::memory_order_release);
+    return true;
+}
+
+void WireCapture::stop()
+{
+    mCapturing.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> g(mMutex);
+    if (mFile)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+void WireCapture::record(const char* channel, const char* dir, const std::string& url, const std::string& data)
+{
+    // cs/sc completions are infrequent enough that writing straight through
+    // under the mutex is fine - no buffering needed
+    std::lock_guard<std::mutex> g(mMutex);
+    if (!mFile)
+    {
+        return;
+    }
+
+    int64_t t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - mStart).count();
+
+    std::string line;
+    line.reserve(data.size() + url.size() + 64);
+    line += "{\"t\":";
+    line += std::to_string(t);
+    line += ",\"ch\":\"";
+    line += channel;
+    line += "\",\"dir\":\"";
+    line += dir;
+    line += "\",\"url\":\"";
+    appendEscaped(line, url);
+    line += "\",\"data\":\"";
+    appendEscaped(line, data);
+    line += "\"}\n";
+
+    fwrite(line.data(), 1, line.size(), mFile);
+}
+
+std::string WireCapture::redactUrl(const std::string& url)
+{
+    std::string redacted = url;
+    size_t pos = redacted.find("sid=");
+    if (pos != std::string::npos)
+    {
+        size_t valstart = pos + 4;
+        size_t valend = redacted.find('&', valstart);
+        redacted.replace(valstart, valend == std::string::npos ? std::string::npos : valend - valstart, "REDACTED");
+    }
+    return redacted;
+}
+
+} // namespace
@@ -0,0 +1,239 @@
+/**
+ * (c) 2026 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+// Startup cost benchmark: runs the phases of the cold-start path (attribute
+// decryption, node (de)serialization, statecache writes and reads) over a
+// synthetic tree of parameterized size and reports per-phase timings, so
+// regressions in login/fetchnodes cost show up in numbers instead of bisects.
+//
+// Usage: test_benchmark [nodecount]     (default 100000)
+
+#include <mega.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace mega;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct PhaseTimer
+{
+    PhaseTimer(const char* name, size_t count)
+        : mName(name)
+        , mCount(count)
+        , mStart(Clock::now())
+    {
+    }
+
+    ~PhaseTimer()
+    {
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+        double perSecond = ms > 0 ? mCount * 1000.0 / ms : 0;
+        printf("%-24s %10.1f ms  %12.0f nodes/s\n", mName, ms, perSecond);
+    }
+
+    const char* mName;
+    size_t mCount;
+    Clock::time_point mStart;
+};
+
+struct BenchmarkHttpIo : HttpIO
+{
+    void addevents(Waiter*, int) override {}
+    void post(struct HttpReq*, const char* = NULL, unsigned = 0) override {}
+    void cancel(HttpReq*) override {}
+    m_off_t postpos(void*) override { return 0; }
+    bool doio() override { return false; }
+    void setuseragent(std::string*) override {}
+};
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    size_t count = 100000;
+    if (argc > 1)
+    {
+        count = static_cast<size_t>(atoll(argv[1]));
+        if (!count)
+        {
+            fprintf(stderr, "usage: %s [nodecount]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SimpleLogger::setLogLevel(logError);
+
+    MegaApp app;
+    BenchmarkHttpIo httpio;
+    auto waiter = std::make_shared<WAIT_CLASS>();
+    MegaClient client(&app, waiter, &httpio, nullptr, nullptr, "XXXXXXXXX", "benchmark", 0);
+
+    printf("benchmarking cold-start phases with %zu nodes\n\n", count);
+
+    // one folder per 128 files, all hanging off a single root, with the
+    // attribute shapes the real fetchnodes path produces
+    std::vector<std::shared_ptr<Node>> nodes;
+    nodes.reserve(count);
+    {
+        PhaseTimer timer("build synthetic tree", count);
+
+        NodeHandle rootHandle = NodeHandle().set6byte(1);
+        auto root = std::make_shared<Node>(client, rootHandle, NodeHandle(), FOLDERNODE, -1, 88, nullptr, 44);
+        root->setkey(reinterpret_cast<const byte*>(std::string(FOLDERNODEKEYLENGTH, 'K').c_str()));
+        root->attrs.map['n'] = "root";
+        nodes.push_back(root);
+
+        NodeHandle parentHandle = rootHandle;
+        for (size_t i = 2; nodes.size() < count; ++i)
+        {
+            NodeHandle handle = NodeHandle().set6byte(i);
+            if (!(i % 128))
+            {
+                auto folder = std::make_shared<Node>(client, handle, rootHandle, FOLDERNODE, -1, 88, nullptr, 44);
+                folder->setkey(reinterpret_cast<const byte*>(std::string(FOLDERNODEKEYLENGTH, 'K').c_str()));
+                folder->attrs.map['n'] = "folder_" + std::to_string(i);
+                nodes.push_back(folder);
+                parentHandle = handle;
+            }
+            else
+            {
+                auto file = std::make_shared<Node>(client, handle, parentHandle, FILENODE, static_cast<m_off_t>(i) * 1024, 88, nullptr, 44);
+                file->setkey(reinterpret_cast<const byte*>(std::string(FILENODEKEYLENGTH, 'K').c_str()));
+                file->attrs.map['n'] = "file_" + std::to_string(i) + ".dat";
+                file->attrs.map['c'] = "fingerprintfingerprint";
+                nodes.push_back(file);
+            }
+        }
+    }
+
+    // attribute decryption, as done when applying node keys
+    {
+        byte keyBytes[FILENODEKEYLENGTH];
+        client.rng.genblock(keyBytes, sizeof(keyBytes));
+        SymmCipher cipher(keyBytes);
+
+        std::string attrstring;
+        MegaClient::makeattr(&cipher, &attrstring, "{\"n\":\"benchmark file name.dat\"}");
+
+        PhaseTimer timer("decrypt attributes", count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            byte* buf = Node::decryptattr(&cipher, attrstring.data(), attrstring.size());
+            if (!buf)
+            {
+                fprintf(stderr, "attribute decryption failed\n");
+                return 1;
+            }
+            delete[] buf;
+        }
+    }
+
+    std::vector<std::string> blobs(nodes.size());
+    {
+        PhaseTimer timer("serialize nodes", nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (!nodes[i]->serialize(&blobs[i]))
+            {
+                fprintf(stderr, "node serialization failed\n");
+                return 1;
+            }
+        }
+    }
+
+#ifdef USE_SQLITE
+    {
+        FSACCESS_CLASS fsaccess;
+        SqliteDbAccess dbaccess(LocalPath::fromRelativePath("."));
+        std::unique_ptr<DbTable> table(dbaccess.openTableWithNodes(client.rng, fsaccess,
+                                                                   "benchmark", 0, nullptr));
+        if (!table)
+        {
+            fprintf(stderr, "unable to open benchmark database\n");
+            return 1;
+        }
+
+        DBTableNodes* nodeTable = dynamic_cast<DBTableNodes*>(table.get());
+        assert(nodeTable);
+
+        table->begin();
+        {
+            PhaseTimer timer("statecache write", nodes.size());
+            for (auto& node : nodes)
+            {
+                nodeTable->put(node.get());
+            }
+            table->commit();
+        }
+
+        {
+            std::vector<std::pair<NodeHandle, NodeSerialized>> records;
+            PhaseTimer timer("statecache read", nodes.size());
+            nodeTable->getAllNodes(records);
+            if (records.size() != nodes.size())
+            {
+                fprintf(stderr, "statecache returned %zu of %zu records\n",
+                        records.size(), nodes.size());
+                return 1;
+            }
+        }
+
+        table->remove();   // leave no benchmark db behind
+    }
+#endif
+
+    std::vector<std::shared_ptr<Node>> unserialized;
+    unserialized.reserve(blobs.size());
+    {
+        std::list<std::unique_ptr<NewShare>> ownNewshares;
+        PhaseTimer timer("unserialize nodes", blobs.size());
+        for (auto& blob : blobs)
+        {
+            auto node = Node::unserialize(client, &blob, true, ownNewshares);
+            if (!node)
+            {
+                fprintf(stderr, "node unserialization failed\n");
+                return 1;
+            }
+            unserialized.push_back(std::move(node));
+        }
+    }
+
+    {
+        // first access parses the deferred attribute blobs
+        size_t attrCount = 0;
+        PhaseTimer timer("materialize attributes", unserialized.size());
+        for (auto& node : unserialized)
+        {
+            attrCount += node->attrs.map.size();
+        }
+        if (attrCount < unserialized.size())
+        {
+            fprintf(stderr, "unexpected attribute count %zu\n", attrCount);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,376 @@
+/**
+ * (c) 2026 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+// Microbenchmarks for the proven hot kernels: JSON cursor operations, Base64,
+// AES-CTR payload crypto, fingerprinting, node (de)serialization, attribute
+// map parsing and LocalPath construction. Inputs are deterministic so numbers
+// are comparable across commits.
+//
+// Built as test_microbench when the google benchmark library is available.
+
+#include <benchmark/benchmark.h>
+
+#include <mega.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mega;
+
+namespace {
+
+// deterministic corpus bytes (stable across runs and platforms)
+std::string makeBlob(size_t len)
+{
+    std::string blob(len, 0);
+    uint64_t x = 0x9e3779b97f4a7c15ull;
+    for (size_t i = 0; i < len; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        blob[i] = static_cast<char>(x & 0xff);
+    }
+    return blob;
+}
+
+struct BenchmarkHttpIo : HttpIO
+{
+    void addevents(Waiter*, int) override {}
+    void post(struct HttpReq*, const char* = NULL, unsigned = 0) override {}
+    void cancel(HttpReq*) override {}
+    m_off_t postpos(void*) override { return 0; }
+    bool doio() override { return false; }
+    void setuseragent(std::string*) override {}
+};
+
+// a MegaClient is needed as context for Node (de)serialization
+MegaClient& benchClient()
+{
+    static MegaApp app;
+    static BenchmarkHttpIo httpio;
+    static auto waiter = std::make_shared<WAIT_CLASS>();
+    static MegaClient client(&app, waiter, &httpio, nullptr, nullptr, "XXXXXXXXX", "benchmark", 0);
+    return client;
+}
+
+std::shared_ptr<Node> makeBenchNode()
+{
+    MegaClient& client = benchClient();
+    auto node = std::make_shared<Node>(client, NodeHandle().set6byte(7), NodeHandle().set6byte(1),
+                                       FILENODE, 1024 * 1024, 88, nullptr, 44);
+    node->setkey(reinterpret_cast<const byte*>(std::string(FILENODEKEYLENGTH, 'K').c_str()));
+    node->attrs.map['n'] = "benchmark file name.dat";
+    node->attrs.map['c'] = "fingerprintfingerprint";
+    node->attrs.map[AttrMap::string2nameid("fav")] = "1";
+    node->attrs.map[AttrMap::string2nameid("lbl")] = "3";
+    return node;
+}
+
+class MemoryInputStream : public InputStreamAccess
+{
+    const std::string& mData;
+    size_t mOffset = 0;
+
+public:
+    MemoryInputStream(const std::string& data)
+        : mData(data)
+    {
+    }
+
+    void rewind()
+    {
+        mOffset = 0;
+    }
+
+    m_off_t size() override
+    {
+        return static_cast<m_off_t>(mData.size());
+    }
+
+    bool read(byte* buffer, unsigned size) override
+    {
+        if (mOffset + size > mData.size())
+        {
+            return false;
+        }
+        if (buffer)
+        {
+            memcpy(buffer, mData.data() + mOffset, size);
+        }
+        mOffset += size;
+        return true;
+    }
+};
+
+// synthetic actionpacket-shaped array, as procsc would walk it
+std::string makeJsonCorpus()
+{
+    std::string s = "[";
+    for (int i = 0; i < 512; ++i)
+    {
+        if (i)
+        {
+            s += ",";
+        }
+        s += "{\"a\":\"u\",\"n\":\"AbCdEfGh\",\"u\":\"MnOpQrStUvW\",\"ts\":1234567890,"
+             "\"at\":\"QmVuY2htYXJrIGF0dHJpYnV0ZSBibG9iIHdpdGggYSByZWFsaXN0aWMgbGVuZ3Ro\"}";
+    }
+    s += "]";
+    return s;
+}
+
+void BM_JsonCursor(benchmark::State& state)
+{
+    static const std::string corpus = makeJsonCorpus();
+
+    for (auto _ : state)
+    {
+        JSON j;
+        j.begin(corpus.c_str());
+        j.enterarray();
+
+        int objects = 0;
+        std::string value;
+        while (j.enterobject())
+        {
+            nameid name;
+            while ((name = j.getnameid()) != EOO)
+            {
+                j.storeobject(&value);
+            }
+            j.leaveobject();
+            ++objects;
+        }
+        j.leavearray();
+        benchmark::DoNotOptimize(objects);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(corpus.size()));
+}
+BENCHMARK(BM_JsonCursor);
+
+void BM_Base64Encode(benchmark::State& state)
+{
+    const std::string in = makeBlob(static_cast<size_t>(state.range(0)));
+    std::string out;
+
+    for (auto _ : state)
+    {
+        Base64::btoa(in, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Base64Encode)->Range(64, 64 << 10);
+
+void BM_Base64Decode(benchmark::State& state)
+{
+    std::string encoded;
+    Base64::btoa(makeBlob(static_cast<size_t>(state.range(0))), encoded);
+    std::string out;
+
+    for (auto _ : state)
+    {
+        Base64::atob(encoded, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Base64Decode)->Range(64, 64 << 10);
+
+void BM_CtrCrypt(benchmark::State& state)
+{
+    const std::string key = makeBlob(SymmCipher::KEYLENGTH);
+    SymmCipher cipher(reinterpret_cast<const byte*>(key.data()));
+
+    std::string payload = makeBlob(static_cast<size_t>(state.range(0)));
+    byte mac[SymmCipher::BLOCKSIZE];
+
+    for (auto _ : state)
+    {
+        cipher.ctr_crypt(reinterpret_cast<byte*>(&payload[0]),
+                         static_cast<unsigned>(payload.size()),
+                         0, 0x0123456789abcdefull, mac, true);
+        benchmark::DoNotOptimize(payload.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_CtrCrypt)->Range(4 << 10, 1 << 20);
+
+void BM_GenFingerprint(benchmark::State& state)
+{
+    const std::string data = makeBlob(static_cast<size_t>(state.range(0)));
+    MemoryInputStream stream(data);
+
+    for (auto _ : state)
+    {
+        stream.rewind();
+        FileFingerprint fp;
+        fp.genfingerprint(&stream, 1234567890);
+        benchmark::DoNotOptimize(fp.crc);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_GenFingerprint)->Range(16 << 10, 16 << 20);
+
+void BM_NodeSerialize(benchmark::State& state)
+{
+    auto node = makeBenchNode();
+    std::string blob;
+
+    for (auto _ : state)
+    {
+        blob.clear();
+        node->serialize(&blob);
+        benchmark::DoNotOptimize(blob.data());
+    }
+}
+BENCHMARK(BM_NodeSerialize);
+
+void BM_NodeUnserialize(benchmark::State& state)
+{
+    std::string blob;
+    makeBenchNode()->serialize(&blob);
+
+    for (auto _ : state)
+    {
+        std::list<std::unique_ptr<NewShare>> ownNewshares;
+        auto node = Node::unserialize(benchClient(), &blob, true, ownNewshares);
+        benchmark::DoNotOptimize(node.get());
+    }
+}
+BENCHMARK(BM_NodeUnserialize);
+
+void BM_AttrMapUnserialize(benchmark::State& state)
+{
+    std::string blob;
+    makeBenchNode()->attrs.serialize(&blob);
+
+    for (auto _ : state)
+    {
+        AttrMap attrs;
+        attrs.unserialize(blob.data(), blob.data() + blob.size());
+        benchmark::DoNotOptimize(attrs.map.size());   // force materialization
+    }
+}
+BENCHMARK(BM_AttrMapUnserialize);
+
+void BM_AttrMapGetJson(benchmark::State& state)
+{
+    auto node = makeBenchNode();
+    std::string json;
+
+    for (auto _ : state)
+    {
+        json.clear();
+        node->attrs.getjson(&json);
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_AttrMapGetJson);
+
+void BM_LocalPathBuild(benchmark::State& state)
+{
+    const std::string components[] = { "benchmark", "corpus", "sub_directory",
+                                       "file_name_with_unicode_\xC3\xA9.dat" };
+
+    for (auto _ : state)
+    {
+        LocalPath path = LocalPath::fromRelativePath("root");
+        for (const std::string& component : components)
+        {
+            path.appendWithSeparator(LocalPath::fromRelativePath(component), true);
+        }
+        std::string utf8 = path.toPath(true);
+        benchmark::DoNotOptimize(utf8.data());
+    }
+}
+BENCHMARK(BM_LocalPathBuild);
+
+// erase-while-iterating on a plain deque, as the transfer queues once did:
+// every mid-deque erase shuffles the remaining elements
+void BM_DequeEraseScattered(benchmark::State& state)
+{
+    const size_t count = size_t(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::deque<int> dq;
+        for (size_t i = 0; i < count; ++i)
+        {
+            dq.push_back(int(i));
+        }
+        state.ResumeTiming();
+
+        for (auto it = dq.begin(); it != dq.end();)
+        {
+            if (*it & 1)
+            {
+                it = dq.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        benchmark::DoNotOptimize(dq.size());
+    }
+}
+BENCHMARK(BM_DequeEraseScattered)->Range(1 << 10, 1 << 17);
+
+// the same cancellation pattern through deque_with_lazy_bulk_erase: erases
+// only mark, and one remove_if compacts at the end
+void BM_LazyBulkEraseScattered(benchmark::State& state)
+{
+    const size_t count = size_t(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        deque_with_lazy_bulk_erase<int> dq;
+        for (size_t i = 0; i < count; ++i)
+        {
+            dq.push_back(int(i));
+        }
+        state.ResumeTiming();
+
+        for (auto it = dq.begin(true); it != dq.end(true); ++it)
+        {
+            int value = *it;
+            if (value & 1)
+            {
+                dq.erase(it);
+            }
+        }
+        dq.applyErase();
+        benchmark::DoNotOptimize(dq.size());
+    }
+}
+BENCHMARK(BM_LazyBulkEraseScattered)->Range(1 << 10, 1 << 17);
+
+} // anonymous namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,206 @@
+/**
+ * (c) 2026 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+// Replay driver for wire captures (MegaApi::startWireCapture): feeds the
+// recorded sc stream through MegaClient::procsc() with a mock HttpIO at a
+// configurable speed-up, turning "the app was slow during yesterday's share
+// storm" into a benchmark case that runs on a desk. Node attributes stay in
+// their captured (encrypted) form - without the account keys they cannot be
+// decrypted - so this measures the parse/apply/notify pipeline, which is
+// where procsc time goes.
+//
+// Usage: test_replay <capture.jsonl> [speedup]
+//   speedup 0 (the default) replays as fast as possible; N plays the
+//   recorded timeline N times faster than real time.
+
+#include <mega.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mega;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct CaptureEvent
+{
+    int64_t t = 0;      // ms since capture start
+    std::string channel;
+    std::string dir;
+    std::string data;
+};
+
+struct ReplayHttpIo : HttpIO
+{
+    void addevents(Waiter*, int) override {}
+    void post(struct HttpReq*, const char* = NULL, unsigned = 0) override {}
+    void cancel(HttpReq*) override {}
+    m_off_t postpos(void*) override { return 0; }
+    bool doio() override { return false; }
+    void setuseragent(std::string*) override {}
+};
+
+// extracts the value of a "name":"..." string field, JSON-unescaped
+bool extractString(const std::string& line, const char* name, std::string* value)
+{
+    std::string tag = std::string("\"") + name + "\":\"";
+    size_t pos = line.find(tag);
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+
+    value->clear();
+    for (size_t i = pos + tag.size(); i < line.size(); i++)
+    {
+        char c = line[i];
+        if (c == '"')
+        {
+            return true;
+        }
+        if (c == '\\' && i + 1 < line.size())
+        {
+            char next = line[++i];
+            if (next == 'u' && i + 4 < line.size())
+            {
+                *value += static_cast<char>(strtol(line.substr(i + 1, 4).c_str(), nullptr, 16));
+                i += 4;
+            }
+            else
+            {
+                *value += next;
+            }
+        }
+        else
+        {
+            *value += c;
+        }
+    }
+    return false;   // unterminated
+}
+
+bool loadCapture(const char* path, std::vector<CaptureEvent>* events)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        CaptureEvent ev;
+        size_t tpos = line.find("\"t\":");
+        if (tpos == std::string::npos ||
+            !extractString(line, "ch", &ev.channel) ||
+            !extractString(line, "dir", &ev.dir) ||
+            !extractString(line, "data", &ev.data))
+        {
+            continue;
+        }
+        ev.t = atoll(line.c_str() + tpos + 4);
+        events->push_back(std::move(ev));
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <capture.jsonl> [speedup]\n", argv[0]);
+        return 1;
+    }
+
+    int64_t speedup = argc > 2 ? atoll(argv[2]) : 0;
+
+    std::vector<CaptureEvent> events;
+    if (!loadCapture(argv[1], &events))
+    {
+        fprintf(stderr, "cannot read capture file: %s\n", argv[1]);
+        return 1;
+    }
+
+    SimpleLogger::setLogLevel(logError);
+
+    MegaApp app;
+    ReplayHttpIo httpio;
+    auto waiter = std::make_shared<WAIT_CLASS>();
+    MegaClient client(&app, waiter, &httpio, nullptr, nullptr, "XXXXXXXXX", "replay", 0);
+
+    size_t scResponses = 0;
+    int64_t lastT = -1;
+    Clock::time_point begin = Clock::now();
+
+    for (const CaptureEvent& ev : events)
+    {
+        if (ev.channel != "sc" || ev.dir != "in" || ev.data.empty())
+        {
+            continue;
+        }
+
+        if (speedup > 0 && lastT >= 0 && ev.t > lastT)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds((ev.t - lastT) / speedup));
+        }
+        lastT = ev.t;
+
+        WAIT_CLASS::bumpds();
+
+        // what exec() does when a pendingsc response arrives, minus the
+        // HttpReq itself: the payload lives in the event until fully parsed
+        client.mScResponseArrival = Waiter::tickTime;
+        client.performanceStats.scBytesAtArrival.record(ev.data.size());
+        client.jsonsc.begin(ev.data.c_str());
+        client.jsonsc.enterobject();
+
+        while (client.jsonsc.pos)
+        {
+            if (client.procsc())
+            {
+                client.jsonsc.pos = nullptr;
+            }
+            WAIT_CLASS::bumpds();
+        }
+
+        client.notifypurge();
+        scResponses++;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+    printf("replayed %zu sc responses in %.1f ms", scResponses, ms);
+    if (lastT > 0)
+    {
+        printf(" (recorded span %lld ms)", static_cast<long long>(lastT));
+    }
+    printf("\n\n%s", PerfCounters::get().report().c_str());
+    printf("sc arrival to parse ms: %s\n", client.performanceStats.scArrivalToParse.report().c_str());
+    printf("sc arrival to delivery ms: %s\n", client.performanceStats.scArrivalToDelivery.report().c_str());
+    return 0;
+}
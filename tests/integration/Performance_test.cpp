@@ -0,0 +1,330 @@
+/**
+ * @file tests/integration/Performance_test.cpp
+ * @brief Timed performance scenarios with recorded baselines
+ *
+ * (c) 2024 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "SdkTest_test.h"
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+// These scenarios time representative SDK operations against a real (staging) API
+// and fail when an operation regresses past a recorded baseline, so that a slowdown
+// is caught by the same harness that checks correctness. They are skipped unless
+// MEGA_PERF_SCENARIOS is set, so ordinary test runs are unaffected.
+//
+// Environment:
+//  - MEGA_PERF_SCENARIOS   run the scenarios (otherwise every test skips)
+//  - MEGA_PERF_BASELINE    path of the baseline file (default: <test data dir>/perf_baseline.txt)
+//  - MEGA_PERF_RECORD      record measured times as the new baselines instead of comparing
+//  - MEGA_PERF_THRESHOLD   allowed slowdown factor over the baseline (default: 1.5)
+//
+// The baseline file holds one "<scenario name> <seconds>" entry per line. Record
+// baselines on the machine that will run the comparisons: absolute times depend on
+// the host and its network path to the API, so baselines are not portable.
+
+// defined in SdkTest_test.cpp
+bool WaitFor(const std::function<bool()>& predicate, unsigned timeoutMs);
+#ifdef ENABLE_SYNC
+std::unique_ptr<::mega::MegaSync> waitForSyncState(::mega::MegaApi* megaApi, ::mega::MegaNode* remoteNode, ::mega::MegaSync::SyncRunningState runState, MegaSync::Error err);
+#endif
+
+namespace
+{
+
+double perfThreshold()
+{
+    if (const char* t = getenv("MEGA_PERF_THRESHOLD"))
+    {
+        double v = atof(t);
+        if (v > 1.0)
+        {
+            return v;
+        }
+    }
+    return 1.5;
+}
+
+fs::path perfBaselinePath()
+{
+    if (const char* p = getenv("MEGA_PERF_BASELINE"))
+    {
+        return fs::path(p);
+    }
+    return getTestDataDir() / "perf_baseline.txt";
+}
+
+std::map<std::string, double> loadPerfBaselines(const fs::path& path)
+{
+    std::map<std::string, double> baselines;
+    std::ifstream in(path.u8string());
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream is(line);
+        std::string name;
+        double seconds;
+        if (is >> name >> seconds)
+        {
+            baselines[name] = seconds;
+        }
+    }
+    return baselines;
+}
+
+void savePerfBaselines(const fs::path& path, const std::map<std::string, double>& baselines)
+{
+    std::ofstream out(path.u8string(), std::ios::trunc);
+    for (const auto& entry : baselines)
+    {
+        out << entry.first << " " << entry.second << "\n";
+    }
+}
+
+} // anonymous namespace
+
+class SdkTestPerformance : public SdkTest
+{
+protected:
+    void SetUp() override
+    {
+        if (!getenv("MEGA_PERF_SCENARIOS"))
+        {
+            GTEST_SKIP() << "Performance scenarios are disabled (set MEGA_PERF_SCENARIOS=1 to run them)";
+        }
+        SdkTest::SetUp();
+    }
+
+    // Times scenario() and checks the elapsed time against the recorded baseline
+    // for that name. With MEGA_PERF_RECORD set the measured time replaces the
+    // baseline instead; without a baseline entry the measurement is only logged.
+    void runScenario(const std::string& name, const std::function<void()>& scenario)
+    {
+        auto start = std::chrono::steady_clock::now();
+        scenario();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (::testing::Test::HasFatalFailure())
+        {
+            return; // the scenario itself failed; its timing is meaningless
+        }
+
+        auto baselines = loadPerfBaselines(perfBaselinePath());
+        if (getenv("MEGA_PERF_RECORD"))
+        {
+            baselines[name] = seconds;
+            savePerfBaselines(perfBaselinePath(), baselines);
+            LOG_info << "Perf scenario '" << name << "': recorded baseline " << seconds << " s";
+            return;
+        }
+
+        auto it = baselines.find(name);
+        if (it == baselines.end())
+        {
+            LOG_warn << "Perf scenario '" << name << "': no baseline recorded, measured " << seconds
+                     << " s (run with MEGA_PERF_RECORD=1 to record one)";
+            return;
+        }
+
+        LOG_info << "Perf scenario '" << name << "': " << seconds << " s (baseline " << it->second
+                 << " s, threshold x" << perfThreshold() << ")";
+        EXPECT_LE(seconds, it->second * perfThreshold())
+                << "Perf scenario '" << name << "' took " << seconds << " s, more than "
+                << perfThreshold() << "x its baseline of " << it->second << " s";
+    }
+};
+
+/**
+ * @brief TEST_F SdkTestPerfBulkUpload
+ *
+ * Times uploading a batch of small files started concurrently, the pattern of a
+ * camera-upload burst or a folder drop.
+ */
+TEST_F(SdkTestPerformance, SdkTestPerfBulkUpload)
+{
+    LOG_info << "___TEST PerfBulkUpload___";
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    std::unique_ptr<MegaNode> rootnode(megaApi[0]->getRootNode());
+    auto nh = createFolder(0, "perf_bulk_upload", rootnode.get());
+    ASSERT_NE(nh, UNDEF) << "Couldn't create remote folder for the upload batch";
+    std::unique_ptr<MegaNode> folder(megaApi[0]->getNodeByHandle(nh));
+    ASSERT_TRUE(folder);
+
+    const unsigned numFiles = 10;
+    std::vector<std::string> filenames;
+    for (unsigned i = 0; i < numFiles; ++i)
+    {
+        filenames.push_back("perf_upload_" + std::to_string(i) + ".txt");
+        ASSERT_TRUE(createFile(filenames.back(), false)) << "Couldn't create " << filenames.back();
+    }
+
+    runScenario("bulk_upload", [&]()
+    {
+        std::vector<std::unique_ptr<TransferTracker>> trackers;
+        for (const auto& filename : filenames)
+        {
+            trackers.push_back(::mega::make_unique<TransferTracker>(megaApi[0].get()));
+            megaApi[0]->startUpload(filename.c_str(),
+                                    folder.get(),
+                                    nullptr /*fileName*/,
+                                    ::mega::MegaApi::INVALID_CUSTOM_MOD_TIME,
+                                    nullptr /*appData*/,
+                                    false   /*isSourceTemporary*/,
+                                    false   /*startFirst*/,
+                                    nullptr /*cancelToken*/,
+                                    trackers.back().get());
+        }
+        for (auto& tracker : trackers)
+        {
+            ASSERT_EQ(API_OK, tracker->waitForResult()) << "Upload failed within the batch";
+        }
+    });
+
+    for (const auto& filename : filenames)
+    {
+        deleteFile(filename);
+    }
+    ASSERT_EQ(API_OK, doDeleteNode(0, folder.get()));
+}
+
+/**
+ * @brief TEST_F SdkTestPerfFetchNodes
+ *
+ * Times fetchnodes on a resumed session, the dominant cost of every app start.
+ * Run it against a seeded account to make the measurement representative.
+ */
+TEST_F(SdkTestPerformance, SdkTestPerfFetchNodes)
+{
+    LOG_info << "___TEST PerfFetchNodes___";
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    std::unique_ptr<char[]> session(dumpSession());
+
+    ASSERT_NO_FATAL_FAILURE( locallogout() );
+    ASSERT_NO_FATAL_FAILURE( resumeSession(session.get()) );
+
+    runScenario("fetchnodes", [this]()
+    {
+        ASSERT_NO_FATAL_FAILURE( fetchnodes(0) );
+    });
+}
+
+/**
+ * @brief TEST_F SdkTestPerfSearch
+ *
+ * Times repeated node searches by name over the local node tree, the operation
+ * behind an interactive search box.
+ */
+TEST_F(SdkTestPerformance, SdkTestPerfSearch)
+{
+    LOG_info << "___TEST PerfSearch___";
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    std::unique_ptr<MegaNode> rootnode(megaApi[0]->getRootNode());
+    const unsigned numFolders = 5;
+    for (unsigned i = 0; i < numFolders; ++i)
+    {
+        std::string name = "perf_search_" + std::to_string(i);
+        ASSERT_NE(createFolder(0, name.c_str(), rootnode.get()), UNDEF) << "Couldn't create " << name;
+    }
+
+    const unsigned numSearches = 100;
+    runScenario("search", [&]()
+    {
+        for (unsigned i = 0; i < numSearches; ++i)
+        {
+            std::unique_ptr<MegaSearchFilter> filter(MegaSearchFilter::createInstance());
+            filter->byName("perf_search");
+            std::unique_ptr<MegaNodeList> results(megaApi[0]->search(filter.get()));
+            ASSERT_TRUE(results);
+            ASSERT_GE(static_cast<unsigned>(results->size()), numFolders);
+        }
+    });
+
+    for (unsigned i = 0; i < numFolders; ++i)
+    {
+        std::string name = "perf_search_" + std::to_string(i);
+        std::unique_ptr<MegaNode> folder(megaApi[0]->getChildNode(rootnode.get(), name.c_str()));
+        ASSERT_TRUE(folder);
+        ASSERT_EQ(API_OK, doDeleteNode(0, folder.get()));
+    }
+}
+
+#ifdef ENABLE_SYNC
+/**
+ * @brief TEST_F SdkTestPerfSyncTree
+ *
+ * Times the initial sync of a locally generated tree: from adding the sync until
+ * every generated file and folder exists in the cloud.
+ */
+TEST_F(SdkTestPerformance, SdkTestPerfSyncTree)
+{
+    LOG_info << "___TEST PerfSyncTree___";
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    // --- Generate the local tree ---
+    const unsigned numFolders = 3;
+    const unsigned filesPerFolder = 5;
+    fs::path localRoot = fs::current_path() / "perf_sync_tree";
+    std::error_code ignoredEc;
+    fs::remove_all(localRoot, ignoredEc);
+    for (unsigned i = 0; i < numFolders; ++i)
+    {
+        fs::path folder = localRoot / ("folder_" + std::to_string(i));
+        ASSERT_TRUE(fs::create_directories(folder));
+        for (unsigned j = 0; j < filesPerFolder; ++j)
+        {
+            std::ofstream f((folder / ("file_" + std::to_string(j) + ".txt")).u8string());
+            f << "perf sync tree test data " << i << " " << j;
+            ASSERT_TRUE(f.good());
+        }
+    }
+
+    std::unique_ptr<MegaNode> rootnode(megaApi[0]->getRootNode());
+    auto nh = createFolder(0, "perf_sync_tree", rootnode.get());
+    ASSERT_NE(nh, UNDEF) << "Couldn't create remote sync root";
+    std::unique_ptr<MegaNode> remoteNode(megaApi[0]->getNodeByHandle(nh));
+    ASSERT_TRUE(remoteNode);
+
+    const unsigned expectedNodes = numFolders + numFolders * filesPerFolder;
+    runScenario("sync_tree", [&]()
+    {
+        ASSERT_EQ(API_OK, synchronousSyncFolder(0, nullptr, MegaSync::TYPE_TWOWAY,
+                                                localRoot.u8string().c_str(), nullptr, nh, nullptr))
+                << "API Error adding a new sync";
+        ASSERT_TRUE(waitForSyncState(megaApi[0].get(), remoteNode.get(),
+                                     MegaSync::RUNSTATE_RUNNING, MegaSync::NO_SYNC_ERROR));
+
+        // wait until every generated node exists in the cloud
+        ASSERT_TRUE(WaitFor([&]()
+        {
+            std::unique_ptr<MegaSearchFilter> filter(MegaSearchFilter::createInstance());
+            filter->byLocationHandle(nh);
+            std::unique_ptr<MegaNodeList> uploaded(megaApi[0]->search(filter.get()));
+            return uploaded && static_cast<unsigned>(uploaded->size()) >= expectedNodes;
+        }, 120*1000)) << "the generated tree did not finish uploading";
+    });
+
+    ASSERT_EQ(API_OK, synchronousRemoveSync(0, mApi[0].lastSyncBackupId)) << "API Error removing the sync";
+    fs::remove_all(localRoot, ignoredEc);
+    ASSERT_EQ(API_OK, doDeleteNode(0, remoteNode.get()));
+}
+#endif // ENABLE_SYNC
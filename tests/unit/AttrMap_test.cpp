@@ -60,4 +60,32 @@ TEST(AttrMap, unserialize_32bit)
 
     ASSERT_EQ(expMap.map, newMap.map);
 }
-#endif
\ No newline at end of file
+#endif
+TEST(AttrMap, getquick_pointerSurvivesMaterialization)
+{
+    mega::AttrMap map;
+    map.map = std::map<mega::nameid, std::string>{
+        {'n', "IMG_20240101_123456_verylongname.jpg"},
+        {42, "blah"},
+    };
+
+    std::string d;
+    map.serialize(&d);
+
+    mega::AttrMap lazy;
+    lazy.unserialize(d.c_str(), d.c_str() + d.size());
+    ASSERT_TRUE(lazy.map.pending());
+
+    const std::string* name = lazy.map.getquick('n');
+    ASSERT_NE(nullptr, name);
+    ASSERT_EQ("IMG_20240101_123456_verylongname.jpg", *name);
+
+    // repeated probes serve the same cached entry
+    ASSERT_EQ(name, lazy.map.getquick('n'));
+
+    // materializing the full map must not invalidate handed-out pointers
+    ASSERT_EQ(size_t(2), lazy.map.size());
+    ASSERT_FALSE(lazy.map.pending());
+    ASSERT_EQ("IMG_20240101_123456_verylongname.jpg", *name);
+    ASSERT_EQ(nullptr, lazy.map.getquick(13));
+}
@@ -830,3 +830,65 @@ TEST(CacheLRU, reduceCacheLRUSize)
     ASSERT_EQ(client->mNodeManager.getNodeCount(), numNodes + 4);
 
 }
+
+TEST(CacheLRU, byteBudgetAndPinnedNodes)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), &rootNode);
+    std::shared_ptr<mega::Node> auxiliarNode(&folder);
+    client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+
+    uint32_t numNodes = 20;
+    mega::NodeHandle pinnedHandle;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &folder);
+        file.size = index;
+        std::string name = "name" + std::to_string(index);
+        file.attrs.map = std::map<mega::nameid, std::string>{{110, name}};
+        if (i == 0)
+        {
+            pinnedHandle = file.nodeHandle();
+        }
+        auxiliarNode.reset(&file);
+        client->mNodeManager.addNode(auxiliarNode, true, false, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+    }
+
+    // no byte budget yet -> every node accounted and kept
+    ASSERT_EQ(client->mNodeManager.getNumNodesAtCacheLRU(), numNodes + 2);
+    ASSERT_GT(client->mNodeManager.getCacheLRUUsedBytes(), 0u);
+
+    // pin the oldest file node and set a budget that forces evictions
+    client->mNodeManager.pinNodeToCacheLRU(pinnedHandle);
+    uint64_t budget = client->mNodeManager.getCacheLRUUsedBytes() / 4;
+    client->mNodeManager.setCacheLRUMaxBytes(budget);
+
+    ASSERT_LE(client->mNodeManager.getCacheLRUUsedBytes(), budget);
+    ASSERT_LT(client->mNodeManager.getNumNodesAtCacheLRU(), numNodes + 2);
+
+    // the pinned node must have survived the eviction
+    uint64_t hitsBefore = client->mNodeManager.getCacheLRUHits();
+    ASSERT_NE(client->mNodeManager.getNodeByHandle(pinnedHandle), nullptr);
+    ASSERT_EQ(client->mNodeManager.getCacheLRUHits(), hitsBefore + 1);
+
+    // unpinning allows the node to be evicted on the next budget check
+    client->mNodeManager.unpinNodeFromCacheLRU(pinnedHandle);
+    ASSERT_LE(client->mNodeManager.getCacheLRUUsedBytes(), budget);
+}
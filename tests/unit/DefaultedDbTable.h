@@ -59,6 +59,10 @@ public:
     {
         return false;
     }
+    bool getHandleByFingerprint(const std::string&, mega::NodeHandle&) override
+    {
+        return false;
+    }
     bool getNodesByOrigFingerprint(const std::string&, std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>&) override
     {
         return false;
@@ -68,6 +72,10 @@ public:
         return false;
         //throw NotImplemented(__func__);
     }
+    bool getAllNodes(std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>&) override
+    {
+        return false;
+    }
 
     /** @deprecated */
     bool getNodesWithSharesOrLink(std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>&, mega::ShareType_t) override
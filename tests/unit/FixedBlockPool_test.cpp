@@ -0,0 +1,67 @@
+/**
+ * (c) 2026 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mega/utils.h>
+
+TEST(FixedBlockPool, recyclesBlocks)
+{
+    mega::FixedBlockPool pool(64, 8);
+
+    void* first = pool.allocate();
+    ASSERT_NE(nullptr, first);
+
+    pool.deallocate(first);
+
+    // the freed block is handed out again before a new slab is carved
+    void* second = pool.allocate();
+    ASSERT_EQ(first, second);
+
+    pool.deallocate(second);
+}
+
+TEST(FixedBlockPool, servesManyBlocksAcrossSlabs)
+{
+    mega::FixedBlockPool pool(32, 4);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10; ++i)   // forces several slabs of 4 blocks
+    {
+        blocks.push_back(pool.allocate());
+        ASSERT_NE(nullptr, blocks.back());
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    ASSERT_EQ(blocks.end(), std::adjacent_find(blocks.begin(), blocks.end()));
+
+    for (void* block : blocks)
+    {
+        pool.deallocate(block);
+    }
+}
+
+TEST(FixedBlockPool, pooledAllocatorSharedPtr)
+{
+    auto value = std::allocate_shared<int>(mega::PooledAllocator<int>(), 42);
+    ASSERT_EQ(42, *value);
+
+    std::weak_ptr<int> observer = value;
+    value.reset();
+    ASSERT_TRUE(observer.expired());
+}
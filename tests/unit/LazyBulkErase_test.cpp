@@ -0,0 +1,97 @@
+/**
+ * (c) 2026 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mega/types.h>
+
+using mega::deque_with_lazy_bulk_erase;
+
+namespace {
+
+deque_with_lazy_bulk_erase<int> makeFilled(int count)
+{
+    deque_with_lazy_bulk_erase<int> dq;
+    for (int i = 0; i < count; ++i)
+    {
+        dq.push_back(i);
+    }
+    return dq;
+}
+
+} // anonymous namespace
+
+TEST(LazyBulkErase, eraseOnlyMarksUntilApplied)
+{
+    auto dq = makeFilled(8);
+
+    // erase() must not invalidate the iterator it was given, or any other
+    for (auto it = dq.begin(true); it != dq.end(true); ++it)
+    {
+        int value = *it;
+        if (value % 2)
+        {
+            dq.erase(it);
+            ASSERT_TRUE(it->isErased());
+        }
+    }
+
+    dq.applyErase();
+
+    ASSERT_EQ(size_t(4), dq.size());
+    for (size_t i = 0; i < 4; ++i)
+    {
+        ASSERT_EQ(int(i) * 2, int(dq[i]));
+    }
+}
+
+TEST(LazyBulkErase, consumersSkipPendingErasures)
+{
+    auto dq = makeFilled(4);
+
+    dq.erase(dq.begin());      // mark the front entry
+    ASSERT_EQ(size_t(3), dq.size());   // size() applies the pending erase
+    ASSERT_EQ(1, int(dq.front()));
+}
+
+TEST(LazyBulkErase, frontAndPopFront)
+{
+    auto dq = makeFilled(3);
+
+    ASSERT_EQ(0, int(dq.front()));
+    dq.pop_front();
+    ASSERT_EQ(1, int(dq.front()));
+    dq.pop_front();
+    dq.pop_front();
+    ASSERT_TRUE(dq.empty());
+}
+
+TEST(LazyBulkErase, clearDropsPendingErasures)
+{
+    auto dq = makeFilled(5);
+
+    dq.erase(dq.begin());
+    dq.clear();
+
+    ASSERT_TRUE(dq.empty());
+
+    // the counter of pending erasures must not leak past clear()
+    dq.push_back(42);
+    ASSERT_EQ(size_t(1), dq.size());
+    ASSERT_EQ(42, int(dq.front()));
+}
@@ -517,3 +517,105 @@ TEST(Logging, Extract_file_name_from_full_path)
     ASSERT_EQ(0, strcmp(::mega::log_file_leafname("include/mega/logging.h"), "logging.h"));
     ASSERT_EQ(0, strcmp(::mega::log_file_leafname("include\\mega\\logging.h"), "logging.h" ));
 }
+
+namespace {
+
+class CollectingLogger : public mega::Logger
+{
+public:
+    void log(const char*, int loglevel, const char*, const char* message
+#ifdef ENABLE_LOG_PERFORMANCE
+        , const char**, size_t*, unsigned
+#endif
+    ) override
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mLines.emplace_back(loglevel, message ? message : "");
+    }
+
+    std::vector<std::pair<int, std::string>> lines()
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        return mLines;
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<std::pair<int, std::string>> mLines;
+};
+
+} // anonymous
+
+TEST(Logging, asyncRingLogger_deliversInOrder)
+{
+    CollectingLogger sink;
+    {
+        mega::AsyncRingLogger ring(&sink, 256);
+        for (int i = 0; i < 100; ++i)
+        {
+            const std::string msg = "message " + std::to_string(i);
+            ring.log("12:00:00", mega::logDebug, "Logging_test.cpp:1", msg.c_str()
+#ifdef ENABLE_LOG_PERFORMANCE
+                , nullptr, nullptr, 0
+#endif
+            );
+        }
+        ring.flush();
+        ASSERT_EQ(0u, ring.droppedCount());
+    } // destructor drains and joins
+
+    const auto lines = sink.lines();
+    ASSERT_EQ(100u, lines.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(mega::logDebug, lines[static_cast<size_t>(i)].first);
+        EXPECT_EQ("message " + std::to_string(i), lines[static_cast<size_t>(i)].second);
+    }
+}
+
+TEST(Logging, asyncRingLogger_concurrentProducers)
+{
+    CollectingLogger sink;
+    const unsigned threads = 4;
+    const int perThread = 250;
+    {
+        mega::AsyncRingLogger ring(&sink, 4096);
+        std::vector<std::thread> producers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            producers.emplace_back([&ring, t]() {
+                for (int i = 0; i < perThread; ++i)
+                {
+                    const std::string msg = "t" + std::to_string(t) + " m" + std::to_string(i);
+                    ring.log(nullptr, mega::logDebug, nullptr, msg.c_str()
+#ifdef ENABLE_LOG_PERFORMANCE
+                        , nullptr, nullptr, 0
+#endif
+                    );
+                }
+            });
+        }
+        for (auto& p : producers)
+        {
+            p.join();
+        }
+        ring.flush();
+        ASSERT_EQ(0u, ring.droppedCount());
+    }
+
+    const auto lines = sink.lines();
+    ASSERT_EQ(threads * perThread, lines.size());
+
+    // each producer's messages must arrive in its own submission order
+    std::vector<int> next(threads, 0);
+    for (const auto& line : lines)
+    {
+        std::istringstream iss(line.second);
+        char c;
+        unsigned t;
+        int i;
+        ASSERT_TRUE(iss >> c >> t >> c >> i);
+        EXPECT_EQ(next[t], i);
+        next[t] = i + 1;
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * (c) 2026 by Mega Limited, Wellsford, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mega/megaclient.h>
+
+using mega::NodeHandle;
+using mega::UnwrappedKeyCache;
+
+namespace {
+
+NodeHandle makeHandle(uint64_t h)
+{
+    return NodeHandle().set6byte(h);
+}
+
+} // anonymous namespace
+
+TEST(UnwrappedKeyCache, missThenHit)
+{
+    UnwrappedKeyCache cache;
+
+    std::string key;
+    ASSERT_FALSE(cache.get(makeHandle(1), key));
+
+    cache.put(makeHandle(1), "unwrapped-bytes");
+    ASSERT_TRUE(cache.get(makeHandle(1), key));
+    ASSERT_EQ("unwrapped-bytes", key);
+}
+
+TEST(UnwrappedKeyCache, putReplacesExistingEntry)
+{
+    UnwrappedKeyCache cache;
+
+    cache.put(makeHandle(2), "old");
+    cache.put(makeHandle(2), "new");
+    ASSERT_EQ(size_t(1), cache.size());
+
+    std::string key;
+    ASSERT_TRUE(cache.get(makeHandle(2), key));
+    ASSERT_EQ("new", key);
+}
+
+TEST(UnwrappedKeyCache, eraseDropsEntry)
+{
+    UnwrappedKeyCache cache;
+
+    cache.put(makeHandle(3), "bytes");
+    cache.erase(makeHandle(3));
+
+    std::string key;
+    ASSERT_FALSE(cache.get(makeHandle(3), key));
+    ASSERT_EQ(size_t(0), cache.size());
+}
+
+TEST(UnwrappedKeyCache, clearDropsEverything)
+{
+    UnwrappedKeyCache cache;
+
+    cache.put(makeHandle(4), "a");
+    cache.put(makeHandle(5), "b");
+    cache.clear();
+
+    ASSERT_EQ(size_t(0), cache.size());
+
+    std::string key;
+    ASSERT_FALSE(cache.get(makeHandle(4), key));
+}
+
+TEST(UnwrappedKeyCache, evictsLeastRecentlyUsedAtCap)
+{
+    UnwrappedKeyCache cache;
+
+    // fill to the cap, then keep the first entry warm and overflow by one
+    const uint64_t cap = 16384;
+    for (uint64_t h = 0; h < cap; ++h)
+    {
+        cache.put(makeHandle(h), "k");
+    }
+
+    std::string key;
+    ASSERT_TRUE(cache.get(makeHandle(0), key));
+
+    cache.put(makeHandle(cap), "k");
+    ASSERT_EQ(size_t(cap), cache.size());
+
+    // the recently touched entry survived; the coldest one was evicted
+    ASSERT_TRUE(cache.get(makeHandle(0), key));
+    ASSERT_FALSE(cache.get(makeHandle(1), key));
+}
@@ -117,3 +117,33 @@ TEST(User, unserialize_32bit)
     auto newUser = mega::User::unserialize(client.get(), &d);
     checkUsers(user, *newUser);
 }
+
+TEST(User, string2attr_roundTripsEveryKnownAttribute)
+{
+    const mega::attr_t attrs[] = {
+        mega::ATTR_AVATAR, mega::ATTR_FIRSTNAME, mega::ATTR_LASTNAME,
+        mega::ATTR_AUTHRING, mega::ATTR_LAST_INT, mega::ATTR_ED25519_PUBK,
+        mega::ATTR_CU25519_PUBK, mega::ATTR_KEYRING, mega::ATTR_SIG_RSA_PUBK,
+        mega::ATTR_SIG_CU255_PUBK, mega::ATTR_COUNTRY, mega::ATTR_BIRTHDAY,
+        mega::ATTR_BIRTHMONTH, mega::ATTR_BIRTHYEAR, mega::ATTR_LANGUAGE,
+        mega::ATTR_PWD_REMINDER, mega::ATTR_DISABLE_VERSIONS,
+        mega::ATTR_CONTACT_LINK_VERIFICATION, mega::ATTR_RICH_PREVIEWS,
+        mega::ATTR_RUBBISH_TIME, mega::ATTR_LAST_PSA, mega::ATTR_STORAGE_STATE,
+        mega::ATTR_GEOLOCATION, mega::ATTR_CAMERA_UPLOADS_FOLDER,
+        mega::ATTR_MY_CHAT_FILES_FOLDER, mega::ATTR_PUSH_SETTINGS,
+        mega::ATTR_UNSHAREABLE_KEY, mega::ATTR_ALIAS, mega::ATTR_AUTHCU255,
+        mega::ATTR_DEVICE_NAMES, mega::ATTR_MY_BACKUPS_FOLDER,
+        mega::ATTR_COOKIE_SETTINGS, mega::ATTR_JSON_SYNC_CONFIG_DATA,
+        mega::ATTR_NO_CALLKIT, mega::ATTR_KEYS, mega::ATTR_APPS_PREFS,
+        mega::ATTR_CC_PREFS, mega::ATTR_VISIBLE_WELCOME_DIALOG,
+    };
+
+    for (mega::attr_t at : attrs)
+    {
+        const std::string name = mega::User::attr2string(at);
+        ASSERT_FALSE(name.empty());
+        ASSERT_EQ(at, mega::User::string2attr(name.c_str())) << name;
+    }
+
+    ASSERT_EQ(mega::ATTR_UNKNOWN, mega::User::string2attr("no-such-attribute"));
+}
@@ -1173,3 +1173,40 @@ TEST_F(SprintfTest, ResizeAndPrint) {
     // sprince = "1.20\0\0\0\..."
     ASSERT_EQ((string)sprice.c_str(), "1.20");
 }
+
+TEST(ScratchStrings, recyclesCapacityAcrossRounds)
+{
+    mega::ScratchStrings scratch;
+
+    std::string& first = scratch.get();
+    first.assign(256, 'x');
+    const char* buffer = first.data();
+
+    // next round: the same slot comes back cleared, buffer intact
+    scratch.reset();
+    std::string& recycled = scratch.get();
+    ASSERT_EQ(&first, &recycled);
+    ASSERT_TRUE(recycled.empty());
+    ASSERT_EQ(buffer, recycled.data());
+    ASSERT_LE(size_t(256), recycled.capacity());
+}
+
+TEST(ScratchStrings, handsOutDistinctSlotsWithinARound)
+{
+    mega::ScratchStrings scratch;
+
+    std::string& a = scratch.get();
+    std::string& b = scratch.get();
+    ASSERT_NE(&a, &b);
+
+    a = "one";
+    b = "two";
+
+    // growing the arena must not move the strings already handed out
+    for (int i = 0; i < 64; ++i)
+    {
+        scratch.get();
+    }
+    ASSERT_EQ("one", a);
+    ASSERT_EQ("two", b);
+}